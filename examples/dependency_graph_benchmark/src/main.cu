@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/util/detail/SteadyClockTimer.h"
+
+/**
+ * Benchmark of DependencyGraph::generateLayers()
+ *
+ * Generates random, diamond heavy, agent function DAGs of increasing size, and compares the layer count and build time
+ * of DependencyGraph::generateLayers() against the previous algorithm (recursive minimum depth walk, followed by packing
+ * each ideal layer and appending a new layer whenever LayerDescription throws due to a conflict).
+ * The previous algorithm visits every path through the graph, so it is skipped once the number of paths becomes impractical.
+ *
+ * Usage: dependency_graph_benchmark [seed]
+ */
+
+FLAMEGPU_AGENT_FUNCTION(fn_none_none, flamegpu::MessageNone, flamegpu::MessageNone) {
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(fn_bf_none, flamegpu::MessageBruteForce, flamegpu::MessageNone) {
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(fn_none_bf, flamegpu::MessageNone, flamegpu::MessageBruteForce) {
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(fn_bf_bf, flamegpu::MessageBruteForce, flamegpu::MessageBruteForce) {
+    return flamegpu::ALIVE;
+}
+
+/**
+ * Parameters of a generated DAG
+ */
+struct GraphSpec {
+    unsigned int levels;
+    unsigned int width;
+    unsigned int agents;
+    unsigned int states;
+    unsigned int messages;
+    unsigned int seed;
+};
+/**
+ * A generated model, and the edges of it's dependency graph
+ */
+struct GeneratedGraph {
+    explicit GeneratedGraph(const std::string &name) : model(name) { }
+    flamegpu::ModelDescription model;
+    std::vector<flamegpu::AgentFunctionDescription*> functions;
+    std::vector<unsigned int> roots;
+    // dependents[i] = functions which depend on function i
+    std::vector<std::vector<unsigned int>> dependents;
+};
+
+/**
+ * Generates a layered DAG, where each function depends on 1-3 functions of the previous level
+ * As functions share dependencies with their neighbours, the number of paths grows exponentially with the number of levels
+ */
+void generate(const GraphSpec &spec, GeneratedGraph &g) {
+    std::mt19937 rng(spec.seed);
+    for (unsigned int m = 0; m < spec.messages; ++m) {
+        g.model.newMessage("message" + std::to_string(m));
+    }
+    std::vector<flamegpu::AgentDescription*> agents;
+    for (unsigned int a = 0; a < spec.agents; ++a) {
+        flamegpu::AgentDescription &agent = g.model.newAgent("agent" + std::to_string(a));
+        for (unsigned int s = 0; s < spec.states; ++s) {
+            agent.newState("state" + std::to_string(s));
+        }
+        agents.push_back(&agent);
+    }
+    const unsigned int count = spec.levels * spec.width;
+    g.dependents.resize(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        const std::string name = "f" + std::to_string(i);
+        flamegpu::AgentDescription &agent = *agents[rng() % spec.agents];
+        // Pick message input/output, each with 25% probability
+        const bool has_in = spec.messages && rng() % 4 == 0;
+        const bool has_out = spec.messages > 1 && rng() % 4 == 0;
+        flamegpu::AgentFunctionDescription *f = nullptr;
+        if (has_in && has_out) {
+            f = &agent.newFunction(name, fn_bf_bf);
+        } else if (has_in) {
+            f = &agent.newFunction(name, fn_bf_none);
+        } else if (has_out) {
+            f = &agent.newFunction(name, fn_none_bf);
+        } else {
+            f = &agent.newFunction(name, fn_none_none);
+        }
+        const unsigned int message_in = rng() % std::max(spec.messages, 1u);
+        if (has_in) {
+            f->setMessageInput("message" + std::to_string(message_in));
+        }
+        if (has_out) {
+            f->setMessageOutput("message" + std::to_string((message_in + 1 + rng() % (spec.messages - 1)) % spec.messages));
+        }
+        f->setInitialState("state" + std::to_string(rng() % spec.states));
+        f->setEndState("state" + std::to_string(rng() % spec.states));
+        g.functions.push_back(f);
+        // Dependencies on the previous level
+        const unsigned int level = i / spec.width;
+        if (level == 0) {
+            g.roots.push_back(i);
+            continue;
+        }
+        const unsigned int dependency_count = 1 + rng() % 3;
+        std::vector<unsigned int> dependencies;
+        for (unsigned int d = 0; d < dependency_count; ++d) {
+            const unsigned int dep = (level - 1) * spec.width + rng() % spec.width;
+            if (std::find(dependencies.begin(), dependencies.end(), dep) == dependencies.end()) {
+                dependencies.push_back(dep);
+                f->dependsOn(*g.functions[dep]);
+                g.dependents[dep].push_back(i);
+            }
+        }
+    }
+    flamegpu::DependencyGraph &graph = g.model.getDependencyGraph();
+    for (const unsigned int r : g.roots) {
+        graph.addRoot(*g.functions[r]);
+    }
+}
+
+/**
+ * Returns the number of root to leaf paths through the graph
+ */
+double countPaths(const GeneratedGraph &g) {
+    // Functions are generated in topological order, so iterate in reverse
+    std::vector<double> paths(g.functions.size(), 1.0);
+    for (size_t i = g.functions.size(); i-- > 0;) {
+        if (!g.dependents[i].empty()) {
+            paths[i] = 0;
+            for (const unsigned int d : g.dependents[i]) {
+                paths[i] += paths[d];
+            }
+        }
+    }
+    double total = 0;
+    for (const unsigned int r : g.roots) {
+        total += paths[r];
+    }
+    return total;
+}
+
+/**
+ * Reimplementation of the previous DependencyGraph::generateLayers() algorithm, operating on the generated edge list
+ * @return The number of layers added to the model
+ */
+unsigned int legacyGenerateLayers(GeneratedGraph &g) {
+    std::vector<int> depth(g.functions.size(), 0);
+    std::function<void(unsigned int, int)> setMinLayerDepths;
+    setMinLayerDepths = [&](unsigned int node, int d) {
+        if (d >= depth[node]) {
+            depth[node] = d;
+        }
+        for (const unsigned int child : g.dependents[node]) {
+            setMinLayerDepths(child, d + 1);
+        }
+    };
+    for (const unsigned int r : g.roots) {
+        setMinLayerDepths(r, 0);
+    }
+    std::vector<std::vector<unsigned int>> idealLayers;
+    std::function<void(unsigned int)> buildIdealLayers;
+    buildIdealLayers = [&](unsigned int node) {
+        while (static_cast<size_t>(depth[node]) >= idealLayers.size()) {
+            idealLayers.emplace_back();
+        }
+        std::vector<unsigned int> &layer = idealLayers[depth[node]];
+        if (std::find(layer.begin(), layer.end(), node) == layer.end()) {
+            layer.push_back(node);
+        }
+        for (const unsigned int child : g.dependents[node]) {
+            buildIdealLayers(child);
+        }
+    };
+    for (const unsigned int r : g.roots) {
+        buildIdealLayers(r);
+    }
+    unsigned int layerCount = 0;
+    for (const auto &idealLayer : idealLayers) {
+        flamegpu::LayerDescription *layer = &g.model.newLayer();
+        ++layerCount;
+        for (const unsigned int node : idealLayer) {
+            try {
+                layer->addAgentFunction(*g.functions[node]);
+            } catch (const flamegpu::exception::InvalidAgentFunc&) {
+                layer = &g.model.newLayer();
+                ++layerCount;
+                layer->addAgentFunction(*g.functions[node]);
+            } catch (const flamegpu::exception::InvalidLayerMember&) {
+                layer = &g.model.newLayer();
+                ++layerCount;
+                layer->addAgentFunction(*g.functions[node]);
+            }
+        }
+    }
+    return layerCount;
+}
+
+int main(int argc, const char ** argv) {
+    const unsigned int seed = argc > 1 ? static_cast<unsigned int>(strtoul(argv[1], nullptr, 0)) : 12;
+    // The previous algorithm is skipped when the graph contains more paths than this
+    const double LEGACY_PATH_LIMIT = 1e7;
+    const std::vector<GraphSpec> specs = {
+        {5, 4, 4, 2, 4, seed},
+        {10, 8, 4, 3, 6, seed},
+        {15, 10, 6, 3, 8, seed},
+        {20, 15, 8, 4, 10, seed},
+        {30, 10, 8, 4, 10, seed},
+        {50, 6, 8, 4, 10, seed},
+        {100, 3, 4, 4, 6, seed},
+    };
+    printf("%-10s %-10s %-12s %-14s %-14s %-14s %-14s\n", "functions", "levels", "paths", "layers", "layers(prev)", "time(s)", "time(prev)(s)");
+    for (const auto &spec : specs) {
+        GeneratedGraph g("benchmark");
+        generate(spec, g);
+        const double paths = countPaths(g);
+        // Current algorithm
+        flamegpu::util::detail::SteadyClockTimer timer;
+        timer.start();
+        g.model.generateLayers();
+        timer.stop();
+        const unsigned int layers = g.model.getLayersCount();
+        const double seconds = timer.getElapsedSeconds();
+        // Previous algorithm, on an identical model
+        if (paths <= LEGACY_PATH_LIMIT) {
+            GeneratedGraph legacy("benchmark_legacy");
+            generate(spec, legacy);
+            timer.start();
+            const unsigned int legacyLayers = legacyGenerateLayers(legacy);
+            timer.stop();
+            printf("%-10zu %-10u %-12.4g %-14u %-14u %-14.6f %-14.6f\n", g.functions.size(), spec.levels, paths, layers, legacyLayers, seconds, timer.getElapsedSeconds());
+        } else {
+            printf("%-10zu %-10u %-12.4g %-14u %-14s %-14.6f %-14s\n", g.functions.size(), spec.levels, paths, layers, "skipped", seconds, "skipped");
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+/**
+ * Benchmark of CUDAEnsemble::EnsembleConfig::reuse_simulations
+ *
+ * Executes an ensemble of many short runs of a small model, first creating a new CUDASimulation per run, and then
+ * reusing a single CUDASimulation per runner. The per run setup overhead is the ensemble's wall time, less the time
+ * spent within each run's call to CUDASimulation::simulate() (as reported by the exit log timing), divided by the number of runs.
+ * Runs are executed serially on a single device, so that the overheads are not hidden by concurrent runs.
+ *
+ * Usage: ensemble_reuse_benchmark [runs] [device]
+ */
+
+FLAMEGPU_AGENT_FUNCTION(output, flamegpu::MessageNone, flamegpu::MessageSpatial2D) {
+    FLAMEGPU->message_out.setLocation(FLAMEGPU->getVariable<float>("x"), FLAMEGPU->getVariable<float>("y"));
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(input, flamegpu::MessageSpatial2D, flamegpu::MessageNone) {
+    const float x = FLAMEGPU->getVariable<float>("x");
+    const float y = FLAMEGPU->getVariable<float>("y");
+    unsigned int count = 0;
+    for (const auto &message : FLAMEGPU->message_in(x, y)) {
+        const float dx = message.getVariable<float>("x") - x;
+        const float dy = message.getVariable<float>("y") - y;
+        count += dx * dx + dy * dy <= 1.0f ? 1 : 0;
+    }
+    FLAMEGPU->setVariable<unsigned int>("count", count);
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_INIT_FUNCTION(init) {
+    const unsigned int POPULATION_TO_GENERATE = FLAMEGPU->environment.getProperty<unsigned int>("POPULATION_TO_GENERATE");
+    const float width = FLAMEGPU->environment.getProperty<float>("width");
+    auto agent = FLAMEGPU->agent("Agent");
+    for (unsigned int i = 0; i < POPULATION_TO_GENERATE; ++i) {
+        auto a = agent.newAgent();
+        a.setVariable<float>("x", FLAMEGPU->random.uniform<float>() * width);
+        a.setVariable<float>("y", FLAMEGPU->random.uniform<float>() * width);
+    }
+}
+
+int main(int argc, const char ** argv) {
+    const unsigned int RUNS = argc > 1 ? static_cast<unsigned int>(strtoul(argv[1], nullptr, 0)) : 200;
+    const int DEVICE = argc > 2 ? static_cast<int>(strtol(argv[2], nullptr, 0)) : 0;
+    const unsigned int STEPS = 2;
+    flamegpu::ModelDescription model("ensemble_reuse_benchmark");
+    {   // Environment
+        flamegpu::EnvironmentDescription &env = model.Environment();
+        env.newProperty<unsigned int>("POPULATION_TO_GENERATE", 1024, true);
+        env.newProperty<float>("width", 32.0f);
+    }
+    {   // Message
+        flamegpu::MessageSpatial2D::Description &message = model.newMessage<flamegpu::MessageSpatial2D>("location");
+        message.setMin(0, 0);
+        message.setMax(32, 32);
+        message.setRadius(1);
+    }
+    {   // Agent
+        flamegpu::AgentDescription &agent = model.newAgent("Agent");
+        agent.newVariable<float>("x");
+        agent.newVariable<float>("y");
+        agent.newVariable<unsigned int>("count", 0);
+        agent.newFunction("output", output).setMessageOutput("location");
+        agent.newFunction("input", input).setMessageInput("location");
+    }
+    {   // Control flow
+        model.newLayer().addAgentFunction(output);
+        model.newLayer().addAgentFunction(input);
+        model.addInitFunction(init);
+    }
+    flamegpu::LoggingConfig exit_log(model);
+    exit_log.agent("Agent").logSum<unsigned int>("count");
+    exit_log.logTiming(true);
+
+    flamegpu::RunPlanVector runs(model, RUNS);
+    runs.setSteps(STEPS);
+    runs.setRandomSimulationSeed(12, 1);
+    runs.setPropertyUniformDistribution<float>("width", 16.0f, 32.0f);
+
+    printf("%-8s %-8s %-14s %-14s %-20s\n", "reuse", "runs", "total(s)", "simulate(s)", "overhead/run(ms)");
+    std::vector<unsigned int> results[2];
+    for (int reuse = 0; reuse < 2; ++reuse) {
+        flamegpu::CUDAEnsemble ensemble(model);
+        ensemble.Config().quiet = true;
+        ensemble.Config().out_format = "";
+        ensemble.Config().concurrent_runs = 1;
+        ensemble.Config().devices = {DEVICE};
+        ensemble.Config().reuse_simulations = reuse != 0;
+        ensemble.setExitLog(exit_log);
+        ensemble.simulate(runs);
+        double simulate_seconds = 0;
+        for (const auto &log : ensemble.getLogs()) {
+            simulate_seconds += log.getExitLog().getTotalTime();
+            results[reuse].push_back(log.getExitLog().getAgent("Agent").getSum<unsigned int>("count"));
+        }
+        const double total_seconds = ensemble.getEnsembleElapsedTime();
+        printf("%-8s %-8u %-14.6f %-14.6f %-20.6f\n", reuse ? "true" : "false", RUNS, total_seconds, simulate_seconds,
+            1000.0 * (total_seconds - simulate_seconds) / RUNS);
+    }
+    // Both modes should produce identical results
+    if (results[0] != results[1]) {
+        fprintf(stderr, "Error: Results differ between reused and recreated simulations.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+/**
+ * Benchmark of AgentDescription::setSortOrder()
+ *
+ * A population of randomly walking agents reads MessageSpatial3D each step. The population is executed unsorted, and then
+ * with the automatic spatial sort using each SpatialSortOrder. For each ordering the benchmark reports:
+ * - bins/warp: The mean number of distinct message grid bins occupied by each 32 consecutive agents (after the final sort),
+ *   a measure of cache locality, as agents within the same warp which occupy fewer bins read more of the same messages.
+ * - step(ms): The mean step time, excluding the first step.
+ * - messages/s: The number of messages iterated by agents per second of step time, excluding the first step.
+ *
+ * Usage: spatial_sort_benchmark [agents] [steps] [device]
+ */
+
+FLAMEGPU_AGENT_FUNCTION(output, flamegpu::MessageNone, flamegpu::MessageSpatial3D) {
+    FLAMEGPU->message_out.setLocation(FLAMEGPU->getVariable<float>("x"), FLAMEGPU->getVariable<float>("y"), FLAMEGPU->getVariable<float>("z"));
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(input, flamegpu::MessageSpatial3D, flamegpu::MessageNone) {
+    const float RADIUS = FLAMEGPU->message_in.radius();
+    const float width = FLAMEGPU->environment.getProperty<float>("width");
+    float pos[3] = {FLAMEGPU->getVariable<float>("x"), FLAMEGPU->getVariable<float>("y"), FLAMEGPU->getVariable<float>("z")};
+    unsigned int iterated = 0;
+    unsigned int neighbours = 0;
+    for (const auto &message : FLAMEGPU->message_in(pos[0], pos[1], pos[2])) {
+        const float dx = message.getVariable<float>("x") - pos[0];
+        const float dy = message.getVariable<float>("y") - pos[1];
+        const float dz = message.getVariable<float>("z") - pos[2];
+        neighbours += dx * dx + dy * dy + dz * dz <= RADIUS * RADIUS ? 1 : 0;
+        ++iterated;
+    }
+    FLAMEGPU->setVariable<unsigned int>("iterated", FLAMEGPU->getVariable<unsigned int>("iterated") + iterated);
+    FLAMEGPU->setVariable<unsigned int>("neighbours", neighbours);
+    // Random walk, wrapped within the environment, so that the sort has work to do each step
+    for (float &p : pos) {
+        p += (FLAMEGPU->random.uniform<float>() - 0.5f) * RADIUS;
+        p = p < 0 ? p + width : (p >= width ? p - width : p);
+    }
+    FLAMEGPU->setVariable<float>("x", pos[0]);
+    FLAMEGPU->setVariable<float>("y", pos[1]);
+    FLAMEGPU->setVariable<float>("z", pos[2]);
+    return flamegpu::ALIVE;
+}
+
+int main(int argc, const char ** argv) {
+    const unsigned int AGENTS = argc > 1 ? static_cast<unsigned int>(strtoul(argv[1], nullptr, 0)) : 1u << 20;
+    const unsigned int STEPS = argc > 2 ? static_cast<unsigned int>(strtoul(argv[2], nullptr, 0)) : 20;
+    const int DEVICE = argc > 3 ? static_cast<int>(strtol(argv[3], nullptr, 0)) : 0;
+    const float RADIUS = 1.0f;
+    // Approximately 8 agents per bin
+    const float WIDTH = std::ceil(std::cbrt(AGENTS / 8.0f)) * RADIUS;
+    const unsigned int GRID_DIM = static_cast<unsigned int>(WIDTH / RADIUS);
+    if (STEPS < 2) {
+        fprintf(stderr, "Error: Atleast 2 steps are required.\n");
+        return EXIT_FAILURE;
+    }
+    flamegpu::ModelDescription model("spatial_sort_benchmark");
+    model.Environment().newProperty<float>("width", WIDTH, true);
+    {   // Message
+        flamegpu::MessageSpatial3D::Description &message = model.newMessage<flamegpu::MessageSpatial3D>("location");
+        message.setMin(0, 0, 0);
+        message.setMax(WIDTH, WIDTH, WIDTH);
+        message.setRadius(RADIUS);
+    }
+    flamegpu::AgentDescription &agent = model.newAgent("Agent");
+    {   // Agent
+        agent.newVariable<float>("x");
+        agent.newVariable<float>("y");
+        agent.newVariable<float>("z");
+        agent.newVariable<unsigned int>("iterated", 0);
+        agent.newVariable<unsigned int>("neighbours", 0);
+        agent.newFunction("output", output).setMessageOutput("location");
+        agent.newFunction("input", input).setMessageInput("location");
+    }
+    {   // Control flow
+        model.newLayer().addAgentFunction(output);
+        model.newLayer().addAgentFunction(input);
+    }
+    // The same randomly ordered initial population is used for each ordering
+    flamegpu::AgentVector population(agent, AGENTS);
+    {
+        std::mt19937 rng(12);
+        std::uniform_real_distribution<float> dist(0, WIDTH);
+        for (auto a : population) {
+            a.setVariable<float>("x", dist(rng));
+            a.setVariable<float>("y", dist(rng));
+            a.setVariable<float>("z", dist(rng));
+        }
+    }
+
+    struct Ordering {
+        const char *name;
+        unsigned int sort_period;
+        flamegpu::SpatialSortOrder order;
+    };
+    const Ordering orderings[] = {
+        {"Unsorted", 0, flamegpu::SpatialSortOrder::RowMajor},
+        {"RowMajor", 1, flamegpu::SpatialSortOrder::RowMajor},
+        {"Morton", 1, flamegpu::SpatialSortOrder::Morton},
+        {"Hilbert", 1, flamegpu::SpatialSortOrder::Hilbert},
+    };
+    printf("agents: %u, grid: %u^3, steps: %u\n", AGENTS, GRID_DIM, STEPS);
+    printf("%-10s %-12s %-12s %-16s\n", "order", "bins/warp", "step(ms)", "messages/s");
+    for (const Ordering &ordering : orderings) {
+        agent.setSortPeriod(ordering.sort_period);
+        agent.setSortOrder(ordering.order);
+        flamegpu::CUDASimulation simulation(model);
+        simulation.SimulationConfig().steps = STEPS;
+        simulation.SimulationConfig().random_seed = 12;
+        simulation.CUDAConfig().device_id = DEVICE;
+        simulation.setPopulationData(population);
+        simulation.simulate();
+        // The first step is excluded, as the population has not yet been sorted
+        double step_seconds = 0;
+        const std::vector<double> step_times = simulation.getElapsedTimeSteps();
+        for (size_t i = 1; i < step_times.size(); ++i)
+            step_seconds += step_times[i];
+        flamegpu::AgentVector result(agent);
+        simulation.getPopulationData(result);
+        // Messages iterated by each agent, scaled to exclude the first step
+        double iterated = 0;
+        for (const auto a : result)
+            iterated += a.getVariable<unsigned int>("iterated");
+        iterated *= static_cast<double>(STEPS - 1) / STEPS;
+        // Distinct bins occupied by each warp of agents, in the order they are stored on the device
+        // Positions have moved since the final sort, by atmost half a bin per axis
+        double bins_per_warp = 0;
+        unsigned int warps = 0;
+        for (unsigned int begin = 0; begin < result.size(); begin += 32) {
+            std::set<unsigned int> bins;
+            for (unsigned int i = begin; i < begin + 32 && i < result.size(); ++i) {
+                const auto a = result[i];
+                const unsigned int bx = std::min(static_cast<unsigned int>(a.getVariable<float>("x") / RADIUS), GRID_DIM - 1);
+                const unsigned int by = std::min(static_cast<unsigned int>(a.getVariable<float>("y") / RADIUS), GRID_DIM - 1);
+                const unsigned int bz = std::min(static_cast<unsigned int>(a.getVariable<float>("z") / RADIUS), GRID_DIM - 1);
+                bins.insert((bz * GRID_DIM + by) * GRID_DIM + bx);
+            }
+            bins_per_warp += bins.size();
+            ++warps;
+        }
+        printf("%-10s %-12.3f %-12.3f %-16.4e\n", ordering.name, bins_per_warp / warps,
+            1000.0 * step_seconds / (STEPS - 1), iterated / step_seconds);
+    }
+    return EXIT_SUCCESS;
+}
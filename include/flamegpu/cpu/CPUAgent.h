@@ -0,0 +1,70 @@
+#ifndef INCLUDE_FLAMEGPU_CPU_CPUAGENT_H_
+#define INCLUDE_FLAMEGPU_CPU_CPUAGENT_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "flamegpu/sim/AgentInterface.h"
+#include "flamegpu/pop/AgentVector.h"
+
+namespace flamegpu {
+
+/**
+ * Host storage for all states of a single agent type, used by CPUReferenceSimulation in place of CUDAAgent
+ * Each state's population is held as an AgentVector, so the columnar layout matches that used for population import/export
+ */
+class CPUAgent : public AgentInterface {
+ public:
+    /**
+     * Creates an empty population for each state of the agent
+     * @param description The agent's description within the model hierarchy
+     */
+    explicit CPUAgent(const AgentData &description);
+    const AgentData &getAgentDescription() const override { return agent_description; }
+    void *getStateVariablePtr(const std::string &state_name, const std::string &variable_name) override;
+    ModelData::size_type getStateSize(const std::string &state_name) const override;
+    id_t nextID(unsigned int count) override;
+    /**
+     * DeviceAgentVector is not available to CPUReferenceSimulation
+     * @throws exception::InvalidOperation
+     */
+    void setPopulationVec(const std::string &state_name, const std::shared_ptr<DeviceAgentVector_impl> &d_vec) override;
+    /**
+     * DeviceAgentVector is not available to CPUReferenceSimulation, so this always returns nullptr
+     */
+    std::shared_ptr<DeviceAgentVector_impl> getPopulationVec(const std::string &state_name) override;
+    void resetPopulationVecs() override { }
+    /**
+     * Returns the population of the named state
+     * @throws exception::InvalidAgentState If the state does not exist
+     */
+    AgentVector &getPopulation(const std::string &state_name);
+    const AgentVector &getPopulation(const std::string &state_name) const;
+    /**
+     * Assigns IDs to any agents whose ID has not been set, and ensures future IDs do not collide with existing IDs
+     * @throws exception::AgentIDCollision If two agents share the same ID
+     */
+    void assignIDs();
+    /**
+     * Sets the ID counter, used when restoring a checkpoint
+     * @param id The next ID to be assigned
+     */
+    void setNextID(id_t id) { next_id = id; }
+    /**
+     * Clears all states, and resets the ID counter
+     */
+    void clear();
+
+ private:
+    const AgentData &agent_description;
+    std::map<std::string, std::unique_ptr<AgentVector>> state_map;
+    /**
+     * The next ID to be assigned
+     */
+    id_t next_id;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_CPU_CPUAGENT_H_
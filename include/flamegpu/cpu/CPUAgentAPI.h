@@ -0,0 +1,464 @@
+#ifndef INCLUDE_FLAMEGPU_CPU_CPUAGENTAPI_H_
+#define INCLUDE_FLAMEGPU_CPU_CPUAGENTAPI_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+
+#include "flamegpu/defines.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/cpu/CPUMessageList.h"
+#include "flamegpu/runtime/AgentFunction.cuh"
+#include "flamegpu/util/Any.h"
+
+/**
+ * Macro for defining agent functions to be executed by CPUReferenceSimulation
+ * The body is written against the same API as FLAMEGPU_AGENT_FUNCTION (e.g. FLAMEGPU->getVariable<float>("x"))
+ * Message types are selected when the function is attached to the model description, so are not required here
+ */
+#define FLAMEGPU_CPU_AGENT_FUNCTION(funcName) \
+flamegpu::AGENT_STATUS funcName(flamegpu::CPUAgentAPI *FLAMEGPU)
+/**
+ * Macro for defining agent function conditions to be executed by CPUReferenceSimulation
+ * @see FLAMEGPU_AGENT_FUNCTION_CONDITION
+ */
+#define FLAMEGPU_CPU_AGENT_FUNCTION_CONDITION(funcName) \
+bool funcName(const flamegpu::CPUAgentAPI *FLAMEGPU)
+
+namespace flamegpu {
+namespace detail {
+/**
+ * Locates the named variable within a buffer map and validates it's type and length
+ * @throws exception::InvalidAgentVar If the variable is not found
+ * @throws exception::InvalidVarType If the variable's type does not match T
+ * @throws exception::OutOfBoundsException If index exceeds the variable's length
+ */
+template<typename T>
+const CPUVariableBuffer &getCPUVariableBuffer(const CPUVariableBufferMap &buffers, const std::string &variable_name, unsigned int index, const char *caller) {
+    const auto it = buffers.find(variable_name);
+    if (it == buffers.end()) {
+        THROW exception::InvalidAgentVar("Variable '%s' was not found, in %s\n", variable_name.c_str(), caller);
+    }
+    if (it->second.type != std::type_index(typeid(T))) {
+        THROW exception::InvalidVarType("Variable '%s' has type '%s', incorrect  type '%s' was requested, in %s\n",
+            variable_name.c_str(), it->second.type.name(), std::type_index(typeid(T)).name(), caller);
+    }
+    if (index >= it->second.elements) {
+        THROW exception::OutOfBoundsException("Index %u is out of bounds for variable '%s' with %u elements, in %s\n",
+            index, variable_name.c_str(), it->second.elements, caller);
+    }
+    return it->second;
+}
+}  // namespace detail
+
+/**
+ * Host equivalent of DeviceAPI, passed to agent functions executed by CPUReferenceSimulation
+ * An instance is bound to a single agent at a time, CPUReferenceSimulation creates one instance per worker chunk
+ * @see DeviceAPI
+ */
+class CPUAgentAPI {
+    friend class CPUReferenceSimulation;
+
+ public:
+    /**
+     * Read-only access to environment properties
+     * @see DeviceEnvironment
+     */
+    class Environment {
+        friend class CPUAgentAPI;
+        explicit Environment(const std::unordered_map<std::string, util::Any> &_properties)
+            : properties(_properties) { }
+        const std::unordered_map<std::string, util::Any> &properties;
+
+     public:
+        /**
+         * Gets an environment property
+         * @param name name used for accessing the property
+         * @tparam T Type of the environment property being accessed
+         * @throws exception::InvalidEnvProperty If a property of the name does not exist
+         * @throws exception::InvalidEnvPropertyType If the property is not of type T
+         */
+        template<typename T>
+        T getProperty(const std::string &name) const {
+            return getProperty<T, 1>(name, 0);
+        }
+        /**
+         * Gets an element of an environment property array
+         * @param name name used for accessing the property
+         * @param index Index of the element within the environment property array to return
+         * @tparam T Type of the environment property being accessed
+         * @tparam N Length of the environment property array
+         * @throws exception::InvalidEnvProperty If a property of the name does not exist
+         * @throws exception::InvalidEnvPropertyType If the property is not of type T
+         * @throws exception::OutOfBoundsException If index is not in range of the length of the property array
+         */
+        template<typename T, unsigned int N>
+        T getProperty(const std::string &name, unsigned int index) const {
+            const auto it = properties.find(name);
+            if (it == properties.end()) {
+                THROW exception::InvalidEnvProperty("Environment property with name '%s' does not exist, "
+                    "in CPUAgentAPI::Environment::getProperty()\n", name.c_str());
+            }
+            if (it->second.type != std::type_index(typeid(T))) {
+                THROW exception::InvalidEnvPropertyType("Environment property '%s' type mismatch '%s' != '%s', "
+                    "in CPUAgentAPI::Environment::getProperty()\n", name.c_str(), it->second.type.name(), std::type_index(typeid(T)).name());
+            }
+            if (index >= it->second.elements) {
+                THROW exception::OutOfBoundsException("Index %u is out of bounds for environment property '%s' of length %u, "
+                    "in CPUAgentAPI::Environment::getProperty()\n", index, name.c_str(), it->second.elements);
+            }
+            return static_cast<const T *>(it->second.ptr)[index];
+        }
+    };
+    /**
+     * Random number generation, the stream of each agent is seeded from the simulation's random seed, the step, the agent function and the agent's ID
+     * As such results are independent of the number of threads used
+     * @note The generator differs from that of AgentRandom (curand), so individual values will not match a CUDASimulation with the same seed
+     * @see AgentRandom
+     */
+    class Random {
+        friend class CPUAgentAPI;
+        Random() : state(0) { }
+        /**
+         * splitmix64, a small fast generator which can be cheaply reseeded per agent
+         */
+        uint64_t next() const {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+        mutable uint64_t state;
+
+     public:
+        /**
+         * Returns a float uniformly distributed between 0.0 and 1.0.
+         * @note It may return from 0.0 to 1.0, where 1.0 is included and 0.0 is excluded.
+         * @note Available as float or double
+         */
+        template<typename T>
+        T uniform() const {
+            static_assert(std::is_floating_point<T>::value, "Invalid template argument for CPUAgentAPI::Random::uniform()");
+            // Use the top 53 bits, offset by 1 to produce the range (0, 1]
+            return static_cast<T>(static_cast<double>((next() >> 11) + 1) * (1.0 / 9007199254740992.0));
+        }
+        /**
+         * Returns a normally distributed float with mean 0.0 and standard deviation 1.0.
+         * @note Available as float or double
+         */
+        template<typename T>
+        T normal() const {
+            static_assert(std::is_floating_point<T>::value, "Invalid template argument for CPUAgentAPI::Random::normal()");
+            // Box-Muller transform
+            const double u1 = uniform<double>();
+            const double u2 = uniform<double>();
+            return static_cast<T>(sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2));
+        }
+        /**
+         * Returns a log-normally distributed float based on a normal distribution with the given mean and standard deviation.
+         * @note Available as float or double
+         */
+        template<typename T>
+        T logNormal(T mean, T stddev) const {
+            static_assert(std::is_floating_point<T>::value, "Invalid template argument for CPUAgentAPI::Random::logNormal()");
+            return static_cast<T>(exp(mean + stddev * normal<double>()));
+        }
+        /**
+         * Returns an integer uniformly distributed in the inclusive range [min, max]
+         * or
+         * Returns a floating point value uniformly distributed in the exclusive-inclusive range (min, max]
+         */
+        template<typename T>
+        T uniform(T min, T max) const {
+            return uniformRange(min, max, std::is_integral<T>());
+        }
+
+     private:
+        template<typename T>
+        T uniformRange(T min, T max, std::true_type) const {
+            const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+            if (range == 0)  // Full 64 bit range
+                return static_cast<T>(next());
+            return static_cast<T>(static_cast<int64_t>(min) + static_cast<int64_t>(next() % range));
+        }
+        template<typename T>
+        T uniformRange(T min, T max, std::false_type) const {
+            return static_cast<T>(min + (max - min) * uniform<double>());
+        }
+    };
+    /**
+     * A single message, returned by iterating CPUAgentAPI::MessageIn
+     */
+    class Message {
+     public:
+        Message(const detail::CPUMessageList &_list, unsigned int _index)
+            : list(&_list), index(_index) { }
+        /**
+         * Returns the value of the named message variable
+         */
+        template<typename T>
+        T getVariable(const std::string &variable_name) const {
+            const detail::CPUVariableBuffer &b = detail::getCPUVariableBuffer<T>(list->getReadBuffers(), variable_name, 0, "CPUAgentAPI::Message::getVariable()");
+            return reinterpret_cast<const T *>(b.ptr)[index * b.elements];
+        }
+        /**
+         * Returns the specified element of the named message array variable
+         */
+        template<typename T, unsigned int N>
+        T getVariable(const std::string &variable_name, unsigned int element) const {
+            const detail::CPUVariableBuffer &b = detail::getCPUVariableBuffer<T>(list->getReadBuffers(), variable_name, element, "CPUAgentAPI::Message::getVariable()");
+            return reinterpret_cast<const T *>(b.ptr)[index * b.elements + element];
+        }
+        /**
+         * Returns the index of the message within the message list
+         */
+        unsigned int getIndex() const { return index; }
+        bool operator==(const Message &rhs) const { return index == rhs.index; }
+        bool operator!=(const Message &rhs) const { return index != rhs.index; }
+
+     private:
+        friend class CPUAgentAPI;
+        const detail::CPUMessageList *list;
+        unsigned int index;
+    };
+    /**
+     * Iterator over a contiguous range of messages
+     */
+    class MessageIterator {
+     public:
+        MessageIterator(const detail::CPUMessageList &list, unsigned int index)
+            : message(list, index) { }
+        MessageIterator &operator++() { ++message.index; return *this; }
+        bool operator==(const MessageIterator &rhs) const { return message == rhs.message; }
+        bool operator!=(const MessageIterator &rhs) const { return message != rhs.message; }
+        const Message &operator*() const { return message; }
+        const Message *operator->() const { return &message; }
+
+     private:
+        Message message;
+    };
+    /**
+     * Spatial3D message search, iterates the messages within the 3x3x3 block of bins surrounding the search origin
+     * As with MessageSpatial3D, the user must check the distance of each returned message against the search radius
+     */
+    class SpatialFilter {
+     public:
+        class iterator {
+         public:
+            /**
+             * Constructs the iterator, and advances to the first message in range
+             */
+            iterator(const SpatialFilter &_parent, bool is_end)
+                : parent(&_parent)
+                , strip(is_end ? 9 : -1)
+                , message(*_parent.list, 0)
+                , strip_end(0) {
+                if (!is_end) {
+                    nextStrip();
+                }
+            }
+            iterator &operator++() {
+                if (++message.index >= strip_end)
+                    nextStrip();
+                return *this;
+            }
+            bool operator==(const iterator &rhs) const { return strip == rhs.strip && (strip >= 9 || message == rhs.message); }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            const Message &operator*() const { return message; }
+            const Message *operator->() const { return &message; }
+
+         private:
+            /**
+             * Moves to the next non-empty strip of bins (a strip is the 3 bins which share y and z)
+             */
+            void nextStrip() {
+                const unsigned int *gridDim = parent->list->getGridDim();
+                const auto &pbm = parent->list->getPBM();
+                while (++strip < 9) {
+                    const int y = parent->cell.y + (strip % 3) - 1;
+                    const int z = parent->cell.z + (strip / 3) - 1;
+                    // Skip the strip if it is completely out of bounds
+                    if (y < 0 || z < 0 || y >= static_cast<int>(gridDim[1]) || z >= static_cast<int>(gridDim[2]))
+                        continue;
+                    const unsigned int start_hash = parent->list->getHash({ parent->cell.x - 1, y, z });
+                    const unsigned int end_hash = parent->list->getHash({ parent->cell.x + 1, y, z });
+                    message.index = pbm[start_hash];
+                    strip_end = pbm[end_hash + 1];
+                    if (message.index < strip_end)
+                        return;
+                }
+            }
+            const SpatialFilter *parent;
+            int strip;
+            Message message;
+            unsigned int strip_end;
+        };
+        SpatialFilter(const detail::CPUMessageList &_list, float x, float y, float z)
+            : list(&_list)
+            , cell(_list.getGridPosition(x, y, z)) { }
+        iterator begin() const { return iterator(*this, false); }
+        iterator end() const { return iterator(*this, true); }
+
+     private:
+        const detail::CPUMessageList *list;
+        detail::CPUMessageList::GridPos3D cell;
+    };
+    /**
+     * Message input, brute force iteration is provided via begin()/end()
+     * Spatial3D search is provided via operator()
+     */
+    class MessageIn {
+        friend class CPUAgentAPI;
+        explicit MessageIn(const detail::CPUMessageList *_list)
+            : list(_list) { }
+        const detail::CPUMessageList &getList() const {
+            if (!list) {
+                THROW exception::InvalidOperation("Agent function does not have a message input, in CPUAgentAPI::MessageIn\n");
+            }
+            return *list;
+        }
+        const detail::CPUMessageList *list;
+
+     public:
+        /**
+         * Returns the number of messages in the input message list
+         */
+        unsigned int size() const { return getList().getMessageCount(); }
+        MessageIterator begin() const { return MessageIterator(getList(), 0); }
+        MessageIterator end() const { return MessageIterator(getList(), getList().getMessageCount()); }
+        /**
+         * Returns a filter over the spatial messages which may fall within radius of the search origin
+         * @throws exception::InvalidMessageType If the message input is not MessageSpatial3D
+         */
+        SpatialFilter operator()(float x, float y, float z) const {
+            if (!getList().isSpatial3D()) {
+                THROW exception::InvalidMessageType("Message '%s' is not a MessageSpatial3D, in CPUAgentAPI::MessageIn::operator()\n", getList().getName().c_str());
+            }
+            return SpatialFilter(getList(), x, y, z);
+        }
+    };
+    /**
+     * Message output, each agent writes to it's own slot within the output list
+     */
+    class MessageOut {
+        friend class CPUAgentAPI;
+        explicit MessageOut(detail::CPUMessageList *_list)
+            : list(_list)
+            , index(0) { }
+        detail::CPUMessageList *list;
+        unsigned int index;
+
+     public:
+        /**
+         * Sets a variable within the agent's output message, marking the message as output
+         */
+        template<typename T>
+        void setVariable(const std::string &variable_name, T value) const {
+            setVariable<T, 1>(variable_name, 0, value);
+        }
+        /**
+         * Sets an element of an array variable within the agent's output message, marking the message as output
+         */
+        template<typename T, unsigned int N>
+        void setVariable(const std::string &variable_name, unsigned int element, T value) const {
+            if (!list) {
+                THROW exception::InvalidOperation("Agent function does not have a message output, in CPUAgentAPI::MessageOut::setVariable()\n");
+            }
+            const detail::CPUVariableBuffer &b = detail::getCPUVariableBuffer<T>(list->getOutputBuffers(), variable_name, element, "CPUAgentAPI::MessageOut::setVariable()");
+            reinterpret_cast<T *>(b.ptr)[index * b.elements + element] = value;
+            list->getOutputFlags()[index] = 1;
+        }
+    };
+    /**
+     * Returns the value of the named agent variable
+     * @throws exception::InvalidAgentVar If the variable does not exist
+     * @throws exception::InvalidVarType If the variable is not of type T
+     */
+    template<typename T>
+    T getVariable(const std::string &variable_name) const {
+        const detail::CPUVariableBuffer &b = detail::getCPUVariableBuffer<T>(variables, variable_name, 0, "CPUAgentAPI::getVariable()");
+        return reinterpret_cast<const T *>(b.ptr)[index * b.elements];
+    }
+    /**
+     * Returns the specified element of the named agent array variable
+     * @throws exception::OutOfBoundsException If element exceeds the length of the array variable
+     */
+    template<typename T, unsigned int N>
+    T getVariable(const std::string &variable_name, unsigned int element) const {
+        const detail::CPUVariableBuffer &b = detail::getCPUVariableBuffer<T>(variables, variable_name, element, "CPUAgentAPI::getVariable()");
+        return reinterpret_cast<const T *>(b.ptr)[index * b.elements + element];
+    }
+    /**
+     * Sets the value of the named agent variable
+     */
+    template<typename T>
+    void setVariable(const std::string &variable_name, T value) {
+        setVariable<T, 1>(variable_name, 0, value);
+    }
+    /**
+     * Sets the specified element of the named agent array variable
+     */
+    template<typename T, unsigned int N>
+    void setVariable(const std::string &variable_name, unsigned int element, T value) {
+        if (variable_name == ID_VARIABLE_NAME) {
+            THROW exception::ReservedName("Agent variable '%s' is read only, in CPUAgentAPI::setVariable()\n", variable_name.c_str());
+        }
+        const detail::CPUVariableBuffer &b = detail::getCPUVariableBuffer<T>(variables, variable_name, element, "CPUAgentAPI::setVariable()");
+        reinterpret_cast<T *>(b.ptr)[index * b.elements + element] = value;
+    }
+    /**
+     * Returns the agent's unique identifier
+     */
+    id_t getID() const { return getVariable<id_t>(ID_VARIABLE_NAME); }
+    /**
+     * Returns the current step index, the first step has step index 0
+     */
+    unsigned int getStepCounter() const { return step; }
+
+    const Environment environment;
+    Random random;
+    MessageIn message_in;
+    MessageOut message_out;
+
+ private:
+    /**
+     * @param _variables Column buffers of the executing agent population
+     * @param env Environment properties
+     * @param _seed Seed shared by all agents executing the current agent function
+     * @param _step The current step index
+     * @param in Message input list, or nullptr
+     * @param out Message output list, or nullptr
+     */
+    CPUAgentAPI(const detail::CPUVariableBufferMap &_variables, const std::unordered_map<std::string, util::Any> &env,
+        uint64_t _seed, unsigned int _step, const detail::CPUMessageList *in, detail::CPUMessageList *out)
+        : environment(env)
+        , random()
+        , message_in(in)
+        , message_out(out)
+        , variables(_variables)
+        , seed(_seed)
+        , step(_step)
+        , index(0) { }
+    /**
+     * Binds the API to the agent at the provided index, and reseeds random from the agent's ID
+     */
+    void setIndex(unsigned int _index) {
+        index = _index;
+        message_out.index = _index;
+        random.state = seed ^ (static_cast<uint64_t>(getID()) * 0xD6E8FEB86659FD93ull);
+        // Discard the first value, so that sequential IDs are decorrelated
+        random.next();
+    }
+    const detail::CPUVariableBufferMap &variables;
+    const uint64_t seed;
+    const unsigned int step;
+    unsigned int index;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_CPU_CPUAGENTAPI_H_
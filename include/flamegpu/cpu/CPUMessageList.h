@@ -0,0 +1,175 @@
+#ifndef INCLUDE_FLAMEGPU_CPU_CPUMESSAGELIST_H_
+#define INCLUDE_FLAMEGPU_CPU_CPUMESSAGELIST_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "flamegpu/io/Checkpoint.h"
+#include "flamegpu/model/Variable.h"
+#include "flamegpu/pop/detail/GenericMemoryVector.h"
+#include "flamegpu/runtime/messaging/MessageBruteForce.h"
+
+namespace flamegpu {
+namespace detail {
+
+/**
+ * Raw view of a single variable's column within CPUReferenceSimulation's host storage
+ * The column holds elements * type_size bytes per agent/message
+ */
+struct CPUVariableBuffer {
+    /**
+     * Pointer to the first item of the column
+     */
+    char *ptr;
+    /**
+     * The variable's base type (e.g. float for float[3])
+     */
+    std::type_index type;
+    /**
+     * Number of elements per item, >1 for array variables
+     */
+    unsigned int elements;
+    /**
+     * Size of the base type in bytes
+     */
+    size_t type_size;
+};
+typedef std::unordered_map<std::string, CPUVariableBuffer> CPUVariableBufferMap;
+
+/**
+ * Host storage for a message list, used by CPUReferenceSimulation in place of CUDAMessage
+ * Supports MessageBruteForce and MessageSpatial3D, matching the semantics of their device implementations
+ * Messages output within the same step are appended, the list is truncated by the first output of the following step
+ */
+class CPUMessageList {
+ public:
+    /**
+     * Spatial partitioning grid position
+     */
+    struct GridPos3D {
+        int x, y, z;
+    };
+    /**
+     * @param description The message's description within the model hierarchy
+     * @throws exception::InvalidMessageType If the message type is not supported by the CPU backend
+     */
+    explicit CPUMessageList(const MessageBruteForce::Data &description);
+    /**
+     * Returns the name of the message as defined in the model description
+     */
+    const std::string &getName() const { return name; }
+    /**
+     * Returns the number of messages currently available to be read
+     */
+    unsigned int getMessageCount() const { return message_count; }
+    /**
+     * Returns true if the message list is spatially partitioned (MessageSpatial3D)
+     */
+    bool isSpatial3D() const { return spatial3D; }
+    /**
+     * Prepares the list for an agent function to output up to max_count messages
+     * Each agent writes to the slot matching it's index, messages beyond those output earlier this step
+     * @param max_count The number of agents executing the output function
+     * @param optional If true, slots are only retained if the agent marks them as output
+     */
+    void beginOutput(unsigned int max_count, bool optional);
+    /**
+     * Compacts optional message output and updates the message count
+     */
+    void endOutput();
+    /**
+     * Marks the list to be truncated by the next call to beginOutput()
+     * Called at the end of each step
+     */
+    void truncate() { truncate_flag = true; }
+    /**
+     * Clear all messages
+     */
+    void clear();
+    /**
+     * Column buffers to write output messages to, only valid between beginOutput() and endOutput()
+     * Slot i corresponds to the agent with index i in the executing population
+     */
+    CPUVariableBufferMap &getOutputBuffers() { return output_buffers; }
+    /**
+     * Output flags, one per slot of the current output, only valid between beginOutput() and endOutput()
+     */
+    char *getOutputFlags() { return output_flags.data(); }
+    /**
+     * Column buffers to read messages from
+     * For spatial messages, buildIndex() must have been called since the last output
+     */
+    const CPUVariableBufferMap &getReadBuffers() const { return read_buffers; }
+    /**
+     * Sorts spatial messages by bin and constructs the partition boundary matrix (PBM)
+     * Does nothing if the index is already current or the message list is not spatial
+     */
+    void buildIndex();
+    /**
+     * Writes the messages currently available to read, and the state of the truncate flag, to a checkpoint
+     */
+    void checkpoint(io::Checkpoint::SectionWriter &out) const;
+    /**
+     * Restores the messages and truncate flag written by checkpoint()
+     * @throws exception::InvalidInputFile If the checkpoint's message variables do not match those of the message
+     */
+    void restore(io::Checkpoint::SectionReader &in);
+    /**
+     * Spatial3D only: returns the grid position of the provided location, clamped to the environment bounds
+     */
+    GridPos3D getGridPosition(float x, float y, float z) const;
+    /**
+     * Spatial3D only: returns the linear bin index of the provided grid position
+     */
+    unsigned int getHash(const GridPos3D &pos) const;
+    /**
+     * Spatial3D only: returns the number of bins in each dimension
+     */
+    const unsigned int *getGridDim() const { return gridDim; }
+    /**
+     * Spatial3D only: returns the partition boundary matrix, bin i contains the messages [pbm[i], pbm[i+1])
+     */
+    const std::vector<unsigned int> &getPBM() const { return pbm; }
+
+ private:
+    /**
+     * Rebuilds read_buffers and output_buffers from the current variable storage
+     */
+    void updateBuffers();
+    std::string name;
+    /**
+     * The message's variable definitions
+     */
+    const VariableMap variables;
+    /**
+     * Columnar message storage
+     */
+    std::map<std::string, std::unique_ptr<GenericMemoryVector>> data;
+    CPUVariableBufferMap read_buffers;
+    CPUVariableBufferMap output_buffers;
+    std::vector<char> output_flags;
+    unsigned int message_count;
+    unsigned int output_base;
+    unsigned int output_count;
+    bool output_optional;
+    bool truncate_flag;
+    bool index_dirty;
+    /**
+     * Spatial3D metadata, calculated in the same manner as MessageSpatial3D::CUDAModelHandler
+     */
+    bool spatial3D;
+    float min[3];
+    float environmentWidth[3];
+    float radius;
+    unsigned int gridDim[3];
+    std::vector<unsigned int> pbm;
+};
+
+}  // namespace detail
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_CPU_CPUMESSAGELIST_H_
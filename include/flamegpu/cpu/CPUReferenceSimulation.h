@@ -0,0 +1,394 @@
+#ifndef INCLUDE_FLAMEGPU_CPU_CPUREFERENCESIMULATION_H_
+#define INCLUDE_FLAMEGPU_CPU_CPUREFERENCESIMULATION_H_
+
+#include <array>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/sim/Simulation.h"
+#include "flamegpu/cpu/CPUAgent.h"
+#include "flamegpu/cpu/CPUAgentAPI.h"
+#include "flamegpu/cpu/CPUMessageList.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/util/Any.h"
+#include "flamegpu/util/StringPair.h"
+
+namespace flamegpu {
+
+class HostAPI;
+class LoggingConfig;
+class RandomManager;
+class StepLoggingConfig;
+struct AgentFunctionData;
+struct LayerData;
+struct RunLog;
+namespace util {
+namespace detail {
+class WorkStealingThreadPool;
+}  // namespace detail
+}  // namespace util
+
+/**
+ * Host (CPU) reference implementation of Simulation, for exercising a model's host logic on machines without a CUDA device
+ *
+ * This does not execute the model's FLAMEGPU_AGENT_FUNCTIONs, their bodies are compiled only for the device.
+ * Instead, every agent function (and agent function condition) within the model must be supplied a second time as a host implementation,
+ * written against CPUAgentAPI, and registered with setAgentFunction() (and setAgentFunctionCondition()).
+ * Simulation fails with exception::InvalidAgentFunc if an agent function executed by a layer has not been registered.
+ *
+ * Agent populations are stored per agent state in AgentVector's columnar (SoA) layout, and the registered agent functions are executed
+ * across the agents of a population using a work stealing thread pool.
+ * Layers, agent function conditions, agent death, state transitions, MessageBruteForce and MessageSpatial3D, host functions
+ * and step/exit logging follow the same semantics as CUDASimulation.
+ *
+ * Results are not expected to match CUDASimulation exactly:
+ * - Device random (CPUAgentAPI::random) is generated with a counter based host generator (splitmix64), not curand
+ * - The order in which messages are iterated, and floating point reductions are accumulated, may differ
+ *
+ * The following are rejected, or throw exception::InvalidOperation when used:
+ * - Agent output (agent birth from agent functions)
+ * - Submodels
+ * - Message types other than MessageBruteForce and MessageSpatial3D
+ * - HostAPI::agent() and environment macro properties, as these depend on CUDA specific data structures
+ * @see CUDASimulation
+ */
+class CPUReferenceSimulation : public Simulation {
+ public:
+    /**
+     * Host implementation of an agent function
+     */
+    typedef std::function<AGENT_STATUS(CPUAgentAPI *)> AgentFunction;
+    /**
+     * Host implementation of an agent function condition
+     */
+    typedef std::function<bool(const CPUAgentAPI *)> AgentFunctionCondition;
+    /**
+     * CPU backend specific config
+     */
+    struct Config {
+        /**
+         * Number of threads used to execute agent functions, including the calling thread
+         * If 0, std::thread::hardware_concurrency() is used
+         */
+        unsigned int thread_count = 0;
+        /**
+         * Maximum number of agents per unit of work scheduled to the thread pool
+         * If 0, populations are split into ~4 units of work per thread
+         */
+        unsigned int grain_size = 0;
+    };
+    /**
+     * Initialise the CPU simulation from a model description hierarchy
+     * @param model The model description hierarchy to be executed
+     * @param argc Runtime argument count
+     * @param argv Runtime argument list ptr
+     * @throws exception::InvalidOperation If the model contains submodels, or agent functions with agent output
+     * @throws exception::InvalidMessageType If the model contains a message type which is not supported
+     */
+    explicit CPUReferenceSimulation(const ModelDescription& model, int argc = 0, const char** argv = nullptr);
+    ~CPUReferenceSimulation() override;
+    /**
+     * Registers the host implementation of the named agent function
+     * @param agent_name Name of the agent which owns the agent function
+     * @param function_name Name of the agent function within the model description
+     * @param function Host implementation of the agent function
+     * @throws exception::InvalidAgentFunc If the agent or agent function does not exist
+     */
+    void setAgentFunction(const std::string &agent_name, const std::string &function_name, AgentFunction function);
+    /**
+     * Registers the host implementation of the named agent function's condition
+     * @param agent_name Name of the agent which owns the agent function
+     * @param function_name Name of the agent function within the model description
+     * @param condition Host implementation of the agent function condition
+     * @throws exception::InvalidAgentFunc If the agent or agent function does not exist, or the agent function does not have a condition
+     */
+    void setAgentFunctionCondition(const std::string &agent_name, const std::string &function_name, AgentFunctionCondition condition);
+    /**
+     * Run the simulation's init functions
+     */
+    void initFunctions() override;
+    /**
+     * Steps the simulation once
+     * @return False if an exit condition was triggered
+     */
+    bool step() override;
+    /**
+     * Run the simulation's exit functions
+     */
+    void exitFunctions() override;
+    /**
+     * Execute the simulation until config.steps have been executed, or an exit condition trips
+     * Includes init and exit functions calls.
+     */
+    void simulate() override;
+    /**
+     * Replaces the named agent state's population with the provided population
+     * @param population The agent type and data to replace agents with
+     * @param state_name The agent state to add the agents to
+     * @throws exception::InvalidAgent If the population's agent is not part of this simulation's model
+     * @throws exception::InvalidAgentState If the state does not exist within the agent
+     */
+    void setPopulationData(AgentVector& population, const std::string& state_name = ModelData::DEFAULT_STATE) override;
+    /**
+     * Returns the agent state's population, replacing the contents of the provided population
+     * @param population The agent type and data to fetch
+     * @param state_name The agent state to get the agents from
+     * @throws exception::InvalidAgent If the population's agent is not part of this simulation's model
+     * @throws exception::InvalidAgentState If the state does not exist within the agent
+     */
+    void getPopulationData(AgentVector& population, const std::string& state_name = ModelData::DEFAULT_STATE) override;
+    /**
+     * Update the current value of the named environment property
+     * @param property_name Name of the environment property to be updated
+     * @param value New value for the named environment property
+     * @tparam T Type of the environment property
+     * @throws exception::InvalidEnvProperty If the named environment property does not exist
+     * @throws exception::InvalidEnvPropertyType If the named environment property does not exist with the specified type
+     * @throws exception::ReadOnlyEnvProperty If the named environment property is marked as read-only
+     */
+    template<typename T>
+    void setEnvironmentProperty(const std::string &property_name, const T &value);
+    /**
+     * Update the current value of the named environment property array
+     * @param property_name Name of the environment property to be updated
+     * @param value New value for the named environment property
+     * @tparam T Type of the elements of the environment property array
+     * @tparam N Length of the environment property array
+     */
+    template<typename T, unsigned int N>
+    void setEnvironmentProperty(const std::string &property_name, const std::array<T, N> &value);
+    /**
+     * Return the current value of the named environment property
+     * @param property_name Name of the environment property to be returned
+     * @tparam T Type of the environment property
+     * @throws exception::InvalidEnvProperty If the named environment property does not exist
+     * @throws exception::InvalidEnvPropertyType If the named environment property does not exist with the specified type
+     */
+    template<typename T>
+    T getEnvironmentProperty(const std::string &property_name) const;
+    /**
+     * Return the current value of the named environment property array
+     * @param property_name Name of the environment property to be returned
+     * @tparam T Type of the elements of the environment property array
+     * @tparam N Length of the environment property array
+     */
+    template<typename T, unsigned int N>
+    std::array<T, N> getEnvironmentProperty(const std::string &property_name) const;
+    AgentInterface &getAgent(const std::string &name) override;
+    std::map<std::string, util::Any> getEnvironmentProperties() const override;
+    /**
+     * @return A mutable reference to the cpu model specific configuration struct
+     * @see Simulation::applyConfig() Should be called afterwards to apply changes
+     */
+    Config &CPUConfig();
+    /**
+     * @return An immutable reference to the cpu model specific configuration struct
+     */
+    const Config &getCPUConfig() const;
+    /**
+     * Returns the number of times step() has been called since the simulation was last reset/init
+     */
+    unsigned int getStepCounter() override;
+    /**
+     * Manually resets the step counter
+     */
+    void resetStepCounter() override;
+    /**
+     * Configure which step data should be logged
+     * @param stepConfig The step logging config for the CPUReferenceSimulation
+     * @note This must be for the same model description hierarchy as the CPUReferenceSimulation
+     */
+    void setStepLog(const StepLoggingConfig &stepConfig);
+    /**
+     * Configure which exit data should be logged
+     * @param exitConfig The logging config for the CPUReferenceSimulation
+     * @note This must be for the same model description hierarchy as the CPUReferenceSimulation
+     */
+    void setExitLog(const LoggingConfig &exitConfig);
+    /**
+     * Returns a reference to the current exit log
+     */
+    const RunLog &getRunLog() const override;
+    /**
+     * Get the duration of the last call to simulate() in seconds.
+     */
+    double getElapsedTimeSimulation() const { return elapsedSecondsSimulation; }
+    /**
+     * Get the duration of the last call to initFunctions() in seconds.
+     */
+    double getElapsedTimeInitFunctions() const { return elapsedSecondsInitFunctions; }
+    /**
+     * Get the duration of the last call to exitFunctions() in seconds.
+     */
+    double getElapsedTimeExitFunctions() const { return elapsedSecondsExitFunctions; }
+    /**
+     * Get the duration of each step() since the last call to `reset`
+     */
+    std::vector<double> getElapsedTimeSteps() const { return elapsedSecondsPerStep; }
+    /**
+     * Get the duration of an individual step in seconds.
+     * @param step Index of step, must be less than the number of steps executed.
+     * @throws exception::OutOfBoundsException If step exceeds the number of steps executed
+     */
+    double getElapsedTimeStep(unsigned int step) const;
+
+ protected:
+    /**
+     * Returns the model to a clean state
+     * This clears all agents and message lists, resets environment properties and the step counter, and reseeds host random
+     * @param submodelReset Unused, submodels are not supported by CPUReferenceSimulation
+     */
+    void reset(bool submodelReset) override;
+    void applyConfig_derived() override;
+    bool checkArgs_derived(int argc, const char** argv, int &i) override;
+    void printHelp_derived() override;
+    void resetDerivedConfig() override;
+    /**
+     * Adds the step counter, environment properties, host random state, agent ID counters, message lists and step log to a checkpoint
+     * Agent function random streams are derived from the seed and step counter, so require no further state
+     */
+    void checkpoint_derived(io::Checkpoint &checkpoint) override;
+    void restore_derived(const io::Checkpoint &checkpoint) override;
+
+ private:
+    /**
+     * Executes every agent function within the layer
+     * Agent functions of a layer are executed in sequence, each is itself parallelised across it's population
+     */
+    void stepLayer(const LayerData &layer, unsigned int layer_index);
+    /**
+     * Executes the host functions of the layer, these follow the layer's agent functions
+     */
+    void layerHostFunctions(const LayerData &layer);
+    /**
+     * Executes the model's step functions
+     */
+    void stepStepFunctions();
+    /**
+     * Executes the model's exit conditions
+     * @return True if an exit condition returned EXIT
+     */
+    bool stepExitConditions();
+    /**
+     * Executes an agent function across the population of it's initial state
+     * Applies the agent function condition, agent death and state transition
+     * @param func The agent function to execute
+     * @param seed The random seed shared by all agents executing this function this step
+     */
+    void executeAgentFunction(const AgentFunctionData &func, uint64_t seed);
+    /**
+     * Builds the column buffer map of the provided population
+     */
+    static detail::CPUVariableBufferMap getBuffers(AgentVector &population);
+    /**
+     * Appends the agents of src with the corresponding flag equal to flag_value to dest
+     */
+    static void scatter(const AgentVector &src, const std::vector<char> &flags, char flag_value, AgentVector &dest);
+    /**
+     * Throws if the model contains features which cannot be executed by the CPU backend
+     */
+    void validateModel() const;
+    /**
+     * Initialise the environment property storage from the model description (and any loaded input file)
+     */
+    void initEnvironment();
+    void resetLog();
+    void processStepLog(double step_time_seconds);
+    void processExitLog();
+    /**
+     * Creates the thread pool if it does not exist, or the thread count has changed
+     */
+    void initThreadPool();
+    /**
+     * Assigns IDs to any agents which have not yet been assigned one
+     */
+    void assignAgentIDs();
+    /**
+     * Returns the HostAPI passed to host functions, creating it if required
+     */
+    HostAPI *getHostAPI();
+    /**
+     * Locates a property in the environment store, validating it's type and length
+     */
+    util::Any &getEnvironmentAny(const std::string &property_name, const std::type_index &type, unsigned int elements, const char *caller) const;
+
+    std::unordered_map<std::string, std::unique_ptr<CPUAgent>> agent_map;
+    std::unordered_map<std::string, std::unique_ptr<detail::CPUMessageList>> message_map;
+    /**
+     * Host implementations of agent functions and conditions, keyed by agent_name:function_name
+     */
+    std::map<util::StringPair, AgentFunction> agent_functions;
+    std::map<util::StringPair, AgentFunctionCondition> agent_function_conditions;
+    /**
+     * Current value of each environment property
+     */
+    mutable std::unordered_map<std::string, util::Any> environment;
+    /**
+     * Names of environment properties marked const
+     */
+    std::set<std::string> read_only_properties;
+    std::unique_ptr<util::detail::WorkStealingThreadPool> thread_pool;
+    /**
+     * Random generator used by host functions, seeded from config.random_seed
+     */
+    std::unique_ptr<RandomManager> rng;
+    /**
+     * Passed to host functions, this refers to environment, read_only_properties and rng
+     */
+    std::unique_ptr<HostAPI> host_api;
+    unsigned int step_count;
+    /**
+     * Set false when populations are changed, so that IDs are assigned before the next step
+     */
+    bool agent_ids_have_init;
+    double elapsedSecondsSimulation;
+    double elapsedSecondsInitFunctions;
+    double elapsedSecondsExitFunctions;
+    std::vector<double> elapsedSecondsPerStep;
+    std::shared_ptr<const StepLoggingConfig> step_log_config;
+    std::shared_ptr<const LoggingConfig> exit_log_config;
+    std::unique_ptr<RunLog> run_log;
+    Config cpu_config;
+};
+
+template<typename T>
+void CPUReferenceSimulation::setEnvironmentProperty(const std::string &property_name, const T &value) {
+    util::Any &a = getEnvironmentAny(property_name, std::type_index(typeid(T)), 1, "CPUReferenceSimulation::setEnvironmentProperty()");
+    if (read_only_properties.find(property_name) != read_only_properties.end()) {
+        THROW exception::ReadOnlyEnvProperty("Environment property '%s' is marked as const and cannot be changed, "
+            "in CPUReferenceSimulation::setEnvironmentProperty()\n", property_name.c_str());
+    }
+    memcpy(a.ptr, &value, sizeof(T));
+}
+template<typename T, unsigned int N>
+void CPUReferenceSimulation::setEnvironmentProperty(const std::string &property_name, const std::array<T, N> &value) {
+    util::Any &a = getEnvironmentAny(property_name, std::type_index(typeid(T)), N, "CPUReferenceSimulation::setEnvironmentProperty()");
+    if (read_only_properties.find(property_name) != read_only_properties.end()) {
+        THROW exception::ReadOnlyEnvProperty("Environment property '%s' is marked as const and cannot be changed, "
+            "in CPUReferenceSimulation::setEnvironmentProperty()\n", property_name.c_str());
+    }
+    memcpy(a.ptr, value.data(), sizeof(T) * N);
+}
+template<typename T>
+T CPUReferenceSimulation::getEnvironmentProperty(const std::string &property_name) const {
+    const util::Any &a = getEnvironmentAny(property_name, std::type_index(typeid(T)), 1, "CPUReferenceSimulation::getEnvironmentProperty()");
+    return *static_cast<const T *>(a.ptr);
+}
+template<typename T, unsigned int N>
+std::array<T, N> CPUReferenceSimulation::getEnvironmentProperty(const std::string &property_name) const {
+    const util::Any &a = getEnvironmentAny(property_name, std::type_index(typeid(T)), N, "CPUReferenceSimulation::getEnvironmentProperty()");
+    std::array<T, N> rtn;
+    memcpy(rtn.data(), a.ptr, sizeof(T) * N);
+    return rtn;
+}
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_CPU_CPUREFERENCESIMULATION_H_
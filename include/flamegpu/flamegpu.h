@@ -29,11 +29,14 @@
 #include "flamegpu/pop/AgentVector.h"
 #include "flamegpu/pop/AgentInstance.h"
 #include "flamegpu/gpu/CUDASimulation.h"
+#include "flamegpu/cpu/CPUReferenceSimulation.h"
 #include "flamegpu/runtime/messaging.h"
 #include "flamegpu/runtime/AgentFunction_shim.cuh"
 #include "flamegpu/runtime/AgentFunctionCondition_shim.cuh"
 #include "flamegpu/gpu/CUDAEnsemble.h"
+#include "flamegpu/sim/SampleSpace.h"
 #include "flamegpu/sim/RunPlanVector.h"
+#include "flamegpu/sim/RunPlanScheduler.h"
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/AgentLoggingConfig.h"
 #include "flamegpu/sim/LogFrame.h"
@@ -8,6 +8,7 @@
 #include <mutex>
 #include <unordered_map>
 #include <list>
+#include <tuple>
 
 // include sub classes
 #include "flamegpu/util/detail/JitifyCache.h"
@@ -15,6 +16,7 @@
 #include "flamegpu/model/AgentFunctionData.cuh"
 #include "flamegpu/model/SubAgentData.h"
 #include "flamegpu/runtime/detail/curve/curve_rtc.cuh"
+#include "flamegpu/runtime/detail/curve/curve_table.h"
 #include "flamegpu/sim/AgentInterface.h"
 
 namespace flamegpu {
@@ -66,8 +68,7 @@ class CUDAAgent : public AgentInterface {
      * library so that can be accessed by name within a n agent function
      * @param func The function.
      * @param instance_id The CUDASimulation instance_id of the parent instance. This is added to the hash, to differentiate instances
-     * @note TODO: This could be improved by iterating the variable list within the state_list, rather than individually looking up vars (the two lists should have all the same vars)
-     * @note This should probably be addressed when curve is updated to not use individual memcpys
+     * @note Variable hashes are calculated once per function instance (see getCurveBinding()), subsequent calls only register the current buffers
      */
     void mapRuntimeVariables(const AgentFunctionData& func, const unsigned int &instance_id) const;
     /**
@@ -161,6 +162,15 @@ class CUDAAgent : public AgentInterface {
      * @param stream CUDA stream to be used for async CUDA operations
      */
     void scatterHostCreation(const std::string &state_name, const unsigned int &newSize, char *const d_inBuff, const VarOffsetStruct &offsets, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream);
+    /**
+     * Appends a batch of agents created by HostAgentAPI::newAgents() to the named state
+     * @param state_name The state agents are appended to
+     * @param batch The batch of new agents
+     * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
+     * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
+     * @param stream CUDA stream to be used for async CUDA operations
+     */
+    void appendHostCreation(const std::string &state_name, const HostNewAgentBatch &batch, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream);
     /**
      * Sorts all agent variables according to the positions stored inside Message Output scan buffer
      * @param state_name The state agents are scattered into
@@ -244,6 +254,7 @@ class CUDAAgent : public AgentInterface {
     void initExcludedVars(const std::string& state, const unsigned int& count, const unsigned int& offset, CUDAScatter& scatter, const unsigned int& streamId, const cudaStream_t& stream);
     /**
      * Resets the number of agents in every statelist to 0
+     * This also resets the agent ID counter, so that IDs are next assigned from the first valid ID
      */
     void cullAllStates();
     /**
@@ -283,6 +294,12 @@ class CUDAAgent : public AgentInterface {
      * If the device value is changed, then the internal ID counter must be updated via CUDAAgent::scatterNew()
      */
     id_t* getDeviceNextID();
+    /**
+     * Sets the next free agent id, and marks the IDs of the current agents as assigned
+     * Used when restoring a checkpoint
+     * @param id The next ID to be assigned
+     */
+    void setNextID(id_t id);
     /**
      * Assigns IDs to any agents who's ID has the value ID_NOT_SET
      * @param hostapi HostAPI object, this is used to provide cub temp storage
@@ -372,6 +389,23 @@ class CUDAAgent : public AgentInterface {
      * Mutex for writing to newBuffs
      */
     std::mutex newBuffsMutex;
+    /**
+     * Returns the curve binding of the agent's variables for the named agent function instance, creating it on first use
+     * Entries are in the iteration order of agent_description.variables
+     * @param func The agent function
+     * @param instance_id The CUDASimulation instance_id of the parent instance
+     * @param new_agents If true, the binding is for the function's agent output (new agent) variables
+     */
+    detail::curve::CurveTable::Binding &getCurveBinding(const AgentFunctionData &func, unsigned int instance_id, bool new_agents) const;
+    /**
+     * Curve bindings created by getCurveBinding()
+     * key: {function name, instance id, new agents}
+     */
+    mutable std::map<std::tuple<std::string, unsigned int, bool>, detail::curve::CurveTable::Binding> curveBindings;
+    /**
+     * Mutex for accessing curveBindings
+     */
+    mutable std::mutex curveBindingsMutex;
     /**
      * Nullptr until getPopulationData() is called, after which it holds the return value
      */
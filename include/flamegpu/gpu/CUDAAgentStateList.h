@@ -13,6 +13,7 @@ namespace flamegpu {
 class CUDAScatter;
 struct VarOffsetStruct;
 class CUDAAgent;
+class HostNewAgentBatch;
 
 /**
  * Manages data for an agent state
@@ -95,6 +96,16 @@ class CUDAAgentStateList {
      * @param stream CUDA stream to be used for async CUDA operations
      */
     void scatterHostCreation(const unsigned int &newSize, char *const d_inBuff, const VarOffsetStruct &offsets, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream);
+    /**
+     * Appends a batch of agents created by HostAgentAPI::newAgents() to the end of the state list
+     * Each variable is copied from the batch with a single host to device copy, so no scatter is required
+     * Variables in mapped agents are initialised to their default values
+     * @param batch The batch of agents to append
+     * @param scatter Scatter instance and scan arrays to be used
+     * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
+     * @param stream CUDA stream to be used for async CUDA operations
+     */
+    void appendAgentData(const HostNewAgentBatch &batch, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream);
     /**
      * Sorts all agent variables according to the positions stored inside Message Output scan buffer
      * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
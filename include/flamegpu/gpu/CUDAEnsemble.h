@@ -6,6 +6,7 @@
 #include <set>
 #include <vector>
 
+#include "flamegpu/sim/Profile.h"
 
 namespace flamegpu {
 
@@ -14,6 +15,7 @@ class ModelDescription;
 class RunPlanVector;
 class LoggingConfig;
 class StepLoggingConfig;
+class RunPlanScheduler;
 struct RunLog;
 /**
  * Manager for automatically executing multiple copies of a model simultaneously
@@ -53,6 +55,50 @@ class CUDAEnsemble {
          * This is independent of the EnsembleConfig::quiet
          */
         bool timing = false;
+        /**
+         * If true, each run is profiled, and it's RunLog will contain a Profile of the run's timings
+         * These are aggregated across all runs by getProfile()
+         * @see Simulation::Config::profile
+         */
+        bool profile = false;
+        /**
+         * If set, a timeline of every run, the log export threads and RTC compilation is written to this file
+         * in the Chrome Trace Event format, which can be viewed with chrome://tracing or https://ui.perfetto.dev
+         * Each runner and log export thread is shown as a separate track, and each event records the index of the run it belongs to
+         * @see Simulation::Config::trace_file
+         */
+        std::string trace_file;
+        /**
+         * The interval (in milliseconds) at which recorded trace events are written to trace_file, 0 writes them once simulate() completes
+         * Large ensembles should set this, as events are dropped once a thread's trace buffer is full
+         */
+        unsigned int trace_flush_interval = 0;
+        /**
+         * If true, each concurrent runner creates a single CUDASimulation, which is reset between the runs it executes
+         * rather than being recreated for each run. This avoids repeating per run setup costs (e.g. device allocations,
+         * CURVE registration and RTC compilation), which can dominate ensembles of many short runs.
+         * Between runs, environment properties are returned to their default values before the RunPlan's overrides are applied,
+         * macro properties are zeroed, all agents and messages are removed, the step counter is reset and random is reseeded.
+         */
+        bool reuse_simulations = false;
+        /**
+         * The number of threads used to export logs to out_directory, concurrently with the executing runs
+         */
+        unsigned int export_threads = 1;
+        /**
+         * The maximum number of completed runs which may await export
+         * When this is reached, runners block before starting their next run, until logs have been exported
+         * If 0, the number of runs awaiting export is unlimited
+         */
+        unsigned int export_queue_capacity = 1024;
+        /**
+         * If 0, each run's logs are exported to their own files, within the run's output subdirectory
+         * Otherwise, the logs of all runs are appended to this many files "runs.<shard>.<out_format>" within out_directory,
+         * where a run's shard is its index modulo export_shards. Each run is written as a single record, holding its
+         * config (including run_index), step and exit logs. Output subdirectories of RunPlans are ignored in this mode.
+         * JSON shards hold one record per line, XML shards hold one <log> element per record within a single <runs> root element.
+         */
+        unsigned int export_shards = 0;
     };
     /**
      * Initialise CUDA Ensemble
@@ -100,6 +146,13 @@ class CUDAEnsemble {
      * @note This must be for the same model description hierarchy as the CUDAEnsemble
      */
     void setExitLog(const LoggingConfig &exitConfig);
+    /**
+     * Configure the order in which RunPlans are issued to runners
+     * By default, LongestFirstScheduler is used with LongestFirstScheduler::defaultCost()
+     * @param scheduler The scheduler to be used by subsequent calls to simulate()
+     * @throws exception::InvalidArgument If scheduler is nullptr
+     */
+    void setScheduler(std::shared_ptr<const RunPlanScheduler> scheduler);
     /**
      * Get the duration of the last call to simulate() in milliseconds. 
      */
@@ -108,6 +161,11 @@ class CUDAEnsemble {
      * Return the list of logs collected from the last call to simulate()
      */
     const std::vector<RunLog> &getLogs();
+    /**
+     * Return the profiles of all runs from the last call to simulate(), merged into a single profile
+     * This is empty unless EnsembleConfig::profile was enabled
+     */
+    Profile getProfile() const;
 
  private:
     /**
@@ -130,6 +188,10 @@ class CUDAEnsemble {
      * Exit logging config
      */
     std::shared_ptr<const LoggingConfig> exit_log_config;
+    /**
+     * Decides the order in which RunPlans are executed
+     */
+    std::shared_ptr<const RunPlanScheduler> scheduler;
     /**
      * Logs collected by simulate()
      */
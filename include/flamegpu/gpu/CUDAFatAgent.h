@@ -62,8 +62,9 @@ class CUDAFatAgent {
      * Constructs a new CUDAFatAgent, by creating a statelist for each of the provided agent's states
      * The specified agent becomes fat_index 0
      * @param description The initial agent to be represented by the CUDAFatAgent
+     * @param memory The resource from which agent buffers are allocated
      */
-    explicit CUDAFatAgent(const AgentData& description);
+    CUDAFatAgent(const AgentData& description, std::shared_ptr<util::detail::MemoryResource> memory);
     /**
      * Destructor
      * Frees any buffers allocated for new agents
@@ -173,6 +174,12 @@ class CUDAFatAgent {
      * @note This will fail silently if it called if any state contains agents
      */
     void resetIDCounter();
+    /**
+     * Sets the ID counter (_nextID), and marks the IDs of the current agents as assigned
+     * Used when restoring a checkpoint, where every agent already holds the ID it was assigned prior to the checkpoint
+     * @param id The next ID to be assigned
+     */
+    void setNextID(id_t id);
 
  private:
     /**
@@ -185,6 +192,10 @@ class CUDAFatAgent {
      * This is used when applying operations to all mapped variables at once
      */
     std::set<std::shared_ptr<CUDAFatAgentStateList>> states_unique;
+    /**
+     * The resource from which agent buffers are allocated
+     */
+    const std::shared_ptr<util::detail::MemoryResource> memory;
 
     /**
      * Represents a buffer stored in d_newLists
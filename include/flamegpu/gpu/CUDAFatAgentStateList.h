@@ -10,6 +10,7 @@
 
 #include "flamegpu/model/AgentData.h"
 #include "flamegpu/model/SubAgentData.h"
+#include "flamegpu/util/detail/MemoryResource.h"
 
 namespace flamegpu {
 
@@ -138,8 +139,10 @@ class CUDAFatAgentStateList {
     /**
      * Constructs a new state list with variables from the provided description
      * Memory for buffers is not allocated until resize() is called
+     * @param description The agent whose variables are to be stored
+     * @param memory The resource from which variable buffers are allocated
      */
-    explicit CUDAFatAgentStateList(const AgentData& description);
+    CUDAFatAgentStateList(const AgentData& description, std::shared_ptr<util::detail::MemoryResource> memory);
     /**
      * Copy constructor, this clones an existing CUDAFatAgentStateList
      * However buffers must be uninitialised (bufferLen == 0)
@@ -289,6 +292,10 @@ class CUDAFatAgentStateList {
      * This is a list, however it contains no duplicates
      */
     std::list<std::shared_ptr<VariableBuffer>> variables_unique;
+    /**
+     * The resource from which variable buffers are allocated
+     */
+    const std::shared_ptr<util::detail::MemoryResource> memory;
 };
 
 }  // namespace flamegpu
@@ -14,6 +14,7 @@
 #include "detail/CUDAErrorChecking.cuh"
 #include "flamegpu/runtime/detail/curve/curve.cuh"
 #include "flamegpu/runtime/utility/HostMacroProperty.cuh"
+#include "flamegpu/io/Checkpoint.h"
 
 // forward declare classes from other modules
 
@@ -82,6 +83,10 @@ class CUDAMacroEnvironment {
     const CUDASimulation& cudaSimulation;
     std::map<std::string, MacroEnvProp> properties;
     std::map<std::string, std::weak_ptr<HostMacroProperty_MetaData>> host_cache;
+    /**
+     * Returns CUDASimulation::Config::macro_property_download_tile_bytes of the parent CUDASimulation
+     */
+    size_t getHostDownloadTileBytes() const;
 
  public:
     /**
@@ -112,6 +117,20 @@ class CUDAMacroEnvironment {
      * Clears all CUDA pointers without deallocating, (e.g. if device has been reset)
      */
     void purge();
+    /**
+     * Sets the value of all macro properties owned by this instance back to zero
+     * Mapped (sub) macro properties are owned, and hence reset by, the master model
+     */
+    void reset();
+    /**
+     * Writes the value of all macro properties owned by this instance to a checkpoint
+     */
+    void checkpoint(io::Checkpoint::SectionWriter &out) const;
+    /**
+     * Restores the value of all macro properties owned by this instance from a checkpoint
+     * @throws exception::InvalidInputFile If the checkpoint's macro properties do not match those of the model
+     */
+    void restore(io::Checkpoint::SectionReader &in);
     /**
      * Register the properties to CURVE for use within the passed agent function
      */
@@ -213,7 +232,7 @@ HostMacroProperty<T, I, J, K, W> CUDAMacroEnvironment::getProperty(const std::st
         }
         host_cache.erase(cache);
     }
-    auto ret = std::make_shared<HostMacroProperty_MetaData>(prop->second.d_ptr, prop->second.elements, sizeof(T), read_flag, name);
+    auto ret = std::make_shared<HostMacroProperty_MetaData>(prop->second.d_ptr, prop->second.elements, sizeof(T), read_flag, name, getHostDownloadTileBytes());
     host_cache.emplace(name, ret);
     return HostMacroProperty<T, I, J, K, W>(ret);
 }
@@ -251,7 +270,7 @@ HostMacroProperty_swig<T> CUDAMacroEnvironment::getProperty_swig(const std::stri
         }
         host_cache.erase(cache);
     }
-    auto ret = std::make_shared<HostMacroProperty_MetaData>(prop->second.d_ptr, prop->second.elements, sizeof(T), read_flag, name);
+    auto ret = std::make_shared<HostMacroProperty_MetaData>(prop->second.d_ptr, prop->second.elements, sizeof(T), read_flag, name, getHostDownloadTileBytes());
     host_cache.emplace(name, ret);
     return HostMacroProperty_swig<T>(ret);
 }
@@ -7,6 +7,7 @@
 
 // include sub classes
 #include "flamegpu/gpu/CUDAMessageList.h"
+#include "flamegpu/io/Checkpoint.h"
 #include "flamegpu/runtime/messaging/MessageBruteForce/MessageBruteForceHost.h"
 
 // forward declare classes from other modules
@@ -127,6 +128,20 @@ class CUDAMessage {
      */
     void buildIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream);
     const void *getMetaDataDevicePtr() const;
+    /**
+     * Writes the messages currently available to read, and the state of the message list's flags, to a checkpoint
+     */
+    void checkpoint(io::Checkpoint::SectionWriter &out);
+    /**
+     * Restores the messages and flags written by checkpoint()
+     * If the message list had already been indexed when it was checkpointed, the index is reconstructed
+     * @param in The checkpoint to read from, positioned after the message's name
+     * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
+     * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
+     * @param stream CUDA stream to be used for async CUDA operations
+     * @throws exception::InvalidInputFile If the checkpoint's message variables do not match those of the message
+     */
+    void restore(io::Checkpoint::SectionReader &in, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream);
 
  protected:
     /** 
@@ -3,8 +3,11 @@
 
 #include <string>
 #include <map>
+#include <memory>
 #include <utility>
 
+#include "flamegpu/util/detail/MemoryResource.h"
+
 namespace flamegpu {
 
 class CUDAScatter;
@@ -27,8 +30,12 @@ class CUDAMessageList {
  public:
      /**
       * Initially allocates message lists based on cuda_message.getMaximumListSize()
+      * @param cuda_message Parent which this provides storage for
+      * @param memory The resource from which message list buffers are allocated
+      * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
+      * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
       */
-    explicit CUDAMessageList(CUDAMessage& cuda_message, CUDAScatter &scatter, const unsigned int &streamId);
+    CUDAMessageList(CUDAMessage& cuda_message, std::shared_ptr<util::detail::MemoryResource> memory, CUDAScatter &scatter, const unsigned int &streamId);
     /**
      * Frees all message list memory
      */
@@ -127,6 +134,10 @@ class CUDAMessageList {
      * Parent which this provides storage for
      */
     const CUDAMessage& message;
+    /**
+     * The resource from which message list buffers are allocated
+     */
+    const std::shared_ptr<util::detail::MemoryResource> memory;
 };
 
 }  // namespace flamegpu
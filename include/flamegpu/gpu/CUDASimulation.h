@@ -15,7 +15,10 @@
 #include "flamegpu/gpu/CUDAEnsemble.h"
 #include "flamegpu/runtime/utility/RandomManager.cuh"
 #include "flamegpu/runtime/HostNewAgentAPI.h"
+#include "flamegpu/runtime/HostNewAgentBatch.h"
 #include "flamegpu/gpu/CUDAMacroEnvironment.h"
+#include "flamegpu/util/detail/MemoryResource.h"
+#include "flamegpu/util/detail/CUDAEventProfiler.cuh"
 
 #ifdef VISUALISATION
 #include "flamegpu/visualiser/ModelVis.h"
@@ -82,6 +85,18 @@ class CUDASimulation : public Simulation {
          * Defaults to enabled.
          */
         bool inLayerConcurrency = true;
+        /**
+         * Upper limit on the total size of released device buffers (e.g. agent and message lists) which are retained for reuse
+         * Retained buffers are always released if an allocation would otherwise fail
+         * Defaults to 256 MiB
+         */
+        size_t memory_pool_max_cached_bytes = 256u << 20;
+        /**
+         * Approximate size in bytes of the tiles in which host functions download environment macro properties
+         * Only tiles containing accessed elements are downloaded, and only modified elements are uploaded
+         * Defaults to 0, whereby the whole macro property is downloaded on first access
+         */
+        size_t macro_property_download_tile_bytes = 0;
     };
     /**
      * Initialise cuda runner
@@ -243,6 +258,11 @@ class CUDASimulation : public Simulation {
      * @todo remove? this is mostly internal methods that modeller doesn't need access to
      */
     CUDAMessage& getCUDAMessage(const std::string &message_name) const;
+    /**
+     * Returns the pool from which the simulation's agent, message and temporary device buffers are allocated
+     * @todo remove? this is mostly internal methods that modeller doesn't need access to
+     */
+    const std::shared_ptr<util::detail::PoolMemoryResource> &getDeviceMemory() const { return device_memory; }
     /**
      * @return A mutable reference to the cuda model specific configuration struct
      * @see Simulation::applyConfig() Should be called afterwards to apply changes
@@ -276,6 +296,7 @@ class CUDASimulation : public Simulation {
      * Returns a reference to the current exit log
      */
     const RunLog &getRunLog() const override;
+    std::map<std::string, util::Any> getEnvironmentProperties() const override;
 #ifdef VISUALISATION
     /**
      * Creates (on first call) and returns the visualisation configuration options for this model instance
@@ -351,7 +372,8 @@ class CUDASimulation : public Simulation {
  protected:
     /**
      * Returns the model to a clean state
-     * This clears all agents and message lists, resets environment properties and reseeds random generation.
+     * This clears all agents and message lists, resets environment properties (applying any overrides), zeros macro properties,
+     * resets agent ID counters and reseeds random generation.
      * Also calls resetStepCounter();
      * @param submodelReset This should only be set to true when called automatically when a submodel reaches it's exit condition during execution. This performs a subset of the regular reset procedure.
      * @note If triggered on a submodel, agent states and environment properties mapped to a parent agent, and random generation are not affected.
@@ -380,6 +402,15 @@ class CUDASimulation : public Simulation {
      * @see Simulation::initialise(int, const char**)
      */
     void resetDerivedConfig() override;
+    /**
+     * Adds the step counter, environment and macro properties, random state, agent ID counters, message lists and step log to a checkpoint
+     * @note Submodels are reset each time they are executed, so do not hold state which requires capturing
+     */
+    void checkpoint_derived(io::Checkpoint &checkpoint) override;
+    /**
+     * Restores the state added by checkpoint_derived()
+     */
+    void restore_derived(const io::Checkpoint &checkpoint) override;
 
  private:
     /**
@@ -387,6 +418,20 @@ class CUDASimulation : public Simulation {
      * @param seed New random seed (this updates stored seed in config)
      */
     void reseed(const uint64_t &seed);
+    /**
+     * Sets the environment property overrides, these replace the model's default values each time the environment is initialised or reset
+     * Used by SimRunner to apply the property overrides of a RunPlan, unlike setEnvironmentProperty() these may override properties marked const
+     * @param overrides Map of property name to value, these must match the type and length of the named properties
+     */
+    void setEnvironmentOverrides(const std::unordered_map<std::string, util::Any> &overrides);
+    /**
+     * Writes env_overrides to the environment
+     */
+    void applyEnvironmentOverrides();
+    /**
+     * Environment property overrides set by setEnvironmentOverrides()
+     */
+    std::unordered_map<std::string, util::Any> env_overrides;
     /**
      * Number of times step() has been called since sim was last reset/init
      */
@@ -412,10 +457,24 @@ class CUDASimulation : public Simulation {
      * Vector of per step timing information in seconds
      */
     std::vector<double> elapsedSecondsPerStep;
+    /**
+     * Accumulates the duration of each layer, agent function, host function etc, if Simulation::Config::profile is enabled
+     * This is reset by each call to simulate(), and copied to the RunLog on completion
+     */
+    util::detail::Profiler profiler;
+    /**
+     * Times agent function and agent function condition kernels on behalf of profiler
+     */
+    util::detail::CUDAEventProfiler profiler_events;
     /**
      * Update the step counter for host and device.
      */
     void incrementStepCounter();
+    /**
+     * Pool from which agent, message and temporary device buffers are allocated
+     * Shared with submodels, as their agents may be mapped to agents of this model
+     */
+    std::shared_ptr<util::detail::PoolMemoryResource> device_memory;
     /**
      * Map of agent storage 
      */
@@ -585,8 +644,8 @@ class CUDASimulation : public Simulation {
      */
     std::unique_ptr<HostAPI> host_api;
     /**
-     * Adds any agents stored in agentData to the device
-     * Clears agent storage in agentData
+     * Adds any agents stored in agentData and agentBatches to the device
+     * Clears agent storage in agentData and agentBatches
      * @param streamId Stream index to perform scatter on
      * @note called at the end of step() and after all init/hostLayer functions and exit conditions have finished
      */
@@ -597,6 +656,9 @@ class CUDASimulation : public Simulation {
     typedef std::unordered_map<std::string, AgentDataBuffer> AgentDataBufferStateMap;
     typedef std::unordered_map<std::string, VarOffsetStruct> AgentOffsetMap;
     typedef std::unordered_map<std::string, AgentDataBufferStateMap> AgentDataMap;
+    typedef std::vector<std::unique_ptr<HostNewAgentBatch>> AgentBatchBuffer;
+    typedef std::unordered_map<std::string, AgentBatchBuffer> AgentBatchBufferStateMap;
+    typedef std::unordered_map<std::string, AgentBatchBufferStateMap> AgentBatchMap;
 
  private:
     void assignAgentIDs();
@@ -614,6 +676,10 @@ class CUDASimulation : public Simulation {
      * Storage used by host agent creation before copying data to device at end of each step()
      */
     AgentDataMap agentData;
+    /**
+     * Storage used by host agent batch creation (HostAgentAPI::newAgents()) before copying data to device at end of each step()
+     */
+    AgentBatchMap agentBatches;
     void initOffsetsAndMap();
 #ifdef VISUALISATION
     /**
@@ -0,0 +1,52 @@
+#ifndef INCLUDE_FLAMEGPU_IO_BINARYSTATEWRITER_H_
+#define INCLUDE_FLAMEGPU_IO_BINARYSTATEWRITER_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "flamegpu/io/StateWriter.h"
+#include "flamegpu/model/ModelDescription.h"
+#include "flamegpu/util/StringPair.h"
+
+namespace flamegpu {
+namespace io {
+/**
+ * Binary columnar format (.fgpub) StateWriter
+ * Each environment property and agent variable is written as a single contiguous, aligned block
+ * @see detail::binary_state for a description of the file layout
+ * @note Simulation config is not stored within binary state files
+ */
+class BinaryStateWriter : public StateWriter {
+ public:
+    /**
+     * Returns a writer capable of writing model state to a binary state file
+     * Environment properties from the Simulation instance pointed to by 'sim_instance_id' will be used 
+     * Agent data will be read from 'model_state'
+     * @param model_name Name from the model description hierarchy of the model to be exported
+     * @param sim_instance_id Instance is from the Simulation instance to export the environment properties from
+     * @param model_state Map of AgentVector to read the agent data from per agent, key should be agent name
+     * @param iterations Unused, the step counter is not stored in binary state files
+     * @param output_file Filename of the input file (This will be used to determine which reader to return)
+     * @param sim_instance Instance of the Simulation object (This is used for setting/getting config)
+     */
+    BinaryStateWriter(
+        const std::string &model_name,
+        const unsigned int &sim_instance_id,
+        const util::StringPairUnorderedMap<std::shared_ptr<AgentVector>> &model_state,
+        const unsigned int &iterations,
+        const std::string &output_file,
+        const Simulation *sim_instance);
+    /**
+     * Actually perform the writing to file
+     * @return Always 0
+     * @param prettyPrint Unused, binary state files are not human readable
+     * @throws exception::InvalidFilePath If the output file cannot be written
+     * @throws exception::UnsupportedVarType If an environment property or agent variable has a type which cannot be exported
+     */
+    int writeStates(bool prettyPrint) override;
+};
+}  // namespace io
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_IO_BINARYSTATEWRITER_H_
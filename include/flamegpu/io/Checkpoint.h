@@ -0,0 +1,176 @@
+#ifndef INCLUDE_FLAMEGPU_IO_CHECKPOINT_H_
+#define INCLUDE_FLAMEGPU_IO_CHECKPOINT_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/util/Any.h"
+
+namespace flamegpu {
+namespace io {
+
+/**
+ * Host copy of the complete state of a Simulation, as captured by Simulation::checkpoint()
+ *
+ * The state is held as named sections of opaque bytes, each of which is written and read by the component that owns that state.
+ * A checkpoint file is laid out as follows, all values are stored in the host's native byte order:
+ * > Header: magic, version, byte order mark, model name, section count
+ * > Each section: name, byte count, bytes
+ * > 64-bit FNV-1a hash of all preceding bytes, so that truncated or corrupt files are detected
+ *
+ * Strings are stored as a uint64_t length followed by the characters, without a null terminator.
+ */
+class Checkpoint {
+ public:
+    /**
+     * Appends values to the end of a section
+     */
+    class SectionWriter {
+     public:
+        explicit SectionWriter(std::vector<char> &_data)
+            : data(_data) { }
+        template<typename T>
+        void write(const T &value) {
+            write(&value, sizeof(T));
+        }
+        void write(const void *src, const size_t bytes) {
+            const char *c = static_cast<const char*>(src);
+            data.insert(data.end(), c, c + bytes);
+        }
+        void writeString(const std::string &str) {
+            write<uint64_t>(str.size());
+            write(str.data(), str.size());
+        }
+        /**
+         * Writes the type, element count and data of an Any
+         * @throws exception::UnsupportedVarType If the type is not supported by binary state files
+         */
+        void writeAny(const util::Any &value);
+
+     private:
+        std::vector<char> &data;
+    };
+    /**
+     * Bounds checked sequential reader of a section
+     */
+    class SectionReader {
+     public:
+        SectionReader(const std::vector<char> &_data, const std::string &_section_name)
+            : data(_data)
+            , section_name(_section_name) { }
+        template<typename T>
+        T read() {
+            T rtn;
+            read(&rtn, sizeof(T));
+            return rtn;
+        }
+        void read(void *dest, const size_t bytes) {
+            require(bytes);
+            memcpy(dest, data.data() + pos, bytes);
+            pos += bytes;
+        }
+        std::string readString() {
+            const uint64_t length = read<uint64_t>();
+            require(length);
+            std::string rtn(data.data() + pos, length);
+            pos += length;
+            return rtn;
+        }
+        /**
+         * Reads a value written by SectionWriter::writeAny()
+         */
+        util::Any readAny();
+        /**
+         * @return True if every byte of the section has been read
+         */
+        bool eof() const { return pos == data.size(); }
+
+     private:
+        void require(const uint64_t bytes) const {
+            if (bytes > data.size() - pos) {
+                THROW exception::InvalidInputFile("Checkpoint section '%s' is truncated or corrupt, "
+                    "in Checkpoint::SectionReader::read()\n", section_name.c_str());
+            }
+        }
+        const std::vector<char> &data;
+        const std::string section_name;
+        size_t pos = 0;
+    };
+    /**
+     * Constructs an empty checkpoint
+     * @param model_name Name of the model which the checkpoint represents, this is validated when the checkpoint is restored
+     */
+    explicit Checkpoint(const std::string &model_name);
+    const std::string &getModelName() const { return model_name; }
+    /**
+     * Creates a new, empty, section
+     * @param name Name of the section
+     * @throws exception::InvalidArgument If a section with the same name already exists
+     */
+    SectionWriter newSection(const std::string &name);
+    bool hasSection(const std::string &name) const;
+    /**
+     * @param name Name of the section
+     * @throws exception::InvalidInputFile If the section does not exist
+     */
+    SectionReader getSection(const std::string &name) const;
+    /**
+     * Writes the checkpoint to file
+     * The file is first written alongside path, and then renamed to path, so that an interrupted write never replaces
+     * an existing checkpoint with a partial one
+     * @param path The file to write
+     * @throws exception::InvalidFilePath If the file cannot be written
+     */
+    void save(const std::string &path) const;
+    /**
+     * Reads a checkpoint from file
+     * @param path The file to read
+     * @throws exception::InvalidFilePath If the file cannot be opened
+     * @throws exception::InvalidInputFile If the file is not a checkpoint, or is truncated or corrupt
+     */
+    static std::shared_ptr<Checkpoint> load(const std::string &path);
+
+ private:
+    std::string model_name;
+    std::map<std::string, std::vector<char>> sections;
+};
+
+/**
+ * Writes checkpoints to file on a background thread, so that execution can continue whilst the file is written
+ * Atmost one write is in flight, a new write first waits for the previous write to complete
+ */
+class CheckpointWriter {
+ public:
+    /**
+     * Waits for any write in flight, errors are discarded
+     */
+    ~CheckpointWriter();
+    /**
+     * Begins writing the checkpoint to file on a background thread
+     * @param checkpoint The checkpoint to write, this must not be modified until the write completes
+     * @param path The file to write
+     * @throws Any exception raised by the previous write
+     */
+    void write(std::shared_ptr<const Checkpoint> checkpoint, const std::string &path);
+    /**
+     * Blocks until the write in flight (if any) has completed
+     * @throws Any exception raised by the write
+     */
+    void wait();
+
+ private:
+    std::future<void> pending;
+};
+
+}  // namespace io
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_IO_CHECKPOINT_H_
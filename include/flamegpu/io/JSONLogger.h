@@ -1,10 +1,12 @@
 #ifndef INCLUDE_FLAMEGPU_IO_JSONLOGGER_H_
 #define INCLUDE_FLAMEGPU_IO_JSONLOGGER_H_
 
+#include <climits>
 #include <string>
 #include <typeindex>
 
 #include "flamegpu/io/Logger.h"
+#include "flamegpu/io/StepLogStreamWriter.h"
 #include "flamegpu/util/Any.h"
 
 namespace flamegpu {
@@ -20,6 +22,8 @@ namespace io {
  * JSON format Logger
  */
 class JSONLogger : public Logger{
+    friend class JSONStepLogStreamWriter;
+
  public:
     JSONLogger(const std::string &outPath, bool prettyPrint, bool truncateFile);
     /**
@@ -27,6 +31,11 @@ class JSONLogger : public Logger{
      * @throws May throw exceptions if logging to file failed for any reason
      */
     void log(const RunLog &log, const RunPlan &plan, bool logSteps = true, bool logExit = true, bool logStepTime = false, bool logExitTime = false) const override;
+    /**
+     * Log a runlog to file, using a RunPlan in place of config, and recording the run's index within the ensemble
+     * @throws May throw exceptions if logging to file failed for any reason
+     */
+    void logRun(const RunLog &log, const RunPlan &plan, unsigned int run_index, bool logSteps = true, bool logExit = true, bool logStepTime = false, bool logExitTime = false) const override;
     /**
      * Log a runlog to file, uses config data (random seed) from the RunLog
      * @throws May throw exceptions if logging to file failed for any reason
@@ -36,14 +45,15 @@ class JSONLogger : public Logger{
  private:
     /**
      * Internal logging method, allows Plan to be passed as null
+     * run_index is only written if not UINT_MAX
      */
-    void logCommon(const RunLog &log, const RunPlan *plan, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const;
+    void logCommon(const RunLog &log, const RunPlan *plan, unsigned int run_index, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const;
     /**
      * rapidjson::Writer doesn't have virtual methods, so can't pass rapidjson::PrettyWriter around as ptr to rapidjson::writer
      * Instead we call a templated version of all the methods
      */
     template<typename T>
-    void logCommon(T &writer, const RunLog &log, const RunPlan *plan, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const;
+    void logCommon(T &writer, const RunLog &log, const RunPlan *plan, unsigned int run_index, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const;
     /**
      * Writes out the run config via a JSON object
      * @param writer Rapidjson writer instance
@@ -57,11 +67,12 @@ class JSONLogger : public Logger{
      * Writes out step logs as a JSON array via the provided writer
      * @param writer Rapidjson writer instance
      * @param plan RunPlan containing the config items to be written
+     * @param run_index Index of the run within the ensemble, omitted if UINT_MAX
      * @tparam T Instance of rapidjson::Writer or subclass (e.g. rapidjson::PrettyWriter)
      * @note Templated as can't forward declare rapidjson::Writer<rapidjson::StringBuffer>
      */
     template<typename T>
-    void logConfig(T &writer, const RunPlan &plan) const;
+    void logConfig(T &writer, const RunPlan &plan, unsigned int run_index = UINT_MAX) const;
     /**
      * Writes out step logs as a JSON array via the provided writer
      * @param writer Rapidjson writer instance
@@ -71,6 +82,15 @@ class JSONLogger : public Logger{
      */
     template<typename T>
     void logPerformanceSpecs(T& writer, const RunLog& log) const;
+    /**
+     * Writes out the profiled timings as a JSON object, keyed by region path, via the provided writer
+     * @param writer Rapidjson writer instance
+     * @param log RunLog containing the profile to be written
+     * @tparam T Instance of rapidjson::Writer or subclass (e.g. rapidjson::PrettyWriter)
+     * @note Templated as can't forward declare rapidjson::Writer<rapidjson::StringBuffer>
+     */
+    template<typename T>
+    void logProfile(T& writer, const RunLog& log) const;
     /**
      * Writes out step logs as a JSON array via the provided writer
      * @param writer Rapidjson writer instance
@@ -135,6 +155,29 @@ class JSONLogger : public Logger{
     bool prettyPrint;
     bool truncateFile;
 };
+
+/**
+ * JSON format StepLogStreamWriter
+ * The closed output has the same structure as the step log output by JSONLogger
+ */
+class JSONStepLogStreamWriter : public StepLogStreamWriter {
+ public:
+    JSONStepLogStreamWriter(const std::string &outPath, bool prettyPrint, bool truncateFile, unsigned int flushFrequency);
+
+ protected:
+    void writeHeader(std::string &out, const RunLog &log, bool logTime) const override;
+    void writeFrame(std::string &out, const StepLogFrame &frame, bool logTime) const override;
+    void writeFooter(std::string &out) const override;
+    const char *getFrameSeparator() const override { return ","; }
+    bool isStepsBegin(const std::string &line) const override;
+    bool parseFrame(const std::string &line, unsigned int &step_index) const override;
+
+ private:
+    /**
+     * Provides the serialisation of config and log frames
+     */
+    JSONLogger logger;
+};
 }  // namespace io
 }  // namespace flamegpu
 
@@ -21,6 +21,12 @@ class Logger {
      * @throws May throw exceptions if logging to file failed for any reason
      */
     virtual void log(const RunLog &log, const RunPlan &plan, bool logSteps = true, bool logExit = true, bool logStepTime = false, bool logExitTime = false) const = 0;
+    /**
+     * Log a runlog to file, using a RunPlan in place of config, and recording the run's index within the ensemble
+     * This allows the logs of many runs to be appended to the same file
+     * @throws May throw exceptions if logging to file failed for any reason
+     */
+    virtual void logRun(const RunLog &log, const RunPlan &plan, unsigned int run_index, bool logSteps = true, bool logExit = true, bool logStepTime = false, bool logExitTime = false) const = 0;
     /**
      * Log a runlog to file, uses config data (random seed) from the RunLog
      * @throws May throw exceptions if logging to file failed for any reason
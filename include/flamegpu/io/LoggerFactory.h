@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "flamegpu/io/Logger.h"
+#include "flamegpu/io/StepLogStreamWriter.h"
 #include "flamegpu/io/JSONLogger.h"
 #include "flamegpu/io/XMLLogger.h"
 #include "flamegpu/util/detail/filesystem.h"
@@ -36,6 +37,24 @@ class LoggerFactory {
             "by StateWriterFactory::createLogger().",
             output_path.c_str());
     }
+    /**
+     * @param output_path File for the step log to be output to, this will be used to determine the writer type
+     * @param prettyPrint If false, the output data will be in a compact/minified format which may not be very readable
+     * @param truncateFile If true and output file already exists, it will be truncated
+     * @param flushFrequency The number of step log frames to buffer before they are written to file
+     */
+    static std::unique_ptr<StepLogStreamWriter> createStepLogStreamWriter(const std::string &output_path, bool prettyPrint, bool truncateFile = true, unsigned int flushFrequency = 1) {
+        const std::string extension = util::detail::filesystem::getFileExt(output_path);
+
+        if (extension == "xml") {
+            return std::make_unique<XMLStepLogStreamWriter>(output_path, prettyPrint, truncateFile, flushFrequency);
+        } else if (extension == "json") {
+            return std::make_unique<JSONStepLogStreamWriter>(output_path, prettyPrint, truncateFile, flushFrequency);
+        }
+        THROW exception::UnsupportedFileType("File '%s' is not a type which can be written "
+            "by LoggerFactory::createStepLogStreamWriter().",
+            output_path.c_str());
+    }
 };
 }  // namespace io
 }  // namespace flamegpu
@@ -10,6 +10,7 @@
 #include "flamegpu/io/StateReader.h"
 #include "flamegpu/io/XMLStateReader.h"
 #include "flamegpu/io/JSONStateReader.h"
+#include "flamegpu/io/BinaryStateReader.h"
 #include "flamegpu/util/StringPair.h"
 #include "flamegpu/util/StringUint32Pair.h"
 #include "flamegpu/util/detail/filesystem.h"
@@ -49,6 +50,8 @@ class StateReaderFactory {
             return new XMLStateReader(model_name, env_desc, env_init, model_state, input, sim_instance);
         } else if (extension == "json") {
             return new JSONStateReader(model_name, env_desc, env_init, model_state, input, sim_instance);
+        } else if (extension == "fgpub") {
+            return new BinaryStateReader(model_name, env_desc, env_init, model_state, input, sim_instance);
         }
         THROW exception::UnsupportedFileType("File '%s' is not a type which can be read "
             "by StateReaderFactory::createReader().",
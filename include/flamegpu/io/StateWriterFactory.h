@@ -10,6 +10,7 @@
 #include "flamegpu/io/StateWriter.h"
 #include "flamegpu/io/XMLStateWriter.h"
 #include "flamegpu/io/JSONStateWriter.h"
+#include "flamegpu/io/BinaryStateWriter.h"
 #include "flamegpu/io/JSONLogger.h"
 #include "flamegpu/io/XMLLogger.h"
 #include "flamegpu/util/StringPair.h"
@@ -51,6 +52,8 @@ class StateWriterFactory {
             return new XMLStateWriter(model_name, sim_instance_id, model_state, iterations, output_file, sim_instance);
         } else if (extension == "json") {
             return new JSONStateWriter(model_name, sim_instance_id, model_state, iterations, output_file, sim_instance);
+        } else if (extension == "fgpub") {
+            return new BinaryStateWriter(model_name, sim_instance_id, model_state, iterations, output_file, sim_instance);
         }
         THROW exception::UnsupportedFileType("File '%s' is not a type which can be written "
             "by StateWriterFactory::createWriter().",
@@ -0,0 +1,151 @@
+#ifndef INCLUDE_FLAMEGPU_IO_STEPLOGSTREAMWRITER_H_
+#define INCLUDE_FLAMEGPU_IO_STEPLOGSTREAMWRITER_H_
+
+#include <fstream>
+#include <string>
+
+namespace flamegpu {
+struct RunLog;
+struct StepLogFrame;
+
+namespace io {
+
+/**
+ * Incrementally writes a step log to file, as each StepLogFrame is produced
+ *
+ * Unlike Logger, which serialises a complete RunLog, frames are appended to the file as they are produced.
+ * Frames are buffered in memory until the flush frequency is reached, so memory use is bounded regardless of the number of steps.
+ * Each frame is written to it's own line, so that a partially written log (e.g. after a crash) can be resumed
+ * by discarding any incomplete trailing frame and continuing to append.
+ *
+ * The output of a closed stream can be read in the same manner as the step log output by the corresponding Logger
+ * @see LoggerFactory::createStepLogStreamWriter()
+ */
+class StepLogStreamWriter {
+ public:
+    /**
+     * @param outPath The file to write the step log to
+     * @param prettyPrint If false, the output data will be in a compact/minified format which may not be very readable
+     * @note Step log frames are always written compact, one per line, regardless of prettyPrint
+     * @param truncateFile If true and output file already exists, it will be truncated, otherwise open() will refuse to overwrite it
+     *        (ignored if the stream is resumed)
+     * @param flushFrequency The number of frames to buffer before they are written to file, 0 is treated as 1
+     */
+    StepLogStreamWriter(const std::string &outPath, bool prettyPrint, bool truncateFile, unsigned int flushFrequency);
+    /**
+     * Writes any buffered frames to file
+     * The log is not closed, so it can later be resumed
+     */
+    virtual ~StepLogStreamWriter();
+    /**
+     * Opens the output file, and writes the log's header (config and performance specs)
+     * @param log RunLog containing the config items to be written, step log frames within the RunLog are not written
+     * @param logTime Include step time in each frame written
+     * @param resume If true and the output file contains a partially written step log, any incomplete trailing frame is
+     *        discarded and subsequent frames are appended. Frames with a step index less than or equal to that of the last
+     *        complete frame are skipped by writeStep(). If the output file does not contain a step log, a new log is started.
+     * @throws exception::InvalidOperation If the stream is already open
+     * @throws exception::InvalidFilePath If the output file cannot be opened for writing
+     * @throws exception::InvalidFilePath If resume is false, truncateFile is false and the output file already exists
+     */
+    void open(const RunLog &log, bool logTime, bool resume = false);
+    /**
+     * Appends a frame to the step log
+     * The frame is written to file once flush frequency frames have been buffered
+     * @param frame The frame to be written
+     * @throws exception::InvalidOperation If the stream is not open
+     */
+    void writeStep(const StepLogFrame &frame);
+    /**
+     * Writes all buffered frames to file
+     */
+    void flush();
+    /**
+     * Writes all buffered frames, closes the step log and then closes the output file
+     * Once closed, the stream can not be resumed
+     */
+    void close();
+    /**
+     * Returns true if open() has been called, and close() has not
+     */
+    bool isOpen() const { return out.is_open(); }
+    /**
+     * Returns true if open() resumed a partially written log containing at least one complete frame
+     */
+    bool isResumed() const { return resumed; }
+    /**
+     * Returns the step index of the final complete frame found when the stream was resumed
+     * @note Only valid if isResumed() returns true
+     */
+    unsigned int getResumedStepIndex() const { return resumed_step_index; }
+    /**
+     * Returns the total number of frames within the log, including those found when resumed and those currently buffered
+     */
+    size_t getFrameCount() const { return frame_count; }
+
+ protected:
+    /**
+     * Serialise the log's header, ending with the opening of the step container
+     * The header must not end with a new line, and the final line must be recognised by isStepsBegin()
+     * @param out String to append the header to
+     * @param log RunLog containing the config items to be written
+     * @param logTime If true, performance specs are included in the header
+     */
+    virtual void writeHeader(std::string &out, const RunLog &log, bool logTime) const = 0;
+    /**
+     * Serialise a single frame to a single line
+     * @param out String to append the frame to
+     * @param frame The frame to be written
+     * @param logTime Include step time in the frame written
+     */
+    virtual void writeFrame(std::string &out, const StepLogFrame &frame, bool logTime) const = 0;
+    /**
+     * Serialise the log's footer, which closes the step container and the log
+     * @param out String to append the footer to
+     */
+    virtual void writeFooter(std::string &out) const = 0;
+    /**
+     * Returns the string written between consecutive frames, before the new line
+     */
+    virtual const char *getFrameSeparator() const = 0;
+    /**
+     * Returns true if line is the final line of a header produced by writeHeader()
+     * @param line A line of a previously written log, with surrounding whitespace removed
+     */
+    virtual bool isStepsBegin(const std::string &line) const = 0;
+    /**
+     * Parses a line previously written by writeFrame()
+     * @param line A line of a previously written log, with surrounding whitespace and any trailing frame separator removed
+     * @param step_index Returns the step index of the frame
+     * @return True if line contains a complete frame
+     */
+    virtual bool parseFrame(const std::string &line, unsigned int &step_index) const = 0;
+
+    const std::string out_path;
+    const bool prettyPrint;
+    const bool truncateFile;
+
+ private:
+    /**
+     * Scans a previously written log for the last complete frame, and truncates the file after it
+     * @return True if the file contained a step log which can be appended to
+     */
+    bool resumeFile();
+
+    const unsigned int flush_frequency;
+    /**
+     * Frames not yet written to file
+     */
+    std::string buffer;
+    unsigned int buffered_frames = 0;
+    size_t frame_count = 0;
+    bool log_time = false;
+    bool resumed = false;
+    unsigned int resumed_step_index = 0;
+    std::ofstream out;
+};
+
+}  // namespace io
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_IO_STEPLOGSTREAMWRITER_H_
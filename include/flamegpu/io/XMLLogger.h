@@ -1,10 +1,12 @@
 #ifndef INCLUDE_FLAMEGPU_IO_XMLLOGGER_H_
 #define INCLUDE_FLAMEGPU_IO_XMLLOGGER_H_
 
+#include <climits>
 #include <string>
 #include <typeindex>
 
 #include "flamegpu/io/Logger.h"
+#include "flamegpu/io/StepLogStreamWriter.h"
 #include "flamegpu/util/Any.h"
 
 namespace tinyxml2 {
@@ -26,6 +28,8 @@ namespace io {
  * XML format Logger
  */
 class XMLLogger : public Logger{
+    friend class XMLStepLogStreamWriter;
+
  public:
     XMLLogger(const std::string &outPath, bool prettyPrint, bool truncateFile);
     /**
@@ -33,6 +37,11 @@ class XMLLogger : public Logger{
      * @throws May throw exceptions if logging to file failed for any reason
      */
     void log(const RunLog &log, const RunPlan &plan, bool logSteps = true, bool logExit = true, bool logStepTime = false, bool logExitTime = false) const override;
+    /**
+     * Log a runlog to file, using a RunPlan in place of config, and recording the run's index within the ensemble
+     * @throws May throw exceptions if logging to file failed for any reason
+     */
+    void logRun(const RunLog &log, const RunPlan &plan, unsigned int run_index, bool logSteps = true, bool logExit = true, bool logStepTime = false, bool logExitTime = false) const override;
     /**
      * Log a runlog to file, uses config data (random seed) from the RunLog
      * @throws May throw exceptions if logging to file failed for any reason
@@ -42,8 +51,9 @@ class XMLLogger : public Logger{
  private:
     /**
      * Internal logging method, allows Plan to be passed as null
+     * run_index is only written if not UINT_MAX
      */
-    void logCommon(const RunLog &log, const RunPlan *plan, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const;
+    void logCommon(const RunLog &log, const RunPlan *plan, unsigned int run_index, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const;
     /**
      * Writes out the run config via a JSON object to the provided node
      * @param doc tinyxml2 document used for allocating the new element
@@ -55,9 +65,10 @@ class XMLLogger : public Logger{
      * Writes out RunPlan configuration (and environment overrides) as a JSON array to the provided node
      * @param doc tinyxml2 document used for allocating the new element
      * @param plan RunPlan containing the config items to be written
+     * @param run_index Index of the run within the ensemble, omitted if UINT_MAX
      * @return The created XMLNode, the calling method will then add it to the main XML hierarchy
      */
-    tinyxml2::XMLNode *logConfig(tinyxml2::XMLDocument &doc, const RunPlan &plan) const;
+    tinyxml2::XMLNode *logConfig(tinyxml2::XMLDocument &doc, const RunPlan &plan, unsigned int run_index = UINT_MAX) const;
     /**
      * Writes out performance specifications as a JSON array to the provided node
      * @param doc tinyxml2 document used for allocating the new element
@@ -65,6 +76,13 @@ class XMLLogger : public Logger{
      * @return The created XMLNode, the calling method will then add it to the main XML hierarchy
      */
     tinyxml2::XMLNode* logPerformanceSpecs(tinyxml2::XMLDocument& doc, const RunLog& log) const;
+    /**
+     * Writes out the profiled timings as a list of regions to the provided node
+     * @param doc tinyxml2 document used for allocating the new element
+     * @param log RunLog containing the profile to be written
+     * @return The created XMLNode, the calling method will then add it to the main XML hierarchy
+     */
+    tinyxml2::XMLNode* logProfile(tinyxml2::XMLDocument& doc, const RunLog& log) const;
     /**
      * Writes out step logs as a JSON array to the provided node
      * @param doc tinyxml2 document used for allocating the new element
@@ -119,6 +137,29 @@ class XMLLogger : public Logger{
     bool prettyPrint;
     bool truncateFile;
 };
+
+/**
+ * XML format StepLogStreamWriter
+ * The closed output has the same structure as the step log output by XMLLogger
+ */
+class XMLStepLogStreamWriter : public StepLogStreamWriter {
+ public:
+    XMLStepLogStreamWriter(const std::string &outPath, bool prettyPrint, bool truncateFile, unsigned int flushFrequency);
+
+ protected:
+    void writeHeader(std::string &out, const RunLog &log, bool logTime) const override;
+    void writeFrame(std::string &out, const StepLogFrame &frame, bool logTime) const override;
+    void writeFooter(std::string &out) const override;
+    const char *getFrameSeparator() const override { return ""; }
+    bool isStepsBegin(const std::string &line) const override;
+    bool parseFrame(const std::string &line, unsigned int &step_index) const override;
+
+ private:
+    /**
+     * Provides the serialisation of config and log frames
+     */
+    XMLLogger logger;
+};
 }  // namespace io
 }  // namespace flamegpu
 
@@ -0,0 +1,206 @@
+#ifndef INCLUDE_FLAMEGPU_IO_DETAIL_BINARYSTATEFORMAT_H_
+#define INCLUDE_FLAMEGPU_IO_DETAIL_BINARYSTATEFORMAT_H_
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <typeindex>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/util/StringPair.h"
+
+namespace flamegpu {
+namespace io {
+namespace detail {
+
+/**
+ * Definitions shared by BinaryStateWriter and BinaryStateReader
+ *
+ * A binary state file (.fgpub) is laid out as follows, all values are stored in the host's native byte order:
+ * > FileHeader
+ * > Layout, environment_count environment property records, followed by population_count population records.
+ *   Each population record (agent name, state name, agent count, column count) is followed by it's column records.
+ *   Each column record is (name, type code, type size, elements, data offset)
+ * > Data, one contiguous block per environment property and per agent variable, each aligned to BLOCK_ALIGNMENT bytes
+ *
+ * Strings are stored as a uint32_t length followed by the characters, without a null terminator.
+ */
+namespace binary_state {
+/**
+ * Identifies the file type, the trailing bytes are reserved
+ */
+static const char MAGIC[8] = {'F', 'G', 'P', 'U', 'B', '\0', '\0', '\0'};
+/**
+ * Incremented whenever the layout changes
+ */
+static const uint32_t VERSION = 1;
+/**
+ * Written in native byte order, so that files produced on a host with different endianness are detected
+ */
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+/**
+ * Alignment of each data block within the file, so that the memory mapped columns are suitably aligned for any type
+ */
+static const uint64_t BLOCK_ALIGNMENT = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    /**
+     * Hash of the model name, and the name, type and length of every environment property and agent variable
+     * @see hashLayout()
+     */
+    uint64_t model_hash;
+    uint32_t environment_count;
+    uint32_t population_count;
+    /**
+     * Size of the layout section which follows the header
+     */
+    uint64_t layout_bytes;
+};
+/**
+ * Portable identifiers for the supported variable types
+ */
+enum TypeCode : uint32_t {
+    Unsupported = 0, Float, Double, Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Char
+};
+/**
+ * Layout of a single environment property or agent variable
+ */
+struct ColumnLayout {
+    uint32_t type;
+    uint32_t type_size;
+    uint32_t elements;
+};
+/**
+ * map<name, layout>
+ */
+typedef std::map<std::string, ColumnLayout> ColumnLayoutMap;
+
+/**
+ * Returns the TypeCode for the provided type, or TypeCode::Unsupported
+ */
+inline TypeCode toTypeCode(const std::type_index &type) {
+    if (type == std::type_index(typeid(float))) return Float;
+    if (type == std::type_index(typeid(double))) return Double;
+    if (type == std::type_index(typeid(int8_t))) return Int8;
+    if (type == std::type_index(typeid(uint8_t))) return UInt8;
+    if (type == std::type_index(typeid(int16_t))) return Int16;
+    if (type == std::type_index(typeid(uint16_t))) return UInt16;
+    if (type == std::type_index(typeid(int32_t))) return Int32;
+    if (type == std::type_index(typeid(uint32_t))) return UInt32;
+    if (type == std::type_index(typeid(int64_t))) return Int64;
+    if (type == std::type_index(typeid(uint64_t))) return UInt64;
+    if (type == std::type_index(typeid(char))) return Char;
+    return Unsupported;
+}
+/**
+ * Returns the type represented by a TypeCode, or typeid(void) if the TypeCode is not recognised
+ */
+inline std::type_index fromTypeCode(const uint32_t code) {
+    switch (code) {
+    case Float: return std::type_index(typeid(float));
+    case Double: return std::type_index(typeid(double));
+    case Int8: return std::type_index(typeid(int8_t));
+    case UInt8: return std::type_index(typeid(uint8_t));
+    case Int16: return std::type_index(typeid(int16_t));
+    case UInt16: return std::type_index(typeid(uint16_t));
+    case Int32: return std::type_index(typeid(int32_t));
+    case UInt32: return std::type_index(typeid(uint32_t));
+    case Int64: return std::type_index(typeid(int64_t));
+    case UInt64: return std::type_index(typeid(uint64_t));
+    case Char: return std::type_index(typeid(char));
+    default: return std::type_index(typeid(void));
+    }
+}
+/**
+ * 64-bit FNV-1a hash
+ */
+inline uint64_t hashBytes(const void *data, size_t length, uint64_t hash = 0xcbf29ce484222325ull) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+inline uint64_t hashString(const std::string &str, uint64_t hash) {
+    const uint32_t length = static_cast<uint32_t>(str.size());
+    return hashBytes(str.data(), str.size(), hashBytes(&length, sizeof(uint32_t), hash));
+}
+inline uint64_t hashColumns(const ColumnLayoutMap &columns, uint64_t hash) {
+    for (const auto &c : columns) {
+        hash = hashString(c.first, hash);
+        hash = hashBytes(&c.second.type, sizeof(uint32_t), hash);
+        hash = hashBytes(&c.second.type_size, sizeof(uint32_t), hash);
+        hash = hashBytes(&c.second.elements, sizeof(uint32_t), hash);
+    }
+    return hash;
+}
+/**
+ * Hash of a model's state layout, used to confirm that a file was produced by the same model
+ * @param model_name Name of the model
+ * @param environment Layout of each environment property
+ * @param populations Layout of each agent state's variables
+ */
+inline uint64_t hashLayout(const std::string &model_name, const ColumnLayoutMap &environment, const std::map<util::StringPair, ColumnLayoutMap> &populations) {
+    uint64_t hash = hashString(model_name, hashBytes(MAGIC, sizeof(MAGIC)));
+    hash = hashColumns(environment, hash);
+    for (const auto &p : populations) {
+        hash = hashString(p.first.first, hash);
+        hash = hashString(p.first.second, hash);
+        hash = hashColumns(p.second, hash);
+    }
+    return hash;
+}
+/**
+ * Returns offset rounded up to the next multiple of BLOCK_ALIGNMENT
+ */
+inline uint64_t alignOffset(uint64_t offset) {
+    return (offset + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+}
+/**
+ * Bounds checked sequential reader of the layout section
+ */
+class LayoutReader {
+ public:
+    LayoutReader(const char *_data, size_t _length, const std::string &_file_path)
+        : data(_data)
+        , length(_length)
+        , file_path(_file_path) { }
+    template<typename T>
+    T read() {
+        require(sizeof(T));
+        T rtn;
+        memcpy(&rtn, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return rtn;
+    }
+    std::string readString() {
+        const uint32_t str_length = read<uint32_t>();
+        require(str_length);
+        std::string rtn(data + pos, str_length);
+        pos += str_length;
+        return rtn;
+    }
+
+ private:
+    void require(size_t bytes) const {
+        if (pos + bytes > length) {
+            THROW exception::InvalidInputFile("Binary state file '%s' is truncated or corrupt, "
+                "in BinaryStateReader::parse()\n", file_path.c_str());
+        }
+    }
+    const char *data;
+    const size_t length;
+    size_t pos = 0;
+    const std::string &file_path;
+};
+}  // namespace binary_state
+}  // namespace detail
+}  // namespace io
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_IO_DETAIL_BINARYSTATEFORMAT_H_
@@ -8,6 +8,7 @@
 
 #include "flamegpu/model/Variable.h"
 #include "flamegpu/model/ModelData.h"
+#include "flamegpu/runtime/messaging/MessageSortingType.h"
 #include "flamegpu/defines.h"
 
 namespace flamegpu {
@@ -68,6 +69,10 @@ struct AgentData : std::enable_shared_from_this<AgentData> {
      * Sort the agent every sortPeriod steps. 0 means no sorting.
      */
     unsigned int sortPeriod;
+    /**
+     * The key by which agents are ordered when they are spatially sorted
+     */
+    SpatialSortOrder sortOrder;
     /**
      * Check whether any agent functions within the ModelDescription hierarchy output agents of this type
      * @return true if this type of agent is created by any agent functions
@@ -283,6 +283,20 @@ class AgentDescription {
      * @param sortPeriod Sort this agent every sortPeriod steps. A value of 0 means no sorting will take place
      */
     void setSortPeriod(const unsigned int sortPeriod);
+    /**
+     * Set the order in which agents are placed when they are spatially sorted. Default value is SpatialSortOrder::RowMajor.
+     * Morton and Hilbert orders place agents within neighbouring bins of the message grid closer together in memory,
+     * which improves the cache locality of spatial message iteration (particularly for MessageSpatial3D).
+     * @param sortOrder The order in which agents are sorted
+     * @note If the message grid has more than 1024 bins per axis (3D) or 65536 bins per axis (2D), neighbouring bins are
+     *       coarsened together so that the curve index fits within 32 bits
+     * @see AgentDescription::setSortPeriod()
+     */
+    void setSortOrder(SpatialSortOrder sortOrder);
+    /**
+     * @return The order in which agents are placed when they are spatially sorted
+     */
+    SpatialSortOrder getSortOrder() const;
 
  private:
     /**
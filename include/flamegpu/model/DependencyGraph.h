@@ -51,6 +51,9 @@ class DependencyGraph {
     bool validateDependencyGraph();
     /**
      * Generates optimal layers based on the dependencies specified and adds them to the model
+     * Nodes are visited in topological order and each is packed into the first layer, following the layers of its dependencies,
+     * which it does not conflict with (e.g. agent functions sharing an agent state or message list). This runs in linear time with
+     * respect to the size of the graph, excluding conflict checks.
      * @param model The model the layers should be added to
      * @throws exception::InvalidDependencyGraph if the model already has layers attached
      */
@@ -72,19 +75,16 @@ class DependencyGraph {
      */
     std::vector<DependencyNode*> roots;
     /**
-     * Used internally for cycle checking
+     * Returns every node reachable from the roots, each node is visited once in breadth first order
      */
-    std::vector<DependencyNode*> functionStack;
+    std::vector<DependencyNode*> getReachableNodes() const;
     /**
-     * Used internally for cycle checking
+     * Sorts the nodes reachable from the roots into waves using Kahn's algorithm
+     * Each node is placed in the wave following that of its last dependency, so the wave index is the node's minimum layer depth
+     * @param waves Output, the nodes of each wave
+     * @returns False if the graph contains a cycle, in which case waves will not contain the nodes of the cycle
      */
-    bool doesFunctionExistInStack(DependencyNode* function);
-    /**
-     * Check the subtree from a node is valid
-     * @param node the root of the subtree
-     * @returns True if the subtree is valid
-     */
-    bool validateSubTree(DependencyNode* node);
+    bool buildTopologicalWaves(std::vector<std::vector<DependencyNode*>>& waves) const;
     /**
      * Issues a warning if the graph is missing agent functions which are present in the model this dependency graph is attached to
      */
@@ -15,7 +15,15 @@ class AgentInstance;
 class AgentDescription;
 class AgentVector_CAgent;
 class AgentVector_Agent;
+template<typename T>
+class AgentVector_CColumn;
+template<typename T>
+class AgentVector_Column;
 struct AgentData;
+namespace io {
+class BinaryStateReader;
+class BinaryStateWriter;
+}  // namespace io
 
 /**
  * Vector of agent data for a single type of Agent
@@ -33,8 +41,23 @@ class AgentVector {
      * Can't include CUDAAgentStateList to friend the specific method.
      */
     friend class CUDAAgentStateList;
+    /**
+     * CPUReferenceSimulation operates directly on the columnar storage when executing agent functions
+     */
+    friend class CPUReferenceSimulation;
+    /**
+     * Populations are captured and restored by Simulation::checkpoint() and Simulation::restore() a column at a time
+     */
+    friend class Simulation;
+    /**
+     * Binary state files are read/written a column at a time, directly from the columnar storage
+     */
+    friend class io::BinaryStateReader;
+    friend class io::BinaryStateWriter;
     friend class AgentVector_CAgent;
     friend class AgentVector_Agent;
+    template<typename T>
+    friend class AgentVector_Column;
 
  public:
     typedef unsigned int size_type;
@@ -46,6 +69,16 @@ class AgentVector {
      * View into the AgentVector to provide immutable access to a specific Agent's data
      */
     typedef AgentVector_CAgent CAgent;
+    /**
+     * Contiguous mutable view of a single variable of every agent within the AgentVector
+     */
+    template<typename T>
+    using Column = AgentVector_Column<T>;
+    /**
+     * Contiguous immutable view of a single variable of every agent within the AgentVector
+     */
+    template<typename T>
+    using CColumn = AgentVector_CColumn<T>;
     typedef std::map<std::string, std::unique_ptr<detail::GenericMemoryVector>> AgentDataMap;
 
     // They might all be wrong
@@ -271,6 +304,20 @@ class AgentVector {
     const T* data(const std::string &variable_name) const;
     void* data(const std::string& variable_name);
     const void* data(const std::string& variable_name) const;
+    /**
+     * Returns a contiguous view of the named variable of every agent in the vector
+     * Unlike data(), changes made via the view's bulk operations are tracked per range, rather than assuming the whole variable has changed
+     * @param variable_name Name of the variable to view
+     * @throws exception::ReservedName If variable_name begins with '_' (mutable version only)
+     * @throws exception::InvalidAgentVar Agent does not contain variable variable_name
+     * @throws exception::InvalidVarType Agent variable variable_name is not of type T
+     * @note For array variables T is the array's element type, and the view holds size() * elements values
+     * @note The view is invalidated by any operation which changes the size or capacity of the vector
+     */
+    template<typename T>
+    Column<T> column(const std::string &variable_name);
+    template<typename T>
+    CColumn<T> column(const std::string &variable_name) const;
 
     // Iterators
     /**
@@ -552,6 +599,13 @@ class AgentVector {
      * Returns the initial state of the internal agent description
      */
     std::string getInitialState() const;
+#ifdef SWIG
+    /**
+     * Returns shared ownership of the variable buffers, so that Python buffer views remain valid after the vector is deleted
+     * Operations which reallocate the buffers whilst ownership is shared, leave the shared buffers intact and copy the data to new buffers
+     */
+    std::shared_ptr<const void> py_shareData() const { return _data; }
+#endif
 
  protected:
     /**
@@ -579,6 +633,13 @@ class AgentVector {
      * @note This is not called in conjunction with _insert() or _erase()
      */
     virtual void _changedAfter(const std::string &variable_name, size_type pos) { }
+    /**
+     * Useful for notifying changes to a range of agents, by bulk operations (e.g. AgentVector::Column::fill())
+     * @param variable_name Name of the variable that has been changed
+     * @param first The first index that has been changed
+     * @param last The index after the last index that has been changed
+     */
+    virtual void _changedRange(const std::string &variable_name, size_type first, size_type last) { }
     /**
      * Notify any subclasses that a variable is about to be accessed, to allow it's data to be synced
      * Should be called by operations which update variables (e.g. AgentVector::Agent::getVariable())
@@ -622,6 +683,7 @@ class AgentVector {
 
 // @todo - why is this include part way down?
 #include "flamegpu/pop/AgentVector_Agent.h"
+#include "flamegpu/pop/AgentVector_Column.h"
 
 namespace flamegpu {
 
@@ -678,6 +740,58 @@ const T* AgentVector::data(const std::string& variable_name) const {
     }
     return nullptr;
 }
+template<typename T>
+AgentVector::Column<T> AgentVector::column(const std::string& variable_name) {
+    if (!variable_name.empty() && variable_name[0] == '_') {
+        THROW exception::ReservedName("Agent variable names that begin with '_' are reserved for internal usage and cannot be changed directly, "
+            "in AgentVector::column().");
+    }
+    // Is variable name found
+    const auto &var = agent->variables.find(variable_name);
+    if (var == agent->variables.end()) {
+        THROW exception::InvalidAgentVar("Variable with name '%s' was not found in agent '%s', "
+            "in AgentVector::column().",
+            variable_name.c_str(), agent->name.c_str());
+    }
+    if (std::type_index(typeid(T)) != var->second.type) {
+        THROW exception::InvalidVarType("Variable '%s' is of a different type. "
+            "'%s' was expected, but '%s' was requested,"
+            "in AgentVector::column().",
+            variable_name.c_str(), var->second.type.name(), typeid(T).name());
+    }
+    _requireLength();
+    // Does the map have a vector
+    const auto& map_it = _data->find(variable_name);
+    if (map_it != _data->end()) {
+        _require(variable_name);
+        return Column<T>(this, variable_name, static_cast<T*>(map_it->second->getDataPtr()), _size, var->second.elements);
+    }
+    return Column<T>(this, variable_name, nullptr, 0, var->second.elements);
+}
+template<typename T>
+AgentVector::CColumn<T> AgentVector::column(const std::string& variable_name) const {
+    // Is variable name found
+    const auto &var = agent->variables.find(variable_name);
+    if (var == agent->variables.end()) {
+        THROW exception::InvalidAgentVar("Variable with name '%s' was not found in agent '%s', "
+            "in AgentVector::column().",
+            variable_name.c_str(), agent->name.c_str());
+    }
+    if (std::type_index(typeid(T)) != var->second.type) {
+        THROW exception::InvalidVarType("Variable '%s' is of a different type. "
+            "'%s' was expected, but '%s' was requested,"
+            "in AgentVector::column().",
+            variable_name.c_str(), var->second.type.name(), typeid(T).name());
+    }
+    _requireLength();
+    // Does the map have a vector
+    const auto& map_it = _data->find(variable_name);
+    if (map_it != _data->end()) {
+        _require(variable_name);
+        return CColumn<T>(variable_name, static_cast<T*>(map_it->second->getDataPtr()), _size, var->second.elements);
+    }
+    return CColumn<T>(variable_name, nullptr, 0, var->second.elements);
+}
 
 template<class InputIt>
 AgentVector::iterator AgentVector::insert(const_iterator pos, InputIt first, InputIt last) {
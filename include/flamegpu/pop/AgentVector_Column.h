@@ -0,0 +1,208 @@
+#ifndef INCLUDE_FLAMEGPU_POP_AGENTVECTOR_COLUMN_H_
+#define INCLUDE_FLAMEGPU_POP_AGENTVECTOR_COLUMN_H_
+
+/**
+ * THIS CLASS SHOULD NOT BE INCLUDED DIRECTLY
+ * Include flamegpu/pop/AgentVector.h instead
+ * Use AgentVector::CColumn<T> instead of AgentVector_CColumn<T>
+ * Use AgentVector::Column<T> instead of AgentVector_Column<T>
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "flamegpu/pop/AgentVector.h"
+
+namespace flamegpu {
+
+/**
+ * const contiguous view of a single variable of every agent within an AgentVector
+ *
+ * Values are stored agent-major, so for an array variable the value of element j of agent i is found at index i * getElements() + j
+ * As with iterators, the view is invalidated by any operation which changes the size or capacity of the AgentVector
+ */
+template<typename T>
+class AgentVector_CColumn {
+    friend class AgentVector;
+
+ public:
+    typedef AgentVector::size_type size_type;
+    typedef T value_type;
+    typedef const T* const_iterator;
+    /**
+     * Returns the number of values in the column, this is the number of agents multiplied by getElements()
+     */
+    size_type size() const { return _agent_count * _elements; }
+    /**
+     * Returns the number of agents covered by the column
+     */
+    size_type getAgentCount() const { return _agent_count; }
+    /**
+     * Returns the number of elements per agent, this is greater than 1 for array variables
+     */
+    unsigned int getElements() const { return _elements; }
+    /**
+     * Returns the name of the variable represented by the column
+     */
+    const std::string &getVariableName() const { return _variable_name; }
+    /**
+     * Returns the value at index pos
+     * @throws exception::OutOfBoundsException If pos >= size()
+     */
+    const T &at(size_type pos) const {
+        if (pos >= size()) {
+            THROW exception::OutOfBoundsException("pos (%u) exceeds length of column (%u), "
+                "in AgentVector::CColumn::at()\n", pos, size());
+        }
+        return _ptr[pos];
+    }
+    /**
+     * Returns the value at index pos, without bounds checking
+     */
+    const T &operator[](size_type pos) const { return _ptr[pos]; }
+    const T *data() const { return _ptr; }
+    const_iterator begin() const { return _ptr; }
+    const_iterator end() const { return _ptr + size(); }
+    const_iterator cbegin() const { return _ptr; }
+    const_iterator cend() const { return _ptr + size(); }
+    /**
+     * Copies count values, beginning at offset, to dest
+     * @throws exception::OutOfBoundsException If offset + count > size()
+     */
+    void copyTo(T *dest, size_type count, size_type offset = 0) const {
+        checkRange(offset, offset + count, "copyTo");
+        if (count)
+            memcpy(dest, _ptr + offset, count * sizeof(T));
+    }
+    /**
+     * Returns a copy of the column's values
+     */
+    std::vector<T> toVector() const {
+        return std::vector<T>(begin(), end());
+    }
+
+ protected:
+    AgentVector_CColumn(const std::string &variable_name, T *ptr, size_type agent_count, unsigned int elements)
+        : _variable_name(variable_name)
+        , _ptr(ptr)
+        , _agent_count(agent_count)
+        , _elements(elements) { }
+    /**
+     * @throws exception::OutOfBoundsException If the range [first, last) is not within the column
+     */
+    void checkRange(size_type first, size_type last, const char *caller) const {
+        if (first > last || last > size()) {
+            THROW exception::OutOfBoundsException("Range [%u, %u) exceeds length of column (%u), "
+                "in AgentVector::Column::%s()\n", first, last, size(), caller);
+        }
+    }
+    const std::string _variable_name;
+    T *const _ptr;
+    const size_type _agent_count;
+    const unsigned int _elements;
+};
+/**
+ * Mutable contiguous view of a single variable of every agent within an AgentVector
+ *
+ * Bulk operations notify the AgentVector of the changed range once per call, rather than once per value,
+ * so that a DeviceAgentVector only copies the changed range of the variable back to the device.
+ */
+template<typename T>
+class AgentVector_Column : public AgentVector_CColumn<T> {
+    friend class AgentVector;
+
+ public:
+    typedef AgentVector::size_type size_type;
+    using AgentVector_CColumn<T>::size;
+    using AgentVector_CColumn<T>::data;
+    /**
+     * Sets every value in the column to value
+     */
+    void fill(const T &value) {
+        fill(0, size(), value);
+    }
+    /**
+     * Sets the values in the range [first, last) to value
+     * @throws exception::OutOfBoundsException If the range is not within the column
+     */
+    void fill(size_type first, size_type last, const T &value) {
+        this->checkRange(first, last, "fill");
+        std::fill(this->_ptr + first, this->_ptr + last, value);
+        markChanged(first, last);
+    }
+    /**
+     * Copies count values from src into the column, beginning at offset
+     * @throws exception::OutOfBoundsException If offset + count > size()
+     */
+    void copyFrom(const T *src, size_type count, size_type offset = 0) {
+        this->checkRange(offset, offset + count, "copyFrom");
+        if (count)
+            memcpy(this->_ptr + offset, src, count * sizeof(T));
+        markChanged(offset, offset + count);
+    }
+    void copyFrom(const std::vector<T> &src, size_type offset = 0) {
+        copyFrom(src.data(), static_cast<size_type>(src.size()), offset);
+    }
+    /**
+     * Replaces each value in the range [first, last) with fn(value)
+     * @param fn Callable with signature T(const T&)
+     * @throws exception::OutOfBoundsException If the range is not within the column
+     */
+    template<typename Fn>
+    void transform(size_type first, size_type last, Fn fn) {
+        this->checkRange(first, last, "transform");
+        std::transform(this->_ptr + first, this->_ptr + last, this->_ptr + first, fn);
+        markChanged(first, last);
+    }
+    template<typename Fn>
+    void transform(Fn fn) {
+        transform(0, size(), fn);
+    }
+    /**
+     * Replaces each value in the range [first, last) with fn(index)
+     * @param fn Callable with signature T(size_type), receives the index of the value within the column
+     * @throws exception::OutOfBoundsException If the range is not within the column
+     */
+    template<typename Fn>
+    void generate(size_type first, size_type last, Fn fn) {
+        this->checkRange(first, last, "generate");
+        for (size_type i = first; i < last; ++i)
+            this->_ptr[i] = fn(i);
+        markChanged(first, last);
+    }
+    template<typename Fn>
+    void generate(Fn fn) {
+        generate(0, size(), fn);
+    }
+    /**
+     * Returns a mutable pointer to the values in the range [first, last)
+     * The range is marked as changed immediately, so the pointer should only be used to update values within the range
+     * @throws exception::OutOfBoundsException If the range is not within the column
+     */
+    T *data(size_type first, size_type last) {
+        this->checkRange(first, last, "data");
+        markChanged(first, last);
+        return this->_ptr + first;
+    }
+
+ private:
+    AgentVector_Column(AgentVector *parent, const std::string &variable_name, T *ptr, size_type agent_count, unsigned int elements)
+        : AgentVector_CColumn<T>(variable_name, ptr, agent_count, elements)
+        , _parent(parent) { }
+    /**
+     * Notify the parent AgentVector of the agents covered by the range of values [first, last)
+     */
+    void markChanged(size_type first, size_type last) {
+        if (first < last) {
+            const unsigned int elements = this->_elements;
+            _parent->_changedRange(this->_variable_name, first / elements, (last + elements - 1) / elements);
+        }
+    }
+    AgentVector *const _parent;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_POP_AGENTVECTOR_COLUMN_H_
@@ -11,6 +11,7 @@
 
 #include "flamegpu/pop/AgentVector.h"
 #include "flamegpu/gpu/CUDAFatAgentStateList.h"  // VariableBuffer
+#include "flamegpu/util/detail/DirtyRangeSet.h"
 
 namespace flamegpu {
 
@@ -55,6 +56,12 @@ class DeviceAgentVector_impl : protected AgentVector {
       * Copies changed agent data back to device
       */
     void syncChanges();
+    /**
+     * Returns the ranges of agents [first, last), whose value of the named variable will be copied back to the device by the next syncChanges()
+     * @param variable_name Name of the variable
+     * @note This is empty if the variable has not been changed since the last sync
+     */
+    std::vector<util::detail::DirtyRangeSet::Range> getChangedRanges(const std::string &variable_name) const;
     /**
      * Clears the local cache, so data is re-downloaded from the device when next required
      */
@@ -87,6 +94,11 @@ class DeviceAgentVector_impl : protected AgentVector {
      */
     using AgentVector::back;
     // using AgentVector::data; // Would need to assume whole vector changed
+    /**
+     * Returns a contiguous view of the named variable of every agent
+     * Changes made via the view's bulk operations are tracked per range, so only the changed ranges are copied back to the device
+     */
+    using AgentVector::column;
     /**
      * Forward iterator access to the start of the vector
      */
@@ -217,6 +229,12 @@ class DeviceAgentVector_impl : protected AgentVector {
     using AgentVector::pop_back;
     using AgentVector::resize;
     // using AgentVector::swap; // This would essentially require replacing the entire on-device agent vector
+#ifdef SWIG
+    /**
+     * Python buffer view ownership
+     */
+    using AgentVector::py_shareData;
+#endif
 
  protected:
     /**
@@ -239,6 +257,13 @@ class DeviceAgentVector_impl : protected AgentVector {
      * @param pos The first index that has been changed
      */
     void _changedAfter(const std::string& variable_name, size_type pos) override;
+    /**
+     * Useful for notifying changes to a range of agents, by bulk operations (e.g. AgentVector::Column::fill())
+     * @param variable_name Name of the variable that has been changed
+     * @param first The first index that has been changed
+     * @param last The index after the last index that has been changed
+     */
+    void _changedRange(const std::string& variable_name, size_type first, size_type last) override;
     /**
      * Notify this that a variable is about to be accessed, to allow it's data to be synced
      * Should be called by operations which update variables (e.g. AgentVector::Agent::getVariable())
@@ -258,10 +283,10 @@ class DeviceAgentVector_impl : protected AgentVector {
      */
     void _requireLength() const override;
     /**
-     * Store information regarding which variables have been changed
+     * Store information regarding which ranges of each variable have been changed
      * This map is built as changes come in, it is empty if no changes have been made
      */
-    std::map<std::string, std::pair<size_type, size_type>> change_detail;
+    std::map<std::string, util::detail::DirtyRangeSet> change_detail;
     /**
      * Variables included here require data to be updated from the device
      * @note Mutable, because it must be updated by _requires(), _requiresAll() which are const
@@ -3,8 +3,10 @@
 
 #include <cuda_runtime.h>  // required for cudaStream_t. This doesn't require nvcc however, as no device code.
 #include <string>
+#include <memory>
 #include <utility>
 #include <functional>
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -13,11 +15,15 @@
 #include "flamegpu/runtime/utility/HostEnvironment.cuh"
 #include "flamegpu/runtime/HostAPI_macros.h"
 #include "flamegpu/runtime/HostNewAgentAPI.h"
+#include "flamegpu/runtime/HostNewAgentBatch.h"
+#include "flamegpu/util/Any.h"
+#include "flamegpu/util/detail/MemoryResource.h"
 
 namespace flamegpu {
 
 class CUDAScatter;
 class CUDASimulation;
+class Simulation;
 class HostAgentAPI;
 class CUDAMacroEnvironment;
 
@@ -42,6 +48,9 @@ class HostAPI {
     typedef std::unordered_map<std::string, AgentDataBuffer> AgentDataBufferStateMap;
     typedef std::unordered_map<std::string, VarOffsetStruct> AgentOffsetMap;
     typedef std::unordered_map<std::string, AgentDataBufferStateMap> AgentDataMap;
+    typedef std::vector<std::unique_ptr<HostNewAgentBatch>> AgentBatchBuffer;
+    typedef std::unordered_map<std::string, AgentBatchBuffer> AgentBatchBufferStateMap;
+    typedef std::unordered_map<std::string, AgentBatchBufferStateMap> AgentBatchMap;
 
     /**
      * Initailises pointers to 0
@@ -52,15 +61,30 @@ class HostAPI {
           CUDAScatter &scatter,
           const AgentOffsetMap &agentOffsets,
           AgentDataMap &agentData,
+          AgentBatchMap &agentBatches,
           CUDAMacroEnvironment &macro_env,
           const unsigned int &streamId,
          cudaStream_t stream);
+    /**
+     * Constructor for CPUReferenceSimulation
+     * Environment properties are accessed within the provided host property store
+     * agent() and environment macro properties are not available, as CPUReferenceSimulation does not hold agent populations on the device
+     * @param _simulation The simulation, used to access the step counter
+     * @param rng The simulation's host random generator
+     * @param env_properties The simulation's environment property store
+     * @param env_read_only Names of the environment properties marked const
+     */
+     HostAPI(Simulation &_simulation,
+          RandomManager &rng,
+          std::unordered_map<std::string, util::Any> &env_properties,
+          const std::set<std::string> &env_read_only);
     /**
      * Frees held device memory
      */
      ~HostAPI();
     /**
      * Returns methods that work on all agents of a certain type currently in a given state
+     * @throws exception::InvalidOperation If called from a CPUReferenceSimulation
      */
     HostAgentAPI agent(const std::string &agent_name, const std::string &stateName = ModelData::DEFAULT_STATE);
     /**
@@ -107,7 +131,25 @@ class HostAPI {
     void resizeTempStorage(const CUB_Config &cc, const unsigned int &items, const size_t &newSize);
     template<typename T>
     void resizeOutputSpace(const unsigned int &items = 1);
-    CUDASimulation &agentModel;
+    /**
+     * Members which refer to CUDASimulation's device storage are null when constructed for CPUReferenceSimulation
+     * This must be called before any of them are accessed
+     * @param caller Name of the calling method, used in the exception message
+     * @throws exception::InvalidOperation If constructed for CPUReferenceSimulation
+     */
+    void requireDevice(const char *caller) const;
+    /**
+     * The simulation which owns this HostAPI
+     */
+    Simulation &simulation;
+    /**
+     * nullptr if constructed for CPUReferenceSimulation
+     */
+    CUDASimulation *const agentModel;
+    /**
+     * The resource from which temporary device buffers are allocated (CUDASimulation::getDeviceMemory())
+     */
+    const std::shared_ptr<util::detail::MemoryResource> memory;
     void *d_cub_temp;
     size_t d_cub_temp_size;
     void *d_output_space;
@@ -123,10 +165,17 @@ class HostAPI {
      * when new agents are copied to device.
      */
     AgentDataMap &agentData;
+    /*
+     * Owned by CUDASimulation, this provides storage for batches of new agents
+     * Used for host agent batch creation, this should be emptied end of each step
+     * when new agents are copied to device.
+     */
+    AgentBatchMap &agentBatches;
     /**
      * Cuda scatter singleton
+     * nullptr if constructed for CPUReferenceSimulation
      */
-    CUDAScatter &scatter;
+    CUDAScatter *const scatter;
     /**
      * Stream index for stream-specific resources
      */
@@ -139,11 +188,12 @@ class HostAPI {
 
 template<typename T>
 void HostAPI::resizeOutputSpace(const unsigned int &items) {
+    requireDevice("HostAPI::resizeOutputSpace()");
     if (sizeof(T) * items > d_output_space_size) {
         if (d_output_space_size) {
-            gpuErrchk(cudaFree(d_output_space));
+            memory->deallocate(d_output_space);
         }
-        gpuErrchk(cudaMalloc(&d_output_space, sizeof(T) * items));
+        d_output_space = memory->allocateOrThrow(sizeof(T) * items);
         d_output_space_size = sizeof(T) * items;
     }
 }
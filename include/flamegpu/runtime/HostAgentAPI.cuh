@@ -118,13 +118,15 @@ class HostAgentAPI {
     * @param _stateName Name of the agent state to be represented
     * @param _agentOffsets Layout of memory within the Host Agent Birth data structure (_newAgentData)
     * @param _newAgentData Structure containing agents birthed via Host Agent Birth
+    * @param _newAgentBatches Structure containing batches of agents birthed via Host Agent Birth
     */
-    HostAgentAPI(HostAPI &_api, AgentInterface &_agent, const std::string &_stateName, const VarOffsetStruct &_agentOffsets, HostAPI::AgentDataBuffer&_newAgentData)
+    HostAgentAPI(HostAPI &_api, AgentInterface &_agent, const std::string &_stateName, const VarOffsetStruct &_agentOffsets, HostAPI::AgentDataBuffer&_newAgentData, HostAPI::AgentBatchBuffer &_newAgentBatches)
         : api(_api)
         , agent(_agent)
         , stateName(_stateName)
         , agentOffsets(_agentOffsets)
-        , newAgentData(_newAgentData) { }
+        , newAgentData(_newAgentData)
+        , newAgentBatches(_newAgentBatches) { }
     /**
      * Copy constructor
      * Not actually sure this is required
@@ -135,6 +137,7 @@ class HostAgentAPI {
         , stateName(other.stateName)
         , agentOffsets(other.agentOffsets)
         , newAgentData(other.newAgentData)
+        , newAgentBatches(other.newAgentBatches)
     { }
     /**
      * Creates a new agent in the current agent and returns an object for configuring it's member variables
@@ -143,6 +146,16 @@ class HostAgentAPI {
      * as it batches agent creation to a single scatter kernel if possible (e.g. no data dependencies).
      */
     HostNewAgentAPI newAgent();
+    /**
+     * Creates count new agents in the current agent and returns a batch, whose variables are set via typed column views
+     *
+     * This is more efficient than newAgent() for creating many agents, as it avoids a per agent allocation and per variable lookup,
+     * and the batch is appended to the agent state with a single copy per variable, without a scatter kernel.
+     * Agents are default initialised, and assigned consecutive IDs.
+     * @param count The number of agents to create
+     * @note The returned batch is invalidated at the end of the host function's layer, when it is appended to the agent state
+     */
+    HostNewAgentBatch &newAgents(unsigned int count);
     /*
      * Returns the number of agents in this state
      */
@@ -334,6 +347,11 @@ class HostAgentAPI {
      * @see newAgent()
      */
     HostAPI::AgentDataBuffer& newAgentData;
+    /**
+     * Columnar data store for efficient host agent batch creation
+     * @see newAgents()
+     */
+    HostAPI::AgentBatchBuffer& newAgentBatches;
 };
 
 //
@@ -629,7 +647,7 @@ void HostAgentAPI::sort(const std::string &variable, Order order, int beginBit,
         population->syncChanges();
     }
     const unsigned int streamId = 0;
-    auto &scatter = api.agentModel.singletons->scatter;
+    auto &scatter = api.agentModel->singletons->scatter;
     auto &scan = scatter.Scan();
     // Check variable is valid
     const auto &agentDesc = agent.getAgentDescription();
@@ -676,7 +694,7 @@ void HostAgentAPI::sort(const std::string &variable, Order order, int beginBit,
         gpuErrchk(cub::DeviceRadixSort::SortPairsDescending(api.d_cub_temp, api.d_cub_temp_size, keys_in, keys_out, vals_in, vals_out, agentCount, beginBit, endBit));
     }
     // Scatter all agent variables
-    api.agentModel.agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, 0);  // @todo use a per simulation stream?
+    api.agentModel->agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, 0);  // @todo use a per simulation stream?
     if (population) {
         // If the user has a DeviceAgentVector out, purge cache so it redownloads new data on next use
         population->purgeCache();
@@ -692,7 +710,7 @@ void HostAgentAPI::sort(const std::string &variable1, Order order1, const std::s
         population->syncChanges();
     }
     const unsigned int streamId = 0;
-    auto &scatter = api.agentModel.singletons->scatter;
+    auto &scatter = api.agentModel->singletons->scatter;
     auto &scan = scatter.Scan();
     const auto &agentDesc = agent.getAgentDescription();
     {  // Check variable 1 is valid
@@ -774,7 +792,7 @@ void HostAgentAPI::sort(const std::string &variable1, Order order1, const std::s
         gpuErrchkLaunch();
     }
     // Scatter all agent variables
-    api.agentModel.agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, 0);  // @todo - use simulation specific stream.
+    api.agentModel->agent_map.at(agentDesc.name)->scatterSort(stateName, scatter, streamId, 0);  // @todo - use simulation specific stream.
 
     if (population) {
         // If the user has a DeviceAgentVector out, purge cache so it redownloads new data on next use
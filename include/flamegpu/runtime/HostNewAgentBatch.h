@@ -0,0 +1,58 @@
+#ifndef INCLUDE_FLAMEGPU_RUNTIME_HOSTNEWAGENTBATCH_H_
+#define INCLUDE_FLAMEGPU_RUNTIME_HOSTNEWAGENTBATCH_H_
+
+#include <string>
+
+#include "flamegpu/pop/AgentVector.h"
+
+namespace flamegpu {
+
+class CUDAAgentStateList;
+
+/**
+ * A batch of agents created by a host function via HostAgentAPI::newAgents()
+ *
+ * Agent variables are stored as contiguous columns, which the user fills via column<T>(), rather than setting each variable
+ * of each agent individually. Agents are default initialised, and are assigned consecutive IDs on creation.
+ * At the end of the host function's layer, each column is copied to the device with a single copy, appending the batch to the agent state.
+ * @note Batches are not visible to DeviceAgentVector, or HostAgentAPI::count(), until they have been appended to the agent state
+ */
+class HostNewAgentBatch : protected AgentVector {
+    /**
+     * Requires access to the AgentVector for CUDAAgentStateList::appendAgentData()
+     */
+    friend class CUDAAgentStateList;
+
+ public:
+    template<typename T>
+    using Column = AgentVector::Column<T>;
+    template<typename T>
+    using CColumn = AgentVector::CColumn<T>;
+    /**
+     * Creates a batch of count default initialised agents
+     * @param agent_desc Description of the agent being created
+     * @param count The number of agents in the batch
+     * @param first_id The ID assigned to the first agent, subsequent agents are assigned consecutive IDs
+     */
+    HostNewAgentBatch(const AgentData &agent_desc, size_type count, id_t first_id);
+    HostNewAgentBatch(const HostNewAgentBatch &) = delete;
+    HostNewAgentBatch &operator=(const HostNewAgentBatch &) = delete;
+    /**
+     * Returns the number of agents in the batch
+     */
+    using AgentVector::size;
+    /**
+     * Returns a contiguous view of the named variable of every agent in the batch
+     * @see AgentVector::column()
+     */
+    using AgentVector::column;
+    /**
+     * Returns the ID which was assigned to the agent at index
+     * @throws exception::OutOfBoundsException If index >= size()
+     */
+    id_t getID(size_type index) const;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_RUNTIME_HOSTNEWAGENTBATCH_H_
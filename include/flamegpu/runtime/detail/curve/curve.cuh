@@ -19,6 +19,8 @@
 #ifndef __CUDACC_RTC__
 #include <mutex>
 #include <shared_mutex>
+
+#include "flamegpu/runtime/detail/curve/curve_table.h"
 #endif
 
 #include "flamegpu/exception/FLAMEGPUDeviceException.cuh"
@@ -77,7 +79,7 @@ class Curve {
     /**
      *  Function for getting a handle (hash table index) to a cuRVE variable from a variable string hash
      *
-     *  Function performs hash collision avoidance using linear probing.
+     *  Function performs hash collision avoidance using linear probing, bounded by the table's max probe distance.
      *
      *  @param variable_hash A cuRVE variable string hash from variableHash.
      *  @return Variable Handle for the cuRVE variable.
@@ -119,7 +121,7 @@ class Curve {
      * Copy host structures to device
      *
      * This function copies the host hash table to the device, it must be used prior to launching agent functions (and agent function conditions) if Curve has been updated.
-     * 4 memcpys to device are always performed, CURVE does not track whether it has been changed internally.
+     * Only the slots changed since the previous call are copied, along with the max probe distance.
      */
     __host__ void updateDevice();
     /**
@@ -139,6 +141,25 @@ class Curve {
      */
     template <unsigned int N>
     __host__ void unregisterVariable(const char(&variableName)[N]);
+#ifndef __CUDACC_RTC__
+    /**
+     * Register every variable of a binding, recording the slot assigned to each
+     *
+     * Bindings are built once at setup (e.g. per agent function instance), so that the group can be registered each layer
+     * without hashing variable names or probing the hash table to unregister them.
+     * @param binding The binding to register
+     * @param d_ptrs Device pointer to each variable's buffer, in the same order as binding.variables
+     * @param length Number of items in each variable's buffer
+     * @see CurveTable::bind()
+     */
+    __host__ void bind(CurveTable::Binding &binding, void *const *d_ptrs, unsigned int length);
+    /**
+     * Unregister every variable of a binding, using the slots recorded when it was bound
+     * @param binding The binding to unregister
+     * @see CurveTable::unbind()
+     */
+    __host__ void unbind(CurveTable::Binding &binding);
+#endif
 
     /**
      * Device function for getting the index of a variable of given name within the Curve hashtable buffers
@@ -465,7 +486,7 @@ class Curve {
     template <typename T, unsigned int N, unsigned int M>
     __device__ __forceinline__ static void setNewAgentArrayVariable(const char(&variableName)[M], VariableHash namespace_hash, T variable, unsigned int variable_index, unsigned int array_index);
 
-    static const int MAX_VARIABLES = 1024;          // !< Default maximum number of cuRVE variables (must be a power of 2)
+    static const int MAX_VARIABLES = 1024;          // !< Default maximum number of cuRVE variables (must be a power of 2, and match CurveTable::MAX_VARIABLES)
     static const VariableHash EMPTY_FLAG = 0;
     static const VariableHash DELETED_FLAG = 1;
 
@@ -585,13 +606,11 @@ class Curve {
      */
     template <typename T, unsigned int N, unsigned int M>
     __device__ __forceinline__ static void setArrayVariable(const char(&variableName)[M], VariableHash namespace_hash, T variable, unsigned int variable_index, unsigned int array_index);
-    VariableHash h_hashes[MAX_VARIABLES];         // Host array of the hash values of registered variables
-    void* h_d_variables[MAX_VARIABLES];           // Host array of pointer to device memory addresses for variable storage
-    size_t h_sizes[MAX_VARIABLES];                // Host array of the sizes of registered variable types (Note: RTTI not supported in CUDA so this is the best we can do for now)
-    unsigned int h_lengths[MAX_VARIABLES];        // Host array of the length of registered variables (i.e: vector length)
     bool deviceInitialised;                       // Flag indicating that curve has/hasn't been initialised yet on a device.
+    unsigned int h_max_probe;                     // Value of d_max_probe currently on the device
 
 #ifndef __CUDACC_RTC__
+    CurveTable table;                             // Host copy of the hash table (hashes, device pointers, sizes and lengths of registered variables)
     /**
      * Managed multi-threaded access to the internal storage
      * All read-only methods take a shared-lock
@@ -659,6 +678,7 @@ namespace detail {
     extern __device__ char* d_variables[Curve::MAX_VARIABLES];                // Device array of pointer to device memory addresses for variable storage
     extern __constant__ size_t d_sizes[Curve::MAX_VARIABLES];                // Device array of the types of registered variables
     extern __constant__ unsigned int d_lengths[Curve::MAX_VARIABLES];
+    extern __constant__ unsigned int d_max_probe;                              // Greatest distance of any registered variable from its home slot
 }  // namespace detail
 
 
@@ -706,9 +726,10 @@ __host__ void Curve::unregisterVariable(const char(&variableName)[N]) {
 /**
 * Device side class implementation
 */
-/* loop unrolling of hash collision detection */
+/* hash collision detection, bounded by the max probe distance of the table (0 whilst there are no collisions) */
 __device__ __forceinline__ Curve::Variable Curve::getVariable(const VariableHash variable_hash) {
-    for (unsigned int x = 0; x< MAX_VARIABLES; x++) {
+    const unsigned int max_probe = curve::detail::d_max_probe;
+    for (unsigned int x = 0; x <= max_probe; x++) {
         const Variable i = ((variable_hash + x) & (MAX_VARIABLES - 1));
         const VariableHash h = curve::detail::d_hashes[i];
         if (h == variable_hash)
@@ -134,9 +134,10 @@ class CurveRTCHost {
      * @param type The name of the property's type (%std::type_index::name())
      * @param type_size The type size of the property's base type (sizeof()), this is the size of a single element if the property is an array property.
      * @param elements The number of elements in the property (1 unless the property is an array property)
+     * @param indirect If true, the RTC cache holds a pointer to the property's data in device global memory, rather than the data itself
      * @throws exception::UnknownInternalError If an environment property with the same name is already registered
      */
-    void registerEnvVariable(const char* propertyName, ptrdiff_t offset, const char* type, size_t type_size, unsigned int elements = 1);
+    void registerEnvVariable(const char* propertyName, ptrdiff_t offset, const char* type, size_t type_size, unsigned int elements = 1, bool indirect = false);
     /**
      * Unregister an environment property, so that it is nolonger included in the dynamic header
      * @param propertyName The property's name
@@ -259,6 +260,10 @@ class CurveRTCHost {
          * Size of the property's base type (e.g. size of an individual element if array property)
          */
         size_t type_size;
+        /**
+         * If true, offset locates a pointer to the property's data, as the property did not fit in constant memory
+         */
+        bool indirect;
     };
     /**
      * Properties for a registered environment macro property
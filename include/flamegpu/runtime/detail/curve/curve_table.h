@@ -0,0 +1,136 @@
+#ifndef INCLUDE_FLAMEGPU_RUNTIME_DETAIL_CURVE_CURVE_TABLE_H_
+#define INCLUDE_FLAMEGPU_RUNTIME_DETAIL_CURVE_CURVE_TABLE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "flamegpu/util/detail/DirtyRangeSet.h"
+
+namespace flamegpu {
+namespace detail {
+namespace curve {
+
+/**
+ * Host side of the cuRVE hash table, which Curve mirrors to the device
+ *
+ * Variables are placed by linear probing from their home slot (hash % MAX_VARIABLES).
+ * The table tracks the greatest probe distance of any registered variable, so that device lookups only need to
+ * inspect getMaxProbe()+1 slots. Whilst no registered variables collide, this is a single indexed load.
+ * Slots are cleared on removal (no tombstones), as lookups are bounded by the max probe distance rather than stopping at an empty slot.
+ *
+ * This class contains no CUDA, so that slot assignment can be tested on the host.
+ */
+class CurveTable {
+ public:
+    typedef int          Variable;      // !< Slot index of a registered variable
+    typedef unsigned int VariableHash;  // !< cuRVE variable name string hash
+    static const int UNKNOWN_VARIABLE = -1;
+    static const unsigned int MAX_VARIABLES = 1024;  // !< Number of slots, must be a power of 2
+    static const VariableHash EMPTY_FLAG = 0;
+    static const VariableHash DELETED_FLAG = 1;
+    /**
+     * Setup-time record of a group of variables which are always registered together (e.g. an agent function's agent variables)
+     *
+     * Variables are given dense indices by their order within variables, the slot each occupies is stored when the binding is bound.
+     * This allows the group to be registered, and unregistered, each layer without hashing names or searching the table.
+     */
+    struct Binding {
+        struct Entry {
+            /**
+             * Full hash of the variable (including namespace hashes)
+             */
+            VariableHash hash;
+            /**
+             * Size of the variable in bytes (type size * elements)
+             */
+            size_t size;
+            /**
+             * Slot the variable occupies whilst bound, else UNKNOWN_VARIABLE
+             */
+            Variable slot = UNKNOWN_VARIABLE;
+        };
+        std::vector<Entry> variables;
+        bool bound = false;
+    };
+
+    CurveTable();
+    /**
+     * Unregister all variables, and mark every slot dirty
+     */
+    void clear();
+    /**
+     * Register a variable, in the first free slot from it's home slot
+     * @param variable_hash Hash of the variable, this must not be EMPTY_FLAG or DELETED_FLAG
+     * @param ptr Device pointer to the variable's buffer
+     * @param size Size of the variable in bytes (type size * elements)
+     * @param length Number of items in the variable's buffer
+     * @return The slot assigned, or UNKNOWN_VARIABLE if the table is full
+     */
+    Variable registerVariable(VariableHash variable_hash, void *ptr, size_t size, unsigned int length);
+    /**
+     * Unregister a variable
+     * @throws exception::CurveException If variable_hash is not registered
+     */
+    void unregisterVariable(VariableHash variable_hash);
+    /**
+     * Returns the slot of the variable, or UNKNOWN_VARIABLE if it is not registered
+     */
+    Variable find(VariableHash variable_hash) const;
+    /**
+     * Register every variable of the binding, recording the slot of each
+     * If the binding is already bound, the buffer and length of each variable are updated in place instead (unless the table
+     * no longer holds the binding's variables at the recorded slots, in which case they are registered afresh)
+     * @param binding The binding to register
+     * @param ptrs Device pointer to each variable's buffer, in the same order as binding.variables
+     * @param length Number of items in each variable's buffer
+     * @throws exception::CurveException If the table is full, in which case no variables of the binding are registered
+     */
+    void bind(Binding &binding, void *const *ptrs, unsigned int length);
+    /**
+     * Unregister every variable of a bound binding, using the recorded slots
+     * Does nothing if the binding is not bound
+     */
+    void unbind(Binding &binding);
+    /**
+     * Returns the number of registered variables
+     */
+    int size() const { return count; }
+    /**
+     * Returns the greatest distance of any registered variable from it's home slot
+     */
+    unsigned int getMaxProbe() const { return max_probe; }
+    static unsigned int getHomeSlot(VariableHash variable_hash) { return variable_hash & (MAX_VARIABLES - 1); }
+    const VariableHash *getHashes() const { return hashes; }
+    void *const *getPointers() const { return pointers; }
+    const size_t *getSizes() const { return sizes; }
+    const unsigned int *getLengths() const { return lengths; }
+    /**
+     * Slots which have changed since clearDirty() was last called
+     */
+    const util::detail::DirtyRangeSet &getDirty() const { return dirty; }
+    void clearDirty() { dirty.clear(); }
+
+ private:
+    /**
+     * Write the slot, and update the probe statistics
+     */
+    void setSlot(unsigned int slot, VariableHash variable_hash, void *ptr, size_t size, unsigned int length);
+    void clearSlot(unsigned int slot);
+    VariableHash hashes[MAX_VARIABLES];
+    void *pointers[MAX_VARIABLES];
+    size_t sizes[MAX_VARIABLES];
+    unsigned int lengths[MAX_VARIABLES];
+    /**
+     * Number of registered variables at each probe distance
+     */
+    unsigned int probe_counts[MAX_VARIABLES];
+    unsigned int max_probe;
+    int count;
+    util::detail::DirtyRangeSet dirty;
+};
+
+}  // namespace curve
+}  // namespace detail
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_RUNTIME_DETAIL_CURVE_CURVE_TABLE_H_
@@ -44,6 +44,13 @@ class MessageBucket::CUDAModelHandler : public MessageSpecialisationHandler {
      * @param stream CUDA stream to be used for async CUDA operations
      */
     void buildIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) override;
+    /**
+     * Reconstructs the partition boundary matrix of messages restored from a checkpoint
+     * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
+     * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
+     * @param stream CUDA stream to be used for async CUDA operations
+     */
+    void restoreIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) override;
     /**
     * Allocates memory for the constructed index.
     * The memory allocation is checked by build index.
@@ -13,6 +13,25 @@ enum class MessageSortingType {
     spatial3D
 };
 
+/**
+ * The order in which agents are placed by the automatic spatial sort, prior to agent functions which input spatial messages
+ * @see AgentDescription::setSortOrder()
+ */
+enum class SpatialSortOrder {
+    /**
+     * Agents are sorted by the linear (x-fastest) index of their bin within the message grid
+     */
+    RowMajor,
+    /**
+     * Agents are sorted by the Z-order (Morton) curve index of their bin within the message grid
+     */
+    Morton,
+    /**
+     * Agents are sorted by the Hilbert curve index of their bin within the message grid
+     */
+    Hilbert
+};
+
 }  // namespace flamegpu
 
 #endif  // INCLUDE_FLAMEGPU_RUNTIME_MESSAGING_MESSAGESORTINGTYPE_H_
@@ -2,6 +2,7 @@
 #define INCLUDE_FLAMEGPU_RUNTIME_MESSAGING_MESSAGESPATIAL2D_MESSAGESPATIAL2DDEVICE_CUH_
 
 #include "flamegpu/runtime/messaging/MessageSpatial2D.h"
+#include "flamegpu/util/detail/SparseCellTable.h"
 #include "flamegpu/runtime/messaging/MessageBruteForce/MessageBruteForceDevice.cuh"
 
 namespace flamegpu {
@@ -37,6 +38,11 @@ class MessageSpatial2D::In {
              * relative_cell corresponds to y offset
              */
             int relative_cell = { -2 };
+            /**
+             * Sparse partitioning only: relative bin within the current strip
+             * Bins of a strip are not contiguous within a sparse PBM, so they are visited individually
+             */
+            int relative_cell_x = 1;
             /**
              * This is the index after the final message, relative to the full message list, in the current bin
              */
@@ -69,6 +75,7 @@ class MessageSpatial2D::In {
              */
             __device__ bool operator==(const Message& rhs) const {
                 return this->relative_cell == rhs.relative_cell
+                    && this->relative_cell_x == rhs.relative_cell_x
                     && this->cell_index_max == rhs.cell_index_max
                     && this->cell_index == rhs.cell_index;
             }
@@ -95,6 +102,17 @@ class MessageSpatial2D::In {
             __device__ void nextStrip() {
                 relative_cell++;
             }
+            /**
+             * Utility function for deciding next bin to access, when sparse partitioning is enabled
+             */
+            __device__ void nextBin() {
+                if (relative_cell_x >= 1) {
+                    relative_cell_x = -1;
+                    nextStrip();
+                } else {
+                    relative_cell_x++;
+                }
+            }
             /**
              * Returns the value for the current message attached to the named variable
              * @param variable_name Name of the variable
@@ -362,7 +380,11 @@ __device__ inline MessageSpatial2D::In::Filter::Message& MessageSpatial2D::In::F
     cell_index++;
     bool move_strip = cell_index >= cell_index_max;
     while (move_strip) {
-        nextStrip();
+        if (_parent.metadata->sparseCapacity) {
+            nextBin();
+        } else {
+            nextStrip();
+        }
         cell_index = 0;
         cell_index_max = 1;
         if (relative_cell < 2) {
@@ -370,6 +392,21 @@ __device__ inline MessageSpatial2D::In::Filter::Message& MessageSpatial2D::In::F
             int absolute_cell_y = _parent.cell.y + relative_cell;
             // Skip the strip if it is completely out of bounds
             if (absolute_cell_y >= 0 && absolute_cell_y < static_cast<int>(_parent.metadata->gridDim[1])) {
+                if (_parent.metadata->sparseCapacity) {
+                    // Skip the bin if it is out of bounds or unoccupied
+                    int absolute_cell_x = _parent.cell.x + relative_cell_x;
+                    if (absolute_cell_x < 0 || absolute_cell_x >= static_cast<int>(_parent.metadata->gridDim[0]))
+                        continue;
+                    const unsigned int slot = util::detail::sparse_cell_table::find(_parent.metadata->sparseKeys, _parent.metadata->sparseCapacity,
+                        getHash2D(_parent.metadata, { absolute_cell_x, absolute_cell_y }));
+                    if (slot == util::detail::sparse_cell_table::EMPTY)
+                        continue;
+                    // Lookup start and end indicies from PBM
+                    cell_index = _parent.metadata->PBM[slot];
+                    cell_index_max = _parent.metadata->PBM[slot + 1];
+                    move_strip = cell_index >= cell_index_max;
+                    continue;
+                }
                 unsigned int start_hash = getHash2D(_parent.metadata, { _parent.cell.x - 1, absolute_cell_y });
                 unsigned int end_hash = getHash2D(_parent.metadata, { _parent.cell.x + 1, absolute_cell_y });
                 // Lookup start and end indicies from PBM
@@ -378,6 +415,7 @@ __device__ inline MessageSpatial2D::In::Filter::Message& MessageSpatial2D::In::F
             } else {
                 // Goto next strip
                 // Don't update move_strip
+                relative_cell_x = 1;
                 continue;
             }
         }
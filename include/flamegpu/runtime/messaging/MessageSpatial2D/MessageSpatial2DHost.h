@@ -1,6 +1,7 @@
 #ifndef INCLUDE_FLAMEGPU_RUNTIME_MESSAGING_MESSAGESPATIAL2D_MESSAGESPATIAL2DHOST_H_
 #define INCLUDE_FLAMEGPU_RUNTIME_MESSAGING_MESSAGESPATIAL2D_MESSAGESPATIAL2DHOST_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -46,6 +47,13 @@ class MessageSpatial2D::CUDAModelHandler : public MessageSpecialisationHandler {
      * @param stream CUDA stream to be used for async CUDA operations
      */
     void buildIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) override;
+    /**
+     * Reconstructs the partition boundary matrix of messages restored from a checkpoint
+     * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
+     * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
+     * @param stream CUDA stream to be used for async CUDA operations
+     */
+    void restoreIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) override;
     /**
      * Allocates memory for the constructed index.
      * The memory allocation is checked by build index.
@@ -64,10 +72,18 @@ class MessageSpatial2D::CUDAModelHandler : public MessageSpecialisationHandler {
     /**
      * Resizes the cub temp memory
      * Currently assumed that bounds of environment/rad never change
-     * So this is only called from the constructor.
+     * So this is only called when the index is allocated, or the sparse bin table is resized.
      * If it were called elsewhere, it would need to be changed to resize d_histogram too
      */
     void resizeCubTemp();
+    /**
+     * Sparse partitioning only: resizes the sparse bin table, PBM and histogram to hold maxOccupied bins
+     * The device copy of the metadata is updated if the table is resized
+     * @param maxOccupied The maximum number of bins which may be occupied, this is bounded by the message list size
+     * @param stream CUDA stream to be used for async CUDA operations
+     * @note This only scales upwards, it will never reduce the size
+     */
+    void resizeSparseTable(const unsigned int &maxOccupied, const cudaStream_t &stream);
     /**
      * Resizes the key value store, this scales with agent count
      * @param newSize The new number of agents to represent
@@ -76,8 +92,13 @@ class MessageSpatial2D::CUDAModelHandler : public MessageSpecialisationHandler {
     void resizeKeysVals(const unsigned int &newSize);
     /**
      * Number of bins, arrays are +1 this length
+     * If sparse partitioning is enabled, this is the number of slots in the sparse bin table
      */
     unsigned int binCount = 0;
+    /**
+     * Number of bins in the environment's partitioning grid
+     */
+    uint64_t gridBinCount = 0;
     /**
      * Size of currently allocated temp storage memory for cub
      */
@@ -124,6 +145,11 @@ struct MessageSpatial2D::Data : public MessageBruteForce::Data {
     float minY;
     float maxX;
     float maxY;
+    /**
+     * If true, only occupied bins are stored
+     * @see Description::setSparse()
+     */
+    bool sparse;
     virtual ~Data() = default;
 
     std::unique_ptr<MessageSpecialisationHandler> getSpecialisationHander(CUDAMessage &owner) const override;
@@ -191,12 +217,25 @@ class MessageSpatial2D::Description : public MessageBruteForce::Description {
     void setMaxX(const float &x);
     void setMaxY(const float &y);
     void setMax(const float &x, const float &y);
+    /**
+     * Enables or disables sparse partitioning, this is disabled by default
+     *
+     * By default, the partition boundary matrix (PBM) holds an entry for every bin within the environment bounds,
+     * so memory use and the cost of building the index scale with the volume of the environment.
+     * When sparse partitioning is enabled, only bins which contain messages are stored, within a hash table sized according to
+     * the maximum message list size. This is suited to large environments with a small search radius, where most bins are empty.
+     * Reading the messages of a bin requires an additional hash table lookup, so dense environments should not enable this.
+     * Messages returned when iterating a search origin are the same in both modes.
+     * @param sparse True to enable sparse partitioning
+     */
+    void setSparse(const bool &sparse);
 
     float getRadius() const;
     float getMinX() const;
     float getMinY() const;
     float getMaxX() const;
     float getMaxY() const;
+    bool getSparse() const;
 };
 
 }  // namespace flamegpu
@@ -55,8 +55,18 @@ class MessageSpatial3D {
         /**
          * Pointer to the partition boundary matrix in device memory
          * The PBM is never stored on the host
+         * If sparse partitioning is enabled, the PBM is indexed by the slot which holds the bin within sparseKeys
          */
         unsigned int *PBM;
+        /**
+         * Pointer to the sparse bin table in device memory, this is nullptr if sparse partitioning is not enabled
+         * @see util::detail::sparse_cell_table
+         */
+        unsigned int *sparseKeys;
+        /**
+         * The number of slots in sparseKeys, this is 0 if sparse partitioning is not enabled
+         */
+        unsigned int sparseCapacity;
         /**
          * The number of subdividision bins in each dimensions
          */
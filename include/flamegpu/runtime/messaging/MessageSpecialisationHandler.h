@@ -33,6 +33,14 @@ class MessageSpecialisationHandler {
      * @param stream CUDA stream to be used for async CUDA operations
      */
     virtual void buildIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) { }
+    /**
+     * Reconstructs the index of a message list restored from a checkpoint, which had already been indexed when it was checkpointed
+     * The messages are already in index order, so message types whose index is only the order of the messages need not implement this
+     * @param scatter Scatter instance and scan arrays to be used (CUDASimulation::singletons->scatter)
+     * @param streamId The stream index to use for accessing stream specific resources such as scan compaction arrays and buffers
+     * @param stream CUDA stream to be used for async CUDA operations
+     */
+    virtual void restoreIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) { }
     /**
      * Allocates memory for the constructed index.
      * The memory allocation is checked by build index.
@@ -16,6 +16,22 @@ namespace detail {
      * Defined in EnvironmentManager.cu
      */
     extern __constant__ char c_envPropBuffer[EnvironmentManager::MAX_BUFFER_SIZE];
+    /**
+     * Reads an element of an environment property
+     * @param d_ptr The property's pointer registered in curve
+     *        Properties stored in constant memory register their offset into c_envPropBuffer
+     *        Properties which spilled to global memory register a device pointer, which is never smaller than MAX_BUFFER_SIZE
+     * @param index Index of the element to read, 0 unless the property is an array property
+     */
+    template<typename T>
+    __device__ __forceinline__ T readEnvProperty(const char *d_ptr, const unsigned int &index = 0) {
+        const ptrdiff_t offset = reinterpret_cast<ptrdiff_t>(d_ptr);
+        // Each branch performs its own load, so that constant reads are not demoted to generic loads
+        if (offset < static_cast<ptrdiff_t>(EnvironmentManager::MAX_BUFFER_SIZE)) {
+            return reinterpret_cast<const T*>(c_envPropBuffer + offset)[index];
+        }
+        return reinterpret_cast<const T*>(d_ptr)[index];
+    }
 }  // namespace detail
 #endif
 
@@ -145,11 +161,11 @@ __device__ __forceinline__ T ReadOnlyDeviceEnvironment::getProperty(const char(&
     } else if (detail::curve::detail::d_sizes[cv] * detail::curve::detail::d_lengths[cv] != type_decode<T>::len_t * sizeof(typename type_decode<T>::type_t)) {
         DTHROW("Environment property with name: %s type size mismatch %llu != %llu.\n", name, detail::curve::detail::d_sizes[cv], sizeof(T));
     } else {
-        return *reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv]));
+        return detail::readEnvProperty<T>(detail::curve::detail::d_variables[cv]);
     }
     return {};
 #else
-    return *reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv]));
+    return detail::readEnvProperty<T>(detail::curve::detail::d_variables[cv]);
 #endif
 }
 template<typename T, unsigned int N>
@@ -165,11 +181,11 @@ __device__ __forceinline__ T ReadOnlyDeviceEnvironment::getProperty(const char(&
     } else if (detail::curve::detail::d_lengths[cv] < t_index || t_index < index) {
         DTHROW("Environment property array with name: %s index %u is out of bounds (length %u).\n", name, index, detail::curve::detail::d_lengths[cv]);
     } else {
-        return *(reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv])) + index);
+        return detail::readEnvProperty<T>(detail::curve::detail::d_variables[cv], index);
     }
     return {};
 #else
-    return *(reinterpret_cast<T*>(detail::c_envPropBuffer + reinterpret_cast<ptrdiff_t>(detail::curve::detail::d_variables[cv])) + index);
+    return detail::readEnvProperty<T>(detail::curve::detail::d_variables[cv], index);
 #endif
 }
 
@@ -4,11 +4,11 @@
 #include <cuda_runtime.h>
 
 #include <cstddef>
+#include <cstring>
 #include <unordered_map>
 #include <array>
 #include <string>
 #include <type_traits>
-#include <list>
 #include <utility>
 #include <typeindex>
 #include <set>
@@ -22,6 +22,7 @@
 #include "flamegpu/exception/FLAMEGPUException.h"
 #include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
 #include "flamegpu/runtime/detail/curve/curve.cuh"
+#include "flamegpu/runtime/utility/EnvironmentStorage.h"
 #include "flamegpu/util/Any.h"
 #include "flamegpu/util/type_decode.h"
 
@@ -38,15 +39,27 @@ class XMLStateReader;
 class JSONStateWriter;
 class JSONStateReader;
 class JSONStateReader_impl;
+class BinaryStateWriter;
 }  // namespace io
 
 /**
  * Singleton manager for managing environment properties storage in constant memory
  * This is an internal class, that should not be accessed directly by modellers
+ *
+ * A single manager exists per device, as the __constant__ buffer and curve are per device.
+ * However, the properties of each CUDASimulation instance are stored independently:
+ * > Each instance reserves its own region of the device's __constant__ buffer when it is initialised
+ * > Each instance has its own host storage (detail::EnvironmentStorage), properties which do not fit within the
+ *   instance's constant region spill into a global memory allocation owned by the instance
+ * Therefore, instances never defragment, or upload, each other's properties.
+ *
+ * The set of registered instances is replaced atomically (copy-on-write) by init() and free(), so getting and setting
+ * properties does not require a lock. Each instance's data must only be accessed by the thread executing that instance
+ * (and its submodels).
  * @see EnvironmentDescription For describing the initial state of a model's environment properties
  * @see AgentEnvironment For reading environment properties during agent functions on the device
  * @see HostEnvironment For accessing environment properties during host functions
- * @note Not thread-safe
+ * @see detail::EnvironmentStorage For the layout of an individual instance's properties
  */
 class EnvironmentManager {
     /**
@@ -61,10 +74,6 @@ class EnvironmentManager {
      * Uses instance to access env properties in host functions
      */
     friend class HostEnvironment;
-    /**
-     * Accesses pointer to hc_buffer
-     */
-    friend class DefragProp;
     /**
      * Accesses properties to find all of a model's vars
      */
@@ -73,20 +82,20 @@ class EnvironmentManager {
     friend class io::JSONStateWriter;
     friend class io::JSONStateReader;
     friend class io::JSONStateReader_impl;
+    friend class io::BinaryStateWriter;
     /**
      * CUDASimulation instance id and Property name
      */
     typedef std::pair<unsigned int, std::string> NamePair;
-    struct NamePairHash {
-        size_t operator()(const NamePair& k) const {
-            return std::hash<unsigned int>()(k.first) ^
-                (std::hash<std::string>()(k.second) << 1);
-        }
-    };
+    /**
+     * Environment properties owned by a single CUDASimulation instance
+     */
+    struct Instance;
 
  public:
     /**
-     * Max amount of space that can be used for storing environmental properties
+     * Max amount of space that can be used for storing environmental properties in constant memory
+     * This is shared between all instances on a device, properties which do not fit are stored in global memory
      */
     static const size_t MAX_BUFFER_SIZE = 10 * 1024;  // 10KB
     /**
@@ -94,42 +103,34 @@ class EnvironmentManager {
      * Length in bytes
      */
     typedef unsigned int size_type;
-    /**
-     * Used to group items required by freeFragments 
-     */
-    typedef std::pair<ptrdiff_t, size_t> OffsetLen;
-    /**
-     * Gives names to indices of OffsetLen
-     */
-    enum OL {
-        OFFSET = 0,
-        LEN = 1,
-    };
     /**
      * Used to group items required by properties
+     * The location of the property's data is held by the owning instance's detail::EnvironmentStorage
      */
     struct EnvProp {
         /**
-         * @param _offset Offset into c_buffer/hc_buffer
          * @param _length Length of associated storage
          * @param _isConst Is the stored data constant
          * @param _elements How many elements does the stored data contain (1 if not array)
          * @param _type Type of property (from typeid())
-        * @param _rtc_offset Offset into the instances rtc cache, this can be skipped if the relevant rtc cache has not yet been built
+         * @param _rtc_offset Offset into the instances rtc cache, this can be skipped if the relevant rtc cache has not yet been built
          */
-        EnvProp(const ptrdiff_t &_offset, const size_t &_length, const bool &_isConst, const size_type &_elements, const std::type_index &_type, const ptrdiff_t &_rtc_offset = 0)
-            : offset(_offset),
-            length(_length),
+        EnvProp(const size_t &_length, const bool &_isConst, const size_type &_elements, const std::type_index &_type, const ptrdiff_t &_rtc_offset = 0)
+            : length(_length),
             isConst(_isConst),
             elements(_elements),
             type(_type),
             rtc_offset(_rtc_offset) {}
-        ptrdiff_t offset;
         size_t length;
         bool isConst;
         size_type elements;
         const std::type_index type;
-        ptrdiff_t rtc_offset;  // This is set by buildRTCOffsets();
+        ptrdiff_t rtc_offset;  // This is set by addRTCOffset();
+        /**
+         * If true, the rtc cache holds a pointer to the property's data in global memory, rather than the data itself
+         * This is the case for properties which spilled out of constant memory
+         */
+        bool rtc_indirect = false;
     };
     /**
      * Used to represent properties of a mapped environment property
@@ -138,51 +139,15 @@ class EnvironmentManager {
         /**
          * @param _masterProp Master property of mapping
          * @param _isConst Is the stored data constant
+         * @param _master The instance which owns the master property
          */
-        MappedProp(const NamePair &_masterProp, const bool &_isConst)
+        MappedProp(const NamePair &_masterProp, const bool &_isConst, const std::shared_ptr<Instance> &_master)
             : masterProp(_masterProp),
-            isConst(_isConst) {}
+            isConst(_isConst),
+            master(_master) {}
         const NamePair masterProp;
         const bool isConst;
-    };
-    /**
-     * This structure is a clone of EnvProp
-     * However, instead of offset (which points to an offset into hc_buffer)
-     * data is available, which points to host memory
-     */
-    struct DefragProp {
-        /**
-         * @param ep Environment property to clone
-         * @note ep.offset is converted to a host pointer by adding to hc_buffer
-         */
-        explicit DefragProp(const EnvProp &ep)
-            :data(EnvironmentManager::getInstance().hc_buffer + ep.offset),
-            length(ep.length),
-            isConst(ep.isConst),
-            elements(ep.elements),
-            type(ep.type),
-            rtc_offset(ep.rtc_offset) { }
-        /**
-        * @param _data Pointer to the data in host memory
-        * @param _length Length of associated storage
-        * @param _isConst Is the stored data constant
-        * @param _elements How many elements does the stored data contain (1 if not array)
-        * @param _type Type of propert (from typeid())
-        * @param _rtc_offset Offset into the instances rtc cache, this can be skipped if the relevant rtc cache has not yet been built
-        */
-        DefragProp(void *_data, const size_t &_length, const bool &_isConst, const size_type &_elements, const std::type_index &_type, const ptrdiff_t &_rtc_offset = 0)
-            : data(_data),
-            length(_length),
-            isConst(_isConst),
-            elements(_elements),
-            type(_type),
-            rtc_offset(_rtc_offset) { }
-        void *data;
-        size_t length;
-        bool isConst;
-        size_type elements;
-        const std::type_index type;
-        ptrdiff_t rtc_offset;
+        const std::shared_ptr<Instance> master;
     };
     /**
      * Struct used by rtc_caches
@@ -198,35 +163,18 @@ class EnvironmentManager {
          * Offset relative to c_buffer, where no more data has been stored
          */
         ptrdiff_t nextFree = 0;
+        /**
+         * Offsets within hc_buffer which hold a device pointer to a spilled property, rather than its data
+         * These are refreshed by getRTCCache(), as the global memory allocation may move
+         */
+        std::map<ptrdiff_t, NamePair> indirect;
     };
-    /**
-     * Transparent operators for DefragMap
-     * This allows them to be secondarily ordered based on NamePair if size is equal
-     */
-    friend bool operator<(const std::pair<size_t, const NamePair>& fk, const size_t& lk) { return fk.first < lk; }
-    friend bool operator<(const size_t& lk, const std::pair<size_t, const NamePair>& fk) { return lk < fk.first; }
-    friend bool operator<(const std::pair<size_t, const NamePair>& fk1, const std::pair<size_t, const NamePair>& fk2) {
-        if (fk1.first == fk2.first) {
-            // If size equal, order by instance_id
-            if (fk1.second.first == fk2.second.first) {
-                // If instance id is equal, order by name
-                return fk1.second.second < fk2.second.second;
-            }
-            return fk1.second.first < fk2.second.first;
-        }
-        return fk1.first < fk2.first;
-    }
-    /**
-     * Typedef for the map used for defragementation
-     * The map is ordered by key of type size, therefore a reverse sort creates aligned data
-     * Specify a transparent operator, to allow us to operate only over size_t part of key
-     */
-    typedef std::multimap<std::pair<size_t, const NamePair>, DefragProp, std::less<>> DefragMap;
     /**
      * Activates a models environment properties, by adding them to constant cache
      * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
      * @param desc environment properties description to use
      * @param isPureRTC If true, Curve collision warnings (debug build only) will be suppressed as they are irrelevant to RTC models
+     * @throws exception::EnvDescriptionAlreadyLoaded If the instance has already been initialised
      */
     void init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC);
     /**
@@ -238,6 +186,7 @@ class EnvironmentManager {
      * @param isPureRTC If true, Curve collision warnings (debug build only) will be suppressed as they are irrelevant to RTC models
      * @param master_instance_id instance_id of the CUDASimulation instance of the parent of the submodel
      * @param mapping Metadata for which environment properties are mapped between master and submodels
+     * @throws exception::EnvDescriptionAlreadyLoaded If the instance has already been initialised
      */
     void init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC, const unsigned int &master_instance_id, const SubEnvironmentData &mapping);
     /**
@@ -248,13 +197,14 @@ class EnvironmentManager {
      */
     void initRTC(const CUDASimulation &cudaSimulation);
     /**
-     * Deactives all environmental properties linked to the named model from constant cache
+     * Deactives all environmental properties linked to the named model, releasing its constant memory region and global memory
      * @param curve The Curve singleton instance to use, it is important that we purge curve for the correct device
      * @param instance_id instance_id of the CUDASimulation instance the properties are attached to
      */
     void free(detail::curve::Curve &curve, const unsigned int &instance_id);
     /**
      * Adds a new environment property
+     * If the property does not fit within the instance's constant region, it will be stored in global memory
      * @param name name used for accessing the property
      * @param value stored value of the property
      * @param isConst If set to true, it is not possible to change the value
@@ -277,6 +227,7 @@ class EnvironmentManager {
     void newProperty(const unsigned int &instance_id, const std::string &var_name, const T &value, const bool &isConst = false);
     /**
      * Adds a new environment property array
+     * If the property does not fit within the instance's constant region, it will be stored in global memory
      * @param name name used for accessing the property
      * @param value stored value of the property
      * @param isConst If set to true, it is not possible to change the value
@@ -478,6 +429,17 @@ class EnvironmentManager {
      * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
     util::Any getPropertyAny(const unsigned int &instance_id, const std::string &var_name) const;
+    /**
+     * Sets the current value of an environment property from an Any object
+     * Unlike setProperty(), this permits properties marked const to be updated, so that RunPlan property overrides can be applied
+     * This method should not be exposed to users
+     * @param instance_id instance_id of the CUDASimulation instance the property is attached to
+     * @param var_name name used for accessing the property
+     * @param value The new value, this must match the type and length of the property
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
+     * @throws exception::InvalidEnvPropertyType If value does not match the type or length of the property
+     */
+    void setPropertyAny(const unsigned int &instance_id, const std::string &var_name, const util::Any &value);
     /**
      * Removes an environment property
      * @param name name used for accessing the property
@@ -507,8 +469,9 @@ class EnvironmentManager {
      * @param name name used for accessing the property
      */
     inline bool containsProperty(const NamePair &name) const {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex);
-        return properties.find(name) != properties.end() || mapped_properties.find(name) != mapped_properties.end();
+        const std::shared_ptr<Instance> instance = findInstanceData(name.first);
+        return instance && (instance->properties.find(name.second) != instance->properties.end() ||
+            instance->mapped_properties.find(name.second) != instance->mapped_properties.end());
     }
     /**
      * Convenience method: Returns whether the named env property exists
@@ -523,19 +486,7 @@ class EnvironmentManager {
      * @return true if the var is marked as constant (cannot be changed during simulation)
      * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
-    inline bool isConst(const NamePair &name) const {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex);
-        const auto a = properties.find(name);
-        if (a != properties.end())
-            return a->second.isConst;
-        const auto b = mapped_properties.find(name);
-        if (b != mapped_properties.end()) {
-            return b->second.isConst;
-        }
-        THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
-            "in EnvironmentManager::isConst().",
-            name.first, name.second.c_str());
-    }
+    inline bool isConst(const NamePair &name) const { return findProperty(name, "isConst").isConst; }
     /**
      * Convenience method: Returns whether the named env property is marked as const
      * @param instance_id instance_id of the CUDASimulation instance the property is attached to
@@ -550,24 +501,7 @@ class EnvironmentManager {
      * @param name name used for accessing the property
      * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
-    inline size_type length(const NamePair &name) const {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex);
-        auto a = properties.find(name);
-        if (a != properties.end())
-            return a->second.elements;
-        const auto b = mapped_properties.find(name);
-        if (b != mapped_properties.end()) {
-            a = properties.find(b->second.masterProp);
-            if (a != properties.end())
-                return a->second.elements;
-            THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
-                "in EnvironmentManager::length().",
-                name.first, name.second.c_str(), b->second.masterProp.first, b->second.masterProp.second.c_str());
-        }
-        THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
-            "in EnvironmentManager::length().",
-            name.first, name.second.c_str());
-    }
+    inline size_type length(const NamePair &name) const { return findProperty(name, "length").prop->elements; }
     /**
      * Convenience method: Returns the number of elements of the named env property (1 if not an array)
      * @param instance_id instance_id of the CUDASimulation instance the property is attached to
@@ -581,24 +515,7 @@ class EnvironmentManager {
      * @param name name used for accessing the property
      * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
-    inline std::type_index type(const NamePair &name) const {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex);
-        auto a = properties.find(name);
-        if (a != properties.end())
-            return a->second.type;
-        const auto b = mapped_properties.find(name);
-        if (b != mapped_properties.end()) {
-            a = properties.find(b->second.masterProp);
-            if (a != properties.end())
-                return a->second.type;
-            THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
-                "in EnvironmentManager::type().",
-                name.first, name.second.c_str(), b->second.masterProp.first, b->second.masterProp.second.c_str());
-        }
-        THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
-            "in EnvironmentManager::type().",
-            name.first, name.second.c_str());
-    }
+    inline std::type_index type(const NamePair &name) const { return findProperty(name, "type").prop->type; }
     /**
      * Convenience method: Returns the variable type of named env property
      * @param instance_id instance_id of the CUDASimulation instance the property is attached to
@@ -613,27 +530,19 @@ class EnvironmentManager {
      * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
     inline size_t type_size(const NamePair& name) const {
-        std::shared_lock<std::shared_timed_mutex> lock(mutex);
-        auto a = properties.find(name);
-        if (a != properties.end())
-            return a->second.length;
-        const auto b = mapped_properties.find(name);
-        if (b != mapped_properties.end()) {
-            a = properties.find(b->second.masterProp);
-            if (a != properties.end())
-                return a->second.length;
-            THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
-                "in EnvironmentManager::type_size().",
-                name.first, name.second.c_str(), b->second.masterProp.first, b->second.masterProp.second.c_str());
-        }
-        THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
-            "in EnvironmentManager::type_size().",
-            name.first, name.second.c_str());
+        const PropRef p = findProperty(name, "type_size");
+        return p.prop->length / p.prop->elements;
     }
     /**
-     * Returns the available space remaining (bytes) for storing environmental properties
+     * Returns the space (bytes) within the device's constant buffer which has not been reserved by any instance
+     */
+    size_t freeSpace() const;
+    /**
+     * Returns the number of bytes of the named instance's properties which are stored in global memory
+     * @param instance_id instance_id of the CUDASimulation instance
+     * @throws exception::UnknownInternalError If the instance is not registered
      */
-    inline size_t freeSpace() const { std::shared_lock<std::shared_timed_mutex> lock(mutex); return m_freeSpace; }
+    size_t spilledSize(const unsigned int &instance_id) const;
     /**
      * This is the string used to generate CURVE_NAMESPACE_HASH
      */
@@ -644,33 +553,129 @@ class EnvironmentManager {
      */
     const detail::curve::Curve::NamespaceHash CURVE_NAMESPACE_HASH;
     /**
-     * Returns read-only access to the properties map
-     * @note You must acquire a lock on mutex before calling this method
+     * Returns read-only access to the properties owned by an instance (this excludes mapped properties)
+     * @param instance_id instance_id of the CUDASimulation instance
+     * @throws exception::UnknownInternalError If the instance is not registered
      */
-    const std::unordered_map<NamePair, EnvProp, NamePairHash> &getPropertiesMap() const {
-        return properties;
-    }
+    const std::unordered_map<std::string, EnvProp> &getPropertiesMap(const unsigned int &instance_id) const;
     /**
-     * Returns readonly access to mapped properties
-     * @note You must acquire a lock on mutex before calling this method
-     */    
-    const std::unordered_map<NamePair, MappedProp, NamePairHash> &getMappedProperties() const {
-        return mapped_properties;
-    }
+     * Returns readonly access to the mapped properties of an instance
+     * @param instance_id instance_id of the CUDASimulation instance
+     * @throws exception::UnknownInternalError If the instance is not registered
+     */
+    const std::unordered_map<std::string, MappedProp> &getMappedProperties(const unsigned int &instance_id) const;
     /**
      * Used by IO methods to efficiently access environment
-     * @note You must acquire a lock on mutex before calling this method
+     * @param instance_id instance_id of the CUDASimulation instance
+     * @param var_name name of a property owned by the instance
+     * @return Pointer to the host copy of the property's data
+     * @note This pointer is invalidated if properties are added to, or removed from, the instance
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
-    const void * getHostBuffer() const {
-        return hc_buffer;
-    }
+    const char *getHostPtr(const unsigned int &instance_id, const std::string &var_name) const;
     /**
-     * Updates the copy of the environment property cache on the device
-     * @param instance_id Used to update the specified instance's rtc too
+     * Updates the copy of the environment properties on the device
+     * Only the byte ranges of the named instance (and the instances it maps properties from) which have changed are copied
+     * @param instance_id Instance to be updated
+     * @param stream The CUDA stream to issue the copies to
+     * @return True if any copies were issued, these are asynchronous so the stream must be synchronised (or ordered) before other streams read the environment
      */
-    void updateDevice(const unsigned int &instance_id);
+    bool updateDevice(const unsigned int &instance_id, cudaStream_t stream);
 
  private:
+    /**
+     * These flags control what happens when updateDevice() is called
+     * Their primary purpose is to cause the device memory to updated as lazily as possible
+     * Changes to property values are tracked by byte range within each instance's EnvironmentStorage
+     */
+    struct EnvUpdateFlags {
+        /**
+         * Update the RTC environment cache for a specific CUDASimulation instance
+         */
+        bool rtc_update_required = true;
+        /**
+         * (Re)register all of the instance's variables inside CURVE
+         * This is required whenever a property is added/removed/moved, or after a device reset when EnvironmentManager::purge() has been called
+         **/
+        bool curve_registration_required = true;
+    };
+    struct Instance {
+        /**
+         * @param _instance_id instance_id of the CUDASimulation instance
+         * @param _constant_base Offset of the instance's region within c_buffer
+         * @param constant_capacity Length of the instance's region within c_buffer
+         * @param _isPureRTC If true, Curve collision warnings (debug build only) will be suppressed
+         */
+        Instance(const unsigned int &_instance_id, const ptrdiff_t &_constant_base, const size_t &constant_capacity, const bool &_isPureRTC)
+            : instance_id(_instance_id)
+            , storage(constant_capacity)
+            , constant_base(_constant_base)
+            , isPureRTC(_isPureRTC) { }
+        const unsigned int instance_id;
+        /**
+         * Host copy of the instance's properties, and their layout
+         */
+        detail::EnvironmentStorage storage;
+        /**
+         * Metadata of each property owned by this instance
+         */
+        std::unordered_map<std::string, EnvProp> properties;
+        /**
+         * Properties whose data is owned by another instance
+         */
+        std::unordered_map<std::string, MappedProp> mapped_properties;
+        /**
+         * Offset of the instance's region within c_buffer
+         */
+        const ptrdiff_t constant_base;
+        /**
+         * Device copy of storage's global segment
+         */
+        char *d_global = nullptr;
+        size_t d_global_capacity = 0;
+        /**
+         * Names of the properties (and mapped properties) currently registered with curve
+         */
+        std::set<std::string> curve_registered;
+        /**
+         * Instances which own the master properties of mapped_properties
+         */
+        std::set<unsigned int> masters;
+        /**
+         * Instances which map properties owned by this instance
+         */
+        std::set<unsigned int> dependents;
+        /**
+         * The rtc cache, this is shared with submodels
+         */
+        std::shared_ptr<RTCEnvPropCache> rtc_cache;
+        /**
+         * The simulation used for RTC, set by initRTC()
+         */
+        const CUDASimulation *simulation = nullptr;
+        const bool isPureRTC;
+        EnvUpdateFlags flags;
+    };
+    typedef std::unordered_map<unsigned int, std::shared_ptr<Instance>> InstanceMap;
+    /**
+     * A resolved property
+     * If the requested property was mapped, this refers to the master property
+     */
+    struct PropRef {
+        /**
+         * Keeps the owning instance alive
+         */
+        std::shared_ptr<Instance> owner;
+        /**
+         * The name of the property within owner
+         */
+        const std::string *name;
+        EnvProp *prop;
+        /**
+         * Const status of the requested property, a mapped property may be const where the master is not
+         */
+        bool isConst;
+    };
     /**
      * Joins the two strings into a std::pair
      * @param instance_id becomes first item of pair
@@ -685,131 +690,119 @@ class EnvironmentManager {
      */
     detail::curve::Curve::VariableHash toHash(const NamePair &name) const;
     /**
-     * Common add handler
+     * Returns the named instance, or nullptr if it is not registered
+     * @note Does not lock a mutex
      */
-    void newProperty(const NamePair &name, const char *ptr, const size_t &len, const bool &isConst, const size_type &elements, const std::type_index &type);
+    std::shared_ptr<Instance> findInstanceData(const unsigned int &instance_id) const;
     /**
-     * Cleanup freeFragments
-     * @param curve The curve instance to use (important if thread has cuda device set wrong)
-     * @param mergeProps Used by init to defragement whilst merging in new data
-     * @param newmaps Namepairs of newly mapped properties, yet to to be setup (essentially ones not yet registered in curve)
-     * @param isPureRTC If true, Curve collision warnings (debug build only) will be suppressed as they are irrelevant to RTC models
-     * @note any EnvPROP
+     * Returns the named instance
+     * @param instance_id instance_id of the CUDASimulation instance
+     * @param caller Name of the calling method, used in the exception message
+     * @throws exception::UnknownInternalError If the instance is not registered
      */
-    void defragment(detail::curve::Curve &curve, const DefragMap * mergeProps = nullptr, std::set<NamePair> newmaps = {}, bool isPureRTC = false);
+    std::shared_ptr<Instance> getInstanceData(const unsigned int &instance_id, const char *caller) const;
     /**
-     * This is the RTC version of defragment()
-     * RTC Constant offsets are fixed at RTC time, and exist in their own constant block.
-     * Therefore if the main constant cache is defragmented, and offsets change, the RTC constants will be incorrect.
-     * Which fix this by maintaining a seperate constant cache per CUDASimulation instance
-     * @param instance_id Instance id of the cuda agent model that owns the properties
-     * @param master_instance_id Instance id of the parent model (If this isn't a submodel, pass instance_id here too
-     * @param mergeProperties Ordered map of properties to be stored.
+     * Resolves a property, following mappings to the master property
+     * @param name Name of the property
+     * @param caller Name of the calling method, used in the exception message
+     * @throws exception::InvalidEnvProperty If a property of the name does not exist
      */
-    void buildRTCOffsets(const unsigned int &instance_id, const unsigned int &master_instance_id, const DefragMap &mergeProperties);
+    PropRef findProperty(const NamePair &name, const char *caller) const;
     /**
-     * Returns the rtccache ptr for the named instance id
-     * @param instance_id Instance id of the cuda agent model that owns the properties
+     * Returns a pointer to the host copy of a resolved property's data
      */
-    char* getRTCCache(const unsigned int& instance_id);
+    static char *getPropertyPtr(const PropRef &p);
     /**
-     * Useful for adding individual variables to RTC cache later on
+     * Flags the device copy (and rtc cache) of a resolved property as out of date, after its host copy has been changed
      */
-    void addRTCOffset(const NamePair &name);
+    void propertyChanged(const PropRef &p);
     /**
-     * Device pointer to the environment property buffer in __constant__ memory
+     * Common init() handler
+     * @param master_instance_id Parent instance, nullptr if not a submodel
+     * @param mapping Submodel mapping, nullptr if not a submodel
      */
-    const char *c_buffer;
+    void initInstance(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC, const unsigned int *master_instance_id, const SubEnvironmentData *mapping);
     /**
-     * Host copy of the device memory pointed to by c_buffer
+     * Common add handler
      */
-    char hc_buffer[MAX_BUFFER_SIZE];
+    void newProperty(const NamePair &name, const char *ptr, const size_t &len, const bool &isConst, const size_type &elements, const std::type_index &type);
     /**
-     * Offset relative to c_buffer, where no more data has been stored
+     * Reserves a region of c_buffer for an instance
+     * The first gap large enough is used, otherwise the largest gap is used (this may be 0 bytes)
+     * @param required The number of bytes requested
+     * @return Offset and length of the reserved region
+     * @note You must acquire a unique lock on mutex before calling this method
      */
-    ptrdiff_t nextFree;
+    std::pair<ptrdiff_t, size_t> reserveConstantRegion(const size_t &required);
     /**
-     * Unused space within c_buffer, including gaps in freeFragments
+     * Flags an instance, and any instances which map its properties, as requiring curve registration
      */
-    size_t m_freeSpace;
+    void requireCurveRegistration(Instance &instance);
     /**
-     * List of fragments remaining from deleted environment variables
+     * (Re)registers all of an instance's properties with curve
+     * The instance's global memory, and that of its masters, must already be allocated
      */
-    std::list<OffsetLen> freeFragments;
+    void registerCurve(Instance &instance);
     /**
-     * Host copy of data related to each stored property
+     * Copies the changed byte ranges of an instance's host storage to the device
+     * Nearby ranges are coalesced, so that few copies are issued
+     * This (re)allocates the instance's global memory if required
+     * @param instance The instance to update
+     * @param stream The CUDA stream to issue the copies to
+     * @return True if any copies were issued
      */
-    std::unordered_map<NamePair, EnvProp, NamePairHash> properties;
+    bool updateInstanceDevice(Instance &instance, cudaStream_t stream);
     /**
-     * This lists all currently mapped properties, so their access can be redirected to the appropriate property
+     * Returns the device pointer which curve holds for a property
+     * For properties in constant memory this is an offset into c_buffer, otherwise it is a pointer to global memory
      */
-    std::unordered_map<NamePair, MappedProp, NamePairHash> mapped_properties;
+    static char *getCurvePtr(const Instance &instance, const detail::EnvironmentStorage::Placement &placement);
     /**
-     * Map of model name to CUDASimulation for use in updating RTC values
+     * Builds the RTC cache for a newly initialised instance
+     * @param instance The newly initialised instance
+     * @param master The master instance, whose cache is shared, nullptr if not a submodel
+     * @param order The instance's properties, in the order they should be added to the cache
      */
-    std::unordered_map<unsigned int, const CUDASimulation&> cuda_agent_models;
+    void buildRTCOffsets(Instance &instance, Instance *master, const std::vector<std::string> &order);
     /**
-     * Map of RTC caches per CUDASimulation instance
-     * They are shared by submodels
+     * Returns the rtccache ptr for the named instance id
+     * Any pointers to spilled properties held within the cache are updated, and their global memory copied to the device
+     * @param instance_id Instance id of the cuda agent model that owns the properties
+     * @param stream The CUDA stream to issue any global memory copies to
      */
-    std::unordered_map<unsigned int, std::shared_ptr<RTCEnvPropCache>> rtc_caches;
+    char* getRTCCache(const unsigned int& instance_id, cudaStream_t stream);
     /**
-     * Flag indicating that curve has/hasn't been initialised yet on a device.
-     */
-    bool deviceInitialised;
-    /*
-     * Convenience fn for managing deviceRequiresUpdate
-     * @param instance_id Sim instance id, UINT_MAX sets all
+     * Useful for adding individual variables to RTC cache later on
+     * @throws exception::OutOfMemory If the rtc cache is full
      */
-    void setDeviceRequiresUpdateFlag(const unsigned int &instance_id = UINT_MAX);
+    void addRTCOffset(Instance &instance, const std::string &name, EnvProp &prop);
     /**
-     * These flags control what happens when updateDevice() is called
-     * Their primary purpose is to cause the device memory to updated as lazily as possible
+     * Device pointer to the environment property buffer in __constant__ memory
      */
-    struct EnvUpdateFlags {
-        /**
-         * Update the device constant cache for main C env var storage
-         */
-        bool c_update_required = true;
-        /**
-         * Update the RTC environment cache for a specific CUDASimulation instance
-         */
-        bool rtc_update_required = true;
-        /**
-         * Additionally register all variables inside CURVE
-         * This should only be triggered after a device reset, when EnvironmentManager::purge()  has been called
-         * As properties are registered with curve when they are first added to EnvironmentManager
-         **/
-        bool curve_registration_required = false;
-    };
+    const char *c_buffer;
     /**
-     * Flag indicating whether the device copy is upto date
-     * sim_instance_id:(C needs update, RTC needs update)
+     * Regions of c_buffer reserved by instances, offset:length
      */
-    std::unordered_map<unsigned int, EnvUpdateFlags> deviceRequiresUpdate;
+    std::map<ptrdiff_t, size_t> constant_regions;
     /**
-     * Function to initialise device-side portions of the environment manager
+     * All currently registered instances
+     * This map is never modified, it is replaced via std::atomic_store() by init() and free()
+     * Readers take a copy via std::atomic_load(), so they do not require a lock
      */
-    void initialiseDevice();
+    std::shared_ptr<const InstanceMap> instances;
     /**
-     * Managed multi-threaded access to the internal storage
-     * All read-only methods take a shared-lock
-     * All methods which modify the internals require a unique-lock
-     * Some private methods expect a lock to be gained before calling (to prevent the same thread attempting to lock the mutex twice)
+     * Flag indicating that curve has/hasn't been initialised yet on a device.
      */
-    mutable std::shared_timed_mutex mutex;
-    std::shared_lock<std::shared_timed_mutex> getSharedLock() const { return std::shared_lock<std::shared_timed_mutex>(mutex); }
-    std::unique_lock<std::shared_timed_mutex> getUniqueLock() const { return std::unique_lock<std::shared_timed_mutex>(mutex); }
+    bool deviceInitialised;
     /**
-     * This mutex exists to stop defrag being called, between curve being updated, and an agent function executing
+     * Function to initialise device-side portions of the environment manager
      */
-    mutable std::shared_timed_mutex device_mutex;
-    std::shared_lock<std::shared_timed_mutex> getDeviceSharedLock() const { return std::shared_lock<std::shared_timed_mutex>(device_mutex); }
-    std::unique_lock<std::shared_timed_mutex> getDeviceUniqueLock() const { return std::unique_lock<std::shared_timed_mutex>(device_mutex); }
+    void initialiseDevice();
     /**
-     * This mutex only protects deviceRequiresUpdate map
+     * Serialises writers of instances and constant_regions (init(), free() and purge())
+     * Reads and writes of individual properties do not lock this mutex
      */
-    mutable std::shared_timed_mutex deviceRequiresUpdate_mutex;
+    mutable std::shared_timed_mutex mutex;
     /**
      * Remainder of class is singleton pattern
      */
@@ -831,9 +824,9 @@ class EnvironmentManager {
     const CUDASimulation& getCUDASimulation(const unsigned int &instance_id);
     /**
      * Update the copy of the env var that exists in the rtc_cache to match the main cache
-     * @param name namepair of the variable to be updated
+     * @param p The resolved property to be updated
      */
-    void updateRTCValue(const NamePair &name);
+    void updateRTCValue(const PropRef &p);
 
  public:
     // Public deleted creates better compiler errors
@@ -850,11 +843,6 @@ void EnvironmentManager::newProperty(const NamePair &name, const T &value, const
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    if (containsProperty(name)) {
-        THROW exception::DuplicateEnvProperty("Environmental property with name '%u:%s' already exists, "
-            "in EnvironmentManager::add().",
-            name.first, name.second.c_str());
-    }
     newProperty(name, reinterpret_cast<const char*>(&value), sizeof(T), isConst, 1, typeid(T));
 }
 template<typename T>
@@ -867,11 +855,6 @@ void EnvironmentManager::newProperty(const NamePair &name, const std::array<T, N
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    if (containsProperty(name)) {
-        THROW exception::DuplicateEnvProperty("Environmental property with name '%u:%s' already exists, "
-            "in EnvironmentManager::add().",
-            name.first, name.second.c_str());
-    }
     newProperty(name, reinterpret_cast<const char*>(value.data()), N * sizeof(T), isConst, N, typeid(T));
 }
 template<typename T, EnvironmentManager::size_type N>
@@ -888,40 +871,32 @@ T EnvironmentManager::setProperty(const NamePair &name, const T &value) {
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "setProperty");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::setProperty().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     if (array_len != type_decode<T>::len_t) {
         THROW exception::InvalidEnvPropertyType("Named environmental property is an array of length %u, the array function or appropriate vector type must be used! "
             "in EnvironmentManager::setProperty().",
             array_len);
     }
-    if (isConst(name)) {
+    if (p.isConst) {
         THROW exception::ReadOnlyEnvProperty("Environmental property ('%u:%s') is marked as const and cannot be changed, "
             "in EnvironmentManager::setProperty().",
             name.first, name.second.c_str());
     }
+    char *const ptr = getPropertyPtr(p);
     // Copy old data to return
-    T rtn = getProperty<T>(name);
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-    } else {
-        buffOffset = properties.at(mapped_properties.at(name).masterProp).offset;
-    }
+    T rtn;
+    memcpy(&rtn, ptr, sizeof(T));
     // Store data
-    memcpy(hc_buffer + buffOffset, &value, sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
+    memcpy(ptr, &value, sizeof(T));
+    // Set device update flag, and do rtc too
+    propertyChanged(p);
 
     return rtn;
 }
@@ -935,40 +910,32 @@ std::array<T, N> EnvironmentManager::setProperty(const NamePair &name, const std
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "setProperty");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::setProperty().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    if (isConst(name)) {
+    if (p.isConst) {
         THROW exception::ReadOnlyEnvProperty("Environmental property array ('%u:%s') is marked as const and cannot be changed, "
             "in EnvironmentManager::setProperty().",
             name.first, name.second.c_str());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     if (array_len != type_decode<T>::len_t * N) {
         THROW exception::OutOfBoundsException("Length of named environmental property array (%u) does not match template argument N (%u)! "
             "in EnvironmentManager::setProperty().",
             array_len, type_decode<T>::len_t * N);
     }
+    char *const ptr = getPropertyPtr(p);
     // Copy old data to return
-    std::array<T, N> rtn = getProperty<T, N>(name);
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-    } else {
-        buffOffset = properties.at(mapped_properties.at(name).masterProp).offset;
-    }
+    std::array<T, N> rtn;
+    memcpy(rtn.data(), ptr, N * sizeof(T));
     // Store data
-    memcpy(hc_buffer + buffOffset, value.data(), N * sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
+    memcpy(ptr, value.data(), N * sizeof(T));
+    // Set device update flag, and do rtc too
+    propertyChanged(p);
 
     return rtn;
 }
@@ -983,45 +950,32 @@ std::vector<T> EnvironmentManager::setPropertyArray(const NamePair& name, const
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "setPropertyArray");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::setPropertyArray().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    if (isConst(name)) {
+    if (p.isConst) {
         THROW exception::ReadOnlyEnvProperty("Environmental property array ('%u:%s') is marked as const and cannot be changed, "
             "in EnvironmentManager::setPropertyArray().",
             name.first, name.second.c_str());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     if (array_len != type_decode<T>::len_t * value.size()) {
         THROW exception::OutOfBoundsException("Length of named environmental property array (%u) does not match length of provided array (%llu)! "
             "in EnvironmentManager::setPropertyArray().",
             array_len, type_decode<T>::len_t * value.size());
     }
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-    } else {
-        buffOffset = properties.at(mapped_properties.at(name).masterProp).offset;
-    }
+    char *const ptr = getPropertyPtr(p);
     // Copy old data to return
     std::vector<T> rtn(value.size());
-    if (a != properties.end()) {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + buffOffset), array_len * sizeof(T));
-    } else {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + buffOffset), array_len * sizeof(T));
-    }
+    memcpy(rtn.data(), ptr, value.size() * sizeof(T));
     // Store data
-    memcpy(hc_buffer + buffOffset, value.data(), value.size() * sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
+    memcpy(ptr, value.data(), value.size() * sizeof(T));
+    // Set device update flag, and do rtc too
+    propertyChanged(p);
 
     return rtn;
 }
@@ -1032,42 +986,33 @@ T EnvironmentManager::setProperty(const NamePair &name, const size_type &index,
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "setProperty");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::setProperty().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    if (isConst(name)) {
+    if (p.isConst) {
         THROW exception::ReadOnlyEnvProperty("Environmental property array ('%u:%s') is marked as const and cannot be changed, "
             "in EnvironmentManager::setProperty().",
             name.first, name.second.c_str());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     const unsigned int t_index = type_decode<T>::len_t * index + type_decode<T>::len_t;
     if (t_index > array_len || t_index < index) {
         THROW exception::OutOfBoundsException("Index(%u) exceeds named environmental property array's length (%u), "
             "in EnvironmentManager::setProperty().",
             index, array_len);
     }
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset + index * sizeof(T);
-    } else {
-        const auto &master_name = mapped_properties.at(name).masterProp;
-        buffOffset = properties.at(master_name).offset + index * sizeof(T);
-    }
+    char *const ptr = getPropertyPtr(p) + index * sizeof(T);
     // Copy old data to return
-    T rtn = *reinterpret_cast<T*>(hc_buffer + buffOffset);
+    T rtn;
+    memcpy(&rtn, ptr, sizeof(T));
     // Store data
-    memcpy(hc_buffer + buffOffset, &value, sizeof(T));
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
+    memcpy(ptr, &value, sizeof(T));
+    // Set device update flag, and do rtc too
+    propertyChanged(p);
 
     return rtn;
 }
@@ -1085,24 +1030,22 @@ T EnvironmentManager::getProperty(const NamePair &name) {
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "getProperty");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::getProperty().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     if (array_len != type_decode<T>::len_t) {
         THROW exception::InvalidEnvPropertyType("Named environmental property is an array of length %u, the array function or appropriate vector type must be used! "
             "in EnvironmentManager::getProperty().",
             array_len);
     }
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    // Copy old data to return
-    const auto a = properties.find(name);
-    if (a != properties.end())
-        return *reinterpret_cast<T*>(hc_buffer + a->second.offset);
-    return *reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset);
+    T rtn;
+    memcpy(&rtn, getPropertyPtr(p), sizeof(T));
+    return rtn;
 }
 template<typename T>
 T EnvironmentManager::getProperty(const unsigned int &instance_id, const std::string &var_name) {
@@ -1114,13 +1057,14 @@ std::array<T, N> EnvironmentManager::getProperty(const NamePair &name) {
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "getProperty");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::getProperty().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     if (array_len != N * type_decode<T>::len_t) {
         THROW exception::OutOfBoundsException("Length of named environmental property array (%u) does not match templated length (%u)! "
             "in EnvironmentManager::getProperty().",
@@ -1128,13 +1072,7 @@ std::array<T, N> EnvironmentManager::getProperty(const NamePair &name) {
     }
     // Copy old data to return
     std::array<T, N> rtn;
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + a->second.offset), N * sizeof(T));
-    } else {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset), N * sizeof(T));
-    }
+    memcpy(rtn.data(), getPropertyPtr(p), N * sizeof(T));
     return rtn;
 }
 template<typename T, EnvironmentManager::size_type N>
@@ -1147,25 +1085,23 @@ T EnvironmentManager::getProperty(const NamePair &name, const size_type &index)
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "getProperty");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::getProperty().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     const unsigned int t_index = type_decode<T>::len_t * index + type_decode<T>::len_t;
     if (t_index > array_len || t_index < index) {
         THROW exception::OutOfBoundsException("Index(%u) exceeds named environmental property array's length (%u), "
             "in EnvironmentManager::getProperty().",
             type_decode<T>::len_t * index, array_len);
     }
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    // Copy old data to return
-    const auto a = properties.find(name);
-    if (a != properties.end())
-        return *reinterpret_cast<T*>(hc_buffer + a->second.offset + index * sizeof(T));
-    return *reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset + index * sizeof(T));
+    T rtn;
+    memcpy(&rtn, getPropertyPtr(p) + index * sizeof(T), sizeof(T));
+    return rtn;
 }
 #ifdef SWIG
 template<typename T>
@@ -1174,13 +1110,14 @@ std::vector<T> EnvironmentManager::getPropertyArray(const NamePair& name) {
     // Compound types would allow host pointers inside structs to be passed
     static_assert(std::is_arithmetic<typename type_decode<T>::type_t>::value || std::is_enum<typename type_decode<T>::type_t>::value,
         "Only arithmetic types can be used as environmental properties");
-    const std::type_index typ_id = type(name);
+    const PropRef p = findProperty(name, "getPropertyArray");
+    const std::type_index typ_id = p.prop->type;
     if (typ_id != std::type_index(typeid(typename type_decode<T>::type_t))) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') type (%s) does not match template argument T (%s), "
             "in EnvironmentManager::getPropertyArray().",
             name.first, name.second.c_str(), typ_id.name(), typeid(typename type_decode<T>::type_t).name());
     }
-    const size_type array_len = length(name);
+    const size_type array_len = p.prop->elements;
     if (array_len % type_decode<T>::len_t != 0) {
         THROW exception::InvalidEnvPropertyType("Environmental property array ('%u:%s') length (%u) is not a multiple of vector length (%d), "
             "in EnvironmentManager::getPropertyArray().",
@@ -1188,13 +1125,7 @@ std::vector<T> EnvironmentManager::getPropertyArray(const NamePair& name) {
     }
     // Copy old data to return
     std::vector<T> rtn(static_cast<size_t>(array_len / type_decode<T>::len_t));
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + a->second.offset), array_len * sizeof(typename type_decode<T>::type_t));
-    } else {
-        memcpy(rtn.data(), reinterpret_cast<T*>(hc_buffer + properties.at(mapped_properties.at(name).masterProp).offset), array_len * sizeof(typename type_decode<T>::type_t));
-    }
+    memcpy(rtn.data(), getPropertyPtr(p), array_len * sizeof(typename type_decode<T>::type_t));
     return rtn;
 }
 #endif
@@ -0,0 +1,195 @@
+#ifndef INCLUDE_FLAMEGPU_RUNTIME_UTILITY_ENVIRONMENTSTORAGE_H_
+#define INCLUDE_FLAMEGPU_RUNTIME_UTILITY_ENVIRONMENTSTORAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "flamegpu/util/detail/DirtyRangeSet.h"
+
+namespace flamegpu {
+namespace detail {
+
+/**
+ * Host storage, and layout, of the environment properties owned by a single simulation instance
+ *
+ * Each property is placed within one of two segments:
+ * > The constant segment has a fixed capacity, it mirrors the instance's region of the device's __constant__ environment buffer
+ * > The global segment grows on demand, it mirrors an allocation in device global memory
+ * Properties are placed within the constant segment where possible, properties which do not fit (even after defragmenting
+ * the constant segment) spill into the global segment.
+ * Once placed, a property never changes segment. However, defragment() may change its offset within the segment.
+ * Each segment tracks the byte ranges which have changed since the device copy was last updated.
+ *
+ * This class has no CUDA dependencies, the device copies of the segments are managed by EnvironmentManager
+ * @note Not thread-safe, each instance is only accessed by the thread executing the owning simulation
+ */
+class EnvironmentStorage {
+ public:
+    enum Segment : unsigned char {
+        Constant = 0,
+        Global = 1,
+    };
+    /**
+     * Location of a property's data
+     */
+    struct Placement {
+        Segment segment;
+        /**
+         * Offset relative to the start of the segment
+         */
+        ptrdiff_t offset;
+        /**
+         * Length in bytes
+         */
+        size_t length;
+        /**
+         * Required alignment of offset, this is the size of the property's base type
+         */
+        size_t alignment;
+    };
+    /**
+     * @param constant_capacity Capacity of the constant segment in bytes, this may be 0
+     */
+    explicit EnvironmentStorage(size_t constant_capacity);
+    /**
+     * Allocates space for a new property, the contents of which are zero initialised
+     * @param name Name of the property
+     * @param length Length of the property in bytes
+     * @param alignment Alignment of the property, this must be a power of 2 which divides length
+     * @return The location of the property
+     * @throws exception::DuplicateEnvProperty If a property with the same name already exists
+     * @throws exception::InvalidArgument If alignment is not a power of 2 which divides length
+     */
+    const Placement &allocate(const std::string &name, size_t length, size_t alignment);
+    /**
+     * Releases the space used by a property
+     * @param name Name of the property
+     * @throws exception::InvalidEnvProperty If the property does not exist
+     */
+    void release(const std::string &name);
+    /**
+     * Compacts both segments, such that they contain no gaps
+     * Properties are ordered by descending alignment, so that no padding is required between them
+     * @return True if the offset of any property changed
+     */
+    bool defragment();
+    /**
+     * @param name Name of the property
+     * @return The location of the property, or nullptr if it does not exist
+     */
+    const Placement *find(const std::string &name) const;
+    /**
+     * @param p Location of the property
+     * @return Pointer to the property's data within the host copy of its segment
+     * @note This pointer is invalidated by any call to allocate(), release() or defragment()
+     */
+    char *getHostPtr(const Placement &p) { return (p.segment == Constant ? constant_buffer.data() : global_buffer.data()) + p.offset; }
+    const char *getHostPtr(const Placement &p) const { return (p.segment == Constant ? constant_buffer.data() : global_buffer.data()) + p.offset; }
+    /**
+     * Marks the property's bytes as requiring copying to the device
+     * Properties are marked when allocated, or moved by defragment(), so this is only required after writing to a property
+     * @param p Location of the property
+     */
+    void markDirty(const Placement &p) { (p.segment == Constant ? constant_dirty : global_dirty).add(p.offset, p.offset + p.length); }
+    /**
+     * Marks the used part of both segments as requiring copying to the device
+     * This is required if the device copies are lost or reallocated
+     */
+    void markAllDirty() {
+        constant_dirty.add(0, getConstantSize());
+        global_dirty.add(0, getGlobalSize());
+    }
+    /**
+     * Byte ranges of the segment which have changed since clearDirty() was last called
+     */
+    const util::detail::DirtyRangeSet &getDirty(const Segment segment) const { return segment == Constant ? constant_dirty : global_dirty; }
+    void clearDirty(const Segment segment) { (segment == Constant ? constant_dirty : global_dirty).clear(); }
+    /**
+     * Host copy of the constant segment
+     */
+    const char *getConstantBuffer() const { return constant_buffer.data(); }
+    size_t getConstantCapacity() const { return constant_buffer.size(); }
+    /**
+     * Returns the number of bytes at the start of the constant segment which contain properties (and any gaps between them)
+     */
+    size_t getConstantSize() const { return static_cast<size_t>(constant.nextFree); }
+    /**
+     * Returns the unused space within the constant segment, including gaps
+     */
+    size_t getConstantFreeSpace() const { return constant_buffer.size() - constant.used; }
+    /**
+     * Host copy of the global segment
+     */
+    const char *getGlobalBuffer() const { return global_buffer.data(); }
+    /**
+     * Returns the number of bytes at the start of the global segment which contain properties (and any gaps between them)
+     */
+    size_t getGlobalSize() const { return global_buffer.size(); }
+    /**
+     * Incremented whenever defragment() changes the offset of an existing property
+     * Allocating and releasing properties do not move other properties
+     */
+    uint64_t getLayoutVersion() const { return layout_version; }
+    /**
+     * Returns the location of every property, ordered by name
+     */
+    const std::map<std::string, Placement> &getPlacements() const { return placements; }
+
+ private:
+    /**
+     * Allocation state of a segment
+     */
+    struct SegmentState {
+        /**
+         * Gaps before nextFree, keyed by offset with their length
+         * Adjacent gaps are always merged
+         */
+        std::map<ptrdiff_t, size_t> freeFragments;
+        /**
+         * Offset at which no more data has been stored
+         */
+        ptrdiff_t nextFree = 0;
+        /**
+         * Bytes used by properties
+         */
+        size_t used = 0;
+    };
+    /**
+     * Attempts to allocate space within a segment, first from the free fragments, then at the end of the segment
+     * @param seg The segment to allocate from
+     * @param capacity Maximum value of nextFree for the segment
+     * @param length Bytes to allocate
+     * @param alignment Required alignment of the returned offset
+     * @param offset Returns the offset of the allocation
+     * @return True if the allocation was successful
+     */
+    static bool tryAllocate(SegmentState &seg, size_t capacity, size_t length, size_t alignment, ptrdiff_t &offset);
+    /**
+     * Returns a range to the free fragments of a segment, merging it with adjacent fragments, or rolling back nextFree
+     */
+    static void releaseRange(SegmentState &seg, ptrdiff_t offset, size_t length);
+    /**
+     * Compacts a single segment
+     * @return True if the offset of any property changed
+     */
+    bool defragment(Segment segment);
+    std::vector<char> constant_buffer;
+    /**
+     * The size of global_buffer always matches global.nextFree
+     */
+    std::vector<char> global_buffer;
+    SegmentState constant;
+    SegmentState global;
+    util::detail::DirtyRangeSet constant_dirty;
+    util::detail::DirtyRangeSet global_dirty;
+    std::map<std::string, Placement> placements;
+    uint64_t layout_version = 0;
+};
+
+}  // namespace detail
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_RUNTIME_UTILITY_ENVIRONMENTSTORAGE_H_
@@ -4,9 +4,11 @@
 #include <cuda_runtime.h>
 #include <device_launch_parameters.h>  // Required for SEATBELTS=OFF builds for some reason.
 
+#include <cstring>
 #include <unordered_map>
 #include <array>
 #include <string>
+#include <typeindex>
 #include <utility>
 #include <set>
 #include <vector>
@@ -15,6 +17,8 @@
 #include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
 #include "flamegpu/runtime/utility/EnvironmentManager.cuh"
 #include "flamegpu/runtime/utility/HostMacroProperty.cuh"
+#include "flamegpu/util/Any.h"
+#include "flamegpu/util/type_decode.h"
 
 namespace flamegpu {
 
@@ -23,6 +27,7 @@ namespace flamegpu {
  * It acts as a wrapper to EnvironmentManager, proxying calls, converting variable name and model_name into a combined hash
  * Pairs with EnvironmentManager, AgentEnvironment and EnvironmentDescription
  * This class is only to be constructed by HostAPI
+ * When constructed for CPUReferenceSimulation, properties are instead accessed directly within the simulation's host property store
  * @note Not thread-safe
  */
 class HostEnvironment {
@@ -36,19 +41,48 @@ class HostEnvironment {
      * Constructor, to be called by HostAPI
      */
     explicit HostEnvironment(const unsigned int &instance_id, CUDAMacroEnvironment &_macro_env);
+    /**
+     * Constructor, to be called by HostAPI on behalf of CPUReferenceSimulation
+     * Macro properties are not available
+     * @param _host_properties The simulation's environment property store
+     * @param _host_read_only Names of the properties within the store which are marked const
+     */
+    HostEnvironment(std::unordered_map<std::string, util::Any> &_host_properties, const std::set<std::string> &_host_read_only);
+    /**
+     * Locates the named property within host_properties, validating it's type and length
+     * @param name Name of the property
+     * @param type Type of the property's elements
+     * @param elements Number of elements accessed, if index is nullptr this must match the property's length (0 permits any length)
+     * @param index If provided, the elements accessed are those of the index'th block of elements
+     * @param write If true, properties marked const are rejected
+     * @param caller Name of the calling method, included in exception messages
+     * @return Pointer to the first element accessed
+     */
+    char *getHostPropertyPtr(const std::string &name, const std::type_index &type, EnvironmentManager::size_type elements,
+        const EnvironmentManager::size_type *index, bool write, const char *caller) const;
     /**
      * Provides access to EnvironmentManager singleton
+     * nullptr if constructed for CPUReferenceSimulation
      */
-    EnvironmentManager &env_mgr;
+    EnvironmentManager *const env_mgr;
     /**
      * Provides access to macro properties for the instance
+     * nullptr if constructed for CPUReferenceSimulation
      */
-    CUDAMacroEnvironment& macro_env;
+    CUDAMacroEnvironment *const macro_env;
     /**
      * Access to instance id of the CUDASimulation
      * This is used to augment all variable names
      */
     const unsigned int instance_id;
+    /**
+     * CPUReferenceSimulation's environment property store, nullptr if constructed for CUDASimulation
+     */
+    std::unordered_map<std::string, util::Any> *const host_properties;
+    /**
+     * Names of the properties within host_properties which are marked const
+     */
+    const std::set<std::string> *const host_read_only;
 
  public:
     /**
@@ -141,6 +175,7 @@ class HostEnvironment {
     /**
      * Returns an interface for accessing the named host macro property
      * @param name The name of the environment macro property to return
+     * @throws exception::InvalidOperation If called from a CPUReferenceSimulation
      */
     template<typename T, unsigned int I = 1, unsigned int J = 1, unsigned int K = 1, unsigned int W = 1>
     HostMacroProperty<T, I, J, K, W> getMacroProperty(const std::string& name) const;
@@ -148,6 +183,7 @@ class HostEnvironment {
     /**
      * None-templated dimensions version of getMacroProperty() for SWIG interface
      * @param name The name of the environment macro property to return
+     * @throws exception::InvalidOperation If called from a CPUReferenceSimulation
      */
     template<typename T>
     HostMacroProperty_swig<T> getMacroProperty_swig(const std::string& name) const;
@@ -163,7 +199,14 @@ T HostEnvironment::setProperty(const std::string &name, const T &value) const {
         THROW exception::ReservedName("Environment property names cannot begin with '_', this is reserved for internal usage, "
             "in HostEnvironment::set().");
     }
-    return env_mgr.setProperty<T>({ instance_id, name }, value);
+    if (host_properties) {
+        char *const ptr = getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), type_decode<T>::len_t, nullptr, true, "HostEnvironment::setProperty()");
+        T rtn;
+        memcpy(&rtn, ptr, sizeof(T));
+        memcpy(ptr, &value, sizeof(T));
+        return rtn;
+    }
+    return env_mgr->setProperty<T>({ instance_id, name }, value);
 }
 template<typename T, EnvironmentManager::size_type N>
 std::array<T, N> HostEnvironment::setProperty(const std::string &name, const std::array<T, N> &value) const {
@@ -171,7 +214,14 @@ std::array<T, N> HostEnvironment::setProperty(const std::string &name, const std
         THROW exception::ReservedName("Environment property names cannot begin with '_', this is reserved for internal usage, "
             "in HostEnvironment::set().");
     }
-    return env_mgr.setProperty<T, N>({ instance_id, name }, value);
+    if (host_properties) {
+        char *const ptr = getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), N * type_decode<T>::len_t, nullptr, true, "HostEnvironment::setProperty()");
+        std::array<T, N> rtn;
+        memcpy(rtn.data(), ptr, sizeof(T) * N);
+        memcpy(ptr, value.data(), sizeof(T) * N);
+        return rtn;
+    }
+    return env_mgr->setProperty<T, N>({ instance_id, name }, value);
 }
 template<typename T>
 T HostEnvironment::setProperty(const std::string &name, const EnvironmentManager::size_type &index, const T &value) const {
@@ -179,7 +229,14 @@ T HostEnvironment::setProperty(const std::string &name, const EnvironmentManager
         THROW exception::ReservedName("Environment property names cannot begin with '_', this is reserved for internal usage, "
             "in HostEnvironment::set().");
     }
-    return env_mgr.setProperty<T>({ instance_id, name }, index, value);
+    if (host_properties) {
+        char *const ptr = getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), type_decode<T>::len_t, &index, true, "HostEnvironment::setProperty()");
+        T rtn;
+        memcpy(&rtn, ptr, sizeof(T));
+        memcpy(ptr, &value, sizeof(T));
+        return rtn;
+    }
+    return env_mgr->setProperty<T>({ instance_id, name }, index, value);
 }
 #ifdef SWIG
 template<typename T>
@@ -188,7 +245,15 @@ std::vector<T> HostEnvironment::setPropertyArray(const std::string &name, const
         THROW exception::ReservedName("Environment property names cannot begin with '_', this is reserved for internal usage, "
             "in HostEnvironment::setArray().");
     }
-    return env_mgr.setPropertyArray<T>({ instance_id, name }, value);
+    if (host_properties) {
+        char *const ptr = getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)),
+            static_cast<EnvironmentManager::size_type>(value.size() * type_decode<T>::len_t), nullptr, true, "HostEnvironment::setPropertyArray()");
+        std::vector<T> rtn(value.size());
+        memcpy(rtn.data(), ptr, sizeof(T) * value.size());
+        memcpy(ptr, value.data(), sizeof(T) * value.size());
+        return rtn;
+    }
+    return env_mgr->setPropertyArray<T>({ instance_id, name }, value);
 }
 #endif  // SWIG
 
@@ -197,32 +262,61 @@ std::vector<T> HostEnvironment::setPropertyArray(const std::string &name, const
  */
 template<typename T>
 T HostEnvironment::getProperty(const std::string &name) const  {
-    return env_mgr.getProperty<T>({ instance_id, name });
+    if (host_properties) {
+        T rtn;
+        memcpy(&rtn, getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), type_decode<T>::len_t, nullptr, false, "HostEnvironment::getProperty()"), sizeof(T));
+        return rtn;
+    }
+    return env_mgr->getProperty<T>({ instance_id, name });
 }
 template<typename T, EnvironmentManager::size_type N>
 std::array<T, N> HostEnvironment::getProperty(const std::string &name) const  {
-    return env_mgr.getProperty<T, N>({ instance_id, name });
+    if (host_properties) {
+        std::array<T, N> rtn;
+        memcpy(rtn.data(), getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), N * type_decode<T>::len_t, nullptr, false, "HostEnvironment::getProperty()"), sizeof(T) * N);
+        return rtn;
+    }
+    return env_mgr->getProperty<T, N>({ instance_id, name });
 }
 template<typename T>
 T HostEnvironment::getProperty(const std::string &name, const EnvironmentManager::size_type &index) const  {
-    return env_mgr.getProperty<T>({ instance_id, name }, index);
+    if (host_properties) {
+        T rtn;
+        memcpy(&rtn, getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), type_decode<T>::len_t, &index, false, "HostEnvironment::getProperty()"), sizeof(T));
+        return rtn;
+    }
+    return env_mgr->getProperty<T>({ instance_id, name }, index);
 }
 #ifdef SWIG
 template<typename T>
 std::vector<T> HostEnvironment::getPropertyArray(const std::string& name) const {
-    return env_mgr.getPropertyArray<T>({instance_id, name});
+    if (host_properties) {
+        const char *const ptr = getHostPropertyPtr(name, std::type_index(typeid(typename type_decode<T>::type_t)), 0, nullptr, false, "HostEnvironment::getPropertyArray()");
+        std::vector<T> rtn(host_properties->at(name).elements / type_decode<T>::len_t);
+        memcpy(rtn.data(), ptr, sizeof(T) * rtn.size());
+        return rtn;
+    }
+    return env_mgr->getPropertyArray<T>({instance_id, name});
 }
 #endif  // SWIG
 
 template<typename T, unsigned int I, unsigned int J, unsigned int K, unsigned int W>
 HostMacroProperty<T, I, J, K, W> HostEnvironment::getMacroProperty(const std::string& name) const {
-    return macro_env.getProperty<T, I, J, K, W>(name);
+    if (!macro_env) {
+        THROW exception::InvalidOperation("Environment macro properties are not supported by CPUReferenceSimulation, "
+            "in HostEnvironment::getMacroProperty()\n");
+    }
+    return macro_env->getProperty<T, I, J, K, W>(name);
 }
 
 #ifdef SWIG
 template<typename T>
 HostMacroProperty_swig<T> HostEnvironment::getMacroProperty_swig(const std::string& name) const {
-    return macro_env.getProperty_swig<T>(name);
+    if (!macro_env) {
+        THROW exception::InvalidOperation("Environment macro properties are not supported by CPUReferenceSimulation, "
+            "in HostEnvironment::getMacroProperty()\n");
+    }
+    return macro_env->getProperty_swig<T>(name);
 }
 #endif
 }  // namespace flamegpu
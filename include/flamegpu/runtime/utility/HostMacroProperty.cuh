@@ -6,24 +6,83 @@
 #include <array>
 #include <memory>
 #include <cmath>
+#include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/util/detail/DirtyRangeSet.h"
 
 namespace flamegpu {
 
+/**
+ * Performs the transfers between an environment macro property's device buffer and it's host copy
+ * This allows the transfers made by HostMacroProperty to be observed, and HostMacroProperty to be used without a device
+ */
+struct HostMacroProperty_Backend {
+    virtual ~HostMacroProperty_Backend() = default;
+    /**
+     * Copy bytes from device memory to host memory
+     */
+    virtual void download(void *h_dst, const void *d_src, size_t bytes) = 0;
+    /**
+     * Copy bytes from host memory to device memory
+     */
+    virtual void upload(void *d_dst, const void *h_src, size_t bytes) = 0;
+    /**
+     * Set bytes of device memory to zero
+     */
+    virtual void zero(void *d_dst, size_t bytes) = 0;
+};
+/**
+ * HostMacroProperty_Backend which transfers via the CUDA runtime
+ */
+struct HostMacroProperty_CUDABackend : public HostMacroProperty_Backend {
+    void download(void *h_dst, const void *d_src, size_t bytes) override {
+        gpuErrchk(cudaMemcpy(h_dst, d_src, bytes, cudaMemcpyDeviceToHost));
+    }
+    void upload(void *d_dst, const void *h_src, size_t bytes) override {
+        gpuErrchk(cudaMemcpy(d_dst, h_src, bytes, cudaMemcpyHostToDevice));
+    }
+    void zero(void *d_dst, size_t bytes) override {
+        gpuErrchk(cudaMemset(d_dst, 0, bytes));
+    }
+};
+
+/**
+ * Host copy of an environment macro property, shared by all HostMacroProperty instances of the property
+ *
+ * The host copy is divided into tiles, which are downloaded when an element within them is first accessed.
+ * Modified elements are tracked as ranges, so that only modified parts of the property are uploaded.
+ */
 struct HostMacroProperty_MetaData {
+    /**
+     * Maximum number of disjoint modified ranges tracked, beyond this the closest ranges are merged
+     */
+    static const size_t MAX_DIRTY_RANGES = 256;
     /**
      * Constructor
+     * @param _d_base_ptr Device buffer of the macro property
+     * @param _dims Dimensions of the macro property
+     * @param _type_size Size of the macro property's type
+     * @param _device_read_flag True if the macro property has been read by an agent function in the current layer
+     * @param name Name of the macro property
+     * @param download_tile_bytes Approximate size of each download tile in bytes, if 0 the whole property is downloaded on first access
+     * @param _backend Performs transfers, if nullptr a HostMacroProperty_CUDABackend is used
      */
     HostMacroProperty_MetaData(void* _d_base_ptr, const std::array<unsigned int, 4>& _dims, size_t _type_size,
-        bool _device_read_flag, const std::string &name)
+        bool _device_read_flag, const std::string &name, size_t download_tile_bytes = 0,
+        std::shared_ptr<HostMacroProperty_Backend> _backend = nullptr)
         : h_base_ptr(nullptr)
         , d_base_ptr(static_cast<char*>(_d_base_ptr))
         , dims(_dims)
         , elements(dims[0] * dims[1] * dims[2] * dims[3])
         , type_size(_type_size)
-        , has_changed(false)
         , device_read_flag(_device_read_flag)
         , property_name(name)
+        , backend(_backend ? std::move(_backend) : std::make_shared<HostMacroProperty_CUDABackend>())
+        , tile_elements(download_tile_bytes ? static_cast<unsigned int>(std::min<size_t>(std::max<size_t>(download_tile_bytes / type_size, 1), elements)) : elements)
+        , dirty(MAX_DIRTY_RANGES)
     { }
     ~HostMacroProperty_MetaData() {
         upload();
@@ -31,20 +90,81 @@ struct HostMacroProperty_MetaData {
             std::free(h_base_ptr);
     }
     /**
-     * Download data
+     * Ensure the elements [first, last) are available in the host copy, downloading any tiles which are not
+     * Consecutive tiles are downloaded with a single copy
      */
-    void download() {
+    void download(size_t first, size_t last) {
         if (!h_base_ptr) {
             h_base_ptr = static_cast<char*>(malloc(elements * type_size));
-            gpuErrchk(cudaMemcpy(h_base_ptr, d_base_ptr, elements * type_size, cudaMemcpyDeviceToHost));
-            has_changed = false;
+            tile_resident.assign((elements + tile_elements - 1) / tile_elements, false);
+        }
+        if (first >= last)
+            return;
+        const size_t last_tile = (last + tile_elements - 1) / tile_elements;
+        size_t t = first / tile_elements;
+        while (t < last_tile) {
+            if (tile_resident[t]) {
+                ++t;
+                continue;
+            }
+            size_t run_end = t + 1;
+            while (run_end < last_tile && !tile_resident[run_end])
+                ++run_end;
+            const size_t begin = t * tile_elements;
+            const size_t end = std::min<size_t>(run_end * tile_elements, elements);
+            backend->download(h_base_ptr + begin * type_size, d_base_ptr + begin * type_size, (end - begin) * type_size);
+            for (; t < run_end; ++t)
+                tile_resident[t] = true;
         }
     }
     /**
-     * Upload data
+     * Ensure the whole property is available in the host copy
+     */
+    void download() {
+        download(0, elements);
+    }
+    /**
+     * Mark the elements [first, last) as modified, so they are uploaded by the next call to upload()
+     * The elements must already be available in the host copy
+     */
+    void markChanged(size_t first, size_t last) {
+        dirty.add(first, last);
+    }
+    /**
+     * Zero the elements [first, last)
+     * If the host copy does not exist, the device buffer is zeroed directly
+     */
+    void zero(size_t first, size_t last) {
+        if (first >= last)
+            return;
+        if (!h_base_ptr) {
+#if !defined(SEATBELTS) || SEATBELTS
+            if (device_read_flag) {
+                THROW flamegpu::exception::InvalidEnvProperty("The environment macro property '%s' was not found, "
+                    "in HostMacroProperty::zero()\n",
+                    property_name.c_str());
+            }
+#endif
+            backend->zero(d_base_ptr + first * type_size, (last - first) * type_size);
+            return;
+        }
+        // Tiles which are completely zeroed need not be downloaded, partially zeroed tiles must be
+        for (size_t t = first / tile_elements; t <= (last - 1) / tile_elements; ++t) {
+            const size_t begin = t * tile_elements;
+            const size_t end = std::min<size_t>(begin + tile_elements, elements);
+            if (begin >= first && end <= last)
+                tile_resident[t] = true;
+            else
+                download(begin, end);
+        }
+        memset(h_base_ptr + first * type_size, 0, (last - first) * type_size);
+        dirty.add(first, last);
+    }
+    /**
+     * Upload modified elements
      */
     void upload() {
-        if (h_base_ptr && has_changed) {
+        if (h_base_ptr && !dirty.empty()) {
 #if !defined(SEATBELTS) || SEATBELTS
             if (device_read_flag) {
                 THROW flamegpu::exception::InvalidEnvProperty("The environment macro property '%s' was not found, "
@@ -52,8 +172,20 @@ struct HostMacroProperty_MetaData {
                     property_name.c_str());
             }
 #endif
-            gpuErrchk(cudaMemcpy(d_base_ptr, h_base_ptr, elements * type_size, cudaMemcpyHostToDevice));
-            has_changed = false;
+            for (const auto &r : dirty.getRanges()) {
+                // Merged ranges may span tiles which were never downloaded, these contain no changes so are skipped
+                size_t begin = r.first;
+                while (begin < r.second) {
+                    const bool resident = tile_resident[begin / tile_elements];
+                    size_t end = begin;
+                    while (end < r.second && tile_resident[end / tile_elements] == resident)
+                        end = std::min<size_t>((end / tile_elements + 1) * tile_elements, r.second);
+                    if (resident)
+                        backend->upload(d_base_ptr + begin * type_size, h_base_ptr + begin * type_size, (end - begin) * type_size);
+                    begin = end;
+                }
+            }
+            dirty.clear();
         }
     }
     char* h_base_ptr;
@@ -61,9 +193,21 @@ struct HostMacroProperty_MetaData {
     std::array<unsigned int, 4> dims;
     unsigned int elements;
     size_t type_size;
-    bool has_changed;
     bool device_read_flag;
     std::string property_name;
+    std::shared_ptr<HostMacroProperty_Backend> backend;
+    /**
+     * Number of elements in each download tile (the final tile may be smaller)
+     */
+    unsigned int tile_elements;
+    /**
+     * Whether each tile is present in the host copy
+     */
+    std::vector<bool> tile_resident;
+    /**
+     * Elements modified since the last upload
+     */
+    util::detail::DirtyRangeSet dirty;
 };
 
 /**
@@ -269,41 +413,27 @@ HostMacroProperty<T, I, J, K, W>::operator T() {
     if (I != 1 || J != 1 || K != 1 || W != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
-    // Must assume changed
-    metadata->has_changed = true;
+    // The value is returned by copy, so the element cannot be changed
+    metadata->download(offset, offset + 1);
     return *(reinterpret_cast<T*>(metadata->h_base_ptr) + offset);
 }
 template<typename T, unsigned int I, unsigned int J, unsigned int K, unsigned int W>
 HostMacroProperty<T, I, J, K, W>::operator T() const {
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return *(reinterpret_cast<T*>(metadata->h_base_ptr) + offset);
 }
 
 template<typename T, unsigned int I, unsigned int J, unsigned int K, unsigned int W>
 void HostMacroProperty<T, I, J, K, W>::zero() {
-    if (metadata->h_base_ptr) {
-        // Memset on host
-        memset(reinterpret_cast<T*>(metadata->h_base_ptr) + offset, 0, I * J * K * W * metadata->type_size);
-        metadata->has_changed = true;
-    } else {
-#if !defined(SEATBELTS) || SEATBELTS
-        if (metadata->device_read_flag) {
-            THROW flamegpu::exception::InvalidEnvProperty("The environment macro property '%s' was not found, "
-                "in HostMacroProperty::zero()\n",
-                metadata->property_name.c_str());
-        }
-#endif
-        // Memset on device
-        gpuErrchk(cudaMemset(reinterpret_cast<T*>(metadata->d_base_ptr) + offset, 0, I * J * K * W * metadata->type_size));
-    }
+    // Memset on host if the host copy exists, else on device
+    metadata->zero(offset, offset + I * J * K * W);
 }
 template<typename T, unsigned int I, unsigned int J, unsigned int K, unsigned int W>
 T& HostMacroProperty<T, I, J, K, W>::_get() const {
     if (I != 1 || J != 1 || K != 1 || W != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset];
 }
 template<typename T, unsigned int I, unsigned int J, unsigned int K, unsigned int W>
@@ -311,8 +441,8 @@ T& HostMacroProperty<T, I, J, K, W>::_get() {
     if (I != 1 || J != 1 || K != 1 || W != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
-    metadata->has_changed = true;
+    metadata->download(offset, offset + 1);
+    metadata->markChanged(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset];
 }
 
@@ -406,9 +536,9 @@ HostMacroProperty<T, I, J, K, W>& HostMacroProperty<T, I, J, K, W>::operator=(co
     if (I != 1 || J != 1 || K != 1 || W != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     reinterpret_cast<T*>(metadata->h_base_ptr)[offset] = val;
-    metadata->has_changed = true;
+    metadata->markChanged(offset, offset + 1);
     return *this;
 }
 
@@ -439,23 +569,17 @@ HostMacroProperty_swig<T> HostMacroProperty_swig<T>::__getitem__(unsigned int i)
 
 template<typename T>
 void HostMacroProperty_swig<T>::zero() {
-    if (metadata->h_base_ptr) {
-        // Memset on host
-        memset(reinterpret_cast<T*>(metadata->h_base_ptr) + offset, 0, dimensions[0] * dimensions[1] * dimensions[2] * dimensions[3] * metadata->type_size);
-        metadata->has_changed = true;
-    } else {
-        // Memset on device
-        gpuErrchk(cudaMemset(reinterpret_cast<T*>(metadata->d_base_ptr) + offset, 0, dimensions[0] * dimensions[1] * dimensions[2] * dimensions[3] * metadata->type_size));
-    }
+    // Memset on host if the host copy exists, else on device
+    metadata->zero(offset, offset + dimensions[0] * dimensions[1] * dimensions[2] * dimensions[3]);
 }
 template<typename T>
 void HostMacroProperty_swig<T>::set(T val) {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     reinterpret_cast<T*>(metadata->h_base_ptr)[offset] = val;
-    metadata->has_changed = true;
+    metadata->markChanged(offset, offset + 1);
 }
 template<typename T>
 void HostMacroProperty_swig<T>::__setitem__(unsigned int i, const T& val) {
@@ -464,17 +588,17 @@ void HostMacroProperty_swig<T>::__setitem__(unsigned int i, const T& val) {
     } else if (i >= dimensions[0]) {
         THROW exception::InvalidOperation("Indexing out of bounds %u >= %u.\n", i, dimensions[0]);
     }
-    metadata->download();
     unsigned int t_offset = offset + (i * dimensions[1] * dimensions[2] * dimensions[3]);
+    metadata->download(t_offset, t_offset + 1);
     reinterpret_cast<T*>(metadata->h_base_ptr)[t_offset] = val;
-    metadata->has_changed = true;
+    metadata->markChanged(t_offset, t_offset + 1);
 }
 template<typename T>
 int HostMacroProperty_swig<T>::__int__() {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return static_cast<int>(reinterpret_cast<T*>(metadata->h_base_ptr)[offset]);
 }
 template<typename T>
@@ -482,7 +606,7 @@ int64_t HostMacroProperty_swig<T>::__long__() {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return static_cast<int64_t>(reinterpret_cast<T*>(metadata->h_base_ptr)[offset]);
 }
 template<typename T>
@@ -490,7 +614,7 @@ double HostMacroProperty_swig<T>::__float__() {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return static_cast<double>(reinterpret_cast<T*>(metadata->h_base_ptr)[offset]);
 }
 template<typename T>
@@ -498,7 +622,7 @@ bool HostMacroProperty_swig<T>::__bool__() {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return static_cast<bool>(reinterpret_cast<T*>(metadata->h_base_ptr)[offset]);
 }
 template<typename T>
@@ -506,7 +630,7 @@ bool HostMacroProperty_swig<T>::__eq__(const T& other) const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset] == other;
 }
 template<typename T>
@@ -514,7 +638,7 @@ bool HostMacroProperty_swig<T>::__ne__(const T& other) const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset] != other;
 }
 template<typename T>
@@ -522,7 +646,7 @@ bool HostMacroProperty_swig<T>::__lt__(const T& other) const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset] < other;
 }
 template<typename T>
@@ -530,7 +654,7 @@ bool HostMacroProperty_swig<T>::__le__(const T& other) const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset] <= other;
 }
 template<typename T>
@@ -538,7 +662,7 @@ bool HostMacroProperty_swig<T>::__gt__(const T& other) const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset] > other;
 }
 template<typename T>
@@ -546,7 +670,7 @@ bool HostMacroProperty_swig<T>::__ge__(const T& other) const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset] >= other;
 }
 // template<typename T>
@@ -562,7 +686,7 @@ T HostMacroProperty_swig<T>::get() const {
     if (dimensions[0] != 1 || dimensions[1] != 1 || dimensions[2] != 1 || dimensions[3] != 1) {
         THROW exception::InvalidOperation("Indexing error, property has more dimensions.\n");
     }
-    metadata->download();
+    metadata->download(offset, offset + 1);
     return reinterpret_cast<T*>(metadata->h_base_ptr)[offset];
 }
 #endif
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "flamegpu/sim/Simulation.h"
+#include "flamegpu/io/Checkpoint.h"
 
 namespace flamegpu {
 
@@ -85,6 +86,15 @@ class RandomManager {
     size_type size();
     uint64_t seed();
     curandState *cudaRandomState();
+    /**
+     * Writes the seed, the state of the host generator and every device curand state (including those backed up to host) to a checkpoint
+     */
+    void checkpoint(io::Checkpoint::SectionWriter &out) const;
+    /**
+     * Restores the state written by checkpoint(), replacing the current state
+     * @throws exception::InvalidInputFile If the checkpoint was produced with a different curandState layout
+     */
+    void restore(io::Checkpoint::SectionReader &in);
 
  private:
     /**
@@ -6,10 +6,12 @@
 #include <set>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/AgentLoggingConfig_Reductions.cuh"
 #include "flamegpu/sim/AgentLoggingConfig_SumReturn.h"
+#include "flamegpu/sim/AgentLoggingConfig_HostReductions.h"
 #include "flamegpu/runtime/HostAgentAPI.cuh"
 
 namespace flamegpu {
@@ -81,14 +83,65 @@ class AgentLoggingConfig {
      */
     template<typename T>
     void logSum(const std::string &variable_name);
+    /**
+     * Mark quantiles of the named agent variable to be logged
+     * Quantiles are estimated with a streaming sketch (t-digest), they are exact for small populations (fewer than ~100 agents)
+     * @param variable_name Name of the agent variable to have it's quantiles logged
+     * @param quantiles The quantiles to be estimated, e.g. {0.05, 0.5, 0.95}
+     * @tparam T The type of the named variable
+     * @throws exception::InvalidAgentVar If the agent var was not found inside the specified agent
+     * @throws exception::InvalidArgument If quantiles is empty, or contains a value outside of the range [0, 1]
+     * @throws exception::InvalidArgument If the agent var's quantiles have already been marked for logging
+     * @note The variable is copied to the host to be reduced
+     */
+    template<typename T>
+    void logQuantiles(const std::string &variable_name, const std::vector<double> &quantiles);
+    /**
+     * Mark a histogram of the named agent variable to be logged
+     * Values are counted into evenly sized bins spanning [lower_bound, upper_bound), values outside of this range are not counted
+     * @param variable_name Name of the agent variable to have it's histogram logged
+     * @param bins The number of bins
+     * @param lower_bound The (inclusive) lower boundary of the lowest bin
+     * @param upper_bound The (exclusive) upper boundary of the highest bin
+     * @tparam T The type of the named variable
+     * @throws exception::InvalidAgentVar If the agent var was not found inside the specified agent
+     * @throws exception::InvalidArgument If bins is 0, or lower_bound is not less than upper_bound
+     * @throws exception::InvalidArgument If the agent var's histogram has already been marked for logging
+     * @see HostAgentAPI::histogramEven()
+     */
+    template<typename T>
+    void logHistogram(const std::string &variable_name, unsigned int bins, T lower_bound, T upper_bound);
+    /**
+     * Mark the (population) covariance of a pair of agent variables to be logged
+     * @param variable_a Name of the first agent variable
+     * @param variable_b Name of the second agent variable
+     * @tparam A The type of variable_a
+     * @tparam B The type of variable_b
+     * @throws exception::InvalidAgentVar If either agent var was not found inside the specified agent
+     * @throws exception::InvalidArgument If the covariance of the pair has already been marked for logging
+     * @note The variables are copied to the host to be reduced
+     */
+    template<typename A, typename B = A>
+    void logCovariance(const std::string &variable_a, const std::string &variable_b);
 
  private:
     /**
      * Generic logging method
      * Returns false if that property combo already exists
+     * @param name The reduction to be logged
+     * @param variable_type The type of the agent variable name.name
+     * @param method_name Suffix of the calling method's name, used in exception messages
+     * @param secondary_type The type of the agent variable name.secondary_name, if set
+     * @throws exception::InvalidAgentVar If the agent var was not found inside the specified agent
+     */
+    void log(const LoggingConfig::NameReductionFn &name, const std::type_index &variable_type, const std::string &method_name,
+        const std::type_index &secondary_type = std::type_index(typeid(void)));
+    /**
+     * Validates that the named variable exists within the agent, with the specified type, and is not an array variable
      * @throws exception::InvalidAgentVar If the agent var was not found inside the specified agent
+     * @throws exception::InvalidVarType If the agent var has a different type, or is an array variable
      */
-    void log(const LoggingConfig::NameReductionFn &name, const std::type_index &variable_type, const std::string &method_name);
+    void validateVariable(const std::string &variable_name, const std::type_index &variable_type, const std::string &method_name) const;
     /**
      * Reference to the agent data structure, for validation agent variable names
      */
@@ -108,76 +161,141 @@ class AgentLoggingConfig {
  *  this runs on the host as an init/step/exit or host layer function
  */
 template<typename T>
-util::Any getAgentVariableMeanFunc(HostAgentAPI &ai, const std::string &variable_name) {
+util::Any getAgentVariableMeanFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
     if (ai.count() > 0)
-        return util::Any(ai.sum<T, typename sum_input_t<T>::result_t>(variable_name) / static_cast<double>(ai.count()));
+        return util::Any(ai.sum<T, typename sum_input_t<T>::result_t>(reduction.name) / static_cast<double>(ai.count()));
     return util::Any(static_cast<double>(0));
 }
 template<typename T>
-util::Any getAgentVariableSumFunc(HostAgentAPI &ai, const std::string &variable_name) {
-    return util::Any(ai.sum<T, typename sum_input_t<T>::result_t>(variable_name));
+util::Any getAgentVariableSumFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
+    return util::Any(ai.sum<T, typename sum_input_t<T>::result_t>(reduction.name));
 }
 template<typename T>
-util::Any getAgentVariableMinFunc(HostAgentAPI &ai, const std::string &variable_name) {
-    return util::Any(ai.min<T>(variable_name));
+util::Any getAgentVariableMinFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
+    return util::Any(ai.min<T>(reduction.name));
 }
 template<typename T>
-util::Any getAgentVariableMaxFunc(HostAgentAPI &ai, const std::string &variable_name) {
-    return util::Any(ai.max<T>(variable_name));
+util::Any getAgentVariableMaxFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
+    return util::Any(ai.max<T>(reduction.name));
 }
 
 template<typename T>
-util::Any getAgentVariableStandardDevFunc(HostAgentAPI &ai, const std::string &variable_name) {
+util::Any getAgentVariableStandardDevFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
     // Todo, workout how to make this more multi-thread/deviceable.
     // Todo, streams for the memcpy?
     if (ai.count() == 0)
         return util::Any(0.0);
     // Work out the Mean
-    const double mean = ai.sum<T, typename sum_input_t<T>::result_t>(variable_name) / static_cast<double>(ai.count());
+    const double mean = ai.sum<T, typename sum_input_t<T>::result_t>(reduction.name) / static_cast<double>(ai.count());
     // Then for each number: subtract the Mean and square the result
     // Then work out the mean of those squared differences.
     auto lock = std::unique_lock<std::mutex>(detail::STANDARD_DEVIATION_MEAN_mutex);
     gpuErrchk(cudaMemcpyToSymbol(detail::STANDARD_DEVIATION_MEAN, &mean, sizeof(double)));
-    const double variance = ai.transformReduce<T, double>(variable_name, detail::standard_deviation_subtract_mean, detail::standard_deviation_add, 0) / static_cast<double>(ai.count());
+    const double variance = ai.transformReduce<T, double>(reduction.name, detail::standard_deviation_subtract_mean, detail::standard_deviation_add, 0) / static_cast<double>(ai.count());
     lock.unlock();
     // Take the square root of that and we are done!
     return util::Any(sqrt(variance));
 }
 
+template<typename T>
+util::Any getAgentVariableQuantilesFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
+    // Quantiles can not be found with a single device reduction, so the variable is downloaded and streamed through the sketch
+    const DeviceAgentVector_impl &population = ai.getPopulationData();
+    const auto column = population.column<T>(reduction.name);
+    return detail::reduceQuantiles(column.data(), column.size(), reduction.parameters);
+}
+template<typename T>
+util::Any getAgentVariableHistogramFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
+    const unsigned int bins = static_cast<unsigned int>(reduction.parameters[0]);
+    std::vector<unsigned int> rtn = ai.histogramEven<T, unsigned int>(reduction.name, bins,
+        static_cast<T>(reduction.parameters[1]), static_cast<T>(reduction.parameters[2]));
+    return util::Any(rtn.data(), rtn.size() * sizeof(unsigned int), std::type_index(typeid(unsigned int)), bins);
+}
+template<typename A, typename B>
+util::Any getAgentVariableCovarianceFunc(HostAgentAPI &ai, const LoggingConfig::NameReductionFn &reduction) {
+    const DeviceAgentVector_impl &population = ai.getPopulationData();
+    const auto column_a = population.column<A>(reduction.name);
+    const auto column_b = population.column<B>(reduction.secondary_name);
+    return detail::reduceCovariance(column_a.data(), column_b.data(), column_a.size());
+}
+
 template<typename T>
 void AgentLoggingConfig::logMean(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableMeanFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableMeanFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Mean, fn}, std::type_index(typeid(T)), "Mean");
+    log({variable_name, LoggingConfig::Mean, fn, host_fn}, std::type_index(typeid(T)), "Mean");
 }
 template<typename T>
 void AgentLoggingConfig::logStandardDev(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableStandardDevFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableStandardDevFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::StandardDev, fn}, std::type_index(typeid(T)), "StandardDev");
+    log({variable_name, LoggingConfig::StandardDev, fn, host_fn}, std::type_index(typeid(T)), "StandardDev");
 }
 template<typename T>
 void AgentLoggingConfig::logMin(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableMinFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableMinFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Min, fn}, std::type_index(typeid(T)), "Min");
+    log({variable_name, LoggingConfig::Min, fn, host_fn}, std::type_index(typeid(T)), "Min");
 }
 template<typename T>
 void AgentLoggingConfig::logMax(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableMaxFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableMaxFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Max, fn}, std::type_index(typeid(T)), "Max");
+    log({variable_name, LoggingConfig::Max, fn, host_fn}, std::type_index(typeid(T)), "Max");
 }
 template<typename T>
 void AgentLoggingConfig::logSum(const std::string &variable_name) {
     // Instantiate the template function for calculating the mean
     LoggingConfig::ReductionFn *fn = getAgentVariableSumFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableSumFunc<T>;
     // Log the property (validation occurs in this common log method)
-    log({variable_name, LoggingConfig::Sum, fn}, std::type_index(typeid(T)), "Sum");
+    log({variable_name, LoggingConfig::Sum, fn, host_fn}, std::type_index(typeid(T)), "Sum");
+}
+template<typename T>
+void AgentLoggingConfig::logQuantiles(const std::string &variable_name, const std::vector<double> &quantiles) {
+    if (quantiles.empty()) {
+        THROW exception::InvalidArgument("Atleast one quantile must be requested, "
+            "in AgentLoggingConfig::logQuantiles()\n");
+    }
+    for (const double &q : quantiles) {
+        if (!(q >= 0 && q <= 1)) {
+            THROW exception::InvalidArgument("Quantile %g is not within the range [0, 1], "
+                "in AgentLoggingConfig::logQuantiles()\n", q);
+        }
+    }
+    LoggingConfig::ReductionFn *fn = getAgentVariableQuantilesFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableQuantilesFunc<T>;
+    log({variable_name, LoggingConfig::Quantiles, fn, host_fn, "", quantiles}, std::type_index(typeid(T)), "Quantiles");
+}
+template<typename T>
+void AgentLoggingConfig::logHistogram(const std::string &variable_name, const unsigned int bins, const T lower_bound, const T upper_bound) {
+    if (bins == 0) {
+        THROW exception::InvalidArgument("Histogram must have atleast 1 bin, "
+            "in AgentLoggingConfig::logHistogram()\n");
+    }
+    if (!(lower_bound < upper_bound)) {
+        THROW exception::InvalidArgument("lower_bound (%s) must be less than upper_bound (%s), "
+            "in AgentLoggingConfig::logHistogram()\n",
+            std::to_string(lower_bound).c_str(), std::to_string(upper_bound).c_str());
+    }
+    LoggingConfig::ReductionFn *fn = getAgentVariableHistogramFunc<T>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableHistogramFunc<T>;
+    log({variable_name, LoggingConfig::Histogram, fn, host_fn, "",
+        {static_cast<double>(bins), static_cast<double>(lower_bound), static_cast<double>(upper_bound)}}, std::type_index(typeid(T)), "Histogram");
+}
+template<typename A, typename B>
+void AgentLoggingConfig::logCovariance(const std::string &variable_a, const std::string &variable_b) {
+    LoggingConfig::ReductionFn *fn = getAgentVariableCovarianceFunc<A, B>;
+    LoggingConfig::HostReductionFn *host_fn = getAgentVectorVariableCovarianceFunc<A, B>;
+    log({variable_a, LoggingConfig::Covariance, fn, host_fn, variable_b, {}}, std::type_index(typeid(A)), "Covariance", std::type_index(typeid(B)));
 }
 
 }  // namespace flamegpu
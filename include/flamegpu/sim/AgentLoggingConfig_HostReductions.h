@@ -0,0 +1,155 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_AGENTLOGGINGCONFIG_HOSTREDUCTIONS_H_
+#define INCLUDE_FLAMEGPU_SIM_AGENTLOGGINGCONFIG_HOSTREDUCTIONS_H_
+
+#include <cmath>
+#include <string>
+#include <limits>
+#include <vector>
+
+#include "flamegpu/pop/AgentVector.h"
+#include "flamegpu/sim/LoggingConfig.h"
+#include "flamegpu/sim/AgentLoggingConfig_SumReturn.h"
+#include "flamegpu/util/Any.h"
+#include "flamegpu/util/detail/TDigest.h"
+
+namespace flamegpu {
+
+namespace detail {
+// Single pass reductions over a contiguous host copy of an agent variable
+// These are shared by the host and device log reductions, as they can not be computed by a single device reduction
+/**
+ * Estimates the requested quantiles with a t-digest, returns an array of double with one element per quantile
+ */
+template<typename T>
+util::Any reduceQuantiles(const T *values, const size_t count, const std::vector<double> &quantiles) {
+    util::detail::TDigest digest;
+    for (size_t i = 0; i < count; ++i)
+        digest.add(static_cast<double>(values[i]));
+    std::vector<double> rtn;
+    rtn.reserve(quantiles.size());
+    for (const double &q : quantiles)
+        rtn.push_back(digest.quantile(q));
+    return util::Any(rtn.data(), rtn.size() * sizeof(double), std::type_index(typeid(double)), static_cast<unsigned int>(rtn.size()));
+}
+/**
+ * Counts values into evenly sized bins spanning [lower, upper), values outside of the range are not counted
+ * This matches HostAgentAPI::histogramEven(), returns an array of unsigned int with one element per bin
+ * @param parameters The bin count, lower bound and upper bound
+ */
+template<typename T>
+util::Any reduceHistogram(const T *values, const size_t count, const std::vector<double> &parameters) {
+    const unsigned int bins = static_cast<unsigned int>(parameters[0]);
+    const double lower = parameters[1];
+    const double upper = parameters[2];
+    std::vector<unsigned int> rtn(bins, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const double v = static_cast<double>(values[i]);
+        if (v >= lower && v < upper) {
+            const unsigned int bin = static_cast<unsigned int>((v - lower) * bins / (upper - lower));
+            ++rtn[bin < bins ? bin : bins - 1];
+        }
+    }
+    return util::Any(rtn.data(), rtn.size() * sizeof(unsigned int), std::type_index(typeid(unsigned int)), bins);
+}
+/**
+ * Returns the population covariance of two variables, computed with a single pass of Welford's algorithm
+ */
+template<typename A, typename B>
+util::Any reduceCovariance(const A *values_a, const B *values_b, const size_t count) {
+    double mean_a = 0, mean_b = 0, comoment = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const double n = static_cast<double>(i + 1);
+        const double da = static_cast<double>(values_a[i]) - mean_a;
+        mean_a += da / n;
+        mean_b += (static_cast<double>(values_b[i]) - mean_b) / n;
+        comoment += da * (static_cast<double>(values_b[i]) - mean_b);
+    }
+    return util::Any(count ? comoment / static_cast<double>(count) : 0.0);
+}
+}  // namespace detail
+
+/**
+ * @brief FLAMEGPU log reduction function pointer definitions, for agent populations held in host memory
+ * These mirror the HostAgentAPI based reductions in AgentLoggingConfig.h, and are used by CPUReferenceSimulation
+ */
+template<typename T>
+util::Any getAgentVectorVariableSumFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    typename sum_input_t<T>::result_t rtn = 0;
+    if (population.size()) {
+        const T *d = population.data<T>(reduction.name);
+        for (AgentVector::size_type i = 0; i < population.size(); ++i)
+            rtn += d[i];
+    }
+    return util::Any(rtn);
+}
+template<typename T>
+util::Any getAgentVectorVariableMeanFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    if (population.size() > 0) {
+        typename sum_input_t<T>::result_t sum = 0;
+        const T *d = population.data<T>(reduction.name);
+        for (AgentVector::size_type i = 0; i < population.size(); ++i)
+            sum += d[i];
+        return util::Any(sum / static_cast<double>(population.size()));
+    }
+    return util::Any(static_cast<double>(0));
+}
+template<typename T>
+util::Any getAgentVectorVariableMinFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    T rtn = std::numeric_limits<T>::max();
+    if (population.size()) {
+        const T *d = population.data<T>(reduction.name);
+        for (AgentVector::size_type i = 0; i < population.size(); ++i)
+            rtn = d[i] < rtn ? d[i] : rtn;
+    }
+    return util::Any(rtn);
+}
+template<typename T>
+util::Any getAgentVectorVariableMaxFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    T rtn = std::numeric_limits<T>::lowest();
+    if (population.size()) {
+        const T *d = population.data<T>(reduction.name);
+        for (AgentVector::size_type i = 0; i < population.size(); ++i)
+            rtn = d[i] > rtn ? d[i] : rtn;
+    }
+    return util::Any(rtn);
+}
+template<typename T>
+util::Any getAgentVectorVariableStandardDevFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    if (population.size() == 0)
+        return util::Any(0.0);
+    const T *d = population.data<T>(reduction.name);
+    // Work out the Mean
+    typename sum_input_t<T>::result_t sum = 0;
+    for (AgentVector::size_type i = 0; i < population.size(); ++i)
+        sum += d[i];
+    const double mean = sum / static_cast<double>(population.size());
+    // Then work out the mean of the squared differences
+    double variance = 0;
+    for (AgentVector::size_type i = 0; i < population.size(); ++i) {
+        const double diff = static_cast<double>(d[i]) - mean;
+        variance += diff * diff;
+    }
+    variance /= static_cast<double>(population.size());
+    return util::Any(sqrt(variance));
+}
+
+template<typename T>
+util::Any getAgentVectorVariableQuantilesFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    const auto column = population.column<T>(reduction.name);
+    return detail::reduceQuantiles(column.data(), column.size(), reduction.parameters);
+}
+template<typename T>
+util::Any getAgentVectorVariableHistogramFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    const auto column = population.column<T>(reduction.name);
+    return detail::reduceHistogram(column.data(), column.size(), reduction.parameters);
+}
+template<typename A, typename B>
+util::Any getAgentVectorVariableCovarianceFunc(const AgentVector &population, const LoggingConfig::NameReductionFn &reduction) {
+    const auto column_a = population.column<A>(reduction.name);
+    const auto column_b = population.column<B>(reduction.secondary_name);
+    return detail::reduceCovariance(column_a.data(), column_b.data(), column_a.size());
+}
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_AGENTLOGGINGCONFIG_HOSTREDUCTIONS_H_
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "flamegpu/sim/LoggingConfig.h"
+#include "flamegpu/sim/Profile.h"
 #include "flamegpu/util/Any.h"
 #include "flamegpu/exception/FLAMEGPUException.h"
 
@@ -25,6 +26,7 @@ struct ExitLogFrame;
  */
 struct LogFrame {
     friend class CUDASimulation;
+    friend class CPUReferenceSimulation;
     /**
      * Default constructor, creates an empty log
      */
@@ -83,6 +85,11 @@ struct LogFrame {
  */
 struct StepLogFrame : public LogFrame {
     friend class CUDASimulation;
+    friend class CPUReferenceSimulation;
+    /**
+     * Restores step_time when the step log is read from a checkpoint
+     */
+    friend class Simulation;
     /**
      * Default constructor, creates an empty log
      */
@@ -114,6 +121,7 @@ struct StepLogFrame : public LogFrame {
  */
 struct ExitLogFrame : public LogFrame {
     friend class CUDASimulation;
+    friend class CPUReferenceSimulation;
     /**
      * Default constructor, creates an empty log
      */
@@ -197,6 +205,7 @@ struct RunLog {
         std::string flamegpu_version;
     };
     friend class CUDASimulation;
+    friend class CPUReferenceSimulation;
     /**
      * Constructs an empty RunLog
      */
@@ -234,6 +243,11 @@ struct RunLog {
      * Return a copy of a structure containing performance relevant device and software information
      */
     PerformanceSpecs getPerformanceSpecs() const { return performance_specs; }
+    /**
+     * Return the timings collected by the profiler during the run
+     * This is empty unless Simulation::Config::profile was enabled
+     */
+    const Profile &getProfile() const { return profile; }
 
  private:
     /**
@@ -256,6 +270,10 @@ struct RunLog {
      * Performance relevant device/software info
      */
     PerformanceSpecs performance_specs;
+    /**
+     * Profiled timings
+     */
+    Profile profile;
 };
 /**
  * Frame of logging data related to a specific agent type and state.
@@ -326,6 +344,29 @@ struct AgentLogFrame {
      * @throws exception::InvalidVarType If the agent variable variable_name does not have type T within the agent.
      */
     double getStandardDev(const std::string &variable_name) const;
+    /**
+     * Return the result of a quantiles reduction performed on the specified agent variable
+     * @param variable_name The agent variable that was reduced
+     * @return The estimate of each quantile, in the order they were passed to AgentLoggingConfig::logQuantiles()
+     * @throws exception::InvalidAgentVar If a quantiles reduction of the agent variable of name variable_name was not found within the log.
+     */
+    std::vector<double> getQuantiles(const std::string &variable_name) const;
+    /**
+     * Return the result of a histogram reduction performed on the specified agent variable
+     * @param variable_name The agent variable that was reduced
+     * @return The number of agents within each bin
+     * @throws exception::InvalidAgentVar If a histogram reduction of the agent variable of name variable_name was not found within the log.
+     */
+    std::vector<unsigned int> getHistogram(const std::string &variable_name) const;
+    /**
+     * Return the result of a covariance reduction performed on the specified pair of agent variables
+     * @param variable_a The first agent variable that was reduced
+     * @param variable_b The second agent variable that was reduced
+     * @return The population covariance of the two variables
+     * @throws exception::InvalidAgentVar If a covariance reduction of the pair of agent variables was not found within the log.
+     * @note The order of the variables does not matter
+     */
+    double getCovariance(const std::string &variable_a, const std::string &variable_b) const;
 
  private:
     /**
@@ -0,0 +1,260 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_LOGREDUCTIONPLAN_H_
+#define INCLUDE_FLAMEGPU_SIM_LOGREDUCTIONPLAN_H_
+
+#include <cuda_runtime.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "flamegpu/util/Any.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+class MemoryResource;
+}  // namespace detail
+}  // namespace util
+namespace detail {
+
+/**
+ * Accumulator type of a LogReductionPlan column
+ * Integer variables are summed, and their min/max found, in 64 bit integers so that results are exact
+ */
+enum class LogReductionKind : unsigned int { Float, Signed, Unsigned };
+/**
+ * Supported types of agent variable, that may be reduced by a LogReductionPlan
+ * long long and unsigned long long are distinct from int64_t and uint64_t on some platforms, so results are returned as the variable's own type
+ */
+enum class LogReductionType : unsigned int { Float, Double, Char, Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, LongLong, ULongLong };
+/**
+ * A single value, held in the accumulator type of a column
+ */
+union LogReductionValue {
+    double f;
+    int64_t i;
+    uint64_t u;
+};
+/**
+ * Partial statistics of a single variable over a subset of agents
+ * Partials of disjoint subsets are combined with merge(), so they can be computed independently (e.g. per thread block)
+ */
+struct LogReductionPartial {
+    /**
+     * Number of agents within the subset
+     * This is held as double, as it is only used within floating point arithmetic
+     */
+    double count;
+    /**
+     * Running mean and sum of squared differences from the mean (Welford), used to calculate standard deviation
+     */
+    double mean;
+    double m2;
+    LogReductionValue sum;
+    LogReductionValue min;
+    LogReductionValue max;
+    /**
+     * Resets the partial to represent an empty subset
+     */
+    __host__ __device__ void init(const LogReductionKind kind) {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+        if (kind == LogReductionKind::Float) {
+            sum.f = 0;
+            min.f = INFINITY;
+            max.f = -INFINITY;
+        } else if (kind == LogReductionKind::Signed) {
+            sum.i = 0;
+            min.i = INT64_MAX;
+            max.i = INT64_MIN;
+        } else {
+            sum.u = 0;
+            min.u = UINT64_MAX;
+            max.u = 0;
+        }
+    }
+    /**
+     * Adds a single value to the subset
+     * @param kind The accumulator type of the column
+     * @param v The value, in the accumulator type
+     * @param x The value, as double
+     */
+    __host__ __device__ void push(const LogReductionKind kind, const LogReductionValue v, const double x) {
+        count += 1;
+        const double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        if (kind == LogReductionKind::Float) {
+            sum.f += v.f;
+            min.f = v.f < min.f ? v.f : min.f;
+            max.f = v.f > max.f ? v.f : max.f;
+        } else if (kind == LogReductionKind::Signed) {
+            sum.i += v.i;
+            min.i = v.i < min.i ? v.i : min.i;
+            max.i = v.i > max.i ? v.i : max.i;
+        } else {
+            sum.u += v.u;
+            min.u = v.u < min.u ? v.u : min.u;
+            max.u = v.u > max.u ? v.u : max.u;
+        }
+    }
+    /**
+     * Combines the partial of a disjoint subset into this partial (Chan et al.)
+     */
+    __host__ __device__ void merge(const LogReductionKind kind, const LogReductionPartial &other) {
+        if (other.count == 0)
+            return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        const double n = count + other.count;
+        const double delta = other.mean - mean;
+        mean += delta * other.count / n;
+        m2 += other.m2 + delta * delta * count * other.count / n;
+        count = n;
+        if (kind == LogReductionKind::Float) {
+            sum.f += other.sum.f;
+            min.f = other.min.f < min.f ? other.min.f : min.f;
+            max.f = other.max.f > max.f ? other.max.f : max.f;
+        } else if (kind == LogReductionKind::Signed) {
+            sum.i += other.sum.i;
+            min.i = other.min.i < min.i ? other.min.i : min.i;
+            max.i = other.max.i > max.i ? other.max.i : max.i;
+        } else {
+            sum.u += other.sum.u;
+            min.u = other.min.u < min.u ? other.min.u : min.u;
+            max.u = other.max.u > max.u ? other.max.u : max.u;
+        }
+    }
+};
+/**
+ * Returns the accumulator type used for a variable type
+ */
+__host__ __device__ inline LogReductionKind getLogReductionKind(const LogReductionType type) {
+    switch (type) {
+    case LogReductionType::Float:
+    case LogReductionType::Double:
+        return LogReductionKind::Float;
+    case LogReductionType::Char:
+        return std::numeric_limits<char>::is_signed ? LogReductionKind::Signed : LogReductionKind::Unsigned;
+    case LogReductionType::Int8:
+    case LogReductionType::Int16:
+    case LogReductionType::Int32:
+    case LogReductionType::Int64:
+    case LogReductionType::LongLong:
+        return LogReductionKind::Signed;
+    default:
+        return LogReductionKind::Unsigned;
+    }
+}
+/**
+ * Loads element i of a variable's buffer, and adds it to the partial
+ * @param partial The partial to be updated
+ * @param type The type of the variable
+ * @param data The variable's buffer
+ * @param i The index of the agent within the buffer
+ */
+__host__ __device__ inline void pushLogReductionValue(LogReductionPartial &partial, const LogReductionType type, const void *data, const unsigned int i) {
+    LogReductionValue v;
+    double x;
+    switch (type) {
+    case LogReductionType::Float: v.f = static_cast<const float*>(data)[i]; x = v.f; break;
+    case LogReductionType::Double: v.f = static_cast<const double*>(data)[i]; x = v.f; break;
+    case LogReductionType::Char:
+        if (std::numeric_limits<char>::is_signed) {
+            v.i = static_cast<const char*>(data)[i]; x = static_cast<double>(v.i);
+        } else {
+            v.u = static_cast<unsigned char>(static_cast<const char*>(data)[i]); x = static_cast<double>(v.u);
+        }
+        break;
+    case LogReductionType::Int8: v.i = static_cast<const int8_t*>(data)[i]; x = static_cast<double>(v.i); break;
+    case LogReductionType::Int16: v.i = static_cast<const int16_t*>(data)[i]; x = static_cast<double>(v.i); break;
+    case LogReductionType::Int32: v.i = static_cast<const int32_t*>(data)[i]; x = static_cast<double>(v.i); break;
+    case LogReductionType::Int64: v.i = static_cast<const int64_t*>(data)[i]; x = static_cast<double>(v.i); break;
+    case LogReductionType::LongLong: v.i = static_cast<const long long*>(data)[i]; x = static_cast<double>(v.i); break;  // NOLINT(runtime/int)
+    case LogReductionType::UInt8: v.u = static_cast<const uint8_t*>(data)[i]; x = static_cast<double>(v.u); break;
+    case LogReductionType::UInt16: v.u = static_cast<const uint16_t*>(data)[i]; x = static_cast<double>(v.u); break;
+    case LogReductionType::UInt32: v.u = static_cast<const uint32_t*>(data)[i]; x = static_cast<double>(v.u); break;
+    case LogReductionType::ULongLong: v.u = static_cast<const unsigned long long*>(data)[i]; x = static_cast<double>(v.u); break;  // NOLINT(runtime/int)
+    default: v.u = static_cast<const uint64_t*>(data)[i]; x = static_cast<double>(v.u); break;
+    }
+    partial.push(getLogReductionKind(type), v, x);
+}
+
+/**
+ * A fused reduction of the logged statistics of several variables of one agent state
+ *
+ * Each variable which has atleast one of Sum, Mean, StandardDev, Min or Max logged is assigned a column.
+ * Every statistic of every column is computed by a single pass over the agents (reduceHost() or reduceDevice()),
+ * rather than by a separate reduction and readback per logged statistic.
+ */
+class LogReductionPlan {
+ public:
+    /**
+     * Statistics which can be fused, these are combined as a bitmask per column
+     */
+    enum Statistic : unsigned int { Sum = 1, Mean = 2, StandardDev = 4, Min = 8, Max = 16 };
+    struct Column {
+        std::string variable_name;
+        LogReductionType type;
+        /**
+         * Bitmask of the statistics requested for this column
+         */
+        unsigned int statistics;
+    };
+    /**
+     * Adds a statistic of a variable to the plan, adding a column for the variable if it does not already have one
+     * @param variable_name Name of the agent variable
+     * @param type Type of the agent variable
+     * @param statistic The statistic to be computed
+     * @return The index of the variable's column
+     * @throws exception::InvalidVarType If type is not supported
+     */
+    unsigned int add(const std::string &variable_name, const std::type_index &type, Statistic statistic);
+    const std::vector<Column> &getColumns() const { return columns; }
+    bool empty() const { return columns.empty(); }
+    /**
+     * Reduces each column over a population held in host memory
+     * @param buffers Pointer to the buffer of each column's variable, in column order
+     * @param count Number of agents within each buffer
+     * @return The statistics of each column
+     */
+    std::vector<LogReductionPartial> reduceHost(const std::vector<const void*> &buffers, unsigned int count) const;
+    /**
+     * Reduces each column over a population held in device memory, with a single kernel launch and a single readback
+     * @param buffers Device pointer to the buffer of each column's variable, in column order
+     * @param count Number of agents within each buffer
+     * @param memory Memory resource used to allocate the temporary device buffer
+     * @param stream The CUDA stream used for the launch and copies, this is synchronised before returning
+     * @return The statistics of each column
+     */
+    std::vector<LogReductionPartial> reduceDevice(const std::vector<const void*> &buffers, unsigned int count, util::detail::MemoryResource &memory, cudaStream_t stream) const;
+    /**
+     * Returns a statistic of a reduced column, with the type that the matching individual log reduction would return
+     * Sum returns sum_input_t<T>::result_t, Mean and StandardDev return double, Min and Max return the variable's type
+     * @param column The index of the column
+     * @param partial The statistics of the column, as returned by reduceHost() or reduceDevice()
+     * @param statistic The statistic to be returned
+     */
+    util::Any getResult(unsigned int column, const LogReductionPartial &partial, Statistic statistic) const;
+    /**
+     * Returns the LogReductionType matching a C++ type
+     * @throws exception::InvalidVarType If the type is not supported
+     */
+    static LogReductionType toLogReductionType(const std::type_index &type);
+
+ private:
+    std::vector<Column> columns;
+};
+
+}  // namespace detail
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_LOGREDUCTIONPLAN_H_
@@ -6,8 +6,11 @@
 #include <set>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "flamegpu/util/StringPair.h"
+#include "flamegpu/sim/LogReductionPlan.h"
 #include "flamegpu/runtime/HostAgentAPI.cuh"
 #include "flamegpu/model/ModelData.h"
 #include "flamegpu/gpu/CUDAEnsemble.h"
@@ -15,6 +18,7 @@
 namespace flamegpu {
 
 class AgentLoggingConfig;
+class AgentVector;
 
 /**
  * Interface to the data structure for controlling how model data is logged
@@ -35,6 +39,10 @@ class LoggingConfig {
      * CUDASimulation::processStepLog() Requires access for reading the config
      */
     friend class CUDASimulation;
+    /**
+     * CPUReferenceSimulation::processStepLog() Requires access for reading the config
+     */
+    friend class CPUReferenceSimulation;
     /**
      * Requires access to log_timing
      */
@@ -44,7 +52,7 @@ class LoggingConfig {
     /**
      * Enum representing the available reduction types for agent variables
      */
-    enum Reduction{ Mean, StandardDev, Min, Max, Sum };
+    enum Reduction{ Mean, StandardDev, Min, Max, Sum, Quantiles, Histogram, Covariance };
     /**
      * Converts a Reduction enum to a string representation
      */
@@ -55,15 +63,25 @@ class LoggingConfig {
         case Min: return "min";
         case Max: return "max";
         case Sum: return "sum";
+        case Quantiles: return "quantiles";
+        case Histogram: return "histogram";
+        case Covariance: return "covariance";
         default: return "unknown";
         }
     }
+    struct NameReductionFn;
     /**
      * ReductionFn is a prototype for reduction functions
      * Typedef'ing function prototypes like this allows for cleaner function pointers
+     * The full reduction is passed, so that parameterised reductions (e.g. Quantiles) can access their arguments
      * @note - this leads to a swig warning 504 which is suppressed.
      */
-    typedef util::Any (ReductionFn)(HostAgentAPI &ai, const std::string &variable_name);
+    typedef util::Any (ReductionFn)(HostAgentAPI &ai, const NameReductionFn &reduction);
+    /**
+     * HostReductionFn is a prototype for reduction functions which operate on a host copy of an agent population
+     * These are used by simulation backends which do not hold agent data on the device (e.g. CPUReferenceSimulation)
+     */
+    typedef util::Any (HostReductionFn)(const AgentVector &population, const NameReductionFn &reduction);
     /**
      * A user configured reduction to be logged
      */
@@ -81,6 +99,27 @@ class LoggingConfig {
          * (Reduction functions are templated so much be instantiated)
          */
         ReductionFn *function;
+        /**
+         * Pointer to instantiated host reduction function, equivalent to function
+         */
+        HostReductionFn *host_function;
+        /**
+         * Name of the second variable, for reductions over a pair of variables (e.g. Covariance)
+         */
+        std::string secondary_name;
+        /**
+         * Arguments of parameterised reductions
+         * Quantiles: the quantiles to be estimated
+         * Histogram: the bin count, lower bound and upper bound
+         */
+        std::vector<double> parameters;
+        /**
+         * Returns the key used to identify the reduction within log files
+         * e.g. "mean", or "covariance_y" for the covariance of the variable with y
+         */
+        std::string getKey() const {
+            return secondary_name.empty() ? toString(reduction) : std::string(toString(reduction)) + "_" + secondary_name;
+        }
         /**
          * Generic ordering function, to allow instances of this type to be stored in ordered collections
          * The defined order is not important
@@ -89,11 +128,42 @@ class LoggingConfig {
          */
         bool operator<(const NameReductionFn &other) const {
             if (name == other.name) {
+                if (reduction == other.reduction) {
+                    return secondary_name < other.secondary_name;
+                }
                 return reduction < other.reduction;
             }
             return name < other.name;
         }
     };
+    /**
+     * The reductions logged for a single agent state, split into those computed by a fused reduction plan and the remainder
+     */
+    struct FusedReductions {
+        /**
+         * Computes every Sum, Mean, StandardDev, Min and Max reduction in a single pass
+         */
+        detail::LogReductionPlan plan;
+        /**
+         * A reduction computed by the plan, and the column and statistic of the plan which produce it
+         */
+        struct Fused {
+            const NameReductionFn *reduction;
+            unsigned int column;
+            detail::LogReductionPlan::Statistic statistic;
+        };
+        std::vector<Fused> fused;
+        /**
+         * Reductions which must be performed individually (e.g. Quantiles)
+         */
+        std::vector<const NameReductionFn *> unfused;
+        /**
+         * Stores the result of each fused reduction
+         * @param partials The statistics of each column of the plan
+         * @param out The map of reduction results
+         */
+        void emplaceResults(const std::vector<detail::LogReductionPartial> &partials, std::map<NameReductionFn, util::Any> &out) const;
+    };
     /**
      * Constructor
      * @param model The ModelDescription hierarchy to produce a logging config for
@@ -128,6 +198,19 @@ class LoggingConfig {
     void logTiming(bool doLogTiming);
 
  private:
+    /**
+     * Builds the fused reduction plan of an agent state's logged reductions
+     * The result refers to the config's reductions, so it must not outlive the config
+     * @param agent_state The agent name and state, this must be a key of agents
+     */
+    FusedReductions fuseReductions(const util::StringPair &agent_state) const;
+    /**
+     * Returns the fused reduction plan of an agent state's logged reductions, building it the first time it is requested
+     * The plan is rebuilt if reductions have since been added to the agent state
+     * @param agent_state The agent name and state, this must be a key of agents
+     * @see fuseReductions()
+     */
+    const FusedReductions &getFusedReductions(const util::StringPair &agent_state) const;
     /**
      * The ModelDescription hierarchy to setup the logging for
      */
@@ -145,6 +228,15 @@ class LoggingConfig {
      * Flag denoting whether timing information for the simulation/steps should be logged
      */
     bool log_timing;
+    /**
+     * Cache of getFusedReductions(), alongside the number of reductions each plan was built from
+     * map<<agent_name:agent_state>, <plan, reduction_count>>
+     */
+    mutable std::map<util::StringPair, std::pair<FusedReductions, size_t>> fused_reductions;
+    /**
+     * Protects fused_reductions, as a config may be shared by the concurrent runs of an ensemble
+     */
+    mutable std::mutex fused_reductions_mutex;
 };
 
 /**
@@ -155,6 +247,10 @@ class StepLoggingConfig : public LoggingConfig {
      * CUDASimulation::processStepLog() requires access for reading the config
      */
     friend class CUDASimulation;
+    /**
+     * CPUReferenceSimulation::processStepLog() requires access for reading the config
+     */
+    friend class CPUReferenceSimulation;
  public:
     /**
      * Constructor
@@ -0,0 +1,98 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_PROFILE_H_
+#define INCLUDE_FLAMEGPU_SIM_PROFILE_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+
+namespace flamegpu {
+
+/**
+ * Accumulated timing of a single profiled region, e.g. an agent function
+ */
+struct ProfileRegion {
+    /**
+     * The number of times the region was executed
+     */
+    uint64_t calls = 0;
+    /**
+     * The total time spent executing the region, in seconds
+     */
+    double total_time = 0;
+    /**
+     * The shortest single execution of the region, in seconds
+     */
+    double min_time = std::numeric_limits<double>::infinity();
+    /**
+     * The longest single execution of the region, in seconds
+     */
+    double max_time = 0;
+    /**
+     * Accumulates a single execution of the region
+     * @param seconds Duration of the execution
+     */
+    void add(double seconds);
+    /**
+     * Accumulates all executions recorded by another instance of the region
+     */
+    void merge(const ProfileRegion &other);
+    /**
+     * Returns the mean duration of a single execution, or 0 if the region was not executed
+     */
+    double getMeanTime() const { return calls ? total_time / calls : 0; }
+};
+/**
+ * Timings collected by the profiler during a model run
+ *
+ * Regions are identified by their path, a '/' separated list of the regions which enclose them, each of the form "category:name"
+ * e.g. "step/layer:move/function:Boid.outputdata" or "step/layer:3/host_function:0".
+ * The timing of a region includes the timing of the regions nested within it.
+ * @see Simulation::Config::profile
+ */
+class Profile {
+ public:
+    typedef std::map<std::string, ProfileRegion> RegionMap;
+    /**
+     * Accumulates a single execution of a region
+     * @param path Path of the region
+     * @param seconds Duration of the execution
+     */
+    void add(const std::string &path, double seconds);
+    /**
+     * Accumulates all regions of another profile, e.g. to aggregate the runs of an ensemble
+     * @param other The profile to merge
+     * @param prefix If not empty, this path is prepended to the paths of the merged regions
+     */
+    void merge(const Profile &other, const std::string &prefix = "");
+    /**
+     * Returns all regions, ordered by path
+     */
+    const RegionMap &getRegions() const { return regions; }
+    /**
+     * Returns the named region
+     * @param path Path of the region
+     * @throws exception::InvalidArgument If no region with the path was recorded
+     */
+    const ProfileRegion &getRegion(const std::string &path) const;
+    /**
+     * Returns whether the named region was recorded
+     * @param path Path of the region
+     */
+    bool hasRegion(const std::string &path) const { return regions.find(path) != regions.end(); }
+    /**
+     * Returns true if no regions have been recorded
+     */
+    bool empty() const { return regions.empty(); }
+    /**
+     * Removes all regions
+     */
+    void clear() { regions.clear(); }
+
+ private:
+    RegionMap regions;
+};
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_PROFILE_H_
@@ -60,6 +60,13 @@ class RunPlan {
      * @param subdir The subdirectory to output logfiles for this run to
      */
     void setOutputSubdirectory(const std::string &subdir);
+    /**
+     * Set an estimate of the relative cost of executing this run
+     * This is used by LongestFirstScheduler to decide the order in which CUDAEnsemble executes runs
+     * @param cost The estimated cost, only the magnitude relative to other runs matters. 0 (the default) means no estimate.
+     * @throws exception::OutOfBoundsException If cost is negative
+     */
+    void setCostEstimate(const double &cost);
     /**
      * Set the environment property override for this run of the model
      * @param name Environment property name
@@ -124,6 +131,11 @@ class RunPlan {
      * Empty string means output for this run will not be placed into a subdirectory
      */
     std::string getOutputSubdirectory() const;
+    /**
+     * Returns the estimated relative cost of executing this run
+     * 0 means no estimate has been set
+     */
+    double getCostEstimate() const;
 
     /**
      * Gets the currently configured environment property value
@@ -179,6 +191,7 @@ class RunPlan {
     uint64_t random_seed;
     unsigned int steps;
     std::string output_subdirectory;
+    double cost_estimate;
     std::unordered_map<std::string, util::Any> property_overrides;
     /**
      * Reference to model environment data, for validation
@@ -0,0 +1,122 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_RUNPLANSCHEDULER_H_
+#define INCLUDE_FLAMEGPU_SIM_RUNPLANSCHEDULER_H_
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "flamegpu/sim/RunPlan.h"
+
+namespace flamegpu {
+
+class RunPlanVector;
+
+/**
+ * Decides the order in which CUDAEnsemble issues the RunPlans of a RunPlanVector to it's runners
+ *
+ * Each runner takes the next plan in the order as soon as it's previous run completes.
+ * Runs are still identified by their index within the RunPlanVector, so the order does not affect logs.
+ * @see CUDAEnsemble::setScheduler()
+ */
+class RunPlanScheduler {
+ public:
+    virtual ~RunPlanScheduler() = default;
+    /**
+     * Returns the index of every RunPlan within plans, in the order they should be issued
+     * Each index must appear exactly once
+     * @param plans The plans to be executed by the ensemble
+     */
+    virtual std::vector<unsigned int> getOrder(const RunPlanVector &plans) const = 0;
+};
+/**
+ * Issues RunPlans in the order they appear within the RunPlanVector
+ */
+class IndexOrderScheduler : public RunPlanScheduler {
+ public:
+    std::vector<unsigned int> getOrder(const RunPlanVector &plans) const override;
+};
+/**
+ * Issues RunPlans in descending order of estimated cost (longest processing time first)
+ *
+ * When the cost of runs varies greatly, issuing the longest runs first prevents a long run starting
+ * near the end of the ensemble whilst all other runners sit idle.
+ * Plans of equal cost retain their relative order.
+ */
+class LongestFirstScheduler : public RunPlanScheduler {
+ public:
+    /**
+     * Returns the estimated cost of executing a RunPlan, only the relative magnitude of costs matters
+     */
+    typedef std::function<double(const RunPlan &)> CostFunction;
+    /**
+     * @param cost The function used to estimate the cost of each plan
+     */
+    explicit LongestFirstScheduler(CostFunction cost = defaultCost);
+    std::vector<unsigned int> getOrder(const RunPlanVector &plans) const override;
+    /**
+     * Returns the plan's cost estimate if one has been set, otherwise the plan's steps
+     * Plans with unlimited steps (0) are treated as having infinite cost
+     * @see RunPlan::setCostEstimate()
+     */
+    static double defaultCost(const RunPlan &plan);
+    /**
+     * Returns a cost function which multiplies each plan's steps by the value of the named environment property
+     * This is useful when a property, such as the initial population size, dominates the cost of a run
+     * Plans with a cost estimate set, use that instead
+     * @param property_name Name of the environment property
+     * @tparam T Type of the environment property
+     */
+    template<typename T>
+    static CostFunction propertyCost(const std::string &property_name) {
+        return [property_name](const RunPlan &plan) {
+            if (plan.getCostEstimate() > 0)
+                return plan.getCostEstimate();
+            if (plan.getSteps() == 0)
+                return std::numeric_limits<double>::infinity();
+            return static_cast<double>(plan.getSteps()) * static_cast<double>(plan.getProperty<T>(property_name));
+        };
+    }
+
+ private:
+    CostFunction cost;
+};
+
+namespace detail {
+/**
+ * Thread safe queue of run indices, shared by the runners of a CUDAEnsemble
+ * Runners call next() to take the next plan to execute, until it returns false
+ */
+class RunPlanQueue {
+ public:
+    /**
+     * @param order The index of each plan, in the order they should be issued
+     * @param plan_count The number of plans within the RunPlanVector
+     * @throws exception::InvalidArgument If order is not a permutation of [0, plan_count)
+     */
+    RunPlanQueue(std::vector<unsigned int> order, unsigned int plan_count);
+    /**
+     * Takes the next plan from the queue
+     * @param run_id Set to the index of the next plan, if available
+     * @return False if all plans have already been issued
+     */
+    bool next(unsigned int &run_id);
+    /**
+     * Returns the number of plans which have been issued
+     */
+    unsigned int getIssuedCount() const;
+    /**
+     * Returns the total number of plans
+     */
+    unsigned int size() const { return static_cast<unsigned int>(order.size()); }
+
+ private:
+    const std::vector<unsigned int> order;
+    std::atomic<unsigned int> next_index;
+};
+}  // namespace detail
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_RUNPLANSCHEDULER_H_
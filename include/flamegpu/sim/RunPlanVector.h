@@ -17,6 +17,7 @@ namespace flamegpu {
 
 class ModelDescription;
 class EnvironmentDescription;
+class SampleSpace;
 
 /**
  * Vector of RunPlan
@@ -265,6 +266,43 @@ class RunPlanVector : private std::vector<RunPlan>  {
      */
     template<typename T, typename rand_dist>
     void setPropertyRandom(const std::string &name, const EnvironmentManager::size_type &index, rand_dist &distribution);
+    /**
+     * Jointly sweep the properties of a sample space using a random Latin hypercube design
+     * The range of each property is divided into size() equal strata, and each stratum is sampled by exactly one RunPlan
+     * The design is generated from the internal random generator, so is reproducible via setRandomPropertySeed()
+     * @param space The properties, and their ranges, to be sampled
+     * @throws exception::InvalidEnvProperty If a property of the space does not exist
+     * @throws exception::InvalidEnvPropertyType If a property of the space has a different type, or is an array and no index was specified
+     * @throws exception::OutOfBoundsException If an index of the space is greater than or equal to the length of the environment property array
+     * @throws exception::OutOfBoundsException If this vector has a length less than 2
+     * @see SampleSpace
+     */
+    void setPropertiesLatinHypercube(const SampleSpace &space);
+    /**
+     * Jointly sweep the properties of a sample space using the Sobol low discrepancy sequence
+     * The first point of the sequence is the minimum of each range, the first 2^k RunPlans are evenly spread across each range
+     * The design is deterministic, it does not depend on the random property seed
+     * @param space The properties, and their ranges, to be sampled
+     * @throws exception::InvalidEnvProperty If a property of the space does not exist
+     * @throws exception::InvalidEnvPropertyType If a property of the space has a different type, or is an array and no index was specified
+     * @throws exception::OutOfBoundsException If an index of the space is greater than or equal to the length of the environment property array
+     * @throws exception::OutOfBoundsException If this vector has a length less than 2
+     * @throws exception::OutOfBoundsException If the space has more than 21 properties
+     * @see SampleSpace
+     */
+    void setPropertiesSobol(const SampleSpace &space);
+    /**
+     * Jointly sweep the properties of a sample space using the Halton low discrepancy sequence
+     * The design is deterministic, it does not depend on the random property seed
+     * @param space The properties, and their ranges, to be sampled
+     * @throws exception::InvalidEnvProperty If a property of the space does not exist
+     * @throws exception::InvalidEnvPropertyType If a property of the space has a different type, or is an array and no index was specified
+     * @throws exception::OutOfBoundsException If an index of the space is greater than or equal to the length of the environment property array
+     * @throws exception::OutOfBoundsException If this vector has a length less than 2
+     * @note Correlation between the higher dimensions becomes noticeable with more than ~8 properties, setPropertiesSobol() is preferred in this case
+     * @see SampleSpace
+     */
+    void setPropertiesHalton(const SampleSpace &space);
 
     /**
      * Expose inherited std::vector methods/classes
@@ -293,6 +331,16 @@ class RunPlanVector : private std::vector<RunPlan>  {
 
  private:
     RunPlanVector(const std::shared_ptr<const std::unordered_map<std::string, EnvironmentDescription::PropData>> &environment, const bool &allow_0_steps);
+    /**
+     * Validates the properties of a sample space against the environment, prior to applying a design
+     * @param space The space to validate
+     * @param caller Name of the calling method, for error messages
+     */
+    void validateSampleSpace(const SampleSpace &space, const char *caller) const;
+    /**
+     * Applies a row major design of size() points, in the unit hypercube, to the properties of space
+     */
+    void applySampleDesign(const SampleSpace &space, const std::vector<double> &points);
     /**
      * Seed used for the current `rand` instance, which is only valid for elements generated since the last call to setRandomPropertySeed
      */
@@ -0,0 +1,118 @@
+#ifndef INCLUDE_FLAMEGPU_SIM_SAMPLESPACE_H_
+#define INCLUDE_FLAMEGPU_SIM_SAMPLESPACE_H_
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <string>
+#include <typeindex>
+#include <type_traits>
+#include <vector>
+
+#include "flamegpu/sim/RunPlan.h"
+
+namespace flamegpu {
+
+/**
+ * Describes the environment properties (and ranges) to be sampled jointly across a RunPlanVector
+ * Each property added forms one dimension of the space, which is filled by a space filling design
+ * @see RunPlanVector::setPropertiesLatinHypercube()
+ * @see RunPlanVector::setPropertiesSobol()
+ * @see RunPlanVector::setPropertiesHalton()
+ */
+class SampleSpace {
+    friend class RunPlanVector;
+
+ public:
+    /**
+     * Adds an environment property to the space
+     * Floating point types are sampled from the range [min, max)
+     * Integer types are sampled from the range [min, max], each integer within the range is equally likely
+     * @param name The name of the environment property
+     * @param min The lower bound of the range
+     * @param max The upper bound of the range
+     * @tparam T The type of the environment property, this must match the ModelDescription
+     * @throws exception::InvalidArgument If max is less than min
+     * @note The property is validated against the model when the space is sampled by RunPlanVector
+     */
+    template<typename T>
+    SampleSpace &addProperty(const std::string &name, const T &min, const T &max);
+    /**
+     * Array property element equivalent of addProperty()
+     * @param name The name of the environment property
+     * @param index The index of the element within the environment property array
+     * @param min The lower bound of the range
+     * @param max The upper bound of the range
+     * @tparam T The type of the environment property, this must match the ModelDescription
+     * @throws exception::InvalidArgument If max is less than min
+     * @see addProperty(const std::string &name, const T &min, const T &max)
+     */
+    template<typename T>
+    SampleSpace &addProperty(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T &max);
+    /**
+     * Returns the number of properties within the space
+     */
+    unsigned int getDimensions() const { return static_cast<unsigned int>(dimensions.size()); }
+
+ private:
+    struct Dimension {
+        std::string name;
+        std::type_index type;
+        /**
+         * True if the dimension is a single element of an array property
+         */
+        bool is_element;
+        EnvironmentManager::size_type index;
+        /**
+         * Sets the property of a RunPlan, from a sample in the range [0, 1)
+         */
+        std::function<void(RunPlan &, double)> set;
+    };
+    /**
+     * Maps a sample in the range [0, 1) to the range of the dimension
+     */
+    template<typename T>
+    static T scale(double u, const T &min, const T &max);
+    template<typename T>
+    static void validateRange(const std::string &name, const T &min, const T &max);
+    std::vector<Dimension> dimensions;
+};
+
+template<typename T>
+T SampleSpace::scale(const double u, const T &min, const T &max) {
+    if (std::numeric_limits<T>::is_integer) {
+        // Divide [min, max + 1) into equal width bins, so that every integer is equally likely
+        const double v = std::floor(static_cast<double>(min) + u * (static_cast<double>(max) - static_cast<double>(min) + 1.0));
+        return v >= static_cast<double>(max) ? max : static_cast<T>(v);
+    }
+    return static_cast<T>(min + u * (max - min));
+}
+template<typename T>
+void SampleSpace::validateRange(const std::string &name, const T &min, const T &max) {
+    if (max < min) {
+        THROW exception::InvalidArgument("Sample range of environment property '%s' has max less than min, "
+            "in SampleSpace::addProperty()\n", name.c_str());
+    }
+}
+template<typename T>
+SampleSpace &SampleSpace::addProperty(const std::string &name, const T &min, const T &max) {
+    static_assert(std::is_arithmetic<T>::value, "Invalid template argument for SampleSpace::addProperty(const std::string &name, const T &min, const T &max)");
+    validateRange(name, min, max);
+    dimensions.push_back({name, std::type_index(typeid(T)), false, 0, [name, min, max](RunPlan &plan, const double u) {
+        plan.setProperty<T>(name, scale<T>(u, min, max));
+    }});
+    return *this;
+}
+template<typename T>
+SampleSpace &SampleSpace::addProperty(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T &max) {
+    static_assert(std::is_arithmetic<T>::value, "Invalid template argument for SampleSpace::addProperty(const std::string &name, const EnvironmentManager::size_type &index, const T &min, const T &max)");
+    validateRange(name, min, max);
+    dimensions.push_back({name, std::type_index(typeid(T)), true, index, [name, index, min, max](RunPlan &plan, const double u) {
+        plan.setProperty<T>(name, index, scale<T>(u, min, max));
+    }});
+    return *this;
+}
+
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_SIM_SAMPLESPACE_H_
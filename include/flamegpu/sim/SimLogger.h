@@ -1,14 +1,15 @@
 #ifndef INCLUDE_FLAMEGPU_SIM_SIMLOGGER_H_
 #define INCLUDE_FLAMEGPU_SIM_SIMLOGGER_H_
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <thread>
 #include <mutex>
-#include <queue>
 #include <string>
-#include <condition_variable>
 
 #include "flamegpu/sim/LogFrame.h"
+#include "flamegpu/util/detail/BoundedQueue.h"
 
 namespace flamegpu {
 
@@ -16,6 +17,9 @@ class RunPlanVector;
 
 /**
  * This class is used by CUDAEnsemble::simulate() to collect logs generated by each of the SimRunner instances executing in different threads and write them to disk
+ *
+ * Logs are exported by a pool of worker threads, which consume the indices of completed runs from log_export_queue until it is closed.
+ * Either each run is exported to it's own files, or if export_shards is non-zero, each run is appended to one of export_shards aggregate files.
  */
 class SimLogger {
     friend class CUDAEnsemble;
@@ -25,33 +29,51 @@ class SimLogger {
      * @param run_plans Reference to the vector of run configurations to be executed
      * @param out_directory The directory to write logs to disk
      * @param out_format The format to write logs to disk.
-     * @param log_export_queue The queue of logs to exported to disk
-     * @param log_export_queue_mutex This mutex must be locked to access log_export_queue
-     * @param log_export_queue_cdn The condition is notified every time a log has been added to the queue
+     * @param log_export_queue The queue of logs to exported to disk, the workers exit once it has been closed and emptied
+     * @param export_threads The number of worker threads to export logs with
+     * @param export_shards If non-zero, the number of aggregate files to append all run logs to
      * @param _export_step If true step logs will be exported
      * @param _export_exit If true exit logs will be exported
      * @param _export_step_time If true step log time will be exported
      * @param _export_exit_time If true exit log time will be exported
+     * @throws exception::InvalidFilePath If a shard file cannot be created
      */
     SimLogger(const std::vector<RunLog> &run_logs,
         const RunPlanVector &run_plans,
         const std::string &out_directory,
         const std::string &out_format,
-        std::queue<unsigned int> &log_export_queue,
-        std::mutex &log_export_queue_mutex,
-        std::condition_variable &log_export_queue_cdn,
+        util::detail::BoundedQueue<unsigned int> &log_export_queue,
+        unsigned int export_threads,
+        unsigned int export_shards,
         bool _export_step,
         bool _export_exit,
         bool _export_step_time,
         bool _export_exit_time);
     /**
-     * The thread which the logger is executing on, created by the constructor
+     * The threads which the logger is executing on, created by the constructor
      */
-    std::thread thread;
+    std::vector<std::thread> threads;
     /**
-     * Starts the SimLogger running in thread
+     * Blocks until every worker thread has exited, and then completes the shard files
+     * log_export_queue must be closed first
      */
-    void start();
+    void join();
+    /**
+     * Exports logs from log_export_queue until it is closed and empty
+     * Executed by each worker thread
+     * @param thread_index Index of the worker thread, used to name it within traces
+     */
+    void start(unsigned int thread_index);
+    /**
+     * Exports the logs of the specified run to their own files within the run's output subdirectory
+     * @param run_id Index of the run within run_plans
+     */
+    void exportRun(unsigned int run_id);
+    /**
+     * Appends the logs of the specified run as a single record, to the run's shard file
+     * @param run_id Index of the run within run_plans
+     */
+    void exportRunToShard(unsigned int run_id);
     // External references
     /**
      * Reference to the vector to store generate run logs
@@ -72,15 +94,20 @@ class SimLogger {
     /**
      * The queue of logs to exported to disk
      */
-    std::queue<unsigned int> &log_export_queue;
+    util::detail::BoundedQueue<unsigned int> &log_export_queue;
+    /**
+     * Path of each shard file, empty if each run is exported to it's own files
+     */
+    std::vector<std::string> shard_paths;
     /**
-     * This mutex must be locked to access log_export_queue
+     * One mutex per shard file, which must be locked to append to the file
      */
-    std::mutex &log_export_queue_mutex;
+    std::vector<std::unique_ptr<std::mutex>> shard_mutexes;
     /**
-     * The condition is notified every time a log has been added to the queue
+     * One mutex per output subdirectory, which must be locked to append to it's exit log file
+     * Populated by the constructor, so it can be read concurrently by workers
      */
-    std::condition_variable &log_export_queue_cdn;
+    std::map<std::string, std::unique_ptr<std::mutex>> exit_file_mutexes;
     /**
      * If true step log files will be exported
      */
@@ -3,12 +3,10 @@
 
 #include <atomic>
 #include <memory>
-#include <mutex>
-#include <queue>
-#include <condition_variable>
 #include <thread>
 #include <vector>
 #include "flamegpu/sim/LogFrame.h"
+#include "flamegpu/util/detail/BoundedQueue.h"
 
 namespace flamegpu {
 
@@ -16,6 +14,9 @@ struct ModelData;
 class LoggingConfig;
 class StepLoggingConfig;
 class RunPlanVector;
+namespace detail {
+class RunPlanQueue;
+}  // namespace detail
 
 /**
  * A thread class which executes RunPlans on a single GPU
@@ -29,31 +30,31 @@ class SimRunner {
      * Constructor, creates and initialise a new SimRunner
      * @param _model A copy of the ModelDescription hierarchy for the RunPlanVector, this is used to create the CUDASimulation instances.
      * @param _err_ct Reference to an atomic integer for tracking how many errors have occurred
-     * @param _next_run Atomic counter for safely selecting the next run plan to execute across multiple threads
+     * @param _run_queue Queue for safely selecting the next run plan to execute across multiple threads
      * @param _plans The vector of run plans to be executed by the ensemble
      * @param _step_log_config The config of which data should be logged each step
      * @param _exit_log_config The config of which data should be logged at run exit
      * @param _device_id The GPU that all runs should execute on
      * @param _runner_id A unique index assigned to the runner
      * @param _verbose If true more information will be written to stdout
+     * @param _reuse_simulation If true a single CUDASimulation is reused for every run executed by the runner
+     * @param _profile If true each run's RunLog will contain a Profile
      * @param run_logs Reference to the vector to store generate run logs
-     * @param log_export_queue The queue of logs to exported to disk
-     * @param log_export_queue_mutex This mutex must be locked to access log_export_queue
-     * @param log_export_queue_cdn The condition is notified every time a log has been added to the queue
+     * @param log_export_queue The queue of logs to exported to disk, nullptr if logs are not being exported
      */
     SimRunner(const std::shared_ptr<const ModelData> _model,
         std::atomic<unsigned int> &_err_ct,
-        std::atomic<unsigned int> &_next_run,
+        detail::RunPlanQueue &_run_queue,
         const RunPlanVector &_plans,
         std::shared_ptr<const StepLoggingConfig> _step_log_config,
         std::shared_ptr<const LoggingConfig> _exit_log_config,
         int _device_id,
         unsigned int _runner_id,
         bool _verbose,
+        bool _reuse_simulation,
+        bool _profile,
         std::vector<RunLog> &run_logs,
-        std::queue<unsigned int> &log_export_queue,
-        std::mutex &log_export_queue_mutex,
-        std::condition_variable &log_export_queue_cdn);
+        util::detail::BoundedQueue<unsigned int> *log_export_queue);
     /**
      * Each sim runner takes it's own clone of model description hierarchy, so it can manipulate environment without conflict
      */
@@ -74,6 +75,16 @@ class SimRunner {
      * Flag for whether to print progress
      */
     const bool verbose;
+    /**
+     * If true, the CUDASimulation is retained between runs, and reset rather than recreated
+     * @see CUDAEnsemble::EnsembleConfig::reuse_simulations
+     */
+    const bool reuse_simulation;
+    /**
+     * If true, runs are profiled
+     * @see CUDAEnsemble::EnsembleConfig::profile
+     */
+    const bool profile;
     /**
      * The thread which the SimRunner executes on
      */
@@ -88,9 +99,9 @@ class SimRunner {
      */
     std::atomic<unsigned int> &err_ct;
     /**
-     * Atomic counter for safely selecting the next run plan to execute across multiple threads
+     * Queue for safely selecting the next run plan to execute across multiple threads, in scheduled order
      */
-    std::atomic<unsigned int> &next_run;
+    detail::RunPlanQueue &run_queue;
     /**
      * Reference to the vector of run configurations to be executed
      */
@@ -108,17 +119,10 @@ class SimRunner {
      */
     std::vector<RunLog> &run_logs;
     /**
-     * The queue of logs to exported to disk
-     */
-    std::queue<unsigned int> &log_export_queue;
-    /**
-     * This mutex must be locked to access log_export_queue
-     */
-    std::mutex &log_export_queue_mutex;
-    /**
-     * The condition is notified every time a log has been added to the queue
+     * The queue of logs to exported to disk, nullptr if logs are not being exported
+     * If the queue is full, the runner blocks until space is available
      */
-    std::condition_variable &log_export_queue_cdn;
+    util::detail::BoundedQueue<unsigned int> *const log_export_queue;
 };
 
 }  // namespace flamegpu
@@ -1,6 +1,8 @@
 #ifndef INCLUDE_FLAMEGPU_SIM_SIMULATION_H_
 #define INCLUDE_FLAMEGPU_SIM_SIMULATION_H_
 
+#include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <ctime>
@@ -8,6 +10,7 @@
 #include <unordered_map>
 
 #include "flamegpu/sim/AgentInterface.h"
+#include "flamegpu/util/Any.h"
 #include "flamegpu/util/StringUint32Pair.h"
 
 
@@ -18,6 +21,12 @@ class HostAPI;
 class ModelDescription;
 struct ModelData;
 struct RunLog;
+struct StepLogFrame;
+namespace io {
+class Checkpoint;
+class CheckpointWriter;
+class StepLogStreamWriter;
+}  // namespace io
 
 
 /**
@@ -38,10 +47,19 @@ class Simulation {
             exit_log_file = other.exit_log_file;
             common_log_file = other.common_log_file;
             truncate_log_files = other.truncate_log_files;
+            stream_step_log = other.stream_step_log;
+            step_log_flush_frequency = other.step_log_flush_frequency;
+            resume_step_log = other.resume_step_log;
+            step_log_pretty_print = other.step_log_pretty_print;
+            checkpoint_file = other.checkpoint_file;
+            checkpoint_frequency = other.checkpoint_frequency;
             random_seed = other.random_seed;
             steps = other.steps;
             verbose = other.verbose;
             timing = other.timing;
+            profile = other.profile;
+            trace_file = other.trace_file;
+            trace_flush_interval = other.trace_flush_interval;
 #ifdef VISUALISATION
             console_mode = other.console_mode;
 #endif
@@ -51,17 +69,61 @@ class Simulation {
         std::string exit_log_file;
         std::string common_log_file;
         bool truncate_log_files = true;
+        /**
+         * If true, step log frames are appended to step_log_file as they are produced, rather than written once simulate() completes
+         * Streamed frames are not retained in the RunLog, unless common_log_file is also set
+         */
+        bool stream_step_log = false;
+        /**
+         * The number of step log frames buffered before they are written to step_log_file, when stream_step_log is enabled
+         */
+        unsigned int step_log_flush_frequency = 1;
+        /**
+         * If true, a partially written step_log_file is resumed rather than overwritten, when stream_step_log is enabled
+         * Frames already present within the file are not written again
+         */
+        bool resume_step_log = false;
+        /**
+         * Whether the header and footer of step_log_file are indented, when stream_step_log is enabled
+         * Step log frames are always written compact, one per line
+         */
+        bool step_log_pretty_print = true;
+        /**
+         * If set alongside checkpoint_frequency, simulate() writes a checkpoint to this file every checkpoint_frequency steps
+         * @see Simulation::checkpoint()
+         */
+        std::string checkpoint_file;
+        /**
+         * The number of steps between each checkpoint written by simulate(), 0 disables automatic checkpoints
+         */
+        unsigned int checkpoint_frequency = 0;
         uint64_t random_seed;
         unsigned int steps = 1;
         bool verbose = false;
         bool timing = false;
+        /**
+         * If true, the duration of each layer, agent function, agent function condition, message index build, scatter and host function
+         * is accumulated during simulate(), and made available via RunLog::getProfile()
+         */
+        bool profile = false;
+        /**
+         * If set, a timeline of the steps, layers, agent functions and host functions executed by simulate() is written to this file
+         * in the Chrome Trace Event format, which can be viewed with chrome://tracing or https://ui.perfetto.dev
+         * This has no effect if a trace is already being recorded, e.g. by the CUDAEnsemble executing the simulation
+         */
+        std::string trace_file;
+        /**
+         * The interval (in milliseconds) at which recorded trace events are written to trace_file, 0 writes them once simulate() completes
+         * Long running simulations should set this, as events are dropped once a thread's trace buffer is full
+         */
+        unsigned int trace_flush_interval = 0;
 #ifdef VISUALISATION
         bool console_mode = false;
 #else
         const bool console_mode = true;
 #endif
     };
-    virtual ~Simulation() = default;
+    virtual ~Simulation();
     /**
      * This constructor takes a clone of the ModelData hierarchy
      */
@@ -112,12 +174,45 @@ class Simulation {
      * @note The config (possibly just random seed) is always output
      */
     void exportLog(const std::string &path, bool steps, bool exit, bool stepTime, bool exitTime, bool prettyPrint = true);
+    /**
+     * Captures the complete state of the simulation, and writes it to file on a background thread
+     * This includes agent populations, message lists, environment and macro properties, random generator state, the step counter,
+     * agent ID counters and the step log collected so far. Restoring the checkpoint with restore() and calling simulate()
+     * resumes the run, producing the same results as a run which was never interrupted.
+     * @param path The file to write, an existing file is only replaced once the new checkpoint has been completely written
+     * @note The state is captured before this method returns, only writing the file occurs in the background
+     * @note Checkpoints must be taken between steps (as is the case when using Config::checkpoint_frequency)
+     * @note Message lists are restored in index order, spatial and bucket indexes are rebuilt rather than stored
+     * @throws Any exception raised by the background write of the previous checkpoint
+     * @see waitForCheckpoint()
+     */
+    void checkpoint(const std::string &path);
+    /**
+     * Blocks until the background write of the most recent checkpoint has completed
+     * @throws Any exception raised by the background write (e.g. exception::InvalidFilePath)
+     */
+    void waitForCheckpoint();
+    /**
+     * Restores the state of the simulation from a file written by checkpoint()
+     * The next call to simulate() resumes the checkpointed run: init functions are not executed, the restored step log is
+     * retained, and steps are executed from the restored step counter until Config::steps is reached.
+     * @param path The file to read
+     * @throws exception::InvalidFilePath If the file cannot be opened
+     * @throws exception::InvalidInputFile If the file is corrupt, or was not produced by the same model
+     * @note Config::random_seed is set to that of the checkpointed run
+     */
+    void restore(const std::string &path);
 
     virtual void setPopulationData(AgentVector& population, const std::string& state_name = ModelData::DEFAULT_STATE) = 0;
     virtual void getPopulationData(AgentVector& population, const std::string& state_name = ModelData::DEFAULT_STATE) = 0;
 
     virtual const RunLog &getRunLog() const = 0;
     virtual AgentInterface &getAgent(const std::string &name) = 0;
+    /**
+     * Returns a copy of the current value of each environment property, used by exportData()
+     * @note Environment macro properties are not included
+     */
+    virtual std::map<std::string, util::Any> getEnvironmentProperties() const = 0;
 
     Config &SimulationConfig();
     const Config &getSimulationConfig() const;
@@ -138,6 +233,29 @@ class Simulation {
     virtual bool checkArgs_derived(int argc, const char** argv, int &i) = 0;
     virtual void printHelp_derived() = 0;
     virtual void resetDerivedConfig() = 0;
+    /**
+     * Adds the backend specific state to a checkpoint
+     * Agent populations are handled by the base class
+     */
+    virtual void checkpoint_derived(io::Checkpoint &checkpoint) = 0;
+    /**
+     * Restores the backend specific state from a checkpoint
+     * This is called after agent populations have been restored
+     */
+    virtual void restore_derived(const io::Checkpoint &checkpoint) = 0;
+    /**
+     * Writes a checkpoint to Config::checkpoint_file, if automatic checkpoints are enabled and step_count is a multiple of Config::checkpoint_frequency
+     * This should be called by simulate() after each step
+     */
+    void processCheckpoint(unsigned int step_count);
+    /**
+     * Adds a step log to a checkpoint
+     */
+    static void checkpointStepLog(const std::list<StepLogFrame> &step_log, io::Checkpoint &checkpoint);
+    /**
+     * Returns the step log held by a checkpoint
+     */
+    static std::list<StepLogFrame> restoreStepLog(const io::Checkpoint &checkpoint);
     /**
      * Returns the unique instance id of this CUDASimulation instance
      * @note This value is used internally for environment property storage
@@ -149,6 +267,23 @@ class Simulation {
      * @return the width of the widest layer.
      */
     unsigned int getMaximumLayerWidth() const { return maxLayerWidth; }
+    /**
+     * Opens the step log stream, if stream_step_log is enabled and step_log_file has been set
+     * This should be called by simulate(), after the RunLog has been reset
+     * @param logTime Include step time in each frame written
+     */
+    void openStepLogStream(bool logTime);
+    /**
+     * Writes the frame to the step log stream, if it is open
+     * @param frame The step log frame to be written
+     * @return True if the frame should also be retained in the RunLog
+     */
+    bool streamStepLog(const StepLogFrame &frame);
+    /**
+     * Closes the step log stream, if it is open
+     * @return True if the stream was open, in which case step_log_file does not require exporting
+     */
+    bool closeStepLogStream();
 
     const std::shared_ptr<const ModelData> model;
 
@@ -179,6 +314,19 @@ class Simulation {
      * the width of the widest layer in the concrete version of the model (calculated once)
      */
     unsigned int maxLayerWidth;
+    /**
+     * Incremental writer of step_log_file, only open during simulate() when stream_step_log is enabled
+     */
+    std::unique_ptr<io::StepLogStreamWriter> step_log_stream;
+    /**
+     * Writes checkpoints on a background thread, created by the first call to checkpoint()
+     */
+    std::unique_ptr<io::CheckpointWriter> checkpoint_writer;
+    /**
+     * Set by restore(), the next call to simulate() resumes the restored run rather than starting a new one
+     * This is cleared by simulate() and reset()
+     */
+    bool resume_from_checkpoint = false;
 
  private:
     /**
@@ -0,0 +1,97 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_BOUNDEDQUEUE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_BOUNDEDQUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <queue>
+#include <utility>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Thread safe FIFO queue, shared by any number of producer and consumer threads
+ *
+ * If a capacity is set, push() blocks whilst the queue is full, so that producers cannot outpace consumers (back-pressure).
+ * Once close() has been called, consumers drain the remaining items and pop() then returns false.
+ */
+template<typename T>
+class BoundedQueue {
+ public:
+    /**
+     * @param _capacity The maximum number of items held, 0 is unbounded
+     */
+    explicit BoundedQueue(size_t _capacity = 0)
+        : capacity(_capacity) { }
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+    /**
+     * Adds an item to the back of the queue, blocking whilst the queue is full
+     * @return False if the queue has been closed, in which case the item is discarded
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]{ return closed || !capacity || items.size() < capacity; });
+        if (closed)
+            return false;
+        items.push(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+    /**
+     * Removes the item at the front of the queue, blocking whilst the queue is empty
+     * @param item Set to the removed item
+     * @return False if the queue is empty and has been closed
+     */
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]{ return closed || !items.empty(); });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+    /**
+     * Prevents further items being pushed, and wakes all blocked threads
+     * Items already in the queue can still be popped
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+    /**
+     * Returns the number of items currently held
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+    /**
+     * Returns the maximum number of items held, 0 is unbounded
+     */
+    size_t getCapacity() const { return capacity; }
+
+ private:
+    const size_t capacity;
+    bool closed = false;
+    std::queue<T> items;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_BOUNDEDQUEUE_H_
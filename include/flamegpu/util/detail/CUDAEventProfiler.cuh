@@ -0,0 +1,148 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_CUDAEVENTPROFILER_CUH_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_CUDAEVENTPROFILER_CUH_
+
+#include <cuda_runtime.h>
+
+#include <string>
+#include <vector>
+
+#include "flamegpu/util/detail/Profiler.h"
+#include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Times regions of device work (e.g. agent function kernels) for a Profiler, using pairs of cudaEvents recorded to the stream which performs the work
+ *
+ * Unlike CUDAEventTimer, events are recorded to the passed stream, so concurrent work within other streams is not included.
+ * Regions are only accumulated into the Profiler by resolve(), which should be called after the streams have been synchronised.
+ * Events are pooled, and only created whilst the Profiler is enabled.
+ * @note free() must be called before the device is reset
+ */
+class CUDAEventProfiler {
+ public:
+    /**
+     * RAII device region, the start event is recorded on construction and the stop event on destruction
+     */
+    class Scope {
+     public:
+        /**
+         * @param events The event pool to time the region with, the region is not recorded if its profiler is disabled
+         * @param stream The stream which performs the work of the region
+         * @see Profiler::Scope::Scope()
+         */
+        Scope(CUDAEventProfiler &events, cudaStream_t stream, const char *category, const std::string &name, const std::string &owner = std::string())
+            : e(events.profiler.isEnabled() ? &events : nullptr)
+            , s(stream)
+            , i(e ? e->begin(s, category, name, owner) : 0) { }
+        /**
+         * Must not throw, as the scope may be destroyed whilst unwinding from an exception
+         */
+        ~Scope() { if (e) e->end(i, s); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+     private:
+        CUDAEventProfiler *e;
+        cudaStream_t s;
+        /**
+         * Index of the region within pending
+         */
+        size_t i;
+    };
+    explicit CUDAEventProfiler(Profiler &_profiler)
+        : profiler(_profiler) { }
+    /**
+     * Events are not destroyed by the destructor, as the device may have already been reset
+     * @see free()
+     */
+    ~CUDAEventProfiler() = default;
+    /**
+     * Blocks until the stop event of every pending region has occurred, and accumulates the regions into the profiler
+     */
+    void resolve() {
+        for (auto &r : pending) {
+            // Regions whose stop event failed to record are dropped
+            if (r.stopped) {
+                float ms = 0;
+                gpuErrchk(cudaEventSynchronize(r.stop));
+                gpuErrchk(cudaEventElapsedTime(&ms, r.start, r.stop));
+                profiler.add(r.path, ms / 1000.0);
+            }
+            pool.push_back(r.start);
+            pool.push_back(r.stop);
+        }
+        pending.clear();
+    }
+    /**
+     * Returns the events of all pending regions to the pool, without accumulating them into the profiler
+     * This should be called if work is abandoned due to an exception, so the regions are not resolved by a later resolve()
+     */
+    void discard() {
+        for (auto &r : pending) {
+            pool.push_back(r.start);
+            pool.push_back(r.stop);
+        }
+        pending.clear();
+    }
+    /**
+     * Destroys all events, discarding any pending regions
+     */
+    void free() {
+        discard();
+        for (auto &ev : pool) {
+            gpuErrchk(cudaEventDestroy(ev));
+        }
+        pool.clear();
+    }
+
+ private:
+    struct Region {
+        std::string path;
+        cudaEvent_t start;
+        cudaEvent_t stop;
+        /**
+         * True once the stop event has been successfully recorded
+         */
+        bool stopped;
+    };
+    /**
+     * Records the start event of a new pending region
+     * @return Index of the region within pending
+     */
+    size_t begin(cudaStream_t stream, const char *category, const std::string &name, const std::string &owner) {
+        pending.push_back({profiler.getPath(category, name, owner), acquire(), acquire(), false});
+        gpuErrchk(cudaEventRecord(pending.back().start, stream));
+        return pending.size() - 1;
+    }
+    /**
+     * Records the stop event of a pending region
+     * Errors are not thrown, as this is called by Scope's destructor, instead the region is dropped by resolve()
+     */
+    void end(const size_t index, cudaStream_t stream) noexcept {
+        if (index < pending.size()) {
+            pending[index].stopped = cudaEventRecord(pending[index].stop, stream) == cudaSuccess;
+        }
+    }
+    cudaEvent_t acquire() {
+        cudaEvent_t rtn;
+        if (pool.empty()) {
+            gpuErrchk(cudaEventCreate(&rtn));
+        } else {
+            rtn = pool.back();
+            pool.pop_back();
+        }
+        return rtn;
+    }
+    Profiler &profiler;
+    std::vector<Region> pending;
+    std::vector<cudaEvent_t> pool;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_CUDAEVENTPROFILER_CUH_
@@ -0,0 +1,32 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_CUDAMEMORYRESOURCE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_CUDAMEMORYRESOURCE_H_
+
+#include "flamegpu/util/detail/MemoryResource.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * MemoryResource backed by device memory of the current CUDA device (cudaMalloc/cudaFree)
+ * If built with UNIFIED_GPU_MEMORY, managed memory is allocated instead
+ */
+class CUDAMemoryResource : public MemoryResource {
+ public:
+    /**
+     * @return Pointer to the device buffer, or nullptr if the device has insufficient memory
+     * @throws exception::CUDAError If CUDA reports any other error
+     */
+    void *allocate(size_t bytes) override;
+    void deallocate(void *ptr) override;
+    /**
+     * Returns a process wide instance, CUDAMemoryResource holds no state
+     */
+    static CUDAMemoryResource &getInstance();
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_CUDAMEMORYRESOURCE_H_
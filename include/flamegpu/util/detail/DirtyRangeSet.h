@@ -0,0 +1,127 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_DIRTYRANGESET_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_DIRTYRANGESET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Ordered set of disjoint half-open index ranges [first, last), used to track which parts of a host buffer have been
+ * changed, so that only those parts need to be copied to the device
+ *
+ * Overlapping and adjacent ranges are merged as they are added.
+ * The number of ranges held is bounded by max_ranges, when exceeded the two ranges separated by the smallest gap are merged.
+ * This bounds the cost of add(), and avoids issuing many small copies when changes are scattered.
+ */
+class DirtyRangeSet {
+ public:
+    typedef std::pair<size_t, size_t> Range;
+    /**
+     * @param _max_ranges The maximum number of disjoint ranges to hold, 0 is treated as 1
+     */
+    explicit DirtyRangeSet(size_t _max_ranges = 16)
+        : max_ranges(_max_ranges ? _max_ranges : 1) { }
+    /**
+     * Marks the range [first, last) as dirty
+     * Empty ranges are ignored
+     */
+    void add(size_t first, size_t last) {
+        if (first >= last)
+            return;
+        // Fast path, changes are most often made front to back
+        if (ranges.empty() || first > ranges.back().second) {
+            ranges.emplace_back(first, last);
+        } else if (first >= ranges.back().first) {
+            ranges.back().second = std::max(ranges.back().second, last);
+        } else {
+            // Find the first range which ends at or after first, and the first range which begins after last
+            auto begin = std::lower_bound(ranges.begin(), ranges.end(), first, [](const Range &r, size_t v) { return r.second < v; });
+            auto end = std::upper_bound(begin, ranges.end(), last, [](size_t v, const Range &r) { return v < r.first; });
+            if (begin == end) {
+                ranges.insert(begin, Range{first, last});
+            } else {
+                // Merge [begin, end) into a single range
+                begin->first = std::min(begin->first, first);
+                begin->second = std::max((end - 1)->second, last);
+                ranges.erase(begin + 1, end);
+            }
+        }
+        if (ranges.size() > max_ranges)
+            mergeSmallestGap();
+    }
+    /**
+     * Removes all parts of ranges which lie at or beyond end
+     */
+    void truncate(size_t end) {
+        while (!ranges.empty() && ranges.back().first >= end)
+            ranges.pop_back();
+        if (!ranges.empty() && ranges.back().second > end)
+            ranges.back().second = end;
+    }
+    void clear() { ranges.clear(); }
+    bool empty() const { return ranges.empty(); }
+    /**
+     * Returns the dirty ranges, in ascending order
+     */
+    const std::vector<Range> &getRanges() const { return ranges; }
+    /**
+     * Returns the first dirty index and the index after the last dirty index, or {0, 0} if empty
+     */
+    Range getBounds() const {
+        return ranges.empty() ? Range{0, 0} : Range{ranges.front().first, ranges.back().second};
+    }
+    /**
+     * Returns the dirty ranges, with any ranges separated by a gap of at most max_gap merged
+     * This allows a caller to trade copying some clean indices for issuing fewer copies
+     * @param max_gap The largest gap between two ranges which should be merged
+     */
+    std::vector<Range> getCoalescedRanges(size_t max_gap) const {
+        std::vector<Range> rtn;
+        for (const auto &r : ranges) {
+            if (!rtn.empty() && r.first - rtn.back().second <= max_gap) {
+                rtn.back().second = r.second;
+            } else {
+                rtn.push_back(r);
+            }
+        }
+        return rtn;
+    }
+    /**
+     * Returns the total number of dirty indices
+     */
+    size_t count() const {
+        size_t rtn = 0;
+        for (const auto &r : ranges)
+            rtn += r.second - r.first;
+        return rtn;
+    }
+
+ private:
+    void mergeSmallestGap() {
+        size_t best = 0;
+        size_t best_gap = std::numeric_limits<size_t>::max();
+        for (size_t i = 0; i + 1 < ranges.size(); ++i) {
+            const size_t gap = ranges[i + 1].first - ranges[i].second;
+            if (gap < best_gap) {
+                best_gap = gap;
+                best = i;
+            }
+        }
+        ranges[best].second = ranges[best + 1].second;
+        ranges.erase(ranges.begin() + best + 1);
+    }
+    size_t max_ranges;
+    std::vector<Range> ranges;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_DIRTYRANGESET_H_
@@ -1,6 +1,7 @@
 #ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_JITIFYCACHE_H_
 #define INCLUDE_FLAMEGPU_UTIL_DETAIL_JITIFYCACHE_H_
 
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <memory>
@@ -15,6 +16,9 @@
 #include "jitify/jitify.hpp"
 #endif
 
+#include "flamegpu/util/detail/SingleFlight.h"
+#include "flamegpu/util/detail/KernelCacheStore.h"
+
 using jitify::experimental::KernelInstantiation;
 
 namespace flamegpu {
@@ -26,24 +30,18 @@ namespace detail {
  * If not, compile and add to both caches
  * Loading an RTC kernel from cache is significantly faster than compiling.
  *
+ * Kernels are identified by a SHA-256 digest of their source, dynamic header, template arguments and the CUDA/FLAMEGPU versions
+ * and device architecture they were compiled for. The on-disk cache is a KernelCacheStore, which is bounded in size, so least recently
+ * used kernels are evicted once the size limit is reached.
+ *
  * This class should sit between FLAMEGPU and Jitify
  */
 class JitifyCache {
-    /**
-     * This structure acts as a key to ensure the cached version is
-     * built for the right flamegpu/cuda/kernel
-     */
-    struct CachedProgram {
-        // dynamic header concatenated to kernel
-        // We check this is an exact match before loading from cache
-        std::string long_reference;
-        std::string serialised_kernelinst;
-    };
-
  public:
     /**
      * Returns a unique instance of the passed kernel
      * If this is not found in the in-memory or disk cache it will be compiled which is much slower
+     * Concurrent requests for the same kernel wait for a single compilation, whereas different kernels are compiled in parallel
      * @param func_name The name of the function (This is only used for error reporting)
      * @param template_args A vector of template arguments for instantiating the kernel.
      * In the case of FLAME GPU 2, these args are likely to be the user defined function_impl and the message i/o types.
@@ -87,6 +85,26 @@ class JitifyCache {
      * @note Will only clear the cache files used by the current build (debug or release)
      */
     void clearDiskCache();
+    /**
+     * Sets the total size (in bytes) of the on-disk cache, above which least recently used kernels are evicted
+     * 0 disables eviction
+     * Defaults to the value of the environment variable FLAMEGPU_RTC_DISK_CACHE_MB (in MiB) if set, otherwise KernelCacheStore::DEFAULT_MAX_BYTES
+     */
+    void setDiskCacheLimit(uint64_t bytes);
+    /**
+     * Returns the total size (in bytes) of the on-disk cache, above which least recently used kernels are evicted
+     */
+    uint64_t getDiskCacheLimit() const;
+    /**
+     * Used to configure whether kernels written to the on-disk cache are compressed
+     * Compressed kernels typically occupy a third of the space, and are slightly slower to load
+     * Defaults to true
+     */
+    void useDiskCacheCompression(bool yesno);
+    /**
+     * Returns whether kernels written to the on-disk cache are compressed
+     */
+    bool useDiskCacheCompression() const;
 
  private:
     /**
@@ -114,19 +132,38 @@ class JitifyCache {
      * @note Libraries such as GLM, which use relative includes internally cannot easily be optimised in this way
      */
     static void getKnownHeaders(std::vector<std::string> &headers);
+    /**
+     * Returns the on-disk cache, creating it on first use
+     * @note cache_mutex must be held
+     * @throws exception::InvalidFilePath If the cache directory cannot be created
+     */
+    KernelCacheStore &getDiskStore();
 
     /**
      * In-memory map of cached RTC kernels
-     * map<short_reference, program>
+     * map<digest, serialised kernel instantiation>
      */
-    std::map<std::string, CachedProgram> cache{};
+    std::map<std::string, std::string> cache{};
     /**
      * Mutex protecting multi-threaded accesses to cache
+     * This is not held during compilation, so that different kernels can be compiled concurrently
      */
     mutable std::mutex cache_mutex;
+    /**
+     * Tracks kernels currently being loaded/compiled, so that concurrent requests for the same kernel only compile it once
+     * Keyed by the kernel's digest, the produced value is the serialised kernel instantiation
+     */
+    SingleFlight<std::string, std::string> in_flight;
+    /**
+     * On-disk cache, created on first use as the cache directory may not be available
+     * Once created, this is never released, so may be used without holding cache_mutex
+     */
+    std::unique_ptr<KernelCacheStore> disk_store;
 
     bool use_memory_cache;
     bool use_disk_cache;
+    bool use_disk_cache_compression;
+    uint64_t disk_cache_limit;
 
     /**
      * Remainder of class is singleton pattern
@@ -0,0 +1,113 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_KERNELCACHESTORE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_KERNELCACHESTORE_H_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Size bounded, content-addressed on-disk store, used by JitifyCache to persist compiled RTC kernels between processes
+ *
+ * Each entry is stored within its own file "<key>.fgpuk", where the key is a hexadecimal digest (e.g. SHA-256) of everything
+ * which affects the entry's value, so a hit never needs to compare the (long) source it was derived from.
+ * Entries are written to a temporary file which is then renamed into place, so concurrent processes sharing the
+ * directory never observe partially written entries. Each entry also holds a checksum of its value, so damaged entries are treated as misses.
+ * Values can optionally be compressed.
+ *
+ * The time at which each entry was last used is recorded in the file "index" within the directory. When the total size of the entries exceeds
+ * the byte budget, least recently used entries are removed. The index only records recency, the entries themselves are always found by scanning
+ * the directory, so entries missing from the index (e.g. due to a concurrent process rewriting it) are treated as least recently used, rather than lost.
+ * @note Thread-safe, all methods may be called concurrently
+ */
+class KernelCacheStore {
+ public:
+    /**
+     * Default byte budget, 1 GiB
+     */
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 1ull << 30;
+    /**
+     * @param directory The directory holding the store, which must already exist
+     * @param max_bytes The total size of entries above which least recently used entries are evicted, 0 disables eviction
+     * @param compress If true, entries written by this store are compressed
+     */
+    explicit KernelCacheStore(const std::string &directory, uint64_t max_bytes = DEFAULT_MAX_BYTES, bool compress = true);
+    /**
+     * Writes any pending updates to the index
+     */
+    ~KernelCacheStore();
+    /**
+     * Loads the value of an entry
+     * @param key The entry's key, this must only contain alpha-numeric characters
+     * @param value Set to the entry's value if it was found
+     * @return True if a valid entry was found
+     * @throws exception::InvalidArgument If key is empty or contains unsupported characters
+     */
+    bool load(const std::string &key, std::string &value);
+    /**
+     * Atomically writes an entry, replacing any existing entry with the same key
+     * Least recently used entries are then evicted, until the store is within its byte budget
+     * The entry being written is never evicted by this call
+     * Failure to write the entry (e.g. the disk is full) is not an error, the entry will be written by a later call
+     * @param key The entry's key, this must only contain alpha-numeric characters
+     * @param value The entry's value
+     * @throws exception::InvalidArgument If key is empty or contains unsupported characters
+     */
+    void store(const std::string &key, const std::string &value);
+    /**
+     * Removes every entry, and the index
+     */
+    void clear();
+    /**
+     * Writes any pending updates to the index
+     */
+    void flush();
+    /**
+     * Returns the total size (in bytes) of all entries currently on disk
+     */
+    uint64_t getSize() const;
+    void setMaxBytes(uint64_t max_bytes);
+    uint64_t getMaxBytes() const;
+    void setCompression(bool compress);
+    bool getCompression() const;
+
+ private:
+    typedef std::map<std::string, int64_t> AccessMap;
+    /**
+     * Merges the access times of the index on disk with access_times, then atomically rewrites the index
+     * @note mutex must be held
+     */
+    void writeIndex();
+    /**
+     * Evicts least recently used entries, until the store is within max_bytes
+     * @param keep Key of an entry which must not be evicted
+     * @note mutex must be held
+     */
+    void evict(const std::string &keep);
+    /**
+     * Parses the index on disk
+     */
+    AccessMap readIndex() const;
+    /**
+     * Returns a unique path within the store's directory, for writing a temporary file to
+     */
+    std::string getTempPath(const std::string &name) const;
+    const std::string directory;
+    mutable std::mutex mutex;
+    uint64_t max_bytes;
+    bool compress;
+    /**
+     * Entries used by this process since the index was last written, and the time (ms since the unix epoch) they were last used
+     */
+    AccessMap access_times;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_KERNELCACHESTORE_H_
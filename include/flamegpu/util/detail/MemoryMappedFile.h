@@ -0,0 +1,51 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_MEMORYMAPPEDFILE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_MEMORYMAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Read-only memory mapping of an entire file
+ * Pages of the file are loaded by the OS on first access, so large files can be read without first copying them into a buffer
+ * The mapping is released when the instance is destroyed
+ */
+class MemoryMappedFile {
+ public:
+    /**
+     * Maps the named file into memory
+     * @param file_path Path to the file to be mapped
+     * @throws exception::InvalidFilePath If the file cannot be opened or mapped
+     */
+    explicit MemoryMappedFile(const std::string &file_path);
+    ~MemoryMappedFile();
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile&) = delete;
+    /**
+     * Returns a pointer to the start of the mapped file, this is nullptr if the file is empty
+     */
+    const char *data() const { return ptr; }
+    /**
+     * Returns the size of the mapped file in bytes
+     */
+    size_t size() const { return length; }
+
+ private:
+    const char *ptr = nullptr;
+    size_t length = 0;
+#ifdef _MSC_VER
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_MEMORYMAPPEDFILE_H_
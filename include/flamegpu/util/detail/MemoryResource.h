@@ -0,0 +1,178 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_MEMORYRESOURCE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_MEMORYRESOURCE_H_
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Interface to a source of raw memory buffers
+ *
+ * Implementations provide memory in a single address space (e.g. host or a specific CUDA device),
+ * so that buffer owners do not need to know how their memory is obtained.
+ */
+class MemoryResource {
+ public:
+    virtual ~MemoryResource() = default;
+    /**
+     * Allocates a buffer of atleast bytes
+     * @param bytes The minimum size of the buffer in bytes, must be greater than 0
+     * @return Pointer to the buffer, or nullptr if sufficient memory is not available
+     */
+    virtual void *allocate(size_t bytes) = 0;
+    /**
+     * Returns a buffer to the resource
+     * @param ptr A pointer returned by allocate(), which has not yet been deallocated. nullptr is ignored
+     */
+    virtual void deallocate(void *ptr) = 0;
+    /**
+     * Allocates a buffer of atleast bytes
+     * @param bytes The minimum size of the buffer in bytes, must be greater than 0
+     * @return Pointer to the buffer
+     * @throws exception::OutOfMemory If sufficient memory is not available
+     */
+    void *allocateOrThrow(size_t bytes);
+};
+
+/**
+ * MemoryResource backed by host memory (malloc/free)
+ * Used to test and benchmark PoolMemoryResource without a GPU
+ */
+class HostMemoryResource : public MemoryResource {
+ public:
+    void *allocate(size_t bytes) override;
+    void deallocate(void *ptr) override;
+};
+
+/**
+ * MemoryResource which caches released buffers, so that they can be reused by later allocations
+ *
+ * Requests are rounded up to a size class, four classes per power of two above MIN_BLOCK_SIZE, so that a cached buffer
+ * is reused by any request within ~19% of it's size. Released buffers are cached per size class, and are only returned to
+ * the upstream resource according to the ShrinkPolicy, when trim() is called, or when an upstream allocation fails.
+ * All methods are thread safe.
+ */
+class PoolMemoryResource : public MemoryResource {
+ public:
+    /**
+     * Controls how much released memory is retained for reuse
+     */
+    struct ShrinkPolicy {
+        /**
+         * If the total size of cached buffers exceeds this, the largest cached buffers are released upstream
+         */
+        size_t max_cached_bytes = std::numeric_limits<size_t>::max();
+        /**
+         * Released buffers larger than this are returned upstream immediately, rather than being cached
+         */
+        size_t max_cached_block = std::numeric_limits<size_t>::max();
+    };
+    /**
+     * Memory usage statistics, for profiling the pool
+     */
+    struct Statistics {
+        /**
+         * Total size of buffers currently allocated to users, after rounding to size class
+         */
+        size_t bytes_in_use = 0;
+        /**
+         * The greatest value bytes_in_use has held
+         */
+        size_t peak_bytes_in_use = 0;
+        /**
+         * Total size of cached buffers, available for reuse
+         */
+        size_t bytes_cached = 0;
+        /**
+         * Number of allocations served from the cache
+         */
+        size_t cache_hits = 0;
+        /**
+         * Number of allocations requested from the upstream resource
+         */
+        size_t upstream_allocations = 0;
+        /**
+         * Number of buffers returned to the upstream resource
+         */
+        size_t upstream_deallocations = 0;
+    };
+    /**
+     * The smallest size class, in bytes
+     */
+    static constexpr size_t MIN_BLOCK_SIZE = 256;
+    /**
+     * @param upstream The resource from which buffers are obtained, this must outlive the pool
+     */
+    explicit PoolMemoryResource(MemoryResource &upstream);
+    /**
+     * @param upstream The resource from which buffers are obtained, this must outlive the pool
+     * @param policy The initial shrink policy
+     */
+    PoolMemoryResource(MemoryResource &upstream, const ShrinkPolicy &policy);
+    /**
+     * Releases all cached buffers upstream
+     * Buffers still allocated to users are not released, as the pool does not own them
+     */
+    ~PoolMemoryResource() override;
+    PoolMemoryResource(const PoolMemoryResource &) = delete;
+    PoolMemoryResource &operator=(const PoolMemoryResource &) = delete;
+    /**
+     * Allocates a buffer of atleast bytes, reusing a cached buffer of the same size class if available
+     * If the upstream resource has insufficient memory, the cache is released and the allocation retried
+     * @return Pointer to the buffer, or nullptr if sufficient memory is not available
+     * @throws exception::InvalidArgument If bytes is 0
+     */
+    void *allocate(size_t bytes) override;
+    /**
+     * Returns a buffer to the pool, where it is cached or released according to the shrink policy
+     * @throws exception::InvalidArgument If ptr was not allocated by this pool, or has already been deallocated
+     */
+    void deallocate(void *ptr) override;
+    /**
+     * Releases cached buffers upstream, largest first, until atmost max_cached_bytes remain cached
+     * @param max_cached_bytes The total size of cached buffers to retain
+     */
+    void trim(size_t max_cached_bytes = 0);
+    /**
+     * Replaces the shrink policy, and trims the cache to satisfy it
+     */
+    void setShrinkPolicy(const ShrinkPolicy &policy);
+    ShrinkPolicy getShrinkPolicy() const;
+    Statistics getStatistics() const;
+    /**
+     * Returns the size class which a request of bytes is served from
+     */
+    static size_t getBlockSize(size_t bytes);
+
+ private:
+    /**
+     * trim() without locking mutex
+     */
+    void trim_locked(size_t max_cached_bytes);
+    MemoryResource &upstream;
+    ShrinkPolicy policy;
+    Statistics stats;
+    /**
+     * Cached buffers, by size class
+     */
+    std::map<size_t, std::vector<void*>> cache;
+    /**
+     * Size class of every buffer currently allocated to users
+     */
+    std::unordered_map<void*, size_t> in_use;
+    mutable std::mutex mutex;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_MEMORYRESOURCE_H_
@@ -0,0 +1,137 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_PROFILER_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_PROFILER_H_
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/sim/Profile.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Hierarchical host timer, which accumulates the time spent within nested regions of a simulation into a Profile
+ *
+ * Regions are opened and closed in stack order, usually via Profiler::Scope.
+ * Each region is named "category:name" (or just "category" if it has no name), and its path is the '/' separated names of
+ * the open regions which enclose it.
+ * When disabled, opening a region performs no string construction and no clock queries, so the profiler may be left
+ * in place within the hot path of a simulation.
+ * @note Not thread-safe, each instance is only accessed by the thread executing the owning simulation
+ */
+class Profiler {
+ public:
+    /**
+     * RAII region, which is opened on construction and closed on destruction
+     */
+    class Scope {
+     public:
+        /**
+         * Opens the region "category:name", or "category:owner.name" if owner is not empty
+         * @param profiler The profiler to record the region to, the region is not recorded if the profiler is disabled
+         * @param category The kind of region, e.g. "function"
+         * @param name The name of the region, e.g. the name of the agent function
+         * @param owner Optional name of the owner of the region, e.g. the name of the agent
+         */
+        Scope(Profiler &profiler, const char *category, const std::string &name = std::string(), const std::string &owner = std::string())
+            : p(profiler.isEnabled() ? &profiler : nullptr) {
+            if (p) p->push(category, name, owner);
+        }
+        /**
+         * Opens the region "category:index", for regions which do not have a name such as host functions
+         */
+        Scope(Profiler &profiler, const char *category, unsigned int index)
+            : p(profiler.isEnabled() ? &profiler : nullptr) {
+            if (p) p->push(category, std::to_string(index));
+        }
+        /**
+         * Opens the region "category:name", or "category:index" if name is empty, e.g. for layers which need not be named
+         */
+        Scope(Profiler &profiler, const char *category, const std::string &name, unsigned int index)
+            : p(profiler.isEnabled() ? &profiler : nullptr) {
+            if (p) p->push(category, name.empty() ? std::to_string(index) : name);
+        }
+        /**
+         * Closes the region
+         * Errors are not thrown, as the scope may be destroyed during stack unwinding, instead the region is discarded
+         */
+        ~Scope() noexcept {
+            if (p) {
+                try {
+                    p->pop();
+                } catch (...) { }
+            }
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+     private:
+        Profiler *p;
+    };
+    /**
+     * Enables or disables the profiler
+     * @note This should not be called whilst any regions are open
+     */
+    void setEnabled(bool _enabled) { enabled = _enabled; }
+    bool isEnabled() const { return enabled; }
+    /**
+     * Opens a region nested within the currently open region
+     * @see Scope::Scope()
+     */
+    void push(const char *category, const std::string &name, const std::string &owner = std::string());
+    /**
+     * Closes the most recently opened region, accumulating its duration
+     * @throws exception::UnknownInternalError If no region is open
+     */
+    void pop();
+    /**
+     * Returns the path that a region would have if it was opened now
+     * This allows regions which are timed by other means (e.g. cuda events) to be recorded later via add()
+     */
+    std::string getPath(const char *category, const std::string &name, const std::string &owner = std::string()) const;
+    /**
+     * Accumulates a single execution of a region which was timed externally
+     * @param path Full path of the region
+     * @param seconds Duration of the execution
+     */
+    void add(const std::string &path, double seconds) { profile.add(path, seconds); }
+    /**
+     * Accumulates all regions of another profile (e.g. that of a submodel), nested within the currently open region
+     */
+    void merge(const Profile &other) { profile.merge(other, path); }
+    /**
+     * Returns the regions accumulated since the last call to reset()
+     */
+    const Profile &getProfile() const { return profile; }
+    /**
+     * Discards all accumulated regions
+     * @note This should not be called whilst any regions are open
+     */
+    void reset() { profile.clear(); }
+
+ private:
+    typedef std::chrono::steady_clock clock;
+    /**
+     * Appends the name of a region to a path
+     */
+    static void appendSegment(std::string &path, const char *category, const std::string &name, const std::string &owner);
+    bool enabled = false;
+    /**
+     * Path of the currently open region
+     */
+    std::string path;
+    /**
+     * For each open region, the length of the path which encloses it, and the time at which it was opened
+     */
+    std::vector<std::pair<size_t, clock::time_point>> stack;
+    Profile profile;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_PROFILER_H_
@@ -0,0 +1,182 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_QUASIRANDOM_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_QUASIRANDOM_H_
+
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Space filling sample designs over the unit hypercube [0, 1)^d
+ * These are used by RunPlanVector to jointly sample several environment properties, covering the parameter space with
+ * far fewer samples than independent random draws.
+ *
+ * Each design returns n points of d dimensions, stored row major (point i, dimension j is at [i * d + j]).
+ */
+namespace quasi_random {
+/**
+ * Initial direction numbers of the Sobol sequence, for dimensions 2 onwards
+ * From the new-joe-kuo-6.21201 table of Joe and Kuo, "Constructing Sobol sequences with better two-dimensional projections",
+ * SIAM J. Sci. Comput. 30 (2008)
+ */
+struct SobolDirection {
+    /**
+     * Degree of the primitive polynomial
+     */
+    unsigned int s;
+    /**
+     * Interior coefficients of the primitive polynomial
+     */
+    unsigned int a;
+    /**
+     * Initial direction numbers m_1..m_s
+     */
+    std::array<uint32_t, 7> m;
+};
+static const SobolDirection SOBOL_DIRECTIONS[] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+/**
+ * The maximum number of dimensions supported by sobol()
+ */
+constexpr unsigned int SOBOL_MAX_DIMENSIONS = 1 + sizeof(SOBOL_DIRECTIONS) / sizeof(SobolDirection);
+/**
+ * Returns the first n points of the d dimensional Sobol sequence, in Gray code order
+ * The first point is the origin, so that the first 2^k points of each dimension are perfectly stratified
+ * @param n The number of points
+ * @param d The number of dimensions
+ * @throws exception::OutOfBoundsException If d exceeds SOBOL_MAX_DIMENSIONS
+ */
+inline std::vector<double> sobol(const unsigned int n, const unsigned int d) {
+    if (d > SOBOL_MAX_DIMENSIONS) {
+        THROW exception::OutOfBoundsException("Sobol sequence supports atmost %u dimensions, %u were requested, "
+            "in quasi_random::sobol()\n", SOBOL_MAX_DIMENSIONS, d);
+    }
+    // Direction numbers, scaled to 32 bit fixed point
+    std::vector<std::array<uint32_t, 32>> v(d);
+    for (unsigned int j = 0; j < d; ++j) {
+        if (j == 0) {
+            for (unsigned int k = 0; k < 32; ++k)
+                v[j][k] = 1u << (31 - k);
+            continue;
+        }
+        const SobolDirection &dir = SOBOL_DIRECTIONS[j - 1];
+        for (unsigned int k = 0; k < dir.s; ++k)
+            v[j][k] = dir.m[k] << (31 - k);
+        for (unsigned int k = dir.s; k < 32; ++k) {
+            v[j][k] = v[j][k - dir.s] ^ (v[j][k - dir.s] >> dir.s);
+            for (unsigned int l = 1; l < dir.s; ++l)
+                v[j][k] ^= ((dir.a >> (dir.s - 1 - l)) & 1u) * v[j][k - l];
+        }
+    }
+    std::vector<double> rtn(static_cast<size_t>(n) * d);
+    std::vector<uint32_t> x(d, 0);
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j < d; ++j)
+            rtn[static_cast<size_t>(i) * d + j] = x[j] / 4294967296.0;
+        // Gray code order, the next point differs from the current by the direction number of the lowest unset bit of i
+        unsigned int c = 0;
+        while (c < 31 && (i >> c) & 1u)
+            ++c;
+        for (unsigned int j = 0; j < d; ++j)
+            x[j] ^= v[j][c];
+    }
+    return rtn;
+}
+/**
+ * Returns points 1 to n of the d dimensional Halton sequence
+ * Dimension j is the radical inverse of the point index in the base of the j'th prime, the origin (point 0) is skipped
+ * @param n The number of points
+ * @param d The number of dimensions
+ */
+inline std::vector<double> halton(const unsigned int n, const unsigned int d) {
+    std::vector<unsigned int> bases;
+    for (unsigned int p = 2; bases.size() < d; ++p) {
+        bool prime = true;
+        for (const unsigned int b : bases) {
+            if (b * b > p)
+                break;
+            if (p % b == 0) {
+                prime = false;
+                break;
+            }
+        }
+        if (prime)
+            bases.push_back(p);
+    }
+    std::vector<double> rtn(static_cast<size_t>(n) * d);
+    for (unsigned int i = 0; i < n; ++i) {
+        for (unsigned int j = 0; j < d; ++j) {
+            double f = 1.0, r = 0.0;
+            for (unsigned int k = i + 1; k > 0; k /= bases[j]) {
+                f /= bases[j];
+                r += f * (k % bases[j]);
+            }
+            rtn[static_cast<size_t>(i) * d + j] = r;
+        }
+    }
+    return rtn;
+}
+/**
+ * Returns a uniform double in [0, 1) from the top 53 bits of a 64 bit generator
+ */
+template<typename RNG>
+double uniform(RNG &rng) {
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+/**
+ * Returns a random Latin hypercube design of n points
+ * Each dimension is divided into n equal strata, and each stratum is sampled exactly once, at a random position within it
+ * Permutations are generated by Fisher-Yates directly from the raw generator output, rather than via std::shuffle or
+ * std distributions (whose output is implementation defined), so a given seed produces the same design on every platform
+ * @param n The number of points
+ * @param d The number of dimensions
+ * @param rng A 64 bit generator such as std::mt19937_64
+ */
+template<typename RNG>
+std::vector<double> latinHypercube(const unsigned int n, const unsigned int d, RNG &rng) {
+    std::vector<double> rtn(static_cast<size_t>(n) * d);
+    std::vector<unsigned int> strata(n);
+    for (unsigned int j = 0; j < d; ++j) {
+        std::iota(strata.begin(), strata.end(), 0u);
+        for (unsigned int i = n; i > 1; --i) {
+            const unsigned int k = static_cast<unsigned int>(uniform(rng) * i);
+            std::swap(strata[i - 1], strata[k < i ? k : i - 1]);
+        }
+        for (unsigned int i = 0; i < n; ++i)
+            rtn[static_cast<size_t>(i) * d + j] = (strata[i] + uniform(rng)) / n;
+    }
+    return rtn;
+}
+}  // namespace quasi_random
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_QUASIRANDOM_H_
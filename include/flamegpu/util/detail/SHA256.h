@@ -0,0 +1,59 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_SHA256_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_SHA256_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Incremental SHA-256 (FIPS 180-4) hash
+ * Used to derive content addresses (e.g. of RTC kernels), where a collision must be practically impossible
+ */
+class SHA256 {
+ public:
+    SHA256() { reset(); }
+    /**
+     * Discards any data hashed so far
+     */
+    void reset();
+    /**
+     * Appends data to the message being hashed
+     */
+    void update(const void *data, size_t length);
+    void update(const std::string &data) { update(data.data(), data.size()); }
+    /**
+     * Completes the hash, and returns the digest as 64 lower case hexadecimal characters
+     * The object must be reset() before it is reused
+     */
+    std::string hexdigest();
+    /**
+     * Convenience method, returning the hexadecimal digest of a single string
+     */
+    static std::string hash(const std::string &data);
+
+ private:
+    /**
+     * Processes the 64 byte block held in buffer
+     */
+    void transform();
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, 64> buffer;
+    /**
+     * Number of bytes currently held in buffer
+     */
+    size_t buffer_len;
+    /**
+     * Total number of bytes hashed
+     */
+    uint64_t length;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_SHA256_H_
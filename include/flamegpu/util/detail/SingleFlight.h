@@ -0,0 +1,101 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_SINGLEFLIGHT_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_SINGLEFLIGHT_H_
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Deduplicates concurrent calls which produce the same value
+ *
+ * The first thread to call run() for a key (the leader) executes the producer, without holding any lock.
+ * Threads which call run() for the same key whilst the leader's producer is executing block, and receive a copy of the leader's result (or exception).
+ * Calls for different keys do not block one another.
+ * Once the leader's producer returns the key is released, so later calls execute the producer again; results should be cached by the caller.
+ *
+ * This is used by JitifyCache so that concurrent requests for the same RTC kernel only trigger a single compilation.
+ * @tparam Key Type used to identify the value, must be ordered
+ * @tparam Value Type of the produced value, must be copy constructible
+ */
+template<typename Key, typename Value>
+class SingleFlight {
+ public:
+    typedef std::function<Value()> Producer;
+    /**
+     * Returns the value produced for key
+     * @param key The key identifying the value
+     * @param producer Callback which produces the value, only executed if no other thread is currently producing the value for key
+     * @param is_leader If provided, set true if this call executed producer, otherwise false
+     * @return The value returned by producer
+     * @throws Any exception thrown by producer, this is also rethrown to every thread waiting on the same key
+     */
+    Value run(const Key &key, const Producer &producer, bool *is_leader = nullptr) {
+        std::shared_future<Value> flight;
+        std::promise<Value> promise;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto it = flights.find(key);
+            if (it != flights.end()) {
+                flight = it->second;
+            } else {
+                flights.emplace(key, promise.get_future().share());
+            }
+        }
+        if (is_leader)
+            *is_leader = !flight.valid();
+        if (flight.valid()) {
+            // Another thread is producing this value, wait for it
+            return flight.get();
+        }
+        // Leader, produce the value and release any waiting threads
+        try {
+            Value rtn = producer();
+            promise.set_value(rtn);
+            release(key);
+            return rtn;
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+            release(key);
+            throw;
+        }
+    }
+    /**
+     * Returns the number of keys which currently have a producer executing
+     */
+    size_t inFlight() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return flights.size();
+    }
+
+ private:
+    /**
+     * Removes key from the map of in-flight keys
+     */
+    void release(const Key &key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        flights.erase(key);
+    }
+    /**
+     * Result of each in-flight producer
+     * map<key, future>
+     */
+    std::map<Key, std::shared_future<Value>> flights;
+    /**
+     * Mutex protecting flights
+     */
+    mutable std::mutex mutex;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_SINGLEFLIGHT_H_
@@ -0,0 +1,136 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_SPACEFILLINGCURVE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_SPACEFILLINGCURVE_H_
+
+#ifndef __CUDACC_RTC__
+#include <cuda_runtime.h>
+#endif
+
+#include "flamegpu/runtime/messaging/MessageSortingType.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Space filling curve indices of the bins of an N dimensional grid
+ * These map grid coordinates to a single key, such that bins which are close in space have keys which are close in value.
+ * They are used as the key of the automatic spatial sort, and are available on both host and device.
+ *
+ * Each function is templated over the number of dimensions N, and the unsigned integer type of the key T.
+ * A key holds sizeof(T)*8/N bits of each coordinate, grids with more bins per axis are coarsened by discarding low bits.
+ */
+namespace space_filling_curve {
+/**
+ * The maximum number of bits of each coordinate which can be held by a key of type T
+ */
+template<unsigned int N, typename T>
+__host__ __device__ constexpr unsigned int maxBits() {
+    return static_cast<unsigned int>(sizeof(T) * 8) / N;
+}
+/**
+ * Returns the number of bits required to represent every coordinate of a grid
+ * @param dims The number of bins along each axis of the grid
+ */
+template<unsigned int N>
+__host__ __device__ inline unsigned int requiredBits(const unsigned int (&dims)[N]) {
+    unsigned int max_dim = 0;
+    for (unsigned int i = 0; i < N; ++i)
+        max_dim = dims[i] > max_dim ? dims[i] : max_dim;
+    unsigned int bits = 0;
+    while (bits < 32 && (1ull << bits) < max_dim)
+        ++bits;
+    return bits;
+}
+/**
+ * Interleaves the low bits of each coordinate, the first coordinate is least significant
+ * @param coords The coordinates, each must be less than 2^bits
+ * @param bits The number of bits of each coordinate, N*bits must not exceed the width of T
+ */
+template<unsigned int N, typename T>
+__host__ __device__ inline T morton(const unsigned int (&coords)[N], const unsigned int bits) {
+    T key = 0;
+    for (unsigned int b = bits; b > 0; --b) {
+        for (unsigned int i = N; i > 0; --i) {
+            key = (key << 1) | static_cast<T>((coords[i - 1] >> (b - 1)) & 1u);
+        }
+    }
+    return key;
+}
+/**
+ * Returns the index of a point along the Hilbert curve which fills the 2^bits hypercube
+ * Implementation of the transpose algorithm of Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004)
+ * @param coords The coordinates, each must be less than 2^bits
+ * @param bits The number of bits of each coordinate, N*bits must not exceed the width of T
+ */
+template<unsigned int N, typename T>
+__host__ __device__ inline T hilbert(const unsigned int (&coords)[N], const unsigned int bits) {
+    if (bits == 0)
+        return 0;
+    unsigned int X[N];
+    for (unsigned int i = 0; i < N; ++i)
+        X[i] = coords[i];
+    const unsigned int M = 1u << (bits - 1);
+    // Inverse undo excess work
+    for (unsigned int Q = M; Q > 1; Q >>= 1) {
+        const unsigned int P = Q - 1;
+        for (unsigned int i = 0; i < N; ++i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            } else {
+                const unsigned int t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    // Gray encode
+    for (unsigned int i = 1; i < N; ++i)
+        X[i] ^= X[i - 1];
+    unsigned int t = 0;
+    for (unsigned int Q = M; Q > 1; Q >>= 1) {
+        if (X[N - 1] & Q)
+            t ^= Q - 1;
+    }
+    for (unsigned int i = 0; i < N; ++i)
+        X[i] ^= t;
+    // The transposed index holds bit b of the key's b'th digit (base 2^N) in X[], the first coordinate is most significant
+    T key = 0;
+    for (unsigned int b = bits; b > 0; --b) {
+        for (unsigned int i = 0; i < N; ++i) {
+            key = (key << 1) | static_cast<T>((X[i] >> (b - 1)) & 1u);
+        }
+    }
+    return key;
+}
+/**
+ * Returns the sort key of a bin of a grid
+ * Coordinates outside of the grid are clamped to the nearest bin, except for RowMajor which matches the bin's linear index
+ * @param order The curve used to compute the key
+ * @param pos The coordinates of the bin
+ * @param dims The number of bins along each axis of the grid
+ */
+template<unsigned int N, typename T>
+__host__ __device__ inline T key(const SpatialSortOrder order, const int (&pos)[N], const unsigned int (&dims)[N]) {
+    if (order == SpatialSortOrder::RowMajor) {
+        T rtn = 0;
+        for (unsigned int i = N; i > 0; --i)
+            rtn = rtn * dims[i - 1] + static_cast<T>(pos[i - 1]);
+        return rtn;
+    }
+    unsigned int bits = requiredBits<N>(dims);
+    const unsigned int shift = bits > maxBits<N, T>() ? bits - maxBits<N, T>() : 0;
+    bits -= shift;
+    unsigned int coords[N];
+    for (unsigned int i = 0; i < N; ++i) {
+        const unsigned int c = pos[i] < 0 ? 0u : static_cast<unsigned int>(pos[i]);
+        coords[i] = (c < dims[i] ? c : (dims[i] ? dims[i] - 1 : 0)) >> shift;
+    }
+    return order == SpatialSortOrder::Morton ? morton<N, T>(coords, bits) : hilbert<N, T>(coords, bits);
+}
+}  // namespace space_filling_curve
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_SPACEFILLINGCURVE_H_
@@ -0,0 +1,187 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_SPARSECELLTABLE_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_SPARSECELLTABLE_H_
+
+#ifndef __CUDACC_RTC__
+#include <cuda_runtime.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#endif
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Open addressing hash table, which maps the linear index of each occupied spatial messaging bin to a compact slot
+ * Used by MessageSpatial2D and MessageSpatial3D when sparse partitioning is enabled, so that the size of the partition
+ * boundary matrix (PBM) scales with the number of messages, rather than the volume of the environment.
+ *
+ * The table is an array of capacity keys, where capacity is a power of 2 and at least twice the number of occupied bins.
+ * Unoccupied slots hold EMPTY. Keys are inserted with linear probing.
+ * Each slot owns the matching bin of the PBM, so the messages of the bin held in slot i are [PBM[i], PBM[i+1]).
+ */
+namespace sparse_cell_table {
+/**
+ * Key held by unoccupied slots, this is not a valid bin index
+ */
+constexpr unsigned int EMPTY = 0xffffffff;
+/**
+ * Minimum number of slots in a table
+ */
+constexpr unsigned int MIN_CAPACITY = 64;
+/**
+ * Scrambles the bits of a bin index, so that neighbouring bins do not form long probe sequences (MurmurHash3 finaliser)
+ */
+__host__ __device__ inline unsigned int hash(unsigned int key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6b;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35;
+    key ^= key >> 16;
+    return key;
+}
+/**
+ * Returns the slot which holds key, or EMPTY if the bin is unoccupied
+ * @param keys The table
+ * @param capacity The number of slots in the table, must be a power of 2
+ * @param key The linear index of the bin
+ */
+__host__ __device__ inline unsigned int find(const unsigned int *keys, const unsigned int capacity, const unsigned int key) {
+    const unsigned int mask = capacity - 1;
+    unsigned int slot = hash(key) & mask;
+    for (unsigned int i = 0; i < capacity; ++i) {
+        const unsigned int k = keys[slot];
+        if (k == key)
+            return slot;
+        if (k == EMPTY)
+            return EMPTY;
+        slot = (slot + 1) & mask;
+    }
+    return EMPTY;
+}
+#ifdef __CUDACC__
+/**
+ * Returns the slot which holds key, claiming an unoccupied slot if the bin is not yet present
+ * Safe for concurrent use by many threads
+ * @param keys The table
+ * @param capacity The number of slots in the table, must be a power of 2
+ * @param key The linear index of the bin
+ * @return The slot, or EMPTY if the table is full (getCapacity() prevents this)
+ */
+__device__ inline unsigned int insert(unsigned int *keys, const unsigned int capacity, const unsigned int key) {
+    const unsigned int mask = capacity - 1;
+    unsigned int slot = hash(key) & mask;
+    for (unsigned int i = 0; i < capacity; ++i) {
+        const unsigned int prev = atomicCAS(keys + slot, EMPTY, key);
+        if (prev == EMPTY || prev == key)
+            return slot;
+        slot = (slot + 1) & mask;
+    }
+    return EMPTY;
+}
+#endif  // __CUDACC__
+#ifndef __CUDACC_RTC__
+/**
+ * Returns the number of slots required to hold max_occupied bins
+ * This is the smallest power of 2 which is at least twice max_occupied, so that the table is never more than half full
+ */
+inline unsigned int getCapacity(const uint64_t max_occupied) {
+    uint64_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * max_occupied)
+        capacity <<= 1;
+    return static_cast<unsigned int>(capacity);
+}
+#endif  // __CUDACC_RTC__
+}  // namespace sparse_cell_table
+
+#ifndef __CUDACC_RTC__
+/**
+ * Host reference implementation of the sparse index built by MessageSpatial2D and MessageSpatial3D
+ * Keys are inserted in message order, so the layout of the table matches that produced by the device
+ * when messages are inserted by a single thread.
+ */
+class SparseCellTable {
+ public:
+    /**
+     * Builds the table and PBM from the bin index of each message
+     * @param bin_index Linear bin index of each message
+     * @param capacity Number of slots, must be a power of 2 greater than the number of distinct bins.
+     *        If 0, sparse_cell_table::getCapacity(bin_index.size()) is used.
+     */
+    explicit SparseCellTable(const std::vector<unsigned int> &bin_index, const unsigned int capacity = 0)
+        : keys(capacity ? capacity : sparse_cell_table::getCapacity(bin_index.size()), sparse_cell_table::EMPTY)
+        , pbm(keys.size() + 1, 0)
+        , destination(bin_index.size())
+        , occupied(0) {
+        const unsigned int cap = static_cast<unsigned int>(keys.size());
+        const unsigned int mask = cap - 1;
+        // Histogram, by slot
+        std::vector<unsigned int> slot_index(bin_index.size());
+        for (size_t i = 0; i < bin_index.size(); ++i) {
+            unsigned int slot = sparse_cell_table::hash(bin_index[i]) & mask;
+            while (keys[slot] != sparse_cell_table::EMPTY && keys[slot] != bin_index[i])
+                slot = (slot + 1) & mask;
+            if (keys[slot] == sparse_cell_table::EMPTY) {
+                keys[slot] = bin_index[i];
+                ++occupied;
+            }
+            slot_index[i] = slot;
+            destination[i] = pbm[slot]++;
+        }
+        // Exclusive scan, to finalise PBM
+        unsigned int running = 0;
+        for (auto &p : pbm) {
+            const unsigned int t = p;
+            p = running;
+            running += t;
+        }
+        for (size_t i = 0; i < bin_index.size(); ++i) {
+            destination[i] += pbm[slot_index[i]];
+        }
+    }
+    /**
+     * Returns the number of slots in the table
+     */
+    unsigned int getCapacity() const { return static_cast<unsigned int>(keys.size()); }
+    /**
+     * Returns the number of distinct bins which contain messages
+     */
+    unsigned int getOccupiedCount() const { return occupied; }
+    /**
+     * Returns the key held by each slot
+     */
+    const std::vector<unsigned int> &getKeys() const { return keys; }
+    /**
+     * Returns the partition boundary matrix, slot i contains the messages [pbm[i], pbm[i+1])
+     */
+    const std::vector<unsigned int> &getPBM() const { return pbm; }
+    /**
+     * Returns the position of each message once messages have been sorted by slot
+     */
+    const std::vector<unsigned int> &getDestination() const { return destination; }
+    /**
+     * Returns the range [first, last) of sorted messages which fall within the named bin
+     * The range is empty if the bin is unoccupied
+     */
+    std::pair<unsigned int, unsigned int> getBin(const unsigned int bin) const {
+        const unsigned int slot = sparse_cell_table::find(keys.data(), getCapacity(), bin);
+        if (slot == sparse_cell_table::EMPTY)
+            return {0, 0};
+        return {pbm[slot], pbm[slot + 1]};
+    }
+
+ private:
+    std::vector<unsigned int> keys;
+    std::vector<unsigned int> pbm;
+    std::vector<unsigned int> destination;
+    unsigned int occupied;
+};
+#endif  // __CUDACC_RTC__
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_SPARSECELLTABLE_H_
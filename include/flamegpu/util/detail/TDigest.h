@@ -0,0 +1,84 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_TDIGEST_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_TDIGEST_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Streaming quantile sketch (merging t-digest, Dunning & Ertl)
+ *
+ * Values are summarised as a sorted list of weighted centroids, whose size is bounded by the compression parameter.
+ * Centroids near the tails are kept small, so extreme quantiles are estimated more accurately than the median.
+ * Whilst fewer than roughly compression / 2 values have been added, every value is held as it's own centroid, so quantiles are exact
+ * (linearly interpolated between neighbouring values).
+ * Digests can be merged, so partial digests of a population may be built independently.
+ */
+class TDigest {
+ public:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+    /**
+     * @param _compression Bounds the number of centroids retained (approximately 2x compression), higher values are more accurate
+     */
+    explicit TDigest(double _compression = 200);
+    /**
+     * Adds a value to the digest
+     * @param x The value to add, NaN is ignored
+     * @param w The weight of the value (e.g. the number of occurrences)
+     */
+    void add(double x, double w = 1);
+    /**
+     * Adds the centroids of another digest to this digest
+     */
+    void merge(const TDigest &other);
+    /**
+     * Returns the estimated value at quantile q
+     * @param q The quantile, in the range [0, 1]
+     * @return The estimate, or 0 if the digest is empty
+     * @throws exception::InvalidArgument If q is not within [0, 1]
+     */
+    double quantile(double q) const;
+    /**
+     * Returns the total weight of values added to the digest
+     */
+    double getCount() const { return total_weight + buffer_weight; }
+    double getMin() const { return min; }
+    double getMax() const { return max; }
+    /**
+     * Returns the centroids, after merging any buffered values
+     */
+    const std::vector<Centroid> &getCentroids() const;
+    /**
+     * Merges any buffered values into the centroids
+     */
+    void compress() const;
+
+ private:
+    /**
+     * Maps a quantile to the k scale (k1 scale function), centroids may span at most 1 unit of k
+     */
+    double k(double q) const;
+    double compression;
+    /**
+     * Mutable, as centroids are lazily merged by the const accessors
+     */
+    mutable std::vector<Centroid> centroids;
+    mutable std::vector<Centroid> buffer;
+    mutable double total_weight;
+    mutable double buffer_weight;
+    size_t buffer_capacity;
+    double min;
+    double max;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_TDIGEST_H_
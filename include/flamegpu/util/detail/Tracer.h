@@ -0,0 +1,251 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_TRACER_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Process wide timeline tracer, which writes events in the Chrome Trace Event JSON format
+ * The output can be viewed with chrome://tracing or https://ui.perfetto.dev
+ *
+ * Each thread records events into its own fixed capacity ring buffer, which is lock-free and only shared with the writer.
+ * Events are written to file by stop(), or periodically by a background writer thread if a flush interval was passed to start().
+ * If a thread's buffer is full when an event is recorded, the event is dropped and counted, rather than blocking the thread.
+ * Whilst the tracer is not active, recording an event costs a single relaxed atomic load.
+ *
+ * Events are recorded as complete ("X") events, so that each holds both its begin and end time.
+ * As well as its name, each event records the run index and layer of the thread which recorded it, and the stream it was issued to.
+ */
+class Tracer {
+ public:
+    /**
+     * Default number of events each thread's ring buffer can hold
+     */
+    static constexpr size_t DEFAULT_BUFFER_EVENTS = 1 << 14;
+    /**
+     * Maximum length of an event's name, longer names are truncated
+     */
+    static constexpr size_t MAX_NAME_LENGTH = 63;
+    /**
+     * A single traced region
+     */
+    struct Event {
+        /**
+         * Static string, e.g. "function"
+         */
+        const char *category;
+        char name[MAX_NAME_LENGTH + 1];
+        /**
+         * Nanoseconds since the steady clock's epoch
+         */
+        int64_t begin;
+        int64_t end;
+        /**
+         * Index of the layer, stream and ensemble run, or -1 if not applicable
+         */
+        int layer;
+        int stream;
+        int run;
+    };
+    /**
+     * RAII traced region, which records a single event on destruction, if the tracer was active on construction
+     */
+    class Scope {
+     public:
+        /**
+         * @param category Static string denoting the kind of region, e.g. "function"
+         * @param name The name of the region, e.g. the name of the agent function
+         * @param owner Optional name of the owner of the region, e.g. the name of the agent, the event is named "owner.name"
+         * @param layer Index of the layer the region belongs to, if applicable
+         * @param stream Index of the stream the region issues work to, if applicable
+         */
+        explicit Scope(const char *category, const std::string &name = std::string(), const std::string &owner = std::string(), int layer = -1, int stream = -1)
+            : active(isEnabled()) {
+            if (active) begin(category, owner, name, layer, stream);
+        }
+        /**
+         * Names the region by its index, for regions which do not have a name such as host functions
+         */
+        Scope(const char *category, unsigned int index, int layer = -1)
+            : active(isEnabled()) {
+            if (active) begin(category, std::string(), std::to_string(index), layer, -1);
+        }
+        ~Scope() { if (active) end(); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+     private:
+        void begin(const char *category, const std::string &owner, const std::string &name, int layer, int stream);
+        void end();
+        bool active;
+        Event event;
+    };
+    /**
+     * RAII trace session, which starts the tracer on construction if it is not already active, and stops it on destruction
+     * This allows nested owners (e.g. a CUDAEnsemble and the simulations it executes) to each request a trace,
+     * with the outermost owner's session recording the events of all of them
+     */
+    class Session {
+     public:
+        /**
+         * @param path The file to write the trace to, if empty no session is started
+         * @see Tracer::start()
+         */
+        explicit Session(const std::string &path, unsigned int flush_interval_ms = 0)
+            : owner(!path.empty() && getInstance().start(path, flush_interval_ms)) { }
+        ~Session() { if (owner) getInstance().stop(); }
+        Session(const Session &) = delete;
+        Session &operator=(const Session &) = delete;
+        /**
+         * Returns true if this session started the tracer, and will stop it
+         */
+        bool isOwner() const { return owner; }
+
+     private:
+        const bool owner;
+    };
+    /**
+     * Returns the tracer singleton
+     */
+    static Tracer &getInstance();
+    /**
+     * Returns true if events are currently being recorded
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    /**
+     * Names the calling thread within the trace, e.g. "CUDASim D0T1"
+     * This may be called before the tracer is started
+     */
+    static void setThreadName(const std::string &name);
+    /**
+     * Sets the ensemble run index which subsequent events recorded by the calling thread belong to, -1 if none
+     */
+    static void setRunIndex(int run_index);
+    /**
+     * Begins recording events, truncating the output file
+     * @param path The file to write the trace to
+     * @param flush_interval_ms If non-zero, a background thread writes the recorded events to file at this interval (in milliseconds),
+     * so that long runs are not limited by the capacity of the buffers. Otherwise, events are only written by stop().
+     * @param buffer_events The number of events each thread's ring buffer can hold, this only affects threads which have not previously recorded events
+     * @return False if the tracer was already active, in which case the call has no effect
+     * @throws exception::InvalidFilePath If the file cannot be opened for writing
+     */
+    bool start(const std::string &path, unsigned int flush_interval_ms = 0, size_t buffer_events = DEFAULT_BUFFER_EVENTS);
+    /**
+     * Stops recording events, writes any remaining events and closes the output file
+     * Has no effect if the tracer is not active
+     * @return The number of events dropped, as they were recorded whilst their thread's buffer was full
+     */
+    uint64_t stop();
+    /**
+     * Returns true between calls to start() and stop()
+     */
+    bool isActive() const;
+
+ private:
+    /**
+     * Single producer (the owning thread), single consumer (the writer) ring buffer of events
+     */
+    struct ThreadBuffer {
+        ThreadBuffer(unsigned int _tid, size_t capacity);
+        void push(const Event &e);
+        std::unique_ptr<Event[]> events;
+        /**
+         * Capacity is always a power of 2
+         */
+        const uint64_t mask;
+        /**
+         * Count of events pushed, only written by the producer
+         */
+        std::atomic<uint64_t> head;
+        /**
+         * Count of events consumed, only written by the consumer
+         */
+        std::atomic<uint64_t> tail;
+        std::atomic<uint64_t> dropped;
+        /**
+         * Set when the owning thread exits, the buffer is released once it has been drained
+         */
+        std::atomic<bool> orphaned;
+        const unsigned int tid;
+        /**
+         * Protected by Tracer::buffers_mutex
+         */
+        std::string name;
+        /**
+         * The name most recently written to file, only accessed by the consumer
+         */
+        std::string written_name;
+    };
+    /**
+     * Releases a thread's buffer to the tracer when the thread exits
+     */
+    struct ThreadBufferHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+        std::string name;
+        int run_index = -1;
+        ~ThreadBufferHandle();
+    };
+    Tracer() = default;
+    ~Tracer();
+    /**
+     * Returns the calling thread's buffer, registering a new buffer if required
+     */
+    ThreadBuffer &getThreadBuffer();
+    static ThreadBufferHandle &getThreadHandle();
+    /**
+     * Writes all events recorded since the last drain to file
+     * @note writer_mutex must be held
+     */
+    void drain();
+    /**
+     * Body of the background writer thread
+     */
+    void writerLoop(unsigned int flush_interval_ms);
+    static std::atomic<bool> enabled;
+    /**
+     * Protects buffers and the names of buffers
+     */
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    unsigned int next_tid = 1;
+    size_t buffer_events = DEFAULT_BUFFER_EVENTS;
+    /**
+     * Protects the output file and all consumer state
+     */
+    mutable std::mutex writer_mutex;
+    FILE *file = nullptr;
+    /**
+     * Steady clock time (ns) at which start() was called, timestamps are written relative to this
+     */
+    int64_t epoch = 0;
+    /**
+     * Dropped events which have already been accounted for by drain(), as buffers may be released
+     */
+    uint64_t dropped = 0;
+    std::thread writer;
+    std::condition_variable writer_cv;
+    bool writer_stop = false;
+
+ public:
+    Tracer(const Tracer &) = delete;
+    void operator=(const Tracer &) = delete;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_TRACER_H_
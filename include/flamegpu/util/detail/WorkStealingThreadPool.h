@@ -0,0 +1,118 @@
+#ifndef INCLUDE_FLAMEGPU_UTIL_DETAIL_WORKSTEALINGTHREADPOOL_H_
+#define INCLUDE_FLAMEGPU_UTIL_DETAIL_WORKSTEALINGTHREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+/**
+ * Fixed size pool of worker threads, where each worker owns a double ended task queue
+ * Workers pop tasks from the back of their own queue, and when it is empty steal from the front of other workers' queues
+ * This keeps the load balanced when the cost of individual tasks varies (e.g. agents with differing message neighbourhoods)
+ * The thread calling parallelFor() also participates in executing work, so a pool with a thread count of 1 executes serially
+ */
+class WorkStealingThreadPool {
+ public:
+    /**
+     * A unit of work which processes the index range [begin, end)
+     */
+    typedef std::function<void(size_t begin, size_t end)> RangeFunction;
+    /**
+     * Construct the pool and launch the worker threads
+     * @param thread_count The total number of threads which will execute work, including the calling thread
+     *        If 0, std::thread::hardware_concurrency() is used
+     */
+    explicit WorkStealingThreadPool(unsigned int thread_count = 0);
+    /**
+     * Signals the workers to exit and joins them
+     * Any outstanding work is completed first
+     */
+    ~WorkStealingThreadPool();
+    WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+    WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+    /**
+     * Returns the total number of threads which execute work, including the calling thread
+     */
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(queues.size()) + 1; }
+    /**
+     * Splits the range [begin, end) into chunks of (at most) grain elements, and executes fn over each chunk
+     * Chunks are distributed round-robin across the worker queues, idle workers then steal to balance the load
+     * This call blocks until every chunk has been processed
+     * @param begin First index of the range
+     * @param end One past the last index of the range
+     * @param grain Maximum number of elements per chunk, if 0 a grain is chosen which gives each thread ~4 chunks
+     * @param fn Function to execute over each chunk
+     * @note If fn throws, the first exception caught is rethrown on the calling thread after all chunks have completed
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain, const RangeFunction &fn);
+
+ private:
+    /**
+     * Tracks completion of a single call to parallelFor()
+     */
+    struct Batch {
+        std::atomic<size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr exception;
+    };
+    typedef std::function<void()> Task;
+    /**
+     * A worker's task queue
+     * A mutex per queue is sufficient, as contention only occurs when stealing
+     */
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    /**
+     * Pop a task from the back of the named queue
+     * @return true if a task was returned
+     */
+    bool popLocal(size_t queue_index, Task &task);
+    /**
+     * Steal a task from the front of any queue other than the named queue
+     * @param thief_index Index of the queue to skip, pass queues.size() to consider all queues
+     * @return true if a task was returned
+     */
+    bool steal(size_t thief_index, Task &task);
+    /**
+     * Main loop of each worker thread
+     */
+    void workerLoop(size_t queue_index);
+    /**
+     * One queue per worker thread
+     */
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    /**
+     * Used to sleep idle workers until work is enqueued
+     */
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    /**
+     * Number of tasks enqueued which have not yet been claimed by a thread
+     */
+    std::atomic<size_t> pending;
+    /**
+     * Set by the destructor to tell workers to exit
+     */
+    bool stop;
+};
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
+
+#endif  // INCLUDE_FLAMEGPU_UTIL_DETAIL_WORKSTEALINGTHREADPOOL_H_
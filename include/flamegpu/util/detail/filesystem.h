@@ -9,6 +9,7 @@
 using std::tr2::sys::exists;
 using std::tr2::sys::path;
 using std::tr2::sys::create_directory;
+using std::tr2::sys::resize_file;
 #else
 // VS2019 requires this macro, as building pre c++17 cant use std::filesystem
 #define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
@@ -16,6 +17,7 @@ using std::tr2::sys::create_directory;
 using std::experimental::filesystem::v1::exists;
 using std::experimental::filesystem::v1::path;
 using std::experimental::filesystem::v1::create_directory;
+using std::experimental::filesystem::v1::resize_file;
 #endif
 
 namespace flamegpu {
@@ -0,0 +1,98 @@
+#include "flamegpu/cpu/CPUAgent.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "flamegpu/model/AgentData.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+
+CPUAgent::CPUAgent(const AgentData &description)
+    : agent_description(description)
+    , next_id(ID_NOT_SET + 1) {
+    for (const auto &s : agent_description.states) {
+        state_map.emplace(s, std::unique_ptr<AgentVector>(new AgentVector(agent_description)));
+    }
+}
+
+void *CPUAgent::getStateVariablePtr(const std::string &state_name, const std::string &variable_name) {
+    AgentVector &pop = getPopulation(state_name);
+    if (!pop.size())
+        return nullptr;
+    return pop.data(variable_name);
+}
+ModelData::size_type CPUAgent::getStateSize(const std::string &state_name) const {
+    return getPopulation(state_name).size();
+}
+id_t CPUAgent::nextID(unsigned int count) {
+    const id_t rtn = next_id;
+    next_id += count;
+    return rtn;
+}
+void CPUAgent::setPopulationVec(const std::string &, const std::shared_ptr<DeviceAgentVector_impl> &) {
+    THROW exception::InvalidOperation("DeviceAgentVector is not supported by CPUReferenceSimulation, in CPUAgent::setPopulationVec()\n");
+}
+std::shared_ptr<DeviceAgentVector_impl> CPUAgent::getPopulationVec(const std::string &) {
+    return nullptr;
+}
+AgentVector &CPUAgent::getPopulation(const std::string &state_name) {
+    const auto it = state_map.find(state_name);
+    if (it == state_map.end()) {
+        THROW exception::InvalidAgentState("Agent ('%s') state ('%s') was not found, "
+            "in CPUAgent::getPopulation()\n",
+            agent_description.name.c_str(), state_name.c_str());
+    }
+    return *it->second;
+}
+const AgentVector &CPUAgent::getPopulation(const std::string &state_name) const {
+    const auto it = state_map.find(state_name);
+    if (it == state_map.end()) {
+        THROW exception::InvalidAgentState("Agent ('%s') state ('%s') was not found, "
+            "in CPUAgent::getPopulation()\n",
+            agent_description.name.c_str(), state_name.c_str());
+    }
+    return *it->second;
+}
+void CPUAgent::assignIDs() {
+    // Find the max ID within the current agents, and check for collisions
+    std::vector<id_t> ids;
+    for (const auto &s : state_map) {
+        if (!s.second->size())
+            continue;
+        const id_t *d = s.second->data<id_t>(ID_VARIABLE_NAME);
+        for (AgentVector::size_type i = 0; i < s.second->size(); ++i) {
+            if (d[i] != ID_NOT_SET)
+                ids.push_back(d[i]);
+        }
+    }
+    if (!ids.empty()) {
+        std::sort(ids.begin(), ids.end());
+        next_id = std::max(next_id, static_cast<id_t>(ids.back() + 1));
+        const auto collisions = static_cast<unsigned int>(ids.size() - (std::unique(ids.begin(), ids.end()) - ids.begin()));
+        if (collisions) {
+            THROW exception::AgentIDCollision("%u agents of type '%s' share an ID with another agent of the same type, "
+                "you may need to explicitly reset agent IDs for 1 or more populations before adding them to the CPUReferenceSimulation, "
+                "in CPUAgent::assignIDs()\n",
+                collisions, agent_description.name.c_str());
+        }
+    }
+    // Assign IDs to any agents which do not yet have one
+    for (auto &s : state_map) {
+        if (!s.second->size())
+            continue;
+        id_t *d = s.second->data<id_t>(ID_VARIABLE_NAME);
+        for (AgentVector::size_type i = 0; i < s.second->size(); ++i) {
+            if (d[i] == ID_NOT_SET)
+                d[i] = next_id++;
+        }
+    }
+}
+void CPUAgent::clear() {
+    for (auto &s : state_map) {
+        s.second->clear();
+    }
+    next_id = ID_NOT_SET + 1;
+}
+
+}  // namespace flamegpu
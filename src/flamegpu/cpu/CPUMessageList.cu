@@ -0,0 +1,208 @@
+#include "flamegpu/cpu/CPUMessageList.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/runtime/messaging/MessageBruteForce/MessageBruteForceHost.h"
+#include "flamegpu/runtime/messaging/MessageSpatial3D/MessageSpatial3DHost.h"
+
+namespace flamegpu {
+namespace detail {
+
+CPUMessageList::CPUMessageList(const MessageBruteForce::Data &description)
+    : name(description.name)
+    , variables(description.variables)
+    , message_count(0)
+    , output_base(0)
+    , output_count(0)
+    , output_optional(false)
+    , truncate_flag(true)
+    , index_dirty(false)
+    , spatial3D(false)
+    , min{0, 0, 0}
+    , environmentWidth{0, 0, 0}
+    , radius(0)
+    , gridDim{0, 0, 0} {
+    if (description.getType() == std::type_index(typeid(MessageSpatial3D))) {
+        const MessageSpatial3D::Data &d = static_cast<const MessageSpatial3D::Data &>(description);
+        spatial3D = true;
+        radius = d.radius;
+        const float _min[3] = {d.minX, d.minY, d.minZ};
+        const float _max[3] = {d.maxX, d.maxY, d.maxZ};
+        unsigned int binCount = 1;
+        for (unsigned int axis = 0; axis < 3; ++axis) {
+            min[axis] = _min[axis];
+            environmentWidth[axis] = _max[axis] - _min[axis];
+            gridDim[axis] = static_cast<unsigned int>(ceil(environmentWidth[axis] / radius));
+            binCount *= gridDim[axis];
+        }
+        pbm.resize(binCount + 1, 0);
+    } else if (description.getType() != std::type_index(typeid(MessageBruteForce))) {
+        THROW exception::InvalidMessageType("Message '%s' is of a type which is not supported by CPUReferenceSimulation, "
+            "only MessageBruteForce and MessageSpatial3D are currently supported, "
+            "in CPUMessageList::CPUMessageList()\n", name.c_str());
+    }
+    for (const auto &v : variables) {
+        data.emplace(v.first, std::unique_ptr<GenericMemoryVector>(v.second.memory_vector->clone()));
+    }
+    updateBuffers();
+}
+
+void CPUMessageList::beginOutput(unsigned int max_count, bool optional) {
+    if (truncate_flag) {
+        message_count = 0;
+        truncate_flag = false;
+    }
+    output_base = message_count;
+    output_count = max_count;
+    output_optional = optional;
+    for (auto &v : data) {
+        v.second->resize(output_base + output_count);
+    }
+    // Non-optional output always produces a message per agent
+    output_flags.assign(output_count, optional ? 0 : 1);
+    updateBuffers();
+}
+void CPUMessageList::endOutput() {
+    unsigned int out = output_count;
+    if (output_optional) {
+        // Stable compaction of the output slots, to match the scan/scatter performed on the device
+        out = 0;
+        for (unsigned int i = 0; i < output_count; ++i) {
+            if (!output_flags[i])
+                continue;
+            if (out != i) {
+                for (auto &v : data) {
+                    const size_t var_size = v.second->getVariableSize();
+                    char *d = static_cast<char *>(v.second->getDataPtr());
+                    memcpy(d + (output_base + out) * var_size, d + (output_base + i) * var_size, var_size);
+                }
+            }
+            ++out;
+        }
+    }
+    message_count = output_base + out;
+    output_count = 0;
+    output_flags.clear();
+    index_dirty = true;
+    updateBuffers();
+}
+void CPUMessageList::clear() {
+    message_count = 0;
+    output_base = 0;
+    output_count = 0;
+    truncate_flag = true;
+    index_dirty = true;
+}
+
+void CPUMessageList::buildIndex() {
+    if (!spatial3D || !index_dirty)
+        return;
+    index_dirty = false;
+    const float *x = reinterpret_cast<const float *>(read_buffers.at("x").ptr);
+    const float *y = reinterpret_cast<const float *>(read_buffers.at("y").ptr);
+    const float *z = reinterpret_cast<const float *>(read_buffers.at("z").ptr);
+    // Build histogram
+    std::vector<unsigned int> bin_index(message_count);
+    std::fill(pbm.begin(), pbm.end(), 0);
+    for (unsigned int i = 0; i < message_count; ++i) {
+        bin_index[i] = getHash(getGridPosition(x[i], y[i], z[i]));
+        ++pbm[bin_index[i]];
+    }
+    // Exclusive scan, to finalise PBM
+    unsigned int running = 0;
+    for (auto &p : pbm) {
+        const unsigned int t = p;
+        p = running;
+        running += t;
+    }
+    // Reorder messages into bin order
+    std::vector<unsigned int> bin_offset(pbm.begin(), pbm.end() - 1);
+    std::vector<unsigned int> destination(message_count);
+    for (unsigned int i = 0; i < message_count; ++i) {
+        destination[i] = bin_offset[bin_index[i]]++;
+    }
+    for (auto &v : data) {
+        const size_t var_size = v.second->getVariableSize();
+        std::unique_ptr<GenericMemoryVector> sorted(v.second->clone());
+        sorted->resize(message_count);
+        const char *src = static_cast<const char *>(v.second->getReadOnlyDataPtr());
+        char *dest = static_cast<char *>(sorted->getDataPtr());
+        for (unsigned int i = 0; i < message_count; ++i) {
+            memcpy(dest + destination[i] * var_size, src + i * var_size, var_size);
+        }
+        v.second = std::move(sorted);
+    }
+    updateBuffers();
+}
+
+CPUMessageList::GridPos3D CPUMessageList::getGridPosition(float x, float y, float z) const {
+    // Clamp each grid coord to 0<=x<dim
+    const int gridPos[3] = {
+        static_cast<int>(floorf(((x - min[0]) / environmentWidth[0]) * gridDim[0])),
+        static_cast<int>(floorf(((y - min[1]) / environmentWidth[1]) * gridDim[1])),
+        static_cast<int>(floorf(((z - min[2]) / environmentWidth[2]) * gridDim[2]))
+    };
+    GridPos3D rtn = {
+        gridPos[0] < 0 ? 0 : (gridPos[0] >= static_cast<int>(gridDim[0]) ? static_cast<int>(gridDim[0]) - 1 : gridPos[0]),
+        gridPos[1] < 0 ? 0 : (gridPos[1] >= static_cast<int>(gridDim[1]) ? static_cast<int>(gridDim[1]) - 1 : gridPos[1]),
+        gridPos[2] < 0 ? 0 : (gridPos[2] >= static_cast<int>(gridDim[2]) ? static_cast<int>(gridDim[2]) - 1 : gridPos[2])
+    };
+    return rtn;
+}
+unsigned int CPUMessageList::getHash(const GridPos3D &pos) const {
+    // Only x should ever be out of bounds here
+    const unsigned int x = static_cast<unsigned int>(pos.x < 0 ? 0 : (pos.x >= static_cast<int>(gridDim[0]) - 1 ? static_cast<int>(gridDim[0]) - 1 : pos.x));
+    return static_cast<unsigned int>(pos.z) * gridDim[0] * gridDim[1] + static_cast<unsigned int>(pos.y) * gridDim[0] + x;
+}
+
+void CPUMessageList::checkpoint(io::Checkpoint::SectionWriter &out) const {
+    out.write<uint32_t>(message_count);
+    out.write<uint8_t>(truncate_flag ? 1 : 0);
+    for (const auto &v : data) {
+        const size_t buffer_size = v.second->getVariableSize() * message_count;
+        out.writeString(v.first);
+        out.write<uint64_t>(buffer_size);
+        if (buffer_size) {
+            out.write(v.second->getReadOnlyDataPtr(), buffer_size);
+        }
+    }
+    out.writeString("");
+}
+void CPUMessageList::restore(io::Checkpoint::SectionReader &in) {
+    message_count = in.read<uint32_t>();
+    truncate_flag = in.read<uint8_t>() != 0;
+    output_base = 0;
+    output_count = 0;
+    for (std::string var_name = in.readString(); !var_name.empty(); var_name = in.readString()) {
+        const auto v = data.find(var_name);
+        const uint64_t buffer_size = in.read<uint64_t>();
+        if (v == data.end() || buffer_size != static_cast<uint64_t>(v->second->getVariableSize()) * message_count) {
+            THROW exception::InvalidInputFile("Checkpoint message variable '%s.%s' does not match the model's messages, "
+                "in CPUMessageList::restore()\n", name.c_str(), var_name.c_str());
+        }
+        v->second->resize(message_count);
+        if (buffer_size) {
+            in.read(v->second->getDataPtr(), static_cast<size_t>(buffer_size));
+        }
+    }
+    // Sorting messages which are already in bin order reproduces the PBM
+    index_dirty = true;
+    updateBuffers();
+}
+void CPUMessageList::updateBuffers() {
+    read_buffers.clear();
+    output_buffers.clear();
+    for (auto &v : data) {
+        const Variable &var = variables.at(v.first);
+        char *ptr = static_cast<char *>(v.second->getDataPtr());
+        read_buffers.emplace(v.first, CPUVariableBuffer{ptr, var.type, var.elements, var.type_size});
+        output_buffers.emplace(v.first, CPUVariableBuffer{ptr ? ptr + output_base * var.type_size * var.elements : nullptr, var.type, var.elements, var.type_size});
+    }
+}
+
+}  // namespace detail
+}  // namespace flamegpu
@@ -0,0 +1,804 @@
+#include "flamegpu/cpu/CPUReferenceSimulation.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <locale>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/model/ModelDescription.h"
+#include "flamegpu/model/AgentData.h"
+#include "flamegpu/model/AgentFunctionData.cuh"
+#include "flamegpu/model/LayerData.h"
+#include "flamegpu/model/EnvironmentDescription.h"
+#include "flamegpu/runtime/messaging/MessageBruteForce/MessageBruteForceHost.h"
+#include "flamegpu/runtime/HostAPI.h"
+#include "flamegpu/runtime/HostFunctionCallback.h"
+#include "flamegpu/runtime/utility/RandomManager.cuh"
+#include "flamegpu/sim/LoggingConfig.h"
+#include "flamegpu/sim/LogFrame.h"
+#include "flamegpu/io/Checkpoint.h"
+#include "flamegpu/util/nvtx.h"
+#include "flamegpu/util/detail/SteadyClockTimer.h"
+#include "flamegpu/util/detail/WorkStealingThreadPool.h"
+#include "flamegpu/version.h"
+
+namespace flamegpu {
+
+namespace {
+/**
+ * splitmix64 finaliser, used to derive independent random seeds for each agent function and step
+ */
+uint64_t mix64(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+}  // namespace
+
+CPUReferenceSimulation::CPUReferenceSimulation(const ModelDescription& _model, int argc, const char** argv)
+    : Simulation(_model.model)
+    , rng(std::make_unique<RandomManager>())
+    , step_count(0)
+    , agent_ids_have_init(false)
+    , elapsedSecondsSimulation(0.)
+    , elapsedSecondsInitFunctions(0.)
+    , elapsedSecondsExitFunctions(0.)
+    , run_log(std::make_unique<RunLog>()) {
+    validateModel();
+    rng->reseed(getSimulationConfig().random_seed);
+    for (const auto &a : model->agents) {
+        agent_map.emplace(a.first, std::unique_ptr<CPUAgent>(new CPUAgent(*a.second)));
+    }
+    for (const auto &m : model->messages) {
+        message_map.emplace(m.first, std::unique_ptr<detail::CPUMessageList>(new detail::CPUMessageList(*m.second)));
+    }
+    initEnvironment();
+    if (argc && argv) {
+        initialise(argc, argv);
+    }
+}
+CPUReferenceSimulation::~CPUReferenceSimulation() = default;
+
+void CPUReferenceSimulation::validateModel() const {
+    if (!model->submodels.empty()) {
+        THROW exception::InvalidOperation("Model '%s' contains submodels, which are not supported by CPUReferenceSimulation, "
+            "in CPUReferenceSimulation::validateModel()\n", model->name.c_str());
+    }
+    for (const auto &a : model->agents) {
+        for (const auto &f : a.second->functions) {
+            if (f.second->agent_output.lock()) {
+                THROW exception::InvalidOperation("Agent function '%s' of agent '%s' has agent output, which is not supported by CPUReferenceSimulation, "
+                    "in CPUReferenceSimulation::validateModel()\n", f.first.c_str(), a.first.c_str());
+            }
+        }
+    }
+}
+
+void CPUReferenceSimulation::setAgentFunction(const std::string &agent_name, const std::string &function_name, AgentFunction function) {
+    const auto a = model->agents.find(agent_name);
+    if (a == model->agents.end() || a->second->functions.find(function_name) == a->second->functions.end()) {
+        THROW exception::InvalidAgentFunc("Agent function '%s' of agent '%s' was not found, "
+            "in CPUReferenceSimulation::setAgentFunction()\n", function_name.c_str(), agent_name.c_str());
+    }
+    agent_functions[{agent_name, function_name}] = std::move(function);
+}
+void CPUReferenceSimulation::setAgentFunctionCondition(const std::string &agent_name, const std::string &function_name, AgentFunctionCondition condition) {
+    const auto a = model->agents.find(agent_name);
+    if (a == model->agents.end()) {
+        THROW exception::InvalidAgentFunc("Agent function '%s' of agent '%s' was not found, "
+            "in CPUReferenceSimulation::setAgentFunctionCondition()\n", function_name.c_str(), agent_name.c_str());
+    }
+    const auto f = a->second->functions.find(function_name);
+    if (f == a->second->functions.end()) {
+        THROW exception::InvalidAgentFunc("Agent function '%s' of agent '%s' was not found, "
+            "in CPUReferenceSimulation::setAgentFunctionCondition()\n", function_name.c_str(), agent_name.c_str());
+    }
+    if (!f->second->condition && f->second->rtc_func_condition_name.empty()) {
+        THROW exception::InvalidAgentFunc("Agent function '%s' of agent '%s' does not have a function condition, "
+            "in CPUReferenceSimulation::setAgentFunctionCondition()\n", function_name.c_str(), agent_name.c_str());
+    }
+    agent_function_conditions[{agent_name, function_name}] = std::move(condition);
+}
+
+void CPUReferenceSimulation::initFunctions() {
+    NVTX_RANGE("CPUReferenceSimulation::initFunctions");
+    util::detail::SteadyClockTimer initFunctionsTimer;
+    initFunctionsTimer.start();
+
+    // Execute normal init functions
+    for (auto &initFn : model->initFunctions) {
+        initFn(getHostAPI());
+    }
+    // Execute init function callbacks (python)
+    for (auto &initFn : model->initFunctionCallbacks) {
+        initFn->run(getHostAPI());
+    }
+
+    // Record, store and output the elapsed time of the init functions.
+    initFunctionsTimer.stop();
+    elapsedSecondsInitFunctions = initFunctionsTimer.getElapsedSeconds();
+    if (getSimulationConfig().timing) {
+        fprintf(stdout, "Init Function Processing time: %.6f s\n", elapsedSecondsInitFunctions);
+    }
+}
+void CPUReferenceSimulation::exitFunctions() {
+    NVTX_RANGE("CPUReferenceSimulation::exitFunctions");
+    util::detail::SteadyClockTimer exitFunctionsTimer;
+    exitFunctionsTimer.start();
+
+    // Execute exit functions
+    for (auto &exitFn : model->exitFunctions) {
+        exitFn(getHostAPI());
+    }
+    // Execute exit function callbacks (python)
+    for (auto &exitFn : model->exitFunctionCallbacks) {
+        exitFn->run(getHostAPI());
+    }
+
+    // Record, store and output the elapsed time of the exit functions.
+    exitFunctionsTimer.stop();
+    elapsedSecondsExitFunctions = exitFunctionsTimer.getElapsedSeconds();
+    if (getSimulationConfig().timing) {
+        fprintf(stdout, "Exit Function Processing time: %.6f s\n", elapsedSecondsExitFunctions);
+    }
+}
+
+bool CPUReferenceSimulation::step() {
+    NVTX_RANGE(std::string("CPUReferenceSimulation::step " + std::to_string(step_count)).c_str());
+    util::detail::SteadyClockTimer stepTimer;
+    stepTimer.start();
+
+    initThreadPool();
+    assignAgentIDs();
+
+    // Execute each layer
+    unsigned int layer_index = 0;
+    for (const auto &layer : model->layers) {
+        stepLayer(*layer, layer_index++);
+    }
+    // Messages output this step are truncated by the first output of the next step
+    for (auto &m : message_map) {
+        m.second->truncate();
+    }
+
+    // Run the step functions and exit conditions
+    stepStepFunctions();
+    const bool exitRequired = stepExitConditions();
+
+    ++step_count;
+    stepTimer.stop();
+    const double stepMilliseconds = stepTimer.getElapsedMilliseconds();
+    elapsedSecondsPerStep.push_back(stepMilliseconds / 1000.0);
+    if (getSimulationConfig().timing) {
+        fprintf(stdout, "Step %d Processing time: %.6f s\n", step_count - 1, stepMilliseconds / 1000.0);
+    }
+    processStepLog(stepMilliseconds / 1000.0);
+    return !exitRequired;
+}
+
+void CPUReferenceSimulation::stepLayer(const LayerData &layer, unsigned int layer_index) {
+    NVTX_RANGE(std::string("stepLayer " + std::to_string(layer_index)).c_str());
+    // Agent functions within a layer are independent, so are executed in turn with each parallelised across it's population
+    // std::set<shared_ptr> has no stable order, so order by name to keep random seeds reproducible
+    std::vector<std::shared_ptr<AgentFunctionData>> funcs(layer.agent_functions.begin(), layer.agent_functions.end());
+    std::sort(funcs.begin(), funcs.end(), [](const std::shared_ptr<AgentFunctionData> &a, const std::shared_ptr<AgentFunctionData> &b) {
+        const std::string a_parent = a->parent.lock()->name;
+        const std::string b_parent = b->parent.lock()->name;
+        return a_parent == b_parent ? a->name < b->name : a_parent < b_parent;
+    });
+    for (const auto &func : funcs) {
+        const uint64_t seed = mix64(mix64(mix64(getSimulationConfig().random_seed) ^ step_count) ^ std::hash<std::string>()(func->parent.lock()->name + "::" + func->name));
+        executeAgentFunction(*func, seed);
+    }
+    layerHostFunctions(layer);
+}
+
+void CPUReferenceSimulation::layerHostFunctions(const LayerData &layer) {
+    NVTX_RANGE("CPUReferenceSimulation::stepHostFunctions");
+    // Execute all host functions attached to layer
+    for (auto &stepFn : layer.host_functions) {
+        NVTX_RANGE("hostFunc");
+        stepFn(getHostAPI());
+    }
+    // Execute all host function callbacks attached to layer
+    for (auto &stepFn : layer.host_functions_callbacks) {
+        NVTX_RANGE("hostFunc_swig");
+        stepFn->run(getHostAPI());
+    }
+}
+
+void CPUReferenceSimulation::stepStepFunctions() {
+    NVTX_RANGE("CPUReferenceSimulation::step::StepFunctions");
+    // Execute step functions
+    for (auto &stepFn : model->stepFunctions) {
+        NVTX_RANGE("stepFunc");
+        stepFn(getHostAPI());
+    }
+    // Execute step function callbacks
+    for (auto &stepFn : model->stepFunctionCallbacks) {
+        NVTX_RANGE("stepFunc_swig");
+        stepFn->run(getHostAPI());
+    }
+}
+
+bool CPUReferenceSimulation::stepExitConditions() {
+    NVTX_RANGE("CPUReferenceSimulation::stepExitConditions");
+    // Execute exit conditions, bailing out at the first which requests exit
+    for (auto &exitCdns : model->exitConditions) {
+        if (exitCdns(getHostAPI()) == EXIT) {
+            return true;
+        }
+    }
+    // Execute exit condition callbacks
+    for (auto &exitCdns : model->exitConditionCallbacks) {
+        if (exitCdns->run(getHostAPI()) == EXIT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HostAPI *CPUReferenceSimulation::getHostAPI() {
+    if (!host_api) {
+        host_api = std::make_unique<HostAPI>(*this, *rng, environment, read_only_properties);
+    }
+    return host_api.get();
+}
+
+void CPUReferenceSimulation::executeAgentFunction(const AgentFunctionData &func, uint64_t seed) {
+    const auto func_agent = func.parent.lock();
+    NVTX_RANGE(std::string(func_agent->name + "::" + func.name).c_str());
+    const auto fn_it = agent_functions.find({func_agent->name, func.name});
+    if (fn_it == agent_functions.end()) {
+        THROW exception::InvalidAgentFunc("Agent function '%s' of agent '%s' does not have a host implementation, "
+            "CPUReferenceSimulation::setAgentFunction() must be called before the simulation is executed, "
+            "in CPUReferenceSimulation::executeAgentFunction()\n", func.name.c_str(), func_agent->name.c_str());
+    }
+    CPUAgent &agent = *agent_map.at(func_agent->name);
+    AgentVector &population = agent.getPopulation(func.initial_state);
+    // Functions with no agents in their initial state are skipped, as with CUDASimulation
+    if (population.size() == 0)
+        return;
+    const size_t grain = cpu_config.grain_size;
+
+    // Evaluate the agent function condition, splitting the population into those which pass and fail
+    std::unique_ptr<AgentVector> condition_pass, condition_fail;
+    if (func.condition || !func.rtc_func_condition_name.empty()) {
+        NVTX_RANGE(std::string("condition " + func_agent->name + "::" + func.name).c_str());
+        const auto cond_it = agent_function_conditions.find({func_agent->name, func.name});
+        if (cond_it == agent_function_conditions.end()) {
+            THROW exception::InvalidAgentFunc("Agent function condition of '%s' of agent '%s' does not have a host implementation, "
+                "CPUReferenceSimulation::setAgentFunctionCondition() must be called before the simulation is executed, "
+                "in CPUReferenceSimulation::executeAgentFunction()\n", func.name.c_str(), func_agent->name.c_str());
+        }
+        const AgentFunctionCondition &condition = cond_it->second;
+        const detail::CPUVariableBufferMap buffers = getBuffers(population);
+        std::vector<char> flags(population.size());
+        thread_pool->parallelFor(0, population.size(), grain, [&](size_t begin, size_t end) {
+            CPUAgentAPI api(buffers, environment, ~seed, step_count, nullptr, nullptr);
+            for (size_t i = begin; i < end; ++i) {
+                api.setIndex(static_cast<unsigned int>(i));
+                flags[i] = condition(&api) ? 1 : 0;
+            }
+        });
+        condition_pass.reset(new AgentVector(*func_agent));
+        condition_fail.reset(new AgentVector(*func_agent));
+        scatter(population, flags, 1, *condition_pass);
+        scatter(population, flags, 0, *condition_fail);
+    }
+    AgentVector &exec_population = condition_pass ? *condition_pass : population;
+    const unsigned int exec_count = exec_population.size();
+
+    // Prepare messages
+    detail::CPUMessageList *message_in = nullptr;
+    detail::CPUMessageList *message_out = nullptr;
+    if (const auto m = func.message_input.lock()) {
+        message_in = message_map.at(m->name).get();
+        message_in->buildIndex();
+    }
+    if (const auto m = func.message_output.lock()) {
+        message_out = message_map.at(m->name).get();
+        message_out->beginOutput(exec_count, func.message_output_optional);
+    }
+
+    // Execute the agent function
+    std::vector<char> alive(exec_count, 1);
+    if (exec_count) {
+        const AgentFunction &function = fn_it->second;
+        const detail::CPUVariableBufferMap buffers = getBuffers(exec_population);
+        thread_pool->parallelFor(0, exec_count, grain, [&](size_t begin, size_t end) {
+            CPUAgentAPI api(buffers, environment, seed, step_count, message_in, message_out);
+            for (size_t i = begin; i < end; ++i) {
+                api.setIndex(static_cast<unsigned int>(i));
+                alive[i] = function(&api) == ALIVE ? 1 : 0;
+            }
+        });
+    }
+    if (message_out) {
+        message_out->endOutput();
+    }
+
+    // Process agent death
+    std::unique_ptr<AgentVector> survivors;
+    if (func.has_agent_death) {
+        if (std::find(alive.begin(), alive.end(), 0) != alive.end()) {
+            survivors.reset(new AgentVector(*func_agent));
+            scatter(exec_population, alive, 1, *survivors);
+        }
+#if !defined(SEATBELTS) || SEATBELTS
+    } else if (std::find(alive.begin(), alive.end(), 0) != alive.end()) {
+        THROW exception::InvalidAgentFunc("Agent function '%s' of agent '%s' returned DEAD, but agent death is not enabled for the function, "
+            "in CPUReferenceSimulation::executeAgentFunction()\n", func.name.c_str(), func_agent->name.c_str());
+#endif
+    }
+    AgentVector &result = survivors ? *survivors : exec_population;
+
+    // Transition agents to the end state, and restore those which failed the condition
+    AgentVector &end_population = agent.getPopulation(func.end_state);
+    if (condition_pass) {
+        // The initial state now only holds the agents which failed the condition
+        population = std::move(*condition_fail);
+        std::vector<char> all(result.size(), 1);
+        scatter(result, all, 1, end_population);
+    } else if (&result != &population) {
+        // Agent death occurred
+        if (func.initial_state == func.end_state) {
+            population = std::move(result);
+        } else {
+            population.clear();
+            std::vector<char> all(result.size(), 1);
+            scatter(result, all, 1, end_population);
+        }
+    } else if (func.initial_state != func.end_state) {
+        std::vector<char> all(population.size(), 1);
+        scatter(population, all, 1, end_population);
+        population.clear();
+    }
+}
+
+detail::CPUVariableBufferMap CPUReferenceSimulation::getBuffers(AgentVector &population) {
+    detail::CPUVariableBufferMap rtn;
+    for (const auto &v : population.agent->variables) {
+        const auto it = population._data->find(v.first);
+        char *ptr = it != population._data->end() ? static_cast<char *>(it->second->getDataPtr()) : nullptr;
+        rtn.emplace(v.first, detail::CPUVariableBuffer{ptr, v.second.type, v.second.elements, v.second.type_size});
+    }
+    return rtn;
+}
+void CPUReferenceSimulation::scatter(const AgentVector &src, const std::vector<char> &flags, char flag_value, AgentVector &dest) {
+    const AgentVector::size_type count = static_cast<AgentVector::size_type>(std::count(flags.begin(), flags.end(), flag_value));
+    if (!count)
+        return;
+    const AgentVector::size_type base = dest._size;
+    dest.reserve(base + count);
+    for (const auto &v : src.agent->variables) {
+        const size_t variable_size = v.second.type_size * v.second.elements;
+        const char *src_data = static_cast<const char *>(src._data->at(v.first)->getReadOnlyDataPtr());
+        char *dest_data = static_cast<char *>(dest._data->at(v.first)->getDataPtr());
+        AgentVector::size_type j = base;
+        for (size_t i = 0; i < flags.size(); ++i) {
+            if (flags[i] == flag_value) {
+                memcpy(dest_data + j * variable_size, src_data + i * variable_size, variable_size);
+                ++j;
+            }
+        }
+    }
+    dest._size = base + count;
+}
+
+void CPUReferenceSimulation::simulate() {
+    NVTX_RANGE("CPUReferenceSimulation::simulate");
+    util::detail::SteadyClockTimer simulationTimer;
+    simulationTimer.start();
+
+    initThreadPool();
+    assignAgentIDs();
+
+    // Reset the class' elapsed time value.
+    elapsedSecondsSimulation = 0.;
+    elapsedSecondsPerStep.clear();
+    if (getSimulationConfig().steps > 0) {
+        elapsedSecondsPerStep.reserve(getSimulationConfig().steps);
+    }
+
+    // A run resumed from a checkpoint has already executed init functions, and retains the restored step log
+    const bool resume = resume_from_checkpoint;
+    resume_from_checkpoint = false;
+    if (!resume) {
+        // Execute init functions
+        initFunctions();
+    }
+
+    // Reset and log initial state to step log 0
+    std::list<StepLogFrame> restored_step_log;
+    if (resume)
+        std::swap(restored_step_log, run_log->step);
+    resetLog();
+    openStepLogStream(step_log_config && step_log_config->log_timing);
+    if (resume)
+        std::swap(restored_step_log, run_log->step);
+    else
+        processStepLog(elapsedSecondsInitFunctions);
+
+    // Run the required number of simulation steps.
+    for (unsigned int i = resume ? step_count : 0; getSimulationConfig().steps == 0 ? true : i < getSimulationConfig().steps; i++) {
+        const bool continueSimulation = step();
+        processCheckpoint(step_count);
+        if (!continueSimulation) {
+            break;
+        }
+    }
+
+    // Exit functions
+    exitFunctions();
+
+    // Record, store and output the elapsed simulation time
+    simulationTimer.stop();
+    elapsedSecondsSimulation = simulationTimer.getElapsedSeconds();
+    if (getSimulationConfig().timing) {
+        fprintf(stdout, "Total Processing time: %.6f s\n", elapsedSecondsSimulation);
+    }
+    processExitLog();
+    waitForCheckpoint();
+
+    // Export logs
+    if (!closeStepLogStream() && !SimulationConfig().step_log_file.empty())
+        exportLog(SimulationConfig().step_log_file, true, false, step_log_config && step_log_config->log_timing, false);
+    if (!SimulationConfig().exit_log_file.empty())
+        exportLog(SimulationConfig().exit_log_file, false, true, false, exit_log_config && exit_log_config->log_timing);
+    if (!SimulationConfig().common_log_file.empty())
+        exportLog(SimulationConfig().common_log_file, true, true, step_log_config && step_log_config->log_timing, exit_log_config && exit_log_config->log_timing);
+}
+
+void CPUReferenceSimulation::setPopulationData(AgentVector& population, const std::string& state_name) {
+    NVTX_RANGE("CPUReferenceSimulation::setPopulationData()");
+    auto it = agent_map.find(population.getAgentName());
+    if (it == agent_map.end()) {
+        THROW exception::InvalidAgent("Agent '%s' was not found, "
+            "in CPUReferenceSimulation::setPopulationData()\n",
+            population.getAgentName().c_str());
+    }
+    if (!population.matchesAgentType(it->second->getAgentDescription())) {
+        THROW exception::InvalidAgent("Population's agent description does not match agent '%s' within the model, "
+            "in CPUReferenceSimulation::setPopulationData()\n",
+            population.getAgentName().c_str());
+    }
+    it->second->getPopulation(state_name) = population;
+    agent_ids_have_init = false;
+}
+void CPUReferenceSimulation::getPopulationData(AgentVector& population, const std::string& state_name) {
+    NVTX_RANGE("CPUReferenceSimulation::getPopulationData()");
+    auto it = agent_map.find(population.getAgentName());
+    if (it == agent_map.end()) {
+        THROW exception::InvalidAgent("Agent '%s' was not found, "
+            "in CPUReferenceSimulation::getPopulationData()\n",
+            population.getAgentName().c_str());
+    }
+    if (!population.matchesAgentType(it->second->getAgentDescription())) {
+        THROW exception::InvalidAgent("Population's agent description does not match agent '%s' within the model, "
+            "in CPUReferenceSimulation::getPopulationData()\n",
+            population.getAgentName().c_str());
+    }
+    population = it->second->getPopulation(state_name);
+}
+AgentInterface &CPUReferenceSimulation::getAgent(const std::string &name) {
+    auto it = agent_map.find(name);
+    if (it == agent_map.end()) {
+        THROW exception::InvalidAgent("Agent '%s' was not found, in CPUReferenceSimulation::getAgent()\n", name.c_str());
+    }
+    return *it->second;
+}
+std::map<std::string, util::Any> CPUReferenceSimulation::getEnvironmentProperties() const {
+    return std::map<std::string, util::Any>(environment.begin(), environment.end());
+}
+void CPUReferenceSimulation::assignAgentIDs() {
+    if (agent_ids_have_init)
+        return;
+    for (auto &a : agent_map) {
+        a.second->assignIDs();
+    }
+    agent_ids_have_init = true;
+}
+
+void CPUReferenceSimulation::initEnvironment() {
+    environment.clear();
+    read_only_properties.clear();
+    for (const auto &prop : model->environment->getPropertiesMap()) {
+        environment.emplace(prop.first, prop.second.data);
+        if (prop.second.isConst)
+            read_only_properties.insert(prop.first);
+    }
+}
+util::Any &CPUReferenceSimulation::getEnvironmentAny(const std::string &property_name, const std::type_index &type, unsigned int elements, const char *caller) const {
+    const auto it = environment.find(property_name);
+    if (it == environment.end()) {
+        THROW exception::InvalidEnvProperty("Environment property '%s' was not found, in %s\n", property_name.c_str(), caller);
+    }
+    if (it->second.type != type) {
+        THROW exception::InvalidEnvPropertyType("Environment property '%s' type mismatch '%s' != '%s', in %s\n",
+            property_name.c_str(), it->second.type.name(), type.name(), caller);
+    }
+    if (it->second.elements != elements) {
+        THROW exception::OutOfBoundsException("Length of environment property '%s' (%u) does not match the requested length (%u), in %s\n",
+            property_name.c_str(), it->second.elements, elements, caller);
+    }
+    return it->second;
+}
+
+void CPUReferenceSimulation::reset(bool) {
+    resetStepCounter();
+    initEnvironment();
+    rng->reseed(getSimulationConfig().random_seed);
+    for (auto &a : agent_map) {
+        a.second->clear();
+    }
+    for (auto &m : message_map) {
+        m.second->clear();
+    }
+    agent_ids_have_init = false;
+    elapsedSecondsPerStep.clear();
+}
+void CPUReferenceSimulation::applyConfig_derived() {
+    NVTX_RANGE("applyConfig_derived");
+    // Set any properties loaded from file during arg parse stage
+    for (const auto &prop : env_init) {
+        const auto it = environment.find(prop.first.first);
+        if (it == environment.end()) {
+            THROW exception::InvalidEnvProperty("Environment init data contains unexpected environment property '%s', "
+                "in CPUReferenceSimulation::applyConfig_derived()\n", prop.first.first.c_str());
+        }
+        const size_t type_size = it->second.length / it->second.elements;
+        if (prop.first.second >= it->second.elements || prop.second.type != it->second.type) {
+            THROW exception::InvalidEnvProperty("Environment init data for property '%s' does not match the model description, "
+                "in CPUReferenceSimulation::applyConfig_derived()\n", prop.first.first.c_str());
+        }
+        memcpy(static_cast<char *>(it->second.ptr) + prop.first.second * type_size, prop.second.ptr, type_size);
+    }
+    env_init.clear();
+    rng->reseed(getSimulationConfig().random_seed);
+    initThreadPool();
+}
+bool CPUReferenceSimulation::checkArgs_derived(int argc, const char** argv, int &i) {
+    // Get arg as lowercase
+    std::string arg(argv[i]);
+    std::transform(arg.begin(), arg.end(), arg.begin(), [](unsigned char c) { return std::use_facet< std::ctype<char>>(std::locale()).tolower(c); });
+    // --threads <uint>, Number of threads used to execute agent functions, defaults to all hardware threads
+    if (arg.compare("--threads") == 0 && argc > i + 1) {
+        cpu_config.thread_count = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 0));
+        return true;
+    }
+    return false;
+}
+void CPUReferenceSimulation::printHelp_derived() {
+    const char *line_fmt = "%-18s %s\n";
+    printf("CPU Model Optional Arguments:\n");
+    printf(line_fmt, "    --threads", "Number of CPU threads");
+}
+void CPUReferenceSimulation::resetDerivedConfig() {
+    cpu_config = CPUReferenceSimulation::Config();
+    resetStepCounter();
+}
+void CPUReferenceSimulation::checkpoint_derived(io::Checkpoint &checkpoint) {
+    checkpoint.newSection("step_count").write<uint32_t>(step_count);
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("environment");
+        for (const auto &prop : environment) {
+            out.writeString(prop.first);
+            out.writeAny(prop.second);
+        }
+    }
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("random");
+        rng->checkpoint(out);
+    }
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("agent_ids");
+        for (auto &a : agent_map) {
+            out.writeString(a.first);
+            out.write<id_t>(a.second->nextID(0));
+        }
+    }
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("messages");
+        for (const auto &m : message_map) {
+            out.writeString(m.first);
+            m.second->checkpoint(out);
+        }
+    }
+    checkpointStepLog(run_log->step, checkpoint);
+}
+void CPUReferenceSimulation::restore_derived(const io::Checkpoint &checkpoint) {
+    step_count = checkpoint.getSection("step_count").read<uint32_t>();
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("environment");
+        while (!in.eof()) {
+            const std::string name = in.readString();
+            util::Any value = in.readAny();
+            const auto it = environment.find(name);
+            if (it == environment.end() || it->second.type != value.type || it->second.length != value.length) {
+                THROW exception::InvalidInputFile("Checkpoint environment property '%s' does not match the model, "
+                    "in CPUReferenceSimulation::restore_derived()\n", name.c_str());
+            }
+            memcpy(it->second.ptr, value.ptr, value.length);
+        }
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("random");
+        rng->restore(in);
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("agent_ids");
+        while (!in.eof()) {
+            const std::string name = in.readString();
+            const id_t next_id = in.read<id_t>();
+            const auto a = agent_map.find(name);
+            if (a == agent_map.end()) {
+                THROW exception::InvalidInputFile("Checkpoint contains agent '%s' which does not match the model, "
+                    "in CPUReferenceSimulation::restore_derived()\n", name.c_str());
+            }
+            a->second->setNextID(next_id);
+        }
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("messages");
+        while (!in.eof()) {
+            const std::string name = in.readString();
+            const auto m = message_map.find(name);
+            if (m == message_map.end()) {
+                THROW exception::InvalidInputFile("Checkpoint contains message '%s' which does not match the model, "
+                    "in CPUReferenceSimulation::restore_derived()\n", name.c_str());
+            }
+            m->second->restore(in);
+        }
+    }
+    run_log->step = restoreStepLog(checkpoint);
+}
+void CPUReferenceSimulation::initThreadPool() {
+    const unsigned int thread_count = cpu_config.thread_count ? cpu_config.thread_count : std::max(std::thread::hardware_concurrency(), 1u);
+    if (!thread_pool || thread_pool->getThreadCount() != thread_count) {
+        thread_pool.reset(new util::detail::WorkStealingThreadPool(thread_count));
+    }
+}
+
+CPUReferenceSimulation::Config &CPUReferenceSimulation::CPUConfig() {
+    return cpu_config;
+}
+const CPUReferenceSimulation::Config &CPUReferenceSimulation::getCPUConfig() const {
+    return cpu_config;
+}
+unsigned int CPUReferenceSimulation::getStepCounter() {
+    return step_count;
+}
+void CPUReferenceSimulation::resetStepCounter() {
+    step_count = 0;
+}
+double CPUReferenceSimulation::getElapsedTimeStep(unsigned int step) const {
+    if (step >= elapsedSecondsPerStep.size()) {
+        THROW exception::OutOfBoundsException("getElapsedTimeStep out of bounds.\n");
+    }
+    return elapsedSecondsPerStep.at(step);
+}
+
+void CPUReferenceSimulation::setStepLog(const StepLoggingConfig &stepConfig) {
+    // Validate ModelDescription matches
+    if (*stepConfig.model != *model) {
+        THROW exception::InvalidArgument("Model descriptions attached to LoggingConfig and CPUReferenceSimulation do not match, in CPUReferenceSimulation::setStepLog()\n");
+    }
+    // Set internal config
+    step_log_config = std::make_shared<StepLoggingConfig>(stepConfig);
+}
+void CPUReferenceSimulation::setExitLog(const LoggingConfig &exitConfig) {
+    // Validate ModelDescription matches
+    if (*exitConfig.model != *model) {
+        THROW exception::InvalidArgument("Model descriptions attached to LoggingConfig and CPUReferenceSimulation do not match, in CPUReferenceSimulation::setExitLog()\n");
+    }
+    // Set internal config
+    exit_log_config = std::make_shared<LoggingConfig>(exitConfig);
+}
+const RunLog &CPUReferenceSimulation::getRunLog() const {
+    return *run_log;
+}
+void CPUReferenceSimulation::resetLog() {
+    run_log->step.clear();
+    run_log->exit = ExitLogFrame();
+    run_log->random_seed = SimulationConfig().random_seed;
+    run_log->step_log_frequency = step_log_config ? step_log_config->frequency : 0;
+    run_log->performance_specs.device_name = "CPU (" + std::to_string(thread_pool ? thread_pool->getThreadCount() : 1) + " threads)";
+    run_log->performance_specs.device_cc_major = 0;
+    run_log->performance_specs.device_cc_minor = 0;
+    run_log->performance_specs.cuda_version = 0;
+#if !defined(SEATBELTS) || SEATBELTS
+    run_log->performance_specs.seatbelts = true;
+#else
+    run_log->performance_specs.seatbelts = false;
+#endif
+    run_log->performance_specs.flamegpu_version = VERSION_FULL;
+}
+void CPUReferenceSimulation::processStepLog(double step_time_seconds) {
+    if (!step_log_config)
+        return;
+    if (step_count % step_log_config->frequency != 0)
+        return;
+    // Iterate members of step log to build the step log frame
+    std::map<std::string, util::Any> environment_log;
+    for (const auto &prop_name : step_log_config->environment) {
+        environment_log.emplace(prop_name, environment.at(prop_name));
+    }
+    std::map<util::StringPair, std::pair<std::map<LoggingConfig::NameReductionFn, util::Any>, unsigned int>> agents_log;
+    for (const auto &name_state : step_log_config->agents) {
+        const AgentVector &population = agent_map.at(name_state.first.first)->getPopulation(name_state.first.second);
+        auto &agent_state_log = agents_log.emplace(name_state.first, std::make_pair(std::map<LoggingConfig::NameReductionFn, util::Any>(), UINT_MAX)).first->second;
+        // Compute every fusable reduction (e.g. Mean, Min) of every variable in a single pass
+        const LoggingConfig::FusedReductions &fused = step_log_config->getFusedReductions(name_state.first);
+        if (!fused.plan.empty()) {
+            std::vector<const void*> buffers;
+            for (const auto &column : fused.plan.getColumns()) {
+                const auto it = population._data->find(column.variable_name);
+                buffers.push_back(it != population._data->end() ? it->second->getReadOnlyDataPtr() : nullptr);
+            }
+            fused.emplaceResults(fused.plan.reduceHost(buffers, population.size()), agent_state_log.first);
+        }
+        // Log the remaining variable reductions individually
+        for (const auto *name_reduction : fused.unfused) {
+            agent_state_log.first.emplace(*name_reduction, name_reduction->host_function(population, *name_reduction));
+        }
+        // Log count of agents in state
+        if (name_state.second.second) {
+            agent_state_log.second = population.size();
+        }
+    }
+    // Append to step log
+    StepLogFrame frame(std::move(environment_log), std::move(agents_log), step_count);
+    frame.step_time = step_time_seconds;
+    // If the step log is being streamed to file, the frame is only retained if required
+    if (streamStepLog(frame)) {
+        run_log->step.push_back(std::move(frame));
+    }
+}
+void CPUReferenceSimulation::processExitLog() {
+    if (!exit_log_config)
+        return;
+    // Iterate members of exit log to build the exit log frame
+    std::map<std::string, util::Any> environment_log;
+    for (const auto &prop_name : exit_log_config->environment) {
+        environment_log.emplace(prop_name, environment.at(prop_name));
+    }
+    std::map<util::StringPair, std::pair<std::map<LoggingConfig::NameReductionFn, util::Any>, unsigned int>> agents_log;
+    for (const auto &name_state : exit_log_config->agents) {
+        const AgentVector &population = agent_map.at(name_state.first.first)->getPopulation(name_state.first.second);
+        auto &agent_state_log = agents_log.emplace(name_state.first, std::make_pair(std::map<LoggingConfig::NameReductionFn, util::Any>(), UINT_MAX)).first->second;
+        // Compute every fusable reduction (e.g. Mean, Min) of every variable in a single pass
+        const LoggingConfig::FusedReductions &fused = exit_log_config->getFusedReductions(name_state.first);
+        if (!fused.plan.empty()) {
+            std::vector<const void*> buffers;
+            for (const auto &column : fused.plan.getColumns()) {
+                const auto it = population._data->find(column.variable_name);
+                buffers.push_back(it != population._data->end() ? it->second->getReadOnlyDataPtr() : nullptr);
+            }
+            fused.emplaceResults(fused.plan.reduceHost(buffers, population.size()), agent_state_log.first);
+        }
+        // Log the remaining variable reductions individually
+        for (const auto *name_reduction : fused.unfused) {
+            agent_state_log.first.emplace(*name_reduction, name_reduction->host_function(population, *name_reduction));
+        }
+        // Log count of agents in state
+        if (name_state.second.second) {
+            agent_state_log.second = population.size();
+        }
+    }
+    // Set Log
+    run_log->exit = ExitLogFrame(std::move(environment_log), std::move(agents_log), step_count);
+    // Add the timing info
+    run_log->exit.rtc_time = 0;
+    run_log->exit.init_time = elapsedSecondsInitFunctions;
+    run_log->exit.exit_time = elapsedSecondsExitFunctions;
+    run_log->exit.total_time = elapsedSecondsSimulation;
+}
+
+}  // namespace flamegpu
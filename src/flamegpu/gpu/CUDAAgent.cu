@@ -5,6 +5,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 // If MSVC earlier than VS 2019
 #if defined(_MSC_VER) && _MSC_VER < 1920
 #include <filesystem>
@@ -45,7 +46,7 @@ namespace flamegpu {
 
 CUDAAgent::CUDAAgent(const AgentData& description, const CUDASimulation &_cudaSimulation)
     : agent_description(description)  // This is a master agent, so it must create a new fat_agent
-    , fat_agent(std::make_shared<CUDAFatAgent>(agent_description))  // if we create fat agent, we're index 0
+    , fat_agent(std::make_shared<CUDAFatAgent>(agent_description, _cudaSimulation.getDeviceMemory()))  // if we create fat agent, we're index 0
     , fat_index(0)
     , cudaSimulation(_cudaSimulation)
     , TOTAL_AGENT_VARIABLE_SIZE(calcTotalVarSize(description)) {
@@ -85,6 +86,24 @@ CUDAAgent::CUDAAgent(
     }
 }
 
+detail::curve::CurveTable::Binding &CUDAAgent::getCurveBinding(const AgentFunctionData &func, const unsigned int instance_id, const bool new_agents) const {
+    std::lock_guard<std::mutex> guard(curveBindingsMutex);
+    auto &binding = curveBindings[std::make_tuple(func.name, instance_id, new_agents)];
+    if (binding.variables.empty() && !agent_description.variables.empty()) {
+        const detail::curve::Curve::VariableHash func_hash = detail::curve::Curve::variableRuntimeHash(func.name.c_str());
+        const detail::curve::Curve::VariableHash namespace_hash = new_agents
+            ? (detail::curve::Curve::variableRuntimeHash("_agent_birth") ^ func_hash) + instance_id
+            : detail::curve::Curve::variableRuntimeHash(agent_description.name.c_str()) + func_hash + instance_id;
+        binding.variables.reserve(agent_description.variables.size());
+        for (const auto &mmp : agent_description.variables) {
+            detail::curve::CurveTable::Binding::Entry entry;
+            entry.hash = detail::curve::Curve::variableRuntimeHash(mmp.first.c_str()) + namespace_hash;
+            entry.size = mmp.second.type_size * mmp.second.elements;
+            binding.variables.push_back(entry);
+        }
+    }
+    return binding;
+}
 void CUDAAgent::mapRuntimeVariables(const AgentFunctionData& func, const unsigned int &instance_id) const {
     // check the cuda agent state map to find the correct state list for functions starting state
     auto sm = state_map.find(func.initial_state);
@@ -95,32 +114,15 @@ void CUDAAgent::mapRuntimeVariables(const AgentFunctionData& func, const unsigne
             agent_description.name.c_str(), func.initial_state.c_str());
     }
 
-    const detail::curve::Curve::VariableHash agent_hash = detail::curve::Curve::variableRuntimeHash(agent_description.name.c_str());
-    const detail::curve::Curve::VariableHash func_hash = detail::curve::Curve::variableRuntimeHash(func.name.c_str());
-    auto &curve = detail::curve::Curve::getInstance();
     const unsigned int agent_count = this->getStateSize(func.initial_state);
-    // loop through the agents variables to map each variable name using cuRVE
+    // loop through the agents variables to collect the device pointer of each
+    std::vector<void*> d_ptrs;
+    d_ptrs.reserve(agent_description.variables.size());
     for (const auto &mmp : agent_description.variables) {
         // get a device pointer for the agent variable name
         void* d_ptr = sm->second->getVariablePointer(mmp.first);
+        d_ptrs.push_back(d_ptr);
 
-        // map using curve
-        const detail::curve::Curve::VariableHash var_hash = detail::curve::Curve::variableRuntimeHash(mmp.first.c_str());
-
-        // get the agent variable size
-        const size_t type_size = mmp.second.type_size * mmp.second.elements;
-
-        // maximum population num
-        if (func.func || func.condition) {
-#ifdef _DEBUG
-            const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + agent_hash + func_hash + instance_id, d_ptr, type_size, agent_count);
-            if (cv != static_cast<int>((var_hash + agent_hash + func_hash + instance_id)%detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' Variable '%s' has a collision and may work improperly.\n", func.name.c_str(), mmp.first.c_str());
-            }
-#else
-            curve.registerVariableByHash(var_hash + agent_hash + func_hash + instance_id, d_ptr, type_size, agent_count);
-#endif
-        }
         // Map RTC variables to agent function (these must be mapped before each function execution as the runtime pointer may have changed to the swapping)
         if (!func.rtc_func_name.empty()) {
             // Copy data to rtc header cache
@@ -136,6 +138,20 @@ void CUDAAgent::mapRuntimeVariables(const AgentFunctionData& func, const unsigne
             memcpy(rtc_header.getAgentVariableCachePtr(mmp.first.c_str()), &d_ptr, sizeof(void*));
         }
     }
+    // map using curve, the binding holds the precomputed hash of each variable
+    if (func.func || func.condition) {
+        auto &binding = getCurveBinding(func, instance_id, false);
+        detail::curve::Curve::getInstance().bind(binding, d_ptrs.data(), agent_count);
+#ifdef _DEBUG
+        auto entry = binding.variables.begin();
+        for (const auto &mmp : agent_description.variables) {
+            if (entry->slot != static_cast<int>(detail::curve::CurveTable::getHomeSlot(entry->hash))) {
+                fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' Variable '%s' has a collision, lookups will probe.\n", func.name.c_str(), mmp.first.c_str());
+            }
+            ++entry;
+        }
+#endif
+    }
 }
 
 void CUDAAgent::unmapRuntimeVariables(const AgentFunctionData& func, const unsigned int &instance_id) const {
@@ -151,17 +167,8 @@ void CUDAAgent::unmapRuntimeVariables(const AgentFunctionData& func, const unsig
             agent_description.name.c_str(), func.initial_state.c_str());
     }
 
-    const detail::curve::Curve::VariableHash agent_hash = detail::curve::Curve::variableRuntimeHash(agent_description.name.c_str());
-    const detail::curve::Curve::VariableHash func_hash = detail::curve::Curve::variableRuntimeHash(func.name.c_str());
-    // loop through the agents variables to map each variable name using cuRVE
-    for (const auto &mmp : agent_description.variables) {
-        // get a device pointer for the agent variable name
-        // void* d_ptr = sm->second->getAgentListVariablePointer(mmp.first);
-
-        // unmap using curve
-        const detail::curve::Curve::VariableHash var_hash = detail::curve::Curve::variableRuntimeHash(mmp.first.c_str());
-        detail::curve::Curve::getInstance().unregisterVariableByHash(var_hash + agent_hash + func_hash + instance_id);
-    }
+    // unmap using curve, the binding holds the slot of each variable
+    detail::curve::Curve::getInstance().unbind(getCurveBinding(func, instance_id, false));
 
     // No current need to unmap RTC variables as they are specific to the agent functions and thus do not persist beyond the scope of a single function
 }
@@ -367,6 +374,15 @@ void CUDAAgent::scatterHostCreation(const std::string &state_name, const unsigne
     }
     sm->second->scatterHostCreation(newSize, d_inBuff, offsets, scatter, streamId, stream);
 }
+void CUDAAgent::appendHostCreation(const std::string &state_name, const HostNewAgentBatch &batch, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
+    auto sm = state_map.find(state_name);
+    if (sm == state_map.end()) {
+        THROW exception::InvalidCudaAgentState("Error: Agent ('%s') state ('%s') was not found "
+            "in CUDAAgent::appendHostCreation()",
+            agent_description.name.c_str(), state_name.c_str());
+    }
+    sm->second->appendAgentData(batch, scatter, streamId, stream);
+}
 void CUDAAgent::scatterSort(const std::string &state_name, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
     auto sm = state_map.find(state_name);
     if (sm == state_map.end()) {
@@ -414,19 +430,16 @@ void CUDAAgent::mapNewRuntimeVariables(const CUDAAgent& func_agent, const AgentF
             maxLen, 0);
 
         // Map variables to curve
-        const detail::curve::Curve::VariableHash _agent_birth_hash = detail::curve::Curve::variableRuntimeHash("_agent_birth");
-        const detail::curve::Curve::VariableHash func_hash = detail::curve::Curve::variableRuntimeHash(func.name.c_str());
-        auto &curve = detail::curve::Curve::getInstance();
+        std::vector<void*> d_ptrs;
+        d_ptrs.reserve(agent_description.variables.size());
         // loop through the agents variables to map each variable name using cuRVE
         for (const auto &mmp : agent_description.variables) {
-            // map using curve
-            const detail::curve::Curve::VariableHash var_hash = detail::curve::Curve::variableRuntimeHash(mmp.first.c_str());
-
             // get the agent variable size
             const size_t type_size = mmp.second.type_size * mmp.second.elements;
 
             // get a device pointer for the agent variable name
             void* d_ptr = d_new_buffer;
+            d_ptrs.push_back(d_ptr);
 
             // Move the pointer along for next variable
             d_new_buffer += type_size * maxLen;
@@ -436,23 +449,27 @@ void CUDAAgent::mapNewRuntimeVariables(const CUDAAgent& func_agent, const AgentF
                 d_new_buffer += 8 - (reinterpret_cast<size_t>(d_new_buffer)%8);
             }
 
-            // maximum population num
-            if (func.func) {
-#ifdef _DEBUG
-                const detail::curve::Curve::Variable cv = curve.registerVariableByHash(var_hash + (_agent_birth_hash ^ func_hash) + instance_id, d_ptr, type_size, maxLen);
-                if (cv != static_cast<int>((var_hash + (_agent_birth_hash ^ func_hash) + instance_id)%detail::curve::Curve::MAX_VARIABLES)) {
-                    fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' New Agent Variable '%s' has a collision and may work improperly.\n", func.name.c_str(), mmp.first.c_str());
-                }
-#else
-                curve.registerVariableByHash(var_hash + (_agent_birth_hash ^ func_hash) + instance_id, d_ptr, type_size, maxLen);
-#endif
-            } else  {
+            if (!func.func) {
                 // Map RTC variables (these must be mapped before each function execution as the runtime pointer may have changed to the swapping)
                 // Copy data to rtc header cache
                 auto& rtc_header = func_agent.getRTCHeader(func.name);
                 memcpy(rtc_header.getNewAgentVariableCachePtr(mmp.first.c_str()), &d_ptr, sizeof(void*));
             }
         }
+        // maximum population num
+        if (func.func) {
+            auto &binding = getCurveBinding(func, instance_id, true);
+            detail::curve::Curve::getInstance().bind(binding, d_ptrs.data(), maxLen);
+#ifdef _DEBUG
+            auto entry = binding.variables.begin();
+            for (const auto &mmp : agent_description.variables) {
+                if (entry->slot != static_cast<int>(detail::curve::CurveTable::getHomeSlot(entry->hash))) {
+                    fprintf(stderr, "detail::curve::Curve Warning: Agent Function '%s' New Agent Variable '%s' has a collision, lookups will probe.\n", func.name.c_str(), mmp.first.c_str());
+                }
+                ++entry;
+            }
+#endif
+        }
     }
 }
 void CUDAAgent::unmapNewRuntimeVariables(const AgentFunctionData& func, const unsigned int &instance_id) {
@@ -472,18 +489,9 @@ void CUDAAgent::unmapNewRuntimeVariables(const AgentFunctionData& func, const un
         // Skip if RTC
         if (!func.func)
             return;
-        // Unmap curve
-        const detail::curve::Curve::VariableHash _agent_birth_hash = detail::curve::Curve::variableRuntimeHash("_agent_birth");
-        const detail::curve::Curve::VariableHash func_hash = detail::curve::Curve::variableRuntimeHash(func.name.c_str());
-        auto &curve = detail::curve::Curve::getInstance();
-        // loop through the agents variables to map each variable name using cuRVE
-        for (const auto &mmp : agent_description.variables) {
-            // unmap using curve
-            const detail::curve::Curve::VariableHash var_hash = detail::curve::Curve::variableRuntimeHash(mmp.first.c_str());
-            curve.unregisterVariableByHash(var_hash + (_agent_birth_hash ^ func_hash) + instance_id);
-
-            // no need to unmap RTC variables
-        }
+        // Unmap curve, the binding holds the slot of each variable
+        detail::curve::Curve::getInstance().unbind(getCurveBinding(func, instance_id, true));
+        // no need to unmap RTC variables
     }
 }
 
@@ -557,28 +565,22 @@ void CUDAAgent::addInstantitateRTCFunction(const AgentFunctionData& func, const
 
     // Set Environment variables in curve
     {
-        // Scope the mutex
-        auto lock = EnvironmentManager::getInstance().getSharedLock();
-        const auto &prop_map = EnvironmentManager::getInstance().getPropertiesMap();
-        for (const auto &p : prop_map) {
-            if (p.first.first == cudaSimulation.getInstanceID()) {
-                const char* variableName = p.first.second.c_str();
-                const char* type = p.second.type.name();
-                unsigned int elements = p.second.elements;
-                ptrdiff_t offset = p.second.rtc_offset;
-                curve_header.registerEnvVariable(variableName, offset, type, p.second.length/elements, elements);
-            }
+        EnvironmentManager &env_manager = EnvironmentManager::getInstance();
+        for (const auto &p : env_manager.getPropertiesMap(cudaSimulation.getInstanceID())) {
+            const char* variableName = p.first.c_str();
+            const char* type = p.second.type.name();
+            unsigned int elements = p.second.elements;
+            ptrdiff_t offset = p.second.rtc_offset;
+            curve_header.registerEnvVariable(variableName, offset, type, p.second.length/elements, elements, p.second.rtc_indirect);
         }
         // Set mapped environment variables in curve
-        for (const auto &mp : EnvironmentManager::getInstance().getMappedProperties()) {
-            if (mp.first.first == cudaSimulation.getInstanceID()) {
-                auto p = prop_map.at(mp.second.masterProp);
-                const char* variableName = mp.second.masterProp.second.c_str();
-                const char* type = p.type.name();
-                unsigned int elements = p.elements;
-                ptrdiff_t offset = p.rtc_offset;
-                curve_header.registerEnvVariable(variableName, offset, type, p.length/elements, elements);
-            }
+        for (const auto &mp : env_manager.getMappedProperties(cudaSimulation.getInstanceID())) {
+            const auto &p = mp.second.master->properties.at(mp.second.masterProp.second);
+            const char* variableName = mp.first.c_str();
+            const char* type = p.type.name();
+            unsigned int elements = p.elements;
+            ptrdiff_t offset = p.rtc_offset;
+            curve_header.registerEnvVariable(variableName, offset, type, p.length/elements, elements, p.rtc_indirect);
         }
     }
 
@@ -698,6 +700,7 @@ void CUDAAgent::cullAllStates() {
         s.second->clear();
     }
     fat_agent->resetIDCounter();
+    fat_agent->markIDsUnset();
 }
 std::list<std::shared_ptr<VariableBuffer>> CUDAAgent::getUnboundVariableBuffers(const std::string& state) {
     const auto& sm = state_map.find(state);
@@ -715,6 +718,9 @@ id_t CUDAAgent::nextID(unsigned int count) {
 id_t* CUDAAgent::getDeviceNextID() {
     return fat_agent->getDeviceNextID();
 }
+void CUDAAgent::setNextID(const id_t id) {
+    fat_agent->setNextID(id);
+}
 void CUDAAgent::assignIDs(HostAPI& hostapi) {
     fat_agent->assignIDs(hostapi);
 }
@@ -9,6 +9,7 @@
 #include "flamegpu/model/AgentDescription.h"
 #include "flamegpu/gpu/CUDAScatter.cuh"
 #include "flamegpu/runtime/HostNewAgentAPI.h"
+#include "flamegpu/runtime/HostNewAgentBatch.h"
 #include "flamegpu/exception/FLAMEGPUException.h"
 
 #ifdef _MSC_VER
@@ -167,6 +168,34 @@ void CUDAAgentStateList::scatterHostCreation(const unsigned int& newSize, char*
     // Update number of alive agents
     parent_list->setAgentCount(parent_list->getSize() + newSize);
 }
+void CUDAAgentStateList::appendAgentData(const HostNewAgentBatch &batch, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
+    const AgentVector &population = batch;
+    if (!population.matchesAgentType(agent.getAgentDescription())) {
+        THROW exception::InvalidCudaAgentDesc("Agent description for agent '%s' does not match that of HostNewAgentBatch, "
+            "in CUDAAgentStateList::appendAgentData()",
+            population.getAgentName().c_str());
+    }
+    const unsigned int newSize = population.size();
+    if (!newSize)
+        return;
+    // Resize agent list if required
+    parent_list->resize(parent_list->getSizeWithDisabled() + newSize, true);
+    const unsigned int offset = parent_list->getSize();
+    // Copy across each variable as a single block host->device
+    for (auto &_var : variables) {
+        const auto &var = agent.getAgentDescription().variables.at(_var.first);
+        const size_t var_size = var.type_size * var.elements;
+        gpuErrchk(cudaMemcpyAsync(static_cast<char*>(_var.second->data) + offset * var_size, population.data(_var.first), var_size * newSize, cudaMemcpyHostToDevice, stream));
+    }
+    // Initialise any buffers in the fat_agent which aren't part of the current agent description
+    std::set<std::shared_ptr<VariableBuffer>> exclusionSet;
+    for (auto &a : variables)
+        exclusionSet.insert(a.second);
+    parent_list->initVariables(exclusionSet, newSize, offset, scatter, streamId, stream);
+    gpuErrchk(cudaStreamSynchronize(stream));
+    // Update number of alive agents
+    parent_list->setAgentCount(offset + newSize);
+}
 void CUDAAgentStateList::scatterSort(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
     parent_list->scatterSort(scatter, streamId, stream);
 }
@@ -5,18 +5,18 @@
 #include <memory>
 #include <thread>
 #include <set>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
 
 #include "flamegpu/version.h"
 #include "flamegpu/model/ModelDescription.h"
 #include "flamegpu/sim/RunPlanVector.h"
+#include "flamegpu/sim/RunPlanScheduler.h"
 #include "flamegpu/util/detail/compute_capability.cuh"
 #include "flamegpu/util/detail/SteadyClockTimer.h"
 #include "flamegpu/gpu/CUDASimulation.h"
 #include "flamegpu/io/StateWriterFactory.h"
 #include "flamegpu/util/detail/filesystem.h"
+#include "flamegpu/util/detail/BoundedQueue.h"
+#include "flamegpu/util/detail/Tracer.h"
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/SimRunner.h"
 #include "flamegpu/sim/LogFrame.h"
@@ -26,7 +26,8 @@ namespace flamegpu {
 
 
 CUDAEnsemble::CUDAEnsemble(const ModelDescription& _model, int argc, const char** argv)
-    : model(_model.model->clone()) {
+    : scheduler(std::make_shared<LongestFirstScheduler>())
+    , model(_model.model->clone()) {
     initialise(argc, argv);
 }
 CUDAEnsemble::~CUDAEnsemble() {
@@ -47,6 +48,9 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
         if (config.out_format.empty()) {
             THROW exception::InvalidArgument("The out_directory config option also requires the out_format options to be set to a suitable type (e.g. 'json', 'xml'), in CUDAEnsemble::simulate()");
         }
+        if (!config.export_threads) {
+            THROW exception::InvalidArgument("The export_threads config option must be greater than 0, in CUDAEnsemble::simulate()");
+        }
         // Create any missing directories
         try {
             util::detail::filesystem::recursive_create_dir(config.out_directory);
@@ -97,9 +101,13 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
 
     // Init runners, devices * concurrent runs
     std::atomic<unsigned int> err_ct = {0};
-    std::atomic<unsigned int> next_run = {0};
+    detail::RunPlanQueue run_queue(scheduler->getOrder(plans), static_cast<unsigned int>(plans.size()));
     const size_t TOTAL_RUNNERS = devices.size() * config.concurrent_runs;
-    SimRunner *runners = static_cast<SimRunner *>(malloc(sizeof(SimRunner) * TOTAL_RUNNERS));
+
+    // Record a trace of all runners and log workers, until they have all exited
+    util::detail::Tracer::Session trace_session(config.trace_file, config.trace_flush_interval);
+    util::detail::Tracer::setThreadName("CUDAEnsemble");
+    util::detail::Tracer::Scope trace_scope("ensemble");
 
     // Log Time (We can't use CUDA events here, due to device resets)
     auto ensemble_timer = util::detail::SteadyClockTimer();
@@ -107,11 +115,20 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
     // Reset the elapsed time.
     ensemble_elapsed_time = 0.;
 
-    // Logging thread-safety items
-    std::queue<unsigned int> log_export_queue;
-    std::mutex log_export_queue_mutex;
-    std::condition_variable log_export_queue_cdn;
+    // Completed runs awaiting export, runners only push to this if a log worker is consuming it
+    const bool export_logs = !config.out_directory.empty() && !config.out_format.empty();
+    util::detail::BoundedQueue<unsigned int> log_export_queue(config.export_queue_capacity);
 
+    // Init log worker, before runners so they never wait on a queue without a consumer
+    SimLogger *log_worker = nullptr;
+    if (export_logs) {
+        log_worker = new SimLogger(run_logs, plans, config.out_directory, config.out_format, log_export_queue, config.export_threads, config.export_shards,
+        step_log_config.get(), exit_log_config.get(), step_log_config && step_log_config->log_timing, exit_log_config && exit_log_config->log_timing);
+    } else if (!config.out_directory.empty() ^ !config.out_format.empty())  {
+        fprintf(stderr, "Warning: Only 1 of out_directory and out_format is set, both must be set for logging to commence to file.\n");
+    }
+
+    SimRunner *runners = static_cast<SimRunner *>(malloc(sizeof(SimRunner) * TOTAL_RUNNERS));
     // Init with placement new
     {
         if (!config.quiet) {
@@ -121,33 +138,20 @@ void CUDAEnsemble::simulate(const RunPlanVector &plans) {
         unsigned int i = 0;
         for (auto &d : devices) {
             for (unsigned int j = 0; j < config.concurrent_runs; ++j) {
-                new (&runners[i++]) SimRunner(model, err_ct, next_run, plans, step_log_config, exit_log_config, d, j, !config.quiet, run_logs, log_export_queue, log_export_queue_mutex, log_export_queue_cdn);
+                new (&runners[i++]) SimRunner(model, err_ct, run_queue, plans, step_log_config, exit_log_config, d, j, !config.quiet, config.reuse_simulations, config.profile, run_logs, export_logs ? &log_export_queue : nullptr);
             }
         }
     }
 
-    // Init log worker
-    SimLogger *log_worker = nullptr;
-    if (!config.out_directory.empty() && !config.out_format.empty()) {
-        log_worker = new SimLogger(run_logs, plans, config.out_directory, config.out_format, log_export_queue, log_export_queue_mutex, log_export_queue_cdn,
-        step_log_config.get(), exit_log_config.get(), step_log_config && step_log_config->log_timing, exit_log_config && exit_log_config->log_timing);
-    } else if (!config.out_directory.empty() ^ !config.out_format.empty())  {
-        fprintf(stderr, "Warning: Only 1 of out_directory and out_format is set, both must be set for logging to commence to file.\n");
-    }
-
     // Wait for all runners to exit
     for (unsigned int i = 0; i < TOTAL_RUNNERS; ++i) {
         runners[i].thread.join();
         runners[i].~SimRunner();
     }
-    // Notify logger to exit
+    // Notify logger to exit, once all queued logs have been exported
     if (log_worker) {
-        {
-            std::lock_guard<std::mutex> lck(log_export_queue_mutex);
-            log_export_queue.push(UINT_MAX);
-        }
-        log_export_queue_cdn.notify_one();
-        log_worker->thread.join();
+        log_export_queue.close();
+        log_worker->join();
         delete log_worker;
         log_worker = nullptr;
     }
@@ -267,6 +271,43 @@ int CUDAEnsemble::checkArgs(int argc, const char** argv) {
             config.timing = true;
             continue;
         }
+        // --profile, Record per layer/function timings to each run's log
+        if (arg.compare("--profile") == 0) {
+            config.profile = true;
+            continue;
+        }
+        // --trace <file.json>, Write a timeline of the ensemble in the Chrome Trace Event format
+        if (arg.compare("--trace") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            config.trace_file = argv[++i];
+            continue;
+        }
+        // --reuse, Reuse a single simulation per concurrent runner
+        if (arg.compare("--reuse") == 0) {
+            config.reuse_simulations = true;
+            continue;
+        }
+        // --export-threads <threads>, Number of threads used to export logs
+        if (arg.compare("--export-threads") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            config.export_threads = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 0));
+            continue;
+        }
+        // --export-shards <files>, Number of aggregate files to export logs to
+        if (arg.compare("--export-shards") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            config.export_shards = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 0));
+            continue;
+        }
         fprintf(stderr, "Unexpected argument: %s\n", arg.c_str());
         printHelp(argv[0]);
         return false;
@@ -286,6 +327,13 @@ void CUDAEnsemble::printHelp(const char *executable) {
     printf(line_fmt, "-o, --out <directory> <filetype>", "Directory and filetype for ensemble outputs");
     printf(line_fmt, "-q, --quiet", "Don't print progress information to console");
     printf(line_fmt, "-t, --timing", "Output timing information to stdout");
+    printf(line_fmt, "    --profile", "Record per layer and per function timings to each run's log");
+    printf(line_fmt, "    --trace <file.json>", "Write a timeline of the ensemble to file (Chrome Trace Event format)");
+    printf(line_fmt, "    --reuse", "Reset and reuse a single simulation per concurrent run");
+    printf(line_fmt, "    --export-threads <threads>", "Number of threads used to export logs");
+    printf(line_fmt, "", "By default, 1 will be used.");
+    printf(line_fmt, "    --export-shards <files>", "Append the logs of all runs to this many files");
+    printf(line_fmt, "", "By default, each run is exported to it's own files.");
 }
 void CUDAEnsemble::setStepLog(const StepLoggingConfig &stepConfig) {
     // Validate ModelDescription matches
@@ -303,8 +351,21 @@ void CUDAEnsemble::setExitLog(const LoggingConfig &exitConfig) {
     // Set internal config
     exit_log_config = std::make_shared<LoggingConfig>(exitConfig);
 }
+void CUDAEnsemble::setScheduler(std::shared_ptr<const RunPlanScheduler> _scheduler) {
+    if (!_scheduler) {
+        THROW exception::InvalidArgument("Scheduler must not be nullptr, in CUDAEnsemble::setScheduler()\n");
+    }
+    scheduler = std::move(_scheduler);
+}
 const std::vector<RunLog> &CUDAEnsemble::getLogs() {
     return run_logs;
 }
+Profile CUDAEnsemble::getProfile() const {
+    Profile rtn;
+    for (const auto &log : run_logs) {
+        rtn.merge(log.getProfile());
+    }
+    return rtn;
+}
 
 }  // namespace flamegpu
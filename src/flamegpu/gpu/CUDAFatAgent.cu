@@ -15,15 +15,16 @@
 
 namespace flamegpu {
 
-CUDAFatAgent::CUDAFatAgent(const AgentData& description)
-    : mappedAgentCount(0)
+CUDAFatAgent::CUDAFatAgent(const AgentData& description, std::shared_ptr<util::detail::MemoryResource> _memory)
+    : memory(std::move(_memory))
+    , mappedAgentCount(0)
     , _nextID(ID_NOT_SET + 1)
     , d_nextID(nullptr)
     , hd_nextID(ID_NOT_SET) {
     for (const std::string &s : description.states) {
         // allocate memory for each state list by creating a new Agent State List
         AgentState state = {mappedAgentCount, s};
-        states.emplace(state, std::make_shared<CUDAFatAgentStateList>(description));
+        states.emplace(state, std::make_shared<CUDAFatAgentStateList>(description, memory));
     }
     mappedAgentCount++;
     // All initial states are unique
@@ -35,7 +36,7 @@ CUDAFatAgent::~CUDAFatAgent() {
         gpuErrchk(cudaFree(d_nextID));
     }
     for (auto &b : d_newLists) {
-        gpuErrchk(cudaFree(b.data));
+        memory->deallocate(b.data);
     }
     d_newLists.clear();
 }
@@ -74,7 +75,7 @@ void CUDAFatAgent::addSubAgent(
         }
         // allocate memory for each state list by creating a new Agent State List
         AgentState state = {mappedAgentCount, s};
-        states.emplace(state, std::make_shared<CUDAFatAgentStateList>(description));
+        states.emplace(state, std::make_shared<CUDAFatAgentStateList>(description, memory));
     }
     // Handle agent variables
     for (auto &state : states_unique) {
@@ -268,8 +269,8 @@ void *CUDAFatAgent::allocNewBuffer(const size_t &total_agent_size, const unsigne
             NewBuffer my_b = b;
             // Erase and resize/reinsert to d_newLists to mark as in use
             d_newLists.erase(b);
-            gpuErrchk(cudaFree(my_b.data));
-            gpuErrchk(cudaMalloc(&my_b.data, ALLOCATION_SIZE));
+            memory->deallocate(my_b.data);
+            my_b.data = memory->allocateOrThrow(ALLOCATION_SIZE);
             my_b.size = ALLOCATION_SIZE;
             my_b.in_use = true;
             d_newLists.insert(my_b);
@@ -279,7 +280,7 @@ void *CUDAFatAgent::allocNewBuffer(const size_t &total_agent_size, const unsigne
     }
     // No existing buffer available, so create a new one
     NewBuffer my_b;
-    gpuErrchk(cudaMalloc(&my_b.data, ALLOCATION_SIZE));
+    my_b.data = memory->allocateOrThrow(ALLOCATION_SIZE);
     my_b.size = ALLOCATION_SIZE;
     my_b.in_use = true;
     d_newLists.insert(my_b);
@@ -385,6 +386,10 @@ void CUDAFatAgent::assignIDs(HostAPI& hostapi) {
 
     agent_ids_have_init = true;
 }
+void CUDAFatAgent::setNextID(const id_t id) {
+    _nextID = id;
+    agent_ids_have_init = true;
+}
 void CUDAFatAgent::resetIDCounter() {
     // Resetting ID whilst agents exist is a bad idea, so fail silently
     for (auto& s : states_unique)
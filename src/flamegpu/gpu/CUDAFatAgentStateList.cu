@@ -1,12 +1,15 @@
 #include "flamegpu/gpu/CUDAFatAgentStateList.h"
 #include "flamegpu/gpu/CUDAScatter.cuh"
 
+#include <utility>
+
 namespace flamegpu {
 
-CUDAFatAgentStateList::CUDAFatAgentStateList(const AgentData& description)
+CUDAFatAgentStateList::CUDAFatAgentStateList(const AgentData& description, std::shared_ptr<util::detail::MemoryResource> _memory)
     : aliveAgents(0)
     , disabledAgents(0)
-    , bufferLen(0) {
+    , bufferLen(0)
+    , memory(std::move(_memory)) {
     // Initial statelist, must be from agent index 0
     // State lists begin unallocated, allocated on first use
     for (const auto &v : description.variables) {
@@ -20,7 +23,8 @@ CUDAFatAgentStateList::CUDAFatAgentStateList(const AgentData& description)
 CUDAFatAgentStateList::CUDAFatAgentStateList(const CUDAFatAgentStateList& other)
     : aliveAgents(other.aliveAgents)
     , disabledAgents(other.disabledAgents)
-    , bufferLen(0) {
+    , bufferLen(0)
+    , memory(other.memory) {
     assert(other.bufferLen == 0);
     std::unordered_map<void*, std::shared_ptr<VariableBuffer>> var_map;
     // Copy all unique variables, create a temporary map of old unique var to new unique var
@@ -38,8 +42,8 @@ CUDAFatAgentStateList::CUDAFatAgentStateList(const CUDAFatAgentStateList& other)
 }
 CUDAFatAgentStateList::~CUDAFatAgentStateList() {
     for (const auto &buff : variables_unique) {
-        gpuErrchk(cudaFree(buff->data));
-        gpuErrchk(cudaFree(buff->data_swap));
+        memory->deallocate(buff->data);
+        memory->deallocate(buff->data_swap);
     }
 }
 void CUDAFatAgentStateList::addSubAgentVariables(
@@ -79,10 +83,10 @@ void CUDAFatAgentStateList::resize(const unsigned int &minSize, const bool &reta
     for (auto &buff : variables_unique) {
         const size_t var_size = buff->type_size * buff->elements;
         const size_t buff_size = var_size * newSize;
-        // Free old swap buffer
-        gpuErrchk(cudaFree(buff->data_swap));
+        // Release old swap buffer, the pool may return it for a later allocation of the same size
+        memory->deallocate(buff->data_swap);
         // Allocate new buffer to swap
-        gpuErrchk(cudaMalloc(&buff->data_swap, buff_size));
+        buff->data_swap = memory->allocateOrThrow(buff_size);
         // Copy old data to new buffer in swap
         if (retainData && buff->data) {
             const size_t active_len = aliveAgents * var_size;
@@ -97,10 +101,10 @@ void CUDAFatAgentStateList::resize(const unsigned int &minSize, const bool &reta
         }
         // Swap buffers
         std::swap(buff->data_swap, buff->data);
-        // Free old swap buffer
-        gpuErrchk(cudaFree(buff->data_swap));
+        // Release old swap buffer
+        memory->deallocate(buff->data_swap);
         // Allocate new buffer to swap
-        gpuErrchk(cudaMalloc(&buff->data_swap, buff_size));
+        buff->data_swap = memory->allocateOrThrow(buff_size);
         // Update condition list
         assert(disabledAgents == 0);
         buff->data_condition = buff->data;
@@ -19,6 +19,10 @@ CUDAMacroEnvironment::CUDAMacroEnvironment(const EnvironmentDescription& descrip
     }
 }
 
+size_t CUDAMacroEnvironment::getHostDownloadTileBytes() const {
+    return cudaSimulation.getCUDAConfig().macro_property_download_tile_bytes;
+}
+
 void CUDAMacroEnvironment::init() {
     for (auto &prop : properties) {
         if (!prop.second.d_ptr) {
@@ -89,6 +93,57 @@ void CUDAMacroEnvironment::purge() {
     for (auto& prop : properties)
         prop.second.d_ptr = nullptr;
 }
+void CUDAMacroEnvironment::reset() {
+    for (auto& prop : properties) {
+        if (prop.second.d_ptr && !prop.second.is_sub) {
+            size_t buffer_size = prop.second.type_size
+                * prop.second.elements[0]
+                * prop.second.elements[1]
+                * prop.second.elements[2]
+                * prop.second.elements[3];
+#if !defined(SEATBELTS) || SEATBELTS
+            buffer_size += sizeof(unsigned int);  // Extra uint is used as read-write flag by seatbelts
+#endif
+            gpuErrchk(cudaMemset(prop.second.d_ptr, 0, buffer_size));
+        }
+    }
+}
+
+void CUDAMacroEnvironment::checkpoint(io::Checkpoint::SectionWriter &out) const {
+    std::vector<char> t_buffer;
+    for (const auto& prop : properties) {
+        if (!prop.second.d_ptr || prop.second.is_sub)
+            continue;
+        const size_t buffer_size = prop.second.type_size
+            * prop.second.elements[0]
+            * prop.second.elements[1]
+            * prop.second.elements[2]
+            * prop.second.elements[3];
+        t_buffer.resize(buffer_size);
+        gpuErrchk(cudaMemcpy(t_buffer.data(), prop.second.d_ptr, buffer_size, cudaMemcpyDeviceToHost));
+        out.writeString(prop.first);
+        out.write<uint64_t>(buffer_size);
+        out.write(t_buffer.data(), buffer_size);
+    }
+    out.writeString("");
+}
+void CUDAMacroEnvironment::restore(io::Checkpoint::SectionReader &in) {
+    // Any host copies are now stale
+    host_cache.clear();
+    std::vector<char> t_buffer;
+    for (std::string name = in.readString(); !name.empty(); name = in.readString()) {
+        const auto prop = properties.find(name);
+        const uint64_t buffer_size = in.read<uint64_t>();
+        if (prop == properties.end() || !prop->second.d_ptr || prop->second.is_sub || buffer_size != prop->second.type_size
+            * prop->second.elements[0] * prop->second.elements[1] * prop->second.elements[2] * prop->second.elements[3]) {
+            THROW exception::InvalidInputFile("Checkpoint macro property '%s' does not match the model's macro properties, "
+                "in CUDAMacroEnvironment::restore()\n", name.c_str());
+        }
+        t_buffer.resize(static_cast<size_t>(buffer_size));
+        in.read(t_buffer.data(), t_buffer.size());
+        gpuErrchk(cudaMemcpy(prop->second.d_ptr, t_buffer.data(), t_buffer.size(), cudaMemcpyHostToDevice));
+    }
+}
 
 void CUDAMacroEnvironment::mapRuntimeVariables() const {
     auto& curve = detail::curve::Curve::getInstance();
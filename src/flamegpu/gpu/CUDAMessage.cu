@@ -1,6 +1,8 @@
 #include <cuda_runtime.h>
 #include <device_launch_parameters.h>
 
+#include <vector>
+
 #include "flamegpu/gpu/CUDAMessage.h"
 #include "flamegpu/gpu/CUDAAgent.h"
 #include "flamegpu/gpu/CUDAMessageList.h"
@@ -56,7 +58,7 @@ void CUDAMessage::resize(unsigned int newSize, CUDAScatter &scatter, const unsig
             message_list->resize(scatter, streamId, _keep_len);
         } else {
             // If the list has not already been allocated, create a new
-            message_list = std::unique_ptr<CUDAMessageList>(new CUDAMessageList(*this, scatter, streamId));
+            message_list = std::unique_ptr<CUDAMessageList>(new CUDAMessageList(*this, cudaSimulation.getDeviceMemory(), scatter, streamId));
         }
         scatter.Scan().resize(max_list_size, CUDAScanCompaction::MESSAGE_OUTPUT, streamId);
     }
@@ -267,5 +269,56 @@ void CUDAMessage::buildIndex(CUDAScatter &scatter, const unsigned int &streamId,
 const void *CUDAMessage::getMetaDataDevicePtr() const {
     return specialisation_handler->getMetaDataDevicePtr();
 }
+void CUDAMessage::checkpoint(io::Checkpoint::SectionWriter &out) {
+    out.write<uint32_t>(message_count);
+    out.write<uint8_t>(truncate_messagelist_flag ? 1 : 0);
+    out.write<uint8_t>(pbm_construction_required ? 1 : 0);
+    std::vector<char> t_buffer;
+    for (const auto &var : message_description.variables) {
+        const size_t buffer_size = message_count ? var.second.type_size * var.second.elements * message_count : 0;
+        t_buffer.resize(buffer_size);
+        if (buffer_size) {
+            gpuErrchk(cudaMemcpy(t_buffer.data(), getReadPtr(var.first), buffer_size, cudaMemcpyDeviceToHost));
+        }
+        out.writeString(var.first);
+        out.write<uint64_t>(buffer_size);
+        out.write(t_buffer.data(), buffer_size);
+    }
+    out.writeString("");
+}
+void CUDAMessage::restore(io::Checkpoint::SectionReader &in, CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
+    const unsigned int count = in.read<uint32_t>();
+    const bool truncate = in.read<uint8_t>() != 0;
+    const bool pbm_required = in.read<uint8_t>() != 0;
+    if (count) {
+        resize(count, scatter, streamId);
+    }
+    std::vector<char> t_buffer;
+    for (std::string name = in.readString(); !name.empty(); name = in.readString()) {
+        const auto var = message_description.variables.find(name);
+        const uint64_t buffer_size = in.read<uint64_t>();
+        if (var == message_description.variables.end() || buffer_size != static_cast<uint64_t>(var->second.type_size) * var->second.elements * count) {
+            THROW exception::InvalidInputFile("Checkpoint message variable '%s.%s' does not match the model's messages, "
+                "in CUDAMessage::restore()\n", message_description.name.c_str(), name.c_str());
+        }
+        t_buffer.resize(static_cast<size_t>(buffer_size));
+        in.read(t_buffer.data(), t_buffer.size());
+        if (buffer_size) {
+            gpuErrchk(cudaMemcpy(getReadPtr(name), t_buffer.data(), t_buffer.size(), cudaMemcpyHostToDevice));
+        }
+    }
+    setMessageCount(count);
+    truncate_messagelist_flag = truncate;
+    pbm_construction_required = pbm_required;
+    if (!pbm_construction_required) {
+        if (message_count) {
+            // The messages are already in index order, but the index itself was not checkpointed
+            specialisation_handler->restoreIndex(scatter, streamId, stream);
+        } else {
+            // Reset any index left over from a previous run
+            specialisation_handler->init(scatter, streamId);
+        }
+    }
+}
 
 }  // namespace flamegpu
@@ -8,14 +8,17 @@
 #include "flamegpu/runtime/messaging/MessageBruteForce/MessageBruteForceHost.h"
 #include "flamegpu/gpu/CUDAScatter.cuh"
 
+#include <utility>
+
 namespace flamegpu {
 
 /**
 * CUDAMessageList class
 * @brief populates CUDA message map
 */
-CUDAMessageList::CUDAMessageList(CUDAMessage& cuda_message, CUDAScatter &scatter, const unsigned int &streamId)
-    : message(cuda_message) {
+CUDAMessageList::CUDAMessageList(CUDAMessage& cuda_message, std::shared_ptr<util::detail::MemoryResource> _memory, CUDAScatter &scatter, const unsigned int &streamId)
+    : message(cuda_message)
+    , memory(std::move(_memory)) {
     // allocate message lists
     allocateDeviceMessageList(d_list);
     allocateDeviceMessageList(d_swap_list);
@@ -49,16 +52,8 @@ void CUDAMessageList::allocateDeviceMessageList(CUDAMessageMap &memory_map) {
         // get the variable size from  message description
         size_t var_size = mm.second.type_size * mm.second.elements;
 
-        // do the device allocation
-        void * d_ptr;
-
-#ifdef UNIFIED_GPU_MEMORY
-        // unified memory allocation
-        gpuErrchk(cudaMallocManaged(reinterpret_cast<void**>(&d_ptr), var_size *  message.getMaximumListSize()))
-#else
-        // non unified memory allocation
-        gpuErrchk(cudaMalloc(reinterpret_cast<void**>(&d_ptr), var_size * message.getMaximumListSize()));
-#endif
+        // do the device allocation (unified memory if built with UNIFIED_GPU_MEMORY)
+        void *d_ptr = memory->allocateOrThrow(var_size * message.getMaximumListSize());
 
         // store the pointer in the map
         memory_map.insert(CUDAMessageMap::value_type(var_name, d_ptr));
@@ -93,8 +88,8 @@ void CUDAMessageList::resize(CUDAScatter& scatter, const unsigned int& streamId,
 void CUDAMessageList::releaseDeviceMessageList(CUDAMessageMap& memory_map) {
     // for each device pointer in the cuda memory map we need to free these
     for (const auto &mm : memory_map) {
-        // free the memory on the device
-        gpuErrchk(cudaFree(mm.second));
+        // release the memory, the pool may return it for a later allocation of the same size
+        memory->deallocate(mm.second);
     }
     memory_map.clear();
 }
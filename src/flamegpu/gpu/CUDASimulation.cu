@@ -3,7 +3,9 @@
 #include <curand_kernel.h>
 
 #include <algorithm>
+#include <list>
 #include <string>
+#include <utility>
 
 #include "flamegpu/model/AgentFunctionData.cuh"
 #include "flamegpu/model/LayerData.h"
@@ -18,6 +20,9 @@
 #include "flamegpu/util/detail/wddm.cuh"
 #include "flamegpu/util/detail/SteadyClockTimer.h"
 #include "flamegpu/util/detail/CUDAEventTimer.cuh"
+#include "flamegpu/util/detail/CUDAMemoryResource.h"
+#include "flamegpu/util/detail/SpaceFillingCurve.h"
+#include "flamegpu/util/detail/Tracer.h"
 #include "flamegpu/runtime/detail/curve/curve_rtc.cuh"
 #include "flamegpu/runtime/HostFunctionCallback.h"
 #include "flamegpu/runtime/messaging.h"
@@ -26,6 +31,7 @@
 #include "flamegpu/sim/LoggingConfig.h"
 #include "flamegpu/sim/LogFrame.h"
 #include "flamegpu/sim/RunPlan.h"
+#include "flamegpu/io/Checkpoint.h"
 #include "flamegpu/version.h"
 #ifdef VISUALISATION
 #include "flamegpu/visualiser/FLAMEGPU_Visualisation.h"
@@ -65,6 +71,8 @@ CUDASimulation::CUDASimulation(const std::shared_ptr<const ModelData> &_model)
     , elapsedSecondsInitFunctions(0.)
     , elapsedSecondsExitFunctions(0.)
     , elapsedSecondsRTCInitialisation(0.)
+    , profiler_events(profiler)
+    , device_memory(std::make_shared<util::detail::PoolMemoryResource>(util::detail::CUDAMemoryResource::getInstance()))
     , macro_env(*_model->environment, *this)
     , run_log(std::make_unique<RunLog>())
     , streams(std::vector<cudaStream_t>())
@@ -121,6 +129,8 @@ bool CUDASimulation::detectPureRTC(const std::shared_ptr<const ModelData>& _mode
 CUDASimulation::CUDASimulation(const std::shared_ptr<SubModelData> &submodel_desc, CUDASimulation *master_model)
     : Simulation(submodel_desc, master_model)
     , step_count(0)
+    , profiler_events(profiler)
+    , device_memory(master_model->device_memory)
     , macro_env(*submodel_desc->submodel->environment, *this)
     , run_log(std::make_unique<RunLog>())
     , streams(std::vector<cudaStream_t>())
@@ -206,6 +216,7 @@ CUDASimulation::~CUDASimulation() {
     // Destroy streams, potentially unsafe in a destructor as it will invoke cuda commands.
     // Do this once to re-use existing streams rather than per-step.
     this->destroyStreams();
+    profiler_events.free();
 
     // We must explicitly delete all cuda members before we cuda device reset
     agent_map.clear();
@@ -216,6 +227,8 @@ CUDASimulation::~CUDASimulation() {
 #ifdef VISUALISATION
     visualisation.reset();
 #endif
+    // Release buffers retained by the memory pool
+    device_memory->trim();
     // If we are the last instance to destruct
     // This doesn't really play nicely if we are passing multi-device CUDASimulations between threads!
     // I think this exists to prevent curve getting left with dead items when exceptions are thrown during the test suite.
@@ -242,13 +255,20 @@ void CUDASimulation::initFunctions() {
     NVTX_RANGE("CUDASimulation::initFunctions");
     std::unique_ptr<util::detail::Timer> initFunctionsTimer(new util::detail::SteadyClockTimer());
     initFunctionsTimer->start();
+    util::detail::Profiler::Scope profile_scope(profiler, "init_functions");
+    util::detail::Tracer::Scope trace_scope("init_functions");
+    unsigned int fnIndex = 0;
 
     // Execute normal init functions
     for (auto &initFn : model->initFunctions) {
+        util::detail::Tracer::Scope trace_scope("host_function", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "host_function", fnIndex++);
         initFn(this->host_api.get());
     }
     // Execute init function callbacks (python)
     for (auto &initFn : model->initFunctionCallbacks) {
+        util::detail::Tracer::Scope trace_scope("host_function", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "host_function", fnIndex++);
         initFn->run(this->host_api.get());
     }
     // Check if host agent creation was used in init functions
@@ -272,13 +292,20 @@ void CUDASimulation::exitFunctions() {
     NVTX_RANGE("CUDASimulation::exitFunctions");
     std::unique_ptr<util::detail::Timer> exitFunctionsTimer(new util::detail::SteadyClockTimer());
     exitFunctionsTimer->start();
+    util::detail::Profiler::Scope profile_scope(profiler, "exit_functions");
+    util::detail::Tracer::Scope trace_scope("exit_functions");
+    unsigned int fnIndex = 0;
 
     // Execute exit functions
     for (auto &exitFn : model->exitFunctions) {
+        util::detail::Tracer::Scope trace_scope("host_function", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "host_function", fnIndex++);
         exitFn(this->host_api.get());
     }
     // Execute any exit functions from swig/python
     for (auto &exitFn : model->exitFunctionCallbacks) {
+        util::detail::Tracer::Scope trace_scope("host_function", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "host_function", fnIndex++);
         exitFn->run(this->host_api.get());
     }
 
@@ -305,78 +332,54 @@ template <typename T> struct Dims {
 };
 }
 
-__global__ void calculateSpatialHashFloat3(float* xyz, unsigned int* binIndex, detail::Dims<float> envMin, detail::Dims<float> envWidth, detail::Dims<unsigned int> gridDim, unsigned int threadCount) {
+__global__ void calculateSpatialHashFloat3(float* xyz, unsigned int* binIndex, detail::Dims<float> envMin, detail::Dims<float> envWidth, detail::Dims<unsigned int> gridDim, SpatialSortOrder order, unsigned int threadCount) {
     const unsigned int TID = blockIdx.x * blockDim.x + threadIdx.x;
     if (TID < threadCount) {
         // Compute hash (effectivley an index for to a bin within the partitioning grid in this case)
-        int gridPos[3] = {
+        const int gridPos[3] = {
             static_cast<int>(floorf(((xyz[TID * 3 + 0] - envMin.x) / envWidth.x) * gridDim.x)),
             static_cast<int>(floorf(((xyz[TID * 3 + 1] - envMin.y) / envWidth.y) * gridDim.y)),
             static_cast<int>(floorf(((xyz[TID * 3 + 2] - envMin.z) / envWidth.z) * gridDim.z))
         };
+        const unsigned int dims[3] = {gridDim.x, gridDim.y, gridDim.z};
 
-        // Compute and set the bin index
-        unsigned int bindex;
-
-        bindex = (unsigned int)(
-            (gridPos[2] * gridDim.x * gridDim.y +   // z
-                (gridPos[1] * gridDim.x) +              // y
-                gridPos[0]));                           // x
-
-        binIndex[TID] = bindex;
+        // Compute and set the sort key of the bin
+        binIndex[TID] = util::detail::space_filling_curve::key<3, unsigned int>(order, gridPos, dims);
     }
 }
-__global__ void calculateSpatialHashFloat2(float* xy, unsigned int* binIndex, detail::Dims<float> envMin, detail::Dims<float> envWidth, detail::Dims<unsigned int> gridDim, unsigned int threadCount) {
+__global__ void calculateSpatialHashFloat2(float* xy, unsigned int* binIndex, detail::Dims<float> envMin, detail::Dims<float> envWidth, detail::Dims<unsigned int> gridDim, SpatialSortOrder order, unsigned int threadCount) {
     const unsigned int TID = blockIdx.x * blockDim.x + threadIdx.x;
     if (TID < threadCount) {
         // Compute hash (effectivley an index for to a bin within the partitioning grid in this case)
-        int gridPos[3] = {
+        const int gridPos[2] = {
             static_cast<int>(floorf(((xy[TID * 2 + 0] - envMin.x) / envWidth.x) * gridDim.x)),
-            static_cast<int>(floorf(((xy[TID * 2 + 1] - envMin.y) / envWidth.y) * gridDim.y)),
-            0
+            static_cast<int>(floorf(((xy[TID * 2 + 1] - envMin.y) / envWidth.y) * gridDim.y))
         };
+        const unsigned int dims[2] = {gridDim.x, gridDim.y};
 
-        // Compute and set the bin index
-        unsigned int bindex;
-
-        bindex = (unsigned int)(
-            (gridPos[1] * gridDim.x) +              // y
-            gridPos[0]);                            // x
-
-        binIndex[TID] = bindex;
+        // Compute and set the sort key of the bin
+        binIndex[TID] = util::detail::space_filling_curve::key<2, unsigned int>(order, gridPos, dims);
     }
 }
-__global__ void calculateSpatialHash(float* x, float* y, float* z, unsigned int* binIndex, detail::Dims<float> envMin, detail::Dims<float> envWidth, detail::Dims<unsigned int> gridDim, unsigned int threadCount) {
+__global__ void calculateSpatialHash(float* x, float* y, float* z, unsigned int* binIndex, detail::Dims<float> envMin, detail::Dims<float> envWidth, detail::Dims<unsigned int> gridDim, SpatialSortOrder order, unsigned int threadCount) {
     const unsigned int TID = blockIdx.x * blockDim.x + threadIdx.x;
     if (TID < threadCount) {
         // Compute hash (effectivley an index for to a bin within the partitioning grid in this case)
-        int gridPos[3] = {
+        const int gridPos[3] = {
             static_cast<int>(floorf(((x[TID]-envMin.x) / envWidth.x)*gridDim.x)),
             static_cast<int>(floorf(((y[TID]-envMin.y) / envWidth.y)*gridDim.y)),
-            0
+            z ? static_cast<int>(floorf(((z[TID]-envMin.z) / envWidth.z)*gridDim.z)) : 0
         };
 
-        // If 3D, set 3rd component
-        if (z) {
-            gridPos[2] = static_cast<int>(floorf(((z[TID]-envMin.z) / envWidth.z)*gridDim.z));
-        }
-
-        // Compute and set the bin index
-        unsigned int bindex;
-
+        // Compute and set the sort key of the bin
         if (z) {
-            bindex = (unsigned int)(
-            (gridPos[2] * gridDim.x * gridDim.y +   // z
-            (gridPos[1] * gridDim.x) +              // y
-            gridPos[0]));                           // x
-
+            const unsigned int dims[3] = {gridDim.x, gridDim.y, gridDim.z};
+            binIndex[TID] = util::detail::space_filling_curve::key<3, unsigned int>(order, gridPos, dims);
         } else {
-            bindex = (unsigned int)(
-            (gridPos[1] * gridDim.x) +              // y
-            gridPos[0]);                            // x
+            const int gridPos2[2] = {gridPos[0], gridPos[1]};
+            const unsigned int dims[2] = {gridDim.x, gridDim.y};
+            binIndex[TID] = util::detail::space_filling_curve::key<2, unsigned int>(order, gridPos2, dims);
         }
-
-        binIndex[TID] = bindex;
     }
 }
 
@@ -517,6 +520,7 @@ void CUDASimulation::spatialSortAgent(const std::string& funcName, const std::st
             envMin,
             envWidth,
             gridDim,
+            cudaAgentData.sortOrder,
             state_list_size);
     } else if (xyPtr) {
         calculateSpatialHashFloat2<<<gridSize, blockSize, sm_size, this->getStream(streamIdx)>>>(reinterpret_cast<float*>(xyPtr),
@@ -524,6 +528,7 @@ void CUDASimulation::spatialSortAgent(const std::string& funcName, const std::st
             envMin,
             envWidth,
             gridDim,
+            cudaAgentData.sortOrder,
             state_list_size);
     } else {
         calculateSpatialHash<<<gridSize, blockSize, sm_size, this->getStream(streamIdx)>>>(reinterpret_cast<float*>(xPtr),
@@ -533,6 +538,7 @@ void CUDASimulation::spatialSortAgent(const std::string& funcName, const std::st
             envMin,
             envWidth,
             gridDim,
+            cudaAgentData.sortOrder,
             state_list_size);
     }
     gpuErrchkLaunch();
@@ -549,6 +555,9 @@ bool CUDASimulation::step() {
     // Time the individual step, using a CUDAEventTimer if possible, else a steadyClockTimer.
     std::unique_ptr<util::detail::Timer> stepTimer = getDriverAppropriateTimer();
     stepTimer->start();
+    profiler.setEnabled(getSimulationConfig().profile);
+    util::detail::Profiler::Scope profile_scope(profiler, "step");
+    util::detail::Tracer::Scope trace_scope("step", step_count);
 
     // Init any unset agent IDs
     this->assignAgentIDs();
@@ -573,7 +582,13 @@ bool CUDASimulation::step() {
     unsigned int layerIndex = 0;
     for (auto& layer : model->layers) {
         // Execute the individual layer
-        stepLayer(layer, layerIndex);
+        try {
+            stepLayer(layer, layerIndex);
+        } catch (...) {
+            // Device regions left pending by the failed layer must not be resolved by a later layer
+            profiler_events.discard();
+            throw;
+        }
         // Increment counter
         ++layerIndex;
     }
@@ -603,14 +618,23 @@ bool CUDASimulation::step() {
 
 void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const unsigned int layerIndex) {
     NVTX_RANGE(std::string("stepLayer " + std::to_string(layerIndex)).c_str());
+    util::detail::Profiler::Scope profile_scope(profiler, "layer", layer->name, layerIndex);
+    util::detail::Tracer::Scope trace_scope("layer", layer->name, "", static_cast<int>(layerIndex));
 
     std::string message_name;
 
     // If the layer contains a sub model, it can only execute the sub model.
     if (layer->sub_model) {
         auto &sm = submodel_map.at(layer->sub_model->name);
+        util::detail::Profiler::Scope submodel_scope(profiler, "submodel", layer->sub_model->name);
+        util::detail::Tracer::Scope submodel_trace_scope("submodel", layer->sub_model->name, "", static_cast<int>(layerIndex));
+        sm->SimulationConfig().profile = getSimulationConfig().profile;
         sm->resetStepCounter();
         sm->simulate();
+        // Nest the submodel's regions within this layer
+        if (profiler.isEnabled()) {
+            profiler.merge(sm->profiler.getProfile());
+        }
         sm->reset(true);
         // Next layer, this layer cannot also contain agent functions
         // Ensure syncrhonisation has occured.
@@ -663,7 +687,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                 std::string func_name = func_des->name + "_condition";
                 auto &rtc_header = cuda_agent.getRTCHeader(func_name);
                 // Sync EnvManager's RTC cache with RTC header's cache
-                rtc_header.updateEnvCache(singletons->environment.getRTCCache(instance_id));
+                rtc_header.updateEnvCache(singletons->environment.getRTCCache(instance_id, this->getStream(0)));
                 // Push RTC header's cache to device
                 rtc_header.updateDevice(cuda_agent.getRTCInstantiation(func_name));
             }
@@ -675,13 +699,12 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
 
     // If any condition kernel needs to be executed, do so, by checking the number of threads from before.
     if (totalThreads > 0) {
-        auto env_shared_lock = this->singletons->environment.getSharedLock();
-        auto env_device_lock = this->singletons->environment.getDeviceSharedLock();
         if (!has_rtc_func_cond) {
-            this->singletons->environment.updateDevice(instance_id);
+            // Environment copies are issued to the first stream, the other streams must not launch until they have completed
+            if (this->singletons->environment.updateDevice(instance_id, this->getStream(0)) && streamIdx > 1) {
+                gpuErrchk(cudaStreamSynchronize(this->getStream(0)));
+            }
             this->singletons->curve.updateDevice();
-
-            // this->synchronizeAllStreams();  // Not required, the above is snchronizing.
         }
 
         // Ensure RandomManager is the correct size to accommodate all threads to be launched
@@ -708,6 +731,8 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                     ++streamIdx;
                     continue;
                 }
+                util::detail::CUDAEventProfiler::Scope condition_scope(profiler_events, this->getStream(streamIdx), "condition", func_name, agent_name);
+                util::detail::Tracer::Scope condition_trace_scope("condition", func_name, agent_name, static_cast<int>(layerIndex), static_cast<int>(streamIdx));
 
                 int blockSize = 0;  // The launch configurator returned block size
                 int minGridSize = 0;  // The minimum grid size needed to achieve the // maximum occupancy for a full device // launch
@@ -773,11 +798,9 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             }
         }
 
-        // Ensure that each condition function has finished before unlocking the environment
-        // Potentially there might be performance gains within a model by moving this until after the unmapping, although this may block other threads
+        // Ensure that each condition function has finished before unmapping
         this->synchronizeAllStreams();
-        env_shared_lock.unlock();
-        env_device_lock.unlock();
+        profiler_events.resolve();
     }
 
     // Track stream index
@@ -806,6 +829,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             this->singletons->exception.checkError("condition " + func_des->name, streamIdx, this->getStream(streamIdx));
 #endif
             // Process agent function condition
+            util::detail::Profiler::Scope scatter_scope(profiler, "condition_scatter", func_des->name, func_agent->name);
             cuda_agent.processFunctionCondition(*func_des, this->singletons->scatter, streamIdx, this->getStream(streamIdx));
             // Increment the stream tracker.
             ++streamIdx;
@@ -838,7 +862,11 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             std::string inpMessage_name = im->name;
             CUDAMessage& cuda_message = getCUDAMessage(inpMessage_name);
             // Construct PBM here if required!!
-            cuda_message.buildIndex(this->singletons->scatter, streamIdx, this->getStream(streamIdx));  // This is synchronous.
+            {
+                util::detail::Profiler::Scope build_scope(profiler, "buildIndex", inpMessage_name);
+                util::detail::Tracer::Scope build_trace_scope("buildIndex", inpMessage_name, "", static_cast<int>(layerIndex), static_cast<int>(streamIdx));
+                cuda_message.buildIndex(this->singletons->scatter, streamIdx, this->getStream(streamIdx));  // This is synchronous.
+            }
             // Map variables after, as index building can swap arrays
             cuda_message.mapReadRuntimeVariables(*func_des, cuda_agent, instance_id);
         }
@@ -880,7 +908,7 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             has_rtc_func = true;
             auto& rtc_header = cuda_agent.getRTCHeader(func_des->name);
             // Sync EnvManager's RTC cache with RTC header's cache
-            rtc_header.updateEnvCache(singletons->environment.getRTCCache(instance_id));
+            rtc_header.updateEnvCache(singletons->environment.getRTCCache(instance_id, this->getStream(0)));
             // Push RTC header's cache to device
             rtc_header.updateDevice(cuda_agent.getRTCInstantiation(func_des->name));
         }
@@ -892,12 +920,12 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
 
     // If any condition kernel needs to be executed, do so, by checking the number of threads from before.
     if (totalThreads > 0) {
-        auto env_shared_lock = this->singletons->environment.getSharedLock();
-        auto env_device_lock = this->singletons->environment.getDeviceSharedLock();
         if (!has_rtc_func) {
-            this->singletons->environment.updateDevice(instance_id);
+            // Environment copies are issued to the first stream, the other streams must not launch until they have completed
+            if (this->singletons->environment.updateDevice(instance_id, this->getStream(0)) && streamIdx > 1) {
+                gpuErrchk(cudaStreamSynchronize(this->getStream(0)));
+            }
             this->singletons->curve.updateDevice();
-            this->synchronizeAllStreams();  // This is not strictly required as updateDevice is synchronous.
         }
 
         // Ensure RandomManager is the correct size to accommodate all threads to be launched
@@ -960,6 +988,8 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
                 ++streamIdx;
                 continue;
             }
+            util::detail::CUDAEventProfiler::Scope function_scope(profiler_events, this->getStream(streamIdx), "function", func_name, agent_name);
+            util::detail::Tracer::Scope function_trace_scope("function", func_name, agent_name, static_cast<int>(layerIndex), static_cast<int>(streamIdx));
 
             int blockSize = 0;  // The launch configurator returned block size
             int minGridSize = 0;  // The minimum grid size needed to achieve the // maximum occupancy for a full device // launch
@@ -1037,10 +1067,9 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
             ++streamIdx;
         }
 
-        // Ensure that each stream of work has finished before releasing the environment lock.
+        // Ensure that each stream of work has finished before unmapping
         this->synchronizeAllStreams();
-        env_shared_lock.unlock();
-        env_device_lock.unlock();
+        profiler_events.resolve();
     }
 
     streamIdx = 0;
@@ -1052,6 +1081,8 @@ void CUDASimulation::stepLayer(const std::shared_ptr<LayerData>& layer, const un
         }
         NVTX_RANGE(std::string("unmap" + func_agent->name + "::" + func_des->name).c_str());
         CUDAAgent& cuda_agent = getCUDAAgent(func_agent->name);
+        // Message output, agent death, state transition and agent output
+        util::detail::Profiler::Scope scatter_scope(profiler, "scatter", func_des->name, func_agent->name);
 
         const unsigned int state_list_size = cuda_agent.getStateSize(func_des->initial_state);
         // If agent function wasn't executed, these are redundant
@@ -1130,13 +1161,18 @@ void CUDASimulation::layerHostFunctions(const std::shared_ptr<LayerData>& layer,
     // Execute all host functions attached to layer
     // TODO: Concurrency?
     assert(host_api);
+    unsigned int fnIndex = 0;
     for (auto &stepFn : layer->host_functions) {
         NVTX_RANGE("hostFunc");
+        util::detail::Tracer::Scope trace_scope("host_function", fnIndex, static_cast<int>(layerIndex));
+        util::detail::Profiler::Scope fn_scope(profiler, "host_function", fnIndex++);
         stepFn(this->host_api.get());
     }
     // Execute all host function callbacks attached to layer
     for (auto &stepFn : layer->host_functions_callbacks) {
         NVTX_RANGE("hostFunc_swig");
+        util::detail::Tracer::Scope trace_scope("host_function", fnIndex, static_cast<int>(layerIndex));
+        util::detail::Profiler::Scope fn_scope(profiler, "host_function", fnIndex++);
         stepFn->run(this->host_api.get());
     }
     // If we have host layer functions, we might have host agent creation
@@ -1152,14 +1188,19 @@ void CUDASimulation::layerHostFunctions(const std::shared_ptr<LayerData>& layer,
 
 void CUDASimulation::stepStepFunctions() {
     NVTX_RANGE("CUDASimulation::step::StepFunctions");
+    unsigned int fnIndex = 0;
     // Execute step functions
     for (auto &stepFn : model->stepFunctions) {
         NVTX_RANGE("stepFunc");
+        util::detail::Tracer::Scope trace_scope("step_function", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "step_function", fnIndex++);
         stepFn(this->host_api.get());
     }
     // Execute step function callbacks
     for (auto &stepFn : model->stepFunctionCallbacks) {
         NVTX_RANGE("stepFunc_swig");
+        util::detail::Tracer::Scope trace_scope("step_function", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "step_function", fnIndex++);
         stepFn->run(this->host_api.get());
     }
     // If we have step functions, we might have host agent creation
@@ -1177,9 +1218,12 @@ bool CUDASimulation::stepExitConditions() {
     // Track if any exit conditions were successful. Use this to control return code and skipsteps.
     // early returning makes timing/stepCounter logic more complicated.
     bool exitConditionExit = false;
+    unsigned int fnIndex = 0;
 
     // Execute exit conditions
     for (auto &exitCdns : model->exitConditions) {
+        util::detail::Tracer::Scope trace_scope("exit_condition", fnIndex);
+        util::detail::Profiler::Scope fn_scope(profiler, "exit_condition", fnIndex++);
         if (exitCdns(this->host_api.get()) == EXIT) {
             #ifdef VISUALISATION
                 if (visualisation) {
@@ -1194,6 +1238,8 @@ bool CUDASimulation::stepExitConditions() {
     // Execute exit condition callbacks
     if (!exitConditionExit) {
         for (auto &exitCdns : model->exitConditionCallbacks) {
+            util::detail::Tracer::Scope trace_scope("exit_condition", fnIndex);
+            util::detail::Profiler::Scope fn_scope(profiler, "exit_condition", fnIndex++);
             if (exitCdns->run(this->host_api.get()) == EXIT) {
                 #ifdef VISUALISATION
                 if (visualisation) {
@@ -1224,6 +1270,9 @@ bool CUDASimulation::stepExitConditions() {
 
 void CUDASimulation::simulate() {
     NVTX_RANGE("CUDASimulation::simulate");
+    // Record a trace, unless one is already being recorded (e.g. by an ensemble or parent model)
+    util::detail::Tracer::Session trace_session(getSimulationConfig().trace_file, getSimulationConfig().trace_flush_interval);
+    util::detail::Tracer::Scope trace_scope("simulate", submodel ? submodel->name : model->name);
 
     // Ensure there is work to do.
     if (agent_map.size() == 0) {
@@ -1259,13 +1308,27 @@ void CUDASimulation::simulate() {
     if (getSimulationConfig().steps > 0) {
         this->elapsedSecondsPerStep.reserve(getSimulationConfig().steps);
     }
+    this->profiler.reset();
+    this->profiler.setEnabled(getSimulationConfig().profile);
 
-    // Execute init functions
-    this->initFunctions();
+    // A run resumed from a checkpoint has already executed init functions, and retains the restored step log
+    const bool resume = resume_from_checkpoint;
+    resume_from_checkpoint = false;
+    if (!resume) {
+        // Execute init functions
+        this->initFunctions();
+    }
 
     // Reset and log initial state to step log 0
+    std::list<StepLogFrame> restored_step_log;
+    if (resume)
+        std::swap(restored_step_log, run_log->step);
     resetLog();
-    processStepLog(this->elapsedSecondsRTCInitialisation + this->elapsedSecondsInitFunctions);
+    openStepLogStream(step_log_config && step_log_config->log_timing);
+    if (resume)
+        std::swap(restored_step_log, run_log->step);
+    else
+        processStepLog(this->elapsedSecondsRTCInitialisation + this->elapsedSecondsInitFunctions);
 
     #ifdef VISUALISATION
     // Pre step-loop visualisation update
@@ -1275,9 +1338,10 @@ void CUDASimulation::simulate() {
     #endif
 
     // Run the required number of simulation steps.
-    for (unsigned int i = 0; getSimulationConfig().steps == 0 ? true : i < getSimulationConfig().steps; i++) {
+    for (unsigned int i = resume ? step_count : 0; getSimulationConfig().steps == 0 ? true : i < getSimulationConfig().steps; i++) {
         // Run the step
         bool continueSimulation = step();
+        processCheckpoint(step_count);
         if (!continueSimulation) {
             break;
         }
@@ -1309,9 +1373,11 @@ void CUDASimulation::simulate() {
         fprintf(stdout, "Total Processing time: %.6f s\n", elapsedSecondsSimulation);
     }
     processExitLog();
+    run_log->profile = profiler.getProfile();
+    waitForCheckpoint();
 
     // Export logs
-    if (!SimulationConfig().step_log_file.empty())
+    if (!closeStepLogStream() && !SimulationConfig().step_log_file.empty())
         exportLog(SimulationConfig().step_log_file, true, false, step_log_config && step_log_config->log_timing, false);
     if (!SimulationConfig().exit_log_file.empty())
         exportLog(SimulationConfig().exit_log_file, false, true, false, exit_log_config && exit_log_config->log_timing);
@@ -1353,10 +1419,12 @@ void CUDASimulation::reset(bool submodelReset) {
     if (singletonsInitialised) {
         // Reset environment properties
         singletons->environment.resetModel(instance_id, *model->environment);
+        applyEnvironmentOverrides();
 
-        // Reseed random, unless performing submodel reset
+        // Reseed random and zero macro properties, unless performing submodel reset
         if (!submodelReset) {
             singletons->rng.reseed(getSimulationConfig().random_seed);
+            macro_env.reset();
         }
     }
 
@@ -1367,9 +1435,11 @@ void CUDASimulation::reset(bool submodelReset) {
             a.second->cullUnmappedStates();
         }
     } else {
+        // Culling all agents also resets the agent ID counters, so that IDs are assigned as they would be by a new simulation
         for (auto &a : agent_map) {
             a.second->cullAllStates();
         }
+        agent_ids_have_init = false;
     }
 
     // Cull messagelists
@@ -1387,8 +1457,11 @@ void CUDASimulation::reset(bool submodelReset) {
     }
 
     // Reset any timing data.
+    // RTC is only initialised once, so it does not contribute to the timing of subsequent runs
     this->elapsedSecondsSimulation = 0.f;
+    this->elapsedSecondsRTCInitialisation = 0.;
     this->elapsedSecondsPerStep.clear();
+    this->profiler.reset();
 }
 
 void CUDASimulation::setPopulationData(AgentVector& population, const std::string& state_name) {
@@ -1554,6 +1627,10 @@ void CUDASimulation::applyConfig_derived() {
         // Calling apply config a second time would reinit GPU, which might clear existing gpu allocations etc
         sm.second->CUDAConfig().device_id = config.device_id;
     }
+    // Submodels share the memory pool, so this also applies to them
+    util::detail::PoolMemoryResource::ShrinkPolicy pool_policy = device_memory->getShrinkPolicy();
+    pool_policy.max_cached_bytes = config.memory_pool_max_cached_bytes;
+    device_memory->setShrinkPolicy(pool_policy);
 
     // Initialise singletons once a device has been selected.
     initialiseSingletons();
@@ -1630,7 +1707,7 @@ void CUDASimulation::initialiseSingletons() {
         singletons->rng.reseed(getSimulationConfig().random_seed);
 
         // Pass created RandomManager to host api
-        host_api = std::make_unique<HostAPI>(*this, singletons->rng, singletons->scatter, agentOffsets, agentData, macro_env, 0, getStream(0));  // Host fns are currently all serial
+        host_api = std::make_unique<HostAPI>(*this, singletons->rng, singletons->scatter, agentOffsets, agentData, agentBatches, macro_env, 0, getStream(0));  // Host fns are currently all serial
 
         for (auto &cm : message_map) {
             cm.second->init(singletons->scatter, 0);
@@ -1644,6 +1721,7 @@ void CUDASimulation::initialiseSingletons() {
             singletons->environment.init(instance_id, *model->environment, isPureRTC, mastermodel->getInstanceID(), *submodel->subenvironment);
             macro_env.init(*submodel->subenvironment, mastermodel->macro_env);
         }
+        applyEnvironmentOverrides();
 
         // Propagate singleton init to submodels
         for (auto &sm : submodel_map) {
@@ -1677,6 +1755,7 @@ void CUDASimulation::initialiseRTC() {
     // Only do this once.
     if (!rtcInitialised) {
         NVTX_RANGE("CUDASimulation::initialiseRTC");
+        util::detail::Tracer::Scope trace_scope("initialiseRTC");
         std::unique_ptr<util::detail::Timer> rtcTimer(new util::detail::SteadyClockTimer());
         rtcTimer->start();
         // Build any RTC functions
@@ -1717,6 +1796,96 @@ void CUDASimulation::resetDerivedConfig() {
     this->config = CUDASimulation::Config();
     resetStepCounter();
 }
+void CUDASimulation::checkpoint_derived(io::Checkpoint &checkpoint) {
+    initialiseSingletons();
+    checkpoint.newSection("step_count").write<uint32_t>(step_count);
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("environment");
+        for (const auto &prop : model->environment->getPropertiesMap()) {
+            out.writeString(prop.first);
+            out.writeAny(singletons->environment.getPropertyAny(instance_id, prop.first));
+        }
+    }
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("macro_environment");
+        macro_env.checkpoint(out);
+    }
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("random");
+        singletons->rng.checkpoint(out);
+    }
+    {
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("agent_ids");
+        for (auto &a : agent_map) {
+            out.writeString(a.first);
+            out.write<id_t>(a.second->nextID(0));
+        }
+    }
+    {
+        // Messages output during a step may be read in a later step, so message lists are not necessarily empty
+        io::Checkpoint::SectionWriter out = checkpoint.newSection("messages");
+        for (auto &m : message_map) {
+            out.writeString(m.first);
+            m.second->checkpoint(out);
+        }
+    }
+    checkpointStepLog(run_log->step, checkpoint);
+}
+void CUDASimulation::restore_derived(const io::Checkpoint &checkpoint) {
+    initialiseSingletons();
+    step_count = checkpoint.getSection("step_count").read<uint32_t>();
+    {
+        // Const properties cannot change during execution, so are not restored
+        io::Checkpoint::SectionReader in = checkpoint.getSection("environment");
+        const auto &props = model->environment->getPropertiesMap();
+        while (!in.eof()) {
+            const std::string name = in.readString();
+            const util::Any value = in.readAny();
+            const auto prop = props.find(name);
+            if (prop == props.end() || prop->second.data.type != value.type || prop->second.data.length != value.length) {
+                THROW exception::InvalidInputFile("Checkpoint environment property '%s' does not match the model, "
+                    "in CUDASimulation::restore_derived()\n", name.c_str());
+            }
+            if (!prop->second.isConst) {
+                singletons->environment.setProperty(instance_id, name, value.ptr, value.length);
+            }
+        }
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("macro_environment");
+        macro_env.restore(in);
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("random");
+        singletons->rng.restore(in);
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("agent_ids");
+        while (!in.eof()) {
+            const std::string name = in.readString();
+            const id_t next_id = in.read<id_t>();
+            const auto a = agent_map.find(name);
+            if (a == agent_map.end()) {
+                THROW exception::InvalidInputFile("Checkpoint contains agent '%s' which does not match the model, "
+                    "in CUDASimulation::restore_derived()\n", name.c_str());
+            }
+            a->second->setNextID(next_id);
+        }
+    }
+    {
+        io::Checkpoint::SectionReader in = checkpoint.getSection("messages");
+        while (!in.eof()) {
+            const std::string name = in.readString();
+            const auto m = message_map.find(name);
+            if (m == message_map.end()) {
+                THROW exception::InvalidInputFile("Checkpoint contains message '%s' which does not match the model, "
+                    "in CUDASimulation::restore_derived()\n", name.c_str());
+            }
+            m->second->restore(in, singletons->scatter, 0, getStream(0));
+        }
+    }
+    run_log->step = restoreStepLog(checkpoint);
+}
 
 
 CUDASimulation::Config &CUDASimulation::CUDAConfig() {
@@ -1755,6 +1924,13 @@ void CUDASimulation::initOffsetsAndMap() {
             agent_states.emplace(state, AgentDataBuffer());
         agentData.emplace(agent.first, std::move(agent_states));
     }
+    agentBatches.clear();
+    for (const auto &agent : md.agents) {
+        AgentBatchBufferStateMap agent_states;
+        for (const auto&state : agent.second->states)
+            agent_states.emplace(state, AgentBatchBuffer());
+        agentBatches.emplace(agent.first, std::move(agent_states));
+    }
 }
 
 void CUDASimulation::processHostAgentCreation(const unsigned int &streamId) {
@@ -1800,6 +1976,18 @@ void CUDASimulation::processHostAgentCreation(const unsigned int &streamId) {
         free(t_buff);
         gpuErrchk(cudaFree(dt_buff));
     }
+    // Append batches, these are already columnar, so each variable is copied directly into the state list
+    for (auto &agent : agentBatches) {
+        for (auto &state : agent.second) {
+            if (state.second.size()) {
+                auto &cudaagent = agent_map.at(agent.first);
+                for (const auto &batch : state.second) {
+                    cudaagent->appendHostCreation(state.first, *batch, this->singletons->scatter, streamId, this->getStream(streamId));
+                }
+                state.second.clear();
+            }
+        }
+    }
 }
 
 void CUDASimulation::RTCSafeCudaMemcpyToSymbol(const void* symbol, const char* rtc_symbol_name, const void* src, size_t count, size_t offset) const {
@@ -1915,11 +2103,20 @@ void CUDASimulation::initEnvironmentMgr() {
     // Clear init
     env_init.clear();
 }
+void CUDASimulation::setEnvironmentOverrides(const std::unordered_map<std::string, util::Any> &overrides) {
+    env_overrides = overrides;
+}
+void CUDASimulation::applyEnvironmentOverrides() {
+    for (const auto &ovrd : env_overrides) {
+        singletons->environment.setPropertyAny(instance_id, ovrd.first, ovrd.second);
+    }
+}
 void CUDASimulation::resetLog() {
     // Track previous device id, so we can avoid costly request for device properties if not required
     static int previous_device_id = -1;
     run_log->step.clear();
     run_log->exit = ExitLogFrame();
+    run_log->profile.clear();
     run_log->random_seed = SimulationConfig().random_seed;
     run_log->step_log_frequency = step_log_config ? step_log_config->frequency : 0;
     if (run_log->performance_specs.device_name.empty() || CUDAConfig().device_id != previous_device_id) {
@@ -1954,24 +2151,45 @@ void CUDASimulation::processStepLog(const double &step_time_seconds) {
         // Create the named sub map
         const std::string &agent_name = name_state.first.first;
         const std::string &agent_state = name_state.first.second;
-        HostAgentAPI host_agent = host_api->agent(agent_name, agent_state);
+        CUDAAgent &cuda_agent = *agent_map.at(agent_name);
         auto &agent_state_log = agents_log.emplace(name_state.first, std::make_pair(std::map<LoggingConfig::NameReductionFn, util::Any>(), UINT_MAX)).first->second;
-        // Log individual variable reductions
-        for (const auto &name_reduction : *name_state.second.first) {
-            // Perform the corresponding reduction
-            auto result = name_reduction.function(host_agent, name_reduction.name);
-            // Store the result
-            agent_state_log.first.emplace(name_reduction, std::move(result));
+        // If the user has a DeviceAgentVector out, sync changes before reducing
+        std::shared_ptr<DeviceAgentVector_impl> population = cuda_agent.getPopulationVec(agent_state);
+        if (population)
+            population->syncChanges();
+        // Compute every fusable reduction (e.g. Mean, Min) of every variable in a single pass
+        const LoggingConfig::FusedReductions &fused = step_log_config->getFusedReductions(name_state.first);
+        if (!fused.plan.empty()) {
+            std::vector<const void*> buffers;
+            for (const auto &column : fused.plan.getColumns())
+                buffers.push_back(cuda_agent.getStateVariablePtr(agent_state, column.variable_name));
+            const unsigned int count = cuda_agent.getStateSize(agent_state);
+            fused.emplaceResults(fused.plan.reduceDevice(buffers, count, *device_memory, getStream(0)), agent_state_log.first);
+        }
+        // Log the remaining variable reductions individually
+        if (!fused.unfused.empty()) {
+            HostAgentAPI host_agent = host_api->agent(agent_name, agent_state);
+            for (const auto *name_reduction : fused.unfused) {
+                agent_state_log.first.emplace(*name_reduction, name_reduction->function(host_agent, *name_reduction));
+            }
         }
         // Log count of agents in state
         if (name_state.second.second) {
-            agent_state_log.second = host_api->agent(agent_name, agent_state).count();
+            agent_state_log.second = cuda_agent.getStateSize(agent_state);
         }
     }
+    // Release host copies of agent variables downloaded by reductions which are computed on the host (e.g. Quantiles)
+    for (auto &ca : agent_map) {
+        ca.second->resetPopulationVecs();
+    }
 
     // Append to step log
-    run_log->step.push_back(StepLogFrame(std::move(environment_log), std::move(agents_log), step_count));
-    run_log->step.back().step_time = step_time_seconds;
+    StepLogFrame frame(std::move(environment_log), std::move(agents_log), step_count);
+    frame.step_time = step_time_seconds;
+    // If the step log is being streamed to file, the frame is only retained if required
+    if (streamStepLog(frame)) {
+        run_log->step.push_back(std::move(frame));
+    }
 }
 
 void CUDASimulation::processExitLog() {
@@ -1988,20 +2206,37 @@ void CUDASimulation::processExitLog() {
         // Create the named sub map
         const std::string &agent_name = name_state.first.first;
         const std::string &agent_state = name_state.first.second;
-        HostAgentAPI host_agent = host_api->agent(agent_name, agent_state);
+        CUDAAgent &cuda_agent = *agent_map.at(agent_name);
         auto &agent_state_log = agents_log.emplace(name_state.first, std::make_pair(std::map<LoggingConfig::NameReductionFn, util::Any>(), UINT_MAX)).first->second;
-        // Log individual variable reductions
-        for (const auto &name_reduction : *name_state.second.first) {
-            // Perform the corresponding reduction
-            auto result = name_reduction.function(host_agent, name_reduction.name);
-            // Store the result
-            agent_state_log.first.emplace(name_reduction, std::move(result));
+        // If the user has a DeviceAgentVector out, sync changes before reducing
+        std::shared_ptr<DeviceAgentVector_impl> population = cuda_agent.getPopulationVec(agent_state);
+        if (population)
+            population->syncChanges();
+        // Compute every fusable reduction (e.g. Mean, Min) of every variable in a single pass
+        const LoggingConfig::FusedReductions &fused = exit_log_config->getFusedReductions(name_state.first);
+        if (!fused.plan.empty()) {
+            std::vector<const void*> buffers;
+            for (const auto &column : fused.plan.getColumns())
+                buffers.push_back(cuda_agent.getStateVariablePtr(agent_state, column.variable_name));
+            const unsigned int count = cuda_agent.getStateSize(agent_state);
+            fused.emplaceResults(fused.plan.reduceDevice(buffers, count, *device_memory, getStream(0)), agent_state_log.first);
+        }
+        // Log the remaining variable reductions individually
+        if (!fused.unfused.empty()) {
+            HostAgentAPI host_agent = host_api->agent(agent_name, agent_state);
+            for (const auto *name_reduction : fused.unfused) {
+                agent_state_log.first.emplace(*name_reduction, name_reduction->function(host_agent, *name_reduction));
+            }
         }
         // Log count of agents in state
         if (name_state.second.second) {
-            agent_state_log.second = host_api->agent(agent_name, agent_state).count();
+            agent_state_log.second = cuda_agent.getStateSize(agent_state);
         }
     }
+    // Release host copies of agent variables downloaded by reductions which are computed on the host (e.g. Quantiles)
+    for (auto &ca : agent_map) {
+        ca.second->resetPopulationVecs();
+    }
 
     // Set Log
     run_log->exit = ExitLogFrame(std::move(environment_log), std::move(agents_log), step_count);
@@ -2014,6 +2249,14 @@ void CUDASimulation::processExitLog() {
 const RunLog &CUDASimulation::getRunLog() const {
     return *run_log;
 }
+std::map<std::string, util::Any> CUDASimulation::getEnvironmentProperties() const {
+    std::map<std::string, util::Any> rtn;
+    const EnvironmentManager &env_mgr = EnvironmentManager::getInstance();
+    for (const auto &prop : env_mgr.getPropertiesMap(instance_id)) {
+        rtn.emplace(prop.first, env_mgr.getPropertyAny(instance_id, prop.first));
+    }
+    return rtn;
+}
 
 void CUDASimulation::createStreams(const unsigned int nStreams) {
     // There should always be atleast 1 stream, as some tests require the 0th stream even when there is no concurrent work to be done.
@@ -0,0 +1,152 @@
+#include "flamegpu/io/BinaryStateReader.h"
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/io/detail/BinaryStateFormat.h"
+#include "flamegpu/pop/AgentVector.h"
+#include "flamegpu/util/StringPair.h"
+#include "flamegpu/util/detail/MemoryMappedFile.h"
+
+namespace flamegpu {
+namespace io {
+
+BinaryStateReader::BinaryStateReader(
+    const std::string &model_name,
+    const std::unordered_map<std::string, EnvironmentDescription::PropData> &env_desc,
+    util::StringUint32PairUnorderedMap<util::Any> &env_init,
+    util::StringPairUnorderedMap<std::shared_ptr<AgentVector>> &model_state,
+    const std::string &input,
+    Simulation *sim_instance)
+    : StateReader(model_name, env_desc, env_init, model_state, input, sim_instance) {}
+
+namespace {
+/**
+ * Reads a column record from the layout section, validates it against the expected layout
+ * and returns a pointer to the column's data within the mapped file
+ */
+const char *readColumn(detail::binary_state::LayoutReader &layout, const util::detail::MemoryMappedFile &file, uint64_t data_begin,
+    const detail::binary_state::ColumnLayoutMap &expected, const uint64_t count, const std::string &file_path, std::string &name) {
+    name = layout.readString();
+    detail::binary_state::ColumnLayout column;
+    column.type = layout.read<uint32_t>();
+    column.type_size = layout.read<uint32_t>();
+    column.elements = layout.read<uint32_t>();
+    const uint64_t offset = layout.read<uint64_t>();
+    const auto it = expected.find(name);
+    if (it == expected.end() || it->second.type != column.type || it->second.type_size != column.type_size || it->second.elements != column.elements) {
+        THROW exception::InvalidInputFile("Binary state file '%s' contains unexpected property or variable '%s', "
+            "in BinaryStateReader::parse()\n", file_path.c_str(), name.c_str());
+    }
+    const uint64_t length = count * column.type_size * column.elements;
+    // Compared against the remaining bytes, so that a corrupt offset or length cannot overflow the bounds check
+    if (data_begin > file.size() || offset > file.size() - data_begin || length > file.size() - data_begin - offset) {
+        THROW exception::InvalidInputFile("Binary state file '%s' is truncated or corrupt, "
+            "in BinaryStateReader::parse()\n", file_path.c_str());
+    }
+    return file.data() + data_begin + offset;
+}
+}  // namespace
+
+int BinaryStateReader::parse() {
+    using namespace detail::binary_state;  // NOLINT(build/namespaces)
+    const util::detail::MemoryMappedFile file(inputFile);
+    FileHeader header;
+    if (file.size() < sizeof(FileHeader)) {
+        THROW exception::InvalidInputFile("Binary state file '%s' is truncated or corrupt, "
+            "in BinaryStateReader::parse()\n", inputFile.c_str());
+    }
+    memcpy(&header, file.data(), sizeof(FileHeader));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        THROW exception::InvalidInputFile("File '%s' is not a binary state file, "
+            "in BinaryStateReader::parse()\n", inputFile.c_str());
+    }
+    if (header.version != VERSION) {
+        THROW exception::InvalidInputFile("Binary state file '%s' has version %u, expected version %u, "
+            "in BinaryStateReader::parse()\n", inputFile.c_str(), header.version, VERSION);
+    }
+    if (header.byte_order_mark != BYTE_ORDER_MARK) {
+        THROW exception::InvalidInputFile("Binary state file '%s' was written by a host with a different byte order, "
+            "in BinaryStateReader::parse()\n", inputFile.c_str());
+    }
+    // Build the expected layout, and confirm the file was produced by the same model
+    ColumnLayoutMap env_layout;
+    for (const auto &p : env_desc) {
+        env_layout.emplace(p.first, ColumnLayout{toTypeCode(p.second.data.type),
+            static_cast<uint32_t>(p.second.data.length / p.second.data.elements), p.second.data.elements});
+    }
+    std::map<util::StringPair, ColumnLayoutMap> pop_layout;
+    for (const auto &agent : model_state) {
+        ColumnLayoutMap &columns = pop_layout[agent.first];
+        for (const auto &var : agent.second->getVariableMetaData()) {
+            columns.emplace(var.first, ColumnLayout{toTypeCode(var.second.type), static_cast<uint32_t>(var.second.type_size), var.second.elements});
+        }
+    }
+    if (header.model_hash != hashLayout(model_name, env_layout, pop_layout)) {
+        THROW exception::InvalidInputFile("Binary state file '%s' was not produced by model '%s', or the model's layout has changed, "
+            "in BinaryStateReader::parse()\n", inputFile.c_str(), model_name.c_str());
+    }
+    if (header.layout_bytes > file.size() - sizeof(FileHeader)) {
+        THROW exception::InvalidInputFile("Binary state file '%s' is truncated or corrupt, "
+            "in BinaryStateReader::parse()\n", inputFile.c_str());
+    }
+    LayoutReader layout(file.data() + sizeof(FileHeader), static_cast<size_t>(header.layout_bytes), inputFile);
+    const uint64_t data_begin = alignOffset(sizeof(FileHeader) + header.layout_bytes);
+    std::string name;
+    // Environment properties
+    for (uint32_t i = 0; i < header.environment_count; ++i) {
+        const char *data = readColumn(layout, file, data_begin, env_layout, 1, inputFile, name);
+        const EnvironmentDescription::PropData &prop = env_desc.at(name);
+        const size_t type_size = prop.data.length / prop.data.elements;
+        for (unsigned int el = 0; el < prop.data.elements; ++el) {
+            if (!env_init.emplace(std::make_pair(name, el), util::Any(data + el * type_size, type_size, prop.data.type, 1)).second) {
+                THROW exception::InvalidInputFile("Binary state file '%s' contains environment property '%s' multiple times, "
+                    "in BinaryStateReader::parse()\n", inputFile.c_str(), name.c_str());
+            }
+        }
+    }
+    // Agent populations, each column is copied directly into the AgentVector's storage
+    for (uint32_t i = 0; i < header.population_count; ++i) {
+        const std::string agent_name = layout.readString();
+        const std::string state_name = layout.readString();
+        const uint32_t count = layout.read<uint32_t>();
+        const uint32_t column_count = layout.read<uint32_t>();
+        const auto f = model_state.find({agent_name, state_name});
+        if (f == model_state.end()) {
+            THROW exception::InvalidInputFile("Binary state file '%s' contains data for agent:state combination '%s:%s' not found in model description hierarchy, "
+                "in BinaryStateReader::parse()\n", inputFile.c_str(), agent_name.c_str(), state_name.c_str());
+        }
+        AgentVector &pop = *f->second;
+        const ColumnLayoutMap &columns = pop_layout.at(f->first);
+        if (column_count != columns.size()) {
+            THROW exception::InvalidInputFile("Binary state file '%s' is truncated or corrupt, "
+                "in BinaryStateReader::parse()\n", inputFile.c_str());
+        }
+        pop._requireLength();
+        const AgentVector::size_type old_size = pop._size;
+        if (count && old_size + count > pop._capacity) {
+            // Every new element is about to be overwritten, so skip default init
+            pop.internal_resize(old_size + count, false);
+        }
+        for (uint32_t j = 0; j < column_count; ++j) {
+            const char *data = readColumn(layout, file, data_begin, columns, count, inputFile, name);
+            if (count) {
+                const ColumnLayout &column = columns.at(name);
+                const size_t variable_size = column.type_size * column.elements;
+                char *dest = static_cast<char*>(pop._data->at(name)->getDataPtr());
+                memcpy(dest + old_size * variable_size, data, count * variable_size);
+            }
+        }
+        if (count) {
+            pop._size = old_size + count;
+            pop._insert(old_size, count);
+        }
+    }
+    return 0;
+}
+
+}  // namespace io
+}  // namespace flamegpu
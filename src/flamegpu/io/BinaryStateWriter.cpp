@@ -0,0 +1,143 @@
+#include "flamegpu/io/BinaryStateWriter.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/io/detail/BinaryStateFormat.h"
+#include "flamegpu/pop/AgentVector.h"
+#include "flamegpu/sim/Simulation.h"
+#include "flamegpu/util/Any.h"
+#include "flamegpu/util/StringPair.h"
+
+namespace flamegpu {
+namespace io {
+
+BinaryStateWriter::BinaryStateWriter(
+    const std::string &model_name,
+    const unsigned int &sim_instance_id,
+    const util::StringPairUnorderedMap<std::shared_ptr<AgentVector>> &model,
+    const unsigned int &iterations,
+    const std::string &output_file,
+    const Simulation *_sim_instance)
+    : StateWriter(model_name, sim_instance_id, model, iterations, output_file, _sim_instance) {}
+
+namespace {
+/**
+ * Appends a value to the layout section
+ */
+template<typename T>
+void append(std::string &out, const T &value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+void appendString(std::string &out, const std::string &str) {
+    append<uint32_t>(out, static_cast<uint32_t>(str.size()));
+    out.append(str);
+}
+/**
+ * A block of data to be written to the data section
+ */
+struct DataBlock {
+    const char *data;
+    uint64_t length;
+};
+/**
+ * Appends a column record to the layout section, and allocates the column's block within the data section
+ */
+void appendColumn(std::string &out, std::vector<DataBlock> &blocks, uint64_t &data_offset,
+    const std::string &name, const detail::binary_state::ColumnLayout &column, const char *data, uint64_t length) {
+    appendString(out, name);
+    append(out, column.type);
+    append(out, column.type_size);
+    append(out, column.elements);
+    append(out, data_offset);
+    blocks.push_back({data, length});
+    data_offset = detail::binary_state::alignOffset(data_offset + length);
+}
+}  // namespace
+
+int BinaryStateWriter::writeStates(bool) {
+    using namespace detail::binary_state;  // NOLINT(build/namespaces)
+    const std::map<std::string, util::Any> env_props = sim_instance->getEnvironmentProperties();
+    // Collect the layout, ordered by name so that it matches the reader's hash
+    ColumnLayoutMap env_layout;
+    for (auto &a : env_props) {
+        const TypeCode type = toTypeCode(a.second.type);
+        if (type == Unsupported) {
+            THROW exception::UnsupportedVarType("Model contains environment property '%s' of unsupported type '%s', "
+                "in BinaryStateWriter::writeStates()\n", a.first.c_str(), a.second.type.name());
+        }
+        env_layout.emplace(a.first, ColumnLayout{type, static_cast<uint32_t>(a.second.length / a.second.elements), a.second.elements});
+    }
+    std::map<util::StringPair, ColumnLayoutMap> pop_layout;
+    std::map<util::StringPair, const AgentVector*> pops;
+    for (const auto &agent : model_state) {
+        ColumnLayoutMap &columns = pop_layout[agent.first];
+        for (const auto &var : agent.second->getVariableMetaData()) {
+            const TypeCode type = toTypeCode(var.second.type);
+            if (type == Unsupported) {
+                THROW exception::UnsupportedVarType("Agent '%s' contains variable '%s' of unsupported type '%s', "
+                    "in BinaryStateWriter::writeStates()\n", agent.first.first.c_str(), var.first.c_str(), var.second.type.name());
+            }
+            columns.emplace(var.first, ColumnLayout{type, static_cast<uint32_t>(var.second.type_size), var.second.elements});
+        }
+        pops.emplace(agent.first, agent.second.get());
+    }
+    // Build the layout section, data offsets are relative to the start of the data section
+    std::string layout;
+    std::vector<DataBlock> blocks;
+    uint64_t data_offset = 0;
+    for (const auto &e : env_layout) {
+        const util::Any &prop = env_props.at(e.first);
+        appendColumn(layout, blocks, data_offset, e.first, e.second, static_cast<const char *>(prop.ptr), prop.length);
+    }
+    for (const auto &p : pops) {
+        const AgentVector &pop = *p.second;
+        pop._requireLength();
+        pop._requireAll();
+        const uint32_t pop_size = pop._size;
+        const ColumnLayoutMap &columns = pop_layout.at(p.first);
+        appendString(layout, p.first.first);
+        appendString(layout, p.first.second);
+        append<uint32_t>(layout, pop_size);
+        append<uint32_t>(layout, static_cast<uint32_t>(columns.size()));
+        for (const auto &c : columns) {
+            const uint64_t length = static_cast<uint64_t>(pop_size) * c.second.type_size * c.second.elements;
+            const char *data = pop_size ? static_cast<const char*>(pop._data->at(c.first)->getReadOnlyDataPtr()) : nullptr;
+            appendColumn(layout, blocks, data_offset, c.first, c.second, data, length);
+        }
+    }
+    FileHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order_mark = BYTE_ORDER_MARK;
+    header.model_hash = hashLayout(model_name, env_layout, pop_layout);
+    header.environment_count = static_cast<uint32_t>(env_layout.size());
+    header.population_count = static_cast<uint32_t>(pop_layout.size());
+    header.layout_bytes = layout.size();
+    // Write the file
+    std::ofstream out(outputFile, std::ofstream::binary | std::ofstream::trunc);
+    if (!out.is_open()) {
+        THROW exception::InvalidFilePath("Unable to open file '%s' for writing, in BinaryStateWriter::writeStates()\n", outputFile.c_str());
+    }
+    const std::vector<char> padding(BLOCK_ALIGNMENT, '\0');
+    out.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+    out.write(layout.data(), layout.size());
+    const uint64_t data_begin = alignOffset(sizeof(FileHeader) + layout.size());
+    out.write(padding.data(), data_begin - sizeof(FileHeader) - layout.size());
+    for (const auto &b : blocks) {
+        if (b.length)
+            out.write(b.data, b.length);
+        out.write(padding.data(), alignOffset(b.length) - b.length);
+    }
+    out.close();
+    if (out.fail()) {
+        THROW exception::InvalidFilePath("Failed whilst writing file '%s', in BinaryStateWriter::writeStates()\n", outputFile.c_str());
+    }
+    return 0;
+}
+
+}  // namespace io
+}  // namespace flamegpu
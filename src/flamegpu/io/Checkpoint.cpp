@@ -0,0 +1,184 @@
+#include "flamegpu/io/Checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "flamegpu/io/detail/BinaryStateFormat.h"
+
+namespace flamegpu {
+namespace io {
+
+namespace {
+/**
+ * Identifies the file type, the trailing bytes are reserved
+ */
+const char MAGIC[8] = {'F', 'G', 'P', 'U', 'C', 'K', 'P', '\0'};
+/**
+ * Incremented whenever the layout changes
+ */
+const uint32_t VERSION = 1;
+/**
+ * Written in native byte order, so that files produced on a host with different endianness are detected
+ */
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+}  // namespace
+
+void Checkpoint::SectionWriter::writeAny(const util::Any &value) {
+    const uint32_t type = detail::binary_state::toTypeCode(value.type);
+    if (type == detail::binary_state::Unsupported) {
+        THROW exception::UnsupportedVarType("Values of type '%s' cannot be stored within a checkpoint, "
+            "in Checkpoint::SectionWriter::writeAny()\n", value.type.name());
+    }
+    write<uint32_t>(type);
+    write<uint32_t>(value.elements);
+    write<uint64_t>(value.length);
+    write(value.ptr, value.length);
+}
+util::Any Checkpoint::SectionReader::readAny() {
+    const uint32_t type = read<uint32_t>();
+    const uint32_t elements = read<uint32_t>();
+    const uint64_t length = read<uint64_t>();
+    require(length);
+    const std::type_index type_index = detail::binary_state::fromTypeCode(type);
+    if (type_index == std::type_index(typeid(void))) {
+        THROW exception::InvalidInputFile("Checkpoint section '%s' contains a value of unknown type %u, "
+            "in Checkpoint::SectionReader::readAny()\n", section_name.c_str(), type);
+    }
+    util::Any rtn(data.data() + pos, static_cast<size_t>(length), type_index, elements);
+    pos += static_cast<size_t>(length);
+    return rtn;
+}
+
+Checkpoint::Checkpoint(const std::string &_model_name)
+    : model_name(_model_name) { }
+
+Checkpoint::SectionWriter Checkpoint::newSection(const std::string &name) {
+    const auto it = sections.emplace(name, std::vector<char>());
+    if (!it.second) {
+        THROW exception::InvalidArgument("Checkpoint already contains a section named '%s', "
+            "in Checkpoint::newSection()\n", name.c_str());
+    }
+    return SectionWriter(it.first->second);
+}
+bool Checkpoint::hasSection(const std::string &name) const {
+    return sections.find(name) != sections.end();
+}
+Checkpoint::SectionReader Checkpoint::getSection(const std::string &name) const {
+    const auto it = sections.find(name);
+    if (it == sections.end()) {
+        THROW exception::InvalidInputFile("Checkpoint of model '%s' does not contain section '%s', "
+            "in Checkpoint::getSection()\n", model_name.c_str(), name.c_str());
+    }
+    return SectionReader(it->second, name);
+}
+
+void Checkpoint::save(const std::string &path) const {
+    std::vector<char> header;
+    SectionWriter out(header);
+    out.write(MAGIC, sizeof(MAGIC));
+    out.write<uint32_t>(VERSION);
+    out.write<uint32_t>(BYTE_ORDER_MARK);
+    out.writeString(model_name);
+    out.write<uint64_t>(sections.size());
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            THROW exception::InvalidFilePath("Unable to open checkpoint file '%s' for writing, "
+                "in Checkpoint::save()\n", tmp_path.c_str());
+        }
+        // Section data is written directly from the checkpoint, rather than copied into a single buffer
+        uint64_t hash = detail::binary_state::hashBytes(header.data(), header.size());
+        file.write(header.data(), header.size());
+        for (const auto &s : sections) {
+            std::vector<char> section_header;
+            SectionWriter section_out(section_header);
+            section_out.writeString(s.first);
+            section_out.write<uint64_t>(s.second.size());
+            hash = detail::binary_state::hashBytes(section_header.data(), section_header.size(), hash);
+            hash = detail::binary_state::hashBytes(s.second.data(), s.second.size(), hash);
+            file.write(section_header.data(), section_header.size());
+            file.write(s.second.data(), s.second.size());
+        }
+        file.write(reinterpret_cast<const char*>(&hash), sizeof(uint64_t));
+        file.close();
+        if (file.fail()) {
+            THROW exception::InvalidFilePath("Failed to write checkpoint file '%s', "
+                "in Checkpoint::save()\n", tmp_path.c_str());
+        }
+    }
+    // rename() does not replace an existing file on all platforms
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(path.c_str());
+        if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            THROW exception::InvalidFilePath("Unable to replace checkpoint file '%s', "
+                "in Checkpoint::save()\n", path.c_str());
+        }
+    }
+}
+std::shared_ptr<Checkpoint> Checkpoint::load(const std::string &path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        THROW exception::InvalidFilePath("Unable to open checkpoint file '%s' for reading, "
+            "in Checkpoint::load()\n", path.c_str());
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(MAGIC) + sizeof(uint64_t) || memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        THROW exception::InvalidInputFile("File '%s' is not a checkpoint file, "
+            "in Checkpoint::load()\n", path.c_str());
+    }
+    uint64_t stored_hash;
+    memcpy(&stored_hash, data.data() + data.size() - sizeof(uint64_t), sizeof(uint64_t));
+    data.resize(data.size() - sizeof(uint64_t));
+    if (detail::binary_state::hashBytes(data.data(), data.size()) != stored_hash) {
+        THROW exception::InvalidInputFile("Checkpoint file '%s' is truncated or corrupt, "
+            "in Checkpoint::load()\n", path.c_str());
+    }
+    SectionReader in(data, "header");
+    char magic[sizeof(MAGIC)];
+    in.read(magic, sizeof(MAGIC));
+    const uint32_t version = in.read<uint32_t>();
+    const uint32_t byte_order_mark = in.read<uint32_t>();
+    if (byte_order_mark != BYTE_ORDER_MARK) {
+        THROW exception::InvalidInputFile("Checkpoint file '%s' was written by a host with a different byte order, "
+            "in Checkpoint::load()\n", path.c_str());
+    }
+    if (version != VERSION) {
+        THROW exception::InvalidInputFile("Checkpoint file '%s' has version %u, only version %u is supported, "
+            "in Checkpoint::load()\n", path.c_str(), version, VERSION);
+    }
+    auto rtn = std::make_shared<Checkpoint>(in.readString());
+    const uint64_t section_count = in.read<uint64_t>();
+    for (uint64_t i = 0; i < section_count; ++i) {
+        const std::string name = in.readString();
+        const uint64_t length = in.read<uint64_t>();
+        std::vector<char> section(static_cast<size_t>(length));
+        in.read(section.data(), section.size());
+        rtn->sections.emplace(name, std::move(section));
+    }
+    return rtn;
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    try {
+        wait();
+    } catch (...) {
+        // Destructors must not throw
+    }
+}
+void CheckpointWriter::write(std::shared_ptr<const Checkpoint> checkpoint, const std::string &path) {
+    wait();
+    pending = std::async(std::launch::async, [checkpoint, path]() {
+        checkpoint->save(path);
+    });
+}
+void CheckpointWriter::wait() {
+    if (pending.valid()) {
+        pending.get();
+    }
+}
+
+}  // namespace io
+}  // namespace flamegpu
@@ -1,8 +1,10 @@
 #include "flamegpu/io/JSONLogger.h"
 
+#include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
+#include <climits>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -19,10 +21,13 @@ JSONLogger::JSONLogger(const std::string &outPath, bool _prettyPrint, bool _trun
     , truncateFile(_truncateFile) { }
 
 void JSONLogger::log(const RunLog &log, const RunPlan &plan, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const {
-  logCommon(log, &plan, false, logSteps, logExit, logStepTime, logExitTime);
+  logCommon(log, &plan, UINT_MAX, false, logSteps, logExit, logStepTime, logExitTime);
+}
+void JSONLogger::logRun(const RunLog &log, const RunPlan &plan, unsigned int run_index, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const {
+  logCommon(log, &plan, run_index, false, logSteps, logExit, logStepTime, logExitTime);
 }
 void JSONLogger::log(const RunLog &log, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const {
-  logCommon(log, nullptr, logConfig, logSteps, logExit, logStepTime, logExitTime);
+  logCommon(log, nullptr, UINT_MAX, logConfig, logSteps, logExit, logStepTime, logExitTime);
 }
 
 template<typename T>
@@ -154,9 +159,9 @@ void JSONLogger::writeCommonLogFrame(T &writer, const LogFrame &frame) const {
                                 writer.StartObject();
                             }
                             // Build name key for the variable
-                            writer.Key(LoggingConfig::toString(var.first.reduction));
+                            writer.Key(var.first.getKey().c_str());
                             // Log value
-                            writeAny(writer, var.second, 1);
+                            writeAny(writer, var.second, var.second.elements);
                         }
                         if (!current_variable.empty())
                             writer.EndObject();
@@ -183,10 +188,14 @@ void JSONLogger::logConfig(T &writer, const RunLog &log) const {
     writer.EndObject();
 }
 template<typename T>
-void JSONLogger::logConfig(T &writer, const RunPlan &plan) const {
+void JSONLogger::logConfig(T &writer, const RunPlan &plan, const unsigned int run_index) const {
     writer.Key("config");
     writer.StartObject();
     {
+        if (run_index != UINT_MAX) {
+            writer.Key("run_index");
+            writer.Uint(run_index);
+        }
         // Add static items
         writer.Key("random_seed");
         writer.Uint64(plan.getRandomSimulationSeed());
@@ -228,6 +237,27 @@ void JSONLogger::logPerformanceSpecs(T& writer, const RunLog& log) const {
     writer.EndObject();
 }
 template<typename T>
+void JSONLogger::logProfile(T& writer, const RunLog& log) const {
+    writer.Key("profile");
+    writer.StartObject();
+    for (const auto &region : log.getProfile().getRegions()) {
+        writer.Key(region.first.c_str());
+        writer.StartObject();
+        {
+            writer.Key("calls");
+            writer.Uint64(region.second.calls);
+            writer.Key("total_time");
+            writer.Double(region.second.total_time);
+            writer.Key("min_time");
+            writer.Double(region.second.min_time);
+            writer.Key("max_time");
+            writer.Double(region.second.max_time);
+        }
+        writer.EndObject();
+    }
+    writer.EndObject();
+}
+template<typename T>
 void JSONLogger::logSteps(T &writer, const RunLog &log, bool logTime) const {
     writer.Key("steps");
     writer.StartArray();
@@ -245,19 +275,22 @@ void JSONLogger::logExit(T &writer, const RunLog &log, bool logTime) const {
 }
 
 template<typename T>
-void JSONLogger::logCommon(T &writer, const RunLog &log, const RunPlan *plan, bool doLogConfig, bool doLogSteps, bool doLogExit, bool doLogStepTime, bool doLogExitTime) const {
+void JSONLogger::logCommon(T &writer, const RunLog &log, const RunPlan *plan, const unsigned int run_index, bool doLogConfig, bool doLogSteps, bool doLogExit, bool doLogStepTime, bool doLogExitTime) const {
     // Begin json output object
     writer->StartObject();
     {
         // Log config
         if (plan) {
-            logConfig(*writer, *plan);
+            logConfig(*writer, *plan, run_index);
         } else if (doLogConfig) {
             logConfig(*writer, log);
         }
         if (doLogStepTime || doLogExitTime) {
             logPerformanceSpecs(*writer, log);
         }
+        if (!log.getProfile().empty()) {
+            logProfile(*writer, log);
+        }
 
         // Log step log
         if (doLogSteps) {
@@ -272,18 +305,18 @@ void JSONLogger::logCommon(T &writer, const RunLog &log, const RunPlan *plan, bo
     // End Json file
     writer->EndObject();
 }
-void JSONLogger::logCommon(const RunLog &log, const RunPlan *plan, bool doLogConfig, bool doLogSteps, bool doLogExit, bool doLogStepTime, bool doLogExitTime) const {
+void JSONLogger::logCommon(const RunLog &log, const RunPlan *plan, const unsigned int run_index, bool doLogConfig, bool doLogSteps, bool doLogExit, bool doLogStepTime, bool doLogExitTime) const {
     // Init writer
     rapidjson::StringBuffer s;
     if (prettyPrint) {
         // rapidjson::Writer doesn't have virtual methods, so can't pass rapidjson::PrettyWriter around as ptr to rapidjson::writer
         rapidjson::PrettyWriter<rapidjson::StringBuffer>* writer = new rapidjson::PrettyWriter<rapidjson::StringBuffer>(s);
         writer->SetIndent('\t', 1);
-        logCommon(writer, log, plan, doLogConfig, doLogSteps, doLogExit, doLogStepTime, doLogExitTime);
+        logCommon(writer, log, plan, run_index, doLogConfig, doLogSteps, doLogExit, doLogStepTime, doLogExitTime);
         delete writer;
     } else {
         rapidjson::Writer<rapidjson::StringBuffer> *writer = new rapidjson::Writer<rapidjson::StringBuffer>(s);
-        logCommon(writer, log, plan, doLogConfig, doLogSteps, doLogExit, doLogStepTime, doLogExitTime);
+        logCommon(writer, log, plan, run_index, doLogConfig, doLogSteps, doLogExit, doLogStepTime, doLogExitTime);
         delete writer;
     }
     // Perform output
@@ -297,5 +330,63 @@ void JSONLogger::logCommon(const RunLog &log, const RunPlan *plan, bool doLogCon
     out.close();
 }
 
+JSONStepLogStreamWriter::JSONStepLogStreamWriter(const std::string &outPath, bool _prettyPrint, bool _truncateFile, unsigned int flushFrequency)
+    : StepLogStreamWriter(outPath, _prettyPrint, _truncateFile, flushFrequency)
+    , logger(outPath, _prettyPrint, _truncateFile) { }
+
+void JSONStepLogStreamWriter::writeHeader(std::string &out, const RunLog &log, bool logTime) const {
+    // The document is left incomplete, with the steps array open
+    const auto writeOpenLog = [this, &log, logTime](auto &writer) {
+        writer.StartObject();
+        logger.logConfig(writer, log);
+        if (logTime) {
+            logger.logPerformanceSpecs(writer, log);
+        }
+        writer.Key("steps");
+        writer.StartArray();
+    };
+    rapidjson::StringBuffer s;
+    if (prettyPrint) {
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+        writer.SetIndent('\t', 1);
+        writeOpenLog(writer);
+    } else {
+        rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+        writeOpenLog(writer);
+    }
+    out.append(s.GetString(), s.GetSize());
+}
+void JSONStepLogStreamWriter::writeFrame(std::string &out, const StepLogFrame &frame, bool logTime) const {
+    // Frames are always compact, so that each occupies a single line
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+    logger.writeLogFrame(writer, frame, logTime);
+    if (prettyPrint) {
+        out += "\t\t";
+    }
+    out.append(s.GetString(), s.GetSize());
+}
+void JSONStepLogStreamWriter::writeFooter(std::string &out) const {
+    out += prettyPrint ? "\n\t]\n}\n" : "\n]}\n";
+}
+bool JSONStepLogStreamWriter::isStepsBegin(const std::string &line) const {
+    for (const std::string suffix : {"\"steps\":[", "\"steps\": ["}) {
+        if (line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0)
+            return true;
+    }
+    return false;
+}
+bool JSONStepLogStreamWriter::parseFrame(const std::string &line, unsigned int &step_index) const {
+    rapidjson::Document doc;
+    doc.Parse(line.c_str(), line.size());
+    if (doc.HasParseError() || !doc.IsObject())
+        return false;
+    const auto it = doc.FindMember("step_index");
+    if (it == doc.MemberEnd() || !it->value.IsUint())
+        return false;
+    step_index = it->value.GetUint();
+    return true;
+}
+
 }  // namespace io
 }  // namespace flamegpu
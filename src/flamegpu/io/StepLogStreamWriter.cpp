@@ -0,0 +1,159 @@
+#include "flamegpu/io/StepLogStreamWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/sim/LogFrame.h"
+#include "flamegpu/util/detail/filesystem.h"
+
+namespace flamegpu {
+namespace io {
+
+StepLogStreamWriter::StepLogStreamWriter(const std::string &outPath, bool _prettyPrint, bool _truncateFile, unsigned int flushFrequency)
+    : out_path(outPath)
+    , prettyPrint(_prettyPrint)
+    , truncateFile(_truncateFile)
+    , flush_frequency(std::max(flushFrequency, 1u)) { }
+
+StepLogStreamWriter::~StepLogStreamWriter() {
+    // Destructor must not throw, a failed write is equivalent to the frames being lost in a crash
+    try {
+        flush();
+    } catch (...) { }
+}
+
+void StepLogStreamWriter::open(const RunLog &log, bool logTime, bool resume) {
+    if (out.is_open()) {
+        THROW exception::InvalidOperation("Step log stream for file '%s' is already open, "
+            "in StepLogStreamWriter::open()\n", out_path.c_str());
+    }
+    log_time = logTime;
+    buffer.clear();
+    buffered_frames = 0;
+    frame_count = 0;
+    resumed = false;
+    resumed_step_index = 0;
+    // Binary mode, so that the byte offsets used when resuming are not affected by line ending conversion
+    const bool append = resume && resumeFile();
+    // Only a resumed log is appended to, a second header would leave the file unreadable
+    if (!append && !resume && !truncateFile && ::exists(path(out_path))) {
+        THROW exception::InvalidFilePath("File '%s' already exists and truncateFile is disabled, "
+            "in StepLogStreamWriter::open()\n", out_path.c_str());
+    }
+    out.open(out_path, std::ofstream::binary | (append ? std::ofstream::app : std::ofstream::trunc));
+    if (!out.is_open()) {
+        THROW exception::InvalidFilePath("Unable to open file '%s' for writing, "
+            "in StepLogStreamWriter::open()\n", out_path.c_str());
+    }
+    if (!append) {
+        writeHeader(buffer, log, log_time);
+        flush();
+    }
+}
+
+bool StepLogStreamWriter::resumeFile() {
+    std::ifstream in(out_path, std::ifstream::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    // Find the final step container within the file, and the end of the last complete frame within it
+    bool found = false;
+    bool in_steps = false;
+    size_t frames = 0;
+    unsigned int last_step_index = 0;
+    std::streamoff end = 0;
+    std::streamoff line_start = 0;
+    const std::string separator = getFrameSeparator();
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t first = line.find_first_not_of(" \t\r");
+        const size_t last = line.find_last_not_of(" \t\r");
+        const std::string trimmed = first == std::string::npos ? "" : line.substr(first, last - first + 1);
+        if (in_steps) {
+            std::string frame = trimmed;
+            if (!separator.empty() && frame.size() >= separator.size() &&
+                frame.compare(frame.size() - separator.size(), separator.size(), separator) == 0) {
+                frame.resize(frame.size() - separator.size());
+                frame.erase(frame.find_last_not_of(" \t\r") + 1);
+            }
+            unsigned int step_index = 0;
+            if (!frame.empty() && parseFrame(frame, step_index)) {
+                ++frames;
+                last_step_index = step_index;
+                end = line_start + static_cast<std::streamoff>(first + frame.size());
+            } else {
+                in_steps = false;
+            }
+        }
+        if (!in_steps && !trimmed.empty() && isStepsBegin(trimmed)) {
+            found = true;
+            in_steps = true;
+            frames = 0;
+            end = line_start + static_cast<std::streamoff>(first + trimmed.size());
+        }
+        line_start += static_cast<std::streamoff>(line.size() + 1);
+    }
+    in.close();
+    if (!found) {
+        return false;
+    }
+    // Discard anything following the last complete frame
+    try {
+        resize_file(out_path, static_cast<uintmax_t>(end));
+    } catch (const std::exception &e) {
+        THROW exception::InvalidFilePath("Unable to truncate file '%s' to resume step log: %s, "
+            "in StepLogStreamWriter::open()\n", out_path.c_str(), e.what());
+    }
+    frame_count = frames;
+    resumed = frames > 0;
+    resumed_step_index = last_step_index;
+    return true;
+}
+
+void StepLogStreamWriter::writeStep(const StepLogFrame &frame) {
+    if (!out.is_open()) {
+        THROW exception::InvalidOperation("Step log stream for file '%s' is not open, "
+            "in StepLogStreamWriter::writeStep()\n", out_path.c_str());
+    }
+    // Frames already present in a resumed log are not duplicated
+    if (resumed && frame.getStepCount() <= resumed_step_index) {
+        return;
+    }
+    if (frame_count) {
+        buffer += getFrameSeparator();
+    }
+    buffer += '\n';
+    writeFrame(buffer, frame, log_time);
+    ++frame_count;
+    if (++buffered_frames >= flush_frequency) {
+        flush();
+    }
+}
+
+void StepLogStreamWriter::flush() {
+    if (!out.is_open() || buffer.empty()) {
+        return;
+    }
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+    buffered_frames = 0;
+    if (out.fail()) {
+        THROW exception::InvalidFilePath("Failed to write to file '%s', "
+            "in StepLogStreamWriter::flush()\n", out_path.c_str());
+    }
+}
+
+void StepLogStreamWriter::close() {
+    if (!out.is_open()) {
+        return;
+    }
+    writeFooter(buffer);
+    flush();
+    out.close();
+}
+
+}  // namespace io
+}  // namespace flamegpu
@@ -1,5 +1,6 @@
 #include "flamegpu/io/XMLLogger.h"
 
+#include <climits>
 #include <sstream>
 
 #include "tinyxml2/tinyxml2.h"              // downloaded from https:// github.com/leethomason/tinyxml2, the list of xml parsers : http:// lars.ruoff.free.fr/xmlcpp/
@@ -55,13 +56,16 @@ XMLLogger::XMLLogger(const std::string &outPath, bool _prettyPrint, bool _trunca
     , truncateFile(_truncateFile) { }
 
 void XMLLogger::log(const RunLog &log, const RunPlan &plan, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const {
-  logCommon(log, &plan, false, logSteps, logExit, logStepTime, logExitTime);
+  logCommon(log, &plan, UINT_MAX, false, logSteps, logExit, logStepTime, logExitTime);
+}
+void XMLLogger::logRun(const RunLog &log, const RunPlan &plan, unsigned int run_index, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const {
+  logCommon(log, &plan, run_index, false, logSteps, logExit, logStepTime, logExitTime);
 }
 void XMLLogger::log(const RunLog &log, bool logConfig, bool logSteps, bool logExit, bool logStepTime, bool logExitTime) const {
-  logCommon(log, nullptr, logConfig, logSteps, logExit, logStepTime, logExitTime);
+  logCommon(log, nullptr, UINT_MAX, logConfig, logSteps, logExit, logStepTime, logExitTime);
 }
 
-void XMLLogger::logCommon(const RunLog &log, const RunPlan *plan, bool doLogConfig, bool doLogSteps, bool doLogExit, bool doLogStepTime, bool doLogExitTime) const {
+void XMLLogger::logCommon(const RunLog &log, const RunPlan *plan, const unsigned int run_index, bool doLogConfig, bool doLogSteps, bool doLogExit, bool doLogStepTime, bool doLogExitTime) const {
     tinyxml2::XMLDocument doc;
 
     tinyxml2::XMLNode * pRoot = doc.NewElement("log");
@@ -69,7 +73,7 @@ void XMLLogger::logCommon(const RunLog &log, const RunPlan *plan, bool doLogConf
 
     // Log config
     if (plan) {
-        pRoot->InsertEndChild(logConfig(doc, *plan));
+        pRoot->InsertEndChild(logConfig(doc, *plan, run_index));
     } else if (doLogConfig) {
         pRoot->InsertEndChild(logConfig(doc, log));
     }
@@ -79,6 +83,11 @@ void XMLLogger::logCommon(const RunLog &log, const RunPlan *plan, bool doLogConf
         pRoot->InsertEndChild(logPerformanceSpecs(doc, log));
     }
 
+    // Log profile
+    if (!log.getProfile().empty()) {
+        pRoot->InsertEndChild(logProfile(doc, log));
+    }
+
     // Log step log
     if (doLogSteps) {
         pRoot->InsertEndChild(logSteps(doc, log, doLogStepTime));
@@ -108,10 +117,15 @@ tinyxml2::XMLNode *XMLLogger::logConfig(tinyxml2::XMLDocument &doc, const RunLog
     }
     return pConfigElement;
 }
-tinyxml2::XMLNode *XMLLogger::logConfig(tinyxml2::XMLDocument &doc, const RunPlan &plan) const {
+tinyxml2::XMLNode *XMLLogger::logConfig(tinyxml2::XMLDocument &doc, const RunPlan &plan, const unsigned int run_index) const {
     tinyxml2::XMLElement *pConfigElement = doc.NewElement("config");
     {
         tinyxml2::XMLElement *pListElement;
+        if (run_index != UINT_MAX) {
+            pListElement = doc.NewElement("run_index");
+            pListElement->SetText(run_index);
+            pConfigElement->InsertEndChild(pListElement);
+        }
         // Add static items
         pListElement = doc.NewElement("random_seed");
         pListElement->SetText(plan.getRandomSimulationSeed());
@@ -159,6 +173,32 @@ tinyxml2::XMLNode* XMLLogger::logPerformanceSpecs(tinyxml2::XMLDocument& doc, co
     }
     return pConfigElement;
 }
+tinyxml2::XMLNode* XMLLogger::logProfile(tinyxml2::XMLDocument& doc, const RunLog& log) const {
+    tinyxml2::XMLElement* pProfileElement = doc.NewElement("profile");
+    for (const auto &region : log.getProfile().getRegions()) {
+        tinyxml2::XMLElement* pRegionElement = doc.NewElement("region");
+        {
+            tinyxml2::XMLElement* pListElement;
+            pListElement = doc.NewElement("path");
+            pListElement->SetText(region.first.c_str());
+            pRegionElement->InsertEndChild(pListElement);
+            pListElement = doc.NewElement("calls");
+            pListElement->SetText(region.second.calls);
+            pRegionElement->InsertEndChild(pListElement);
+            pListElement = doc.NewElement("total_time");
+            pListElement->SetText(region.second.total_time);
+            pRegionElement->InsertEndChild(pListElement);
+            pListElement = doc.NewElement("min_time");
+            pListElement->SetText(region.second.min_time);
+            pRegionElement->InsertEndChild(pListElement);
+            pListElement = doc.NewElement("max_time");
+            pListElement->SetText(region.second.max_time);
+            pRegionElement->InsertEndChild(pListElement);
+        }
+        pProfileElement->InsertEndChild(pRegionElement);
+    }
+    return pProfileElement;
+}
 tinyxml2::XMLNode *XMLLogger::logSteps(tinyxml2::XMLDocument &doc, const RunLog &log, bool logTime) const {
     tinyxml2::XMLElement *pStepsElement = doc.NewElement("steps");
     {
@@ -264,8 +304,8 @@ void XMLLogger::writeCommonLogFrame(tinyxml2::XMLDocument &doc, tinyxml2::XMLEle
                                 pVariableElement = doc.NewElement(current_variable.c_str());
                             }
                             // Build name key for the variable & log value
-                            tinyxml2::XMLElement *pValueElement = doc.NewElement(LoggingConfig::toString(var.first.reduction));
-                            writeAny(pValueElement, var.second, 1);
+                            tinyxml2::XMLElement *pValueElement = doc.NewElement(var.first.getKey().c_str());
+                            writeAny(pValueElement, var.second, var.second.elements);
                             pVariableElement->InsertEndChild(pValueElement);
                         }
                         if (!current_variable.empty())
@@ -318,5 +358,53 @@ void XMLLogger::writeAny(tinyxml2::XMLElement *pElement, const util::Any &value,
     pElement->SetText(ss.str().c_str());
 }
 
+XMLStepLogStreamWriter::XMLStepLogStreamWriter(const std::string &outPath, bool _prettyPrint, bool _truncateFile, unsigned int flushFrequency)
+    : StepLogStreamWriter(outPath, _prettyPrint, _truncateFile, flushFrequency)
+    , logger(outPath, _prettyPrint, _truncateFile) { }
+
+void XMLStepLogStreamWriter::writeHeader(std::string &out, const RunLog &log, bool logTime) const {
+    // Print a complete log with an empty steps element, and keep everything up to the opening of the steps element
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLNode *pRoot = doc.NewElement("log");
+    doc.InsertFirstChild(pRoot);
+    pRoot->InsertEndChild(logger.logConfig(doc, log));
+    if (logTime) {
+        pRoot->InsertEndChild(logger.logPerformanceSpecs(doc, log));
+    }
+    pRoot->InsertEndChild(doc.NewElement("steps"));
+    tinyxml2::XMLPrinter printer(nullptr, !prettyPrint);
+    doc.Print(&printer);
+    const std::string printed(printer.CStr(), printer.CStrSize() - 1);
+    out += printed.substr(0, printed.rfind("<steps/>"));
+    out += "<steps>";
+}
+void XMLStepLogStreamWriter::writeFrame(std::string &out, const StepLogFrame &frame, bool logTime) const {
+    // Frames are always compact, so that each occupies a single line
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLPrinter printer(nullptr, true);
+    logger.writeLogFrame(doc, frame, logTime)->Accept(&printer);
+    if (prettyPrint) {
+        out += "        ";
+    }
+    out.append(printer.CStr(), printer.CStrSize() - 1);
+}
+void XMLStepLogStreamWriter::writeFooter(std::string &out) const {
+    out += prettyPrint ? "\n    </steps>\n</log>\n" : "\n</steps></log>\n";
+}
+bool XMLStepLogStreamWriter::isStepsBegin(const std::string &line) const {
+    const std::string suffix = "<steps>";
+    return line.size() >= suffix.size() && line.compare(line.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+bool XMLStepLogStreamWriter::parseFrame(const std::string &line, unsigned int &step_index) const {
+    tinyxml2::XMLDocument doc;
+    if (doc.Parse(line.c_str(), line.size()) != tinyxml2::XML_SUCCESS)
+        return false;
+    const tinyxml2::XMLElement *pFrame = doc.RootElement();
+    if (!pFrame || std::string(pFrame->Name()) != "step")
+        return false;
+    const tinyxml2::XMLElement *pStepIndex = pFrame->FirstChildElement("step_index");
+    return pStepIndex && pStepIndex->QueryUnsignedText(&step_index) == tinyxml2::XML_SUCCESS;
+}
+
 }  // namespace io
 }  // namespace flamegpu
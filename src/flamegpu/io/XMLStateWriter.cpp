@@ -167,48 +167,43 @@ int XMLStateWriter::writeStates(bool prettyPrint) {
 
     pElement = doc.NewElement("environment");
     // for each environment property
-    EnvironmentManager &env_manager = EnvironmentManager::getInstance();
-    auto lock = env_manager.getSharedLock();
-    const char *env_buffer = reinterpret_cast<const char *>(env_manager.getHostBuffer());
-    for (auto &a : env_manager.getPropertiesMap()) {
-        // If it is from this model
-        if (a.first.first == sim_instance_id) {
-            tinyxml2::XMLElement* pListElement = doc.NewElement(a.first.second.c_str());
-            pListElement->SetAttribute("type", a.second.type.name());
-                // Output properties
-                std::stringstream ss;
-                // Loop through elements, to construct csv string
-                for (unsigned int el = 0; el < a.second.elements; ++el) {
-                    if (a.second.type == std::type_index(typeid(float))) {
-                        ss << *reinterpret_cast<const float*>(env_buffer + a.second.offset + (el * sizeof(float)));
-                    } else if (a.second.type == std::type_index(typeid(double))) {
-                        ss << *reinterpret_cast<const double*>(env_buffer + a.second.offset + (el * sizeof(double)));
-                    } else if (a.second.type == std::type_index(typeid(int64_t))) {
-                        ss << *reinterpret_cast<const int64_t*>(env_buffer + a.second.offset + (el * sizeof(int64_t)));
-                    } else if (a.second.type == std::type_index(typeid(uint64_t))) {
-                        ss << *reinterpret_cast<const uint64_t*>(env_buffer + a.second.offset + (el * sizeof(uint64_t)));
-                    } else if (a.second.type == std::type_index(typeid(int32_t))) {
-                        ss << *reinterpret_cast<const int32_t*>(env_buffer + a.second.offset + (el * sizeof(int32_t)));
-                    } else if (a.second.type == std::type_index(typeid(uint32_t))) {
-                        ss << *reinterpret_cast<const uint32_t*>(env_buffer + a.second.offset + (el * sizeof(uint32_t)));
-                    } else if (a.second.type == std::type_index(typeid(int16_t))) {
-                        ss << *reinterpret_cast<const int16_t*>(env_buffer + a.second.offset + (el * sizeof(int16_t)));
-                    } else if (a.second.type == std::type_index(typeid(uint16_t))) {
-                        ss << *reinterpret_cast<const uint16_t*>(env_buffer + a.second.offset + (el * sizeof(uint16_t)));
-                    } else if (a.second.type == std::type_index(typeid(int8_t))) {
-                        ss << static_cast<int32_t>(*reinterpret_cast<const int8_t*>(env_buffer + a.second.offset + (el * sizeof(int8_t))));  // Char outputs weird if being used as an integer
-                    } else if (a.second.type == std::type_index(typeid(uint8_t))) {
-                        ss << static_cast<uint32_t>(*reinterpret_cast<const uint8_t*>(env_buffer + a.second.offset + (el * sizeof(uint8_t))));  // Char outputs weird if being used as an integer
-                    } else {
-                        THROW exception::TinyXMLError("Model contains environment property '%s' of unsupported type '%s', "
-                            "in XMLStateWriter::writeStates()\n", a.first.second.c_str(), a.second.type.name());
-                    }
-                    if (el + 1 != a.second.elements)
-                        ss << ",";
+    for (auto &a : sim_instance->getEnvironmentProperties()) {
+        const char *prop_buffer = static_cast<const char *>(a.second.ptr);
+        tinyxml2::XMLElement* pListElement = doc.NewElement(a.first.c_str());
+        pListElement->SetAttribute("type", a.second.type.name());
+            // Output properties
+            std::stringstream ss;
+            // Loop through elements, to construct csv string
+            for (unsigned int el = 0; el < a.second.elements; ++el) {
+                if (a.second.type == std::type_index(typeid(float))) {
+                    ss << *reinterpret_cast<const float*>(prop_buffer + (el * sizeof(float)));
+                } else if (a.second.type == std::type_index(typeid(double))) {
+                    ss << *reinterpret_cast<const double*>(prop_buffer + (el * sizeof(double)));
+                } else if (a.second.type == std::type_index(typeid(int64_t))) {
+                    ss << *reinterpret_cast<const int64_t*>(prop_buffer + (el * sizeof(int64_t)));
+                } else if (a.second.type == std::type_index(typeid(uint64_t))) {
+                    ss << *reinterpret_cast<const uint64_t*>(prop_buffer + (el * sizeof(uint64_t)));
+                } else if (a.second.type == std::type_index(typeid(int32_t))) {
+                    ss << *reinterpret_cast<const int32_t*>(prop_buffer + (el * sizeof(int32_t)));
+                } else if (a.second.type == std::type_index(typeid(uint32_t))) {
+                    ss << *reinterpret_cast<const uint32_t*>(prop_buffer + (el * sizeof(uint32_t)));
+                } else if (a.second.type == std::type_index(typeid(int16_t))) {
+                    ss << *reinterpret_cast<const int16_t*>(prop_buffer + (el * sizeof(int16_t)));
+                } else if (a.second.type == std::type_index(typeid(uint16_t))) {
+                    ss << *reinterpret_cast<const uint16_t*>(prop_buffer + (el * sizeof(uint16_t)));
+                } else if (a.second.type == std::type_index(typeid(int8_t))) {
+                    ss << static_cast<int32_t>(*reinterpret_cast<const int8_t*>(prop_buffer + (el * sizeof(int8_t))));  // Char outputs weird if being used as an integer
+                } else if (a.second.type == std::type_index(typeid(uint8_t))) {
+                    ss << static_cast<uint32_t>(*reinterpret_cast<const uint8_t*>(prop_buffer + (el * sizeof(uint8_t))));  // Char outputs weird if being used as an integer
+                } else {
+                    THROW exception::TinyXMLError("Model contains environment property '%s' of unsupported type '%s', "
+                        "in XMLStateWriter::writeStates()\n", a.first.c_str(), a.second.type.name());
                 }
-            pListElement->SetText(ss.str().c_str());
-            pElement->InsertEndChild(pListElement);
-        }
+                if (el + 1 != a.second.elements)
+                    ss << ",";
+            }
+        pListElement->SetText(ss.str().c_str());
+        pElement->InsertEndChild(pListElement);
     }
     pRoot->InsertEndChild(pElement);
 
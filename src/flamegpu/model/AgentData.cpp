@@ -12,7 +12,8 @@ AgentData::AgentData(std::shared_ptr<const ModelData> model, const std::string &
     , description(new AgentDescription(model, this))
     , name(agent_name)
     , keepDefaultState(false)
-    , sortPeriod(1) {
+    , sortPeriod(1)
+    , sortOrder(SpatialSortOrder::RowMajor) {
     states.insert(ModelData::DEFAULT_STATE);
     // All agents have an internal _id variable
     variables.emplace(ID_VARIABLE_NAME, Variable(std::array<id_t, 1>{ ID_NOT_SET }));
@@ -35,7 +36,8 @@ AgentData::AgentData(std::shared_ptr<const ModelData> model, const AgentData &ot
     , description(model ? new AgentDescription(model, this) : nullptr)
     , name(other.name)
     , keepDefaultState(other.keepDefaultState)
-    , sortPeriod(other.sortPeriod) { }
+    , sortPeriod(other.sortPeriod)
+    , sortOrder(other.sortOrder) { }
 
 bool AgentData::operator==(const AgentData &rhs) const {
     if (this == &rhs)  // They point to same object
@@ -45,6 +47,7 @@ bool AgentData::operator==(const AgentData &rhs) const {
         && agent_outputs == rhs.agent_outputs
         && keepDefaultState == rhs.keepDefaultState
         && sortPeriod == rhs.sortPeriod
+        && sortOrder == rhs.sortOrder
         && functions.size() == rhs.functions.size()
         && variables.size() == rhs.variables.size()
         && states.size() == rhs.states.size()) {
@@ -142,6 +142,12 @@ const std::set<std::string> &AgentDescription::getStates() const {
 void AgentDescription::setSortPeriod(const unsigned int sortPeriod) {
     agent->sortPeriod = sortPeriod;
 }
+void AgentDescription::setSortOrder(const SpatialSortOrder sortOrder) {
+    agent->sortOrder = sortOrder;
+}
+SpatialSortOrder AgentDescription::getSortOrder() const {
+    return agent->sortOrder;
+}
 
 bool AgentDescription::hasState(const std::string &state_name) const {
     return agent->states.find(state_name) != agent->states.end();
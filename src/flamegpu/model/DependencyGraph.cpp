@@ -1,5 +1,12 @@
 #include "flamegpu/model/DependencyGraph.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "flamegpu/model/AgentData.h"
+#include "flamegpu/model/AgentFunctionData.cuh"
+
 namespace flamegpu {
 
 DependencyGraph::DependencyGraph() {
@@ -60,8 +67,6 @@ void DependencyGraph::addRoot(DependencyNode& root) {
 }
 
 bool DependencyGraph::validateDependencyGraph() {
-    functionStack.clear();
-
     if (roots.size() == 0) {
             THROW exception::InvalidDependencyGraph("Warning! Agent function dependency graph is empty!");
     }
@@ -69,12 +74,137 @@ bool DependencyGraph::validateDependencyGraph() {
         if (root->getDependencies().size() != 0) {
             THROW exception::InvalidDependencyGraph("Warning! Root agent function has dependencies!");
         }
-        if (!validateSubTree(root)) {
-            THROW exception::InvalidDependencyGraph("Warning! Dependency graph validation failed! Does the graph have a cycle?");
+    }
+    std::vector<std::vector<DependencyNode*>> waves;
+    if (!buildTopologicalWaves(waves)) {
+        THROW exception::InvalidDependencyGraph("Warning! Dependency graph validation failed! Does the graph have a cycle?");
+    }
+    return true;
+}
+
+std::vector<DependencyNode*> DependencyGraph::getReachableNodes() const {
+    std::vector<DependencyNode*> nodes;
+    std::unordered_set<DependencyNode*> visited;
+    for (auto root : roots) {
+        if (visited.insert(root).second) {
+            nodes.push_back(root);
+        }
+    }
+    // nodes doubles as the BFS queue
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (auto child : nodes[i]->dependents) {
+            if (visited.insert(child).second) {
+                nodes.push_back(child);
+            }
+        }
+    }
+    return nodes;
+}
+
+bool DependencyGraph::buildTopologicalWaves(std::vector<std::vector<DependencyNode*>>& waves) const {
+    waves.clear();
+    const std::vector<DependencyNode*> nodes = getReachableNodes();
+    // Count the incoming edges of each node
+    std::unordered_map<DependencyNode*, size_t> inDegree;
+    for (auto node : nodes) {
+        inDegree.emplace(node, 0);
+    }
+    for (auto node : nodes) {
+        for (auto child : node->dependents) {
+            ++inDegree.at(child);
+        }
+    }
+    // Initial wave contains the nodes without dependencies
+    std::vector<DependencyNode*> wave;
+    for (auto node : nodes) {
+        if (inDegree.at(node) == 0) {
+            wave.push_back(node);
+        }
+    }
+    // Each following wave contains the nodes whose final dependency was in the previous wave
+    size_t processed = 0;
+    while (!wave.empty()) {
+        processed += wave.size();
+        std::vector<DependencyNode*> nextWave;
+        for (auto node : wave) {
+            for (auto child : node->dependents) {
+                if (--inDegree.at(child) == 0) {
+                    nextWave.push_back(child);
+                }
+            }
+        }
+        waves.push_back(std::move(wave));
+        wave = std::move(nextWave);
+    }
+    // Nodes which are part of a cycle never have all of their dependencies processed
+    return processed == nodes.size();
+}
+
+namespace {
+/**
+ * A layer planned by DependencyGraph::generateLayers(), prior to being added to the model
+ */
+struct PlannedLayer {
+    /**
+     * Nodes assigned to the layer, in the order they were assigned
+     */
+    std::vector<DependencyNode*> nodes;
+    /**
+     * Agent functions assigned to the layer
+     */
+    std::vector<const AgentFunctionData*> agentFunctions;
+    /**
+     * True if the layer contains a host function or submodel, these must be alone in their layer
+     */
+    bool exclusive = false;
+};
+/**
+ * Returns whether the agent function can be added to the layer
+ * This mirrors the checks performed by LayerDescription::addAgentFunction(), so that conflicts are detected without exceptions
+ */
+bool canAddAgentFunction(const PlannedLayer& layer, const AgentFunctionData& a) {
+    if (layer.exclusive) {
+        return false;
+    }
+    const auto a_parent = a.parent.lock();
+    const auto a_agent_out = a.agent_output.lock();
+    const auto a_message_out = a.message_output.lock();
+    const auto a_message_in = a.message_input.lock();
+    for (const auto b : layer.agentFunctions) {
+        if (b == &a) {
+            return false;
+        }
+        if (const auto b_parent = b->parent.lock()) {
+            // Functions of the same agent may not share a state
+            if (a_parent && b_parent->name == a_parent->name) {
+                if (b->initial_state == a.initial_state ||
+                    b->initial_state == a.end_state ||
+                    b->end_state == a.initial_state ||
+                    b->end_state == a.end_state) {
+                    return false;
+                }
+            }
+            // Agent output may not target a state which is the input of another function
+            if (a_agent_out && b_parent->name == a_agent_out->name && b->initial_state == a.agent_output_state) {
+                return false;
+            }
+            const auto b_agent_out = b->agent_output.lock();
+            if (b_agent_out && a_parent && a_parent->name == b_agent_out->name && a.initial_state == b->agent_output_state) {
+                return false;
+            }
+        }
+        // Functions may not output to a message list which is used by another function
+        const auto b_message_out = b->message_output.lock();
+        const auto b_message_in = b->message_input.lock();
+        if ((a_message_out && b_message_out && a_message_out == b_message_out) ||
+            (a_message_out && b_message_in && a_message_out == b_message_in) ||
+            (a_message_in && b_message_out && a_message_in == b_message_out)) {
+            return false;
         }
     }
     return true;
 }
+}  // namespace
 
 void DependencyGraph::generateLayers(ModelDescription& _model) {
     // Check model doesn't already have layers attached
@@ -86,166 +216,72 @@ void DependencyGraph::generateLayers(ModelDescription& _model) {
     validateDependencyGraph();
     checkForUnattachedFunctions();
 
-    // Lambda to walk the graph and set minimum layer depths of nodes
-    std::function<void(DependencyNode*, int)> setMinLayerDepths;
-    setMinLayerDepths = [&setMinLayerDepths] (DependencyNode* node, int depth) {
-        if (depth >= node->getMinimumLayerDepth()) {
-            node->setMinimumLayerDepth(depth);
-        }
-        for (auto child : node->getDependents()) {
-            setMinLayerDepths(child, depth + 1);
-        }
-    };
-
-    // Set minimum layer depths
-    for (auto root : roots) {
-        setMinLayerDepths(root, 0);
-    }
-
-    // Build list of functions in their respective ideal layers assuming no conflicts
-    std::vector<std::vector<DependencyNode*>> idealLayers;
-    std::function<void(DependencyNode*)> buildIdealLayers;
-    buildIdealLayers = [&buildIdealLayers, &idealLayers] (DependencyNode* node) {
-        // New layers required
-        std::vector<std::vector<DependencyNode*>>::size_type nodeDepth = node->getMinimumLayerDepth();
-        while (nodeDepth >= idealLayers.size()) {
-            idealLayers.push_back(std::vector<DependencyNode*>());
-        }
-
-        // Add node to relevant layer if node hasn't already been added
-        bool alreadyAdded = false;
-        for (auto& includedNode : idealLayers[nodeDepth]) {
-            if (node == includedNode) {
-                alreadyAdded = true;
+    // Sort nodes into waves, the wave index is the minimum layer depth of the node
+    std::vector<std::vector<DependencyNode*>> waves;
+    buildTopologicalWaves(waves);
+
+    // Visit nodes in topological order, assigning each to the first compatible layer after the layers of all of its dependencies
+    std::vector<PlannedLayer> plannedLayers;
+    std::unordered_map<DependencyNode*, size_t> nodeLayer;
+    for (size_t depth = 0; depth < waves.size(); ++depth) {
+        for (auto node : waves[depth]) {
+            node->setMinimumLayerDepth(static_cast<int>(depth));
+            size_t earliest = 0;
+            for (auto dependency : node->dependencies) {
+                const auto it = nodeLayer.find(dependency);
+                // Dependencies which are not reachable from a root are ignored
+                if (it != nodeLayer.end()) {
+                    earliest = std::max(earliest, it->second + 1);
+                }
             }
+            AgentFunctionDescription* afd = dynamic_cast<AgentFunctionDescription*>(node);
+            size_t layerIndex = earliest;
+            for (; layerIndex < plannedLayers.size(); ++layerIndex) {
+                const PlannedLayer& layer = plannedLayers[layerIndex];
+                if (afd ? canAddAgentFunction(layer, *afd->function) : layer.nodes.empty()) {
+                    break;
+                }
+            }
+            if (layerIndex == plannedLayers.size()) {
+                plannedLayers.emplace_back();
+            }
+            PlannedLayer& layer = plannedLayers[layerIndex];
+            layer.nodes.push_back(node);
+            if (afd) {
+                layer.agentFunctions.push_back(afd->function);
+            } else {
+                layer.exclusive = true;
+            }
+            nodeLayer.emplace(node, layerIndex);
         }
-        if (!alreadyAdded) {
-            idealLayers[nodeDepth].push_back(node);
-        }
-
-        // Repeat for children
-        for (auto child : node->getDependents()) {
-            buildIdealLayers(child);
-        }
-    };
-
-    for (auto root : roots) {
-        buildIdealLayers(root);
     }
 
-    // idealLayers now contains DependencyNode pointers in their ideal layers, i.e. assuming no conflicts.
-    // Now iterate structure attempting to add functions to layers.
-    // If we encounter conflicts, introduce additional layers as necessary
+    // Add the planned layers to the model
+    // Conflicts were resolved whilst planning, so any exception thrown here indicates an invalid model
     constructedLayers.clear();
-    for (auto idealLayer : idealLayers) {
-        // Request a new layer from the model
-        LayerDescription* layer = &_model.newLayer();
+    for (const auto& plannedLayer : plannedLayers) {
+        LayerDescription& layer = _model.newLayer();
         constructedLayers.emplace_back();
-        // Attempt to add each node in the idealLayer to the layer
-        for (auto node : idealLayer) {
+        for (auto node : plannedLayer.nodes) {
             // Add node based on its concrete type
-            // Agent function
             if (AgentFunctionDescription* afd = dynamic_cast<AgentFunctionDescription*>(node)) {
-                try {
-                    layer->addAgentFunction(*afd);
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(afd));
-                } catch (const exception::InvalidAgentFunc&) {
-                    // Conflict, create new layer and add to that instead
-                    layer = &_model.newLayer();
-                    layer->addAgentFunction(*afd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(afd));
-                    // printf("New function execution layer created - exception::InvalidAgentFunc exception\n");
-                } catch (const exception::InvalidLayerMember&) {
-                    layer = &_model.newLayer();
-                    layer->addAgentFunction(*afd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(afd));
-                    // printf("New function execution layer created - exception::InvalidLayerMember exception\n");
-                }
-            }
-
-            // Submodel
-            if (SubModelDescription* smd = dynamic_cast<SubModelDescription*>(node)) {
-                try {
-                    layer->addSubModel(*smd);
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(smd));
-                } catch (const exception::InvalidLayerMember&) {
-                    layer = &_model.newLayer();
-                    layer->addSubModel(*smd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(smd));
-                    // printf("New submodel layer created - exception::InvalidLayerMember exception\n");
-                } catch (const exception::InvalidSubModel&) {
-                    layer = &_model.newLayer();
-                    layer->addSubModel(*smd);
-                    constructedLayers.emplace_back();
-                    constructedLayers.back().emplace_back(DependencyGraph::getNodeName(smd));
-                    // printf("New submodel layer created - exception::InvalidSubModel exception\n");
-                }
-            }
-
-            // Host function
-            if (HostFunctionDescription* hdf = dynamic_cast<HostFunctionDescription*>(node)) {
+                layer.addAgentFunction(*afd);
+            } else if (SubModelDescription* smd = dynamic_cast<SubModelDescription*>(node)) {
+                layer.addSubModel(*smd);
+            } else if (HostFunctionDescription* hdf = dynamic_cast<HostFunctionDescription*>(node)) {
                 // function ptr, callback object should be mutually exclusive. Callback only used for SWIG, ptr only for non-SWIG.
                 // If ptr is available, use that
                 if (hdf->getFunctionPtr() != nullptr) {
-                    try {
-                        layer->addHostFunction(hdf->getFunctionPtr());
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                    } catch (const exception::InvalidLayerMember&) {
-                        layer = &_model.newLayer();
-                        layer->addHostFunction(hdf->getFunctionPtr());
-                        constructedLayers.emplace_back();
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                        // printf("New host function layer created - exception::InvalidLayerMember exception\n");
-                    }
+                    layer.addHostFunction(hdf->getFunctionPtr());
                 } else {
-                    try {
-                        layer->_addHostFunctionCallback(hdf->getCallbackObject());
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                    } catch (const exception::InvalidLayerMember&) {
-                        layer = &_model.newLayer();
-                        layer->_addHostFunctionCallback(hdf->getCallbackObject());
-                        constructedLayers.emplace_back();
-                        constructedLayers.back().emplace_back(DependencyGraph::getNodeName(hdf));
-                        // printf("New host function layer created - exception::InvalidLayerMember exception\n");
-                    }
+                    layer._addHostFunctionCallback(hdf->getCallbackObject());
                 }
             }
+            constructedLayers.back().emplace_back(DependencyGraph::getNodeName(node));
         }
     }
 }
 
-bool DependencyGraph::validateSubTree(DependencyNode* node) {
-    // Check if the function we are looking at already exists on the stack - if so we have a cycle
-    if (doesFunctionExistInStack(node)) {
-        return false;
-    }
-
-    // No cycle detected, check if all child nodes form valid subtrees
-    functionStack.push_back(node);
-    for (auto child : node->getDependents()) {
-        if (!validateSubTree(child))
-            return false;
-    }
-
-    // No problems, tree formed by this node and its children is valid
-    // Pop this function from the stack and return
-    functionStack.pop_back();
-    return true;
-}
-
-bool DependencyGraph::doesFunctionExistInStack(DependencyNode* function) {
-    // Iterating vector probably faster than using constant lookup structure for likely number of elements
-    for (auto fn : functionStack) {
-        if (fn == function) {
-            return true;
-        }
-    }
-    return false;
-}
-
 void DependencyGraph::checkForUnattachedFunctions() {
     // Build set of model's agent functions
     std::set<AgentFunctionData*> modelFunctions;
@@ -257,18 +293,10 @@ void DependencyGraph::checkForUnattachedFunctions() {
 
     // Build set of functions present in the dependency graph
     std::set<AgentFunctionData*> graphFunctions;
-    std::function<void(DependencyNode*)> captureFunctions;
-    captureFunctions = [&captureFunctions, &graphFunctions] (DependencyNode* node) {
+    for (auto node : getReachableNodes()) {
         if (AgentFunctionDescription* afd = dynamic_cast<AgentFunctionDescription*>(node)) {
             graphFunctions.insert(afd->function);
         }
-        for (const auto& child : node->getDependents()) {
-            captureFunctions(child);
-        }
-    };
-
-    for (auto& root : roots) {
-        captureFunctions(root);
     }
 
     // Compare sets
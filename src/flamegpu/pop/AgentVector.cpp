@@ -528,6 +528,20 @@ void AgentVector::resize(size_type count) {
 void AgentVector::internal_resize(size_type count, bool init) {
     if (count == _capacity)
         return;
+    if (_data.use_count() > 1) {
+        // The buffers are shared (e.g. by a Python buffer view), so copy them to new buffers rather than reallocating them beneath the sharer
+        auto t_data = std::make_shared<AgentDataMap>();
+        for (const auto& it : *_data) {
+            const auto& v = agent->variables.at(it.first);
+            auto t = std::unique_ptr<detail::GenericMemoryVector>(it.second->clone());
+            t->resize(_capacity);
+            if (_capacity) {
+                memcpy(t->getDataPtr(), it.second->getReadOnlyDataPtr(), _capacity * v.type_size * v.elements);
+            }
+            t_data->emplace(it.first, std::move(t));
+        }
+        _data = t_data;
+    }
     for (const auto& v : agent->variables) {
         // For each variable inside agent, add it to the map or replace it in the map
         const auto it = _data->find(v.first);
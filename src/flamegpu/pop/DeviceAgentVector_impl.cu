@@ -46,15 +46,19 @@ void DeviceAgentVector_impl::syncChanges() {
         cuda_agent.initExcludedVars(cuda_agent_state, new_allocated_size - old_size, old_size, scatter, streamId, stream);
     }
     _requireLength();
-    // Copy all changes back to device
-    for (const auto &ch : change_detail) {
+    // Copy all changed ranges back to device
+    for (auto &ch : change_detail) {
         auto &v = agent->variables.at(ch.first);
+        const size_t variable_size = v.type_size * v.elements;
         // Copy back variable data into each array
         const char* host_src = static_cast<const char*>(_data->at(ch.first)->getDataPtr());
         char* device_dest = static_cast<char*>(cuda_agent.getStateVariablePtr(cuda_agent_state, ch.first));
-        const size_t copy_offset = ch.second.first * v.type_size * v.elements;
-        const size_t copy_len = (ch.second.second - ch.second.first) * v.type_size * v.elements;
-        gpuErrchk(cudaMemcpyAsync(device_dest + copy_offset, host_src + copy_offset, copy_len, cudaMemcpyHostToDevice, stream));
+        ch.second.truncate(_size);
+        for (const auto &range : ch.second.getRanges()) {
+            const size_t copy_offset = range.first * variable_size;
+            const size_t copy_len = (range.second - range.first) * variable_size;
+            gpuErrchk(cudaMemcpyAsync(device_dest + copy_offset, host_src + copy_offset, copy_len, cudaMemcpyHostToDevice, stream));
+        }
     }
     change_detail.clear();
     // Copy all unbound buffes
@@ -72,6 +76,12 @@ void DeviceAgentVector_impl::syncChanges() {
     // Update CUDAAgent statelist size
     cuda_agent.setStateAgentCount(cuda_agent_state, _size);
 }
+std::vector<util::detail::DirtyRangeSet::Range> DeviceAgentVector_impl::getChangedRanges(const std::string &variable_name) const {
+    const auto it = change_detail.find(variable_name);
+    if (it == change_detail.end())
+        return {};
+    return it->second.getRanges();
+}
 void DeviceAgentVector_impl::purgeCache() {
     _size = cuda_agent.getStateSize(cuda_agent_state);
     // All variables are now invalid
@@ -234,18 +244,11 @@ void DeviceAgentVector_impl::_insert(size_type pos, size_type count) {
     if (unbound_host_buffer_size != _size) {
         THROW exception::InvalidOperation("Unbound buffers have gone out of sync, in DeviceAgentVector::_insert().\n");
     }
-    // Update change detail for all variables
+    // Update change detail for all variables, all agents from pos onwards have moved
     for (const auto& v : agent->variables) {
-        // Does it exist in change map
-        auto change = change_detail.find(v.first);
-        if (change == change_detail.end()) {
-            change_detail.emplace(v.first, std::pair<size_type, size_type>{pos, _size});
-        } else {
-            // Inclusive min bound
-            change->second.first = change->second.first > pos ? pos : change->second.first;
-            // Exclusive max bound
-            change->second.second = _size;
-        }
+        auto &change = change_detail[v.first];
+        change.truncate(_size);
+        change.add(pos, _size);
     }
 }
 void DeviceAgentVector_impl::_erase(size_type pos, size_type count) {
@@ -280,18 +283,11 @@ void DeviceAgentVector_impl::_erase(size_type pos, size_type count) {
     if (unbound_host_buffer_size != _size) {
         THROW exception::InvalidOperation("Unbound buffers have gone out of sync, in DeviceAgentVector::_erase().\n");
     }
-    // Update change detail for all variables
+    // Update change detail for all variables, all agents from pos onwards have moved
     for (const auto &v : agent->variables) {
-        // Does it exist in change map
-        auto change = change_detail.find(v.first);
-        if (change == change_detail.end()) {
-            change_detail.emplace(v.first, std::pair<size_type, size_type>{pos, _size});
-        } else {
-            // Inclusive min bound
-            change->second.first = change->second.first > pos ? pos : change->second.first;
-            // Exclusive max bound
-            change->second.second = _size;
-        }
+        auto &change = change_detail[v.first];
+        change.truncate(_size);
+        change.add(pos, _size);
     }
 }
 
@@ -304,16 +300,7 @@ void DeviceAgentVector_impl::_changed(const std::string& variable_name, size_typ
             "in DeviceAgentVector::_changed()\n",
             variable_name.c_str());
     }
-    // Does it exist in change map
-    auto change = change_detail.find(variable_name);
-    if (change == change_detail.end()) {
-        change_detail.emplace(variable_name, std::pair<size_type, size_type>{pos, pos + 1});
-    } else {
-        // Inclusive min bound
-        change->second.first = change->second.first > pos ? pos : change->second.first;
-        // Exclusive max bound
-        change->second.second = change->second.second <= pos ? pos + 1 : change->second.second;
-    }
+    change_detail[variable_name].add(pos, pos + 1);
 }
 void DeviceAgentVector_impl::_changedAfter(const std::string& variable_name, size_type pos) {
     // Check the variable exists
@@ -323,16 +310,17 @@ void DeviceAgentVector_impl::_changedAfter(const std::string& variable_name, siz
             "in DeviceAgentVector::_changed()\n",
             variable_name.c_str());
     }
-    // Does it exist in change map
-    auto change = change_detail.find(variable_name);
-    if (change == change_detail.end()) {
-        change_detail.emplace(variable_name, std::pair<size_type, size_type>{pos, _size});
-    } else {
-        // Inclusive min bound
-        change->second.first = change->second.first > pos ? pos : change->second.first;
-        // Exclusive max bound
-        change->second.second = _size;
+    change_detail[variable_name].add(pos, _size);
+}
+void DeviceAgentVector_impl::_changedRange(const std::string& variable_name, size_type first, size_type last) {
+    // Check the variable exists
+    auto var = agent->variables.find(variable_name);
+    if (var == agent->variables.end()) {
+        THROW exception::InvalidAgentVar("Variable %s was not found, "
+            "in DeviceAgentVector::_changedRange()\n",
+            variable_name.c_str());
     }
+    change_detail[variable_name].add(first, last);
 }
 void DeviceAgentVector_impl::_require(const std::string& variable_name) const {
     if (invalid_variables.find(variable_name) !=invalid_variables.end()) {
@@ -7,40 +7,79 @@
 
 namespace flamegpu {
 
+namespace {
+// CPUReferenceSimulation does not have device agent storage, so these are bound in it's place
+const HostAPI::AgentOffsetMap empty_agent_offsets;
+HostAPI::AgentDataMap empty_agent_data;
+HostAPI::AgentBatchMap empty_agent_batches;
+}  // namespace
+
 HostAPI::HostAPI(CUDASimulation &_agentModel,
     RandomManager& rng,
     CUDAScatter &_scatter,
     const AgentOffsetMap &_agentOffsets,
     AgentDataMap &_agentData,
+    AgentBatchMap &_agentBatches,
     CUDAMacroEnvironment &macro_env,
     const unsigned int& _streamId,
     cudaStream_t _stream)
     : random(rng)
     , environment(_agentModel.getInstanceID(), macro_env)
-    , agentModel(_agentModel)
+    , simulation(_agentModel)
+    , agentModel(&_agentModel)
+    , memory(_agentModel.getDeviceMemory())
     , d_cub_temp(nullptr)
     , d_cub_temp_size(0)
     , d_output_space(nullptr)
     , d_output_space_size(0)
     , agentOffsets(_agentOffsets)
     , agentData(_agentData)
-    , scatter(_scatter)
+    , agentBatches(_agentBatches)
+    , scatter(&_scatter)
     , streamId(_streamId)
     , stream(_stream) { }
 
+HostAPI::HostAPI(Simulation &_simulation,
+    RandomManager &rng,
+    std::unordered_map<std::string, util::Any> &env_properties,
+    const std::set<std::string> &env_read_only)
+    : random(rng)
+    , environment(env_properties, env_read_only)
+    , simulation(_simulation)
+    , agentModel(nullptr)
+    , memory(nullptr)
+    , d_cub_temp(nullptr)
+    , d_cub_temp_size(0)
+    , d_output_space(nullptr)
+    , d_output_space_size(0)
+    , agentOffsets(empty_agent_offsets)
+    , agentData(empty_agent_data)
+    , agentBatches(empty_agent_batches)
+    , scatter(nullptr)
+    , streamId(0)
+    , stream(nullptr) { }
+
 HostAPI::~HostAPI() {
     // @todo - cuda is not allowed in destructor
     if (d_cub_temp) {
-        gpuErrchk(cudaFree(d_cub_temp));
+        memory->deallocate(d_cub_temp);
         d_cub_temp_size = 0;
     }
     if (d_output_space_size) {
-        gpuErrchk(cudaFree(d_output_space));
+        memory->deallocate(d_output_space);
         d_output_space_size = 0;
     }
 }
 
+void HostAPI::requireDevice(const char *caller) const {
+    if (!agentModel || !scatter || !memory) {
+        THROW exception::InvalidOperation("Device agent storage is required, which is not available within CPUReferenceSimulation, "
+            "in %s\n", caller);
+    }
+}
+
 HostAgentAPI HostAPI::agent(const std::string &agent_name, const std::string &state_name) {
+    requireDevice("HostAPI::agent()");
     auto agt = agentData.find(agent_name);
     if (agt == agentData.end()) {
         THROW exception::InvalidAgent("Agent '%s' was not found in model description hierarchy.\n", agent_name.c_str());
@@ -49,7 +88,7 @@ HostAgentAPI HostAPI::agent(const std::string &agent_name, const std::string &st
     if (state == agt->second.end()) {
         THROW exception::InvalidAgentState("Agent '%s' in model description hierarchy does not contain state '%s'.\n", agent_name.c_str(), state_name.c_str());
     }
-    return HostAgentAPI(*this, agentModel.getAgent(agent_name), state_name, agentOffsets.at(agent_name), state->second);
+    return HostAgentAPI(*this, agentModel->getAgent(agent_name), state_name, agentOffsets.at(agent_name), state->second, agentBatches.at(agent_name).at(state_name));
 }
 
 bool HostAPI::tempStorageRequiresResize(const CUB_Config &cc, const unsigned int &items) {
@@ -62,11 +101,12 @@ bool HostAPI::tempStorageRequiresResize(const CUB_Config &cc, const unsigned int
 }
 void HostAPI::resizeTempStorage(const CUB_Config &cc, const unsigned int &items, const size_t &newSize) {
     NVTX_RANGE("HostAPI::resizeTempStorage");
+    requireDevice("HostAPI::resizeTempStorage()");
     if (newSize > d_cub_temp_size) {
         if (d_cub_temp) {
-            gpuErrchk(cudaFree(d_cub_temp));
+            memory->deallocate(d_cub_temp);
         }
-        gpuErrchk(cudaMalloc(&d_cub_temp, newSize));
+        d_cub_temp = memory->allocateOrThrow(newSize);
         d_cub_temp_size = newSize;
     }
     assert(tempStorageRequiresResize(cc, items));
@@ -80,7 +120,7 @@ void HostAPI::resizeTempStorage(const CUB_Config &cc, const unsigned int &items,
  * @return the current step count, 0 indexed unsigned.
  */
 unsigned int HostAPI::getStepCounter() const {
-    return agentModel.getStepCounter();
+    return simulation.getStepCounter();
 }
 
 }  // namespace flamegpu
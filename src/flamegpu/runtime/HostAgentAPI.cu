@@ -9,6 +9,11 @@ HostNewAgentAPI HostAgentAPI::newAgent() {
     // Point the returned object to the created agent
     return HostNewAgentAPI(newAgentData.back());
 }
+HostNewAgentBatch &HostAgentAPI::newAgents(const unsigned int count) {
+    // IDs for the whole batch are reserved at once
+    newAgentBatches.emplace_back(new HostNewAgentBatch(agent.getAgentDescription(), count, agent.nextID(count)));
+    return *newAgentBatches.back();
+}
 
 unsigned HostAgentAPI::count() {
     std::shared_ptr<DeviceAgentVector_impl> d_vec = agent.getPopulationVec(stateName);
@@ -48,7 +53,7 @@ DeviceAgentVector HostAgentAPI::getPopulationData() {
     std::shared_ptr<DeviceAgentVector_impl> d_vec = agent.getPopulationVec(stateName);
 
     if (!d_vec) {
-        d_vec = std::make_shared<DeviceAgentVector_impl>(static_cast<CUDAAgent&>(agent), stateName, agentOffsets, newAgentData, api.scatter, api.streamId, api.stream);
+        d_vec = std::make_shared<DeviceAgentVector_impl>(static_cast<CUDAAgent&>(agent), stateName, agentOffsets, newAgentData, *api.scatter, api.streamId, api.stream);
         agent.setPopulationVec(stateName, d_vec);
     }
     return *d_vec;
@@ -0,0 +1,28 @@
+#include "flamegpu/runtime/HostNewAgentBatch.h"
+
+namespace flamegpu {
+
+HostNewAgentBatch::HostNewAgentBatch(const AgentData &agent_desc, const size_type count, const id_t first_id)
+    : AgentVector(agent_desc, count) {
+    // Assign IDs in a single pass, rather than one at a time as with HostAgentAPI::newAgent()
+    const auto it = _data->find(ID_VARIABLE_NAME);
+    if (it == _data->end()) {
+        THROW exception::InvalidOperation("Agent '%s' is missing internal ID variable, "
+            "in HostNewAgentBatch::HostNewAgentBatch()\n",
+            agent->name.c_str());
+    }
+    id_t *ids = static_cast<id_t*>(it->second->getDataPtr());
+    for (size_type i = 0; i < count; ++i) {
+        ids[i] = first_id + i;
+    }
+}
+id_t HostNewAgentBatch::getID(const size_type index) const {
+    if (index >= _size) {
+        THROW exception::OutOfBoundsException("Index (%u) exceeds size of batch (%u), "
+            "in HostNewAgentBatch::getID()\n",
+            index, _size);
+    }
+    return static_cast<const id_t*>(_data->at(ID_VARIABLE_NAME)->getReadOnlyDataPtr())[index];
+}
+
+}  // namespace flamegpu
@@ -33,13 +33,20 @@ namespace detail {
      * Holds the length of the buffer (in terms of agents/items, rather than bytes)
      */
     __constant__ unsigned int d_lengths[Curve::MAX_VARIABLES];
+    /**
+     * Curve hashtable, greatest distance of any registered variable from its home slot
+     * Bounds the linear probing performed by device lookups
+     */
+    __constant__ unsigned int d_max_probe;
 }  // namespace detail
 
 std::mutex Curve::instance_mutex;
+static_assert(Curve::MAX_VARIABLES == static_cast<int>(CurveTable::MAX_VARIABLES), "Curve and CurveTable must have the same capacity");
 
 /* header implementations */
 __host__ Curve::Curve() :
-    deviceInitialised(false) {
+    deviceInitialised(false),
+    h_max_probe(0) {
 }
 __host__ void Curve::purge() {
     auto lock = std::unique_lock<std::shared_timed_mutex>(mutex);
@@ -61,15 +68,18 @@ __host__ void Curve::initialiseDevice() {
         gpuErrchk(cudaGetSymbolAddress(reinterpret_cast<void **>(&_d_sizes), curve::detail::d_sizes));
 
         // set values of hash table to 0 on host and device
-        memset(h_hashes, 0, sizeof(unsigned int)*MAX_VARIABLES);
-        memset(h_lengths, 0, sizeof(unsigned int)*MAX_VARIABLES);
-        memset(h_sizes, 0, sizeof(size_t)*MAX_VARIABLES);
+        table.clear();
+        // The device now matches the host table
+        table.clearDirty();
 
         // initialise data to 0 on device
         gpuErrchk(cudaMemset(_d_hashes, 0, sizeof(unsigned int)*MAX_VARIABLES));
         gpuErrchk(cudaMemset(_d_variables, 0, sizeof(void*)*MAX_VARIABLES));
         gpuErrchk(cudaMemset(_d_lengths, 0, sizeof(unsigned int)*MAX_VARIABLES));
         gpuErrchk(cudaMemset(_d_sizes, 0, sizeof(size_t)*MAX_VARIABLES));
+        const unsigned int max_probe = 0;
+        gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_max_probe, &max_probe, sizeof(unsigned int)));
+        h_max_probe = 0;
     }
     deviceInitialised = true;
 }
@@ -91,24 +101,8 @@ __host__ Curve::VariableHash Curve::variableRuntimeHash(unsigned int num) {
 }
 
 __host__ Curve::Variable Curve::getVariableHandle(VariableHash variable_hash) {
-    // Method is static, does not require mutex
-    unsigned int n = 0;
-    unsigned int i = (variable_hash) % MAX_VARIABLES;
-
-    while (h_hashes[i] != EMPTY_FLAG) {
-        if (h_hashes[i] == variable_hash) {
-            return i;
-        }
-        n += 1;
-        if (n >= MAX_VARIABLES) {
-            break;
-        }
-        i += 1;
-        if (i >= MAX_VARIABLES) {
-            i = 0;
-        }
-    }
-    return UNKNOWN_VARIABLE;
+    auto lock = std::shared_lock<std::shared_timed_mutex>(mutex);
+    return table.find(variable_hash);
 }
 
 __host__ Curve::Variable Curve::registerVariableByHash(VariableHash variable_hash, void * d_ptr, size_t size, unsigned int length) {
@@ -117,85 +111,51 @@ __host__ Curve::Variable Curve::registerVariableByHash(VariableHash variable_has
 }
 __host__ Curve::Variable Curve::_registerVariableByHash(VariableHash variable_hash, void * d_ptr, size_t size, unsigned int length) {
     // Do not lock mutex here, do it in the calling method
-    unsigned int n = 0;
-    assert(variable_hash != EMPTY_FLAG);
-    assert(variable_hash != DELETED_FLAG);
-    unsigned int i = (variable_hash) % MAX_VARIABLES;
-    while (h_hashes[i] != EMPTY_FLAG && h_hashes[i] != DELETED_FLAG) {
-        n += 1;
-        if (n >= MAX_VARIABLES) {
-            return UNKNOWN_VARIABLE;
-        }
-        i += 1;
-        if (i >= MAX_VARIABLES) {
-            i = 0;
-        }
-    }
-
-    h_hashes[i] = variable_hash;
-
-    // make a host copy of the pointer
-    h_d_variables[i] = d_ptr;
-
-    // set the size of the data type
-    h_sizes[i] = size;
-
-    // set the length of variable
-    h_lengths[i] = length;
-
-    return i;
+    return table.registerVariable(variable_hash, d_ptr, size, length);
 }
 __host__ int Curve::size() const {
     auto lock = std::shared_lock<std::shared_timed_mutex>(mutex);
     return _size();
 }
 __host__ int Curve::_size() const {
-    int rtn = 0;
-    for (unsigned int hash : h_hashes) {
-        if (hash != EMPTY_FLAG && hash != DELETED_FLAG)
-            rtn++;
-    }
-    return rtn;
+    return table.size();
 }
-/**
- * TODO: Does un-registering imply that other variable with collisions will no longer be found. I.e. do you need to re-register all other variable when one is removed.
- */
 __host__ void Curve::unregisterVariableByHash(VariableHash variable_hash) {
     auto lock = std::unique_lock<std::shared_timed_mutex>(mutex);
     _unregisterVariableByHash(variable_hash);
 }
 __host__ void Curve::_unregisterVariableByHash(VariableHash variable_hash) {
     // Do not lock mutex here, do it in the calling method
-    // get the curve variable
-    Variable cv = getVariableHandle(variable_hash);
-
-    // error checking
-    if (cv == UNKNOWN_VARIABLE) {
-        THROW exception::CurveException("Cannot unregister '%u', hash not found within curve table.", variable_hash);
-    }
-
-    // clear hash location on host and copy hash to device
-    h_hashes[cv] = DELETED_FLAG;
-
-    // set a host pointer to nullptr and copy to the device
-    h_d_variables[cv] = 0;
-
-    // set the empty size to 0
-    h_sizes[cv] = 0;
-
-    // set the length of variable to 0
-    h_lengths[cv] = 0;
+    table.unregisterVariable(variable_hash);
+}
+__host__ void Curve::bind(CurveTable::Binding &binding, void *const *d_ptrs, unsigned int length) {
+    auto lock = std::unique_lock<std::shared_timed_mutex>(mutex);
+    table.bind(binding, d_ptrs, length);
+}
+__host__ void Curve::unbind(CurveTable::Binding &binding) {
+    auto lock = std::unique_lock<std::shared_timed_mutex>(mutex);
+    table.unbind(binding);
 }
 __host__ void Curve::updateDevice() {
-    auto lock = std::shared_lock<std::shared_timed_mutex>(mutex);
+    // Unique lock, as the dirty slots are cleared
+    auto lock = std::unique_lock<std::shared_timed_mutex>(mutex);
     NVTX_RANGE("Curve::updateDevice()");
     // Initialise the device (if required)
     assert(deviceInitialised);  // No reason for this to ever fail. Purge calls init device
-    // Copy
-    gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_hashes, h_hashes, sizeof(unsigned int) * MAX_VARIABLES));
-    gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_variables, h_d_variables, sizeof(void*) * MAX_VARIABLES));
-    gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_sizes, h_sizes, sizeof(size_t) * MAX_VARIABLES));
-    gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_lengths, h_lengths, sizeof(unsigned int) * MAX_VARIABLES));
+    // Copy the slots which have changed
+    for (const auto &r : table.getDirty().getRanges()) {
+        const size_t n = r.second - r.first;
+        gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_hashes, table.getHashes() + r.first, sizeof(unsigned int) * n, sizeof(unsigned int) * r.first));
+        gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_variables, table.getPointers() + r.first, sizeof(void*) * n, sizeof(void*) * r.first));
+        gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_sizes, table.getSizes() + r.first, sizeof(size_t) * n, sizeof(size_t) * r.first));
+        gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_lengths, table.getLengths() + r.first, sizeof(unsigned int) * n, sizeof(unsigned int) * r.first));
+    }
+    table.clearDirty();
+    const unsigned int max_probe = table.getMaxProbe();
+    if (max_probe != h_max_probe) {
+        gpuErrchk(cudaMemcpyToSymbol(curve::detail::d_max_probe, &max_probe, sizeof(unsigned int)));
+        h_max_probe = max_probe;
+    }
 }
 
 Curve& Curve::getInstance() {
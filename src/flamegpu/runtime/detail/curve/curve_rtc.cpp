@@ -323,12 +323,13 @@ void* CurveRTCHost::getNewAgentVariableCachePtr(const char* variableName) {
     THROW exception::UnknownInternalError("Variable '%s' not found when accessing variable, in CurveRTCHost::getNewAgentVariableCachePtr()", variableName);
 }
 
-void CurveRTCHost::registerEnvVariable(const char* propertyName, ptrdiff_t offset, const char* type, size_t type_size, unsigned int elements) {
+void CurveRTCHost::registerEnvVariable(const char* propertyName, ptrdiff_t offset, const char* type, size_t type_size, unsigned int elements, bool indirect) {
     RTCEnvVariableProperties props;
     props.type = CurveRTCHost::demangle(type);
     props.elements = elements;
     props.offset = offset;
     props.type_size = type_size;
+    props.indirect = indirect;
     if (!RTCEnvVariables.emplace(propertyName, props).second) {
         THROW exception::UnknownInternalError("Environment property with name '%s' is already registered, in CurveRTCHost::registerEnvVariable()", propertyName);
     }
@@ -394,7 +395,12 @@ void CurveRTCHost::initHeaderEnvironment() {
                 getEnvVariableImpl <<   "            return {};\n";
                 getEnvVariableImpl <<   "        }\n";
                 getEnvVariableImpl <<   "#endif\n";
-                getEnvVariableImpl <<   "        return *reinterpret_cast<T*>(reinterpret_cast<void*>(flamegpu::detail::curve::" << getVariableSymbolName() <<" + " << props.offset << "));\n";
+                if (props.indirect) {
+                    // Property was spilled to global memory, the cache holds a pointer to it
+                    getEnvVariableImpl <<   "        return *reinterpret_cast<T*>(*reinterpret_cast<char* const*>(reinterpret_cast<void*>(flamegpu::detail::curve::" << getVariableSymbolName() <<" + " << props.offset << ")));\n";
+                } else {
+                    getEnvVariableImpl <<   "        return *reinterpret_cast<T*>(reinterpret_cast<void*>(flamegpu::detail::curve::" << getVariableSymbolName() <<" + " << props.offset << "));\n";
+                }
                 getEnvVariableImpl <<   "    };\n";
             }
         }
@@ -425,7 +431,11 @@ void CurveRTCHost::initHeaderEnvironment() {
                 getEnvArrayVariableImpl << "            return {};\n";
                 getEnvArrayVariableImpl << "        }\n";
                 getEnvArrayVariableImpl << "#endif\n";
-                getEnvArrayVariableImpl << "        return reinterpret_cast<T*>(reinterpret_cast<void*>(flamegpu::detail::curve::" << getVariableSymbolName() <<" + " << props.offset << "))[index];\n";
+                if (props.indirect) {
+                    getEnvArrayVariableImpl << "        return reinterpret_cast<T*>(*reinterpret_cast<char* const*>(reinterpret_cast<void*>(flamegpu::detail::curve::" << getVariableSymbolName() <<" + " << props.offset << ")))[index];\n";
+                } else {
+                    getEnvArrayVariableImpl << "        return reinterpret_cast<T*>(reinterpret_cast<void*>(flamegpu::detail::curve::" << getVariableSymbolName() <<" + " << props.offset << "))[index];\n";
+                }
                 getEnvArrayVariableImpl << "    };\n";
             }
         }
@@ -0,0 +1,144 @@
+#include "flamegpu/runtime/detail/curve/curve_table.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace detail {
+namespace curve {
+
+const int CurveTable::UNKNOWN_VARIABLE;
+const unsigned int CurveTable::MAX_VARIABLES;
+const CurveTable::VariableHash CurveTable::EMPTY_FLAG;
+const CurveTable::VariableHash CurveTable::DELETED_FLAG;
+
+CurveTable::CurveTable() {
+    clear();
+}
+void CurveTable::clear() {
+    memset(hashes, 0, sizeof(hashes));
+    memset(pointers, 0, sizeof(pointers));
+    memset(sizes, 0, sizeof(sizes));
+    memset(lengths, 0, sizeof(lengths));
+    memset(probe_counts, 0, sizeof(probe_counts));
+    max_probe = 0;
+    count = 0;
+    dirty.clear();
+    dirty.add(0, MAX_VARIABLES);
+}
+void CurveTable::setSlot(const unsigned int slot, const VariableHash variable_hash, void *ptr, const size_t size, const unsigned int length) {
+    const unsigned int probe = (slot - getHomeSlot(variable_hash)) & (MAX_VARIABLES - 1);
+    hashes[slot] = variable_hash;
+    pointers[slot] = ptr;
+    sizes[slot] = size;
+    lengths[slot] = length;
+    ++probe_counts[probe];
+    if (probe > max_probe)
+        max_probe = probe;
+    ++count;
+    dirty.add(slot, slot + 1);
+}
+void CurveTable::clearSlot(const unsigned int slot) {
+    const unsigned int probe = (slot - getHomeSlot(hashes[slot])) & (MAX_VARIABLES - 1);
+    hashes[slot] = EMPTY_FLAG;
+    pointers[slot] = nullptr;
+    sizes[slot] = 0;
+    lengths[slot] = 0;
+    --probe_counts[probe];
+    while (max_probe && !probe_counts[max_probe])
+        --max_probe;
+    --count;
+    dirty.add(slot, slot + 1);
+}
+CurveTable::Variable CurveTable::registerVariable(const VariableHash variable_hash, void *ptr, const size_t size, const unsigned int length) {
+    assert(variable_hash != EMPTY_FLAG);
+    assert(variable_hash != DELETED_FLAG);
+    const unsigned int home = getHomeSlot(variable_hash);
+    for (unsigned int x = 0; x < MAX_VARIABLES; ++x) {
+        const unsigned int i = (home + x) & (MAX_VARIABLES - 1);
+        if (hashes[i] == EMPTY_FLAG) {
+            setSlot(i, variable_hash, ptr, size, length);
+            return static_cast<Variable>(i);
+        }
+    }
+    return UNKNOWN_VARIABLE;
+}
+void CurveTable::unregisterVariable(const VariableHash variable_hash) {
+    const Variable cv = find(variable_hash);
+    if (cv == UNKNOWN_VARIABLE) {
+        THROW exception::CurveException("Cannot unregister '%u', hash not found within curve table.", variable_hash);
+    }
+    clearSlot(static_cast<unsigned int>(cv));
+}
+CurveTable::Variable CurveTable::find(const VariableHash variable_hash) const {
+    if (variable_hash == EMPTY_FLAG)
+        return UNKNOWN_VARIABLE;
+    const unsigned int home = getHomeSlot(variable_hash);
+    for (unsigned int x = 0; x <= max_probe; ++x) {
+        const unsigned int i = (home + x) & (MAX_VARIABLES - 1);
+        if (hashes[i] == variable_hash)
+            return static_cast<Variable>(i);
+    }
+    return UNKNOWN_VARIABLE;
+}
+void CurveTable::bind(Binding &binding, void *const *ptrs, const unsigned int length) {
+    if (binding.bound) {
+        bool intact = true;
+        for (const auto &v : binding.variables) {
+            if (hashes[v.slot] != v.hash) {
+                intact = false;
+                break;
+            }
+        }
+        if (intact) {
+            // Already registered, so only the buffers need updating
+            for (size_t i = 0; i < binding.variables.size(); ++i) {
+                const unsigned int slot = static_cast<unsigned int>(binding.variables[i].slot);
+                if (pointers[slot] != ptrs[i] || lengths[slot] != length) {
+                    pointers[slot] = ptrs[i];
+                    lengths[slot] = length;
+                    dirty.add(slot, slot + 1);
+                }
+            }
+            return;
+        }
+        // The table has been cleared or modified since the binding was bound, so release what remains and register afresh
+        for (auto &v : binding.variables) {
+            if (hashes[v.slot] == v.hash)
+                clearSlot(static_cast<unsigned int>(v.slot));
+            v.slot = UNKNOWN_VARIABLE;
+        }
+        binding.bound = false;
+    }
+    for (size_t i = 0; i < binding.variables.size(); ++i) {
+        auto &v = binding.variables[i];
+        v.slot = registerVariable(v.hash, ptrs[i], v.size, length);
+        if (v.slot == UNKNOWN_VARIABLE) {
+            // Roll back the partial binding, so the table is left unchanged
+            for (size_t j = 0; j < i; ++j) {
+                clearSlot(static_cast<unsigned int>(binding.variables[j].slot));
+                binding.variables[j].slot = UNKNOWN_VARIABLE;
+            }
+            THROW exception::CurveException("Curve table is full (%u variables), unable to register '%u', in CurveTable::bind()\n",
+                MAX_VARIABLES, v.hash);
+        }
+    }
+    binding.bound = true;
+}
+void CurveTable::unbind(Binding &binding) {
+    if (!binding.bound)
+        return;
+    for (auto &v : binding.variables) {
+        // Skip slots which no longer hold the variable, e.g. if the table was cleared whilst bound
+        if (hashes[v.slot] == v.hash)
+            clearSlot(static_cast<unsigned int>(v.slot));
+        v.slot = UNKNOWN_VARIABLE;
+    }
+    binding.bound = false;
+}
+
+}  // namespace curve
+}  // namespace detail
+}  // namespace flamegpu
@@ -114,6 +114,11 @@ void MessageBucket::CUDAModelHandler::buildIndex(CUDAScatter &scatter, const uns
     }
 }
 
+void MessageBucket::CUDAModelHandler::restoreIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
+    // Messages are already in bucket order, so rebuilding the index only reproduces the partition boundary matrix
+    buildIndex(scatter, streamId, stream);
+}
+
 void MessageBucket::CUDAModelHandler::resizeCubTemp() {
     size_t bytesCheck = 0;
     gpuErrchk(cub::DeviceScan::ExclusiveSum(nullptr, bytesCheck, hd_data.PBM, d_histogram, bucketCount + 1));
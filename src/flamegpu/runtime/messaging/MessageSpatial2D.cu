@@ -1,5 +1,7 @@
 #include "flamegpu/runtime/messaging/MessageSpatial2D.h"
 
+#include <algorithm>
+
 #ifdef _MSC_VER
 #pragma warning(push, 1)
 #pragma warning(disable : 4706 4834)
@@ -31,11 +33,25 @@ MessageSpatial2D::CUDAModelHandler::CUDAModelHandler(CUDAMessage &a)
     hd_data.min[1] = d.minY;
     hd_data.max[0] = d.maxX;
     hd_data.max[1] = d.maxY;
-    binCount = 1;
+    gridBinCount = 1;
     for (unsigned int axis = 0; axis < 2; ++axis) {
         hd_data.environmentWidth[axis] = hd_data.max[axis] - hd_data.min[axis];
         hd_data.gridDim[axis] = static_cast<unsigned int>(ceil(hd_data.environmentWidth[axis] / hd_data.radius));
-        binCount *= hd_data.gridDim[axis];
+        gridBinCount *= hd_data.gridDim[axis];
+    }
+    binCount = static_cast<unsigned int>(gridBinCount);
+    hd_data.PBM = nullptr;
+    hd_data.sparseKeys = nullptr;
+    hd_data.sparseCapacity = 0;
+    if (d.sparse) {
+        // Bin indices must fit within the table's keys, without colliding with the empty key
+        if (gridBinCount >= util::detail::sparse_cell_table::EMPTY) {
+            THROW exception::InvalidMessage("Spatial message '%s' has %llu bins, sparse partitioning supports a maximum of %u bins, "
+                "in MessageSpatial2D::CUDAModelHandler::CUDAModelHandler()\n", d.name.c_str(), static_cast<unsigned long long>(gridBinCount), util::detail::sparse_cell_table::EMPTY - 1);
+        }
+        // Only occupied bins are stored, so the PBM is sized according to the message list rather than the environment
+        binCount = util::detail::sparse_cell_table::getCapacity(std::min<uint64_t>(a.getMaximumListSize(), gridBinCount));
+        hd_data.sparseCapacity = binCount;
     }
 }
 MessageSpatial2D::CUDAModelHandler::~CUDAModelHandler() { }
@@ -53,6 +69,10 @@ __global__ void atomicHistogram2D(
 
     MessageSpatial2D::GridPos2D gridPos = getGridPosition2D(md, x[index], y[index]);
     unsigned int hash = getHash2D(md, gridPos);
+    if (md->sparseCapacity) {
+        // Messages are binned by the slot which holds their bin within the sparse table
+        hash = util::detail::sparse_cell_table::insert(md->sparseKeys, md->sparseCapacity, hash);
+    }
     bin_index[index] = hash;
     unsigned int bin_idx = atomicInc((unsigned int*)&pbm_counts[hash], 0xFFFFFFFF);
     bin_sub_index[index] = bin_idx;
@@ -62,12 +82,19 @@ void MessageSpatial2D::CUDAModelHandler::init(CUDAScatter &, const unsigned int
     allocateMetaDataDevicePtr();
     // Set PBM to 0
     gpuErrchk(cudaMemset(hd_data.PBM, 0x00000000, (binCount + 1) * sizeof(unsigned int)));
+    if (hd_data.sparseCapacity) {
+        // Mark all slots of the sparse table empty
+        gpuErrchk(cudaMemset(hd_data.sparseKeys, 0xff, binCount * sizeof(unsigned int)));
+    }
 }
 
 void MessageSpatial2D::CUDAModelHandler::allocateMetaDataDevicePtr() {
     if (d_data == nullptr) {
         gpuErrchk(cudaMalloc(&d_histogram, (binCount + 1) * sizeof(unsigned int)));
         gpuErrchk(cudaMalloc(&hd_data.PBM, (binCount + 1) * sizeof(unsigned int)));
+        if (hd_data.sparseCapacity) {
+            gpuErrchk(cudaMalloc(&hd_data.sparseKeys, binCount * sizeof(unsigned int)));
+        }
         gpuErrchk(cudaMalloc(&d_data, sizeof(MetaData)));
         gpuErrchk(cudaMemcpy(d_data, &hd_data, sizeof(MetaData), cudaMemcpyHostToDevice));
         resizeCubTemp();
@@ -80,10 +107,12 @@ void MessageSpatial2D::CUDAModelHandler::freeMetaDataDevicePtr() {
         gpuErrchk(cudaFree(d_CUB_temp_storage));
         gpuErrchk(cudaFree(d_histogram));
         gpuErrchk(cudaFree(hd_data.PBM));
+        gpuErrchk(cudaFree(hd_data.sparseKeys));
         gpuErrchk(cudaFree(d_data));
         d_CUB_temp_storage = nullptr;
         d_histogram = nullptr;
         hd_data.PBM = nullptr;
+        hd_data.sparseKeys = nullptr;
         d_data = nullptr;
         if (d_keys) {
             d_keys_vals_storage_bytes = 0;
@@ -99,6 +128,10 @@ void MessageSpatial2D::CUDAModelHandler::buildIndex(CUDAScatter &scatter, const
     NVTX_RANGE("MessageSpatial2D::CUDAModelHandler::buildIndex");
     const unsigned int MESSAGE_COUNT = this->sim_message.getMessageCount();
     resizeKeysVals(this->sim_message.getMaximumListSize());  // Resize based on allocated amount rather than message count
+    if (hd_data.sparseCapacity) {  // Reset sparse bin table
+        resizeSparseTable(this->sim_message.getMaximumListSize(), stream);
+        gpuErrchk(cudaMemsetAsync(hd_data.sparseKeys, 0xff, binCount * sizeof(unsigned int), stream));
+    }
     {  // Build atomic histogram
         gpuErrchk(cudaMemsetAsync(d_histogram, 0x00000000, (binCount + 1) * sizeof(unsigned int), stream));
         int blockSize;  // The launch configurator returned block size
@@ -124,6 +157,11 @@ void MessageSpatial2D::CUDAModelHandler::buildIndex(CUDAScatter &scatter, const
     }
 }
 
+void MessageSpatial2D::CUDAModelHandler::restoreIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
+    // Messages are already in bin order, so rebuilding the index only reproduces the partition boundary matrix
+    buildIndex(scatter, streamId, stream);
+}
+
 void MessageSpatial2D::CUDAModelHandler::resizeCubTemp() {
     size_t bytesCheck = 0;
     gpuErrchk(cub::DeviceScan::ExclusiveSum(nullptr, bytesCheck, hd_data.PBM, d_histogram, binCount + 1));
@@ -136,6 +174,22 @@ void MessageSpatial2D::CUDAModelHandler::resizeCubTemp() {
     }
 }
 
+void MessageSpatial2D::CUDAModelHandler::resizeSparseTable(const unsigned int &maxOccupied, const cudaStream_t &stream) {
+    const unsigned int capacity = util::detail::sparse_cell_table::getCapacity(std::min<uint64_t>(maxOccupied, gridBinCount));
+    if (capacity > hd_data.sparseCapacity) {
+        gpuErrchk(cudaFree(hd_data.sparseKeys));
+        gpuErrchk(cudaFree(hd_data.PBM));
+        gpuErrchk(cudaFree(d_histogram));
+        binCount = capacity;
+        hd_data.sparseCapacity = capacity;
+        gpuErrchk(cudaMalloc(&hd_data.sparseKeys, binCount * sizeof(unsigned int)));
+        gpuErrchk(cudaMalloc(&hd_data.PBM, (binCount + 1) * sizeof(unsigned int)));
+        gpuErrchk(cudaMalloc(&d_histogram, (binCount + 1) * sizeof(unsigned int)));
+        gpuErrchk(cudaMemcpyAsync(d_data, &hd_data, sizeof(MetaData), cudaMemcpyHostToDevice, stream));
+        resizeCubTemp();
+    }
+}
+
 void MessageSpatial2D::CUDAModelHandler::resizeKeysVals(const unsigned int &newSize) {
     size_t bytesCheck = newSize * sizeof(unsigned int);
     if (bytesCheck > d_keys_vals_storage_bytes) {
@@ -156,7 +210,8 @@ MessageSpatial2D::Data::Data(const std::shared_ptr<const ModelData> &model, cons
     , minX(NAN)
     , minY(NAN)
     , maxX(NAN)
-    , maxY(NAN) {
+    , maxY(NAN)
+    , sparse(false) {
     description = std::unique_ptr<MessageSpatial2D::Description>(new MessageSpatial2D::Description(model, this));
     description->newVariable<float>("x");
     description->newVariable<float>("y");
@@ -167,7 +222,8 @@ MessageSpatial2D::Data::Data(const std::shared_ptr<const ModelData> &model, cons
     , minX(other.minX)
     , minY(other.minY)
     , maxX(other.maxX)
-    , maxY(other.maxY) {
+    , maxY(other.maxY)
+    , sparse(other.sparse) {
     description = std::unique_ptr<MessageSpatial2D::Description>(model ? new MessageSpatial2D::Description(model, this) : nullptr);
     if (isnan(radius)) {
         THROW exception::InvalidMessage("Radius has not been set in spatial message '%s'.", other.name.c_str());
@@ -259,6 +315,10 @@ void MessageSpatial2D::Description::setMax(const float &x, const float &y) {
     reinterpret_cast<Data *>(message)->maxY = y;
 }
 
+void MessageSpatial2D::Description::setSparse(const bool &sparse) {
+    reinterpret_cast<Data *>(message)->sparse = sparse;
+}
+
 float MessageSpatial2D::Description::getRadius() const {
     return reinterpret_cast<Data *>(message)->radius;
 }
@@ -274,5 +334,8 @@ float MessageSpatial2D::Description::getMaxX() const {
 float MessageSpatial2D::Description::getMaxY() const {
     return reinterpret_cast<Data *>(message)->maxY;
 }
+bool MessageSpatial2D::Description::getSparse() const {
+    return reinterpret_cast<Data *>(message)->sparse;
+}
 
 }  // namespace flamegpu
@@ -1,6 +1,8 @@
 #include "flamegpu/runtime/messaging/MessageSpatial3D/MessageSpatial3DHost.h"
 #include "flamegpu/runtime/messaging/MessageSpatial3D/MessageSpatial3DDevice.cuh"
 
+#include <algorithm>
+
 #include "flamegpu/gpu/CUDAScatter.cuh"
 #ifdef _MSC_VER
 #pragma warning(push, 1)
@@ -27,11 +29,25 @@ MessageSpatial3D::CUDAModelHandler::CUDAModelHandler(CUDAMessage &a)
     hd_data.max[0] = d.maxX;
     hd_data.max[1] = d.maxY;
     hd_data.max[2] = d.maxZ;
-    binCount = 1;
+    gridBinCount = 1;
     for (unsigned int axis = 0; axis < 3; ++axis) {
         hd_data.environmentWidth[axis] = hd_data.max[axis] - hd_data.min[axis];
         hd_data.gridDim[axis] = static_cast<unsigned int>(ceil(hd_data.environmentWidth[axis] / hd_data.radius));
-        binCount *= hd_data.gridDim[axis];
+        gridBinCount *= hd_data.gridDim[axis];
+    }
+    binCount = static_cast<unsigned int>(gridBinCount);
+    hd_data.PBM = nullptr;
+    hd_data.sparseKeys = nullptr;
+    hd_data.sparseCapacity = 0;
+    if (d.sparse) {
+        // Bin indices must fit within the table's keys, without colliding with the empty key
+        if (gridBinCount >= util::detail::sparse_cell_table::EMPTY) {
+            THROW exception::InvalidMessage("Spatial message '%s' has %llu bins, sparse partitioning supports a maximum of %u bins, "
+                "in MessageSpatial3D::CUDAModelHandler::CUDAModelHandler()\n", d.name.c_str(), static_cast<unsigned long long>(gridBinCount), util::detail::sparse_cell_table::EMPTY - 1);
+        }
+        // Only occupied bins are stored, so the PBM is sized according to the message list rather than the environment
+        binCount = util::detail::sparse_cell_table::getCapacity(std::min<uint64_t>(a.getMaximumListSize(), gridBinCount));
+        hd_data.sparseCapacity = binCount;
     }
     // Device allocation occurs in allocateMetaDataDevicePtr rather than the constructor.
 }
@@ -51,6 +67,10 @@ __global__ void atomicHistogram3D(
 
     MessageSpatial3D::GridPos3D gridPos = getGridPosition3D(md, x[index], y[index], z[index]);
     unsigned int hash = getHash3D(md, gridPos);
+    if (md->sparseCapacity) {
+        // Messages are binned by the slot which holds their bin within the sparse table
+        hash = util::detail::sparse_cell_table::insert(md->sparseKeys, md->sparseCapacity, hash);
+    }
     bin_index[index] = hash;
     unsigned int bin_idx = atomicInc((unsigned int*)&pbm_counts[hash], 0xFFFFFFFF);
     bin_sub_index[index] = bin_idx;
@@ -60,12 +80,19 @@ void MessageSpatial3D::CUDAModelHandler::init(CUDAScatter &, const unsigned int
     allocateMetaDataDevicePtr();
     // Set PBM to 0
     gpuErrchk(cudaMemset(hd_data.PBM, 0x00000000, (binCount + 1) * sizeof(unsigned int)));
+    if (hd_data.sparseCapacity) {
+        // Mark all slots of the sparse table empty
+        gpuErrchk(cudaMemset(hd_data.sparseKeys, 0xff, binCount * sizeof(unsigned int)));
+    }
 }
 
 void MessageSpatial3D::CUDAModelHandler::allocateMetaDataDevicePtr() {
     if (d_data == nullptr) {
         gpuErrchk(cudaMalloc(&d_histogram, (binCount + 1) * sizeof(unsigned int)));
         gpuErrchk(cudaMalloc(&hd_data.PBM, (binCount + 1) * sizeof(unsigned int)));
+        if (hd_data.sparseCapacity) {
+            gpuErrchk(cudaMalloc(&hd_data.sparseKeys, binCount * sizeof(unsigned int)));
+        }
         gpuErrchk(cudaMalloc(&d_data, sizeof(MetaData)));
         gpuErrchk(cudaMemcpy(d_data, &hd_data, sizeof(MetaData), cudaMemcpyHostToDevice));
         resizeCubTemp();
@@ -78,10 +105,12 @@ void MessageSpatial3D::CUDAModelHandler::freeMetaDataDevicePtr() {
         gpuErrchk(cudaFree(d_CUB_temp_storage));
         gpuErrchk(cudaFree(d_histogram));
         gpuErrchk(cudaFree(hd_data.PBM));
+        gpuErrchk(cudaFree(hd_data.sparseKeys));
         gpuErrchk(cudaFree(d_data));
         d_CUB_temp_storage = nullptr;
         d_histogram = nullptr;
         hd_data.PBM = nullptr;
+        hd_data.sparseKeys = nullptr;
         d_data = nullptr;
         if (d_keys) {
             d_keys_vals_storage_bytes = 0;
@@ -97,6 +126,10 @@ void MessageSpatial3D::CUDAModelHandler::buildIndex(CUDAScatter &scatter, const
     NVTX_RANGE("MessageSpatial3D::CUDAModelHandler::buildIndex");
     const unsigned int MESSAGE_COUNT = this->sim_message.getMessageCount();
     resizeKeysVals(this->sim_message.getMaximumListSize());  // Resize based on allocated amount rather than message count
+    if (hd_data.sparseCapacity) {  // Reset sparse bin table
+        resizeSparseTable(this->sim_message.getMaximumListSize(), stream);
+        gpuErrchk(cudaMemsetAsync(hd_data.sparseKeys, 0xff, binCount * sizeof(unsigned int), stream));
+    }
     {  // Build atomic histogram
         gpuErrchk(cudaMemsetAsync(d_histogram, 0x00000000, (binCount + 1) * sizeof(unsigned int), stream));
         int blockSize;  // The launch configurator returned block size
@@ -123,6 +156,11 @@ void MessageSpatial3D::CUDAModelHandler::buildIndex(CUDAScatter &scatter, const
     }
 }
 
+void MessageSpatial3D::CUDAModelHandler::restoreIndex(CUDAScatter &scatter, const unsigned int &streamId, const cudaStream_t &stream) {
+    // Messages are already in bin order, so rebuilding the index only reproduces the partition boundary matrix
+    buildIndex(scatter, streamId, stream);
+}
+
 void MessageSpatial3D::CUDAModelHandler::resizeCubTemp() {
     size_t bytesCheck = 0;
     gpuErrchk(cub::DeviceScan::ExclusiveSum(nullptr, bytesCheck, hd_data.PBM, d_histogram, binCount + 1));
@@ -135,6 +173,22 @@ void MessageSpatial3D::CUDAModelHandler::resizeCubTemp() {
     }
 }
 
+void MessageSpatial3D::CUDAModelHandler::resizeSparseTable(const unsigned int &maxOccupied, const cudaStream_t &stream) {
+    const unsigned int capacity = util::detail::sparse_cell_table::getCapacity(std::min<uint64_t>(maxOccupied, gridBinCount));
+    if (capacity > hd_data.sparseCapacity) {
+        gpuErrchk(cudaFree(hd_data.sparseKeys));
+        gpuErrchk(cudaFree(hd_data.PBM));
+        gpuErrchk(cudaFree(d_histogram));
+        binCount = capacity;
+        hd_data.sparseCapacity = capacity;
+        gpuErrchk(cudaMalloc(&hd_data.sparseKeys, binCount * sizeof(unsigned int)));
+        gpuErrchk(cudaMalloc(&hd_data.PBM, (binCount + 1) * sizeof(unsigned int)));
+        gpuErrchk(cudaMalloc(&d_histogram, (binCount + 1) * sizeof(unsigned int)));
+        gpuErrchk(cudaMemcpyAsync(d_data, &hd_data, sizeof(MetaData), cudaMemcpyHostToDevice, stream));
+        resizeCubTemp();
+    }
+}
+
 void MessageSpatial3D::CUDAModelHandler::resizeKeysVals(const unsigned int &newSize) {
     size_t bytesCheck = newSize * sizeof(unsigned int);
     if (bytesCheck > d_keys_vals_storage_bytes) {
@@ -265,6 +319,10 @@ void MessageSpatial3D::Description::setMax(const float &x, const float &y, const
     reinterpret_cast<Data *>(message)->maxZ = z;
 }
 
+void MessageSpatial3D::Description::setSparse(const bool &sparse) {
+    reinterpret_cast<Data *>(message)->sparse = sparse;
+}
+
 float MessageSpatial3D::Description::getRadius() const {
     return reinterpret_cast<Data *>(message)->radius;
 }
@@ -286,5 +344,8 @@ float MessageSpatial3D::Description::getMaxY() const {
 float MessageSpatial3D::Description::getMaxZ() const {
     return reinterpret_cast<Data *>(message)->maxZ;
 }
+bool MessageSpatial3D::Description::getSparse() const {
+    return reinterpret_cast<Data *>(message)->sparse;
+}
 
 }  // namespace flamegpu
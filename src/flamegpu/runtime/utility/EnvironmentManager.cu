@@ -1,5 +1,7 @@
 #include "flamegpu/runtime/utility/EnvironmentManager.cuh"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <memory>
 
@@ -22,142 +24,143 @@ namespace detail {
     __constant__ char c_envPropBuffer[EnvironmentManager::MAX_BUFFER_SIZE];
 }  // namespace detail
 
+namespace {
+/**
+ * Alignment of the start of each instance's constant region
+ * This is the largest base type supported by environment properties
+ */
+const size_t REGION_ALIGNMENT = 8;
+/**
+ * Dirty byte ranges separated by no more than this many clean bytes are copied to the device as a single range
+ * Copying a few clean bytes is cheaper than the overhead of issuing an additional copy
+ */
+const size_t COPY_COALESCE_GAP = 256;
+}  // namespace
+
 std::mutex EnvironmentManager::instance_mutex;
 const char EnvironmentManager::CURVE_NAMESPACE_STRING[23] = "ENVIRONMENT_PROPERTIES";
 
 EnvironmentManager::EnvironmentManager() :
     CURVE_NAMESPACE_HASH(detail::curve::Curve::variableRuntimeHash(CURVE_NAMESPACE_STRING)),
-    nextFree(0),
-    m_freeSpace(EnvironmentManager::MAX_BUFFER_SIZE),
-    freeFragments(),
+    instances(std::make_shared<const InstanceMap>()),
     deviceInitialised(false) { }
 
 void EnvironmentManager::purge() {
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
     deviceInitialised = false;
-    for (auto &a : deviceRequiresUpdate) {
-        a.second.c_update_required = true;
-        a.second.rtc_update_required = true;
-        a.second.curve_registration_required = true;
-    }
-    deviceRequiresUpdate_lock.unlock();
-    // We are now able to only purge the device stuff after device reset?
-    // freeFragments.clear();
-    // m_freeSpace = EnvironmentManager::MAX_BUFFER_SIZE;
-    // nextFree = 0;
-    // cuda_agent_models.clear();
-    // properties.clear();
-    // mapped_properties.clear();
-    // rtc_caches.clear();
+    // Device memory was released by the device reset, and curve has been purged too
+    for (auto &i : *std::atomic_load(&instances)) {
+        Instance &instance = *i.second;
+        instance.d_global = nullptr;
+        instance.d_global_capacity = 0;
+        instance.curve_registered.clear();
+        instance.storage.markAllDirty();
+        instance.flags.rtc_update_required = true;
+        instance.flags.curve_registration_required = true;
+    }
     initialiseDevice();
 }
 
 void EnvironmentManager::init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Error if reinit
-    for (auto &&i : properties) {
-        if (i.first.first == instance_id) {
-            THROW exception::EnvDescriptionAlreadyLoaded("Environment description with same instance id '%u' is already loaded, "
-                "in EnvironmentManager::init().",
-                instance_id);
-        }
-    }
-
-    // Add to device requires update map
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    deviceRequiresUpdate.emplace(instance_id, EnvUpdateFlags());
-    deviceRequiresUpdate_lock.unlock();
-
-    // Build a DefragMap to send to defragger method
-    DefragMap orderedProperties;
-    size_t newSize = 0;
-    for (auto _i = desc.properties.begin(); _i != desc.properties.end(); ++_i) {
-        const auto &i = _i->second;
-        NamePair name = toName(instance_id, _i->first);
-        DefragProp prop = DefragProp(i.data.ptr, i.data.length, i.isConst, i.data.elements, i.data.type);
-        const size_t typeSize = i.data.length / i.data.elements;
-        orderedProperties.emplace(std::make_pair(typeSize, name), prop);
-        newSize += i.data.length;
-    }
-    if (newSize > m_freeSpace) {
-        // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-        // Arguably this check should be performed by init()
-        THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties,"
-            "in EnvironmentManager::init().");
-    }
-    // Defragment to rebuild it properly
-    defragment(detail::curve::Curve::getInstance(), &orderedProperties, {}, isPureRTC);
-    // Setup RTC version
-    buildRTCOffsets(instance_id, instance_id, orderedProperties);
+    initInstance(instance_id, desc, isPureRTC, nullptr, nullptr);
 }
 void EnvironmentManager::init(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC, const unsigned int &master_instance_id, const SubEnvironmentData &mapping) {
-    assert(deviceRequiresUpdate.size());  // submodel init should never be called first, requires parent init first for mapping
+    initInstance(instance_id, desc, isPureRTC, &master_instance_id, &mapping);
+}
+void EnvironmentManager::initInstance(const unsigned int &instance_id, const EnvironmentDescription &desc, bool isPureRTC, const unsigned int *master_instance_id, const SubEnvironmentData *mapping) {
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
-
-    // Add to device requires update map
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    deviceRequiresUpdate.emplace(instance_id, EnvUpdateFlags());
-    deviceRequiresUpdate_lock.unlock();
-
+    const std::shared_ptr<const InstanceMap> current = std::atomic_load(&instances);
     // Error if reinit
-    for (auto &&i : properties) {
-        if (i.first.first == instance_id) {
-            THROW exception::EnvDescriptionAlreadyLoaded("Environment description with same instance id '%u' is already loaded, "
-                "in EnvironmentManager::init().",
-                instance_id);
+    if (current->find(instance_id) != current->end()) {
+        THROW exception::EnvDescriptionAlreadyLoaded("Environment description with same instance id '%u' is already loaded, "
+            "in EnvironmentManager::init().",
+            instance_id);
+    }
+    std::shared_ptr<Instance> master;
+    if (master_instance_id) {
+        const auto m = current->find(*master_instance_id);
+        // Submodel init should never be called first, requires parent init first for mapping
+        if (m == current->end()) {
+            THROW exception::UnknownInternalError("Master instance with id '%u' not registered in EnvironmentManager, "
+                "in EnvironmentManager::init().", *master_instance_id);
+        }
+        master = m->second;
+    }
+    // Order unmapped properties by descending alignment, so that they pack without padding
+    std::vector<std::string> order;
+    size_t required = 0;
+    for (const auto &p : desc.getPropertiesMap()) {
+        if (!mapping || mapping->properties.find(p.first) == mapping->properties.end()) {
+            order.push_back(p.first);
+            required += p.second.data.length;
         }
     }
-
-    // Build a DefragMap of to send to defragger method
-    DefragMap orderedProperties;
-    size_t newSize = 0;
-    std::set<NamePair> new_mapped_props;
-    for (auto _i = desc.properties.begin(); _i != desc.properties.end(); ++_i) {
-        auto prop_mapping = mapping.properties.find(_i->first);
-        const auto &i = _i->second;
-        NamePair name = toName(instance_id, _i->first);
-        if (prop_mapping == mapping.properties.end()) {
-            // Property is not mapped, so add to defrag map
-            DefragProp prop = DefragProp(i.data.ptr, i.data.length, i.isConst, i.data.elements, i.data.type);
-            const size_t typeSize = i.data.length / i.data.elements;
-            orderedProperties.emplace(std::make_pair(typeSize, name), prop);
-            newSize += i.data.length;
-        } else {
-            // Property is mapped, follow it's mapping upwards until we find the highest parent
-            NamePair ultimateParent = toName(master_instance_id, prop_mapping->second);
-            auto propFind = mapped_properties.find(ultimateParent);
-            while (propFind != mapped_properties.end()) {
-                ultimateParent = propFind->second.masterProp;
-                propFind = mapped_properties.find(ultimateParent);
+    const auto &props = desc.getPropertiesMap();
+    std::sort(order.begin(), order.end(), [&props](const std::string &a, const std::string &b) {
+        const auto &pa = props.at(a).data;
+        const auto &pb = props.at(b).data;
+        const size_t ta = pa.length / pa.elements;
+        const size_t tb = pb.length / pb.elements;
+        return ta != tb ? ta > tb : a < b;
+    });
+    // Reserve this instance's region of the constant buffer, anything which does not fit spills to global memory
+    const std::pair<ptrdiff_t, size_t> region = reserveConstantRegion(required);
+    try {
+        auto instance = std::make_shared<Instance>(instance_id, region.first, region.second, isPureRTC);
+        for (const auto &name : order) {
+            const auto &p = props.at(name);
+            const detail::EnvironmentStorage::Placement &placement = instance->storage.allocate(name, p.data.length, p.data.length / p.data.elements);
+            memcpy(instance->storage.getHostPtr(placement), p.data.ptr, p.data.length);
+            instance->properties.emplace(name, EnvProp(p.data.length, p.isConst, p.data.elements, p.data.type));
+        }
+        if (mapping) {
+            for (const auto &p : props) {
+                const auto prop_mapping = mapping->properties.find(p.first);
+                if (prop_mapping == mapping->properties.end())
+                    continue;
+                // Property is mapped, follow it's mapping upwards until we find the highest parent
+                NamePair ultimateParent = toName(*master_instance_id, prop_mapping->second);
+                std::shared_ptr<Instance> owner = master;
+                const auto mp = master->mapped_properties.find(prop_mapping->second);
+                if (mp != master->mapped_properties.end()) {
+                    // The master's mapped properties already refer to their highest parent
+                    ultimateParent = mp->second.masterProp;
+                    owner = mp->second.master;
+                }
+                if (owner->properties.find(ultimateParent.second) == owner->properties.end()) {
+                    THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
+                        "in EnvironmentManager::init().",
+                        instance_id, p.first.c_str(), ultimateParent.first, ultimateParent.second.c_str());
+                }
+                instance->mapped_properties.emplace(p.first, MappedProp(ultimateParent, p.second.isConst, owner));
+                instance->masters.insert(owner->instance_id);
             }
-            // Add to mapping list
-            MappedProp mp = MappedProp(ultimateParent, i.isConst);
-            mapped_properties.emplace(name, mp);
-            new_mapped_props.emplace(name);
         }
+        // Setup RTC version
+        buildRTCOffsets(*instance, master.get(), order);
+        // Publish the new instance
+        for (const auto &m : instance->masters) {
+            current->at(m)->dependents.insert(instance_id);
+        }
+        auto next = std::make_shared<InstanceMap>(*current);
+        next->emplace(instance_id, instance);
+        std::atomic_store(&instances, std::shared_ptr<const InstanceMap>(std::move(next)));
+    } catch (...) {
+        if (region.second) {
+            constant_regions.erase(region.first);
+        }
+        throw;
     }
-    if (newSize > m_freeSpace) {
-        // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-        // Arguably this check should be performed by init()
-        THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties,"
-            "in EnvironmentManager::init().");
-    }
-    // Defragment to rebuild it properly
-    defragment(detail::curve::Curve::getInstance(), &orderedProperties, new_mapped_props, isPureRTC);
-    // Setup RTC version
-    buildRTCOffsets(instance_id, master_instance_id, orderedProperties);
 }
 
 void EnvironmentManager::initRTC(const CUDASimulation& cudaSimulation) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    const std::shared_ptr<Instance> instance = getInstanceData(cudaSimulation.getInstanceID(), "initRTC");
     // check to ensure that model name is not already registered
-    auto res = cuda_agent_models.find(cudaSimulation.getInstanceID());
-    if (res != cuda_agent_models.end()) {
+    if (instance->simulation) {
         THROW exception::UnknownInternalError("Agent model name '%s' already registered in initRTC()", cudaSimulation.getModelDescription().name.c_str());
     }
     // register model name
-    cuda_agent_models.emplace(cudaSimulation.getInstanceID(), cudaSimulation);
+    instance->simulation = &cudaSimulation;
 }
 
 void EnvironmentManager::initialiseDevice() {
@@ -173,51 +176,37 @@ void EnvironmentManager::initialiseDevice() {
 }
 void EnvironmentManager::free(detail::curve::Curve &curve, const unsigned int &instance_id) {
     std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Release regular properties
-    for (auto &&i = properties.begin(); i != properties.end();) {
-        if (i->first.first == instance_id) {
-            // Release from CURVE
-            detail::curve::Curve::VariableHash cvh = toHash(i->first);
-            curve.unregisterVariableByHash(cvh);
-            // Drop from properties map
-            i = properties.erase(i);
-        } else {
-            ++i;
-        }
-    }
-    // Release mapped properties
-    for (auto &&i = mapped_properties.begin(); i != mapped_properties.end();) {
-        if (i->first.first == instance_id) {
-            // Release from CURVE
-            detail::curve::Curve::VariableHash cvh = toHash(i->first);
-            curve.unregisterVariableByHash(cvh);
-            // Drop from properties map
-            i = mapped_properties.erase(i);
-        } else {
-            ++i;
+    const std::shared_ptr<const InstanceMap> current = std::atomic_load(&instances);
+    const auto it = current->find(instance_id);
+    if (it == current->end()) {
+        return;
+    }
+    Instance &instance = *it->second;
+    // Release from CURVE
+    for (const auto &name : instance.curve_registered) {
+        curve.unregisterVariableByHash(toHash(toName(instance_id, name)));
+    }
+    instance.curve_registered.clear();
+    // Release device memory
+    if (instance.d_global) {
+        gpuErrchk(cudaFree(instance.d_global));
+        instance.d_global = nullptr;
+        instance.d_global_capacity = 0;
+    }
+    if (instance.storage.getConstantCapacity()) {
+        constant_regions.erase(instance.constant_base);
+    }
+    // Masters may have already been freed, as submodels are freed after their master
+    for (const auto &m : instance.masters) {
+        const auto master = current->find(m);
+        if (master != current->end()) {
+            master->second->dependents.erase(instance_id);
         }
     }
-    // Defragment to clear up all the buffer items we didn't handle here
-    defragment(curve);
-    // Remove reference to cuda agent model used by RTC
-    // This may not exist if the CUDAgent model has not been created (e.g. some tests which do not run the model)
-    auto cam = cuda_agent_models.find(instance_id);
-    if (cam != cuda_agent_models.end()) {
-        cuda_agent_models.erase(cam);
-    }
-    // Sample applies to requires update map
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    auto dru = deviceRequiresUpdate.find(instance_id);
-    if (dru != deviceRequiresUpdate.end()) {
-        deviceRequiresUpdate.erase(dru);
-    }
-    deviceRequiresUpdate_lock.unlock();
-
-    // Sample applies to rtc_caches
-    auto rtcc = rtc_caches.find(instance_id);
-    if (rtcc != rtc_caches.end()) {
-        rtc_caches.erase(rtcc);
-    }
+    // Drop from the instances map
+    auto next = std::make_shared<InstanceMap>(*current);
+    next->erase(instance_id);
+    std::atomic_store(&instances, std::shared_ptr<const InstanceMap>(std::move(next)));
 }
 
 EnvironmentManager::NamePair EnvironmentManager::toName(const unsigned int &instance_id, const std::string &var_name) {
@@ -232,479 +221,337 @@ detail::curve::Curve::VariableHash EnvironmentManager::toHash(const NamePair &na
     return CURVE_NAMESPACE_HASH + name.first + var_cvh;
 }
 
-void EnvironmentManager::newProperty(const NamePair &name, const char *ptr, const size_t &length, const bool &isConst, const size_type &elements, const std::type_index &type) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    assert(elements > 0);
-    const size_t typeSize = (length / elements);
-    ptrdiff_t buffOffset = MAX_BUFFER_SIZE;
-    // Allocate buffer space, using a free fragment
-    for (auto it = freeFragments.begin(); it != freeFragments.end(); ++it) {
-        const ptrdiff_t alignmentOffset = std::get<OFFSET>(*it) % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (std::get<LEN>(*it) + alignmentFix <= length) {
-            // We can use this space!
-            buffOffset = std::get<OFFSET>(*it) + alignmentFix;
-            // Update freeFrags
-            if (alignmentFix != 0) {
-                freeFragments.push_back(OffsetLen(std::get<OFFSET>(*it), alignmentFix));
-            }
-            // Update nextFree
-            if (std::get<LEN>(*it) == length) {
-                // Remove
-                freeFragments.erase(it);
-            } else {
-                // Shrink
-                *it = { std::get<OFFSET>(*it) + length, std::get<LEN>(*it) - length };
-            }
-            break;
-        }
+std::shared_ptr<EnvironmentManager::Instance> EnvironmentManager::findInstanceData(const unsigned int &instance_id) const {
+    const std::shared_ptr<const InstanceMap> current = std::atomic_load(&instances);
+    const auto it = current->find(instance_id);
+    return it == current->end() ? nullptr : it->second;
+}
+std::shared_ptr<EnvironmentManager::Instance> EnvironmentManager::getInstanceData(const unsigned int &instance_id, const char *caller) const {
+    std::shared_ptr<Instance> rtn = findInstanceData(instance_id);
+    if (!rtn) {
+        THROW exception::UnknownInternalError("Instance with id '%u' not registered in EnvironmentManager, "
+            "in EnvironmentManager::%s()", instance_id, caller);
     }
-    // Allocate buffer space, using nextFree
-    if (buffOffset == MAX_BUFFER_SIZE) {
-        const ptrdiff_t alignmentOffset = nextFree % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (nextFree + alignmentFix + length < MAX_BUFFER_SIZE) {
-            // Update freeFrags
-            if (alignmentFix != 0) {
-                freeFragments.push_back(OffsetLen(nextFree, alignmentFix));
-            }
-            // We can use this space!
-            nextFree += alignmentFix;
-            buffOffset = nextFree;
-            nextFree += length;
+    return rtn;
+}
+EnvironmentManager::PropRef EnvironmentManager::findProperty(const NamePair &name, const char *caller) const {
+    std::shared_ptr<Instance> instance = findInstanceData(name.first);
+    if (instance) {
+        const auto a = instance->properties.find(name.second);
+        if (a != instance->properties.end()) {
+            return PropRef{instance, &a->first, &a->second, a->second.isConst};
         }
-    }
-    if (buffOffset == MAX_BUFFER_SIZE) {  // buffOffset hasn't changed from init value
-        // defragment() and retry using nextFree
-        defragment(detail::curve::Curve::getInstance());
-        const ptrdiff_t alignmentOffset = nextFree % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (nextFree + alignmentFix + length < MAX_BUFFER_SIZE) {
-            // Update freeFrags
-            if (alignmentFix != 0) {
-                freeFragments.push_back(OffsetLen(nextFree, alignmentFix));
+        const auto b = instance->mapped_properties.find(name.second);
+        if (b != instance->mapped_properties.end()) {
+            const auto m = b->second.master->properties.find(b->second.masterProp.second);
+            if (m != b->second.master->properties.end()) {
+                return PropRef{b->second.master, &m->first, &m->second, b->second.isConst};
             }
-            // We can use this space!
-            nextFree += alignmentFix;
-            buffOffset = nextFree;
-            nextFree += length;
-        } else {
-            // Ran out of constant cache space!
-            THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new property,"
-                "in EnvironmentManager::add().");
+            THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
+                "in EnvironmentManager::%s().",
+                name.first, name.second.c_str(), b->second.masterProp.first, b->second.masterProp.second.c_str(), caller);
         }
     }
-    // Update FreeSpace
-    m_freeSpace -= length;
-    // Add to properties
-    // printf("Constant '%s' created at offset: %llu, (%llu%%8), (%llu%%4)\n", name.c_str(), buffOffset, buffOffset % 8, buffOffset % 4);
-    properties.emplace(name, EnvProp(buffOffset, length, isConst, elements, type));
+    THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
+        "in EnvironmentManager::%s().",
+        name.first, name.second.c_str(), caller);
+}
+char *EnvironmentManager::getPropertyPtr(const PropRef &p) {
+    return p.owner->storage.getHostPtr(*p.owner->storage.find(*p.name));
+}
+void EnvironmentManager::propertyChanged(const PropRef &p) {
+    // Only the property's bytes need copying to the device
+    p.owner->storage.markDirty(*p.owner->storage.find(*p.name));
+    // Do rtc too
+    updateRTCValue(p);
+}
+
+void EnvironmentManager::newProperty(const NamePair &name, const char *ptr, const size_t &length, const bool &isConst, const size_type &elements, const std::type_index &type) {
+    assert(elements > 0);
+    const std::shared_ptr<Instance> instance = getInstanceData(name.first, "newProperty");
+    if (instance->properties.find(name.second) != instance->properties.end() ||
+        instance->mapped_properties.find(name.second) != instance->mapped_properties.end()) {
+        THROW exception::DuplicateEnvProperty("Environmental property with name '%u:%s' already exists, "
+            "in EnvironmentManager::add().",
+            name.first, name.second.c_str());
+    }
+    const uint64_t layout_version = instance->storage.getLayoutVersion();
+    // Allocate storage, this may defragment the instance's constant region, or spill into global memory
+    // The new bytes (and any moved by defragmenting) are marked dirty by the storage
+    const detail::EnvironmentStorage::Placement &placement = instance->storage.allocate(name.second, length, length / elements);
     // Store data
-    memcpy(hc_buffer + buffOffset, ptr, length);
-    // Register in cuRVE
-    detail::curve::Curve::VariableHash cvh = toHash(name);
-    const auto CURVE_RESULT = detail::curve::Curve::getInstance().registerVariableByHash(cvh, reinterpret_cast<void*>(buffOffset), typeSize, elements);
-    if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-        THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE"
-            "in EnvironmentManager::add().");
-    }
-#ifdef _DEBUG
-    if (CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-        fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", name.second.c_str());
-    }
-#endif
-    addRTCOffset(name);
-    setDeviceRequiresUpdateFlag();
+    memcpy(instance->storage.getHostPtr(placement), ptr, length);
+    auto &prop = instance->properties.emplace(name.second, EnvProp(length, isConst, elements, type)).first->second;
+    if (instance->storage.getLayoutVersion() != layout_version) {
+        // Existing properties moved, so curve must be updated for this instance and any which map its properties
+        requireCurveRegistration(*instance);
+    }
+    // Register in cuRVE at the next updateDevice()
+    instance->flags.curve_registration_required = true;
+    addRTCOffset(*instance, name.second, prop);
 }
 
-#ifdef _DEBUG
-void EnvironmentManager::defragment(detail::curve::Curve &curve, const DefragMap * mergeProperties, std::set<NamePair> newmaps, bool isPureRTC) {
-#else
-void EnvironmentManager::defragment(detail::curve::Curve & curve, const DefragMap * mergeProperties, std::set<NamePair> newmaps, bool) {
-#endif
+std::pair<ptrdiff_t, size_t> EnvironmentManager::reserveConstantRegion(const size_t &required) {
     // Do not lock mutex here, do it in the calling method
-    auto device_lock = std::unique_lock<std::shared_timed_mutex>(device_mutex);
-    // Build a multimap to sort the elements (to create natural alignment in compact form)
-    DefragMap orderedProperties;
-    for (auto &i : properties) {
-        size_t typeLen = i.second.length / i.second.elements;
-        orderedProperties.emplace(std::make_pair(typeLen, i.first), DefragProp(i.second));
-    }
-    // Include any merge elements
-    if (mergeProperties) {
-        orderedProperties.insert(mergeProperties->cbegin(), mergeProperties->cend());
-    }
-    // Lock device mutex here, as we begin to mess with curve
-    // Clear freefrags, so we can refill it with alignment junk
-    freeFragments.clear();
-    size_t spareFrags = 0;
-    // Rebuild properties map into temporary buffer
-    std::unordered_map<NamePair, EnvProp, NamePairHash> t_properties;
-    char t_buffer[MAX_BUFFER_SIZE];
-    ptrdiff_t buffOffset = 0;
-    // Iterate largest vars first
-    for (auto _i = orderedProperties.rbegin(); _i != orderedProperties.rend(); ++_i) {
-        size_t typeSize = _i->first.first;
-        const NamePair &name = _i->first.second;
-        auto &i = _i->second;
-        // Handle alignment
-        const ptrdiff_t alignmentOffset = buffOffset % typeSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? typeSize - alignmentOffset : 0;
-        if (alignmentOffset != 0) {
-            freeFragments.push_back(OffsetLen(buffOffset, alignmentFix));
-            buffOffset += alignmentFix;
-            spareFrags += alignmentFix;
-        }
-        if (buffOffset + i.length <= MAX_BUFFER_SIZE) {
-            // Setup constant in new position
-            memcpy(t_buffer + buffOffset, i.data, i.length);
-            t_properties.emplace(name, EnvProp(buffOffset, i.length, i.isConst, i.elements, i.type, i.rtc_offset));
-            // Update cuRVE (There isn't an update, so unregister and reregister)  // TODO: curveGetVariableHandle()?
-            detail::curve::Curve::VariableHash cvh = toHash(name);
-            // Only unregister variable if it's already registered
-            if (!mergeProperties) {  // Merge properties are only provided on 1st init, when vars can't be unregistered
-                curve.unregisterVariableByHash(cvh);
-            } else {
-                // Can this var be found inside mergeProps
-                auto range = mergeProperties->equal_range(_i->first);
-                bool isFound = false;
-                for (auto w = range.first; w != range.second; ++w) {
-                    if (w->first.second == name) {
-                        isFound = true;
-                        break;
-                    }
-                }
-                if (!isFound) {
-                    curve.unregisterVariableByHash(cvh);
-                }
-            }
-            const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(buffOffset),
-                typeSize, i.elements);
-            if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-                THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                    "in EnvironmentManager::defragment().");
-            }
-#ifdef _DEBUG
-            if (!isPureRTC && CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-                fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", name.second.c_str());
-            }
-#endif
-            // Increase buffer offset length that has been added
-            buffOffset += i.length;
-        } else {
-            // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-            // Arguably this check should be performed by init()
-            THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                "in EnvironmentManager::defragment().");
+    if (!required) {
+        return { 0, 0 };
+    }
+    std::pair<ptrdiff_t, size_t> largest = { 0, 0 };
+    ptrdiff_t gap_start = 0;
+    auto gap = [&largest, &required](const ptrdiff_t start, const ptrdiff_t end) {
+        const ptrdiff_t a = static_cast<ptrdiff_t>(REGION_ALIGNMENT);
+        const ptrdiff_t aligned = (start + a - 1) / a * a;
+        if (aligned < end && static_cast<size_t>(end - aligned) > largest.second) {
+            largest = { aligned, static_cast<size_t>(end - aligned) };
         }
+        return largest.second >= required;
+    };
+    // First fit, otherwise the largest gap
+    bool found = false;
+    for (const auto &r : constant_regions) {
+        if ((found = gap(gap_start, r.first)))
+            break;
+        gap_start = r.first + static_cast<ptrdiff_t>(r.second);
     }
-    // Replace stored properties with temp
-    std::swap(properties, t_properties);
-    // Replace buffer on host
-    memcpy(hc_buffer, t_buffer, buffOffset);
-    // Update m_freeSpace, nextFree
-    nextFree = buffOffset;
-    m_freeSpace = MAX_BUFFER_SIZE - buffOffset + spareFrags;
-    // Update cub for any mapped properties
-    for (auto &mp : mapped_properties) {
-        // Generate hash for the subproperty name
-        detail::curve::Curve::VariableHash cvh = toHash(mp.first);
-        // Unregister the property if it's already been registered
-        if (newmaps.find(mp.first) == newmaps.end()) {
-            curve.unregisterVariableByHash(cvh);
-        }
-        // Find the location of the mappedproperty
-        auto masterprop = properties.at(mp.second.masterProp);
-        // Create the mapping
-        const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(masterprop.offset),
-                masterprop.length / masterprop.elements, masterprop.elements);
-        if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-            THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                "in EnvironmentManager::defragment().");
-        }
-#ifdef _DEBUG
-        if (!isPureRTC && CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-            fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", mp.first.second.c_str());
-        }
-#endif
+    if (!found) {
+        gap(gap_start, static_cast<ptrdiff_t>(MAX_BUFFER_SIZE));
+    }
+    largest.second = std::min(largest.second, required);
+    if (largest.second) {
+        constant_regions.emplace(largest.first, largest.second);
+    }
+    return largest;
+}
+size_t EnvironmentManager::freeSpace() const {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex);
+    size_t reserved = 0;
+    for (const auto &r : constant_regions) {
+        reserved += r.second;
     }
-    setDeviceRequiresUpdateFlag();
+    return MAX_BUFFER_SIZE - reserved;
+}
+size_t EnvironmentManager::spilledSize(const unsigned int &instance_id) const {
+    const std::shared_ptr<Instance> instance = getInstanceData(instance_id, "spilledSize");
+    size_t rtn = 0;
+    for (const auto &p : instance->storage.getPlacements()) {
+        if (p.second.segment == detail::EnvironmentStorage::Global)
+            rtn += p.second.length;
+    }
+    return rtn;
 }
 
-void EnvironmentManager::buildRTCOffsets(const unsigned int &instance_id, const unsigned int &master_instance_id, const DefragMap &orderedProperties) {
-    // Do not lock mutex here, do it in the calling method
-    // Actually begin
-    if (instance_id == master_instance_id) {
+void EnvironmentManager::buildRTCOffsets(Instance &instance, Instance *master, const std::vector<std::string> &order) {
+    if (!master) {
         // Create a new cache
-        std::shared_ptr<RTCEnvPropCache> cache = std::make_shared<RTCEnvPropCache>();
-        // Add the properties, they are already ordered so we can just enforce alignment
-        // As we add each property, set its rtc_offset value in main properties map
-        for (auto _i = orderedProperties.rbegin(); _i != orderedProperties.rend(); ++_i) {
-            auto &i = _i->second;
-            size_t alignmentSize = _i->first.first;
-            const NamePair &name = _i->first.second;
-            // Handle alignment
-            const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
-            const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
-            cache->nextFree += alignmentFix;
-            if (cache->nextFree + i.length <= MAX_BUFFER_SIZE) {
-                // Setup constant in new position
-                memcpy(cache->hc_buffer + cache->nextFree, i.data, i.length);
-                properties.at(name).rtc_offset = cache->nextFree;
-                // Increase buffer offset length that has been added
-                cache->nextFree += i.length;
-            } else {
-                // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-                // Arguably this check should be performed by init()
-                // This should never happen, it would be caught by defrag sooner
-                THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                    "in EnvironmentManager::buildRTCOffsets().");
-            }
-        }
-        // Cache is complete, add it to cache map
-        rtc_caches.emplace(instance_id, cache);
+        instance.rtc_cache = std::make_shared<RTCEnvPropCache>();
     } else {
-        // Find the master cache
-        std::shared_ptr<RTCEnvPropCache> &cache = rtc_caches.at(master_instance_id);
-        // Add the properties, they are already ordered so we can just enforce alignment
-        // As we add each property, set its rtc_offset value in main properties map
-        for (auto _i = orderedProperties.rbegin(); _i != orderedProperties.rend(); ++_i) {
-            const NamePair &name = _i->first.second;
-            auto &i = _i->second;
-            auto mi_it = mapped_properties.find(name);
-            if (mi_it ==  mapped_properties.end()) {
-                // Property is not mapped, add it to cache
-                size_t alignmentSize = _i->first.first;
-                // Handle alignment
-                const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
-                const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
-                cache->nextFree += alignmentFix;
-                if (cache->nextFree + i.length <= MAX_BUFFER_SIZE) {
-                    // Setup constant in new position
-                    memcpy(cache->hc_buffer + cache->nextFree, i.data, i.length);
-                    properties.at(name).rtc_offset = cache->nextFree;
-                    // Increase buffer offset length that has been added
-                    cache->nextFree += i.length;
-                } else {
-                    // Ran out of constant cache space! (this can only trigger when a DefragMap is passed)
-                    // Arguably this check should be performed by init()
-                    // This should never happen, it would be caught by defrag sooner
-                    THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                        "in EnvironmentManager::buildRTCOffsets().");
-                }
-            }
-        }
-        // Add a copy of cache for this instance_id to env manager
-        rtc_caches.emplace(instance_id, cache);
+        // Submodels share the master's cache
+        instance.rtc_cache = master->rtc_cache;
+    }
+    // Add the properties, they are already ordered so we can just enforce alignment
+    for (const auto &name : order) {
+        addRTCOffset(instance, name, instance.properties.at(name));
     }
 }
-char * EnvironmentManager::getRTCCache(const unsigned int& instance_id) {
-    auto it = rtc_caches.find(instance_id);
-    if (it != rtc_caches.end())
-        return it->second->hc_buffer;
-    THROW exception::UnknownInternalError("Instance with id '%u' not registered in EnvironmentManager for use with RTC in EnvironmentManager::getRTCCache", instance_id);
+char * EnvironmentManager::getRTCCache(const unsigned int& instance_id, cudaStream_t stream) {
+    const std::shared_ptr<Instance> instance = getInstanceData(instance_id, "getRTCCache");
+    RTCEnvPropCache &cache = *instance->rtc_cache;
+    // Spilled properties are accessed via a pointer held in the cache, which must be current
+    for (const auto &i : cache.indirect) {
+        const std::shared_ptr<Instance> owner = i.second.first == instance_id ? instance : findInstanceData(i.second.first);
+        if (!owner)
+            continue;
+        updateInstanceDevice(*owner, stream);
+        char *d_ptr = getCurvePtr(*owner, *owner->storage.find(i.second.second));
+        memcpy(cache.hc_buffer + i.first, &d_ptr, sizeof(char*));
+    }
+    return cache.hc_buffer;
 }
-void EnvironmentManager::addRTCOffset(const NamePair &name) {
-    // Do not lock mutex here, do it in the calling method
-    auto mi_it = mapped_properties.find(name);
-    // Property is not mapped (it's not even currently possible to add mapped properties after the fact)
-    if (mi_it ==  mapped_properties.end()) {
-        auto &cache = rtc_caches.at(name.first);
-        auto &p = properties.at(name);
-        size_t alignmentSize = p.length > 64 ? 64 : p.length;  // This creates better alignment for small vectors
-        // Handle alignment
-        const ptrdiff_t alignmentOffset = cache->nextFree % alignmentSize;
-        const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
-        cache->nextFree += alignmentFix;
-        if (cache->nextFree + p.length <= MAX_BUFFER_SIZE) {
-            // Setup constant in new position
-            memcpy(cache->hc_buffer + cache->nextFree, hc_buffer + p.offset, p.length);
-            p.rtc_offset = cache->nextFree;
-            // Increase buffer offset length that has been added
-            cache->nextFree += p.length;
-        } else {
-            THROW exception::OutOfMemory("Insufficient EnvProperty memory to create new properties, "
-                "in EnvironmentManager::buildRTCOffsets().");
-        }
+void EnvironmentManager::addRTCOffset(Instance &instance, const std::string &name, EnvProp &prop) {
+    RTCEnvPropCache &cache = *instance.rtc_cache;
+    const detail::EnvironmentStorage::Placement &placement = *instance.storage.find(name);
+    prop.rtc_indirect = placement.segment == detail::EnvironmentStorage::Global;
+    // Spilled properties only store a pointer within the cache
+    const size_t length = prop.rtc_indirect ? sizeof(char*) : prop.length;
+    const size_t alignmentSize = prop.rtc_indirect ? alignof(char*) : placement.alignment;
+    // Handle alignment
+    const ptrdiff_t alignmentOffset = cache.nextFree % alignmentSize;
+    const ptrdiff_t alignmentFix = alignmentOffset != 0 ? alignmentSize - alignmentOffset : 0;
+    cache.nextFree += alignmentFix;
+    if (cache.nextFree + length > MAX_BUFFER_SIZE) {
+        THROW exception::OutOfMemory("Insufficient RTC environment cache memory to create new property '%u:%s', "
+            "in EnvironmentManager::addRTCOffset().", instance.instance_id, name.c_str());
+    }
+    if (prop.rtc_indirect) {
+        // Pointer is written by getRTCCache(), as the device allocation may not yet exist
+        cache.indirect.emplace(cache.nextFree, toName(instance.instance_id, name));
     } else {
-        THROW exception::OutOfMemory("Support for mapped (sub) properties is not currently implemented, "
-            "in EnvironmentManager::addRTCOffset().");
+        memcpy(cache.hc_buffer + cache.nextFree, instance.storage.getHostPtr(placement), length);
     }
+    prop.rtc_offset = cache.nextFree;
+    // Increase buffer offset length that has been added
+    cache.nextFree += length;
 }
 
 const CUDASimulation& EnvironmentManager::getCUDASimulation(const unsigned int &instance_id) {
-    // Don't lock mutex here, lock it in the calling function
-    auto res = cuda_agent_models.find(instance_id);
-    if (res == cuda_agent_models.end()) {
+    const std::shared_ptr<Instance> instance = findInstanceData(instance_id);
+    if (!instance || !instance->simulation) {
         THROW exception::UnknownInternalError("Instance with id '%u' not registered in EnvironmentManager for use with RTC in EnvironmentManager::getCUDASimulation", instance_id);
     }
-    return res->second;
+    return *instance->simulation;
 }
 
-void EnvironmentManager::updateRTCValue(const NamePair &name) {
-    // Don't lock mutex here, lock it in the calling function
-    // Grab the updated prop
-    auto a = properties.find(name);
-    if (a == properties.end()) {
-        a = properties.find(mapped_properties.at(name).masterProp);
-    }
-    // Grab the main cache ptr for the prop
-    void *main_ptr = hc_buffer + a->second.offset;
-    // Grab the rtc cache ptr for the prop
-    void *rtc_ptr = rtc_caches.at(name.first)->hc_buffer + a->second.rtc_offset;
-    // Copy
-    memcpy(rtc_ptr, main_ptr, a->second.length);
-
-    // Now we must detect if the variable is mapped in any form
-    // If this is the case, any rtc models which share the property must be flagged for update too
-    {
-        std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-        // First check if it's the subvar
-        auto mp_it = mapped_properties.find(name);
-        const NamePair check = mp_it == mapped_properties.end() ? name : mp_it->second.masterProp;
-        // Now check for any properties mapped to this variable
-        for (auto mp : mapped_properties) {
-            if (mp.second.masterProp == check) {
-                // It's a hit, set flag to true
-                deviceRequiresUpdate.at(check.first).rtc_update_required = true;
-            }
-        }
-        deviceRequiresUpdate_lock.unlock();
+void EnvironmentManager::updateRTCValue(const PropRef &p) {
+    // Spilled properties are read directly from global memory
+    if (!p.prop->rtc_indirect) {
+        // Grab the rtc cache ptr for the prop
+        void *rtc_ptr = p.owner->rtc_cache->hc_buffer + p.prop->rtc_offset;
+        // Copy
+        memcpy(rtc_ptr, getPropertyPtr(p), p.prop->length);
     }
+    // The rtc cache is shared by submodels, so flagging the owner is sufficient
+    p.owner->flags.rtc_update_required = true;
 }
 
 void EnvironmentManager::removeProperty(const NamePair &name) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    const std::shared_ptr<Instance> instance = getInstanceData(name.first, "removeProperty");
     // Unregister in cuRVE
-    detail::curve::Curve::VariableHash cvh = toHash(name);
-    detail::curve::Curve::getInstance().unregisterVariableByHash(cvh);
-    // Update free space
+    if (instance->curve_registered.erase(name.second)) {
+        detail::curve::Curve::getInstance().unregisterVariableByHash(toHash(name));
+    }
     // Remove from properties map
-    auto realprop = properties.find(name);
-    if (realprop!= properties.end()) {
-        auto i = realprop->second;
-        // Cast is safe, length would need to be gigabytes, we only have 64KB constant cache
-        if (i.offset + static_cast<uint32_t>(i.length) == nextFree) {
-            // Rollback nextFree
-            nextFree = i.offset;
-        } else {
-            // Notify free fragments
-            freeFragments.push_back(OffsetLen(i.offset, i.length));
+    const auto realprop = instance->properties.find(name.second);
+    if (realprop != instance->properties.end()) {
+        if (realprop->second.rtc_indirect) {
+            instance->rtc_cache->indirect.erase(realprop->second.rtc_offset);
         }
-        m_freeSpace += i.length;
-        // Purge properties
-        properties.erase(name);
-    } else {
-        mapped_properties.erase(name);
+        instance->storage.release(name.second);
+        instance->properties.erase(realprop);
+        // Any submodel mapping this property must drop it from curve
+        requireCurveRegistration(*instance);
+    } else if (!instance->mapped_properties.erase(name.second)) {
+        THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
+            "in EnvironmentManager::removeProperty().",
+            name.first, name.second.c_str());
     }
-    setDeviceRequiresUpdateFlag(name.first);
 }
 void EnvironmentManager::removeProperty(const unsigned int &instance_id, const std::string &var_name) {
     removeProperty({instance_id, var_name});
 }
 
 void EnvironmentManager::resetModel(const unsigned int &instance_id, const EnvironmentDescription &desc) {
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
+    const std::shared_ptr<Instance> instance = getInstanceData(instance_id, "resetModel");
     // Todo: Might want to change this, so EnvManager holds a copy of the default at init time
     // For every property, in the named model, which is not a mapped property
     for (auto &d : desc.getPropertiesMap()) {
-        if (mapped_properties.find({instance_id, d.first}) == mapped_properties.end()) {
-            // Find the local property data
-            auto &p = properties.at({instance_id, d.first});
+        const auto p = instance->properties.find(d.first);
+        if (p != instance->properties.end()) {
+            const PropRef ref{instance, &p->first, &p->second, p->second.isConst};
+            assert(d.second.data.length == p->second.length);
             // Set back to default value
-            memcpy(hc_buffer + p.offset, d.second.data.ptr, d.second.data.length);
-            // Do rtc too
-            void *rtc_ptr = rtc_caches.at(instance_id)->hc_buffer + p.rtc_offset;
-            memcpy(rtc_ptr, d.second.data.ptr, d.second.data.length);
-            assert(d.second.data.length == p.length);
+            memcpy(getPropertyPtr(ref), d.second.data.ptr, d.second.data.length);
+            // Set device update flag, and do rtc too
+            propertyChanged(ref);
+        }
+    }
+}
+void EnvironmentManager::requireCurveRegistration(Instance &instance) {
+    instance.flags.curve_registration_required = true;
+    for (const auto &d : instance.dependents) {
+        if (const std::shared_ptr<Instance> dependent = findInstanceData(d)) {
+            dependent->flags.curve_registration_required = true;
+        }
+    }
+}
+char *EnvironmentManager::getCurvePtr(const Instance &instance, const detail::EnvironmentStorage::Placement &placement) {
+    if (placement.segment == detail::EnvironmentStorage::Constant) {
+        // Offset into c_buffer, this is always less than MAX_BUFFER_SIZE
+        return reinterpret_cast<char*>(instance.constant_base + placement.offset);
+    }
+    return instance.d_global + placement.offset;
+}
+void EnvironmentManager::registerCurve(Instance &instance) {
+    auto &curve = detail::curve::Curve::getInstance();
+    // There isn't an update, so unregister and reregister
+    for (const auto &name : instance.curve_registered) {
+        curve.unregisterVariableByHash(toHash(toName(instance.instance_id, name)));
+    }
+    instance.curve_registered.clear();
+    auto reg = [&](const std::string &name, const char *d_ptr, const EnvProp &prop) {
+        const detail::curve::Curve::VariableHash cvh = toHash(toName(instance.instance_id, name));
+        const auto CURVE_RESULT = curve.registerVariableByHash(cvh, const_cast<char*>(d_ptr), prop.length / prop.elements, prop.elements);
+        if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
+            THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
+                "in EnvironmentManager::updateDevice().");
+        }
+#ifdef _DEBUG
+        if (!instance.isPureRTC && CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
+            fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", name.c_str());
+        }
+#endif
+        instance.curve_registered.insert(name);
+    };
+    for (const auto &p : instance.properties) {
+        reg(p.first, getCurvePtr(instance, *instance.storage.find(p.first)), p.second);
+    }
+    for (const auto &mp : instance.mapped_properties) {
+        const Instance &master = *mp.second.master;
+        const auto p = master.properties.find(mp.second.masterProp.second);
+        // The master property may have been removed
+        if (p != master.properties.end()) {
+            reg(mp.first, getCurvePtr(master, *master.storage.find(p->first)), p->second);
         }
     }
-    setDeviceRequiresUpdateFlag(instance_id);
-}
-void EnvironmentManager::setDeviceRequiresUpdateFlag(const unsigned int &instance_id) {
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
-    // Don't lock mutex here, lock it in the calling function
-    // Increment host version
-    if (instance_id == UINT_MAX) {
-        // Set required version for all, we have defragged
-        for (auto &a : deviceRequiresUpdate) {
-            a.second.c_update_required = true;
-            a.second.rtc_update_required = true;
+    instance.flags.curve_registration_required = false;
+}
+bool EnvironmentManager::updateInstanceDevice(Instance &instance, cudaStream_t stream) {
+    // The host buffers are pageable, so cudaMemcpyAsync() has staged them before returning and they may be safely modified
+    bool issued = false;
+    const detail::EnvironmentStorage &storage = instance.storage;
+    for (const auto &r : storage.getDirty(detail::EnvironmentStorage::Constant).getCoalescedRanges(COPY_COALESCE_GAP)) {
+        gpuErrchk(cudaMemcpyAsync(const_cast<char*>(c_buffer) + instance.constant_base + r.first, storage.getConstantBuffer() + r.first, r.second - r.first, cudaMemcpyHostToDevice, stream));
+        issued = true;
+    }
+    instance.storage.clearDirty(detail::EnvironmentStorage::Constant);
+    const size_t len = storage.getGlobalSize();
+    if (len > instance.d_global_capacity) {
+        if (instance.d_global) {
+            gpuErrchk(cudaFree(instance.d_global));
         }
+        gpuErrchk(cudaMalloc(&instance.d_global, len));
+        instance.d_global_capacity = len;
+        // Spilled properties have moved, and the new allocation must be filled
+        requireCurveRegistration(instance);
+        gpuErrchk(cudaMemcpyAsync(instance.d_global, storage.getGlobalBuffer(), len, cudaMemcpyHostToDevice, stream));
+        issued = true;
     } else {
-        // Set individual
-        auto &flags = deviceRequiresUpdate.at(instance_id);
-        flags.c_update_required = true;
-        flags.rtc_update_required = true;
+        for (const auto &r : storage.getDirty(detail::EnvironmentStorage::Global).getCoalescedRanges(COPY_COALESCE_GAP)) {
+            gpuErrchk(cudaMemcpyAsync(instance.d_global + r.first, storage.getGlobalBuffer() + r.first, r.second - r.first, cudaMemcpyHostToDevice, stream));
+            issued = true;
+        }
     }
+    instance.storage.clearDirty(detail::EnvironmentStorage::Global);
+    return issued;
 }
-void EnvironmentManager::updateDevice(const unsigned int &instance_id) {
-    // Lock shared mutex of mutex in calling method first!!!
+bool EnvironmentManager::updateDevice(const unsigned int &instance_id, cudaStream_t stream) {
     // Device must be init first
     assert(deviceInitialised);
-    std::unique_lock<std::shared_timed_mutex> deviceRequiresUpdate_lock(deviceRequiresUpdate_mutex);
     NVTX_RANGE("EnvironmentManager::updateDevice()");
-    auto &flags = deviceRequiresUpdate.at(instance_id);
-    auto &c_update_required = flags.c_update_required;
-    auto &rtc_update_required = flags.rtc_update_required;
-    auto &curve_registration_required = flags.curve_registration_required;
-    if (c_update_required) {
-        // Store data
-        gpuErrchk(cudaMemcpy(reinterpret_cast<void*>(const_cast<char*>(c_buffer)), reinterpret_cast<void*>(const_cast<char*>(hc_buffer)), MAX_BUFFER_SIZE, cudaMemcpyHostToDevice));
-        // Update C update flag for all instances
-        for (auto &a : deviceRequiresUpdate) {
-            a.second.c_update_required = false;
+    const std::shared_ptr<Instance> instance = getInstanceData(instance_id, "updateDevice");
+    bool issued = false;
+    // Mapped properties are stored by their master instance
+    for (const auto &m : instance->masters) {
+        if (const std::shared_ptr<Instance> master = findInstanceData(m)) {
+            issued |= updateInstanceDevice(*master, stream);
         }
     }
-    if (rtc_update_required) {
-        // RTC is nolonger updated here, it's always updated before the CurveRTCHost is pushed to device.
-        // Update instance's rtc update flag
-        rtc_update_required = false;
-    }
-    if (curve_registration_required) {
-        auto &curve = detail::curve::Curve::getInstance();
-        // Update cub for any not mapped properties
-        for (auto &p : properties) {
-            if (p.first.first == instance_id) {
-                // Generate hash for the subproperty name
-                detail::curve::Curve::VariableHash cvh = toHash(p.first);
-                const auto &prop = p.second;
-                // Create the mapping
-                const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(prop.offset),
-                        prop.length / prop.elements, prop.elements);
-                if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-                    THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                        "in EnvironmentManager::updateDevice().");
-                }
-#ifdef _DEBUG
-                if (CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-                    fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", p.first.second.c_str());
-                }
-#endif
-            }
-        }
-        // Update cub for any mapped properties
-        for (auto &mp : mapped_properties) {
-            if (mp.first.first == instance_id) {
-                // Generate hash for the subproperty name
-                detail::curve::Curve::VariableHash cvh = toHash(mp.first);
-                const auto &masterprop = properties.at(mp.second.masterProp);
-                // Create the mapping
-                const auto CURVE_RESULT = curve.registerVariableByHash(cvh, reinterpret_cast<void*>(masterprop.offset),
-                        masterprop.length / masterprop.elements, masterprop.elements);
-                if (CURVE_RESULT == detail::curve::Curve::UNKNOWN_VARIABLE) {
-                    THROW exception::CurveException("curveRegisterVariableByHash() returned UNKNOWN_CURVE_VARIABLE, "
-                        "in EnvironmentManager::updateDevice().");
-                }
-#ifdef _DEBUG
-                if (CURVE_RESULT != static_cast<int>(cvh%detail::curve::Curve::MAX_VARIABLES)) {
-                    fprintf(stderr, "Curve Warning: Environment Property '%s' has a collision and may work improperly.\n", mp.first.second.c_str());
-                }
-#endif
-            }
-        }
-        curve_registration_required = false;
+    issued |= updateInstanceDevice(*instance, stream);
+    // RTC is nolonger updated here, it's always updated before the CurveRTCHost is pushed to device.
+    instance->flags.rtc_update_required = false;
+    if (instance->flags.curve_registration_required) {
+        registerCurve(*instance);
     }
+    return issued;
 }
 
 
@@ -720,58 +567,49 @@ EnvironmentManager& EnvironmentManager::getInstance() {
     return *(instances.emplace(device_id, std::unique_ptr<EnvironmentManager>(new EnvironmentManager())).first->second);
 }
 
+const std::unordered_map<std::string, EnvironmentManager::EnvProp> &EnvironmentManager::getPropertiesMap(const unsigned int &instance_id) const {
+    return getInstanceData(instance_id, "getPropertiesMap")->properties;
+}
+const std::unordered_map<std::string, EnvironmentManager::MappedProp> &EnvironmentManager::getMappedProperties(const unsigned int &instance_id) const {
+    return getInstanceData(instance_id, "getMappedProperties")->mapped_properties;
+}
+const char *EnvironmentManager::getHostPtr(const unsigned int &instance_id, const std::string &var_name) const {
+    return getPropertyPtr(findProperty(toName(instance_id, var_name), "getHostPtr"));
+}
 
 util::Any EnvironmentManager::getPropertyAny(const unsigned int &instance_id, const std::string &var_name) const {
-    std::shared_lock<std::shared_timed_mutex> lock(mutex);
-    const NamePair name = toName(instance_id, var_name);
-    auto a = properties.find(name);
-    if (a != properties.end())
-        return util::Any(hc_buffer + a->second.offset, a->second.length, a->second.type, a->second.elements);
-    const auto b = mapped_properties.find(name);
-    if (b != mapped_properties.end()) {
-        a = properties.find(b->second.masterProp);
-        if (a != properties.end())
-            return util::Any(hc_buffer + a->second.offset, a->second.length, a->second.type, a->second.elements);
-        THROW exception::InvalidEnvProperty("Mapped environmental property with name '%u:%s' maps to missing property with name '%u:%s', "
-            "in EnvironmentManager::getPropertyAny().",
-            name.first, name.second.c_str(), b->second.masterProp.first, b->second.masterProp.second.c_str());
+    const PropRef p = findProperty(toName(instance_id, var_name), "getPropertyAny");
+    return util::Any(getPropertyPtr(p), p.prop->length, p.prop->type, p.prop->elements);
+}
+void EnvironmentManager::setPropertyAny(const unsigned int &instance_id, const std::string &var_name, const util::Any &value) {
+    const PropRef p = findProperty(toName(instance_id, var_name), "setPropertyAny");
+    if (value.type != p.prop->type || value.length != p.prop->length) {
+        THROW exception::InvalidEnvPropertyType("Environmental property ('%u:%s') type (%s) or length (%llu) does not match the value provided (%s, %llu), "
+            "in EnvironmentManager::setPropertyAny().",
+            instance_id, var_name.c_str(), p.prop->type.name(), p.prop->length, value.type.name(), value.length);
     }
-    THROW exception::InvalidEnvProperty("Environmental property with name '%u:%s' does not exist, "
-        "in EnvironmentManager::getPropertyAny().",
-        name.first, name.second.c_str());
+    // Store data
+    memcpy(getPropertyPtr(p), value.ptr, value.length);
+    // Set device update flag, and do rtc too
+    propertyChanged(p);
 }
 
 void EnvironmentManager::setProperty(const unsigned int& instance_id, const std::string& var_name, void* data, size_t len) {
-    const NamePair name = { instance_id, var_name };
-    if (isConst(name)) {
+    const PropRef p = findProperty(toName(instance_id, var_name), "setProperty");
+    if (p.isConst) {
         THROW exception::ReadOnlyEnvProperty("Environmental property ('%u:%s') is marked as const and cannot be changed, "
             "in EnvironmentManager::setProperty().",
             instance_id, var_name.c_str());
     }
-    std::unique_lock<std::shared_timed_mutex> lock(mutex);
-    // Find property offset
-    ptrdiff_t buffOffset = 0;
-    size_t data_len = 0;
-    const auto a = properties.find(name);
-    if (a != properties.end()) {
-        buffOffset = a->second.offset;
-        data_len = a->second.length;
-    } else {
-        const auto& prop = properties.at(mapped_properties.at(name).masterProp);
-        buffOffset = prop.offset;
-        data_len = prop.length;
-    }
-    if (len != data_len) {
+    if (len != p.prop->length) {
         THROW exception::InvalidEnvPropertyType("Environmental property ('%u:%s') does not match len (%llu != %llu), "
             "in EnvironmentManager::setProperty().",
-            instance_id, var_name.c_str(), len, data_len);
+            instance_id, var_name.c_str(), len, p.prop->length);
     }
     // Store data
-    memcpy(hc_buffer + buffOffset, data, data_len);
-    // Do rtc too
-    updateRTCValue(name);
-    // Set device update flag
-    setDeviceRequiresUpdateFlag(name.first);
+    memcpy(getPropertyPtr(p), data, len);
+    // Set device update flag, and do rtc too
+    propertyChanged(p);
 }
 
 }  // namespace flamegpu
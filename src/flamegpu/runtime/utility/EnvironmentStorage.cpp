@@ -0,0 +1,178 @@
+#include "flamegpu/runtime/utility/EnvironmentStorage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace detail {
+
+namespace {
+ptrdiff_t alignUp(const ptrdiff_t offset, const size_t alignment) {
+    const ptrdiff_t a = static_cast<ptrdiff_t>(alignment);
+    return (offset + a - 1) / a * a;
+}
+}  // namespace
+
+EnvironmentStorage::EnvironmentStorage(const size_t constant_capacity)
+    : constant_buffer(constant_capacity, 0) { }
+
+const EnvironmentStorage::Placement &EnvironmentStorage::allocate(const std::string &name, const size_t length, const size_t alignment) {
+    if (placements.find(name) != placements.end()) {
+        THROW exception::DuplicateEnvProperty("Environment property with name '%s' already exists, "
+            "in EnvironmentStorage::allocate()\n", name.c_str());
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || length % alignment != 0) {
+        THROW exception::InvalidArgument("Environment property '%s' has invalid alignment %llu for length %llu, "
+            "in EnvironmentStorage::allocate()\n", name.c_str(), static_cast<unsigned long long>(alignment), static_cast<unsigned long long>(length));
+    }
+    Placement p{Constant, 0, length, alignment};
+    bool success = tryAllocate(constant, constant_buffer.size(), length, alignment, p.offset);
+    if (!success && getConstantFreeSpace() >= length) {
+        // Enough space exists, but it is fragmented
+        defragment(Constant);
+        success = tryAllocate(constant, constant_buffer.size(), length, alignment, p.offset);
+    }
+    if (!success) {
+        // Spill into the global segment, which has no capacity limit
+        p.segment = Global;
+        tryAllocate(global, std::numeric_limits<size_t>::max(), length, alignment, p.offset);
+        global_buffer.resize(static_cast<size_t>(global.nextFree), 0);
+    }
+    SegmentState &seg = p.segment == Constant ? constant : global;
+    seg.used += length;
+    const auto rtn = placements.emplace(name, p).first;
+    memset(getHostPtr(rtn->second), 0, length);
+    markDirty(rtn->second);
+    return rtn->second;
+}
+void EnvironmentStorage::release(const std::string &name) {
+    const auto it = placements.find(name);
+    if (it == placements.end()) {
+        THROW exception::InvalidEnvProperty("Environment property with name '%s' does not exist, "
+            "in EnvironmentStorage::release()\n", name.c_str());
+    }
+    const Placement p = it->second;
+    placements.erase(it);
+    SegmentState &seg = p.segment == Constant ? constant : global;
+    seg.used -= p.length;
+    releaseRange(seg, p.offset, p.length);
+    // Bytes beyond the end of the segment need not be copied
+    (p.segment == Constant ? constant_dirty : global_dirty).truncate(static_cast<size_t>(seg.nextFree));
+    if (p.segment == Global) {
+        global_buffer.resize(static_cast<size_t>(global.nextFree));
+    }
+}
+bool EnvironmentStorage::defragment() {
+    const bool c = defragment(Constant);
+    const bool g = defragment(Global);
+    return c || g;
+}
+const EnvironmentStorage::Placement *EnvironmentStorage::find(const std::string &name) const {
+    const auto it = placements.find(name);
+    return it == placements.end() ? nullptr : &it->second;
+}
+
+bool EnvironmentStorage::tryAllocate(SegmentState &seg, const size_t capacity, const size_t length, const size_t alignment, ptrdiff_t &offset) {
+    // First fit within the free fragments
+    for (auto it = seg.freeFragments.begin(); it != seg.freeFragments.end(); ++it) {
+        const ptrdiff_t aligned = alignUp(it->first, alignment);
+        const size_t padding = static_cast<size_t>(aligned - it->first);
+        if (padding + length <= it->second) {
+            const ptrdiff_t frag_offset = it->first;
+            const size_t frag_length = it->second;
+            seg.freeFragments.erase(it);
+            if (padding) {
+                seg.freeFragments.emplace(frag_offset, padding);
+            }
+            if (padding + length < frag_length) {
+                seg.freeFragments.emplace(aligned + static_cast<ptrdiff_t>(length), frag_length - padding - length);
+            }
+            offset = aligned;
+            return true;
+        }
+    }
+    // Append to the end of the segment
+    const ptrdiff_t aligned = alignUp(seg.nextFree, alignment);
+    if (static_cast<size_t>(aligned) > capacity || length > capacity - static_cast<size_t>(aligned)) {
+        return false;
+    }
+    if (aligned != seg.nextFree) {
+        releaseRange(seg, seg.nextFree, static_cast<size_t>(aligned - seg.nextFree));
+    }
+    offset = aligned;
+    seg.nextFree = aligned + static_cast<ptrdiff_t>(length);
+    return true;
+}
+void EnvironmentStorage::releaseRange(SegmentState &seg, ptrdiff_t offset, size_t length) {
+    // Merge with the preceding fragment
+    auto next = seg.freeFragments.lower_bound(offset);
+    if (next != seg.freeFragments.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + static_cast<ptrdiff_t>(prev->second) == offset) {
+            offset = prev->first;
+            length += prev->second;
+            seg.freeFragments.erase(prev);
+        }
+    }
+    // Merge with the following fragment
+    if (next != seg.freeFragments.end() && offset + static_cast<ptrdiff_t>(length) == next->first) {
+        length += next->second;
+        seg.freeFragments.erase(next);
+    }
+    if (offset + static_cast<ptrdiff_t>(length) == seg.nextFree) {
+        // Roll back nextFree, rather than track a trailing fragment
+        seg.nextFree = offset;
+    } else {
+        seg.freeFragments.emplace(offset, length);
+    }
+}
+bool EnvironmentStorage::defragment(const Segment segment) {
+    SegmentState &seg = segment == Constant ? constant : global;
+    std::vector<char> &buffer = segment == Constant ? constant_buffer : global_buffer;
+    // Order by descending alignment, then name, so that the layout is deterministic
+    std::vector<std::pair<const std::string, Placement>*> order;
+    for (auto &p : placements) {
+        if (p.second.segment == segment)
+            order.push_back(&p);
+    }
+    std::sort(order.begin(), order.end(), [](const std::pair<const std::string, Placement> *a, const std::pair<const std::string, Placement> *b) {
+        if (a->second.alignment != b->second.alignment)
+            return a->second.alignment > b->second.alignment;
+        return a->first < b->first;
+    });
+    std::vector<char> t_buffer(buffer.size(), 0);
+    SegmentState t_seg;
+    bool moved = false;
+    for (auto *p : order) {
+        Placement &placement = p->second;
+        const ptrdiff_t aligned = alignUp(t_seg.nextFree, placement.alignment);
+        if (aligned != t_seg.nextFree) {
+            t_seg.freeFragments.emplace(t_seg.nextFree, static_cast<size_t>(aligned - t_seg.nextFree));
+        }
+        memcpy(t_buffer.data() + aligned, buffer.data() + placement.offset, placement.length);
+        moved |= aligned != placement.offset;
+        placement.offset = aligned;
+        t_seg.nextFree = aligned + static_cast<ptrdiff_t>(placement.length);
+        t_seg.used += placement.length;
+    }
+    if (segment == Global) {
+        t_buffer.resize(static_cast<size_t>(t_seg.nextFree));
+    }
+    std::swap(buffer, t_buffer);
+    std::swap(seg, t_seg);
+    if (moved) {
+        ++layout_version;
+        util::detail::DirtyRangeSet &dirty = segment == Constant ? constant_dirty : global_dirty;
+        dirty.clear();
+        dirty.add(0, static_cast<size_t>(seg.nextFree));
+    }
+    return moved;
+}
+
+}  // namespace detail
+}  // namespace flamegpu
@@ -3,8 +3,48 @@
 namespace flamegpu {
 
 HostEnvironment::HostEnvironment(const unsigned int &_instance_id, CUDAMacroEnvironment& _macro_env)
-    : env_mgr(EnvironmentManager::getInstance())
-    , macro_env(_macro_env)
-    , instance_id(_instance_id) { }
+    : env_mgr(&EnvironmentManager::getInstance())
+    , macro_env(&_macro_env)
+    , instance_id(_instance_id)
+    , host_properties(nullptr)
+    , host_read_only(nullptr) { }
+
+HostEnvironment::HostEnvironment(std::unordered_map<std::string, util::Any> &_host_properties, const std::set<std::string> &_host_read_only)
+    : env_mgr(nullptr)
+    , macro_env(nullptr)
+    , instance_id(0)
+    , host_properties(&_host_properties)
+    , host_read_only(&_host_read_only) { }
+
+char *HostEnvironment::getHostPropertyPtr(const std::string &name, const std::type_index &type, const EnvironmentManager::size_type elements,
+    const EnvironmentManager::size_type *index, const bool write, const char *caller) const {
+    const auto it = host_properties->find(name);
+    if (it == host_properties->end()) {
+        THROW exception::InvalidEnvProperty("Environmental property with name '%s' does not exist, "
+            "in %s\n", name.c_str(), caller);
+    }
+    util::Any &prop = it->second;
+    if (prop.type != type) {
+        THROW exception::InvalidEnvPropertyType("Environmental property ('%s') type (%s) does not match template argument T (%s), "
+            "in %s\n", name.c_str(), prop.type.name(), type.name(), caller);
+    }
+    if (write && host_read_only->find(name) != host_read_only->end()) {
+        THROW exception::ReadOnlyEnvProperty("Environmental property ('%s') is marked as const and cannot be changed, "
+            "in %s\n", name.c_str(), caller);
+    }
+    const size_t type_size = prop.length / prop.elements;
+    if (index) {
+        if ((*index + 1) * elements > prop.elements) {
+            THROW exception::OutOfBoundsException("Index(%u) exceeds named environmental property array's length (%u), "
+                "in %s\n", *index, prop.elements / elements, caller);
+        }
+        return static_cast<char *>(prop.ptr) + *index * elements * type_size;
+    }
+    if (elements && elements != prop.elements) {
+        THROW exception::OutOfBoundsException("Length of named environmental property array (%u) does not match the length requested (%u), "
+            "in %s\n", prop.elements, elements, caller);
+    }
+    return static_cast<char *>(prop.ptr);
+}
 
 }  // namespace flamegpu
@@ -8,7 +8,11 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
 #include "flamegpu/gpu/CUDASimulation.h"
@@ -202,5 +206,55 @@ uint64_t RandomManager::seed() {
 curandState *RandomManager::cudaRandomState() {
     return d_random_state;
 }
+void RandomManager::checkpoint(io::Checkpoint::SectionWriter &out) const {
+    out.write<uint64_t>(mSeed);
+    std::ostringstream host_state;
+    host_state << host_rng;
+    out.writeString(host_state.str());
+    out.write<uint64_t>(sizeof(curandState));
+    // Device states in use
+    out.write<size_type>(length);
+    if (length) {
+        std::vector<curandState> t_states(length);
+        gpuErrchk(cudaMemcpy(t_states.data(), d_random_state, length * sizeof(curandState), cudaMemcpyDeviceToHost));
+        out.write(t_states.data(), length * sizeof(curandState));
+    }
+    // States backed up to host when the device array was last shrunk, these are restored if it grows again
+    const size_type backup_length = h_max_random_size > length ? h_max_random_size : length;
+    out.write<size_type>(backup_length);
+    if (backup_length > length) {
+        out.write(h_max_random_state + length, (backup_length - length) * sizeof(curandState));
+    }
+}
+void RandomManager::restore(io::Checkpoint::SectionReader &in) {
+    reseed(in.read<uint64_t>());
+    std::istringstream host_state(in.readString());
+    host_state >> host_rng;
+    if (in.read<uint64_t>() != sizeof(curandState)) {
+        THROW exception::InvalidInputFile("Checkpoint was produced with a different curandState layout, "
+            "in RandomManager::restore()\n");
+    }
+    const size_type t_length = in.read<size_type>();
+    std::vector<curandState> t_states(t_length);
+    in.read(t_states.data(), t_length * sizeof(curandState));
+    const size_type backup_length = in.read<size_type>();
+    if (backup_length > t_length) {
+        // Release any existing host backup, rather than leaking it
+        freeHost();
+        h_max_random_state = reinterpret_cast<curandState *>(malloc(backup_length * sizeof(curandState)));
+        h_max_random_size = backup_length;
+        // The prefix mirrors the device states, so that the whole backup is valid if it is later copied back to the device
+        if (t_length) {
+            memcpy(h_max_random_state, t_states.data(), t_length * sizeof(curandState));
+        }
+        in.read(h_max_random_state + t_length, (backup_length - t_length) * sizeof(curandState));
+    }
+    if (t_length) {
+        deviceInitialised = true;
+        gpuErrchk(cudaMalloc(&d_random_state, t_length * sizeof(curandState)));
+        gpuErrchk(cudaMemcpy(d_random_state, t_states.data(), t_length * sizeof(curandState), cudaMemcpyHostToDevice));
+        length = t_length;
+    }
+}
 
 }  // namespace flamegpu
@@ -19,22 +19,28 @@ AgentLoggingConfig::AgentLoggingConfig(
     , agent_set(_agent_set.first)
     , log_count(_agent_set.second) { }
 
-void AgentLoggingConfig::log(const LoggingConfig::NameReductionFn &nrf, const std::type_index &variable_type, const std::string &method_name) {
-    // Validate variable name and type
-    const auto var = agent->variables.find(nrf.name);
+void AgentLoggingConfig::validateVariable(const std::string &variable_name, const std::type_index &variable_type, const std::string &method_name) const {
+    const auto var = agent->variables.find(variable_name);
     if (var == agent->variables.end()) {
         THROW exception::InvalidAgentVar("Agent ('%s') variable '%s' was not found in the model description, "
             "in AgentLoggingConfig::log%s()\n",
-            agent->name.c_str(), nrf.name.c_str(), method_name.c_str());
+            agent->name.c_str(), variable_name.c_str(), method_name.c_str());
     } else if (var->second.type != variable_type) {
         THROW exception::InvalidVarType("Agent ('%s') variable '%s' has type '%s', incorrect type '%s' was provided to template, "
             "in AgentLoggingConfig::log%s()\n",
-            agent->name.c_str(), nrf.name.c_str(), var->second.type.name(), variable_type.name(), method_name.c_str());
+            agent->name.c_str(), variable_name.c_str(), var->second.type.name(), variable_type.name(), method_name.c_str());
     } else if (var->second.elements != 1) {
         THROW exception::InvalidVarType("Agent ('%s') variable '%s' is an array variable, this function does not support array variables, "
             "in AgentLoggingConfig::log%s()\n",
-            agent->name.c_str(), nrf.name.c_str(), method_name.c_str());
+            agent->name.c_str(), variable_name.c_str(), method_name.c_str());
     }
+}
+void AgentLoggingConfig::log(const LoggingConfig::NameReductionFn &nrf, const std::type_index &variable_type, const std::string &method_name,
+    const std::type_index &secondary_type) {
+    // Validate variable name and type
+    validateVariable(nrf.name, variable_type, method_name);
+    if (!nrf.secondary_name.empty())
+        validateVariable(nrf.secondary_name, secondary_type, method_name);
     // Store it in the map
     if (!agent_set->emplace(nrf).second) {
         THROW exception::InvalidArgument("Agent ('%s') variable '%s' %s has already been marked for logging, "
@@ -59,6 +59,39 @@ double AgentLogFrame::getStandardDev(const std::string &variable_name) const {
     return *static_cast<double *>(it->second.ptr);
 }
 
+std::vector<double> AgentLogFrame::getQuantiles(const std::string &variable_name) const {
+    const auto &it = data.find({variable_name, LoggingConfig::Quantiles});
+    if (it == data.end()) {
+        THROW exception::InvalidAgentVar("Quantiles of agent variable '%s' were not found in the log, "
+            "in AgentLogFrame::getQuantiles()\n",
+            variable_name.c_str());
+    }
+    const double *begin = static_cast<const double *>(it->second.ptr);
+    return std::vector<double>(begin, begin + it->second.elements);
+}
+std::vector<unsigned int> AgentLogFrame::getHistogram(const std::string &variable_name) const {
+    const auto &it = data.find({variable_name, LoggingConfig::Histogram});
+    if (it == data.end()) {
+        THROW exception::InvalidAgentVar("Histogram of agent variable '%s' was not found in the log, "
+            "in AgentLogFrame::getHistogram()\n",
+            variable_name.c_str());
+    }
+    const unsigned int *begin = static_cast<const unsigned int *>(it->second.ptr);
+    return std::vector<unsigned int>(begin, begin + it->second.elements);
+}
+double AgentLogFrame::getCovariance(const std::string &variable_a, const std::string &variable_b) const {
+    auto it = data.find({variable_a, LoggingConfig::Covariance, nullptr, nullptr, variable_b});
+    if (it == data.end()) {
+        it = data.find({variable_b, LoggingConfig::Covariance, nullptr, nullptr, variable_a});
+        if (it == data.end()) {
+            THROW exception::InvalidAgentVar("Covariance of agent variables '%s' and '%s' was not found in the log, "
+                "in AgentLogFrame::getCovariance()\n",
+                variable_a.c_str(), variable_b.c_str());
+        }
+    }
+    return *static_cast<double *>(it->second.ptr);
+}
+
 StepLogFrame::StepLogFrame()
     : LogFrame()
     , step_time(0.0) { }
@@ -0,0 +1,211 @@
+#include "flamegpu/sim/LogReductionPlan.h"
+
+#include <algorithm>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+#include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
+#include "flamegpu/util/detail/MemoryResource.h"
+
+namespace flamegpu {
+namespace detail {
+
+namespace {
+/**
+ * Threads per block of the fused reduction kernel, must be a power of 2
+ */
+constexpr unsigned int LOG_REDUCTION_BLOCK_SIZE = 256;
+/**
+ * Upper bound on the number of blocks assigned to each column
+ * Each block produces one partial per column, so this bounds the size of the readback
+ */
+constexpr unsigned int LOG_REDUCTION_MAX_BLOCKS = 64;
+/**
+ * Device copy of a column, the variable's buffer replaces it's name
+ */
+struct LogReductionBuffer {
+    const void *data;
+    LogReductionType type;
+};
+
+/**
+ * Each block reduces a strided subset of agents for the column blockIdx.y
+ * @param buffers The buffer of each column
+ * @param count The number of agents within each buffer
+ * @param partials Output, one partial per block, column-major
+ */
+__global__ void fusedLogReduction(const LogReductionBuffer *buffers, const unsigned int count, LogReductionPartial *partials) {
+    __shared__ LogReductionPartial sm_partials[LOG_REDUCTION_BLOCK_SIZE];
+    const LogReductionBuffer buffer = buffers[blockIdx.y];
+    const LogReductionKind kind = getLogReductionKind(buffer.type);
+    LogReductionPartial p;
+    p.init(kind);
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < count; i += blockDim.x * gridDim.x) {
+        pushLogReductionValue(p, buffer.type, buffer.data, i);
+    }
+    sm_partials[threadIdx.x] = p;
+    __syncthreads();
+    for (unsigned int stride = blockDim.x / 2; stride > 0; stride >>= 1) {
+        if (threadIdx.x < stride) {
+            sm_partials[threadIdx.x].merge(kind, sm_partials[threadIdx.x + stride]);
+        }
+        __syncthreads();
+    }
+    if (threadIdx.x == 0) {
+        partials[blockIdx.y * gridDim.x + blockIdx.x] = sm_partials[0];
+    }
+}
+/**
+ * Converts a value held in a column's accumulator type back to the variable's type
+ */
+template<typename T>
+util::Any toVariableType(const LogReductionKind kind, const LogReductionValue v) {
+    if (kind == LogReductionKind::Float)
+        return util::Any(static_cast<T>(v.f));
+    else if (kind == LogReductionKind::Signed)
+        return util::Any(static_cast<T>(v.i));
+    return util::Any(static_cast<T>(v.u));
+}
+}  // namespace
+
+LogReductionType LogReductionPlan::toLogReductionType(const std::type_index &type) {
+    if (type == std::type_index(typeid(float))) return LogReductionType::Float;
+    if (type == std::type_index(typeid(double))) return LogReductionType::Double;
+    if (type == std::type_index(typeid(char))) return LogReductionType::Char;
+    if (type == std::type_index(typeid(int8_t))) return LogReductionType::Int8;
+    if (type == std::type_index(typeid(uint8_t))) return LogReductionType::UInt8;
+    if (type == std::type_index(typeid(int16_t))) return LogReductionType::Int16;
+    if (type == std::type_index(typeid(uint16_t))) return LogReductionType::UInt16;
+    if (type == std::type_index(typeid(int32_t))) return LogReductionType::Int32;
+    if (type == std::type_index(typeid(uint32_t))) return LogReductionType::UInt32;
+    if (type == std::type_index(typeid(int64_t))) return LogReductionType::Int64;
+    if (type == std::type_index(typeid(uint64_t))) return LogReductionType::UInt64;
+    if (type == std::type_index(typeid(long long))) return LogReductionType::LongLong;  // NOLINT(runtime/int)
+    if (type == std::type_index(typeid(unsigned long long))) return LogReductionType::ULongLong;  // NOLINT(runtime/int)
+    THROW exception::InvalidVarType("Variables of type '%s' can not be reduced, "
+        "in LogReductionPlan::toLogReductionType()\n", type.name());
+}
+unsigned int LogReductionPlan::add(const std::string &variable_name, const std::type_index &type, const Statistic statistic) {
+    for (unsigned int i = 0; i < columns.size(); ++i) {
+        if (columns[i].variable_name == variable_name) {
+            columns[i].statistics |= statistic;
+            return i;
+        }
+    }
+    columns.push_back({variable_name, toLogReductionType(type), statistic});
+    return static_cast<unsigned int>(columns.size() - 1);
+}
+std::vector<LogReductionPartial> LogReductionPlan::reduceHost(const std::vector<const void*> &buffers, const unsigned int count) const {
+    if (buffers.size() != columns.size()) {
+        THROW exception::InvalidArgument("%u buffers were provided, the plan has %u columns, "
+            "in LogReductionPlan::reduceHost()\n", static_cast<unsigned int>(buffers.size()), static_cast<unsigned int>(columns.size()));
+    }
+    std::vector<LogReductionPartial> rtn(columns.size());
+    for (size_t c = 0; c < columns.size(); ++c)
+        rtn[c].init(getLogReductionKind(columns[c].type));
+    // Agent-major, so each agent's variables are visited together
+    for (unsigned int i = 0; i < count; ++i) {
+        for (size_t c = 0; c < columns.size(); ++c) {
+            pushLogReductionValue(rtn[c], columns[c].type, buffers[c], i);
+        }
+    }
+    return rtn;
+}
+util::Any LogReductionPlan::getResult(const unsigned int column, const LogReductionPartial &partial, const Statistic statistic) const {
+    const LogReductionType type = columns.at(column).type;
+    const LogReductionKind kind = getLogReductionKind(type);
+    switch (statistic) {
+    case Mean: {
+        if (partial.count == 0)
+            return util::Any(0.0);
+        // Divide the exact sum, to match HostAgentAPI::sum() / count
+        if (kind == LogReductionKind::Float)
+            return util::Any(partial.sum.f / partial.count);
+        else if (kind == LogReductionKind::Signed)
+            return util::Any(partial.sum.i / partial.count);
+        return util::Any(partial.sum.u / partial.count);
+    }
+    case StandardDev:
+        return util::Any(partial.count == 0 ? 0.0 : sqrt(partial.m2 / partial.count));
+    case Sum:
+        // sum_input_t<T>::result_t, char is accumulated with it's own signedness but always returned as uint64_t, long long types are returned as themselves
+        if (kind == LogReductionKind::Float)
+            return util::Any(partial.sum.f);
+        else if (type == LogReductionType::Char)
+            return util::Any(static_cast<uint64_t>(partial.sum.i));
+        else if (type == LogReductionType::LongLong)
+            return util::Any(static_cast<long long>(partial.sum.i));  // NOLINT(runtime/int)
+        else if (type == LogReductionType::ULongLong)
+            return util::Any(static_cast<unsigned long long>(partial.sum.u));  // NOLINT(runtime/int)
+        else if (kind == LogReductionKind::Signed)
+            return util::Any(partial.sum.i);
+        return util::Any(partial.sum.u);
+    case Min:
+    case Max: {
+        const bool is_min = statistic == Min;
+        switch (type) {
+        // Empty populations return the identity of the reduction, to match the individual reductions
+#define FLAMEGPU_LOG_REDUCTION_MINMAX(ENUM, T) \
+        case LogReductionType::ENUM: \
+            if (partial.count == 0) \
+                return util::Any(is_min ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest()); \
+            return toVariableType<T>(kind, is_min ? partial.min : partial.max);
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Float, float)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Double, double)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Char, char)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Int8, int8_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(UInt8, uint8_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Int16, int16_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(UInt16, uint16_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Int32, int32_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(UInt32, uint32_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(Int64, int64_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(UInt64, uint64_t)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(LongLong, long long)  // NOLINT(runtime/int)
+        FLAMEGPU_LOG_REDUCTION_MINMAX(ULongLong, unsigned long long)  // NOLINT(runtime/int)
+#undef FLAMEGPU_LOG_REDUCTION_MINMAX
+        }
+    }
+    }
+    THROW exception::InvalidArgument("Statistic %u is not a single statistic, "
+        "in LogReductionPlan::getResult()\n", static_cast<unsigned int>(statistic));
+}
+
+std::vector<LogReductionPartial> LogReductionPlan::reduceDevice(const std::vector<const void*> &buffers, const unsigned int count, util::detail::MemoryResource &memory, cudaStream_t stream) const {
+    if (buffers.size() != columns.size()) {
+        THROW exception::InvalidArgument("%u buffers were provided, the plan has %u columns, "
+            "in LogReductionPlan::reduceDevice()\n", static_cast<unsigned int>(buffers.size()), static_cast<unsigned int>(columns.size()));
+    }
+    std::vector<LogReductionPartial> rtn(columns.size());
+    for (size_t c = 0; c < columns.size(); ++c)
+        rtn[c].init(getLogReductionKind(columns[c].type));
+    if (columns.empty() || count == 0)
+        return rtn;
+    const unsigned int blocks = std::min((count + LOG_REDUCTION_BLOCK_SIZE - 1) / LOG_REDUCTION_BLOCK_SIZE, LOG_REDUCTION_MAX_BLOCKS);
+    const unsigned int column_count = static_cast<unsigned int>(columns.size());
+    // A single allocation holds the column buffers, followed by the partials
+    std::vector<LogReductionBuffer> h_buffers(column_count);
+    for (unsigned int c = 0; c < column_count; ++c)
+        h_buffers[c] = {buffers[c], columns[c].type};
+    const size_t partials_offset = ((column_count * sizeof(LogReductionBuffer) + alignof(LogReductionPartial) - 1) / alignof(LogReductionPartial)) * alignof(LogReductionPartial);
+    const size_t partials_count = static_cast<size_t>(column_count) * blocks;
+    char *d_temp = static_cast<char*>(memory.allocateOrThrow(partials_offset + partials_count * sizeof(LogReductionPartial)));
+    LogReductionBuffer *d_buffers = reinterpret_cast<LogReductionBuffer*>(d_temp);
+    LogReductionPartial *d_partials = reinterpret_cast<LogReductionPartial*>(d_temp + partials_offset);
+    std::vector<LogReductionPartial> h_partials(partials_count);
+    gpuErrchk(cudaMemcpyAsync(d_buffers, h_buffers.data(), column_count * sizeof(LogReductionBuffer), cudaMemcpyHostToDevice, stream));
+    fusedLogReduction<<<dim3(blocks, column_count), LOG_REDUCTION_BLOCK_SIZE, 0, stream>>>(d_buffers, count, d_partials);
+    gpuErrchkLaunch();
+    gpuErrchk(cudaMemcpyAsync(h_partials.data(), d_partials, partials_count * sizeof(LogReductionPartial), cudaMemcpyDeviceToHost, stream));
+    gpuErrchk(cudaStreamSynchronize(stream));
+    memory.deallocate(d_temp);
+    // Combine the partials of each column's blocks
+    for (unsigned int c = 0; c < column_count; ++c) {
+        const LogReductionKind kind = getLogReductionKind(columns[c].type);
+        for (unsigned int b = 0; b < blocks; ++b)
+            rtn[c].merge(kind, h_partials[c * blocks + b]);
+    }
+    return rtn;
+}
+
+}  // namespace detail
+}  // namespace flamegpu
@@ -56,6 +56,42 @@ void LoggingConfig::logEnvironment(const std::string &property_name) {
 void LoggingConfig::logTiming(bool doLogTiming) {
     log_timing = doLogTiming;
 }
+LoggingConfig::FusedReductions LoggingConfig::fuseReductions(const util::StringPair &agent_state) const {
+    FusedReductions rtn;
+    const AgentData &agent = *model->agents.at(agent_state.first);
+    for (const NameReductionFn &nrf : *agents.at(agent_state).first) {
+        detail::LogReductionPlan::Statistic statistic;
+        switch (nrf.reduction) {
+        case Mean: statistic = detail::LogReductionPlan::Mean; break;
+        case StandardDev: statistic = detail::LogReductionPlan::StandardDev; break;
+        case Min: statistic = detail::LogReductionPlan::Min; break;
+        case Max: statistic = detail::LogReductionPlan::Max; break;
+        case Sum: statistic = detail::LogReductionPlan::Sum; break;
+        default:
+            rtn.unfused.push_back(&nrf);
+            continue;
+        }
+        const unsigned int column = rtn.plan.add(nrf.name, agent.variables.at(nrf.name).type, statistic);
+        rtn.fused.push_back({&nrf, column, statistic});
+    }
+    return rtn;
+}
+const LoggingConfig::FusedReductions &LoggingConfig::getFusedReductions(const util::StringPair &agent_state) const {
+    const size_t reduction_count = agents.at(agent_state).first->size();
+    std::lock_guard<std::mutex> lock(fused_reductions_mutex);
+    auto it = fused_reductions.find(agent_state);
+    if (it == fused_reductions.end()) {
+        it = fused_reductions.emplace(agent_state, std::make_pair(fuseReductions(agent_state), reduction_count)).first;
+    } else if (it->second.second != reduction_count) {
+        it->second = std::make_pair(fuseReductions(agent_state), reduction_count);
+    }
+    return it->second.first;
+}
+void LoggingConfig::FusedReductions::emplaceResults(const std::vector<detail::LogReductionPartial> &partials, std::map<NameReductionFn, util::Any> &out) const {
+    for (const Fused &f : fused) {
+        out.emplace(*f.reduction, plan.getResult(f.column, partials[f.column], f.statistic));
+    }
+}
 StepLoggingConfig::StepLoggingConfig(const ModelDescription &model)
     : LoggingConfig(model)
     , frequency(1) { }
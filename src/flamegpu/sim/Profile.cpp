@@ -0,0 +1,39 @@
+#include "flamegpu/sim/Profile.h"
+
+#include <algorithm>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+
+void ProfileRegion::add(const double seconds) {
+    ++calls;
+    total_time += seconds;
+    min_time = std::min(min_time, seconds);
+    max_time = std::max(max_time, seconds);
+}
+void ProfileRegion::merge(const ProfileRegion &other) {
+    calls += other.calls;
+    total_time += other.total_time;
+    min_time = std::min(min_time, other.min_time);
+    max_time = std::max(max_time, other.max_time);
+}
+
+void Profile::add(const std::string &path, const double seconds) {
+    regions[path].add(seconds);
+}
+void Profile::merge(const Profile &other, const std::string &prefix) {
+    for (const auto &r : other.regions) {
+        regions[prefix.empty() ? r.first : prefix + "/" + r.first].merge(r.second);
+    }
+}
+const ProfileRegion &Profile::getRegion(const std::string &path) const {
+    const auto it = regions.find(path);
+    if (it == regions.end()) {
+        THROW exception::InvalidArgument("Profile does not contain a region with path '%s', "
+            "in Profile::getRegion()\n", path.c_str());
+    }
+    return it->second;
+}
+
+}  // namespace flamegpu
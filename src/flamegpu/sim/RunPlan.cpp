@@ -11,6 +11,7 @@ RunPlan::RunPlan(const ModelDescription &model)
 RunPlan::RunPlan(const std::shared_ptr<const std::unordered_map<std::string, EnvironmentDescription::PropData>>  &environment, const bool &allow_0)
     : random_seed(0)
     , steps(1)
+    , cost_estimate(0)
     , environment(environment)
     , allow_0_steps(allow_0) { }
 
@@ -20,6 +21,7 @@ RunPlan& RunPlan::operator=(const RunPlan& other) {
     this->environment = other.environment;
     this->allow_0_steps = other.allow_0_steps;
     this->output_subdirectory = other.output_subdirectory;
+    this->cost_estimate = other.cost_estimate;
     this->allow_0_steps = other.allow_0_steps;
     for (auto &i : other.property_overrides)
         this->property_overrides.emplace(i.first, util::Any(i.second));
@@ -38,6 +40,13 @@ void RunPlan::setSteps(const unsigned int &_steps) {
 void RunPlan::setOutputSubdirectory(const std::string &subdir) {
     output_subdirectory = subdir;
 }
+void RunPlan::setCostEstimate(const double &cost) {
+    if (!(cost >= 0)) {
+        throw exception::OutOfBoundsException("Cost estimate must be a non-negative value, "
+            "in RunPlan::setCostEstimate()");
+    }
+    cost_estimate = cost;
+}
 
 uint64_t RunPlan::getRandomSimulationSeed() const {
     return random_seed;
@@ -48,6 +57,9 @@ unsigned int RunPlan::getSteps() const {
 std::string RunPlan::getOutputSubdirectory() const {
     return output_subdirectory;
 }
+double RunPlan::getCostEstimate() const {
+    return cost_estimate;
+}
 
 RunPlanVector RunPlan::operator+(const RunPlan& rhs) const {
     // Validation
@@ -0,0 +1,72 @@
+#include "flamegpu/sim/RunPlanScheduler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "flamegpu/sim/RunPlanVector.h"
+
+namespace flamegpu {
+
+std::vector<unsigned int> IndexOrderScheduler::getOrder(const RunPlanVector &plans) const {
+    std::vector<unsigned int> rtn(plans.size());
+    std::iota(rtn.begin(), rtn.end(), 0u);
+    return rtn;
+}
+
+LongestFirstScheduler::LongestFirstScheduler(CostFunction _cost)
+    : cost(std::move(_cost)) {
+    if (!cost) {
+        THROW exception::InvalidArgument("Cost function must not be empty, "
+            "in LongestFirstScheduler::LongestFirstScheduler()\n");
+    }
+}
+std::vector<unsigned int> LongestFirstScheduler::getOrder(const RunPlanVector &plans) const {
+    // Evaluate each cost once, as the cost function may be expensive
+    std::vector<double> costs;
+    costs.reserve(plans.size());
+    for (const auto &plan : plans)
+        costs.push_back(cost(plan));
+    std::vector<unsigned int> rtn(plans.size());
+    std::iota(rtn.begin(), rtn.end(), 0u);
+    std::stable_sort(rtn.begin(), rtn.end(), [&costs](unsigned int a, unsigned int b) { return costs[a] > costs[b]; });
+    return rtn;
+}
+double LongestFirstScheduler::defaultCost(const RunPlan &plan) {
+    if (plan.getCostEstimate() > 0)
+        return plan.getCostEstimate();
+    if (plan.getSteps() == 0)
+        return std::numeric_limits<double>::infinity();
+    return static_cast<double>(plan.getSteps());
+}
+
+namespace detail {
+RunPlanQueue::RunPlanQueue(std::vector<unsigned int> _order, const unsigned int plan_count)
+    : order(std::move(_order))
+    , next_index(0) {
+    if (order.size() != plan_count) {
+        THROW exception::InvalidArgument("Schedule contains %u runs, expected %u, "
+            "in RunPlanQueue::RunPlanQueue()\n", static_cast<unsigned int>(order.size()), plan_count);
+    }
+    std::vector<bool> seen(plan_count, false);
+    for (const auto &i : order) {
+        if (i >= plan_count || seen[i]) {
+            THROW exception::InvalidArgument("Schedule contains invalid or repeated run index %u, "
+                "in RunPlanQueue::RunPlanQueue()\n", i);
+        }
+        seen[i] = true;
+    }
+}
+bool RunPlanQueue::next(unsigned int &run_id) {
+    const unsigned int i = next_index++;
+    if (i >= order.size())
+        return false;
+    run_id = order[i];
+    return true;
+}
+unsigned int RunPlanQueue::getIssuedCount() const {
+    return std::min(next_index.load(), static_cast<unsigned int>(order.size()));
+}
+}  // namespace detail
+
+}  // namespace flamegpu
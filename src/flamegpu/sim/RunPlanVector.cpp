@@ -1,5 +1,7 @@
 #include "flamegpu/sim/RunPlanVector.h"
 #include "flamegpu/model/ModelDescription.h"
+#include "flamegpu/sim/SampleSpace.h"
+#include "flamegpu/util/detail/QuasiRandom.h"
 
 namespace flamegpu {
 
@@ -48,6 +50,59 @@ uint64_t RunPlanVector::getRandomPropertySeed() {
     return randomPropertySeed;
 }
 
+void RunPlanVector::validateSampleSpace(const SampleSpace &space, const char *caller) const {
+    if (this->size() < 2) {
+        THROW exception::OutOfBoundsException("Unable to apply a property distribution a vector with less than 2 elements, "
+            "in RunPlanVector::%s()\n", caller);
+    }
+    for (const auto &dim : space.dimensions) {
+        const auto it = environment->find(dim.name);
+        if (it == environment->end()) {
+            THROW exception::InvalidEnvProperty("Environment description does not contain property '%s', "
+                "in RunPlanVector::%s()\n",
+                dim.name.c_str(), caller);
+        }
+        if (it->second.data.type != dim.type) {
+            THROW exception::InvalidEnvPropertyType("Environment property '%s' type mismatch '%s' != '%s', "
+                "in RunPlanVector::%s()\n",
+                dim.name.c_str(), it->second.data.type.name(), dim.type.name(), caller);
+        }
+        if (!dim.is_element && it->second.data.elements != 1) {
+            THROW exception::InvalidEnvPropertyType("Environment property '%s' is an array with %u elements, array method should be used, "
+                "in RunPlanVector::%s()\n",
+                dim.name.c_str(), it->second.data.elements, caller);
+        }
+        if (dim.is_element && dim.index >= it->second.data.elements) {
+            THROW exception::OutOfBoundsException("Environment property array index out of bounds "
+                "in RunPlanVector::%s()\n", caller);
+        }
+    }
+}
+void RunPlanVector::applySampleDesign(const SampleSpace &space, const std::vector<double> &points) {
+    const size_t d = space.dimensions.size();
+    for (size_t i = 0; i < this->size(); ++i) {
+        for (size_t j = 0; j < d; ++j) {
+            space.dimensions[j].set((*this)[i], points[i * d + j]);
+        }
+    }
+}
+void RunPlanVector::setPropertiesLatinHypercube(const SampleSpace &space) {
+    validateSampleSpace(space, "setPropertiesLatinHypercube");
+    applySampleDesign(space, util::detail::quasi_random::latinHypercube(static_cast<unsigned int>(this->size()), space.getDimensions(), rand));
+}
+void RunPlanVector::setPropertiesSobol(const SampleSpace &space) {
+    validateSampleSpace(space, "setPropertiesSobol");
+    if (space.getDimensions() > util::detail::quasi_random::SOBOL_MAX_DIMENSIONS) {
+        THROW exception::OutOfBoundsException("Sobol sequence supports atmost %u properties, the sample space contains %u, "
+            "in RunPlanVector::setPropertiesSobol()\n", util::detail::quasi_random::SOBOL_MAX_DIMENSIONS, space.getDimensions());
+    }
+    applySampleDesign(space, util::detail::quasi_random::sobol(static_cast<unsigned int>(this->size()), space.getDimensions()));
+}
+void RunPlanVector::setPropertiesHalton(const SampleSpace &space) {
+    validateSampleSpace(space, "setPropertiesHalton");
+    applySampleDesign(space, util::detail::quasi_random::halton(static_cast<unsigned int>(this->size()), space.getDimensions()));
+}
+
 RunPlanVector RunPlanVector::operator+(const RunPlan& rhs) const {
     // This function is defined internally inside both RunPlan and RunPlanVector as it's the only way to both pass CI and have SWIG build
     // Validation
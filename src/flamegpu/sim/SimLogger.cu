@@ -1,7 +1,12 @@
 #include "flamegpu/sim/SimLogger.h"
 
+#include <cstdio>
+#include <fstream>
+#include <string>
+
 #include "flamegpu/io/LoggerFactory.h"
 #include "flamegpu/sim/RunPlanVector.h"
+#include "flamegpu/util/detail/Tracer.h"
 
 // If earlier than VS 2019
 #if defined(_MSC_VER) && _MSC_VER < 1920
@@ -30,9 +35,9 @@ SimLogger::SimLogger(const std::vector<RunLog> &_run_logs,
         const RunPlanVector &_run_plans,
         const std::string &_out_directory,
         const std::string &_out_format,
-        std::queue<unsigned int> &_log_export_queue,
-        std::mutex &_log_export_queue_mutex,
-        std::condition_variable &_log_export_queue_cdn,
+        util::detail::BoundedQueue<unsigned int> &_log_export_queue,
+        const unsigned int export_threads,
+        const unsigned int export_shards,
         bool _export_step,
         bool _export_exit,
         bool _export_step_time,
@@ -42,65 +47,106 @@ SimLogger::SimLogger(const std::vector<RunLog> &_run_logs,
     , out_directory(_out_directory)
     , out_format(_out_format)
     , log_export_queue(_log_export_queue)
-    , log_export_queue_mutex(_log_export_queue_mutex)
-    , log_export_queue_cdn(_log_export_queue_cdn)
     , export_step(_export_step)
     , export_exit(_export_exit)
     , export_step_time(_export_step_time)
     , export_exit_time(_export_exit_time) {
-    this->thread = std::thread(&SimLogger::start, this);
-    // Attempt to name the thread
+    if (export_shards) {
+        // Create (or truncate) each shard file, runs are then appended to them
+        const path p_out_directory = out_directory;
+        for (unsigned int i = 0; i < export_shards; ++i) {
+            const path shard_path = p_out_directory / path("runs." + std::to_string(i) + "." + out_format);
+            shard_paths.push_back(shard_path.generic_string());
+            shard_mutexes.emplace_back(new std::mutex());
+            std::ofstream shard_file(shard_paths.back(), std::ofstream::trunc);
+            if (!shard_file.is_open()) {
+                THROW exception::InvalidFilePath("Unable to open file '%s' for writing, in SimLogger::SimLogger()\n", shard_paths.back().c_str());
+            }
+            // XML documents require a single root element, so the records are wrapped in <runs>, which is closed by join()
+            if (out_format == "xml") {
+                shard_file << "<runs>\n";
+            }
+        }
+    } else {
+        // Runs which share an output subdirectory, append to the same exit log file
+        for (const auto &plan : run_plans) {
+            auto &m = exit_file_mutexes[plan.getOutputSubdirectory()];
+            if (!m)
+                m.reset(new std::mutex());
+        }
+    }
+    for (unsigned int i = 0; i < export_threads; ++i) {
+        threads.emplace_back(&SimLogger::start, this, i);
+        // Attempt to name the thread
 #ifdef _MSC_VER
-    std::wstringstream thread_name;
-    thread_name << L"SimLogger";
-    // HRESULT hr =
-    SetThreadDescription(this->thread.native_handle(), thread_name.str().c_str());
-    // if (FAILED(hr)) {
-    //     fprintf(stderr, "Failed to name thread 'SimLogger'\n");
-    // }
+        std::wstringstream thread_name;
+        thread_name << L"SimLogger" << i;
+        // HRESULT hr =
+        SetThreadDescription(threads.back().native_handle(), thread_name.str().c_str());
+        // if (FAILED(hr)) {
+        //     fprintf(stderr, "Failed to name thread 'SimLogger%u'\n", i);
+        // }
 #else
-    std::stringstream thread_name;
-    thread_name << "SimLogger";
-    // int hr =
-    pthread_setname_np(this->thread.native_handle(), thread_name.str().c_str());
-    // if (hr) {
-    //     fprintf(stderr, "Failed to name thread 'SimLogger'\n");
-    // }
+        std::stringstream thread_name;
+        thread_name << "SimLogger" << i;
+        // int hr =
+        pthread_setname_np(threads.back().native_handle(), thread_name.str().c_str());
+        // if (hr) {
+        //     fprintf(stderr, "Failed to name thread 'SimLogger%u'\n", i);
+        // }
 #endif
+    }
 }
-void SimLogger::start() {
-    const path p_out_directory = out_directory;
-    unsigned int logs_processed = 0;
-    while (logs_processed < run_plans.size()) {
-        std::unique_lock<std::mutex> lock(log_export_queue_mutex);
-        log_export_queue_cdn.wait(lock, [this]{ return !log_export_queue.empty(); });
-        do {
-            // Pop item to be logged from queue
-            const unsigned int target_log = log_export_queue.front();
-            log_export_queue.pop();
-            lock.unlock();
-
-            // Check item isn't telling us to exit early
-            if (target_log == UINT_MAX) {
-                logs_processed = UINT_MAX;
-                break;
-            }
-            // Log items
-            if (export_exit) {
-                const path exit_path = p_out_directory / path(run_plans[target_log].getOutputSubdirectory()) / path("exit." + out_format);
-                const auto exit_logger = io::LoggerFactory::createLogger(exit_path.generic_string(), false, false);
-                exit_logger->log(run_logs[target_log], run_plans[target_log], false, true, false, export_exit_time);
-            }
-            if (export_step) {
-                const path step_path = p_out_directory/path(run_plans[target_log].getOutputSubdirectory())/path(std::to_string(target_log)+"."+out_format);
-                const auto step_logger = io::LoggerFactory::createLogger(step_path.generic_string(), false, false);
-                step_logger->log(run_logs[target_log], run_plans[target_log], true, false, export_step_time, false);
+void SimLogger::join() {
+    for (auto &t : threads) {
+        t.join();
+    }
+    threads.clear();
+    // Close the root element opened by the constructor, now that every record has been appended
+    if (out_format == "xml") {
+        for (const auto &shard_path : shard_paths) {
+            std::ofstream shard_file(shard_path, std::ofstream::app);
+            shard_file << "</runs>\n";
+        }
+    }
+}
+void SimLogger::start(const unsigned int thread_index) {
+    util::detail::Tracer::setThreadName("SimLogger" + std::to_string(thread_index));
+    unsigned int target_log;
+    // Pop items to be logged from queue, until it is closed and empty
+    while (log_export_queue.pop(target_log)) {
+        util::detail::Tracer::setRunIndex(static_cast<int>(target_log));
+        try {
+            util::detail::Tracer::Scope trace_scope("export", target_log);
+            if (shard_paths.empty()) {
+                exportRun(target_log);
+            } else {
+                exportRunToShard(target_log);
             }
-            // Continue
-            ++logs_processed;
-            lock.lock();
-        } while (!log_export_queue.empty());
+        } catch (std::exception &e) {
+            fprintf(stderr, "\nExporting logs of run %u failed with exception: \n%s\n", target_log, e.what());
+        }
+    }
+}
+void SimLogger::exportRun(const unsigned int target_log) {
+    const path p_out_directory = out_directory;
+    if (export_exit) {
+        const path exit_path = p_out_directory / path(run_plans[target_log].getOutputSubdirectory()) / path("exit." + out_format);
+        const auto exit_logger = io::LoggerFactory::createLogger(exit_path.generic_string(), false, false);
+        std::lock_guard<std::mutex> lock(*exit_file_mutexes.at(run_plans[target_log].getOutputSubdirectory()));
+        exit_logger->log(run_logs[target_log], run_plans[target_log], false, true, false, export_exit_time);
     }
+    if (export_step) {
+        const path step_path = p_out_directory/path(run_plans[target_log].getOutputSubdirectory())/path(std::to_string(target_log)+"."+out_format);
+        const auto step_logger = io::LoggerFactory::createLogger(step_path.generic_string(), false, false);
+        step_logger->log(run_logs[target_log], run_plans[target_log], true, false, export_step_time, false);
+    }
+}
+void SimLogger::exportRunToShard(const unsigned int target_log) {
+    const unsigned int shard = target_log % static_cast<unsigned int>(shard_paths.size());
+    const auto logger = io::LoggerFactory::createLogger(shard_paths[shard], false, false);
+    std::lock_guard<std::mutex> lock(*shard_mutexes[shard]);
+    logger->logRun(run_logs[target_log], run_plans[target_log], target_log, export_step, export_exit, export_step_time, export_exit_time);
 }
 
 }  // namespace flamegpu
@@ -1,10 +1,13 @@
 #include "flamegpu/sim/SimRunner.h"
 
+#include <string>
 #include <utility>
 
 #include "flamegpu/model/ModelData.h"
 #include "flamegpu/gpu/CUDASimulation.h"
 #include "flamegpu/sim/RunPlanVector.h"
+#include "flamegpu/sim/RunPlanScheduler.h"
+#include "flamegpu/util/detail/Tracer.h"
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -16,31 +19,31 @@ namespace flamegpu {
 
 SimRunner::SimRunner(const std::shared_ptr<const ModelData> _model,
     std::atomic<unsigned int> &_err_ct,
-    std::atomic<unsigned int> &_next_run,
+    detail::RunPlanQueue &_run_queue,
     const RunPlanVector &_plans,
     std::shared_ptr<const StepLoggingConfig> _step_log_config,
     std::shared_ptr<const LoggingConfig> _exit_log_config,
     int _device_id,
     unsigned int _runner_id,
     bool _verbose,
+    bool _reuse_simulation,
+    bool _profile,
     std::vector<RunLog> &_run_logs,
-    std::queue<unsigned int> &_log_export_queue,
-    std::mutex &_log_export_queue_mutex,
-    std::condition_variable &_log_export_queue_cdn)
+    util::detail::BoundedQueue<unsigned int> *_log_export_queue)
       : model(_model->clone())
       , run_id(0)
       , device_id(_device_id)
       , runner_id(_runner_id)
       , verbose(_verbose)
+      , reuse_simulation(_reuse_simulation)
+      , profile(_profile)
       , err_ct(_err_ct)
-      , next_run(_next_run)
+      , run_queue(_run_queue)
       , plans(_plans)
       , step_log_config(std::move(_step_log_config))
       , exit_log_config(std::move(_exit_log_config))
       , run_logs(_run_logs)
-      , log_export_queue(_log_export_queue)
-      , log_export_queue_mutex(_log_export_queue_mutex)
-      ,  log_export_queue_cdn(_log_export_queue_cdn) {
+      , log_export_queue(_log_export_queue) {
     this->thread = std::thread(&SimRunner::start, this);
     // Attempt to name the thread
 #ifdef _MSC_VER
@@ -64,44 +67,61 @@ SimRunner::SimRunner(const std::shared_ptr<const ModelData> _model,
 
 
 void SimRunner::start() {
+    util::detail::Tracer::setThreadName("CUDASim D" + std::to_string(device_id) + "T" + std::to_string(runner_id));
+    // Only retained between runs if reuse_simulation is set
+    std::unique_ptr<CUDASimulation> simulation;
     // While there are still plans to process
-    while ((this->run_id = next_run++) < plans.size()) {
+    while (run_queue.next(this->run_id)) {
+        util::detail::Tracer::setRunIndex(static_cast<int>(this->run_id));
         try {
-            // Update environment (this might be worth moving into CUDASimulation)
-            auto &prop_map = model->environment->properties;
-            for (auto &ovrd : plans[run_id].property_overrides) {
-                auto &prop = prop_map.at(ovrd.first);
-                memcpy(prop.data.ptr, ovrd.second.ptr, prop.data.length);
+            util::detail::Tracer::Scope trace_scope("run", this->run_id);
+            const bool reset = simulation != nullptr;
+            if (!reset) {
+                // Set simulation device
+                simulation = std::unique_ptr<CUDASimulation>(new CUDASimulation(model));
+                simulation->SimulationConfig().verbose = false;
+                simulation->SimulationConfig().timing = false;
+                simulation->SimulationConfig().profile = profile;
+                simulation->CUDAConfig().device_id = this->device_id;
             }
-            // Set simulation device
-            std::unique_ptr<CUDASimulation> simulation = std::unique_ptr<CUDASimulation>(new CUDASimulation(model));
+            // Update environment, overrides are applied when the simulation's environment is initialised or reset
+            simulation->setEnvironmentOverrides(plans[run_id].property_overrides);
             // Copy steps and seed from runplan
             simulation->SimulationConfig().steps = plans[run_id].getSteps();
-            simulation->SimulationConfig().random_seed = plans[run_id].getRandomSimulationSeed();
-            simulation->SimulationConfig().verbose = false;
-            simulation->SimulationConfig().timing = false;
-            simulation->CUDAConfig().device_id = this->device_id;
-            simulation->applyConfig();
-            // Set the step config directly, to bypass validation
-            simulation->step_log_config = step_log_config;
-            simulation->exit_log_config = exit_log_config;
+            if (!reset) {
+                simulation->SimulationConfig().random_seed = plans[run_id].getRandomSimulationSeed();
+                simulation->applyConfig();
+                // Set the step config directly, to bypass validation
+                simulation->step_log_config = step_log_config;
+                simulation->exit_log_config = exit_log_config;
+            } else {
+                // Return the retained simulation to it's initial state
+                // This uploads the updated environment, zeros macro properties and culls all agents and messages
+                simulation->reset(false);
+                // Reseed random, this also reseeds any submodels
+                simulation->reseed(plans[run_id].getRandomSimulationSeed());
+            }
             // TODO Set population?
             // Execute simulation
             simulation->simulate();
             // Store results in run_log (use placement new because const members)
             run_logs[this->run_id] = simulation->getRunLog();
-            // Notify logger
-            {
-                std::lock_guard<std::mutex> lck(log_export_queue_mutex);
-                log_export_queue.push(this->run_id);
+            if (!reuse_simulation) {
+                simulation.reset();
+            }
+            // Notify logger, this blocks if too many logs are awaiting export
+            if (log_export_queue) {
+                util::detail::Tracer::Scope queue_trace_scope("queue_export");
+                log_export_queue->push(this->run_id);
             }
-            log_export_queue_cdn.notify_one();
             // Print progress to console
             if (verbose) {
-                fprintf(stdout, "\rCUDAEnsemble progress: %u/%u", run_id + 1, static_cast<unsigned int>(plans.size()));
+                fprintf(stdout, "\rCUDAEnsemble progress: %u/%u", run_queue.getIssuedCount(), static_cast<unsigned int>(plans.size()));
                 fflush(stdout);
             }
         } catch(std::exception &e) {
+            // The failed simulation may have been left in an inconsistent state, so a new one is created for the next run
+            simulation.reset();
             fprintf(stderr, "\nRun %u failed on device %d, thread %u with exception: \n%s\n", run_id, device_id, runner_id, e.what());
         }
     }
@@ -2,6 +2,11 @@
 
 #include <algorithm>
 #include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
 
 #include "flamegpu/version.h"
 #include "flamegpu/model/ModelData.h"
@@ -10,6 +15,9 @@
 #include "flamegpu/io/StateReaderFactory.h"
 #include "flamegpu/io/StateWriterFactory.h"
 #include "flamegpu/io/LoggerFactory.h"
+#include "flamegpu/io/StepLogStreamWriter.h"
+#include "flamegpu/io/Checkpoint.h"
+#include "flamegpu/sim/LogFrame.h"
 #include "flamegpu/runtime/utility/RandomManager.cuh"
 #include "flamegpu/pop/AgentVector.h"
 #include "flamegpu/model/AgentDescription.h"
@@ -33,6 +41,8 @@ Simulation::Simulation(const std::shared_ptr<SubModelData> &submodel_desc, CUDAS
     , instance_id(get_instance_id())
     , maxLayerWidth(submodel_desc->submodel->getMaxLayerWidth()) { }
 
+Simulation::~Simulation() = default;
+
 void Simulation::initialise(int argc, const char** argv) {
     NVTX_RANGE("Simulation::initialise");
     config = Config();  // Reset to defaults
@@ -139,6 +149,28 @@ void Simulation::exportLog(const std::string &path, bool steps, bool exit, bool
     // Perform logging
     logger->log(getRunLog(), true, steps, exit, stepTime, exitTime);
 }
+void Simulation::openStepLogStream(bool logTime) {
+    // Any stream left open by a previous simulate() which threw an exception is abandoned, leaving it resumable
+    step_log_stream.reset();
+    if (!config.stream_step_log || config.step_log_file.empty())
+        return;
+    step_log_stream = io::LoggerFactory::createStepLogStreamWriter(config.step_log_file, config.step_log_pretty_print, config.truncate_log_files, config.step_log_flush_frequency);
+    step_log_stream->open(getRunLog(), logTime, config.resume_step_log);
+}
+bool Simulation::streamStepLog(const StepLogFrame &frame) {
+    if (!step_log_stream)
+        return true;
+    step_log_stream->writeStep(frame);
+    // The common log file still requires the full step log
+    return !config.common_log_file.empty();
+}
+bool Simulation::closeStepLogStream() {
+    if (!step_log_stream)
+        return false;
+    step_log_stream->close();
+    step_log_stream.reset();
+    return true;
+}
 
 int Simulation::checkArgs(int argc, const char** argv) {
     // Required args
@@ -241,6 +273,20 @@ int Simulation::checkArgs(int argc, const char** argv) {
             config.timing = true;
             continue;
         }
+        // --profile, Record per layer/function timings to the RunLog
+        if (arg.compare("--profile") == 0) {
+            config.profile = true;
+            continue;
+        }
+        // --trace <file.json>, Write a timeline of the simulation in the Chrome Trace Event format
+        if (arg.compare("--trace") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a trailing argument\n", arg.c_str());
+                return false;
+            }
+            config.trace_file = argv[++i];
+            continue;
+        }
         // --out-step <file.xml/file.json>, Step log file path
         if (arg.compare("--out-step") == 0) {
             if (i + 1 >= argc) {
@@ -250,6 +296,17 @@ int Simulation::checkArgs(int argc, const char** argv) {
             config.step_log_file = argv[++i];
             continue;
         }
+        // --stream-step, Write the step log file incrementally
+        if (arg.compare("--stream-step") == 0) {
+            config.stream_step_log = true;
+            continue;
+        }
+        // --resume-step, Write the step log file incrementally, resuming a partially written step log file
+        if (arg.compare("--resume-step") == 0) {
+            config.stream_step_log = true;
+            config.resume_step_log = true;
+            continue;
+        }
         // --out-exit <file.xml/file.json>, Exit log file path
         if (arg.compare("--out-exit") == 0) {
             if (i + 1 >= argc) {
@@ -292,14 +349,18 @@ void Simulation::printHelp(const char* executable) {
     printf("Optional Arguments:\n");
     const char *line_fmt = "%-18s %s\n";
     printf(line_fmt, "-h, --help", "show this help message and exit");
-    printf(line_fmt, "-i, --in <file.xml/file.json>", "Initial state file (XML or JSON)");
+    printf(line_fmt, "-i, --in <file.xml/file.json/file.fgpub>", "Initial state file (XML, JSON or binary)");
     printf(line_fmt, "    --out-step <file.xml/file.json>", "Step log file (XML or JSON)");
+    printf(line_fmt, "    --stream-step", "Write the step log file as each step completes");
+    printf(line_fmt, "    --resume-step", "As --stream-step, resuming a partially written step log file");
     printf(line_fmt, "    --out-exit <file.xml/file.json>", "Exit log file (XML or JSON)");
     printf(line_fmt, "    --out-log <file.xml/file.json>", "Common log file (XML or JSON)");
     printf(line_fmt, "-s, --steps <steps>", "Number of simulation iterations");
     printf(line_fmt, "-r, --random <seed>", "RandomManager seed");
     printf(line_fmt, "-v, --verbose", "Verbose FLAME GPU output");
     printf(line_fmt, "-t, --timing", "Output timing information to stdout");
+    printf(line_fmt, "    --profile", "Record per layer and per function timings to the log files");
+    printf(line_fmt, "    --trace <file.json>", "Write a timeline of the simulation to file (Chrome Trace Event format)");
 #ifdef VISUALISATION
     printf(line_fmt, "-c, --console", "Console mode, disable the visualisation");
 #endif
@@ -315,9 +376,177 @@ const Simulation::Config &Simulation::getSimulationConfig() const {
 
 void Simulation::reset() {
     loaded_input_file = "";
+    resume_from_checkpoint = false;
     reset(false);
 }
 
+void Simulation::checkpoint(const std::string &path) {
+    NVTX_RANGE("Simulation::checkpoint");
+    if (!checkpoint_writer) {
+        checkpoint_writer = std::make_unique<io::CheckpointWriter>();
+    }
+    // Report any failure of the previous write, before capturing state for the next
+    checkpoint_writer->wait();
+    auto ckpt = std::make_shared<io::Checkpoint>(model->name);
+    {
+        io::Checkpoint::SectionWriter out = ckpt->newSection("config");
+        out.write<uint64_t>(config.random_seed);
+    }
+    {
+        // Each population is stored a column at a time, directly from the AgentVector's storage
+        io::Checkpoint::SectionWriter out = ckpt->newSection("populations");
+        for (const auto &agent : model->agents) {
+            for (const auto &state : agent.second->states) {
+                AgentVector pop(*agent.second->description);
+                getPopulationData(pop, state);
+                out.writeString(agent.first);
+                out.writeString(state);
+                out.write<uint32_t>(pop.size());
+                const VariableMap &variables = agent.second->variables;
+                out.write<uint32_t>(static_cast<uint32_t>(variables.size()));
+                for (const auto &var : variables) {
+                    const size_t variable_size = var.second.type_size * var.second.elements;
+                    out.writeString(var.first);
+                    out.write<uint64_t>(variable_size);
+                    if (pop.size()) {
+                        out.write(pop._data->at(var.first)->getReadOnlyDataPtr(), pop.size() * variable_size);
+                    }
+                }
+            }
+        }
+    }
+    checkpoint_derived(*ckpt);
+    checkpoint_writer->write(ckpt, path);
+}
+void Simulation::waitForCheckpoint() {
+    if (checkpoint_writer) {
+        checkpoint_writer->wait();
+    }
+}
+void Simulation::restore(const std::string &path) {
+    NVTX_RANGE("Simulation::restore");
+    // The file may be the target of a write still in flight
+    waitForCheckpoint();
+    const std::shared_ptr<io::Checkpoint> ckpt = io::Checkpoint::load(path);
+    if (ckpt->getModelName() != model->name) {
+        THROW exception::InvalidInputFile("Checkpoint file '%s' was produced by model '%s', not '%s', "
+            "in Simulation::restore()\n", path.c_str(), ckpt->getModelName().c_str(), model->name.c_str());
+    }
+    {
+        io::Checkpoint::SectionReader in = ckpt->getSection("config");
+        config.random_seed = in.read<uint64_t>();
+    }
+    {
+        io::Checkpoint::SectionReader in = ckpt->getSection("populations");
+        while (!in.eof()) {
+            const std::string agent_name = in.readString();
+            const std::string state_name = in.readString();
+            const uint32_t count = in.read<uint32_t>();
+            const uint32_t variable_count = in.read<uint32_t>();
+            const auto agent = model->agents.find(agent_name);
+            if (agent == model->agents.end() || agent->second->states.find(state_name) == agent->second->states.end()
+                || variable_count != agent->second->variables.size()) {
+                THROW exception::InvalidInputFile("Checkpoint file '%s' contains agent:state '%s:%s' which does not match the model, "
+                    "in Simulation::restore()\n", path.c_str(), agent_name.c_str(), state_name.c_str());
+            }
+            AgentVector pop(*agent->second->description);
+            // Every element is about to be overwritten, so skip default init
+            if (count) {
+                pop.internal_resize(count, false);
+            }
+            for (uint32_t i = 0; i < variable_count; ++i) {
+                const std::string name = in.readString();
+                const uint64_t variable_size = in.read<uint64_t>();
+                const auto var = agent->second->variables.find(name);
+                if (var == agent->second->variables.end() || variable_size != var->second.type_size * var->second.elements) {
+                    THROW exception::InvalidInputFile("Checkpoint file '%s' contains agent variable '%s:%s' which does not match the model, "
+                        "in Simulation::restore()\n", path.c_str(), agent_name.c_str(), name.c_str());
+                }
+                if (count) {
+                    in.read(pop._data->at(name)->getDataPtr(), count * static_cast<size_t>(variable_size));
+                }
+            }
+            pop._size = count;
+            setPopulationData(pop, state_name);
+        }
+    }
+    restore_derived(*ckpt);
+    resume_from_checkpoint = true;
+}
+void Simulation::processCheckpoint(const unsigned int step_count) {
+    if (config.checkpoint_frequency && !config.checkpoint_file.empty() && step_count % config.checkpoint_frequency == 0) {
+        checkpoint(config.checkpoint_file);
+    }
+}
+void Simulation::checkpointStepLog(const std::list<StepLogFrame> &step_log, io::Checkpoint &checkpoint) {
+    io::Checkpoint::SectionWriter out = checkpoint.newSection("step_log");
+    out.write<uint64_t>(step_log.size());
+    for (const auto &frame : step_log) {
+        out.write<uint32_t>(frame.getStepCount());
+        out.write<double>(frame.getStepTime());
+        out.write<uint64_t>(frame.getEnvironment().size());
+        for (const auto &prop : frame.getEnvironment()) {
+            out.writeString(prop.first);
+            out.writeAny(prop.second);
+        }
+        out.write<uint64_t>(frame.getAgents().size());
+        for (const auto &agent : frame.getAgents()) {
+            out.writeString(agent.first.first);
+            out.writeString(agent.first.second);
+            out.write<uint32_t>(agent.second.second);
+            out.write<uint64_t>(agent.second.first.size());
+            for (const auto &reduction : agent.second.first) {
+                out.writeString(reduction.first.name);
+                out.write<uint32_t>(static_cast<uint32_t>(reduction.first.reduction));
+                out.writeString(reduction.first.secondary_name);
+                out.write<uint64_t>(reduction.first.parameters.size());
+                out.write(reduction.first.parameters.data(), reduction.first.parameters.size() * sizeof(double));
+                out.writeAny(reduction.second);
+            }
+        }
+    }
+}
+std::list<StepLogFrame> Simulation::restoreStepLog(const io::Checkpoint &checkpoint) {
+    std::list<StepLogFrame> rtn;
+    io::Checkpoint::SectionReader in = checkpoint.getSection("step_log");
+    const uint64_t frame_count = in.read<uint64_t>();
+    for (uint64_t i = 0; i < frame_count; ++i) {
+        const unsigned int step_count = in.read<uint32_t>();
+        const double step_time = in.read<double>();
+        std::map<std::string, util::Any> environment;
+        const uint64_t environment_count = in.read<uint64_t>();
+        for (uint64_t j = 0; j < environment_count; ++j) {
+            std::string name = in.readString();
+            environment.emplace(std::move(name), in.readAny());
+        }
+        std::map<util::StringPair, std::pair<std::map<LoggingConfig::NameReductionFn, util::Any>, unsigned int>> agents;
+        const uint64_t agent_count = in.read<uint64_t>();
+        for (uint64_t j = 0; j < agent_count; ++j) {
+            std::string agent_name = in.readString();
+            std::string state_name = in.readString();
+            const unsigned int count = in.read<uint32_t>();
+            std::map<LoggingConfig::NameReductionFn, util::Any> reductions;
+            const uint64_t reduction_count = in.read<uint64_t>();
+            for (uint64_t k = 0; k < reduction_count; ++k) {
+                // The reduction functions are not required once the value has been logged
+                LoggingConfig::NameReductionFn reduction = {};
+                reduction.name = in.readString();
+                reduction.reduction = static_cast<LoggingConfig::Reduction>(in.read<uint32_t>());
+                reduction.function = nullptr;
+                reduction.host_function = nullptr;
+                reduction.secondary_name = in.readString();
+                reduction.parameters.resize(static_cast<size_t>(in.read<uint64_t>()));
+                in.read(reduction.parameters.data(), reduction.parameters.size() * sizeof(double));
+                reductions.emplace(std::move(reduction), in.readAny());
+            }
+            agents.emplace(util::StringPair{std::move(agent_name), std::move(state_name)}, std::make_pair(std::move(reductions), count));
+        }
+        rtn.emplace_back(std::move(environment), std::move(agents), step_count);
+        rtn.back().step_time = step_time;
+    }
+    return rtn;
+}
+
 unsigned int Simulation::get_instance_id() {
     static std::atomic<unsigned int> i = {0};;
     return 641 * (i++);
@@ -0,0 +1,38 @@
+#include "flamegpu/util/detail/CUDAMemoryResource.h"
+
+#include <cuda_runtime.h>
+
+#include "flamegpu/gpu/detail/CUDAErrorChecking.cuh"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+void *CUDAMemoryResource::allocate(const size_t bytes) {
+    void *ptr = nullptr;
+#ifdef UNIFIED_GPU_MEMORY
+    const cudaError_t status = cudaMallocManaged(&ptr, bytes);
+#else
+    const cudaError_t status = cudaMalloc(&ptr, bytes);
+#endif
+    if (status == cudaErrorMemoryAllocation) {
+        // Clear the error, so it is not reported by a later check
+        cudaGetLastError();
+        return nullptr;
+    }
+    gpuErrchk(status);
+    return ptr;
+}
+void CUDAMemoryResource::deallocate(void *ptr) {
+    if (ptr) {
+        gpuErrchk(cudaFree(ptr));
+    }
+}
+CUDAMemoryResource &CUDAMemoryResource::getInstance() {
+    static CUDAMemoryResource instance;
+    return instance;
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
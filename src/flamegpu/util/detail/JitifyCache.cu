@@ -1,12 +1,17 @@
 #include "flamegpu/util/detail/JitifyCache.h"
 
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
+#include <fstream>
 #include <regex>
 #include <array>
 
 #include "flamegpu/version.h"
 #include "flamegpu/exception/FLAMEGPUException.h"
 #include "flamegpu/util/detail/compute_capability.cuh"
+#include "flamegpu/util/detail/SHA256.h"
+#include "flamegpu/util/detail/Tracer.h"
 #include "flamegpu/util/nvtx.h"
 
 // If MSVC earlier than VS 2019
@@ -28,9 +33,6 @@ using std::experimental::filesystem::v1::path;
 using std::experimental::filesystem::v1::directory_iterator;
 #endif
 
-using jitify::detail::hash_combine;
-using jitify::detail::hash_larson64;
-
 namespace flamegpu {
 namespace util {
 namespace detail {
@@ -41,8 +43,8 @@ namespace {
  * Defined here to avoid filesystem includes being in header
  */
 path getTMP() {
-    static path result;
-    if (result.empty()) {
+    // Initialised once, on first use, in a thread safe manner
+    static const path result = []() {
         path tmp =  std::getenv("FLAMEGPU_TMP_DIR") ? std::getenv("FLAMEGPU_TMP_DIR") : temp_directory_path();
         // Create the $tmp/flamegpu/jitifycache(/debug) folder hierarchy
         if (!::exists(tmp) && !create_directory(tmp)) {
@@ -64,16 +66,17 @@ path getTMP() {
             create_directory(tmp);
         }
 #endif
-        result = tmp;
-    }
+        return tmp;
+    }();
     return result;
 }
 /**
  * Returns the user-defined include directories
  */
 std::vector<path> getIncludeDirs() {
-    static std::vector<path> rtn;
-    if (rtn.empty()) {
+    // Initialised once, on first use, in a thread safe manner
+    static const std::vector<path> result = []() {
+        std::vector<path> rtn;
         if (std::getenv("FLAMEGPU_RTC_INCLUDE_DIRS")) {
             const std::string s = std::getenv("FLAMEGPU_RTC_INCLUDE_DIRS");
             // Split the string by ; (windows), : (linux)
@@ -94,24 +97,9 @@ std::vector<path> getIncludeDirs() {
         } else {
             rtn.push_back(current_path());
         }
-    }
-    return rtn;
-}
-std::string loadFile(const path &filepath) {
-    std::ifstream ifs;
-    ifs.open(filepath, std::ifstream::binary);
-    if (!ifs)
-    return "";
-    // get length of file
-    ifs.seekg(0, ifs.end);
-    const std::streamoff length = ifs.tellg();
-    ifs.seekg(0, ifs.beg);
-    std::string rtn;
-    rtn.resize(length);
-    char *buffer = &rtn[0];
-    ifs.read(buffer, length);
-    ifs.close();
-    return rtn;
+        return rtn;
+    }();
+    return result;
 }
 
 /**
@@ -233,7 +221,8 @@ break_flamegpu_inc_dir_loop:
  * @return boolean indicator of success.
  */
 bool confirmFLAMEGPUHeaderVersion(const std::string flamegpuIncludeDir, const std::string envVariable) {
-    static bool header_version_confirmed = false;
+    // Atomic, as kernels may be compiled by multiple threads concurrently
+    static std::atomic<bool> header_version_confirmed{false};
 
     if (!header_version_confirmed) {
         std::string fileHash;
@@ -285,6 +274,7 @@ bool confirmFLAMEGPUHeaderVersion(const std::string flamegpuIncludeDir, const st
 std::mutex JitifyCache::instance_mutex;
 std::unique_ptr<KernelInstantiation> JitifyCache::compileKernel(const std::string &func_name, const std::vector<std::string> &template_args, const std::string &kernel_src, const std::string &dynamic_header) {
     NVTX_RANGE("JitifyCache::compileKernel");
+    Tracer::Scope trace_scope("rtc_compile", func_name);
     // find and validate the cuda include directory via CUDA_PATH or CUDA_HOME.
     static const std::string cuda_include_dir = getCUDAIncludeDir();
     // find and validate the the flamegpu include directory
@@ -457,7 +447,7 @@ void JitifyCache::getKnownHeaders(std::vector<std::string>& headers) {
 
 std::unique_ptr<KernelInstantiation> JitifyCache::loadKernel(const std::string &func_name, const std::vector<std::string> &template_args, const std::string &kernel_src, const std::string &dynamic_header) {
     NVTX_RANGE("JitifyCache::loadKernel");
-    std::lock_guard<std::mutex> lock(cache_mutex);
+    Tracer::Scope trace_scope("rtc_load", func_name);
     // Detect current compute capability=
     int currentDeviceIdx = 0;
     cudaError_t status = cudaGetDevice(&currentDeviceIdx);
@@ -465,68 +455,81 @@ std::unique_ptr<KernelInstantiation> JitifyCache::loadKernel(const std::string &
     status = cudaRuntimeGetVersion(&currentDeviceIdx);
     const std::string cuda_version = std::to_string((status == cudaSuccess) ? currentDeviceIdx : 0);
     const std::string seatbelts = std::to_string(SEATBELTS);
-    // Cat kernel, dynamic header, header version
-    const std::string long_reference = kernel_src + dynamic_header;  // Don't need to include rest, they are explicit in short reference/filename
-    // Generate short reference string
-    // Would prefer to use a proper hash, e.g. md5(reference_string), but that requires extra dependencies
-    const std::string short_reference =
-        cuda_version + "_" +
-        arch + "_" +
-        seatbelts + "_" +
-        std::string(flamegpu::VERSION_FULL) + "_" +
-        // Use jitify hash methods for consistent hashing between OSs
-        std::to_string(hash_combine(hash_larson64(kernel_src.c_str()), hash_larson64(dynamic_header.c_str())));
-    // Does a copy with the right reference exist in memory?
-    if (use_memory_cache) {
-        const auto it = cache.find(short_reference);
-        if (it != cache.end()) {
-            // Check long reference
-            if (it->second.long_reference == long_reference) {
-                return std::make_unique<KernelInstantiation>(KernelInstantiation::deserialize(it->second.serialised_kernelinst));
+    // Identify the kernel by a digest of everything which affects its compilation
+    // Each field is length prefixed, so that no two distinct sets of fields produce the same message
+    SHA256 sha;
+    const auto hashField = [&sha](const std::string &field) {
+        sha.update(std::to_string(field.size()) + ":");
+        sha.update(field);
+    };
+    hashField(cuda_version);
+    hashField(arch);
+    hashField(seatbelts);
+    hashField(flamegpu::VERSION_FULL);
+    for (const auto &arg : template_args)
+        hashField(arg);
+    hashField(kernel_src);
+    hashField(dynamic_header);
+    const std::string digest = sha.hexdigest();
+    // Does a copy with the right digest exist in memory?
+    bool memory_cache;
+    KernelCacheStore *disk_cache = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        memory_cache = use_memory_cache;
+        if (use_disk_cache) {
+            disk_cache = &getDiskStore();
+        }
+        if (memory_cache) {
+            const auto it = cache.find(digest);
+            if (it != cache.end()) {
+                return std::make_unique<KernelInstantiation>(KernelInstantiation::deserialize(it->second));
             }
         }
     }
-    // Does a copy with the right reference exist on disk?
-    const path cache_file = getTMP() / short_reference;
-    const path reference_file = cache_file.parent_path() / path(cache_file.filename().string() + ".ref");
-    if (use_disk_cache && exists(cache_file)) {
-        // Load the long reference for the cache file
-        const std::string file_long_reference = loadFile(reference_file);
-        if (file_long_reference == long_reference) {
-            // Load the cache file
-            const std::string serialised_kernelinst = loadFile(cache_file);
-            if (!serialised_kernelinst.empty()) {
-                // Add it to cache for later loads
-                cache.emplace(short_reference, CachedProgram{long_reference, serialised_kernelinst});
-                // Deserialize and return program
-                return std::make_unique<KernelInstantiation>(KernelInstantiation::deserialize(serialised_kernelinst));
+    // Load from disk or compile, without holding cache_mutex so that unrelated kernels can be compiled concurrently
+    // Concurrent requests for the same kernel wait on the thread which is already loading it
+    std::unique_ptr<KernelInstantiation> kernelinst;
+    bool is_leader = false;
+    const std::string serialised_kernelinst = in_flight.run(digest, [&]() {
+        // Another thread may have completed loading this kernel since the memory cache was checked
+        if (memory_cache) {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            const auto it = cache.find(digest);
+            if (it != cache.end()) {
+                return it->second;
             }
         }
-    }
-    // Kernel has not yet been cached
-    {
-        // Build kernel
-        auto kernelinst = compileKernel(func_name, template_args, kernel_src, dynamic_header);
+        // Does a copy with the right digest exist on disk?
+        std::string serialised;
+        if (disk_cache && disk_cache->load(digest, serialised) && !serialised.empty()) {
+            // Add it to cache for later loads
+            if (memory_cache) {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                cache.emplace(digest, serialised);
+            }
+            return serialised;
+        }
+        // Kernel has not yet been cached, build kernel
+        kernelinst = compileKernel(func_name, template_args, kernel_src, dynamic_header);
+        // Threads waiting on this compilation receive the serialised kernel, so it must always be serialised
+        serialised = kernelinst->serialize();
         // Add it to cache for later loads
-        const std::string serialised_kernelinst = use_memory_cache || use_disk_cache ? kernelinst->serialize() : "";
-        if (use_memory_cache) {
-            cache.emplace(short_reference, CachedProgram{long_reference, serialised_kernelinst});
+        if (memory_cache) {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            cache.emplace(digest, serialised);
         }
-        // Save it to disk
-        if (use_disk_cache) {
-            std::ofstream ofs(cache_file, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-            if (ofs) {
-                ofs << serialised_kernelinst;
-                ofs.close();
-            }
-            ofs = std::ofstream(reference_file, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-            if (ofs) {
-                ofs << long_reference;
-                ofs.close();
-            }
+        // Save it to disk, this is atomic so concurrent processes sharing the cache never load a partial kernel
+        if (disk_cache) {
+            disk_cache->store(digest, serialised);
         }
+        return serialised;
+    }, &is_leader);
+    // The thread which compiled the kernel can return it directly, others deserialise their own instance
+    if (is_leader && kernelinst) {
         return kernelinst;
     }
+    return std::make_unique<KernelInstantiation>(KernelInstantiation::deserialize(serialised_kernelinst));
 }
 void JitifyCache::useMemoryCache(bool yesno) {
     std::lock_guard<std::mutex> lock(cache_mutex);
@@ -550,6 +553,8 @@ void JitifyCache::clearMemoryCache() {
 }
 void JitifyCache::clearDiskCache() {
     std::lock_guard<std::mutex> lock(cache_mutex);
+    getDiskStore().clear();
+    // Also remove any files written by earlier versions of the cache
     const path tmp_dir = getTMP();
     for (const auto & entry : directory_iterator(tmp_dir)) {
         if (is_regular_file(entry.path())) {
@@ -557,13 +562,43 @@ void JitifyCache::clearDiskCache() {
         }
     }
 }
+void JitifyCache::setDiskCacheLimit(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    disk_cache_limit = bytes;
+    if (disk_store)
+        disk_store->setMaxBytes(bytes);
+}
+uint64_t JitifyCache::getDiskCacheLimit() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return disk_cache_limit;
+}
+void JitifyCache::useDiskCacheCompression(bool yesno) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    use_disk_cache_compression = yesno;
+    if (disk_store)
+        disk_store->setCompression(yesno);
+}
+bool JitifyCache::useDiskCacheCompression() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return use_disk_cache_compression;
+}
+KernelCacheStore &JitifyCache::getDiskStore() {
+    if (!disk_store) {
+        disk_store = std::make_unique<KernelCacheStore>(getTMP().string(), disk_cache_limit, use_disk_cache_compression);
+    }
+    return *disk_store;
+}
 JitifyCache::JitifyCache()
     : use_memory_cache(true)
 #ifndef DISABLE_RTC_DISK_CACHE
-    , use_disk_cache(true) { }
+    , use_disk_cache(true)
 #else
-    , use_disk_cache(false) { }
+    , use_disk_cache(false)
 #endif
+    , use_disk_cache_compression(true)
+    , disk_cache_limit(std::getenv("FLAMEGPU_RTC_DISK_CACHE_MB") ?
+        static_cast<uint64_t>(strtoull(std::getenv("FLAMEGPU_RTC_DISK_CACHE_MB"), nullptr, 0)) << 20 :
+        KernelCacheStore::DEFAULT_MAX_BYTES) { }
 JitifyCache& JitifyCache::getInstance() {
     auto lock = std::unique_lock<std::mutex>(instance_mutex);  // Mutex to protect from two threads triggering the static instantiation concurrently
     static JitifyCache instance;  // Instantiated on first use.
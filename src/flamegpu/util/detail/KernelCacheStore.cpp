@@ -0,0 +1,466 @@
+#include "flamegpu/util/detail/KernelCacheStore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+// If MSVC earlier than VS 2019
+#if defined(_MSC_VER) && _MSC_VER < 1920
+#include <filesystem>
+using std::tr2::sys::directory_iterator;
+using std::tr2::sys::exists;
+using std::tr2::sys::file_size;
+using std::tr2::sys::last_write_time;
+using std::tr2::sys::path;
+using std::tr2::sys::remove;
+using std::tr2::sys::rename;
+#else
+// VS2019 requires this macro, as building pre c++17 cant use std::filesystem
+#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
+#include <experimental/filesystem>
+using std::experimental::filesystem::v1::directory_iterator;
+using std::experimental::filesystem::v1::exists;
+using std::experimental::filesystem::v1::file_size;
+using std::experimental::filesystem::v1::last_write_time;
+using std::experimental::filesystem::v1::path;
+using std::experimental::filesystem::v1::remove;
+using std::experimental::filesystem::v1::rename;
+#endif
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+namespace {
+const char ENTRY_MAGIC[8] = {'F', 'G', 'P', 'U', 'K', 'C', '0', '1'};
+const char ENTRY_EXT[] = ".fgpuk";
+const char INDEX_FILE[] = "index";
+const char INDEX_HEADER[] = "FLAMEGPU_KERNEL_CACHE_INDEX 1";
+const char TEMP_EXT[] = ".tmp";
+const uint8_t FLAG_COMPRESSED = 1;
+/**
+ * Temporary files older than this were abandoned by a process which did not complete writing them
+ */
+const std::chrono::hours TEMP_FILE_LIFETIME(1);
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+/**
+ * 64 bit FNV-1a, used to detect damaged entries
+ */
+uint64_t checksum(const std::string &data) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const char c : data) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+void writeU64(std::string &out, uint64_t v) {
+    for (int i = 0; i < 8; ++i)
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+}
+uint64_t readU64(const char *in) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | static_cast<unsigned char>(in[i]);
+    return v;
+}
+uint32_t readU32(const std::string &in, size_t pos) {
+    uint32_t v;
+    memcpy(&v, in.data() + pos, sizeof(uint32_t));
+    return v;
+}
+/**
+ * Appends an LZ77 length extension, in runs of 255
+ */
+void writeLength(std::string &out, size_t len) {
+    while (len >= 255) {
+        out.push_back(static_cast<char>(255));
+        len -= 255;
+    }
+    out.push_back(static_cast<char>(len));
+}
+/**
+ * Byte oriented LZ77 compression, using the sequence layout of the LZ4 block format
+ * Each sequence is a token (literal length, match length - 4), the literals, a 16 bit match offset and any length extensions.
+ * The final sequence has no match. Serialised kernels are mostly PTX text, which this typically shrinks to a third of its size.
+ */
+std::string lzCompress(const std::string &src) {
+    const size_t MIN_MATCH = 4;
+    const unsigned int HASH_BITS = 14;
+    const size_t MAX_OFFSET = 65535;
+    const uint32_t NONE = UINT32_MAX;
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, NONE);
+    std::string out;
+    out.reserve(src.size() / 2 + 16);
+    size_t anchor = 0;
+    size_t i = 0;
+    const auto emit = [&](size_t literal_end, size_t offset, size_t match_len) {
+        const size_t lit = literal_end - anchor;
+        const size_t ml = match_len ? match_len - MIN_MATCH : 0;
+        out.push_back(static_cast<char>((std::min<size_t>(lit, 15) << 4) | std::min<size_t>(ml, 15)));
+        if (lit >= 15)
+            writeLength(out, lit - 15);
+        out.append(src, anchor, lit);
+        if (match_len) {
+            out.push_back(static_cast<char>(offset & 0xff));
+            out.push_back(static_cast<char>(offset >> 8));
+            if (ml >= 15)
+                writeLength(out, ml - 15);
+        }
+    };
+    while (i + MIN_MATCH <= src.size()) {
+        const uint32_t v = readU32(src, i);
+        const uint32_t h = (v * 2654435761u) >> (32 - HASH_BITS);
+        const uint32_t candidate = table[h];
+        table[h] = static_cast<uint32_t>(i);
+        if (candidate != NONE && i - candidate <= MAX_OFFSET && readU32(src, candidate) == v) {
+            size_t len = MIN_MATCH;
+            while (i + len < src.size() && src[candidate + len] == src[i + len])
+                ++len;
+            emit(i, i - candidate, len);
+            i += len;
+            anchor = i;
+        } else {
+            ++i;
+        }
+    }
+    emit(src.size(), 0, 0);
+    return out;
+}
+/**
+ * Inverse of lzCompress()
+ * @return False if src is malformed or does not decompress to exactly expected_size bytes
+ */
+bool lzDecompress(const std::string &src, const size_t expected_size, std::string &out) {
+    out.clear();
+    // Each byte of src can produce at most 255 bytes of output, so a damaged size can't cause a huge allocation
+    out.reserve(std::min<size_t>(expected_size, src.size() * 255));
+    size_t ip = 0;
+    const auto readLength = [&](size_t &len) {
+        unsigned char b;
+        do {
+            if (ip >= src.size())
+                return false;
+            b = static_cast<unsigned char>(src[ip++]);
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+    while (ip < src.size()) {
+        const unsigned char token = static_cast<unsigned char>(src[ip++]);
+        size_t lit = token >> 4;
+        if (lit == 15 && !readLength(lit))
+            return false;
+        if (lit > src.size() - ip || out.size() + lit > expected_size)
+            return false;
+        out.append(src, ip, lit);
+        ip += lit;
+        if (ip == src.size())
+            break;
+        if (src.size() - ip < 2)
+            return false;
+        const size_t offset = static_cast<unsigned char>(src[ip]) | (static_cast<size_t>(static_cast<unsigned char>(src[ip + 1])) << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && !readLength(len))
+            return false;
+        len += 4;
+        if (offset == 0 || offset > out.size() || out.size() + len > expected_size)
+            return false;
+        // Matches may overlap the bytes they produce, so copy byte by byte
+        size_t from = out.size() - offset;
+        for (size_t j = 0; j < len; ++j)
+            out.push_back(out[from + j]);
+    }
+    return out.size() == expected_size;
+}
+void validateKey(const std::string &key, const char *method) {
+    if (key.empty() || key.size() > 255 || !std::all_of(key.begin(), key.end(), [](unsigned char c) { return isalnum(c); })) {
+        THROW exception::InvalidArgument("Kernel cache key '%s' must be 1-255 alpha-numeric characters, in KernelCacheStore::%s()\n", key.c_str(), method);
+    }
+}
+/**
+ * Returns the key of the entry stored in file p, or an empty string if it is not an entry
+ */
+std::string getEntryKey(const path &p) {
+    const std::string name = p.filename().string();
+    const size_t ext_len = sizeof(ENTRY_EXT) - 1;
+    if (name.size() > ext_len && name.compare(name.size() - ext_len, ext_len, ENTRY_EXT) == 0)
+        return name.substr(0, name.size() - ext_len);
+    return "";
+}
+bool isTempFile(const path &p) {
+    const std::string name = p.filename().string();
+    const size_t ext_len = sizeof(TEMP_EXT) - 1;
+    return name.size() > ext_len && name.compare(name.size() - ext_len, ext_len, TEMP_EXT) == 0;
+}
+}  // namespace
+
+KernelCacheStore::KernelCacheStore(const std::string &_directory, uint64_t _max_bytes, bool _compress)
+    : directory(_directory)
+    , max_bytes(_max_bytes)
+    , compress(_compress) { }
+KernelCacheStore::~KernelCacheStore() {
+    try {
+        flush();
+    } catch (...) { }
+}
+
+bool KernelCacheStore::load(const std::string &key, std::string &value) {
+    validateKey(key, "load");
+    std::string file;
+    {
+        std::ifstream ifs(path(directory) / path(key + ENTRY_EXT), std::ifstream::binary);
+        if (!ifs)
+            return false;
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        file = ss.str();
+    }
+    // Header: magic, flags, value size, value checksum, key length, key
+    const size_t HEADER_SIZE = sizeof(ENTRY_MAGIC) + 1 + 8 + 8 + 1;
+    if (file.size() < HEADER_SIZE + key.size() || memcmp(file.data(), ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) != 0)
+        return false;
+    size_t pos = sizeof(ENTRY_MAGIC);
+    const uint8_t flags = static_cast<uint8_t>(file[pos++]);
+    const uint64_t size = readU64(file.data() + pos);
+    pos += 8;
+    const uint64_t sum = readU64(file.data() + pos);
+    pos += 8;
+    const size_t key_len = static_cast<uint8_t>(file[pos++]);
+    if (key_len != key.size() || file.compare(pos, key_len, key) != 0)
+        return false;
+    pos += key_len;
+    if (flags & FLAG_COMPRESSED) {
+        if (!lzDecompress(file.substr(pos), static_cast<size_t>(size), value))
+            return false;
+    } else {
+        if (file.size() - pos != size)
+            return false;
+        value = file.substr(pos);
+    }
+    if (checksum(value) != sum)
+        return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    access_times[key] = now();
+    return true;
+}
+void KernelCacheStore::store(const std::string &key, const std::string &value) {
+    validateKey(key, "store");
+    const bool use_compression = getCompression();
+    std::string file(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    file.push_back(static_cast<char>(use_compression ? FLAG_COMPRESSED : 0));
+    writeU64(file, value.size());
+    writeU64(file, checksum(value));
+    file.push_back(static_cast<char>(key.size()));
+    file.append(key);
+    file.append(use_compression ? lzCompress(value) : value);
+    // Write to a temporary file, then rename it into place, so that other processes never read a partial entry
+    const path temp_path = getTempPath(key);
+    const path entry_path = path(directory) / path(key + ENTRY_EXT);
+    {
+        std::ofstream ofs(temp_path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+        if (ofs) {
+            ofs.write(file.data(), file.size());
+            ofs.close();
+        }
+        if (!ofs) {
+            std::error_code ec;
+            remove(temp_path, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    rename(temp_path, entry_path, ec);
+    if (ec) {
+        remove(temp_path, ec);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    access_times[key] = now();
+    evict(key);
+    writeIndex();
+}
+void KernelCacheStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::error_code ec;
+    for (directory_iterator it(path(directory), ec), end; !ec && it != end; it.increment(ec)) {
+        const path p = it->path();
+        if (!getEntryKey(p).empty() || isTempFile(p) || p.filename().string() == INDEX_FILE) {
+            std::error_code remove_ec;
+            remove(p, remove_ec);
+        }
+    }
+    access_times.clear();
+}
+void KernelCacheStore::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!access_times.empty())
+        writeIndex();
+}
+uint64_t KernelCacheStore::getSize() const {
+    uint64_t total = 0;
+    std::error_code ec;
+    for (directory_iterator it(path(directory), ec), end; !ec && it != end; it.increment(ec)) {
+        if (!getEntryKey(it->path()).empty()) {
+            std::error_code size_ec;
+            const uint64_t size = file_size(it->path(), size_ec);
+            if (!size_ec)
+                total += size;
+        }
+    }
+    return total;
+}
+void KernelCacheStore::setMaxBytes(uint64_t _max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    max_bytes = _max_bytes;
+}
+uint64_t KernelCacheStore::getMaxBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return max_bytes;
+}
+void KernelCacheStore::setCompression(bool _compress) {
+    std::lock_guard<std::mutex> lock(mutex);
+    compress = _compress;
+}
+bool KernelCacheStore::getCompression() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return compress;
+}
+
+void KernelCacheStore::writeIndex() {
+    AccessMap index = readIndex();
+    for (const auto &a : access_times) {
+        auto &t = index[a.first];
+        t = std::max(t, a.second);
+    }
+    std::stringstream ss;
+    ss << INDEX_HEADER << "\n";
+    for (const auto &a : index) {
+        // Drop entries which have been evicted
+        if (exists(path(directory) / path(a.first + ENTRY_EXT)))
+            ss << a.first << " " << a.second << "\n";
+    }
+    const std::string data = ss.str();
+    const path temp_path = getTempPath(INDEX_FILE);
+    {
+        std::ofstream ofs(temp_path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+        if (ofs) {
+            ofs.write(data.data(), data.size());
+            ofs.close();
+        }
+        if (!ofs) {
+            std::error_code ec;
+            remove(temp_path, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    rename(temp_path, path(directory) / path(INDEX_FILE), ec);
+    if (ec) {
+        remove(temp_path, ec);
+        return;
+    }
+    access_times.clear();
+}
+void KernelCacheStore::evict(const std::string &keep) {
+    if (!max_bytes)
+        return;
+    struct Entry {
+        path file;
+        std::string key;
+        uint64_t size;
+        int64_t access;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    const AccessMap index = readIndex();
+    // Compare against the modification time of the entry just written, as the filesystem's clock may differ from the system clock
+    std::error_code ec;
+    const auto reference_time = last_write_time(path(directory) / path(keep + ENTRY_EXT), ec);
+    const bool remove_temp_files = !ec;
+    for (directory_iterator it(path(directory), ec), end; !ec && it != end; it.increment(ec)) {
+        const path p = it->path();
+        std::error_code file_ec;
+        if (isTempFile(p)) {
+            // Remove temporary files abandoned by processes which were killed whilst writing them
+            if (remove_temp_files) {
+                const auto write_time = last_write_time(p, file_ec);
+                if (!file_ec && reference_time - write_time > TEMP_FILE_LIFETIME)
+                    remove(p, file_ec);
+            }
+            continue;
+        }
+        const std::string key = getEntryKey(p);
+        if (key.empty())
+            continue;
+        const uint64_t size = file_size(p, file_ec);
+        if (file_ec)
+            continue;
+        total += size;
+        if (key == keep)
+            continue;
+        // Entries which are missing from the index are treated as least recently used
+        int64_t access = 0;
+        const auto a = access_times.find(key);
+        if (a != access_times.end())
+            access = a->second;
+        const auto i = index.find(key);
+        if (i != index.end())
+            access = std::max(access, i->second);
+        entries.push_back({p, key, size, access});
+    }
+    if (total <= max_bytes)
+        return;
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.access < b.access; });
+    for (const auto &e : entries) {
+        if (total <= max_bytes)
+            break;
+        std::error_code remove_ec;
+        remove(e.file, remove_ec);
+        // If removal failed, another process may have already evicted the entry
+        if (!remove_ec || !exists(e.file))
+            total -= e.size;
+        access_times.erase(e.key);
+    }
+}
+KernelCacheStore::AccessMap KernelCacheStore::readIndex() const {
+    AccessMap rtn;
+    std::ifstream ifs(path(directory) / path(INDEX_FILE));
+    std::string line;
+    if (!ifs || !std::getline(ifs, line) || line != INDEX_HEADER)
+        return rtn;
+    std::string key;
+    int64_t access;
+    while (ifs >> key >> access) {
+        rtn[key] = access;
+    }
+    return rtn;
+}
+std::string KernelCacheStore::getTempPath(const std::string &name) const {
+    // Seeded per thread, so that concurrent threads and processes choose distinct names
+    thread_local std::mt19937_64 rng([]() {
+        std::random_device rd;
+        return rd() ^ std::hash<std::thread::id>()(std::this_thread::get_id()) ^ static_cast<uint64_t>(now());
+    }());
+    std::stringstream ss;
+    ss << name << "." << std::hex << rng() << TEMP_EXT;
+    return (path(directory) / path(ss.str())).string();
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
@@ -0,0 +1,87 @@
+#include "flamegpu/util/detail/MemoryMappedFile.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+#ifdef _MSC_VER
+MemoryMappedFile::MemoryMappedFile(const std::string &file_path) {
+    file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        file_handle = nullptr;
+        THROW exception::InvalidFilePath("Unable to open file '%s' for reading, in MemoryMappedFile::MemoryMappedFile()\n", file_path.c_str());
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        THROW exception::InvalidFilePath("Unable to query size of file '%s', in MemoryMappedFile::MemoryMappedFile()\n", file_path.c_str());
+    }
+    length = static_cast<size_t>(file_size.QuadPart);
+    // Empty files cannot be mapped
+    if (length) {
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle) {
+            ptr = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!ptr) {
+            if (mapping_handle)
+                CloseHandle(mapping_handle);
+            CloseHandle(file_handle);
+            THROW exception::InvalidFilePath("Unable to memory map file '%s', in MemoryMappedFile::MemoryMappedFile()\n", file_path.c_str());
+        }
+    }
+}
+MemoryMappedFile::~MemoryMappedFile() {
+    if (ptr)
+        UnmapViewOfFile(ptr);
+    if (mapping_handle)
+        CloseHandle(mapping_handle);
+    if (file_handle)
+        CloseHandle(file_handle);
+}
+#else
+MemoryMappedFile::MemoryMappedFile(const std::string &file_path) {
+    fd = open(file_path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        THROW exception::InvalidFilePath("Unable to open file '%s' for reading, in MemoryMappedFile::MemoryMappedFile()\n", file_path.c_str());
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        close(fd);
+        THROW exception::InvalidFilePath("Unable to query size of file '%s', in MemoryMappedFile::MemoryMappedFile()\n", file_path.c_str());
+    }
+    length = static_cast<size_t>(file_stat.st_size);
+    // Empty files cannot be mapped
+    if (length) {
+        void *t_ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (t_ptr == MAP_FAILED) {
+            close(fd);
+            THROW exception::InvalidFilePath("Unable to memory map file '%s', in MemoryMappedFile::MemoryMappedFile()\n", file_path.c_str());
+        }
+        // Columns are read front to back
+        madvise(t_ptr, length, MADV_SEQUENTIAL);
+        ptr = static_cast<const char*>(t_ptr);
+    }
+}
+MemoryMappedFile::~MemoryMappedFile() {
+    if (ptr)
+        munmap(const_cast<char*>(ptr), length);
+    if (fd != -1)
+        close(fd);
+}
+#endif
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
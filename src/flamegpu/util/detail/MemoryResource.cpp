@@ -0,0 +1,143 @@
+#include "flamegpu/util/detail/MemoryResource.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+void *MemoryResource::allocateOrThrow(const size_t bytes) {
+    void *ptr = allocate(bytes);
+    if (!ptr) {
+        THROW exception::OutOfMemory("Unable to allocate %llu bytes, in MemoryResource::allocateOrThrow()\n", static_cast<unsigned long long>(bytes));
+    }
+    return ptr;
+}
+
+void *HostMemoryResource::allocate(const size_t bytes) {
+    return std::malloc(bytes);
+}
+void HostMemoryResource::deallocate(void *ptr) {
+    std::free(ptr);
+}
+
+constexpr size_t PoolMemoryResource::MIN_BLOCK_SIZE;
+
+PoolMemoryResource::PoolMemoryResource(MemoryResource &_upstream)
+    : upstream(_upstream) { }
+PoolMemoryResource::PoolMemoryResource(MemoryResource &_upstream, const ShrinkPolicy &_policy)
+    : upstream(_upstream)
+    , policy(_policy) { }
+PoolMemoryResource::~PoolMemoryResource() {
+    trim_locked(0);
+}
+size_t PoolMemoryResource::getBlockSize(const size_t bytes) {
+    if (bytes <= MIN_BLOCK_SIZE)
+        return MIN_BLOCK_SIZE;
+    // Find the largest power of two <= bytes, each power of two is divided into 4 size classes
+    size_t p = MIN_BLOCK_SIZE;
+    while (p <= bytes / 2)
+        p *= 2;
+    const size_t step = p / 4;
+    if (bytes > std::numeric_limits<size_t>::max() - step)
+        return bytes;
+    return ((bytes + step - 1) / step) * step;
+}
+void *PoolMemoryResource::allocate(const size_t bytes) {
+    if (!bytes) {
+        THROW exception::InvalidArgument("Allocations must be atleast 1 byte, in PoolMemoryResource::allocate()\n");
+    }
+    const size_t block_size = getBlockSize(bytes);
+    std::lock_guard<std::mutex> lock(mutex);
+    void *ptr = nullptr;
+    auto c = cache.find(block_size);
+    if (c != cache.end() && !c->second.empty()) {
+        ptr = c->second.back();
+        c->second.pop_back();
+        stats.bytes_cached -= block_size;
+        ++stats.cache_hits;
+    } else {
+        ptr = upstream.allocate(block_size);
+        if (!ptr && stats.bytes_cached) {
+            // Memory held by the cache may be preventing the allocation, so release it and retry
+            trim_locked(0);
+            ptr = upstream.allocate(block_size);
+        }
+        if (!ptr)
+            return nullptr;
+        ++stats.upstream_allocations;
+    }
+    in_use.emplace(ptr, block_size);
+    stats.bytes_in_use += block_size;
+    stats.peak_bytes_in_use = std::max(stats.peak_bytes_in_use, stats.bytes_in_use);
+    return ptr;
+}
+void PoolMemoryResource::deallocate(void *ptr) {
+    if (!ptr)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = in_use.find(ptr);
+    if (it == in_use.end()) {
+        THROW exception::InvalidArgument("Pointer was not allocated by this pool, or has already been deallocated, "
+            "in PoolMemoryResource::deallocate()\n");
+    }
+    const size_t block_size = it->second;
+    in_use.erase(it);
+    stats.bytes_in_use -= block_size;
+    if (block_size > policy.max_cached_block || block_size > policy.max_cached_bytes) {
+        upstream.deallocate(ptr);
+        ++stats.upstream_deallocations;
+        return;
+    }
+    cache[block_size].push_back(ptr);
+    stats.bytes_cached += block_size;
+    if (stats.bytes_cached > policy.max_cached_bytes)
+        trim_locked(policy.max_cached_bytes);
+}
+void PoolMemoryResource::trim(const size_t max_cached_bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    trim_locked(max_cached_bytes);
+}
+void PoolMemoryResource::trim_locked(const size_t max_cached_bytes) {
+    // Release the largest buffers first, as they are the least likely to be reused
+    auto c = cache.end();
+    while (stats.bytes_cached > max_cached_bytes && c != cache.begin()) {
+        --c;
+        while (!c->second.empty() && stats.bytes_cached > max_cached_bytes) {
+            upstream.deallocate(c->second.back());
+            c->second.pop_back();
+            stats.bytes_cached -= c->first;
+            ++stats.upstream_deallocations;
+        }
+        if (c->second.empty())
+            c = cache.erase(c);
+    }
+}
+void PoolMemoryResource::setShrinkPolicy(const ShrinkPolicy &_policy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = _policy;
+    // Cached blocks which the new policy would not have retained
+    for (auto c = cache.upper_bound(policy.max_cached_block); c != cache.end(); c = cache.erase(c)) {
+        for (void *ptr : c->second) {
+            upstream.deallocate(ptr);
+            stats.bytes_cached -= c->first;
+            ++stats.upstream_deallocations;
+        }
+    }
+    trim_locked(policy.max_cached_bytes);
+}
+PoolMemoryResource::ShrinkPolicy PoolMemoryResource::getShrinkPolicy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return policy;
+}
+PoolMemoryResource::Statistics PoolMemoryResource::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
@@ -0,0 +1,44 @@
+#include "flamegpu/util/detail/Profiler.h"
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+void Profiler::push(const char *category, const std::string &name, const std::string &owner) {
+    stack.emplace_back(path.size(), clock::now());
+    appendSegment(path, category, name, owner);
+}
+void Profiler::pop() {
+    const clock::time_point end = clock::now();
+    if (stack.empty()) {
+        THROW exception::UnknownInternalError("Profiler has no open region to close, in Profiler::pop()\n");
+    }
+    const std::chrono::duration<double> elapsed = end - stack.back().second;
+    profile.add(path, elapsed.count());
+    path.resize(stack.back().first);
+    stack.pop_back();
+}
+std::string Profiler::getPath(const char *category, const std::string &name, const std::string &owner) const {
+    std::string rtn = path;
+    appendSegment(rtn, category, name, owner);
+    return rtn;
+}
+void Profiler::appendSegment(std::string &path, const char *category, const std::string &name, const std::string &owner) {
+    if (!path.empty())
+        path.push_back('/');
+    path.append(category);
+    if (name.empty() && owner.empty())
+        return;
+    path.push_back(':');
+    if (!owner.empty()) {
+        path.append(owner);
+        path.push_back('.');
+    }
+    path.append(name);
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
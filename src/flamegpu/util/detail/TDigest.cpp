@@ -0,0 +1,106 @@
+#include "flamegpu/util/detail/TDigest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+TDigest::TDigest(const double _compression)
+    : compression(_compression > 10 ? _compression : 10)
+    , total_weight(0)
+    , buffer_weight(0)
+    , buffer_capacity(static_cast<size_t>(compression) * 5)
+    , min(std::numeric_limits<double>::infinity())
+    , max(-std::numeric_limits<double>::infinity()) { }
+
+void TDigest::add(const double x, const double w) {
+    if (std::isnan(x) || !(w > 0))
+        return;
+    buffer.push_back({x, w});
+    buffer_weight += w;
+    min = std::min(min, x);
+    max = std::max(max, x);
+    if (buffer.size() >= buffer_capacity)
+        compress();
+}
+void TDigest::merge(const TDigest &other) {
+    for (const Centroid &c : other.getCentroids())
+        add(c.mean, c.weight);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+double TDigest::k(double q) const {
+    q = std::min(std::max(q, 0.0), 1.0);
+    return compression / (2 * 3.14159265358979323846) * std::asin(2 * q - 1);
+}
+void TDigest::compress() const {
+    if (buffer.empty())
+        return;
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::sort(buffer.begin(), buffer.end(), [](const Centroid &a, const Centroid &b) { return a.mean < b.mean; });
+    total_weight += buffer_weight;
+    buffer_weight = 0;
+    centroids.clear();
+    // Greedily merge neighbouring centroids, whilst the merged centroid spans no more than 1 unit of k
+    Centroid current = buffer[0];
+    double weight_so_far = 0;
+    double k_lower = k(0);
+    for (size_t i = 1; i < buffer.size(); ++i) {
+        const double proposed = current.weight + buffer[i].weight;
+        if (k((weight_so_far + proposed) / total_weight) - k_lower <= 1) {
+            current.mean += (buffer[i].mean - current.mean) * buffer[i].weight / proposed;
+            current.weight = proposed;
+        } else {
+            centroids.push_back(current);
+            weight_so_far += current.weight;
+            k_lower = k(weight_so_far / total_weight);
+            current = buffer[i];
+        }
+    }
+    centroids.push_back(current);
+    buffer.clear();
+}
+const std::vector<TDigest::Centroid> &TDigest::getCentroids() const {
+    compress();
+    return centroids;
+}
+double TDigest::quantile(const double q) const {
+    if (!(q >= 0 && q <= 1)) {
+        THROW exception::InvalidArgument("Quantile %g is not within the range [0, 1], in TDigest::quantile()\n", q);
+    }
+    compress();
+    if (centroids.empty())
+        return 0;
+    const double index = q * total_weight;
+    const Centroid &first = centroids.front();
+    const Centroid &last = centroids.back();
+    // Tails, interpolate between the exact min/max and the centre of the outermost centroid
+    if (index < 1)
+        return min;
+    if (index < first.weight / 2)
+        return min + (index - 1) / (first.weight / 2 - 1) * (first.mean - min);
+    if (index > total_weight - 1)
+        return max;
+    if (index > total_weight - last.weight / 2)
+        return max - (total_weight - index - 1) / (last.weight / 2 - 1) * (max - last.mean);
+    // Interpolate between the centres of the neighbouring centroids
+    double cumulative = first.weight / 2;
+    for (size_t i = 0; i + 1 < centroids.size(); ++i) {
+        const double dw = (centroids[i].weight + centroids[i + 1].weight) / 2;
+        if (index < cumulative + dw) {
+            const double z = (index - cumulative) / dw;
+            return centroids[i].mean + z * (centroids[i + 1].mean - centroids[i].mean);
+        }
+        cumulative += dw;
+    }
+    return last.mean;
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
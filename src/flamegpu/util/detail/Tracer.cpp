@@ -0,0 +1,236 @@
+#include "flamegpu/util/detail/Tracer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+namespace {
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+/**
+ * Writes a string to file, escaping characters which are not permitted within a JSON string
+ */
+void writeEscaped(FILE *file, const char *str) {
+    for (; *str; ++str) {
+        const unsigned char c = static_cast<unsigned char>(*str);
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+}
+}  // namespace
+
+std::atomic<bool> Tracer::enabled{false};
+
+void Tracer::Scope::begin(const char *category, const std::string &owner, const std::string &name, int layer, int stream) {
+    event.category = category;
+    size_t len = 0;
+    if (!owner.empty()) {
+        len = std::min(owner.size(), MAX_NAME_LENGTH - 1);
+        memcpy(event.name, owner.c_str(), len);
+        event.name[len++] = '.';
+    }
+    const size_t name_len = std::min(name.size(), MAX_NAME_LENGTH - len);
+    memcpy(event.name + len, name.c_str(), name_len);
+    event.name[len + name_len] = '\0';
+    event.layer = layer;
+    event.stream = stream;
+    event.run = getThreadHandle().run_index;
+    event.begin = now();
+}
+void Tracer::Scope::end() {
+    event.end = now();
+    Tracer::getInstance().getThreadBuffer().push(event);
+}
+
+Tracer::ThreadBuffer::ThreadBuffer(unsigned int _tid, size_t capacity)
+    : mask([capacity]() {
+        // Round up to a power of 2, so that indices can be masked
+        uint64_t c = 1;
+        while (c < capacity)
+            c <<= 1;
+        return c - 1;
+    }())
+    , head(0)
+    , tail(0)
+    , dropped(0)
+    , orphaned(false)
+    , tid(_tid) {
+    events = std::unique_ptr<Event[]>(new Event[mask + 1]);
+}
+void Tracer::ThreadBuffer::push(const Event &e) {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) > mask) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    events[h & mask] = e;
+    head.store(h + 1, std::memory_order_release);
+}
+Tracer::ThreadBufferHandle::~ThreadBufferHandle() {
+    if (buffer)
+        buffer->orphaned.store(true, std::memory_order_release);
+}
+
+Tracer &Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+Tracer::~Tracer() {
+    stop();
+}
+Tracer::ThreadBufferHandle &Tracer::getThreadHandle() {
+    thread_local ThreadBufferHandle handle;
+    return handle;
+}
+Tracer::ThreadBuffer &Tracer::getThreadBuffer() {
+    ThreadBufferHandle &handle = getThreadHandle();
+    if (!handle.buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        handle.buffer = std::make_shared<ThreadBuffer>(next_tid++, buffer_events);
+        handle.buffer->name = handle.name;
+        buffers.push_back(handle.buffer);
+    }
+    return *handle.buffer;
+}
+void Tracer::setThreadName(const std::string &name) {
+    ThreadBufferHandle &handle = getThreadHandle();
+    handle.name = name;
+    if (handle.buffer) {
+        std::lock_guard<std::mutex> lock(getInstance().buffers_mutex);
+        handle.buffer->name = name;
+    }
+}
+void Tracer::setRunIndex(int run_index) {
+    getThreadHandle().run_index = run_index;
+}
+
+bool Tracer::start(const std::string &path, unsigned int flush_interval_ms, size_t _buffer_events) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    if (file)
+        return false;
+    file = fopen(path.c_str(), "w");
+    if (!file) {
+        THROW exception::InvalidFilePath("Unable to open trace file '%s' for writing, in Tracer::start()\n", path.c_str());
+    }
+    {
+        std::lock_guard<std::mutex> buffers_lock(buffers_mutex);
+        buffer_events = std::max<size_t>(_buffer_events, 1);
+        // Discard anything recorded after the previous session was stopped
+        for (auto &b : buffers) {
+            b->tail.store(b->head.load(std::memory_order_acquire), std::memory_order_release);
+            b->dropped.store(0, std::memory_order_relaxed);
+            b->written_name.clear();
+        }
+    }
+    epoch = now();
+    dropped = 0;
+    fputs("[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"FLAMEGPU\"}}", file);
+    enabled.store(true, std::memory_order_relaxed);
+    if (flush_interval_ms) {
+        writer_stop = false;
+        writer = std::thread(&Tracer::writerLoop, this, flush_interval_ms);
+    }
+    return true;
+}
+uint64_t Tracer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        if (!file)
+            return 0;
+        enabled.store(false, std::memory_order_relaxed);
+        writer_stop = true;
+    }
+    writer_cv.notify_all();
+    if (writer.joinable())
+        writer.join();
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    drain();
+    fputs("\n]\n", file);
+    fclose(file);
+    file = nullptr;
+    if (dropped) {
+        fprintf(stderr, "Warning: %llu trace events were dropped as a thread's trace buffer was full, "
+            "increase the buffer size or enable periodic flushing, in Tracer::stop()\n", static_cast<unsigned long long>(dropped));
+    }
+    return dropped;
+}
+bool Tracer::isActive() const {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return file != nullptr;
+}
+
+void Tracer::drain() {
+    std::vector<std::pair<std::shared_ptr<ThreadBuffer>, std::string>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        snapshot.reserve(buffers.size());
+        for (auto &b : buffers)
+            snapshot.emplace_back(b, b->name);
+    }
+    for (auto &s : snapshot) {
+        ThreadBuffer &b = *s.first;
+        if (!s.second.empty() && s.second != b.written_name) {
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"", b.tid);
+            writeEscaped(file, s.second.c_str());
+            fputs("\"}}", file);
+            b.written_name = s.second;
+        }
+        const uint64_t h = b.head.load(std::memory_order_acquire);
+        for (uint64_t t = b.tail.load(std::memory_order_relaxed); t < h; ++t) {
+            const Event &e = b.events[t & b.mask];
+            // Skip regions which began before the session was started
+            if (e.begin < epoch)
+                continue;
+            fputs(",\n{\"name\":\"", file);
+            writeEscaped(file, e.name[0] ? e.name : e.category);
+            fprintf(file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+                e.category, b.tid, (e.begin - epoch) / 1000.0, (e.end - e.begin) / 1000.0);
+            const char *sep = "";
+            if (e.run >= 0) {
+                fprintf(file, "\"run\":%d", e.run);
+                sep = ",";
+            }
+            if (e.layer >= 0) {
+                fprintf(file, "%s\"layer\":%d", sep, e.layer);
+                sep = ",";
+            }
+            if (e.stream >= 0) {
+                fprintf(file, "%s\"stream\":%d", sep, e.stream);
+            }
+            fputs("}}", file);
+        }
+        b.tail.store(h, std::memory_order_release);
+        dropped += b.dropped.exchange(0, std::memory_order_relaxed);
+    }
+    // Release the buffers of threads which have exited, once they have been emptied
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const std::shared_ptr<ThreadBuffer> &b) {
+        return b->orphaned.load(std::memory_order_acquire) && b->head.load(std::memory_order_acquire) == b->tail.load(std::memory_order_relaxed);
+    }), buffers.end());
+}
+void Tracer::writerLoop(unsigned int flush_interval_ms) {
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    while (!writer_stop) {
+        writer_cv.wait_for(lock, std::chrono::milliseconds(flush_interval_ms), [this]() { return writer_stop; });
+        if (!writer_stop) {
+            drain();
+            fflush(file);
+        }
+    }
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
@@ -0,0 +1,138 @@
+#include "flamegpu/util/detail/WorkStealingThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flamegpu {
+namespace util {
+namespace detail {
+
+WorkStealingThreadPool::WorkStealingThreadPool(unsigned int thread_count)
+    : pending(0)
+    , stop(false) {
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    // The calling thread also executes work, so one fewer worker is required
+    for (unsigned int i = 1; i < thread_count; ++i) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (size_t i = 0; i < queues.size(); ++i) {
+        workers.emplace_back(&WorkStealingThreadPool::workerLoop, this, i);
+    }
+}
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stop = true;
+    }
+    wake_cv.notify_all();
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+void WorkStealingThreadPool::parallelFor(size_t begin, size_t end, size_t grain, const RangeFunction &fn) {
+    if (end <= begin)
+        return;
+    const size_t count = end - begin;
+    if (grain == 0) {
+        grain = std::max<size_t>(count / (4 * getThreadCount()), 1);
+    }
+    // Nothing to distribute, avoid the overhead of the queues
+    if (queues.empty() || count <= grain) {
+        fn(begin, end);
+        return;
+    }
+    const size_t chunks = (count + grain - 1) / grain;
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = chunks;
+    // Count the chunks before they are published, so a worker which takes one can never decrement pending below zero
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        pending += chunks;
+    }
+    // Distribute chunks round robin across the worker queues
+    for (size_t c = 0; c < chunks; ++c) {
+        const size_t chunk_begin = begin + c * grain;
+        const size_t chunk_end = std::min(chunk_begin + grain, end);
+        Task t = [batch, &fn, chunk_begin, chunk_end]() {
+            try {
+                fn(chunk_begin, chunk_end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                if (!batch->exception)
+                    batch->exception = std::current_exception();
+            }
+            if (--batch->remaining == 0) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->cv.notify_all();
+            }
+        };
+        WorkQueue &q = *queues[c % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(std::move(t));
+    }
+    wake_cv.notify_all();
+    // The calling thread helps out, until there is nothing left to steal
+    Task task;
+    while (batch->remaining > 0 && steal(queues.size(), task)) {
+        task();
+        task = nullptr;
+    }
+    // Wait for chunks still executing on other threads
+    {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->cv.wait(lock, [&batch]() { return batch->remaining == 0; });
+    }
+    if (batch->exception) {
+        std::rethrow_exception(batch->exception);
+    }
+}
+
+bool WorkStealingThreadPool::popLocal(size_t queue_index, Task &task) {
+    WorkQueue &q = *queues[queue_index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty())
+        return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    --pending;
+    return true;
+}
+bool WorkStealingThreadPool::steal(size_t thief_index, Task &task) {
+    // Start at the thief's neighbour, so thieves don't all converge on queue 0
+    for (size_t i = 1; i <= queues.size(); ++i) {
+        const size_t victim = (thief_index + i) % queues.size();
+        if (victim == thief_index)
+            continue;
+        WorkQueue &q = *queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty())
+            continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        --pending;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::workerLoop(size_t queue_index) {
+    Task task;
+    while (true) {
+        if (popLocal(queue_index, task) || steal(queue_index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake_cv.wait(lock, [this]() { return stop || pending > 0; });
+        if (stop && pending == 0)
+            return;
+    }
+}
+
+}  // namespace detail
+}  // namespace util
+}  // namespace flamegpu
@@ -338,6 +338,8 @@ class FLAMEGPURuntimeException : public std::exception {
 %ignore flamegpu::AgentVector::getVariableType;
 %ignore flamegpu::AgentVector::getVariableMetaData;
 %ignore flamegpu::AgentVector::data;
+%ignore flamegpu::AgentVector::column;  // Replaced by getVariableView()
+%ignore flamegpu::AgentVector::py_shareData;  // Used by getVariableView()
 
 %ignore flamegpu::VarOffsetStruct; // not required but defined in HostNewAgentAPI
 
@@ -361,12 +363,20 @@ class FLAMEGPURuntimeException : public std::exception {
 %ignore flamegpu::DeviceAgentVector_impl::getVariableType;
 %ignore flamegpu::DeviceAgentVector_impl::getVariableMetaData;
 %ignore flamegpu::DeviceAgentVector_impl::data;
+%ignore flamegpu::DeviceAgentVector_impl::column;  // Replaced by getVariableView()
+%ignore flamegpu::DeviceAgentVector_impl::py_shareData;  // Used by getVariableView()
+
+// HostAgentAPI::newAgents returns a batch whose typed column views are not currently wrapped
+%ignore flamegpu::HostAgentAPI::newAgents;
 
 %ignore flamegpu::HostRandom::uniform;
 
 // RunPlanVector::SetPropertyRandom takes a c++ std::distribution as an argument, so not appropriate for wrapping.
 %ignore flamegpu::RunPlanVector::setPropertyRandom;
 
+// CUDAEnsemble::setScheduler takes a shared_ptr to a polymorphic scheduler, which may hold a c++ std::function, so is not wrapped. Python ensembles use the default scheduler.
+%ignore flamegpu::CUDAEnsemble::setScheduler;
+
 // Ignore const'd accessors for configuration structs, which were mutable in python.
 %ignore flamegpu::CUDASimulation::getCUDAConfig;
 %ignore flamegpu::CUDAEnsemble::getConfig;
@@ -479,6 +489,8 @@ class ModelVis;
 
 %include "flamegpu/runtime/HostFunctionCallback.h"
 
+%include "flamegpu/runtime/messaging/MessageSortingType.h"  // Provides SpatialSortOrder, used by AgentDescription
+
 %feature("flatnested");     // flat nested on
 %include "flamegpu/runtime/messaging/MessageNone.h"
 %include "flamegpu/runtime/messaging/MessageNone/MessageNoneHost.h"
@@ -513,6 +525,10 @@ class ModelVis;
 
 %include "flamegpu/runtime/utility/RandomManager.cuh"
 
+// Include the profile returned by RunLog and CUDAEnsemble
+%include "flamegpu/sim/Profile.h"
+%template(ProfileRegionMap) std::map<std::string, flamegpu::ProfileRegion>;
+
 // Include Simulation and CUDASimulation
 %feature("flatnested");     // flat nested on to ensure Config is included
 %include "flamegpu/sim/Simulation.h"
@@ -537,6 +553,10 @@ class ModelVis;
 %include "flamegpu/runtime/utility/HostRandom.cuh"
 
 %nodefaultctor flamegpu::HostMacroProperty_swig;
+// Transfer internals of HostMacroProperty, not required by Python
+%ignore flamegpu::HostMacroProperty_Backend;
+%ignore flamegpu::HostMacroProperty_CUDABackend;
+%ignore flamegpu::HostMacroProperty_MetaData;
 %include "flamegpu/runtime/utility/HostMacroProperty.cuh"
 %include "flamegpu/runtime/utility/HostEnvironment.cuh"
 
@@ -552,8 +572,160 @@ class ModelVis;
 
 // Include ensemble implementations
 %include "flamegpu/sim/RunPlan.h"
+%include "flamegpu/sim/SampleSpace.h"
 %include "flamegpu/sim/RunPlanVector.h"
 
+// Helpers for exposing contiguous C++ buffers to python via the buffer protocol (e.g. memoryview, numpy.asarray())
+%{
+namespace flamegpu {
+namespace detail {
+/**
+ * Returns the python struct format character matching T
+ */
+template<typename T>
+const char *bufferFormat() {
+    if (std::is_floating_point<T>::value)
+        return sizeof(T) == sizeof(float) ? "f" : "d";
+    switch (sizeof(T)) {
+        case 1: return std::is_signed<T>::value ? "b" : "B";
+        case 2: return std::is_signed<T>::value ? "h" : "H";
+        case 4: return std::is_signed<T>::value ? "i" : "I";
+        default: return std::is_signed<T>::value ? "q" : "Q";
+    }
+}
+/**
+ * Casts a flat byte memoryview to T, with shape (rows) or (rows, elements) for array values
+ * Steals the reference to bytes
+ */
+template<typename T>
+PyObject *castBufferView(PyObject *bytes, const size_t rows, const unsigned int elements) {
+    if (!bytes)
+        return nullptr;
+    PyObject *rtn = nullptr;
+    if (rows && elements > 1) {
+        PyObject *shape = Py_BuildValue("(nn)", static_cast<Py_ssize_t>(rows), static_cast<Py_ssize_t>(elements));
+        rtn = shape ? PyObject_CallMethod(bytes, "cast", "sO", bufferFormat<T>(), shape) : nullptr;
+        Py_XDECREF(shape);
+    } else {
+        rtn = PyObject_CallMethod(bytes, "cast", "s", bufferFormat<T>());
+    }
+    Py_DECREF(bytes);
+    return rtn;
+}
+/**
+ * Python object which exports a C++ buffer via the buffer protocol, whilst sharing ownership of the allocation holding it
+ * It is the base object of the memoryviews returned by wrapBufferView(), so the buffer remains valid for as long as any view (or array) of it
+ */
+struct SharedBuffer {
+    PyObject_HEAD
+    std::shared_ptr<const void> *owner;
+    void *ptr;
+    Py_ssize_t len;
+    int readonly;
+};
+void SharedBuffer_dealloc(PyObject *self) {
+    delete reinterpret_cast<SharedBuffer*>(self)->owner;
+    Py_TYPE(self)->tp_free(self);
+}
+int SharedBuffer_getbuffer(PyObject *self, Py_buffer *view, int flags) {
+    const SharedBuffer *buffer = reinterpret_cast<SharedBuffer*>(self);
+    return PyBuffer_FillInfo(view, self, buffer->ptr, buffer->len, buffer->readonly, flags);
+}
+/**
+ * Returns the SharedBuffer python type, readying it on first use
+ */
+PyTypeObject *sharedBufferType() {
+    static PyBufferProcs procs = { SharedBuffer_getbuffer, nullptr };
+    static PyTypeObject type = { PyVarObject_HEAD_INIT(nullptr, 0) };
+    static bool ready = false;
+    if (!ready) {
+        type.tp_name = "pyflamegpu.SharedBuffer";
+        type.tp_basicsize = sizeof(SharedBuffer);
+        type.tp_dealloc = SharedBuffer_dealloc;
+        type.tp_as_buffer = &procs;
+        type.tp_flags = Py_TPFLAGS_DEFAULT;
+        type.tp_doc = "Buffer shared with a FLAMEGPU agent vector";
+        if (PyType_Ready(&type) < 0)
+            return nullptr;
+        ready = true;
+    }
+    return &type;
+}
+/**
+ * Returns a memoryview of T which wraps ptr without copying
+ * The view shares ownership of the allocation holding ptr, so remains valid after the vector it was taken from is deleted or reallocated
+ * @param owner The allocation holding ptr
+ * @param ptr The buffer to wrap
+ * @param rows The number of values (or arrays of values) in the buffer
+ * @param elements The number of values in each row
+ * @param writable If false, the view is read only
+ */
+template<typename T>
+PyObject *wrapBufferView(std::shared_ptr<const void> owner, T *ptr, const size_t rows, const unsigned int elements, const bool writable) {
+    // memoryview does not accept a null pointer, even for an empty view
+    static char empty = 0;
+    PyTypeObject *type = sharedBufferType();
+    if (!type)
+        return nullptr;
+    SharedBuffer *buffer = PyObject_New(SharedBuffer, type);
+    if (!buffer)
+        return nullptr;
+    buffer->owner = new std::shared_ptr<const void>(std::move(owner));
+    buffer->ptr = ptr ? static_cast<void*>(ptr) : static_cast<void*>(&empty);
+    buffer->len = static_cast<Py_ssize_t>(rows * elements * sizeof(T));
+    buffer->readonly = writable ? 0 : 1;
+    PyObject *bytes = PyMemoryView_FromObject(reinterpret_cast<PyObject*>(buffer));
+    Py_DECREF(buffer);  // The memoryview holds a reference to the SharedBuffer
+    return castBufferView<T>(bytes, rows, elements);
+}
+/**
+ * Returns a memoryview of T, over a new python owned buffer holding one row per step log frame
+ * @param steps The step log to gather values from
+ * @param elements The number of values in each row
+ * @param fn Callable with signature void(const StepLogFrame&, T*), which writes the row of values for a frame
+ */
+template<typename T, typename Fn>
+PyObject *gatherStepLogSeries(const std::list<StepLogFrame> &steps, const unsigned int elements, Fn fn) {
+    std::vector<T> values(steps.size() * elements);
+    size_t i = 0;
+    for (const auto &step : steps) {
+        fn(step, values.data() + i);
+        i += elements;
+    }
+    PyObject *buffer = PyByteArray_FromStringAndSize(reinterpret_cast<const char*>(values.data()), static_cast<Py_ssize_t>(values.size() * sizeof(T)));
+    if (!buffer)
+        return nullptr;
+    PyObject *bytes = PyMemoryView_FromObject(buffer);
+    Py_DECREF(buffer);  // The memoryview holds a reference to the bytearray
+    return castBufferView<T>(bytes, steps.size(), elements);
+}
+/**
+ * Returns the number of elements of an environment property within a step log, checking it's type
+ * @throws exception::InvalidEnvProperty If the property was not logged
+ * @throws exception::InvalidEnvPropertyType If the property is not of type T
+ */
+template<typename T>
+unsigned int stepLogPropertyElements(const std::list<StepLogFrame> &steps, const std::string &property_name) {
+    if (steps.empty())
+        return 1;
+    const auto &env = steps.front().getEnvironment();
+    const auto it = env.find(property_name);
+    if (it == env.end()) {
+        THROW exception::InvalidEnvProperty("Environment property '%s' was not found in the log, "
+            "in RunLog::getStepEnvironmentPropertySeries()\n",
+            property_name.c_str());
+    }
+    if (it->second.type != std::type_index(typeid(T))) {
+        THROW exception::InvalidEnvPropertyType("Environment property '%s' has type %s, but requested type %s, "
+            "in RunLog::getStepEnvironmentPropertySeries()\n",
+            property_name.c_str(), it->second.type.name(), std::type_index(typeid(T)).name());
+    }
+    return it->second.elements;
+}
+}  // namespace detail
+}  // namespace flamegpu
+%}
+
 // %extend classes go after %includes, but before tempalates (that use them)
 // -----------------
 
@@ -580,6 +752,34 @@ class ModelVis;
     void flamegpu::AgentVector::__setitem__(const flamegpu::AgentVector::size_type &index, const flamegpu::AgentVector::Agent &value) {
         $self->operator[](index).setData(value);
     }
+    /**
+     * Returns a writable memoryview of the named variable of every agent, which shares memory with the vector
+     * The whole variable is marked as changed, so only request a writable view of variables which are to be updated
+     * The view keeps the memory alive, but no longer shares it with the vector once the vector is deleted, or reallocated by growing it
+     */
+    template<typename T> PyObject *getVariableView(const std::string &variable_name) {
+        auto column = $self->column<T>(variable_name);
+        return flamegpu::detail::wrapBufferView<T>($self->py_shareData(), column.data(0, column.size()), column.getAgentCount(), column.getElements(), true);
+    }
+    /**
+     * Returns a writable memoryview of the named variable of the agents [first, last), only this range is marked as changed
+     */
+    template<typename T> PyObject *getVariableViewRange(const std::string &variable_name, const flamegpu::AgentVector::size_type &first, const flamegpu::AgentVector::size_type &last) {
+        auto column = $self->column<T>(variable_name);
+        const unsigned int elements = column.getElements();
+        if (first > last) {
+            THROW flamegpu::exception::InvalidArgument("first (%u) must not exceed last (%u), "
+                "in AgentVector::getVariableViewRange()\n", first, last);
+        }
+        return flamegpu::detail::wrapBufferView<T>($self->py_shareData(), column.data(first * elements, last * elements), last - first, elements, true);
+    }
+    /**
+     * Returns a read only memoryview of the named variable of every agent, which does not mark the variable as changed
+     */
+    template<typename T> PyObject *getVariableViewReadOnly(const std::string &variable_name) const {
+        auto column = static_cast<const flamegpu::AgentVector*>($self)->column<T>(variable_name);
+        return flamegpu::detail::wrapBufferView<T>($self->py_shareData(), const_cast<T*>(column.data()), column.getAgentCount(), column.getElements(), false);
+    }
 }
 /* Extend HostRandom to add a templated version of the uniform function with a different name so this can be instantiated 
  * It is required to ingore the original defintion of uniform and separate the two functions to have a distinct name
@@ -633,6 +833,89 @@ class ModelVis;
     void flamegpu::DeviceAgentVector_impl::__setitem__(const size_type &index, const Agent &value) {
         $self->operator[](index).setData(value);
     }
+    /**
+     * Returns a writable memoryview of the named variable of every agent, which shares memory with the vector
+     * The whole variable is marked as changed, so only request a writable view of variables which are to be updated
+     * The view keeps the memory alive, but no longer shares it with the vector once the vector is deleted, or reallocated by growing it
+     */
+    template<typename T> PyObject *getVariableView(const std::string &variable_name) {
+        auto column = $self->column<T>(variable_name);
+        return flamegpu::detail::wrapBufferView<T>($self->py_shareData(), column.data(0, column.size()), column.getAgentCount(), column.getElements(), true);
+    }
+    /**
+     * Returns a writable memoryview of the named variable of the agents [first, last), only this range is marked as changed
+     */
+    template<typename T> PyObject *getVariableViewRange(const std::string &variable_name, const flamegpu::AgentVector::size_type &first, const flamegpu::AgentVector::size_type &last) {
+        auto column = $self->column<T>(variable_name);
+        const unsigned int elements = column.getElements();
+        if (first > last) {
+            THROW flamegpu::exception::InvalidArgument("first (%u) must not exceed last (%u), "
+                "in DeviceAgentVector::getVariableViewRange()\n", first, last);
+        }
+        return flamegpu::detail::wrapBufferView<T>($self->py_shareData(), column.data(first * elements, last * elements), last - first, elements, true);
+    }
+    /**
+     * Returns a read only memoryview of the named variable of every agent, which does not mark the variable as changed
+     */
+    template<typename T> PyObject *getVariableViewReadOnly(const std::string &variable_name) const {
+        auto column = static_cast<const flamegpu::DeviceAgentVector_impl*>($self)->column<T>(variable_name);
+        return flamegpu::detail::wrapBufferView<T>($self->py_shareData(), const_cast<T*>(column.data()), column.getAgentCount(), column.getElements(), false);
+    }
+}
+
+// Extend RunLog to return each logged value across the step log as a single python buffer (e.g. for numpy.asarray())
+%extend flamegpu::RunLog {
+    PyObject *getStepCountSeries() const {
+        return flamegpu::detail::gatherStepLogSeries<unsigned int>($self->getStepLog(), 1, [](const flamegpu::StepLogFrame &step, unsigned int *out) {
+            *out = step.getStepCount();
+        });
+    }
+    PyObject *getStepTimeSeries() const {
+        return flamegpu::detail::gatherStepLogSeries<double>($self->getStepLog(), 1, [](const flamegpu::StepLogFrame &step, double *out) {
+            *out = step.getStepTime();
+        });
+    }
+    /**
+     * Array properties return a 2D view, of shape (steps, elements)
+     */
+    template<typename T> PyObject *getStepEnvironmentPropertySeries(const std::string &property_name) const {
+        const unsigned int elements = flamegpu::detail::stepLogPropertyElements<T>($self->getStepLog(), property_name);
+        return flamegpu::detail::gatherStepLogSeries<T>($self->getStepLog(), elements, [&property_name](const flamegpu::StepLogFrame &step, T *out) {
+            const auto &p = step.getEnvironment().at(property_name);
+            memcpy(out, p.ptr, p.length);
+        });
+    }
+    PyObject *getStepAgentCountSeries(const std::string &agent_name, const std::string &state_name = flamegpu::ModelData::DEFAULT_STATE) const {
+        return flamegpu::detail::gatherStepLogSeries<unsigned int>($self->getStepLog(), 1, [&](const flamegpu::StepLogFrame &step, unsigned int *out) {
+            *out = step.getAgent(agent_name, state_name).getCount();
+        });
+    }
+    PyObject *getStepAgentMeanSeries(const std::string &agent_name, const std::string &variable_name, const std::string &state_name = flamegpu::ModelData::DEFAULT_STATE) const {
+        return flamegpu::detail::gatherStepLogSeries<double>($self->getStepLog(), 1, [&](const flamegpu::StepLogFrame &step, double *out) {
+            *out = step.getAgent(agent_name, state_name).getMean(variable_name);
+        });
+    }
+    PyObject *getStepAgentStandardDevSeries(const std::string &agent_name, const std::string &variable_name, const std::string &state_name = flamegpu::ModelData::DEFAULT_STATE) const {
+        return flamegpu::detail::gatherStepLogSeries<double>($self->getStepLog(), 1, [&](const flamegpu::StepLogFrame &step, double *out) {
+            *out = step.getAgent(agent_name, state_name).getStandardDev(variable_name);
+        });
+    }
+    template<typename T> PyObject *getStepAgentMinSeries(const std::string &agent_name, const std::string &variable_name, const std::string &state_name = flamegpu::ModelData::DEFAULT_STATE) const {
+        return flamegpu::detail::gatherStepLogSeries<T>($self->getStepLog(), 1, [&](const flamegpu::StepLogFrame &step, T *out) {
+            *out = step.getAgent(agent_name, state_name).getMin<T>(variable_name);
+        });
+    }
+    template<typename T> PyObject *getStepAgentMaxSeries(const std::string &agent_name, const std::string &variable_name, const std::string &state_name = flamegpu::ModelData::DEFAULT_STATE) const {
+        return flamegpu::detail::gatherStepLogSeries<T>($self->getStepLog(), 1, [&](const flamegpu::StepLogFrame &step, T *out) {
+            *out = step.getAgent(agent_name, state_name).getMax<T>(variable_name);
+        });
+    }
+    template<typename T> PyObject *getStepAgentSumSeries(const std::string &agent_name, const std::string &variable_name, const std::string &state_name = flamegpu::ModelData::DEFAULT_STATE) const {
+        typedef typename flamegpu::sum_input_t<T>::result_t OutT;
+        return flamegpu::detail::gatherStepLogSeries<OutT>($self->getStepLog(), 1, [&](const flamegpu::StepLogFrame &step, OutT *out) {
+            *out = step.getAgent(agent_name, state_name).getSum<T>(variable_name);
+        });
+    }
 }
 
 // Template expansions. Go after the %include and %extension
@@ -659,6 +942,14 @@ TEMPLATE_VARIABLE_INSTANTIATE_ID(setVariableArray, flamegpu::AgentInstance::setV
 TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariable, flamegpu::AgentInstance::getVariable)
 TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableArray, flamegpu::AgentInstance::getVariableArray)
 
+// Instantiate template versions of AgentVector/DeviceAgentVector buffer views
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableView, flamegpu::AgentVector::getVariableView)
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableViewRange, flamegpu::AgentVector::getVariableViewRange)
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableViewReadOnly, flamegpu::AgentVector::getVariableViewReadOnly)
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableView, flamegpu::DeviceAgentVector_impl::getVariableView)
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableViewRange, flamegpu::DeviceAgentVector_impl::getVariableViewRange)
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getVariableViewReadOnly, flamegpu::DeviceAgentVector_impl::getVariableViewReadOnly)
+
 // Instantiate template versions of host agent instance functions from the API
 // Not currently supported: custom reductions, transformations or histograms
 TEMPLATE_VARIABLE_INSTANTIATE(sort, flamegpu::HostAgentAPI::sort)
@@ -777,12 +1068,19 @@ TEMPLATE_VARIABLE_INSTANTIATE(setPropertyUniformRandom, flamegpu::RunPlanVector:
 TEMPLATE_VARIABLE_INSTANTIATE_FLOATS(setPropertyNormalRandom, flamegpu::RunPlanVector::setPropertyNormalRandom)
 TEMPLATE_VARIABLE_INSTANTIATE_FLOATS(setPropertyLogNormalRandom, flamegpu::RunPlanVector::setPropertyLogNormalRandom)
 
+// Instantiate template versions of SampleSpace functions from the API
+TEMPLATE_VARIABLE_INSTANTIATE(addProperty, flamegpu::SampleSpace::addProperty)
+
 // Instantiate template versions of AgentLoggingConfig functions from the API
 TEMPLATE_VARIABLE_INSTANTIATE(logMean, flamegpu::AgentLoggingConfig::logMean)
 TEMPLATE_VARIABLE_INSTANTIATE(logMin, flamegpu::AgentLoggingConfig::logMin)
 TEMPLATE_VARIABLE_INSTANTIATE(logMax, flamegpu::AgentLoggingConfig::logMax)
 TEMPLATE_VARIABLE_INSTANTIATE(logStandardDev, flamegpu::AgentLoggingConfig::logStandardDev)
 TEMPLATE_VARIABLE_INSTANTIATE(logSum, flamegpu::AgentLoggingConfig::logSum)
+TEMPLATE_VARIABLE_INSTANTIATE(logQuantiles, flamegpu::AgentLoggingConfig::logQuantiles)
+TEMPLATE_VARIABLE_INSTANTIATE(logHistogram, flamegpu::AgentLoggingConfig::logHistogram)
+// Covariance is only instantiated for pairs of variables of the same type
+TEMPLATE_VARIABLE_INSTANTIATE(logCovariance, flamegpu::AgentLoggingConfig::logCovariance)
 
 // Instantiate template versions of LogFrame functions from the API
 TEMPLATE_VARIABLE_INSTANTIATE_ID(getEnvironmentProperty, flamegpu::LogFrame::getEnvironmentProperty)
@@ -793,6 +1091,12 @@ TEMPLATE_VARIABLE_INSTANTIATE(getMin, flamegpu::AgentLogFrame::getMin)
 TEMPLATE_VARIABLE_INSTANTIATE(getMax, flamegpu::AgentLogFrame::getMax)
 TEMPLATE_VARIABLE_INSTANTIATE(getSum, flamegpu::AgentLogFrame::getSum)
 
+// Instantiate template versions of RunLog step log series functions
+TEMPLATE_VARIABLE_INSTANTIATE_ID(getStepEnvironmentPropertySeries, flamegpu::RunLog::getStepEnvironmentPropertySeries)
+TEMPLATE_VARIABLE_INSTANTIATE(getStepAgentMinSeries, flamegpu::RunLog::getStepAgentMinSeries)
+TEMPLATE_VARIABLE_INSTANTIATE(getStepAgentMaxSeries, flamegpu::RunLog::getStepAgentMaxSeries)
+TEMPLATE_VARIABLE_INSTANTIATE(getStepAgentSumSeries, flamegpu::RunLog::getStepAgentSumSeries)
+
 // Instantiate template versions of new and get message types from the API
 %template(newMessageBruteForce) flamegpu::ModelDescription::newMessage<flamegpu::MessageBruteForce>;
 %template(newMessageSpatial2D) flamegpu::ModelDescription::newMessage<flamegpu::MessageSpatial2D>;
@@ -333,6 +333,76 @@ class LoggingTest(TestCase):
         assert u_a[2] == 5 + step_index
         assert u_a[3] == 6 + step_index    
 
+    def test_StepLogSeries(self):
+        """
+           Ensure step log series buffers match the individual step log frames
+        """
+        # Define model
+        m = pyflamegpu.ModelDescription(MODEL_NAME)
+        a = m.newAgent(AGENT_NAME1)
+        a.newVariableFloat("float_var");
+        a.newVariableInt("int_var");
+        a.newVariableUInt("uint_var");
+        f1 = a.newRTCFunction(FUNCTION_NAME1, self.agent_fn1);
+        m.newLayer().addAgentFunction(f1);
+        sf1 = step_fn1();
+        m.addStepFunctionCallback(sf1);
+        m.Environment().newPropertyFloat("float_prop", 1.0);
+        m.Environment().newPropertyInt("int_prop", 1);
+        m.Environment().newPropertyUInt("uint_prop", 1);
+        m.Environment().newPropertyArrayFloat("float_prop_array", 2, [1.0, 2.0]);
+        m.Environment().newPropertyArrayInt("int_prop_array", 3, [2, 3, 4]);
+        m.Environment().newPropertyArrayUInt("uint_prop_array", 4, [3, 4, 5, 6]);
+
+        # Define logging configs
+        lcfg = pyflamegpu.LoggingConfig(m);
+        alcfg = lcfg.agent(AGENT_NAME1);
+        alcfg.logCount();
+        self.logAllAgent(alcfg, "float_var", "Float");
+        self.logAllAgent(alcfg, "int_var", "Int");
+        lcfg.logEnvironment("float_prop");
+        lcfg.logEnvironment("int_prop_array");
+        slcfg = pyflamegpu.StepLoggingConfig(lcfg);
+        slcfg.setFrequency(2);
+
+        # Create agent population
+        pop = pyflamegpu.AgentVector(a, 101);
+        for i in range(101):
+            instance = pop[i];
+            instance.setVariableFloat("float_var", i);
+            instance.setVariableInt("int_var", i+1);
+
+        # Run model
+        sim = pyflamegpu.CUDASimulation(m);
+        sim.SimulationConfig().steps = 10;
+        sim.setStepLog(slcfg);
+        sim.setPopulationData(pop);
+        sim.simulate();
+
+        log = sim.getRunLog();
+        steps = log.getStepLog();
+        step_counts = log.getStepCountSeries();
+        assert step_counts.format == "I"
+        assert step_counts.tolist() == [step.getStepCount() for step in steps]
+        assert len(log.getStepTimeSeries()) == steps.size()
+        assert log.getStepEnvironmentPropertySeriesFloat("float_prop").tolist() == [step.getEnvironmentPropertyFloat("float_prop") for step in steps]
+        int_array = log.getStepEnvironmentPropertySeriesInt("int_prop_array");
+        assert int_array.shape == (steps.size(), 3)
+        assert int_array.tolist() == [list(step.getEnvironmentPropertyArrayInt("int_prop_array")) for step in steps]
+        assert log.getStepAgentCountSeries(AGENT_NAME1).tolist() == [101] * steps.size()
+        assert log.getStepAgentMinSeriesFloat(AGENT_NAME1, "float_var").tolist() == [step.getAgent(AGENT_NAME1).getMinFloat("float_var") for step in steps]
+        assert log.getStepAgentMaxSeriesInt(AGENT_NAME1, "int_var").tolist() == [step.getAgent(AGENT_NAME1).getMaxInt("int_var") for step in steps]
+        assert log.getStepAgentSumSeriesInt(AGENT_NAME1, "int_var").tolist() == [step.getAgent(AGENT_NAME1).getSumInt("int_var") for step in steps]
+        assert log.getStepAgentMeanSeries(AGENT_NAME1, "float_var").tolist() == [step.getAgent(AGENT_NAME1).getMean("float_var") for step in steps]
+        assert log.getStepAgentStandardDevSeries(AGENT_NAME1, "float_var").tolist() == [step.getAgent(AGENT_NAME1).getStandardDev("float_var") for step in steps]
+        # Properties which were not logged, or are requested with the wrong type raise
+        with pytest.raises(pyflamegpu.FLAMEGPURuntimeException) as e:
+            log.getStepEnvironmentPropertySeriesFloat("uint_prop")
+        assert e.value.type() == "InvalidEnvProperty"
+        with pytest.raises(pyflamegpu.FLAMEGPURuntimeException) as e:
+            log.getStepEnvironmentPropertySeriesInt("float_prop")
+        assert e.value.type() == "InvalidEnvPropertyType"
+
     def test_CUDAEnsembleSimulate(self):
         """
            Ensure the expected data is logged when CUDAEnsemble::simulate() is called
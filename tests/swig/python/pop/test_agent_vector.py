@@ -1,3 +1,4 @@
+import gc
 import pytest
 from unittest import TestCase
 from pyflamegpu import *
@@ -988,4 +989,89 @@ class AgentVectorTest(TestCase):
         
         assert pop[-len(pop)].getVariableUInt("uint") == pop.front().getVariableUInt("uint")
         assert pop[-1].getVariableUInt("uint")
-      
\ No newline at end of file
+      
+    def test_getVariableView(self):
+        POP_SIZE = 10;
+        # Buffer views share memory with the AgentVector, so writes are visible to both
+        model = pyflamegpu.ModelDescription("model");
+        agent = model.newAgent("agent");
+        agent.newVariableFloat("float", 1.0);
+        agent.newVariableArrayInt("int3", 3, [1, 2, 3]);
+
+        pop = pyflamegpu.AgentVector(agent, POP_SIZE);
+        view = pop.getVariableViewFloat("float");
+        assert view.format == "f"
+        assert view.shape == (POP_SIZE,)
+        assert view.tolist() == [1.0] * POP_SIZE
+        for i in range(POP_SIZE):
+            view[i] = float(i)
+        for i in range(POP_SIZE):
+            assert pop[i].getVariableFloat("float") == float(i)
+        pop[3].setVariableFloat("float", 12.0);
+        assert view[3] == 12.0
+        # Array variables have shape (agents, elements)
+        array_view = pop.getVariableViewInt("int3");
+        assert array_view.shape == (POP_SIZE, 3)
+        array_view[2, 1] = 20
+        assert pop[2].getVariableArrayInt("int3") == (1, 20, 3)
+        # Ranges cover agents [first, last)
+        range_view = pop.getVariableViewRangeInt("int3", 4, 6);
+        assert range_view.shape == (2, 3)
+        range_view[1, 0] = 50
+        assert pop[5].getVariableArrayInt("int3") == (50, 2, 3)
+        # Read only views cannot be written
+        ro_view = pop.getVariableViewReadOnlyFloat("float");
+        assert ro_view.readonly
+        with pytest.raises(TypeError):
+            ro_view[0] = 1.0
+        # Empty vectors return an empty view
+        empty_pop = pyflamegpu.AgentVector(agent);
+        assert len(empty_pop.getVariableViewFloat("float")) == 0
+
+    def test_getVariableView_lifetime(self):
+        POP_SIZE = 10;
+        # Views share ownership of the buffer, so remain valid after the vector is resized or deleted
+        model = pyflamegpu.ModelDescription("model");
+        agent = model.newAgent("agent");
+        agent.newVariableFloat("float", 1.0);
+        pop = pyflamegpu.AgentVector(agent, POP_SIZE);
+        view = pop.getVariableViewFloat("float");
+        ro_view = pop.getVariableViewReadOnlyFloat("float");
+        for i in range(POP_SIZE):
+            view[i] = float(i)
+        # Growing the vector reallocates it, the views keep the old buffer
+        pop.resize(POP_SIZE * 100);
+        assert view.tolist() == [float(i) for i in range(POP_SIZE)]
+        view[0] = 50.0
+        assert ro_view[0] == 50.0
+        # Data is copied to the new buffer, which is no longer shared with the views
+        assert pop[0].getVariableFloat("float") == 0.0
+        assert pop[POP_SIZE - 1].getVariableFloat("float") == float(POP_SIZE - 1)
+        assert pop[POP_SIZE].getVariableFloat("float") == 1.0
+        # Views of the reallocated vector share it's new buffer
+        new_view = pop.getVariableViewFloat("float");
+        assert len(new_view) == POP_SIZE * 100
+        new_view[0] = 25.0
+        assert pop[0].getVariableFloat("float") == 25.0
+        # Deleting the vector does not free the buffers of live views
+        del pop
+        gc.collect()
+        assert new_view[0] == 25.0
+        new_view[1] = 26.0
+        assert new_view.tolist()[:2] == [25.0, 26.0]
+        assert view.tolist()[:2] == [50.0, 1.0]
+
+    def test_getVariableView_exceptions(self):
+        model = pyflamegpu.ModelDescription("model");
+        agent = model.newAgent("agent");
+        agent.newVariableFloat("float");
+        pop = pyflamegpu.AgentVector(agent, 4);
+        with pytest.raises(pyflamegpu.FLAMEGPURuntimeException) as e:
+            pop.getVariableViewFloat("wrong")
+        assert e.value.type() == "InvalidAgentVar"
+        with pytest.raises(pyflamegpu.FLAMEGPURuntimeException) as e:
+            pop.getVariableViewInt("float")
+        assert e.value.type() == "InvalidVarType"
+        with pytest.raises(pyflamegpu.FLAMEGPURuntimeException) as e:
+            pop.getVariableViewRangeFloat("float", 2, 5)
+        assert e.value.type() == "OutOfBoundsException"
@@ -0,0 +1,483 @@
+/**
+ * Tests of CPUReferenceSimulation
+ *
+ * Tests cover:
+ * > agent functions execute once per agent per step, on multiple threads
+ * > agent function conditions, agent death and state transitions
+ * > brute force and spatial 3D messaging
+ * > environment properties and step/exit logging
+ * > host functions and exit conditions
+ * > environment properties are included in exported state
+ * > quantile, histogram and covariance log reductions
+ * > unsupported model features are rejected
+ */
+#include <array>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_cpu_reference_simulation {
+const unsigned int AGENT_COUNT = 1024;
+const char *MODEL_NAME = "Model";
+const char *AGENT_NAME = "Agent";
+const char *MESSAGE_NAME = "Message";
+const char *FUNCTION_NAME = "Function";
+const char *FUNCTION_NAME2 = "Function2";
+const char *STATE1 = "Start";
+const char *STATE2 = "End";
+
+// Device implementations are only required to build the model description
+FLAMEGPU_AGENT_FUNCTION(DeviceNullFn, MessageNone, MessageNone) {
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(DeviceOutFn, MessageNone, MessageBruteForce) {
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(DeviceInFn, MessageBruteForce, MessageNone) {
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(DeviceSpatialOutFn, MessageNone, MessageSpatial3D) {
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(DeviceSpatialInFn, MessageSpatial3D, MessageNone) {
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION_CONDITION(DeviceCondition) {
+    return true;
+}
+FLAMEGPU_INIT_FUNCTION(InitFn) {
+    FLAMEGPU->environment.setProperty<int>("inc", 3);
+}
+FLAMEGPU_HOST_FUNCTION(LayerHostFn) {
+    FLAMEGPU->environment.setProperty<unsigned int>("layer_count", FLAMEGPU->environment.getProperty<unsigned int>("layer_count") + 1);
+}
+FLAMEGPU_STEP_FUNCTION(StepFn) {
+    FLAMEGPU->environment.setProperty<unsigned int>("last_step", FLAMEGPU->getStepCounter());
+}
+FLAMEGPU_EXIT_CONDITION(ExitAfterFourSteps) {
+    return FLAMEGPU->getStepCounter() + 1 >= 4 ? EXIT : CONTINUE;
+}
+FLAMEGPU_EXIT_FUNCTION(ExitFn) {
+    FLAMEGPU->environment.setProperty<float, 2>("random", {FLAMEGPU->random.uniform<float>(), FLAMEGPU->random.uniform<float>()});
+}
+FLAMEGPU_STEP_FUNCTION(HostAgentFn) {
+    FLAMEGPU->agent(AGENT_NAME);
+}
+FLAMEGPU_STEP_FUNCTION(MacroPropertyFn) {
+    FLAMEGPU->environment.getMacroProperty<int>("macro");
+}
+
+FLAMEGPU_CPU_AGENT_FUNCTION(IncrementFn) {
+    FLAMEGPU->setVariable<int>("x", FLAMEGPU->getVariable<int>("x") + FLAMEGPU->environment.getProperty<int>("inc"));
+    return ALIVE;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION(KillOddFn) {
+    return FLAMEGPU->getVariable<int>("x") % 2 ? DEAD : ALIVE;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION_CONDITION(EvenCondition) {
+    return FLAMEGPU->getVariable<int>("x") % 2 == 0;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION(OutFn) {
+    FLAMEGPU->message_out.setVariable<int>("x", FLAMEGPU->getVariable<int>("x"));
+    return ALIVE;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION(InFn) {
+    int sum = 0;
+    for (const auto &message : FLAMEGPU->message_in) {
+        sum += message.getVariable<int>("x");
+    }
+    FLAMEGPU->setVariable<int>("sum", sum);
+    return ALIVE;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION(SpatialOutFn) {
+    FLAMEGPU->message_out.setVariable<float>("x", FLAMEGPU->getVariable<float>("x"));
+    FLAMEGPU->message_out.setVariable<float>("y", FLAMEGPU->getVariable<float>("y"));
+    FLAMEGPU->message_out.setVariable<float>("z", FLAMEGPU->getVariable<float>("z"));
+    return ALIVE;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION(SpatialInFn) {
+    const float x = FLAMEGPU->getVariable<float>("x");
+    const float y = FLAMEGPU->getVariable<float>("y");
+    const float z = FLAMEGPU->getVariable<float>("z");
+    unsigned int count = 0;
+    for (const auto &message : FLAMEGPU->message_in(x, y, z)) {
+        const float dx = message.getVariable<float>("x") - x;
+        const float dy = message.getVariable<float>("y") - y;
+        const float dz = message.getVariable<float>("z") - z;
+        if (dx * dx + dy * dy + dz * dz <= 1.0f)
+            ++count;
+    }
+    FLAMEGPU->setVariable<unsigned int>("count", count);
+    return ALIVE;
+}
+
+TEST(CPUReferenceSimulationTest, AgentFunction) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    m.Environment().newProperty<int>("inc", 2);
+    m.newLayer().addAgentFunction(f);
+    AgentVector pop(a, AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i)
+        pop[i].setVariable<int>("x", static_cast<int>(i));
+    CPUReferenceSimulation s(m);
+    s.CPUConfig().thread_count = 4;
+    s.SimulationConfig().steps = 3;
+    s.applyConfig();
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, IncrementFn);
+    s.setPopulationData(pop);
+    s.simulate();
+    EXPECT_EQ(s.getStepCounter(), 3u);
+    s.getPopulationData(pop);
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        EXPECT_EQ(pop[i].getVariable<int>("x"), static_cast<int>(i) + 6);
+        EXPECT_NE(pop[i].getID(), ID_NOT_SET);
+    }
+}
+TEST(CPUReferenceSimulationTest, MissingHostImplementation) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    m.newLayer().addAgentFunction(f);
+    AgentVector pop(a, AGENT_COUNT);
+    CPUReferenceSimulation s(m);
+    s.setPopulationData(pop);
+    EXPECT_THROW(s.step(), exception::InvalidAgentFunc);
+    EXPECT_THROW(s.setAgentFunction(AGENT_NAME, "missing", IncrementFn), exception::InvalidAgentFunc);
+    EXPECT_THROW(s.setAgentFunctionCondition(AGENT_NAME, FUNCTION_NAME, EvenCondition), exception::InvalidAgentFunc);
+}
+TEST(CPUReferenceSimulationTest, UnsupportedFeatures) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    a.newFunction(FUNCTION_NAME, DeviceNullFn).setAgentOutput(a);
+    EXPECT_THROW(CPUReferenceSimulation s(m), exception::InvalidOperation);
+}
+TEST(CPUReferenceSimulationTest, UnsupportedHostAPIFeatures) {
+    {
+        ModelDescription m(MODEL_NAME);
+        m.newAgent(AGENT_NAME).newVariable<int>("x", 0);
+        m.addStepFunction(HostAgentFn);
+        CPUReferenceSimulation s(m);
+        EXPECT_THROW(s.step(), exception::InvalidOperation);
+    }
+    {
+        ModelDescription m(MODEL_NAME);
+        m.newAgent(AGENT_NAME).newVariable<int>("x", 0);
+        m.Environment().newMacroProperty<int>("macro");
+        m.addStepFunction(MacroPropertyFn);
+        CPUReferenceSimulation s(m);
+        EXPECT_THROW(s.step(), exception::InvalidOperation);
+    }
+}
+TEST(CPUReferenceSimulationTest, HostFunctions) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    m.Environment().newProperty<int>("inc", 1);
+    m.Environment().newProperty<unsigned int>("layer_count", 0);
+    m.Environment().newProperty<unsigned int>("last_step", 0);
+    m.Environment().newProperty<float, 2>("random", {0.0f, 0.0f});
+    m.newLayer().addAgentFunction(f);
+    m.newLayer().addHostFunction(LayerHostFn);
+    m.addInitFunction(InitFn);
+    m.addStepFunction(StepFn);
+    m.addExitCondition(ExitAfterFourSteps);
+    m.addExitFunction(ExitFn);
+    AgentVector pop(a, 10);
+    std::array<float, 2> random_a;
+    for (int run = 0; run < 2; ++run) {
+        CPUReferenceSimulation s(m);
+        s.SimulationConfig().steps = 10;
+        s.SimulationConfig().random_seed = 12;
+        s.applyConfig();
+        s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, IncrementFn);
+        s.setPopulationData(pop);
+        s.simulate();
+        // The exit condition ends the run after 4 of the 10 steps
+        EXPECT_EQ(s.getStepCounter(), 4u);
+        EXPECT_EQ(s.getEnvironmentProperty<unsigned int>("layer_count"), 4u);
+        EXPECT_EQ(s.getEnvironmentProperty<unsigned int>("last_step"), 3u);
+        AgentVector pop_out(a);
+        s.getPopulationData(pop_out);
+        for (const auto &agent : pop_out) {
+            // Agent functions observe the value set by the init function
+            EXPECT_EQ(agent.getVariable<int>("x"), 12);
+        }
+        // Host random is seeded from the simulation's random seed
+        const std::array<float, 2> random = s.getEnvironmentProperty<float, 2>("random");
+        EXPECT_NE(random[0], random[1]);
+        if (run == 0) {
+            random_a = random;
+        } else {
+            EXPECT_EQ(random, random_a);
+        }
+    }
+}
+TEST(CPUReferenceSimulationTest, ConditionDeathAndStateTransition) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    a.newState(STATE1);
+    a.newState(STATE2);
+    // Agents with even x move to STATE2
+    AgentFunctionDescription &f1 = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    f1.setInitialState(STATE1);
+    f1.setEndState(STATE2);
+    f1.setFunctionCondition(DeviceCondition);
+    // The remaining odd agents die
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, DeviceNullFn);
+    f2.setInitialState(STATE1);
+    f2.setEndState(STATE1);
+    f2.setAllowAgentDeath(true);
+    m.newLayer().addAgentFunction(f1);
+    m.newLayer().addAgentFunction(f2);
+    AgentVector pop(a, AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i)
+        pop[i].setVariable<int>("x", static_cast<int>(i));
+    CPUReferenceSimulation s(m);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, [](CPUAgentAPI *) { return ALIVE; });
+    s.setAgentFunctionCondition(AGENT_NAME, FUNCTION_NAME, EvenCondition);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME2, KillOddFn);
+    s.setPopulationData(pop, STATE1);
+    s.step();
+    AgentVector pop_start(a), pop_end(a);
+    s.getPopulationData(pop_start, STATE1);
+    s.getPopulationData(pop_end, STATE2);
+    EXPECT_EQ(pop_start.size(), 0u);
+    ASSERT_EQ(pop_end.size(), AGENT_COUNT / 2);
+    for (unsigned int i = 0; i < pop_end.size(); ++i) {
+        EXPECT_EQ(pop_end[i].getVariable<int>("x"), static_cast<int>(i * 2));
+    }
+}
+TEST(CPUReferenceSimulationTest, BruteForceMessaging) {
+    ModelDescription m(MODEL_NAME);
+    MessageBruteForce::Description &msg = m.newMessage(MESSAGE_NAME);
+    msg.newVariable<int>("x");
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    a.newVariable<int>("sum", 0);
+    AgentFunctionDescription &fo = a.newFunction(FUNCTION_NAME, DeviceOutFn);
+    fo.setMessageOutput(msg);
+    AgentFunctionDescription &fi = a.newFunction(FUNCTION_NAME2, DeviceInFn);
+    fi.setMessageInput(msg);
+    m.newLayer().addAgentFunction(fo);
+    m.newLayer().addAgentFunction(fi);
+    AgentVector pop(a, AGENT_COUNT);
+    int expected = 0;
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        pop[i].setVariable<int>("x", static_cast<int>(i));
+        expected += static_cast<int>(i);
+    }
+    CPUReferenceSimulation s(m);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, OutFn);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME2, InFn);
+    s.setPopulationData(pop);
+    // Second step confirms messages are truncated between steps
+    s.step();
+    s.step();
+    s.getPopulationData(pop);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        EXPECT_EQ(pop[i].getVariable<int>("sum"), expected);
+    }
+}
+TEST(CPUReferenceSimulationTest, Spatial3DMessaging) {
+    const unsigned int GRID = 8;
+    ModelDescription m(MODEL_NAME);
+    MessageSpatial3D::Description &msg = m.newMessage<MessageSpatial3D>(MESSAGE_NAME);
+    msg.setMin(0.0f, 0.0f, 0.0f);
+    msg.setMax(static_cast<float>(GRID), static_cast<float>(GRID), static_cast<float>(GRID));
+    msg.setRadius(1.0f);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<float>("x");
+    a.newVariable<float>("y");
+    a.newVariable<float>("z");
+    a.newVariable<unsigned int>("count", 0);
+    AgentFunctionDescription &fo = a.newFunction(FUNCTION_NAME, DeviceSpatialOutFn);
+    fo.setMessageOutput(msg);
+    AgentFunctionDescription &fi = a.newFunction(FUNCTION_NAME2, DeviceSpatialInFn);
+    fi.setMessageInput(msg);
+    m.newLayer().addAgentFunction(fo);
+    m.newLayer().addAgentFunction(fi);
+    // One agent at the centre of each cell of a regular grid, so each agent has 6 neighbours at distance 1 (plus itself)
+    AgentVector pop(a, GRID * GRID * GRID);
+    for (unsigned int i = 0; i < GRID * GRID * GRID; ++i) {
+        pop[i].setVariable<float>("x", 0.5f + (i % GRID));
+        pop[i].setVariable<float>("y", 0.5f + ((i / GRID) % GRID));
+        pop[i].setVariable<float>("z", 0.5f + (i / (GRID * GRID)));
+    }
+    CPUReferenceSimulation s(m);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, SpatialOutFn);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME2, SpatialInFn);
+    s.setPopulationData(pop);
+    s.step();
+    s.getPopulationData(pop);
+    for (unsigned int i = 0; i < GRID * GRID * GRID; ++i) {
+        const unsigned int x = i % GRID, y = (i / GRID) % GRID, z = i / (GRID * GRID);
+        unsigned int expected = 7;
+        expected -= (x == 0) + (x == GRID - 1) + (y == 0) + (y == GRID - 1) + (z == 0) + (z == GRID - 1);
+        EXPECT_EQ(pop[i].getVariable<unsigned int>("count"), expected);
+    }
+}
+TEST(CPUReferenceSimulationTest, Environment) {
+    ModelDescription m(MODEL_NAME);
+    m.newAgent(AGENT_NAME);
+    m.Environment().newProperty<int>("a", 12);
+    m.Environment().newProperty<float, 3>("b", {1.0f, 2.0f, 3.0f});
+    m.Environment().newProperty<int>("c", 5, true);
+    CPUReferenceSimulation s(m);
+    EXPECT_EQ(s.getEnvironmentProperty<int>("a"), 12);
+    s.setEnvironmentProperty<int>("a", 13);
+    EXPECT_EQ(s.getEnvironmentProperty<int>("a"), 13);
+    const std::array<float, 3> b = {4.0f, 5.0f, 6.0f};
+    s.setEnvironmentProperty<float, 3>("b", b);
+    EXPECT_EQ((s.getEnvironmentProperty<float, 3>("b")), b);
+    EXPECT_THROW(s.getEnvironmentProperty<float>("a"), exception::InvalidEnvPropertyType);
+    EXPECT_THROW(s.getEnvironmentProperty<int>("missing"), exception::InvalidEnvProperty);
+    EXPECT_THROW(s.setEnvironmentProperty<int>("c", 6), exception::ReadOnlyEnvProperty);
+}
+TEST(CPUReferenceSimulationTest, Logging) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    m.Environment().newProperty<int>("inc", 1);
+    m.newLayer().addAgentFunction(f);
+    StepLoggingConfig step_log(m);
+    step_log.agent(AGENT_NAME).logSum<int>("x");
+    step_log.agent(AGENT_NAME).logMean<int>("x");
+    step_log.agent(AGENT_NAME).logMax<int>("x");
+    step_log.logEnvironment("inc");
+    LoggingConfig exit_log(m);
+    exit_log.agent(AGENT_NAME).logMin<int>("x");
+    AgentVector pop(a, 10);
+    for (unsigned int i = 0; i < 10; ++i)
+        pop[i].setVariable<int>("x", static_cast<int>(i));
+    CPUReferenceSimulation s(m);
+    s.SimulationConfig().steps = 2;
+    s.applyConfig();
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, IncrementFn);
+    s.setStepLog(step_log);
+    s.setExitLog(exit_log);
+    s.setPopulationData(pop);
+    s.simulate();
+    const RunLog &log = s.getRunLog();
+    // Init log frame, plus one per step
+    ASSERT_EQ(log.getStepLog().size(), 3u);
+    unsigned int i = 0;
+    for (const StepLogFrame &frame : log.getStepLog()) {
+        EXPECT_EQ(frame.getStepCount(), i);
+        EXPECT_EQ(frame.getEnvironmentProperty<int>("inc"), 1);
+        const AgentLogFrame agent_log = frame.getAgent(AGENT_NAME);
+        EXPECT_EQ(agent_log.getSum<int>("x"), 45 + static_cast<int>(10 * i));
+        EXPECT_DOUBLE_EQ(agent_log.getMean("x"), 4.5 + i);
+        EXPECT_EQ(agent_log.getMax<int>("x"), 9 + static_cast<int>(i));
+        ++i;
+    }
+    EXPECT_EQ(log.getExitLog().getAgent(AGENT_NAME).getMin<int>("x"), 2);
+}
+TEST(CPUReferenceSimulationTest, LoggingStatistics) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    a.newVariable<float>("y", 0);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    m.Environment().newProperty<int>("inc", 1);
+    m.newLayer().addAgentFunction(f);
+    StepLoggingConfig step_log(m);
+    step_log.agent(AGENT_NAME).logQuantiles<int>("x", {0, 0.5, 1});
+    step_log.agent(AGENT_NAME).logHistogram<int>("x", 4, 0, 8);
+    step_log.agent(AGENT_NAME).logCovariance<int, float>("x", "y");
+    AgentVector pop(a, 10);
+    for (unsigned int i = 0; i < 10; ++i) {
+        pop[i].setVariable<int>("x", static_cast<int>(i));
+        pop[i].setVariable<float>("y", 2.0f * i);
+    }
+    CPUReferenceSimulation s(m);
+    s.SimulationConfig().steps = 1;
+    s.applyConfig();
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, IncrementFn);
+    s.setStepLog(step_log);
+    s.setPopulationData(pop);
+    s.simulate();
+    const RunLog &log = s.getRunLog();
+    ASSERT_EQ(log.getStepLog().size(), 2u);
+    unsigned int i = 0;
+    for (const StepLogFrame &frame : log.getStepLog()) {
+        const AgentLogFrame agent_log = frame.getAgent(AGENT_NAME);
+        // x is [i, 9 + i]
+        const std::vector<double> quantiles = agent_log.getQuantiles("x");
+        ASSERT_EQ(quantiles.size(), 3u);
+        EXPECT_DOUBLE_EQ(quantiles[0], i);
+        EXPECT_NEAR(quantiles[1], 4.5 + i, 0.5);
+        EXPECT_DOUBLE_EQ(quantiles[2], 9 + i);
+        const std::vector<unsigned int> histogram = agent_log.getHistogram("x");
+        const std::vector<unsigned int> expected_histogram = i == 0 ? std::vector<unsigned int>{2, 2, 2, 2} : std::vector<unsigned int>{1, 2, 2, 2};
+        EXPECT_EQ(histogram, expected_histogram);
+        // y is not incremented, so cov(x, y) = 2 var(x), the population variance of 10 consecutive integers is 8.25
+        EXPECT_DOUBLE_EQ(agent_log.getCovariance("x", "y"), 16.5);
+        EXPECT_DOUBLE_EQ(agent_log.getCovariance("y", "x"), agent_log.getCovariance("x", "y"));
+        EXPECT_THROW(agent_log.getCovariance("x", "x"), exception::InvalidAgentVar);
+        ++i;
+    }
+}
+TEST(CPUReferenceSimulationTest, LoggingStatisticsExceptions) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    a.newVariable<float, 2>("z");
+    LoggingConfig log(m);
+    AgentLoggingConfig agent_log = log.agent(AGENT_NAME);
+    EXPECT_THROW(agent_log.logQuantiles<int>("x", {}), exception::InvalidArgument);
+    EXPECT_THROW(agent_log.logQuantiles<int>("x", {0.5, 1.5}), exception::InvalidArgument);
+    EXPECT_THROW(agent_log.logQuantiles<float>("x", {0.5}), exception::InvalidVarType);
+    EXPECT_THROW(agent_log.logQuantiles<float>("z", {0.5}), exception::InvalidVarType);
+    EXPECT_NO_THROW(agent_log.logQuantiles<int>("x", {0.5}));
+    EXPECT_THROW(agent_log.logQuantiles<int>("x", {0.25}), exception::InvalidArgument);
+    EXPECT_THROW(agent_log.logHistogram<int>("x", 0, 0, 1), exception::InvalidArgument);
+    EXPECT_THROW(agent_log.logHistogram<int>("x", 2, 1, 1), exception::InvalidArgument);
+    EXPECT_NO_THROW(agent_log.logHistogram<int>("x", 2, 0, 1));
+    EXPECT_THROW(agent_log.logCovariance<int>("x", "missing"), exception::InvalidAgentVar);
+    EXPECT_THROW(agent_log.logCovariance<int>("x", "z"), exception::InvalidVarType);
+    EXPECT_NO_THROW(agent_log.logCovariance<int>("x", "x"));
+    EXPECT_THROW(agent_log.logCovariance<int>("x", "x"), exception::InvalidArgument);
+}
+TEST(CPUReferenceSimulationTest, ExportEnvironment) {
+    const char *JSON_FILE_NAME = "test_cpu_reference_simulation_export.json";
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    m.Environment().newProperty<int>("a", 12);
+    m.Environment().newProperty<float, 3>("b", {1.0f, 2.0f, 3.0f});
+    {
+        CPUReferenceSimulation s(m);
+        s.setEnvironmentProperty<int>("a", 13);
+        s.setEnvironmentProperty<float, 3>("b", {4.0f, 5.0f, 6.0f});
+        AgentVector pop(a, 10);
+        s.setPopulationData(pop);
+        s.exportData(JSON_FILE_NAME);
+    }
+    {
+        CPUReferenceSimulation s(m);
+        s.SimulationConfig().input_file = JSON_FILE_NAME;
+        s.applyConfig();
+        EXPECT_EQ(s.getEnvironmentProperty<int>("a"), 13);
+        const std::array<float, 3> b = {4.0f, 5.0f, 6.0f};
+        EXPECT_EQ((s.getEnvironmentProperty<float, 3>("b")), b);
+        AgentVector pop(a);
+        s.getPopulationData(pop);
+        EXPECT_EQ(pop.size(), 10u);
+    }
+    ASSERT_EQ(::remove(JSON_FILE_NAME), 0);
+}
+}  // namespace test_cpu_reference_simulation
+}  // namespace flamegpu
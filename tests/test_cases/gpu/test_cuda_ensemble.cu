@@ -1,5 +1,9 @@
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
 
 #include "flamegpu/flamegpu.h"
 
@@ -50,6 +54,10 @@ TEST(TestCUDAEnsemble, EnsembleConfig) {
     EXPECT_EQ(immutableConfig.devices, std::set<int>());  // @todo - this will need to change.
     EXPECT_EQ(immutableConfig.quiet, false);
     EXPECT_EQ(immutableConfig.timing, false);
+    EXPECT_EQ(immutableConfig.reuse_simulations, false);
+    EXPECT_EQ(immutableConfig.export_threads, 1u);
+    EXPECT_EQ(immutableConfig.export_queue_capacity, 1024u);
+    EXPECT_EQ(immutableConfig.export_shards, 0u);
     // Mutate the config. Note we cannot mutate the return from getConfig, and connot test this as it is a compialtion failure (requires ctest / standalone .cpp file)
     mutableConfig.out_directory = std::string("test");
     mutableConfig.out_format = std::string("xml");
@@ -57,6 +65,10 @@ TEST(TestCUDAEnsemble, EnsembleConfig) {
     mutableConfig.devices = std::set<int>({0});
     mutableConfig.quiet = true;
     mutableConfig.timing = true;
+    mutableConfig.reuse_simulations = true;
+    mutableConfig.export_threads = 4;
+    mutableConfig.export_queue_capacity = 0;
+    mutableConfig.export_shards = 2;
     // Check via the const ref, this should show the same value as config was a reference, not a copy.
     EXPECT_EQ(immutableConfig.out_directory, "test");
     EXPECT_EQ(immutableConfig.out_format, "xml");
@@ -64,6 +76,10 @@ TEST(TestCUDAEnsemble, EnsembleConfig) {
     EXPECT_EQ(immutableConfig.devices, std::set<int>({0}));  // @todo - this will need to change.
     EXPECT_EQ(immutableConfig.quiet, true);
     EXPECT_EQ(immutableConfig.timing, true);
+    EXPECT_EQ(immutableConfig.reuse_simulations, true);
+    EXPECT_EQ(immutableConfig.export_threads, 4u);
+    EXPECT_EQ(immutableConfig.export_queue_capacity, 0u);
+    EXPECT_EQ(immutableConfig.export_shards, 2u);
 }
 // This test causes `exit` so cannot be used.
 /* TEST(TestCUDAEnsemble, DISABLED_initialise_help) {
@@ -132,6 +148,30 @@ TEST(TestCUDAEnsemble, initialise_timing) {
     ensemble.initialise(sizeof(argv) / sizeof(char*), argv);
     EXPECT_EQ(ensemble.getConfig().timing, true);
 }
+TEST(TestCUDAEnsemble, initialise_reuse) {
+    // Create a model
+    flamegpu::ModelDescription model("test");
+    // Create an ensemble
+    flamegpu::CUDAEnsemble ensemble(model);
+    // Call initialise with differnt cli arguments, which will mutate values. Check they have the new value.
+    EXPECT_EQ(ensemble.getConfig().reuse_simulations, false);
+    const char *argv[2] = { "prog.exe", "--reuse" };
+    ensemble.initialise(sizeof(argv) / sizeof(char*), argv);
+    EXPECT_EQ(ensemble.getConfig().reuse_simulations, true);
+}
+TEST(TestCUDAEnsemble, initialise_export) {
+    // Create a model
+    flamegpu::ModelDescription model("test");
+    // Create an ensemble
+    flamegpu::CUDAEnsemble ensemble(model);
+    // Call initialise with differnt cli arguments, which will mutate values. Check they have the new value.
+    EXPECT_EQ(ensemble.getConfig().export_threads, 1u);
+    EXPECT_EQ(ensemble.getConfig().export_shards, 0u);
+    const char *argv[5] = { "prog.exe", "--export-threads", "3", "--export-shards", "2" };
+    ensemble.initialise(sizeof(argv) / sizeof(char*), argv);
+    EXPECT_EQ(ensemble.getConfig().export_threads, 3u);
+    EXPECT_EQ(ensemble.getConfig().export_shards, 2u);
+}
 // Agent function used to check the ensemble runs.
 FLAMEGPU_AGENT_FUNCTION(simulateAgentFn, flamegpu::MessageNone, flamegpu::MessageNone) {
     // Increment agent's counter by 1.
@@ -295,6 +335,196 @@ TEST(TestCUDAEnsemble, getLogs) {
     const auto &runLogs = ensemble.getLogs();
     EXPECT_EQ(runLogs.size(), 0u);
 }
+/**
+ * Issues plans in reverse index order, and records that it was used
+ */
+class ReverseScheduler : public RunPlanScheduler {
+ public:
+    std::vector<unsigned int> getOrder(const RunPlanVector &plans) const override {
+        ++calls;
+        std::vector<unsigned int> rtn;
+        for (unsigned int i = static_cast<unsigned int>(plans.size()); i > 0; --i)
+            rtn.push_back(i - 1);
+        return rtn;
+    }
+    mutable unsigned int calls = 0;
+};
+TEST(TestCUDAEnsemble, setScheduler) {
+    flamegpu::ModelDescription model("test");
+    flamegpu::AgentDescription &agent = model.newAgent("Agent");
+    agent.newVariable<uint32_t>("counter", 0u);
+    LoggingConfig lcfg(model);
+    flamegpu::RunPlanVector plans(model, 4);
+    for (unsigned int i = 0; i < plans.size(); ++i)
+        plans[i].setSteps(i + 1);
+    flamegpu::CUDAEnsemble ensemble(model);
+    ensemble.Config().quiet = true;
+    ensemble.Config().out_format = "";  // Suppress warning
+    ensemble.setExitLog(lcfg);
+    EXPECT_THROW(ensemble.setScheduler(nullptr), flamegpu::exception::InvalidArgument);
+    auto scheduler = std::make_shared<ReverseScheduler>();
+    EXPECT_NO_THROW(ensemble.setScheduler(scheduler));
+    EXPECT_NO_THROW(ensemble.simulate(plans));
+    EXPECT_EQ(scheduler->calls, 1u);
+    // Logs are stored by plan index, regardless of the order runs were executed
+    const auto &runLogs = ensemble.getLogs();
+    ASSERT_EQ(runLogs.size(), plans.size());
+    for (unsigned int i = 0; i < plans.size(); ++i) {
+        EXPECT_EQ(runLogs[i].getExitLog().getStepCount(), i + 1);
+    }
+}
+FLAMEGPU_INIT_FUNCTION(reuseInit) {
+    // Population is seeded from random, so that reseeding between runs is checked
+    auto agent = FLAMEGPU->agent("Agent");
+    for (uint32_t i = 0; i < FLAMEGPU->environment.getProperty<uint32_t>("POPULATION_TO_GENERATE"); ++i) {
+        agent.newAgent().setVariable<float>("x", FLAMEGPU->random.uniform<float>());
+    }
+}
+FLAMEGPU_AGENT_FUNCTION(reuseCopyID, flamegpu::MessageNone, flamegpu::MessageNone) {
+    // Agent IDs should be assigned as they are by a new simulation
+    FLAMEGPU->setVariable<flamegpu::id_t>("id_copy", FLAMEGPU->getID());
+    return flamegpu::ALIVE;
+}
+FLAMEGPU_STEP_FUNCTION(reuseStep) {
+    // Macro property should begin each run at 0
+    auto count = FLAMEGPU->environment.getMacroProperty<uint32_t>("count");
+    ++count;
+    FLAMEGPU->environment.setProperty<uint32_t>("count_copy", count);
+    // Mutated properties should begin each run at their default, or overridden, value
+    FLAMEGPU->environment.setProperty<int>("a", FLAMEGPU->environment.getProperty<int>("a") + 1);
+}
+TEST(TestCUDAEnsemble, reuse_simulations) {
+    // Runs executed by a reused simulation, should produce the same logs as runs which each create a new simulation
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<uint32_t>("POPULATION_TO_GENERATE", 64, true);
+    model.Environment().newProperty<int>("a", 10);
+    model.Environment().newProperty<uint32_t>("count_copy", 0);
+    model.Environment().newMacroProperty<uint32_t>("count");
+    flamegpu::AgentDescription &agent = model.newAgent("Agent");
+    agent.newVariable<float>("x", 0);
+    agent.newVariable<flamegpu::id_t>("id_copy", flamegpu::ID_NOT_SET);
+    model.newLayer().addAgentFunction(agent.newFunction("reuseCopyID", reuseCopyID));
+    model.addInitFunction(reuseInit);
+    model.addStepFunction(reuseStep);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("a");
+    lcfg.logEnvironment("count_copy");
+    lcfg.agent("Agent").logCount();
+    lcfg.agent("Agent").logSum<float>("x");
+    lcfg.agent("Agent").logMin<flamegpu::id_t>("id_copy");
+    lcfg.agent("Agent").logMax<flamegpu::id_t>("id_copy");
+    // Only some runs override a, so that later runs must restore the default
+    // Some runs override the population size, which is marked const, so that the ID counter of the previous run must be reset
+    flamegpu::RunPlanVector plans(model, 6);
+    plans.setRandomSimulationSeed(12, 7);
+    for (unsigned int i = 0; i < plans.size(); ++i) {
+        plans[i].setSteps(i + 1);
+        if (i % 2 == 0)
+            plans[i].setProperty<int>("a", static_cast<int>(i) * 100);
+        if (i % 3 == 1)
+            plans[i].setProperty<uint32_t>("POPULATION_TO_GENERATE", 32);
+    }
+    std::vector<RunLog> logs[2];
+    for (int reuse = 0; reuse < 2; ++reuse) {
+        flamegpu::CUDAEnsemble ensemble(model);
+        ensemble.Config().quiet = true;
+        ensemble.Config().out_format = "";  // Suppress warning
+        ensemble.Config().concurrent_runs = 1;
+        ensemble.Config().devices = {0};
+        ensemble.Config().reuse_simulations = reuse != 0;
+        ensemble.setExitLog(lcfg);
+        EXPECT_NO_THROW(ensemble.simulate(plans));
+        logs[reuse] = ensemble.getLogs();
+    }
+    ASSERT_EQ(logs[0].size(), plans.size());
+    ASSERT_EQ(logs[1].size(), plans.size());
+    for (unsigned int i = 0; i < plans.size(); ++i) {
+        const auto &created = logs[0][i].getExitLog();
+        const auto &reused = logs[1][i].getExitLog();
+        EXPECT_EQ(reused.getStepCount(), i + 1);
+        EXPECT_EQ(reused.getStepCount(), created.getStepCount());
+        EXPECT_EQ(logs[1][i].getRandomSeed(), logs[0][i].getRandomSeed());
+        EXPECT_EQ(reused.getEnvironmentProperty<int>("a"), (i % 2 == 0 ? static_cast<int>(i) * 100 : 10) + static_cast<int>(i) + 1);
+        EXPECT_EQ(reused.getEnvironmentProperty<int>("a"), created.getEnvironmentProperty<int>("a"));
+        EXPECT_EQ(reused.getEnvironmentProperty<uint32_t>("count_copy"), i + 1);
+        EXPECT_EQ(reused.getEnvironmentProperty<uint32_t>("count_copy"), created.getEnvironmentProperty<uint32_t>("count_copy"));
+        EXPECT_EQ(reused.getAgent("Agent").getCount(), i % 3 == 1 ? 32u : 64u);
+        EXPECT_EQ(reused.getAgent("Agent").getCount(), created.getAgent("Agent").getCount());
+        EXPECT_EQ(reused.getAgent("Agent").getSum<float>("x"), created.getAgent("Agent").getSum<float>("x"));
+        EXPECT_EQ(reused.getAgent("Agent").getMin<flamegpu::id_t>("id_copy"), created.getAgent("Agent").getMin<flamegpu::id_t>("id_copy"));
+        EXPECT_EQ(reused.getAgent("Agent").getMax<flamegpu::id_t>("id_copy"), created.getAgent("Agent").getMax<flamegpu::id_t>("id_copy"));
+        EXPECT_EQ(reused.getAgent("Agent").getMax<flamegpu::id_t>("id_copy") - reused.getAgent("Agent").getMin<flamegpu::id_t>("id_copy") + 1,
+            reused.getAgent("Agent").getCount());
+    }
+}
+TEST(TestCUDAEnsemble, export_shards) {
+    // The logs of every run are exported as one record, appended to the run's shard file
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<int>("a", 10);
+    LoggingConfig lcfg(model);
+    lcfg.logEnvironment("a");
+    flamegpu::RunPlanVector plans(model, 7);
+    plans.setSteps(1);
+    plans.setPropertyUniformDistribution<int>("a", 0, 6);
+    flamegpu::CUDAEnsemble ensemble(model);
+    ensemble.Config().quiet = true;
+    ensemble.Config().out_directory = ".";
+    ensemble.Config().out_format = "json";
+    ensemble.Config().export_threads = 3;
+    ensemble.Config().export_queue_capacity = 1;
+    ensemble.Config().export_shards = 2;
+    ensemble.setExitLog(lcfg);
+    EXPECT_NO_THROW(ensemble.simulate(plans));
+    // Runs are distributed between shards by their index
+    unsigned int records[2] = {0, 0};
+    for (unsigned int shard = 0; shard < 2; ++shard) {
+        const std::string shard_path = "runs." + std::to_string(shard) + ".json";
+        std::ifstream shard_file(shard_path);
+        ASSERT_TRUE(shard_file.is_open());
+        std::string record;
+        while (std::getline(shard_file, record)) {
+            if (record.empty())
+                continue;
+            ++records[shard];
+            const size_t index_pos = record.find("\"run_index\":");
+            ASSERT_NE(index_pos, std::string::npos);
+            const unsigned int run_index = static_cast<unsigned int>(std::stoul(record.substr(index_pos + 12)));
+            EXPECT_EQ(run_index % 2, shard);
+            EXPECT_NE(record.find("\"exit\":"), std::string::npos);
+        }
+        shard_file.close();
+        std::remove(shard_path.c_str());
+    }
+    EXPECT_EQ(records[0], 4u);
+    EXPECT_EQ(records[1], 3u);
+    // Per run files are not created
+    EXPECT_FALSE(std::ifstream("exit.json").is_open());
+    // XML shards wrap their records in a single root element
+    ensemble.Config().out_format = "xml";
+    EXPECT_NO_THROW(ensemble.simulate(plans));
+    for (unsigned int shard = 0; shard < 2; ++shard) {
+        const std::string shard_path = "runs." + std::to_string(shard) + ".xml";
+        std::ifstream shard_file(shard_path);
+        ASSERT_TRUE(shard_file.is_open());
+        const std::string contents((std::istreambuf_iterator<char>(shard_file)), std::istreambuf_iterator<char>());
+        shard_file.close();
+        std::remove(shard_path.c_str());
+        EXPECT_EQ(contents.find("<runs>\n"), 0u);
+        EXPECT_EQ(contents.rfind("</runs>\n"), contents.size() - 8);
+        unsigned int logs = 0;
+        for (size_t pos = contents.find("<log>"); pos != std::string::npos; pos = contents.find("<log>", pos + 1)) {
+            ++logs;
+            const size_t index_pos = contents.find("<run_index>", pos);
+            ASSERT_NE(index_pos, std::string::npos);
+            EXPECT_EQ(std::stoul(contents.substr(index_pos + 11)) % 2, shard);
+        }
+        EXPECT_EQ(logs, shard == 0 ? 4u : 3u);
+        EXPECT_EQ(contents.find("<runs>", 1), std::string::npos);
+    }
+    // The export pool requires atleast one thread
+    ensemble.Config().export_threads = 0;
+    EXPECT_THROW(ensemble.simulate(plans), flamegpu::exception::InvalidArgument);
+}
 // Agent function used to check the ensemble runs.
 FLAMEGPU_AGENT_FUNCTION(elapsedAgentFn, flamegpu::MessageNone, flamegpu::MessageNone) {
     // Increment agent's counter by 1.
@@ -1,6 +1,7 @@
 #include <chrono>
 #include <thread>
 #include <set>
+#include <string>
 
 #include "flamegpu/flamegpu.h"
 #include "flamegpu/util/detail/compute_capability.cuh"
@@ -501,6 +502,56 @@ TEST(TestCUDASimulation, stepElapsedTime) {
     }
 }
 
+FLAMEGPU_AGENT_FUNCTION_CONDITION(ProfileCondition) {
+    return true;
+}
+FLAMEGPU_HOST_FUNCTION(ProfileHostFunction) {
+    externalCounter++;
+}
+// test the per layer and per function timings collected by the profiler
+TEST(TestCUDASimulation, Profile) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("i");
+    a.newVariable<int>("j");
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, add_fn);
+    f.setFunctionCondition(ProfileCondition);
+    m.newLayer(LAYER_NAME).addAgentFunction(f);
+    m.newLayer().addHostFunction(ProfileHostFunction);
+    m.addStepFunction(IncrementCounter);
+    AgentVector pop(a, static_cast<unsigned int>(AGENT_COUNT));
+
+    CUDASimulation c(m);
+    c.setPopulationData(pop);
+    const unsigned int STEPS = 5u;
+    c.SimulationConfig().steps = STEPS;
+    // Disabled by default
+    c.simulate();
+    EXPECT_TRUE(c.getRunLog().getProfile().empty());
+    c.SimulationConfig().profile = true;
+    c.simulate();
+    const Profile &profile = c.getRunLog().getProfile();
+    const std::string layer = std::string("step/layer:") + LAYER_NAME;
+    const std::string agent_fn = std::string(AGENT_NAME) + "." + FUNCTION_NAME;
+    for (const std::string &path : {
+        std::string("step"),
+        layer,
+        layer + "/condition:" + agent_fn,
+        layer + "/condition_scatter:" + agent_fn,
+        layer + "/function:" + agent_fn,
+        layer + "/scatter:" + agent_fn,
+        std::string("step/layer:1/host_function:0"),
+        std::string("step/step_function:0")}) {
+        ASSERT_TRUE(profile.hasRegion(path)) << path;
+        EXPECT_EQ(profile.getRegion(path).calls, STEPS) << path;
+        EXPECT_GE(profile.getRegion(path).min_time, 0.) << path;
+    }
+    EXPECT_GE(profile.getRegion("step").total_time, profile.getRegion(layer).total_time);
+    // Profiling is reset by each call to simulate()
+    c.simulate();
+    EXPECT_EQ(c.getRunLog().getProfile().getRegion("step").calls, STEPS);
+}
+
 /* const char* rtc_empty_agent_func = R"###(
 FLAMEGPU_AGENT_FUNCTION(rtc_test_func, MessageNone, MessageNone) {
     return ALIVE;
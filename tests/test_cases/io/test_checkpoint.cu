@@ -0,0 +1,374 @@
+/**
+ * Tests of Simulation::checkpoint() and Simulation::restore()
+ *
+ * Tests cover:
+ * > a run resumed from a checkpoint matches a run which was never interrupted
+ *   (agent variables, agent IDs, device and host random, environment and macro properties, step log)
+ * > messages output in the step before a checkpoint are available to read after it is restored
+ * > automatic checkpoints written via Config::checkpoint_frequency
+ * > checkpoints of a different model, or corrupt checkpoints, are rejected
+ * > CPUReferenceSimulation checkpoints
+ */
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+
+
+namespace test_checkpoint {
+const char *MODEL_NAME = "Model";
+const char *AGENT_NAME = "Agent";
+const char *FUNCTION_NAME = "Function";
+const char *CHECKPOINT_FILE = "test_checkpoint.ckpt";
+const unsigned int AGENT_COUNT = 1024;
+const unsigned int STEPS = 10;
+
+FLAMEGPU_AGENT_FUNCTION(RandomWalk, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<float>("x", FLAMEGPU->getVariable<float>("x") + FLAMEGPU->random.uniform<float>());
+    FLAMEGPU->environment.getMacroProperty<unsigned int>("macro") += 1;
+    return ALIVE;
+}
+FLAMEGPU_STEP_FUNCTION(HostStep) {
+    // Host random, environment properties and host agent birth (which consumes agent IDs)
+    FLAMEGPU->environment.setProperty<float>("host", FLAMEGPU->environment.getProperty<float>("host") + FLAMEGPU->random.uniform<float>());
+    FLAMEGPU->agent(AGENT_NAME).newAgent().setVariable<float>("x", FLAMEGPU->random.uniform<float>());
+    FLAMEGPU->environment.setProperty<unsigned int>("macro_copy", FLAMEGPU->environment.getMacroProperty<unsigned int>("macro"));
+}
+unsigned int init_calls = 0;
+FLAMEGPU_INIT_FUNCTION(CountInit) {
+    ++init_calls;
+}
+struct Result {
+    std::vector<id_t> ids;
+    std::vector<float> x;
+    float host;
+    unsigned int macro;
+    unsigned int step_count;
+    std::list<StepLogFrame> step_log;
+};
+void buildModel(ModelDescription &m) {
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<float>("x", 0);
+    a.newFunction(FUNCTION_NAME, RandomWalk);
+    m.Environment().newProperty<float>("host", 0);
+    m.Environment().newProperty<unsigned int>("macro_copy", 0);
+    m.Environment().newMacroProperty<unsigned int>("macro");
+    m.newLayer().addAgentFunction(RandomWalk);
+    m.addStepFunction(HostStep);
+    m.addInitFunction(CountInit);
+}
+StepLoggingConfig buildStepLog(const ModelDescription &m) {
+    StepLoggingConfig slcfg(m);
+    slcfg.setFrequency(1);
+    slcfg.agent(AGENT_NAME).logCount();
+    slcfg.agent(AGENT_NAME).logMean<float>("x");
+    slcfg.logEnvironment("host");
+    return slcfg;
+}
+Result getResult(CUDASimulation &sim, const ModelDescription &m) {
+    Result rtn;
+    AgentVector pop(m.getAgent(AGENT_NAME));
+    sim.getPopulationData(pop);
+    for (const auto a : pop) {
+        rtn.ids.push_back(a.getID());
+        rtn.x.push_back(a.getVariable<float>("x"));
+    }
+    rtn.host = sim.getEnvironmentProperty<float>("host");
+    rtn.macro = sim.getEnvironmentProperty<unsigned int>("macro_copy");
+    rtn.step_count = sim.getStepCounter();
+    rtn.step_log = sim.getRunLog().getStepLog();
+    return rtn;
+}
+void expectEqual(const Result &a, const Result &b) {
+    EXPECT_EQ(a.ids, b.ids);
+    EXPECT_EQ(a.x, b.x);
+    EXPECT_EQ(a.host, b.host);
+    EXPECT_EQ(a.macro, b.macro);
+    EXPECT_EQ(a.step_count, b.step_count);
+    ASSERT_EQ(a.step_log.size(), b.step_log.size());
+    auto it_b = b.step_log.begin();
+    for (const auto &frame_a : a.step_log) {
+        const StepLogFrame &frame_b = *it_b++;
+        EXPECT_EQ(frame_a.getStepCount(), frame_b.getStepCount());
+        EXPECT_EQ(frame_a.getEnvironmentProperty<float>("host"), frame_b.getEnvironmentProperty<float>("host"));
+        EXPECT_EQ(frame_a.getAgent(AGENT_NAME).getCount(), frame_b.getAgent(AGENT_NAME).getCount());
+        EXPECT_EQ(frame_a.getAgent(AGENT_NAME).getMean("x"), frame_b.getAgent(AGENT_NAME).getMean("x"));
+    }
+}
+
+TEST(CheckpointTest, ResumeMatchesUninterrupted) {
+    ModelDescription m(MODEL_NAME);
+    buildModel(m);
+    const StepLoggingConfig slcfg = buildStepLog(m);
+    AgentVector pop(m.getAgent(AGENT_NAME), AGENT_COUNT);
+    // Uninterrupted run
+    Result uninterrupted;
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS;
+        sim.SimulationConfig().random_seed = 12;
+        sim.setStepLog(slcfg);
+        sim.applyConfig();
+        sim.setPopulationData(pop);
+        sim.simulate();
+        uninterrupted = getResult(sim, m);
+    }
+    // Interrupted run, stopped half way through
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS / 2;
+        sim.SimulationConfig().random_seed = 12;
+        sim.setStepLog(slcfg);
+        sim.applyConfig();
+        sim.setPopulationData(pop);
+        sim.simulate();
+        sim.checkpoint(CHECKPOINT_FILE);
+        sim.waitForCheckpoint();
+    }
+    // Resumed run, the seed is restored from the checkpoint
+    init_calls = 0;
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS;
+        sim.SimulationConfig().random_seed = 999;
+        sim.setStepLog(slcfg);
+        sim.applyConfig();
+        sim.restore(CHECKPOINT_FILE);
+        EXPECT_EQ(sim.getSimulationConfig().random_seed, 12u);
+        EXPECT_EQ(sim.getStepCounter(), STEPS / 2);
+        sim.simulate();
+        EXPECT_EQ(init_calls, 0u);
+        expectEqual(getResult(sim, m), uninterrupted);
+    }
+    EXPECT_EQ(uninterrupted.ids.size(), AGENT_COUNT + STEPS);
+    EXPECT_EQ(uninterrupted.macro, AGENT_COUNT * STEPS + STEPS * (STEPS - 1) / 2);
+    std::remove(CHECKPOINT_FILE);
+}
+TEST(CheckpointTest, CheckpointFrequency) {
+    ModelDescription m(MODEL_NAME);
+    buildModel(m);
+    AgentVector pop(m.getAgent(AGENT_NAME), AGENT_COUNT);
+    std::remove(CHECKPOINT_FILE);
+    Result uninterrupted;
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS;
+        sim.SimulationConfig().random_seed = 34;
+        sim.SimulationConfig().checkpoint_file = CHECKPOINT_FILE;
+        sim.SimulationConfig().checkpoint_frequency = 3;
+        sim.applyConfig();
+        sim.setPopulationData(pop);
+        sim.simulate();
+        uninterrupted = getResult(sim, m);
+    }
+    // The most recent checkpoint was taken after step 9
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS;
+        sim.restore(CHECKPOINT_FILE);
+        EXPECT_EQ(sim.getStepCounter(), 9u);
+        sim.simulate();
+        expectEqual(getResult(sim, m), uninterrupted);
+    }
+    std::remove(CHECKPOINT_FILE);
+}
+TEST(CheckpointTest, ResetDiscardsRestore) {
+    ModelDescription m(MODEL_NAME);
+    buildModel(m);
+    AgentVector pop(m.getAgent(AGENT_NAME), AGENT_COUNT);
+    CUDASimulation sim(m);
+    sim.SimulationConfig().steps = 2;
+    sim.setPopulationData(pop);
+    sim.simulate();
+    sim.checkpoint(CHECKPOINT_FILE);
+    sim.restore(CHECKPOINT_FILE);
+    sim.reset();
+    init_calls = 0;
+    sim.setPopulationData(pop);
+    sim.simulate();
+    EXPECT_EQ(init_calls, 1u);
+    EXPECT_EQ(sim.getStepCounter(), 2u);
+    std::remove(CHECKPOINT_FILE);
+}
+TEST(CheckpointTest, DifferentModel) {
+    ModelDescription m(MODEL_NAME);
+    buildModel(m);
+    ModelDescription m2("Model2");
+    buildModel(m2);
+    {
+        AgentVector pop(m.getAgent(AGENT_NAME), AGENT_COUNT);
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = 1;
+        sim.setPopulationData(pop);
+        sim.simulate();
+        sim.checkpoint(CHECKPOINT_FILE);
+    }
+    CUDASimulation sim2(m2);
+    EXPECT_THROW(sim2.restore(CHECKPOINT_FILE), exception::InvalidInputFile);
+    std::remove(CHECKPOINT_FILE);
+}
+TEST(CheckpointTest, CorruptFile) {
+    ModelDescription m(MODEL_NAME);
+    buildModel(m);
+    CUDASimulation sim(m);
+    EXPECT_THROW(sim.restore("missing.ckpt"), exception::InvalidFilePath);
+    AgentVector pop(m.getAgent(AGENT_NAME), AGENT_COUNT);
+    sim.SimulationConfig().steps = 1;
+    sim.setPopulationData(pop);
+    sim.simulate();
+    sim.checkpoint(CHECKPOINT_FILE);
+    sim.waitForCheckpoint();
+    {
+        // Truncate the file
+        std::ifstream in(CHECKPOINT_FILE, std::ios::in | std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(CHECKPOINT_FILE, std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size() / 2);
+    }
+    EXPECT_THROW(sim.restore(CHECKPOINT_FILE), exception::InvalidInputFile);
+    {
+        std::ofstream file(CHECKPOINT_FILE, std::ios::out | std::ios::binary | std::ios::trunc);
+        file << "not a checkpoint";
+    }
+    EXPECT_THROW(sim.restore(CHECKPOINT_FILE), exception::InvalidInputFile);
+    std::remove(CHECKPOINT_FILE);
+}
+const char *MESSAGE_NAME = "Message";
+FLAMEGPU_AGENT_FUNCTION(SpatialIn, MessageSpatial3D, MessageNone) {
+    // Messages were output by the previous step
+    const float x = FLAMEGPU->getVariable<float>("x");
+    const float y = FLAMEGPU->getVariable<float>("y");
+    const float z = FLAMEGPU->getVariable<float>("z");
+    unsigned int sum = 0;
+    for (auto &message : FLAMEGPU->message_in(x, y, z)) {
+        sum += message.getVariable<unsigned int>("id");
+    }
+    FLAMEGPU->setVariable<unsigned int>("sum", FLAMEGPU->getVariable<unsigned int>("sum") + sum);
+    FLAMEGPU->setVariable<float>("x", fmodf(x + FLAMEGPU->random.uniform<float>(), 10.0f));
+    return ALIVE;
+}
+FLAMEGPU_AGENT_FUNCTION(SpatialOut, MessageNone, MessageSpatial3D) {
+    FLAMEGPU->message_out.setVariable<unsigned int>("id", FLAMEGPU->getID());
+    FLAMEGPU->message_out.setLocation(FLAMEGPU->getVariable<float>("x"), FLAMEGPU->getVariable<float>("y"), FLAMEGPU->getVariable<float>("z"));
+    return ALIVE;
+}
+TEST(CheckpointTest, Messages) {
+    ModelDescription m(MODEL_NAME);
+    MessageSpatial3D::Description &message = m.newMessage<MessageSpatial3D>(MESSAGE_NAME);
+    message.newVariable<unsigned int>("id");
+    message.setRadius(1.0f);
+    message.setMin(0, 0, 0);
+    message.setMax(10, 10, 10);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<float>("x");
+    a.newVariable<float>("y");
+    a.newVariable<float>("z");
+    a.newVariable<unsigned int>("sum", 0);
+    a.newFunction("in", SpatialIn).setMessageInput(message);
+    a.newFunction("out", SpatialOut).setMessageOutput(message);
+    m.newLayer().addAgentFunction(SpatialIn);
+    m.newLayer().addAgentFunction(SpatialOut);
+    AgentVector pop(a, AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        pop[i].setVariable<float>("x", static_cast<float>(i % 10));
+        pop[i].setVariable<float>("y", static_cast<float>((i / 10) % 10));
+        pop[i].setVariable<float>("z", static_cast<float>((i / 100) % 10));
+    }
+    std::vector<unsigned int> uninterrupted;
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS;
+        sim.SimulationConfig().random_seed = 56;
+        sim.applyConfig();
+        sim.setPopulationData(pop);
+        sim.simulate();
+        AgentVector out(a);
+        sim.getPopulationData(out);
+        for (const auto agent : out)
+            uninterrupted.push_back(agent.getVariable<unsigned int>("sum"));
+    }
+    {
+        CUDASimulation sim(m);
+        sim.SimulationConfig().steps = STEPS / 2;
+        sim.SimulationConfig().random_seed = 56;
+        sim.applyConfig();
+        sim.setPopulationData(pop);
+        sim.simulate();
+        sim.checkpoint(CHECKPOINT_FILE);
+        sim.waitForCheckpoint();
+    }
+    CUDASimulation sim(m);
+    sim.SimulationConfig().steps = STEPS;
+    sim.applyConfig();
+    sim.restore(CHECKPOINT_FILE);
+    sim.simulate();
+    AgentVector out(a);
+    sim.getPopulationData(out);
+    ASSERT_EQ(out.size(), uninterrupted.size());
+    for (unsigned int i = 0; i < out.size(); ++i) {
+        EXPECT_EQ(out[i].getVariable<unsigned int>("sum"), uninterrupted[i]);
+    }
+    std::remove(CHECKPOINT_FILE);
+}
+
+FLAMEGPU_AGENT_FUNCTION(DeviceNullFn, MessageNone, MessageNone) {
+    return ALIVE;
+}
+FLAMEGPU_CPU_AGENT_FUNCTION(IncrementFn) {
+    FLAMEGPU->setVariable<int>("x", FLAMEGPU->getVariable<int>("x") + FLAMEGPU->environment.getProperty<int>("inc"));
+    return ALIVE;
+}
+TEST(CheckpointTest, CPUReferenceSimulation) {
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME, DeviceNullFn);
+    m.Environment().newProperty<int>("inc", 2);
+    m.newLayer().addAgentFunction(f);
+    StepLoggingConfig slcfg(m);
+    slcfg.agent(AGENT_NAME).logSum<int>("x");
+    AgentVector pop(a, AGENT_COUNT);
+    {
+        CPUReferenceSimulation s(m);
+        s.SimulationConfig().steps = 3;
+        s.setStepLog(slcfg);
+        s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, IncrementFn);
+        s.setPopulationData(pop);
+        s.simulate();
+        s.checkpoint(CHECKPOINT_FILE);
+    }
+    CPUReferenceSimulation s(m);
+    s.SimulationConfig().steps = 5;
+    s.setStepLog(slcfg);
+    s.setAgentFunction(AGENT_NAME, FUNCTION_NAME, IncrementFn);
+    s.restore(CHECKPOINT_FILE);
+    s.simulate();
+    EXPECT_EQ(s.getStepCounter(), 5u);
+    s.getPopulationData(pop);
+    ASSERT_EQ(pop.size(), AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        EXPECT_EQ(pop[i].getVariable<int>("x"), 10);
+        EXPECT_EQ(pop[i].getID(), static_cast<id_t>(i + 1));
+    }
+    const auto &step_log = s.getRunLog().getStepLog();
+    ASSERT_EQ(step_log.size(), 6u);
+    unsigned int step = 0;
+    for (const auto &frame : step_log) {
+        EXPECT_EQ(frame.getStepCount(), step);
+        EXPECT_EQ(frame.getAgent(AGENT_NAME).getSum<int>("x"), static_cast<int>(AGENT_COUNT * step * 2));
+        ++step;
+    }
+    std::remove(CHECKPOINT_FILE);
+}
+
+}  // namespace test_checkpoint
+}  // namespace flamegpu
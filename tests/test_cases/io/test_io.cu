@@ -1,9 +1,11 @@
 #include <iostream>
 #include <fstream>
+#include <string>
 
 #include "gtest/gtest.h"
 
 #include "flamegpu/flamegpu.h"
+#include "flamegpu/io/detail/BinaryStateFormat.h"
 
 namespace flamegpu {
 
@@ -11,6 +13,7 @@ namespace test_io {
 bool validate_has_run = false;
 const char *XML_FILE_NAME = "test.xml";
 const char *JSON_FILE_NAME = "test.json";
+const char *BINARY_FILE_NAME = "test.fgpub";
 FLAMEGPU_STEP_FUNCTION(VALIDATE_ENV) {
     EXPECT_EQ(FLAMEGPU->environment.getProperty<float>("float"), 12.0f);
     EXPECT_EQ(FLAMEGPU->environment.getProperty<float>("float"), 12.0f);
@@ -70,7 +73,11 @@ FLAMEGPU_STEP_FUNCTION(RESET_ENV) {
 
 class MiniSim {
  public:
-    void run(const std::string &test_file_name) {
+    /**
+     * @param test_file_name File to export to and import from
+     * @param has_config False if the file format does not store the simulation config (e.g. binary)
+     */
+    void run(const std::string &test_file_name, const bool has_config = true) {
         ModelDescription model("test_model");
         AgentDescription &a = model.newAgent("a");
         {
@@ -188,26 +195,29 @@ class MiniSim {
 #ifdef VISUALISATION
             am.SimulationConfig().console_mode = false;
 #endif
-            am.CUDAConfig().device_id = 1000;
+            if (has_config)
+                am.CUDAConfig().device_id = 1000;
             am.CUDAConfig().inLayerConcurrency = true;
             // Perform import
             am.SimulationConfig().input_file = test_file_name;
             EXPECT_NO_THROW(am.applyConfig());  // If loading device id from config file didn't work, this would throw exception::InvalidCUDAdevice
             // Validate config matches
             EXPECT_EQ(am.getSimulationConfig().input_file, test_file_name);
-            EXPECT_EQ(am.getSimulationConfig().step_log_file, "step");
-            EXPECT_EQ(am.getSimulationConfig().exit_log_file, "exit");
-            EXPECT_EQ(am.getSimulationConfig().common_log_file, "common");
-            EXPECT_EQ(am.getSimulationConfig().truncate_log_files, false);
-            EXPECT_EQ(am.getSimulationConfig().random_seed, 654321u);
-            EXPECT_EQ(am.getSimulationConfig().steps, 123u);
-            EXPECT_EQ(am.getSimulationConfig().verbose, false);
-            EXPECT_EQ(am.getSimulationConfig().timing, true);
+            if (has_config) {
+                EXPECT_EQ(am.getSimulationConfig().step_log_file, "step");
+                EXPECT_EQ(am.getSimulationConfig().exit_log_file, "exit");
+                EXPECT_EQ(am.getSimulationConfig().common_log_file, "common");
+                EXPECT_EQ(am.getSimulationConfig().truncate_log_files, false);
+                EXPECT_EQ(am.getSimulationConfig().random_seed, 654321u);
+                EXPECT_EQ(am.getSimulationConfig().steps, 123u);
+                EXPECT_EQ(am.getSimulationConfig().verbose, false);
+                EXPECT_EQ(am.getSimulationConfig().timing, true);
 #ifdef VISUALISATION
-            EXPECT_EQ(am.getSimulationConfig().console_mode, true);
+                EXPECT_EQ(am.getSimulationConfig().console_mode, true);
 #endif
-            EXPECT_EQ(am.getCUDAConfig().device_id, 0);
-            EXPECT_EQ(am.getCUDAConfig().inLayerConcurrency, false);
+                EXPECT_EQ(am.getCUDAConfig().device_id, 0);
+                EXPECT_EQ(am.getCUDAConfig().inLayerConcurrency, false);
+            }
             AgentVector pop_a_in(a, 5);
             AgentVector pop_b_in(b, 5);
             am.getPopulationData(pop_a_in);
@@ -298,6 +308,9 @@ TEST_F(IOTest, XML_WriteRead) {
 TEST_F(IOTest, JSON_WriteRead) {
     ms->run(JSON_FILE_NAME);
 }
+TEST_F(IOTest, Binary_WriteRead) {
+    ms->run(BINARY_FILE_NAME, false);
+}
 FLAMEGPU_HOST_FUNCTION(DoNothing) {
     // Do nothing
 }
@@ -415,5 +428,111 @@ TEST(IOTest2, AgentID_FileInput_IDCollision) {
     // Cleanup
     ASSERT_EQ(::remove(JSON_FILE_NAME), 0);
 }
+// Binary state files can only be loaded by the model which produced them
+TEST(IOTest2, Binary_LayoutMismatch) {
+    {
+        ModelDescription model("test_binary");
+        AgentDescription& agent = model.newAgent("agent");
+        agent.newVariable<float>("x");
+        model.newLayer().addHostFunction(DoNothing);
+        CUDASimulation sim(model);
+        AgentVector pop(agent, 10);
+        sim.setPopulationData(pop);
+        sim.exportData(BINARY_FILE_NAME);
+    }
+    ModelDescription model("test_binary");
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newVariable<double>("x");
+    model.newLayer().addHostFunction(DoNothing);
+    CUDASimulation sim(model);
+    sim.SimulationConfig().input_file = BINARY_FILE_NAME;
+    EXPECT_THROW(sim.applyConfig(), exception::InvalidInputFile);
+    // Cleanup
+    ASSERT_EQ(::remove(BINARY_FILE_NAME), 0);
+}
+TEST(IOTest2, Binary_Truncated) {
+    ModelDescription model("test_binary");
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newVariable<float>("x");
+    model.newLayer().addHostFunction(DoNothing);
+    std::string file_body;
+    {
+        CUDASimulation sim(model);
+        AgentVector pop(agent, 1000);
+        sim.setPopulationData(pop);
+        sim.exportData(BINARY_FILE_NAME);
+        std::ifstream in(BINARY_FILE_NAME, std::ifstream::binary);
+        file_body = std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+    // Remove the tail of the final column
+    {
+        std::ofstream out(BINARY_FILE_NAME, std::ofstream::binary | std::ofstream::trunc);
+        out.write(file_body.data(), file_body.size() - 100);
+    }
+    {
+        CUDASimulation sim(model);
+        sim.SimulationConfig().input_file = BINARY_FILE_NAME;
+        EXPECT_THROW(sim.applyConfig(), exception::InvalidInputFile);
+    }
+    // Remove everything but the magic
+    {
+        std::ofstream out(BINARY_FILE_NAME, std::ofstream::binary | std::ofstream::trunc);
+        out.write(file_body.data(), 8);
+    }
+    {
+        CUDASimulation sim(model);
+        sim.SimulationConfig().input_file = BINARY_FILE_NAME;
+        EXPECT_THROW(sim.applyConfig(), exception::InvalidInputFile);
+    }
+    // Corrupt the final column's offset, such that offset + length overflows
+    {
+        io::detail::binary_state::FileHeader header;
+        memcpy(&header, file_body.data(), sizeof(header));
+        const uint64_t offset_pos = sizeof(header) + header.layout_bytes - sizeof(uint64_t);
+        const uint64_t offset = UINT64_MAX - io::detail::binary_state::alignOffset(sizeof(header) + header.layout_bytes);
+        std::string corrupt_body = file_body;
+        memcpy(&corrupt_body[offset_pos], &offset, sizeof(uint64_t));
+        std::ofstream out(BINARY_FILE_NAME, std::ofstream::binary | std::ofstream::trunc);
+        out.write(corrupt_body.data(), corrupt_body.size());
+    }
+    {
+        CUDASimulation sim(model);
+        sim.SimulationConfig().input_file = BINARY_FILE_NAME;
+        EXPECT_THROW(sim.applyConfig(), exception::InvalidInputFile);
+    }
+    // Cleanup
+    ASSERT_EQ(::remove(BINARY_FILE_NAME), 0);
+}
+TEST(IOTest2, AgentID_Binary_ExportImport) {
+    ModelDescription model("test_agentid");
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newVariable<id_t>("id_other", ID_NOT_SET);
+    auto& layer_a = model.newLayer();
+    layer_a.addHostFunction(DoNothing);
+    AgentVector pop_out(agent);
+    {
+        CUDASimulation sim(model);
+        AgentVector pop(agent, 100);
+        sim.setPopulationData(pop);
+        sim.step();
+        sim.getPopulationData(pop_out);
+        sim.exportData(BINARY_FILE_NAME);
+    }
+    {
+        CUDASimulation sim(model);
+        sim.SimulationConfig().input_file = BINARY_FILE_NAME;
+        EXPECT_NO_THROW(sim.applyConfig());
+
+        AgentVector pop_in(agent);
+        sim.getPopulationData(pop_in);
+        ASSERT_EQ(pop_in.size(), pop_out.size());
+        for (unsigned int i = 0; i < pop_in.size(); ++i) {
+            ASSERT_NE(pop_in[i].getID(), ID_NOT_SET);
+            EXPECT_EQ(pop_in[i].getID(), pop_out[i].getID());
+        }
+    }
+    // Cleanup
+    ASSERT_EQ(::remove(BINARY_FILE_NAME), 0);
+}
 }  // namespace test_io
 }  // namespace flamegpu
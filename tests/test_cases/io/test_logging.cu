@@ -382,6 +382,85 @@ TEST(LoggingTest, EmptyMean) {
         EXPECT_EQ(step.getAgent(AGENT_NAME1).getMean("float_var"), 0.0);
     }
 }
+TEST(LoggingTest, CUDASimulationDistributionReductions) {
+    /**
+     * Ensure quantile, histogram and covariance reductions are logged correctly by CUDASimulation
+     * The population is small enough that quantiles are exact
+     */
+    // Define model
+    ModelDescription m(MODEL_NAME);
+    AgentDescription &a = m.newAgent(AGENT_NAME1);
+    a.newVariable<float>("float_var");
+    a.newVariable<int>("int_var");
+    a.newVariable<unsigned int>("uint_var");
+    AgentFunctionDescription &f1 = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    m.newLayer().addAgentFunction(f1);
+
+    // Define logging configs
+    LoggingConfig lcfg(m);
+    AgentLoggingConfig alcfg = lcfg.agent(AGENT_NAME1);
+    alcfg.logQuantiles<float>("float_var", {0.0, 0.25, 0.5, 1.0});
+    alcfg.logHistogram<int>("int_var", 4, 0, 20);
+    alcfg.logCovariance<float, int>("float_var", "int_var");
+    alcfg.logCovariance<float, unsigned int>("float_var", "uint_var");
+
+    StepLoggingConfig slcfg(lcfg);
+    slcfg.setFrequency(1);
+
+    // Create agent population
+    AgentVector pop(a, 11);
+    for (int i = 0; i < 11; ++i) {
+        auto instance = pop[i];
+        instance.setVariable<float>("float_var", static_cast<float>(i));
+        instance.setVariable<int>("int_var", static_cast<int>(i + 1));
+        instance.setVariable<unsigned int>("uint_var", static_cast<unsigned int>(20 - 2 * i));
+    }
+
+    // Run model
+    CUDASimulation sim(m);
+    sim.SimulationConfig().steps = 5;
+    sim.setStepLog(slcfg);
+    sim.setExitLog(lcfg);
+    sim.setPopulationData(pop);
+    sim.simulate();
+
+    const auto checkFrame = [](const AgentLogFrame &agent_log, const unsigned int step_index) {
+        // float_var holds [step_index, step_index + 10]
+        const std::vector<double> quantiles = agent_log.getQuantiles("float_var");
+        ASSERT_EQ(quantiles.size(), 4u);
+        EXPECT_DOUBLE_EQ(quantiles[0], 0.0 + step_index);
+        EXPECT_DOUBLE_EQ(quantiles[1], 2.25 + step_index);
+        EXPECT_DOUBLE_EQ(quantiles[2], 5.0 + step_index);
+        EXPECT_DOUBLE_EQ(quantiles[3], 10.0 + step_index);
+        // int_var holds [step_index + 1, step_index + 11], counted into bins of width 5
+        std::vector<unsigned int> expected_histogram(4, 0);
+        for (unsigned int i = 1; i <= 11; ++i) {
+            const unsigned int v = i + step_index;
+            if (v < 20)
+                ++expected_histogram[v / 5];
+        }
+        EXPECT_EQ(agent_log.getHistogram("int_var"), expected_histogram);
+        // int_var is offset from float_var, uint_var is scaled by -2, so covariance is unaffected by the increment
+        EXPECT_DOUBLE_EQ(agent_log.getCovariance("float_var", "int_var"), 10.0);
+        EXPECT_DOUBLE_EQ(agent_log.getCovariance("int_var", "float_var"), 10.0);
+        EXPECT_DOUBLE_EQ(agent_log.getCovariance("float_var", "uint_var"), -20.0);
+    };
+    {  // Check step log
+        const auto &steps = sim.getRunLog().getStepLog();
+        EXPECT_EQ(steps.size(), 6u);  // init log, + 5 logs from 5 steps
+        unsigned int step_index = 0;
+        for (const auto &step : steps) {
+            ASSERT_EQ(step.getStepCount(), step_index);
+            checkFrame(step.getAgent(AGENT_NAME1), step_index);
+            ++step_index;
+        }
+    }
+    {  // Check exit log, should match final step log
+        const auto &exit = sim.getRunLog().getExitLog();
+        ASSERT_EQ(exit.getStepCount(), 5u);
+        checkFrame(exit.getAgent(AGENT_NAME1), 5u);
+    }
+}
 TEST(LoggingTest, CUDAEnsembleSimulate) {
     /**
      * Ensure the expected data is logged when CUDAEnsemble::simulate() is called
@@ -0,0 +1,239 @@
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+// If earlier than VS 2019
+#if defined(_MSC_VER) && _MSC_VER < 1920
+#include <filesystem>
+using std::tr2::sys::exists;
+using std::tr2::sys::path;
+using std::tr2::sys::remove;
+#else
+// VS2019 requires this macro, as building pre c++17 cant use std::filesystem
+#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
+#include <experimental/filesystem>
+using std::experimental::filesystem::v1::exists;
+using std::experimental::filesystem::v1::path;
+using std::experimental::filesystem::v1::remove;
+#endif
+#include "gtest/gtest.h"
+
+#include "flamegpu/flamegpu.h"
+#include "flamegpu/io/LoggerFactory.h"
+#include "flamegpu/io/StepLogStreamWriter.h"
+
+namespace flamegpu {
+
+
+namespace test_step_log_stream {
+const char *MODEL_NAME = "Model";
+const char *AGENT_NAME = "Agent";
+const char *FUNCTION_NAME = "Function";
+
+FLAMEGPU_AGENT_FUNCTION(agent_fn, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<int>("x", FLAMEGPU->getVariable<int>("x") + 1);
+    return ALIVE;
+}
+StepLogFrame makeFrame(unsigned int step) {
+    std::map<std::string, util::Any> environment;
+    environment.emplace("prop", util::Any(static_cast<int>(step * 2)));
+    std::map<util::StringPair, std::pair<std::map<LoggingConfig::NameReductionFn, util::Any>, unsigned int>> agents;
+    return StepLogFrame(std::move(environment), std::move(agents), step);
+}
+std::string readFile(const std::string &file_path) {
+    std::ifstream in(file_path, std::ifstream::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+unsigned int countOccurrences(const std::string &haystack, const std::string &needle) {
+    unsigned int count = 0;
+    for (size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + needle.size()))
+        ++count;
+    return count;
+}
+/**
+ * Writes frames [0, 4) without closing the stream, and then appends a partially written frame as though the writer had crashed
+ */
+void writeCrashedLog(const std::string &file_path, const std::string &partial_frame) {
+    RunLog log;
+    {
+        auto writer = io::LoggerFactory::createStepLogStreamWriter(file_path, true, true, 1);
+        writer->open(log, false);
+        for (unsigned int i = 0; i < 4; ++i)
+            writer->writeStep(makeFrame(i));
+    }
+    std::ofstream out(file_path, std::ofstream::binary | std::ofstream::app);
+    out << partial_frame;
+}
+/**
+ * Resumes a log written by writeCrashedLog(), and writes frames [0, 6)
+ */
+void resumeCrashedLog(const std::string &file_path) {
+    RunLog log;
+    auto writer = io::LoggerFactory::createStepLogStreamWriter(file_path, true, false, 1);
+    writer->open(log, false, true);
+    EXPECT_TRUE(writer->isResumed());
+    EXPECT_EQ(writer->getResumedStepIndex(), 3u);
+    EXPECT_EQ(writer->getFrameCount(), 4u);
+    for (unsigned int i = 0; i < 6; ++i)
+        writer->writeStep(makeFrame(i));
+    EXPECT_EQ(writer->getFrameCount(), 6u);
+    writer->close();
+}
+}  // namespace test_step_log_stream
+
+using test_step_log_stream::makeFrame;
+using test_step_log_stream::readFile;
+using test_step_log_stream::countOccurrences;
+
+TEST(StepLogStreamTest, FlushFrequency) {
+    const std::string file_path = "stream_step.json";
+    ASSERT_FALSE(::exists(file_path));
+    RunLog log;
+    auto writer = io::LoggerFactory::createStepLogStreamWriter(file_path, true, true, 2);
+    writer->open(log, false);
+    EXPECT_TRUE(writer->isOpen());
+    EXPECT_FALSE(writer->isResumed());
+    // Header is written immediately
+    EXPECT_NE(readFile(file_path).find("\"steps\": ["), std::string::npos);
+    // Frames are only written once the flush frequency is reached
+    writer->writeStep(makeFrame(0));
+    EXPECT_EQ(countOccurrences(readFile(file_path), "\"step_index\""), 0u);
+    writer->writeStep(makeFrame(1));
+    EXPECT_EQ(countOccurrences(readFile(file_path), "\"step_index\""), 2u);
+    writer->writeStep(makeFrame(2));
+    EXPECT_EQ(countOccurrences(readFile(file_path), "\"step_index\""), 2u);
+    writer->flush();
+    EXPECT_EQ(countOccurrences(readFile(file_path), "\"step_index\""), 3u);
+    writer->close();
+    EXPECT_FALSE(writer->isOpen());
+    const std::string output = readFile(file_path);
+    EXPECT_EQ(countOccurrences(output, "\"step_index\""), 3u);
+    EXPECT_NE(output.find("{\"step_index\":2,\"environment\":{\"prop\":4}}"), std::string::npos);
+    EXPECT_EQ(output.substr(output.size() - 6), "\n\t]\n}\n");
+    EXPECT_THROW(writer->writeStep(makeFrame(3)), exception::InvalidOperation);
+    ASSERT_TRUE(::remove(file_path));
+}
+TEST(StepLogStreamTest, ResumeJSON) {
+    const std::string file_path = "stream_step.json";
+    ASSERT_FALSE(::exists(file_path));
+    test_step_log_stream::writeCrashedLog(file_path, ",\n\t\t{\"step_index\":4,\"envir");
+    test_step_log_stream::resumeCrashedLog(file_path);
+    const std::string output = readFile(file_path);
+    // Partial frame has been discarded, and frames are not duplicated
+    EXPECT_EQ(output.find("envir\n"), std::string::npos);
+    EXPECT_EQ(countOccurrences(output, "\"step_index\""), 6u);
+    for (unsigned int i = 0; i < 6; ++i)
+        EXPECT_EQ(countOccurrences(output, "\"step_index\":" + std::to_string(i) + ","), 1u);
+    EXPECT_EQ(countOccurrences(output, "\"steps\""), 1u);
+    EXPECT_EQ(output.substr(output.size() - 6), "\n\t]\n}\n");
+    ASSERT_TRUE(::remove(file_path));
+}
+TEST(StepLogStreamTest, ResumeXML) {
+    const std::string file_path = "stream_step.xml";
+    ASSERT_FALSE(::exists(file_path));
+    test_step_log_stream::writeCrashedLog(file_path, "\n        <step><step_index>4</step_index><env");
+    test_step_log_stream::resumeCrashedLog(file_path);
+    const std::string output = readFile(file_path);
+    EXPECT_EQ(output.find("<env\n"), std::string::npos);
+    EXPECT_EQ(countOccurrences(output, "<step_index>"), 6u);
+    for (unsigned int i = 0; i < 6; ++i)
+        EXPECT_EQ(countOccurrences(output, "<step_index>" + std::to_string(i) + "</step_index>"), 1u);
+    EXPECT_EQ(countOccurrences(output, "<steps>"), 1u);
+    EXPECT_EQ(output.substr(output.size() - 7), "</log>\n");
+    ASSERT_TRUE(::remove(file_path));
+}
+TEST(StepLogStreamTest, ResumeMissingFile) {
+    // Resuming a file which does not exist, starts a new log
+    const std::string file_path = "stream_step.json";
+    ASSERT_FALSE(::exists(file_path));
+    RunLog log;
+    auto writer = io::LoggerFactory::createStepLogStreamWriter(file_path, false, true, 1);
+    writer->open(log, false, true);
+    EXPECT_FALSE(writer->isResumed());
+    EXPECT_EQ(writer->getFrameCount(), 0u);
+    writer->writeStep(makeFrame(0));
+    writer->close();
+    const std::string output = readFile(file_path);
+    EXPECT_EQ(countOccurrences(output, "\"step_index\""), 1u);
+    EXPECT_EQ(output.substr(output.size() - 4), "\n]}\n");
+    ASSERT_TRUE(::remove(file_path));
+}
+TEST(StepLogStreamTest, NoTruncate) {
+    // An existing file is only appended to when resumed, otherwise it would contain two headers
+    const std::string file_path = "stream_step.json";
+    ASSERT_FALSE(::exists(file_path));
+    RunLog log;
+    {
+        auto writer = io::LoggerFactory::createStepLogStreamWriter(file_path, false, true, 1);
+        writer->open(log, false);
+        writer->writeStep(makeFrame(0));
+        writer->close();
+    }
+    const std::string output = readFile(file_path);
+    auto writer = io::LoggerFactory::createStepLogStreamWriter(file_path, false, false, 1);
+    EXPECT_THROW(writer->open(log, false), exception::InvalidFilePath);
+    EXPECT_FALSE(writer->isOpen());
+    EXPECT_EQ(readFile(file_path), output);
+    // Truncating replaces the existing log
+    writer = io::LoggerFactory::createStepLogStreamWriter(file_path, false, true, 1);
+    writer->open(log, false);
+    writer->writeStep(makeFrame(1));
+    writer->close();
+    const std::string truncated = readFile(file_path);
+    EXPECT_EQ(countOccurrences(truncated, "\"steps\""), 1u);
+    EXPECT_EQ(countOccurrences(truncated, "\"step_index\""), 1u);
+    EXPECT_NE(truncated.find("\"step_index\":1,"), std::string::npos);
+    ASSERT_TRUE(::remove(file_path));
+}
+TEST(StepLogStreamTest, UnsupportedFileType) {
+    EXPECT_THROW(io::LoggerFactory::createStepLogStreamWriter("stream_step.csv", true), exception::UnsupportedFileType);
+}
+TEST(StepLogStreamTest, CUDASimulationStream) {
+    const std::string step_file = "stream_step.json";
+    const std::string common_file = "stream_common.json";
+    ASSERT_FALSE(::exists(step_file));
+    ASSERT_FALSE(::exists(common_file));
+    ModelDescription m(test_step_log_stream::MODEL_NAME);
+    AgentDescription &a = m.newAgent(test_step_log_stream::AGENT_NAME);
+    a.newVariable<int>("x", 0);
+    m.newLayer().addAgentFunction(a.newFunction(test_step_log_stream::FUNCTION_NAME, test_step_log_stream::agent_fn));
+    StepLoggingConfig slcfg(m);
+    slcfg.agent(test_step_log_stream::AGENT_NAME).logSum<int>("x");
+    AgentVector pop(a, 10);
+    CUDASimulation sim(m);
+    sim.SimulationConfig().steps = 10;
+    sim.SimulationConfig().step_log_file = step_file;
+    sim.SimulationConfig().stream_step_log = true;
+    sim.SimulationConfig().step_log_flush_frequency = 4;
+    sim.setStepLog(slcfg);
+    sim.setPopulationData(pop);
+    sim.simulate();
+    // Streamed frames are not retained
+    EXPECT_EQ(sim.getRunLog().getStepLog().size(), 0u);
+    std::string output = readFile(step_file);
+    EXPECT_EQ(countOccurrences(output, "\"step_index\""), 11u);
+    EXPECT_NE(output.find("{\"step_index\":10,\"agents\":{\"Agent\":{\"default\":{\"variables\":{\"x\":{\"sum\":100}}}}}}"), std::string::npos);
+    // Header is indented by default
+    EXPECT_EQ(output.substr(output.size() - 6), "\n\t]\n}\n");
+    // Frames are retained if they are also required by the common log
+    sim.SimulationConfig().common_log_file = common_file;
+    sim.setPopulationData(pop);
+    sim.simulate();
+    EXPECT_EQ(sim.getRunLog().getStepLog().size(), 11u);
+    output = readFile(step_file);
+    EXPECT_EQ(countOccurrences(output, "\"step_index\""), 11u);
+    // Pretty print can be disabled
+    sim.SimulationConfig().step_log_pretty_print = false;
+    sim.setPopulationData(pop);
+    sim.simulate();
+    output = readFile(step_file);
+    EXPECT_EQ(countOccurrences(output, "\"step_index\""), 11u);
+    EXPECT_EQ(output.substr(output.size() - 4), "\n]}\n");
+    ASSERT_TRUE(::remove(step_file));
+    ASSERT_TRUE(::remove(common_file));
+}
+
+}  // namespace flamegpu
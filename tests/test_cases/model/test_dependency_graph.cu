@@ -561,5 +561,70 @@ TEST(DependencyGraphTest, ModelAlreadyHasLayers) {
 
     EXPECT_THROW(_m.generateLayers(), exception::InvalidDependencyGraph);
 }
+TEST(DependencyGraphTest, CorrectLayersPackIntoEarlierLayer) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME1, agent_fn2);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn3);
+    AgentFunctionDescription &f3 = a2.newFunction(FUNCTION_NAME3, agent_fn4);
+    // f and f2 share a state so conflict, f3 can share the layer created for f2
+    f3.dependsOn(f);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    graph.addRoot(f);
+    graph.addRoot(f2);
+    _m.generateLayers();
+    std::string expectedLayers = R"###(--------------------
+Layer 0
+--------------------
+Function1
+
+--------------------
+Layer 1
+--------------------
+Function2
+Function3
+
+)###";
+    EXPECT_EQ(expectedLayers, graph.getConstructedLayersString());
+    EXPECT_EQ(_m.getLayersCount(), 2u);
+}
+TEST(DependencyGraphTest, CorrectLayersDiamondChain) {
+    // A chain of diamonds has 2^DIAMONDS paths from the root, so the graph must not be walked per path
+    const unsigned int DIAMONDS = 64;
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentDescription &a2 = _m.newAgent(AGENT_NAME2);
+    AgentFunctionDescription *top = &a.newFunction("top0", agent_fn2);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    graph.addRoot(*top);
+    for (unsigned int i = 0; i < DIAMONDS; ++i) {
+        AgentFunctionDescription &left = a.newFunction("left" + std::to_string(i), agent_fn2);
+        AgentFunctionDescription &right = a2.newFunction("right" + std::to_string(i), agent_fn2);
+        AgentFunctionDescription &bottom = a.newFunction("top" + std::to_string(i + 1), agent_fn2);
+        left.dependsOn(*top);
+        right.dependsOn(*top);
+        bottom.dependsOn(left, right);
+        top = &bottom;
+    }
+    EXPECT_TRUE(graph.validateDependencyGraph());
+    _m.generateLayers();
+    // left and right belong to different agents, so share a layer
+    EXPECT_EQ(_m.getLayersCount(), 2 * DIAMONDS + 1);
+}
+TEST(DependencyGraphTest, ValidateCycleBelowDiamond) {
+    ModelDescription _m(MODEL_NAME);
+    AgentDescription &a = _m.newAgent(AGENT_NAME);
+    AgentFunctionDescription &f = a.newFunction(FUNCTION_NAME1, agent_fn1);
+    AgentFunctionDescription &f2 = a.newFunction(FUNCTION_NAME2, agent_fn2);
+    AgentFunctionDescription &f3 = a.newFunction(FUNCTION_NAME3, agent_fn3);
+    AgentFunctionDescription &f4 = a.newFunction(FUNCTION_NAME4, agent_fn4);
+    f2.dependsOn(f);
+    f3.dependsOn(f, f4);
+    f4.dependsOn(f2, f3);
+    DependencyGraph& graph = _m.getDependencyGraph();
+    graph.addRoot(f);
+    EXPECT_THROW(graph.validateDependencyGraph(), exception::InvalidDependencyGraph);
+}
 }  // namespace test_dependency_graph
 }  // namespace flamegpu
@@ -342,6 +342,71 @@ TEST(AgentVectorTest, data) {
     EXPECT_THROW(pop.data<unsigned int>("int"), exception::InvalidVarType);
     EXPECT_THROW(pop.data<int64_t>("int"), exception::InvalidVarType);
 }
+TEST(AgentVectorTest, column) {
+    const unsigned int POP_SIZE = 10;
+    // Test correctness of AgentVector column()
+    ModelDescription model("model");
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newVariable<int>("int", 1);
+    agent.newVariable<float, 3>("float3", {1.0f, 2.0f, 3.0f});
+
+    AgentVector pop(agent, POP_SIZE);
+    const AgentVector &cpop = pop;
+    AgentVector::Column<int> col = pop.column<int>("int");
+    ASSERT_EQ(col.size(), POP_SIZE);
+    ASSERT_EQ(col.getAgentCount(), POP_SIZE);
+    ASSERT_EQ(col.getElements(), 1u);
+    EXPECT_EQ(col.getVariableName(), "int");
+    for (unsigned int i = 0; i < POP_SIZE; ++i) {
+        EXPECT_EQ(col[i], 1);
+    }
+    // Bulk operations
+    col.generate([](unsigned int i) { return static_cast<int>(i); });
+    col.transform(2, 6, [](const int &v) { return v * 10; });
+    col.fill(8, POP_SIZE, 5);
+    const int expected[POP_SIZE] = {0, 1, 20, 30, 40, 50, 6, 7, 5, 5};
+    for (unsigned int i = 0; i < POP_SIZE; ++i) {
+        EXPECT_EQ(pop[i].getVariable<int>("int"), expected[i]);
+    }
+    col.copyFrom(std::vector<int>{-1, -2}, 1);
+    int *raw = col.data(9, 10);
+    raw[0] = -9;
+    AgentVector::CColumn<int> ccol = cpop.column<int>("int");
+    EXPECT_EQ(ccol.toVector(), (std::vector<int>{0, -1, -2, 30, 40, 50, 6, 7, 5, -9}));
+    int out[2];
+    ccol.copyTo(out, 2, 3);
+    EXPECT_EQ(out[0], 30);
+    EXPECT_EQ(out[1], 40);
+    // Array variables are stored agent-major
+    AgentVector::Column<float> col3 = pop.column<float>("float3");
+    ASSERT_EQ(col3.size(), POP_SIZE * 3);
+    ASSERT_EQ(col3.getElements(), 3u);
+    col3.copyFrom(std::vector<float>{4.0f, 5.0f, 6.0f}, 3);
+    const bool array_eq = pop[1].getVariable<float, 3>("float3") == std::array<float, 3>{4.0f, 5.0f, 6.0f};
+    EXPECT_TRUE(array_eq);
+    EXPECT_EQ(col3.at(2), 3.0f);
+
+    // Empty returns an empty column
+    AgentVector empty_pop(agent);
+    EXPECT_EQ(empty_pop.column<int>("int").size(), 0u);
+    EXPECT_EQ(empty_pop.column<int>("int").data(), nullptr);
+
+    // Out of bounds
+    EXPECT_THROW(ccol.at(POP_SIZE), exception::OutOfBoundsException);
+    EXPECT_THROW(col.fill(5, POP_SIZE + 1, 0), exception::OutOfBoundsException);
+    EXPECT_THROW(col.fill(5, 4, 0), exception::OutOfBoundsException);
+    EXPECT_THROW(col.copyFrom(std::vector<int>(3), POP_SIZE - 2), exception::OutOfBoundsException);
+    EXPECT_THROW(col.data(0, POP_SIZE + 1), exception::OutOfBoundsException);
+    // Invalid exception::InvalidAgentVar
+    EXPECT_THROW(pop.column<int>("int12"), exception::InvalidAgentVar);
+    EXPECT_THROW(cpop.column<int>("int12"), exception::InvalidAgentVar);
+    // Invalid exception::InvalidVarType
+    EXPECT_THROW(pop.column<float>("int"), exception::InvalidVarType);
+    EXPECT_THROW(cpop.column<int64_t>("int"), exception::InvalidVarType);
+    // Internal variables can only be viewed
+    EXPECT_THROW(pop.column<id_t>("_id"), exception::ReservedName);
+    EXPECT_EQ(cpop.column<id_t>("_id").size(), POP_SIZE);
+}
 TEST(AgentVectorTest, iterator) {
     const unsigned int POP_SIZE = 10;
     // Test correctness of AgentVector array iterator, and the member functions for creating them.
@@ -111,6 +111,52 @@ TEST(DeviceAgentVectorTest, SetGetHalf) {
         }
     }
 }
+FLAMEGPU_STEP_FUNCTION(ColumnDisjoint) {
+    DeviceAgentVector av = FLAMEGPU->agent(AGENT_NAME).getPopulationData();
+    AgentVector::Column<int> col = av.column<int>("int");
+    // Update the first and last agents, the agents between are not changed
+    col.transform(0, 2, [](const int &v) { return v + 12; });
+    col.fill(col.size() - 2, col.size(), -1);
+    // Only the changed ranges are copied back to the device
+    const std::vector<util::detail::DirtyRangeSet::Range> ranges = av.getChangedRanges("int");
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0], util::detail::DirtyRangeSet::Range(0, 2));
+    EXPECT_EQ(ranges[1], util::detail::DirtyRangeSet::Range(col.size() - 2, col.size()));
+    EXPECT_TRUE(av.getChangedRanges("float").empty());
+}
+TEST(DeviceAgentVectorTest, ColumnDisjoint) {
+    // Initialise an agent population with values in a variable [0,1,2..N]
+    // Inside a step function, update two disjoint ranges of agents via a column view
+    // Check that only those ranges of the changed variable are marked to be copied back to the device
+    // After model completion, retrieve the agent population and check only those ranges have changed
+    ModelDescription model(MODEL_NAME);
+    AgentDescription& agent = model.newAgent(AGENT_NAME);
+    agent.newVariable<int>("int", 0);
+    agent.newVariable<float>("float", 1.0f);
+    model.addStepFunction(ColumnDisjoint);
+
+    // Init agent pop
+    AgentVector av(agent, AGENT_COUNT);
+    av.column<int>("int").generate([](unsigned int i) { return static_cast<int>(i); });
+
+    // Create and step simulation
+    CUDASimulation sim(model);
+    sim.setPopulationData(av);
+    sim.step();
+
+    // Retrieve and validate agents match
+    sim.getPopulationData(av);
+    ASSERT_EQ(av.size(), AGENT_COUNT);
+    for (unsigned int i = 0; i < AGENT_COUNT; ++i) {
+        if (i < 2) {
+            ASSERT_EQ(av[i].getVariable<int>("int"), static_cast<int>(i) + 12);
+        } else if (i >= AGENT_COUNT - 2) {
+            ASSERT_EQ(av[i].getVariable<int>("int"), -1);
+        } else {
+            ASSERT_EQ(av[i].getVariable<int>("int"), static_cast<int>(i));
+        }
+    }
+}
 FLAMEGPU_AGENT_FUNCTION(MasterIncrement, MessageNone, MessageNone) {
     FLAMEGPU->setVariable<unsigned int>("uint", FLAMEGPU->getVariable<unsigned int>("uint") + 1);
     return ALIVE;
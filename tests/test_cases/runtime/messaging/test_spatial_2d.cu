@@ -4,6 +4,10 @@
 * Tests cover:
 * > mandatory messaging, send/recieve
 */
+#include <algorithm>
+#include <array>
+#include <map>
+
 #include "flamegpu/flamegpu.h"
 
 #include "gtest/gtest.h"
@@ -497,6 +501,139 @@ TEST(Spatial2DMessageTest, ReadEmpty) {
     EXPECT_EQ(pop_out.size(), 1u);
     EXPECT_EQ(pop_out[0].getVariable<unsigned int>("count"), 0u);
 }
+/**
+ * Builds a model which outputs a message from every agent, then counts the messages within each agent's Moore neighbourhood
+ * Bins are 1 unit wide, with the environment minimum bound at the origin
+ */
+void buildSparseModel2D(ModelDescription &model, const float max[2], const bool sparse) {
+    {   // Location message
+        MessageSpatial2D::Description &message = model.newMessage<MessageSpatial2D>("location");
+        message.setMin(0, 0);
+        message.setMax(max[0], max[1]);
+        message.setRadius(1);
+        message.setSparse(sparse);
+        message.newVariable<int>("id");
+    }
+    {   // Circle agent
+        AgentDescription &agent = model.newAgent("agent");
+        agent.newVariable<int>("id");
+        agent.newVariable<float>("x");
+        agent.newVariable<float>("y");
+        agent.newVariable<unsigned int>("count");
+        agent.newVariable<unsigned int>("badCount");
+        agent.newFunction("out", out_mandatory2D).setMessageOutput("location");
+        agent.newFunction("in", in2D).setMessageInput("location");
+    }
+    model.newLayer().addAgentFunction(out_mandatory2D);
+    model.newLayer().addAgentFunction(in2D);
+}
+TEST(Spatial2DMessageTest, Sparse) {
+    ModelDescription model("Spatial2DMessageTestModel");
+    MessageSpatial2D::Description &message = model.newMessage<MessageSpatial2D>("location");
+    EXPECT_FALSE(message.getSparse());
+    message.setSparse(true);
+    EXPECT_TRUE(message.getSparse());
+    message.setSparse(false);
+    EXPECT_FALSE(message.getSparse());
+}
+TEST(Spatial2DMessageTest, SparseMatchesDense) {
+    // Sparse and dense partitioning should return the same messages to every agent
+    const float ENV_MAX[2] = {40, 25};
+    const unsigned int AGENT_COUNT = 2049;
+    ModelDescription dense_model("Spatial2DMessageTestModel");
+    buildSparseModel2D(dense_model, ENV_MAX, false);
+    ModelDescription sparse_model("Spatial2DMessageTestModel");
+    buildSparseModel2D(sparse_model, ENV_MAX, true);
+    AgentVector population(dense_model.Agent("agent"), AGENT_COUNT);
+    {
+        // Half the agents are spread over the environment, the remainder are clustered near a corner
+        std::default_random_engine rng;
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        for (unsigned int i = 0; i < AGENT_COUNT; i++) {
+            const float scale = i % 2 ? 1.0f : 0.2f;
+            AgentVector::Agent instance = population[i];
+            instance.setVariable<int>("id", i);
+            instance.setVariable<float>("x", dist(rng) * ENV_MAX[0] * scale);
+            instance.setVariable<float>("y", dist(rng) * ENV_MAX[1] * scale);
+        }
+    }
+    AgentVector dense_out(dense_model.Agent("agent"));
+    AgentVector sparse_out(sparse_model.Agent("agent"));
+    {
+        CUDASimulation cudaSimulation(dense_model);
+        cudaSimulation.setPopulationData(population);
+        cudaSimulation.step();
+        cudaSimulation.getPopulationData(dense_out);
+    }
+    {
+        CUDASimulation cudaSimulation(sparse_model);
+        cudaSimulation.setPopulationData(population);
+        // Run multiple steps, so that the sparse table is rebuilt
+        cudaSimulation.step();
+        cudaSimulation.step();
+        cudaSimulation.getPopulationData(sparse_out);
+    }
+    ASSERT_EQ(dense_out.size(), AGENT_COUNT);
+    ASSERT_EQ(sparse_out.size(), AGENT_COUNT);
+    std::unordered_map<int, unsigned int> dense_counts;
+    for (AgentVector::Agent ai : dense_out) {
+        dense_counts.emplace(ai.getVariable<int>("id"), ai.getVariable<unsigned int>("count"));
+        EXPECT_EQ(ai.getVariable<unsigned int>("badCount"), 0u);
+    }
+    for (AgentVector::Agent ai : sparse_out) {
+        EXPECT_EQ(ai.getVariable<unsigned int>("count"), dense_counts.at(ai.getVariable<int>("id")));
+        EXPECT_EQ(ai.getVariable<unsigned int>("badCount"), 0u);
+    }
+}
+TEST(Spatial2DMessageTest, SparseLargeEnvironment) {
+    // 2.5 billion bins, too many for a dense PBM
+    const float ENV_MAX[2] = {50000, 50000};
+    const unsigned int AGENT_COUNT = 1024;
+    ModelDescription model("Spatial2DMessageTestModel");
+    buildSparseModel2D(model, ENV_MAX, true);
+    AgentVector population(model.Agent("agent"), AGENT_COUNT);
+    // Agents are grouped within a small number of clusters, count the agents within each bin
+    std::map<std::array<int, 2>, unsigned int> bin_counts;
+    {
+        const int clusters[4][2] = {{1, 1}, {25000, 25000}, {49997, 49998}, {0, 49999}};
+        std::default_random_engine rng;
+        std::uniform_int_distribution<int> offset(-3, 3);
+        // Agents are kept away from bin boundaries, so that rounding cannot place them in a different bin to that expected
+        std::uniform_real_distribution<float> dist(0.25f, 0.75f);
+        for (unsigned int i = 0; i < AGENT_COUNT; i++) {
+            const int *c = clusters[i % 4];
+            float pos[2];
+            for (int axis = 0; axis < 2; ++axis) {
+                const int bin = std::min(std::max(c[axis] + offset(rng), 0), static_cast<int>(ENV_MAX[axis]) - 1);
+                pos[axis] = static_cast<float>(bin) + dist(rng);
+            }
+            AgentVector::Agent instance = population[i];
+            instance.setVariable<int>("id", i);
+            instance.setVariable<float>("x", pos[0]);
+            instance.setVariable<float>("y", pos[1]);
+            ++bin_counts[{static_cast<int>(pos[0]), static_cast<int>(pos[1])}];
+        }
+    }
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.setPopulationData(population);
+    cudaSimulation.step();
+    cudaSimulation.getPopulationData(population);
+    for (AgentVector::Agent ai : population) {
+        const int bin[2] = {
+            static_cast<int>(ai.getVariable<float>("x")),
+            static_cast<int>(ai.getVariable<float>("y"))
+        };
+        unsigned int expected = 0;
+        for (int x = -1; x <= 1; ++x) {
+            for (int y = -1; y <= 1; ++y) {
+                const auto it = bin_counts.find({bin[0] + x, bin[1] + y});
+                expected += it == bin_counts.end() ? 0 : it->second;
+            }
+        }
+        EXPECT_EQ(ai.getVariable<unsigned int>("count"), expected);
+        EXPECT_EQ(ai.getVariable<unsigned int>("badCount"), 0u);
+    }
+}
 
 FLAMEGPU_AGENT_FUNCTION(ArrayOut, MessageNone, MessageSpatial2D) {
     const unsigned int x = FLAMEGPU->getVariable<unsigned int, 2>("index", 0);
@@ -4,6 +4,10 @@
 * Tests cover:
 * > mandatory messaging, send/recieve
 */
+#include <algorithm>
+#include <array>
+#include <map>
+
 #include "flamegpu/flamegpu.h"
 
 #include "gtest/gtest.h"
@@ -544,6 +548,186 @@ TEST(Spatial3DMessageTest, ReadEmpty) {
 }
 
 
+/**
+ * Builds a model which outputs a message from every agent, then counts the messages within each agent's Moore neighbourhood
+ * Bins are 1 unit wide, with the environment minimum bound at the origin
+ */
+void buildSparseModel3D(ModelDescription &model, const float max[3], const bool sparse) {
+    {   // Location message
+        MessageSpatial3D::Description &message = model.newMessage<MessageSpatial3D>("location");
+        message.setMin(0, 0, 0);
+        message.setMax(max[0], max[1], max[2]);
+        message.setRadius(1);
+        message.setSparse(sparse);
+        message.newVariable<int>("id");
+    }
+    {   // Circle agent
+        AgentDescription &agent = model.newAgent("agent");
+        agent.newVariable<int>("id");
+        agent.newVariable<float>("x");
+        agent.newVariable<float>("y");
+        agent.newVariable<float>("z");
+        agent.newVariable<unsigned int>("count");
+        agent.newVariable<unsigned int>("badCount");
+        agent.newFunction("out", out_mandatory3D).setMessageOutput("location");
+        agent.newFunction("in", in3D).setMessageInput("location");
+    }
+    model.newLayer().addAgentFunction(out_mandatory3D);
+    model.newLayer().addAgentFunction(in3D);
+}
+TEST(Spatial3DMessageTest, Sparse) {
+    ModelDescription model("Spatial3DMessageTestModel");
+    MessageSpatial3D::Description &message = model.newMessage<MessageSpatial3D>("location");
+    EXPECT_FALSE(message.getSparse());
+    message.setSparse(true);
+    EXPECT_TRUE(message.getSparse());
+    message.setSparse(false);
+    EXPECT_FALSE(message.getSparse());
+}
+TEST(Spatial3DMessageTest, SparseMatchesDense) {
+    // Sparse and dense partitioning should return the same messages to every agent
+    const float ENV_MAX[3] = {20, 15, 10};
+    const unsigned int AGENT_COUNT = 2049;
+    ModelDescription dense_model("Spatial3DMessageTestModel");
+    buildSparseModel3D(dense_model, ENV_MAX, false);
+    ModelDescription sparse_model("Spatial3DMessageTestModel");
+    buildSparseModel3D(sparse_model, ENV_MAX, true);
+    AgentVector population(dense_model.Agent("agent"), AGENT_COUNT);
+    {
+        // Half the agents are spread over the environment, the remainder are clustered near a corner
+        std::default_random_engine rng;
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        for (unsigned int i = 0; i < AGENT_COUNT; i++) {
+            const float scale = i % 2 ? 1.0f : 0.2f;
+            AgentVector::Agent instance = population[i];
+            instance.setVariable<int>("id", i);
+            instance.setVariable<float>("x", dist(rng) * ENV_MAX[0] * scale);
+            instance.setVariable<float>("y", dist(rng) * ENV_MAX[1] * scale);
+            instance.setVariable<float>("z", dist(rng) * ENV_MAX[2] * scale);
+        }
+    }
+    AgentVector dense_out(dense_model.Agent("agent"));
+    AgentVector sparse_out(sparse_model.Agent("agent"));
+    {
+        CUDASimulation cudaSimulation(dense_model);
+        cudaSimulation.setPopulationData(population);
+        cudaSimulation.step();
+        cudaSimulation.getPopulationData(dense_out);
+    }
+    {
+        CUDASimulation cudaSimulation(sparse_model);
+        cudaSimulation.setPopulationData(population);
+        // Run multiple steps, so that the sparse table is rebuilt
+        cudaSimulation.step();
+        cudaSimulation.step();
+        cudaSimulation.getPopulationData(sparse_out);
+    }
+    ASSERT_EQ(dense_out.size(), AGENT_COUNT);
+    ASSERT_EQ(sparse_out.size(), AGENT_COUNT);
+    std::unordered_map<int, unsigned int> dense_counts;
+    for (AgentVector::Agent ai : dense_out) {
+        dense_counts.emplace(ai.getVariable<int>("id"), ai.getVariable<unsigned int>("count"));
+        EXPECT_EQ(ai.getVariable<unsigned int>("badCount"), 0u);
+    }
+    for (AgentVector::Agent ai : sparse_out) {
+        EXPECT_EQ(ai.getVariable<unsigned int>("count"), dense_counts.at(ai.getVariable<int>("id")));
+        EXPECT_EQ(ai.getVariable<unsigned int>("badCount"), 0u);
+    }
+}
+TEST(Spatial3DMessageTest, SparseLargeEnvironment) {
+    // 2 billion bins, too many for a dense PBM
+    const float ENV_MAX[3] = {2000, 2000, 500};
+    const unsigned int AGENT_COUNT = 1024;
+    ModelDescription model("Spatial3DMessageTestModel");
+    buildSparseModel3D(model, ENV_MAX, true);
+    AgentVector population(model.Agent("agent"), AGENT_COUNT);
+    // Agents are grouped within a small number of clusters, count the agents within each bin
+    std::map<std::array<int, 3>, unsigned int> bin_counts;
+    {
+        const int clusters[4][3] = {{1, 1, 1}, {1000, 1000, 250}, {1997, 1998, 499}, {0, 1999, 0}};
+        std::default_random_engine rng;
+        std::uniform_int_distribution<int> offset(-2, 2);
+        // Agents are kept away from bin boundaries, so that rounding cannot place them in a different bin to that expected
+        std::uniform_real_distribution<float> dist(0.25f, 0.75f);
+        for (unsigned int i = 0; i < AGENT_COUNT; i++) {
+            const int *c = clusters[i % 4];
+            float pos[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                const int bin = std::min(std::max(c[axis] + offset(rng), 0), static_cast<int>(ENV_MAX[axis]) - 1);
+                pos[axis] = static_cast<float>(bin) + dist(rng);
+            }
+            AgentVector::Agent instance = population[i];
+            instance.setVariable<int>("id", i);
+            instance.setVariable<float>("x", pos[0]);
+            instance.setVariable<float>("y", pos[1]);
+            instance.setVariable<float>("z", pos[2]);
+            ++bin_counts[{static_cast<int>(pos[0]), static_cast<int>(pos[1]), static_cast<int>(pos[2])}];
+        }
+    }
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.setPopulationData(population);
+    cudaSimulation.step();
+    cudaSimulation.getPopulationData(population);
+    for (AgentVector::Agent ai : population) {
+        const int bin[3] = {
+            static_cast<int>(ai.getVariable<float>("x")),
+            static_cast<int>(ai.getVariable<float>("y")),
+            static_cast<int>(ai.getVariable<float>("z"))
+        };
+        unsigned int expected = 0;
+        for (int x = -1; x <= 1; ++x) {
+            for (int y = -1; y <= 1; ++y) {
+                for (int z = -1; z <= 1; ++z) {
+                    const auto it = bin_counts.find({bin[0] + x, bin[1] + y, bin[2] + z});
+                    expected += it == bin_counts.end() ? 0 : it->second;
+                }
+            }
+        }
+        EXPECT_EQ(ai.getVariable<unsigned int>("count"), expected);
+        EXPECT_EQ(ai.getVariable<unsigned int>("badCount"), 0u);
+    }
+}
+TEST(Spatial3DMessageTest, SparseReadEmpty) {
+    ModelDescription model("Model");
+    {   // Location message
+        MessageSpatial3D::Description &message = model.newMessage<MessageSpatial3D>("location");
+        message.setMin(-3, -3, -3);
+        message.setMax(3, 3, 3);
+        message.setRadius(2);
+        message.setSparse(true);
+        message.newVariable<int>("id");  // unused by current test
+    }
+    {   // Circle agent
+        AgentDescription &agent = model.newAgent("agent");
+        agent.newVariable<unsigned int>("count", 0);  // Count the number of messages read
+        agent.newFunction("in", count3D).setMessageInput("location");
+    }
+    {   // Layer #1
+        LayerDescription &layer = model.newLayer();
+        layer.addAgentFunction(count3D);
+    }
+    // Create 1 agent
+    AgentVector pop_in(model.Agent("agent"), 1);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.setPopulationData(pop_in);
+    // Execute model
+    EXPECT_NO_THROW(cudaSimulation.step());
+    // Check result
+    AgentVector pop_out(model.Agent("agent"), 1);
+    pop_out[0].setVariable<unsigned int>("count", 1);
+    cudaSimulation.getPopulationData(pop_out);
+    EXPECT_EQ(pop_out.size(), 1u);
+    EXPECT_EQ(pop_out[0].getVariable<unsigned int>("count"), 0u);
+}
+TEST(Spatial3DMessageTest, SparseTooManyBins) {
+    // Sparse bin indices are limited to 32 bits
+    const float ENV_MAX[3] = {10000, 10000, 100};
+    ModelDescription model("Spatial3DMessageTestModel");
+    buildSparseModel3D(model, ENV_MAX, true);
+    EXPECT_THROW(CUDASimulation cudaSimulation(model), exception::InvalidMessage);
+}
+
+
 
 FLAMEGPU_AGENT_FUNCTION(ArrayOut, MessageNone, MessageSpatial3D) {
     const unsigned int x = FLAMEGPU->getVariable<unsigned int, 3>("index", 0);
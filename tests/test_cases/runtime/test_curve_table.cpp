@@ -0,0 +1,198 @@
+#include <map>
+#include <random>
+#include <utility>
+
+#include "flamegpu/runtime/detail/curve/curve_table.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_curve_table {
+using detail::curve::CurveTable;
+const unsigned int N = CurveTable::MAX_VARIABLES;
+
+TEST(TestCurveTable, HomeSlot) {
+    CurveTable table;
+    int x = 0;
+    const CurveTable::VariableHash h = 12345u;
+    const CurveTable::Variable cv = table.registerVariable(h, &x, sizeof(int), 10);
+    EXPECT_EQ(cv, static_cast<int>(h % N));
+    EXPECT_EQ(table.find(h), cv);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.getMaxProbe(), 0u);
+    EXPECT_EQ(table.getHashes()[cv], h);
+    EXPECT_EQ(table.getPointers()[cv], &x);
+    EXPECT_EQ(table.getSizes()[cv], sizeof(int));
+    EXPECT_EQ(table.getLengths()[cv], 10u);
+    EXPECT_EQ(table.find(h + 1), CurveTable::UNKNOWN_VARIABLE);
+    EXPECT_EQ(table.find(CurveTable::EMPTY_FLAG), CurveTable::UNKNOWN_VARIABLE);
+}
+TEST(TestCurveTable, CollisionsBoundProbe) {
+    CurveTable table;
+    // Three hashes which share home slot 2
+    const CurveTable::VariableHash a = 2, b = 2 + N, c = 2 + 2 * N;
+    EXPECT_EQ(table.registerVariable(a, nullptr, 4, 1), 2);
+    EXPECT_EQ(table.registerVariable(b, nullptr, 4, 1), 3);
+    EXPECT_EQ(table.registerVariable(c, nullptr, 4, 1), 4);
+    EXPECT_EQ(table.getMaxProbe(), 2u);
+    // Removing a variable does not hide those which probed past it
+    table.unregisterVariable(b);
+    EXPECT_EQ(table.find(c), 4);
+    EXPECT_EQ(table.getMaxProbe(), 2u);
+    // The max probe falls once the displaced variables are removed
+    table.unregisterVariable(c);
+    EXPECT_EQ(table.getMaxProbe(), 0u);
+    EXPECT_EQ(table.find(a), 2);
+    // Freed slots are reused
+    EXPECT_EQ(table.registerVariable(c, nullptr, 4, 1), 3);
+    EXPECT_EQ(table.getMaxProbe(), 1u);
+    EXPECT_EQ(table.size(), 2);
+}
+TEST(TestCurveTable, Wraparound) {
+    CurveTable table;
+    const CurveTable::VariableHash a = N - 1, b = 2 * N - 1;
+    EXPECT_EQ(table.registerVariable(a, nullptr, 4, 1), static_cast<int>(N - 1));
+    EXPECT_EQ(table.registerVariable(b, nullptr, 4, 1), 0);
+    EXPECT_EQ(table.getMaxProbe(), 1u);
+    EXPECT_EQ(table.find(b), 0);
+}
+TEST(TestCurveTable, Full) {
+    CurveTable table;
+    for (unsigned int i = 0; i < N; ++i)
+        EXPECT_NE(table.registerVariable(2 + i, nullptr, 4, 1), CurveTable::UNKNOWN_VARIABLE);
+    EXPECT_EQ(table.size(), static_cast<int>(N));
+    EXPECT_EQ(table.registerVariable(2 + N, nullptr, 4, 1), CurveTable::UNKNOWN_VARIABLE);
+    table.clear();
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(table.getMaxProbe(), 0u);
+}
+TEST(TestCurveTable, UnregisterUnknown) {
+    CurveTable table;
+    EXPECT_THROW(table.unregisterVariable(12345u), exception::CurveException);
+    table.registerVariable(12345u, nullptr, 4, 1);
+    EXPECT_NO_THROW(table.unregisterVariable(12345u));
+    EXPECT_THROW(table.unregisterVariable(12345u), exception::CurveException);
+}
+TEST(TestCurveTable, Dirty) {
+    CurveTable table;
+    // A new table must be uploaded in full
+    EXPECT_EQ(table.getDirty().getBounds(), std::make_pair(size_t(0), size_t(N)));
+    table.clearDirty();
+    EXPECT_TRUE(table.getDirty().empty());
+    table.registerVariable(10, nullptr, 4, 1);
+    table.registerVariable(20, nullptr, 4, 1);
+    ASSERT_EQ(table.getDirty().getRanges().size(), 2u);
+    EXPECT_EQ(table.getDirty().getRanges()[0], std::make_pair(size_t(10), size_t(11)));
+    EXPECT_EQ(table.getDirty().getRanges()[1], std::make_pair(size_t(20), size_t(21)));
+    table.clearDirty();
+    table.unregisterVariable(20);
+    EXPECT_EQ(table.getDirty().getBounds(), std::make_pair(size_t(20), size_t(21)));
+}
+TEST(TestCurveTable, Binding) {
+    CurveTable table;
+    CurveTable::Binding binding;
+    // Entries 0 and 1 collide
+    binding.variables.resize(3);
+    binding.variables[0].hash = 100;
+    binding.variables[1].hash = 100 + N;
+    binding.variables[2].hash = 500;
+    for (auto &v : binding.variables)
+        v.size = 4;
+    int data[6];
+    void *ptrs[3] = {&data[0], &data[1], &data[2]};
+    table.bind(binding, ptrs, 10);
+    EXPECT_TRUE(binding.bound);
+    EXPECT_EQ(binding.variables[0].slot, 100);
+    EXPECT_EQ(binding.variables[1].slot, 101);
+    EXPECT_EQ(binding.variables[2].slot, 500);
+    EXPECT_EQ(table.size(), 3);
+    for (unsigned int i = 0; i < 3; ++i) {
+        EXPECT_EQ(table.getPointers()[binding.variables[i].slot], ptrs[i]);
+        EXPECT_EQ(table.getLengths()[binding.variables[i].slot], 10u);
+    }
+    // Binding again updates buffers in place, only dirtying the slots which changed
+    table.clearDirty();
+    void *ptrs2[3] = {&data[0], &data[4], &data[2]};
+    table.bind(binding, ptrs2, 10);
+    EXPECT_EQ(table.size(), 3);
+    EXPECT_EQ(table.getPointers()[101], &data[4]);
+    EXPECT_EQ(table.getDirty().getBounds(), std::make_pair(size_t(101), size_t(102)));
+    table.unbind(binding);
+    EXPECT_FALSE(binding.bound);
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(table.getMaxProbe(), 0u);
+    for (const auto &v : binding.variables)
+        EXPECT_EQ(v.slot, CurveTable::UNKNOWN_VARIABLE);
+    // Unbinding an unbound binding does nothing
+    EXPECT_NO_THROW(table.unbind(binding));
+}
+TEST(TestCurveTable, BindingAfterClear) {
+    CurveTable table;
+    CurveTable::Binding binding;
+    binding.variables.resize(2);
+    binding.variables[0].hash = 100;
+    binding.variables[1].hash = 200;
+    void *ptrs[2] = {nullptr, nullptr};
+    table.bind(binding, ptrs, 1);
+    // e.g. Curve was purged whilst the binding was bound
+    table.clear();
+    // Occupy the home slot of one of the binding's variables
+    table.registerVariable(200 + N, nullptr, 8, 1);
+    table.bind(binding, ptrs, 1);
+    EXPECT_EQ(table.size(), 3);
+    EXPECT_EQ(table.getHashes()[binding.variables[0].slot], 100u);
+    EXPECT_EQ(table.getHashes()[binding.variables[1].slot], 200u);
+    EXPECT_EQ(binding.variables[1].slot, 201);
+    table.unbind(binding);
+    EXPECT_EQ(table.size(), 1);
+    EXPECT_EQ(table.find(200 + N), 200);
+}
+TEST(TestCurveTable, BindingFullRollback) {
+    CurveTable table;
+    for (unsigned int i = 0; i < N - 1; ++i)
+        table.registerVariable(2 + i, nullptr, 4, 1);
+    table.clearDirty();
+    CurveTable::Binding binding;
+    binding.variables.resize(2);
+    binding.variables[0].hash = 5000;
+    binding.variables[1].hash = 6000;
+    void *ptrs[2] = {nullptr, nullptr};
+    EXPECT_THROW(table.bind(binding, ptrs, 1), exception::CurveException);
+    EXPECT_FALSE(binding.bound);
+    EXPECT_EQ(table.size(), static_cast<int>(N - 1));
+    EXPECT_EQ(table.find(5000), CurveTable::UNKNOWN_VARIABLE);
+}
+TEST(TestCurveTable, RandomAgainstReference) {
+    CurveTable table;
+    std::map<CurveTable::VariableHash, CurveTable::Variable> reference;
+    std::mt19937 rng(42);
+    // Restrict hashes to few home slots, to force long probe sequences
+    std::uniform_int_distribution<unsigned int> dist(2, 2 + 64 * 4);
+    for (int i = 0; i < 20000; ++i) {
+        const CurveTable::VariableHash h = dist(rng) * (N / 4 + 1);
+        if (h == CurveTable::EMPTY_FLAG || h == CurveTable::DELETED_FLAG)
+            continue;
+        auto r = reference.find(h);
+        if (r == reference.end() && reference.size() < N / 2) {
+            const auto cv = table.registerVariable(h, nullptr, 4, 1);
+            ASSERT_NE(cv, CurveTable::UNKNOWN_VARIABLE);
+            reference.emplace(h, cv);
+        } else if (r != reference.end()) {
+            table.unregisterVariable(h);
+            reference.erase(r);
+        }
+        if (i % 100 == 0) {
+            unsigned int max_probe = 0;
+            for (const auto &v : reference) {
+                ASSERT_EQ(table.find(v.first), v.second);
+                const unsigned int probe = (v.second - CurveTable::getHomeSlot(v.first)) & (N - 1);
+                max_probe = probe > max_probe ? probe : max_probe;
+            }
+            ASSERT_EQ(table.getMaxProbe(), max_probe);
+            ASSERT_EQ(table.size(), static_cast<int>(reference.size()));
+        }
+    }
+}
+
+}  // namespace test_curve_table
+}  // namespace flamegpu
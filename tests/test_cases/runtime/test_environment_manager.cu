@@ -5,7 +5,7 @@
  * Tests cover:
  * > init() [does it work, can we host multiple models]
  * > free() [does it work, can we re-host a model]
- * > Out of space exception
+ * > Spilling properties which do not fit in constant memory
  * Implied tests: (Covered as a result of other tests)
  * > defrag() [init uses this]
  */
@@ -33,6 +33,16 @@ FLAMEGPU_STEP_FUNCTION(AlignTest) {
     ASSERT_EQ(FLAMEGPU->environment.getProperty<int8_t>("e"), 21);
     ASSERT_EQ(FLAMEGPU->environment.getProperty<float>("f"), 13.0f);
 }
+FLAMEGPU_STEP_FUNCTION(SpillTest) {
+    ASSERT_EQ(FLAMEGPU->environment.getProperty<char>("char_5kb_a", 1), 1);
+    ASSERT_EQ(FLAMEGPU->environment.getProperty<char>("char_5kb_b", 2), 2);
+    ASSERT_EQ(FLAMEGPU->environment.getProperty<char>("char_5kb_c", EnvironmentManager::MAX_BUFFER_SIZE / 2 - 1), 3);
+}
+FLAMEGPU_AGENT_FUNCTION(SpillRead, MessageNone, MessageNone) {
+    FLAMEGPU->setVariable<int>("a", FLAMEGPU->environment.getProperty<char>("char_5kb_a", 1));
+    FLAMEGPU->setVariable<int>("c", FLAMEGPU->environment.getProperty<char>("char_5kb_c", EnvironmentManager::MAX_BUFFER_SIZE / 2 - 1));
+    return ALIVE;
+}
 FLAMEGPU_STEP_FUNCTION(Multi_ms1) {
     ASSERT_EQ(FLAMEGPU->environment.getProperty<float>("ms1_float"), MS1_VAL);
     ASSERT_EQ(FLAMEGPU->environment.getProperty<float>("ms1_float2"), MS1_VAL2);
@@ -106,15 +116,35 @@ TEST_F(EnvironmentManagerTest, Alignment) {
     ms->run();
 }
 
-// Test bounds limit
-TEST_F(EnvironmentManagerTest, OutOfMemory1) {
+// Properties which do not fit in constant memory spill to global memory
+TEST(EnvironmentManagerTest2, SpillToGlobalMemory) {
+    ModelDescription model("model");
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<int>("a");
+    agent.newVariable<int>("c");
+    agent.newFunction("SpillRead", SpillRead);
+    model.newLayer().addAgentFunction(SpillRead);
+    model.addStepFunction(SpillTest);
+    EnvironmentDescription &env = model.Environment();
     std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_a = {};
-    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_b;
-    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_c;
-    ms->env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_a", char_5kb_a);
-    ms->env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_b", char_5kb_b);
-    ms->env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_c", char_5kb_c);
-    EXPECT_THROW(ms->run(), exception::OutOfMemory);
+    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_b = {};
+    std::array<char, EnvironmentManager::MAX_BUFFER_SIZE / 2> char_5kb_c = {};
+    char_5kb_a[1] = 1;
+    char_5kb_b[2] = 2;
+    char_5kb_c[char_5kb_c.size() - 1] = 3;
+    env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_a", char_5kb_a);
+    env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_b", char_5kb_b);
+    env.newProperty<char, EnvironmentManager::MAX_BUFFER_SIZE / 2>("char_5kb_c", char_5kb_c);
+    AgentVector population(agent, TEST_LEN);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 1;
+    cudaSimulation.setPopulationData(population);
+    ASSERT_NO_THROW(cudaSimulation.simulate());
+    cudaSimulation.getPopulationData(population);
+    for (const auto &a : population) {
+        ASSERT_EQ(a.getVariable<int>("a"), 1);
+        ASSERT_EQ(a.getVariable<int>("c"), 3);
+    }
 }
 
 // Multiple models
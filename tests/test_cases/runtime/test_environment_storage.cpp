@@ -0,0 +1,214 @@
+/**
+ * Tests of class: detail::EnvironmentStorage
+ * This is the host-only layout backend of EnvironmentManager, so can be tested without a device
+ *
+ * Tests cover:
+ * > Natural alignment of properties
+ * > Reuse of released space
+ * > Defragmentation
+ * > Spilling into the global segment
+ * > Dirty range tracking
+ */
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/runtime/utility/EnvironmentStorage.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+namespace test_environment_storage {
+using detail::EnvironmentStorage;
+
+TEST(EnvironmentStorageTest, Alignment) {
+    EnvironmentStorage s(256);
+    const EnvironmentStorage::Placement a = s.allocate("a", 1, 1);
+    const EnvironmentStorage::Placement b = s.allocate("b", 8, 8);
+    const EnvironmentStorage::Placement c = s.allocate("c", 1, 1);
+    const EnvironmentStorage::Placement d = s.allocate("d", 24, 8);
+    const EnvironmentStorage::Placement e = s.allocate("e", 2, 2);
+    const EnvironmentStorage::Placement f = s.allocate("f", 4, 4);
+    for (const auto &p : {a, b, c, d, e, f}) {
+        EXPECT_EQ(p.segment, EnvironmentStorage::Constant);
+        EXPECT_EQ(p.offset % p.alignment, 0);
+    }
+    // Alignment padding is reused by later small properties
+    EXPECT_EQ(a.offset, 0);
+    EXPECT_EQ(b.offset, 8);
+    EXPECT_EQ(c.offset, 1);
+    EXPECT_EQ(d.offset, 16);
+    EXPECT_EQ(e.offset, 2);
+    EXPECT_EQ(f.offset, 4);
+    EXPECT_EQ(s.getConstantSize(), 40u);
+    EXPECT_EQ(s.getConstantFreeSpace(), 256u - 40u);
+    // Properties are zero initialised
+    for (const auto &p : s.getPlacements()) {
+        const char *ptr = s.getHostPtr(p.second);
+        for (size_t i = 0; i < p.second.length; ++i)
+            EXPECT_EQ(ptr[i], 0);
+    }
+}
+TEST(EnvironmentStorageTest, InvalidArguments) {
+    EnvironmentStorage s(64);
+    s.allocate("a", 4, 4);
+    EXPECT_THROW(s.allocate("a", 4, 4), exception::DuplicateEnvProperty);
+    EXPECT_THROW(s.allocate("b", 4, 3), exception::InvalidArgument);
+    EXPECT_THROW(s.allocate("b", 6, 4), exception::InvalidArgument);
+    EXPECT_THROW(s.allocate("b", 4, 0), exception::InvalidArgument);
+    EXPECT_THROW(s.release("b"), exception::InvalidEnvProperty);
+    EXPECT_EQ(s.find("b"), nullptr);
+    ASSERT_NE(s.find("a"), nullptr);
+    EXPECT_EQ(s.find("a")->length, 4u);
+}
+TEST(EnvironmentStorageTest, ReleaseReusesSpace) {
+    EnvironmentStorage s(64);
+    s.allocate("a", 16, 8);
+    s.allocate("b", 16, 8);
+    s.allocate("c", 16, 8);
+    // Releasing the last property rolls back the end of the segment
+    s.release("c");
+    EXPECT_EQ(s.getConstantSize(), 32u);
+    // Releasing an inner property leaves a gap, which is reused
+    s.release("a");
+    EXPECT_EQ(s.getConstantSize(), 32u);
+    EXPECT_EQ(s.getConstantFreeSpace(), 48u);
+    const EnvironmentStorage::Placement d = s.allocate("d", 8, 4);
+    EXPECT_EQ(d.segment, EnvironmentStorage::Constant);
+    EXPECT_EQ(d.offset, 0);
+    // Adjacent gaps merge, and roll back the end of the segment
+    s.release("b");
+    s.release("d");
+    EXPECT_EQ(s.getConstantSize(), 0u);
+    EXPECT_EQ(s.getConstantFreeSpace(), 64u);
+    EXPECT_EQ(s.allocate("e", 64, 8).offset, 0);
+}
+TEST(EnvironmentStorageTest, Defragment) {
+    EnvironmentStorage s(64);
+    s.allocate("a", 1, 1);
+    s.allocate("b", 8, 8);
+    s.allocate("c", 2, 2);
+    s.allocate("d", 16, 4);
+    // Write a unique value to every byte
+    for (const auto &p : s.getPlacements()) {
+        char *ptr = s.getHostPtr(p.second);
+        for (size_t i = 0; i < p.second.length; ++i)
+            ptr[i] = static_cast<char>(p.first[0] + i);
+    }
+    const uint64_t version = s.getLayoutVersion();
+    EXPECT_TRUE(s.defragment());
+    EXPECT_GT(s.getLayoutVersion(), version);
+    // Descending alignment, no gaps
+    EXPECT_EQ(s.find("b")->offset, 0);
+    EXPECT_EQ(s.find("d")->offset, 8);
+    EXPECT_EQ(s.find("c")->offset, 24);
+    EXPECT_EQ(s.find("a")->offset, 26);
+    EXPECT_EQ(s.getConstantSize(), 27u);
+    // Values move with their property
+    for (const auto &p : s.getPlacements()) {
+        const char *ptr = s.getHostPtr(p.second);
+        for (size_t i = 0; i < p.second.length; ++i)
+            EXPECT_EQ(ptr[i], static_cast<char>(p.first[0] + i));
+    }
+    // A compact layout does not change
+    const uint64_t version2 = s.getLayoutVersion();
+    EXPECT_FALSE(s.defragment());
+    EXPECT_EQ(s.getLayoutVersion(), version2);
+}
+TEST(EnvironmentStorageTest, DefragmentOnAllocate) {
+    EnvironmentStorage s(32);
+    s.allocate("a", 8, 8);
+    s.allocate("b", 8, 8);
+    s.allocate("c", 8, 8);
+    s.allocate("d", 8, 8);
+    s.release("a");
+    s.release("c");
+    memset(s.getHostPtr(*s.find("b")), 'b', 8);
+    memset(s.getHostPtr(*s.find("d")), 'd', 8);
+    // 16 bytes are free, but not contiguous, so the segment is compacted rather than spilling
+    const EnvironmentStorage::Placement e = s.allocate("e", 16, 8);
+    EXPECT_EQ(e.segment, EnvironmentStorage::Constant);
+    EXPECT_EQ(e.offset, 16);
+    EXPECT_EQ(s.find("b")->offset, 0);
+    EXPECT_EQ(s.find("d")->offset, 8);
+    EXPECT_EQ(s.getHostPtr(*s.find("b"))[7], 'b');
+    EXPECT_EQ(s.getHostPtr(*s.find("d"))[0], 'd');
+    EXPECT_EQ(s.getConstantFreeSpace(), 0u);
+    EXPECT_EQ(s.getGlobalSize(), 0u);
+}
+TEST(EnvironmentStorageTest, Spill) {
+    EnvironmentStorage s(32);
+    const EnvironmentStorage::Placement a = s.allocate("a", 24, 8);
+    // Does not fit, even after defragmenting
+    const EnvironmentStorage::Placement b = s.allocate("b", 16, 4);
+    // Still fits in the remaining constant space
+    const EnvironmentStorage::Placement c = s.allocate("c", 8, 8);
+    const EnvironmentStorage::Placement d = s.allocate("d", 4096, 8);
+    EXPECT_EQ(a.segment, EnvironmentStorage::Constant);
+    EXPECT_EQ(b.segment, EnvironmentStorage::Global);
+    EXPECT_EQ(c.segment, EnvironmentStorage::Constant);
+    EXPECT_EQ(d.segment, EnvironmentStorage::Global);
+    EXPECT_EQ(b.offset, 0);
+    EXPECT_EQ(d.offset, 16);
+    EXPECT_EQ(s.getGlobalSize(), 16u + 4096u);
+    memset(s.getHostPtr(d), 'd', d.length);
+    // Releasing a spilled property does not move it back to the constant segment
+    s.release("c");
+    s.release("b");
+    EXPECT_EQ(s.find("d")->segment, EnvironmentStorage::Global);
+    EXPECT_TRUE(s.defragment());
+    EXPECT_EQ(s.find("d")->segment, EnvironmentStorage::Global);
+    EXPECT_EQ(s.find("d")->offset, 0);
+    EXPECT_EQ(s.getGlobalSize(), 4096u);
+    EXPECT_EQ(s.getHostPtr(*s.find("d"))[4095], 'd');
+    s.release("d");
+    EXPECT_EQ(s.getGlobalSize(), 0u);
+}
+TEST(EnvironmentStorageTest, NoConstantCapacity) {
+    EnvironmentStorage s(0);
+    EXPECT_EQ(s.allocate("a", 4, 4).segment, EnvironmentStorage::Global);
+    EXPECT_EQ(s.allocate("b", 1, 1).segment, EnvironmentStorage::Global);
+    EXPECT_EQ(s.allocate("c", 8, 8).offset, 8);
+    EXPECT_EQ(s.allocate("d", 2, 2).offset, 6);
+    EXPECT_EQ(s.getConstantSize(), 0u);
+    EXPECT_EQ(s.getGlobalSize(), 16u);
+}
+TEST(EnvironmentStorageTest, DirtyTracking) {
+    typedef std::vector<std::pair<size_t, size_t>> Ranges;
+    EnvironmentStorage s(32);
+    // New properties are dirty, alignment padding is not
+    s.allocate("a", 8, 8);
+    s.allocate("b", 4, 4);
+    s.allocate("c", 8, 8);
+    s.allocate("d", 24, 8);
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Constant).getRanges(), (Ranges{{0, 12}, {16, 24}}));
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Global).getRanges(), (Ranges{{0, 24}}));
+    s.clearDirty(EnvironmentStorage::Constant);
+    s.clearDirty(EnvironmentStorage::Global);
+    EXPECT_TRUE(s.getDirty(EnvironmentStorage::Constant).empty());
+    // Only the written properties are dirty
+    s.markDirty(*s.find("a"));
+    s.markDirty(*s.find("c"));
+    s.markDirty(*s.find("d"));
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Constant).getRanges(), (Ranges{{0, 8}, {16, 24}}));
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Constant).getCoalescedRanges(8), (Ranges{{0, 24}}));
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Global).getRanges(), (Ranges{{0, 24}}));
+    // Releasing the last property drops its dirty range
+    s.release("c");
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Constant).getRanges(), (Ranges{{0, 8}}));
+    s.clearDirty(EnvironmentStorage::Constant);
+    s.clearDirty(EnvironmentStorage::Global);
+    // Moving properties marks the compacted segment dirty
+    s.release("a");
+    EXPECT_TRUE(s.defragment());
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Constant).getRanges(), (Ranges{{0, 4}}));
+    EXPECT_TRUE(s.getDirty(EnvironmentStorage::Global).empty());
+    s.markAllDirty();
+    EXPECT_EQ(s.getDirty(EnvironmentStorage::Global).getRanges(), (Ranges{{0, 24}}));
+}
+
+}  // namespace test_environment_storage
+}  // namespace flamegpu
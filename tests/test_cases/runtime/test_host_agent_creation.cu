@@ -7,6 +7,7 @@
 * > host function birthed agents have default values set
 * > Exception thrown if setting/getting wrong variable name/type
 * > getVariable() works
+* > batch creation via newAgents() appends agents with default values and unique IDs
 */
 #include <set>
 
@@ -954,5 +955,98 @@ TEST(HostAgentCreationTest, DISABLED_HostAgentBirth_ArrayDefaultWorks2_glm) {}
 TEST(HostAgentCreationTest, DISABLED_HostAgentBirth_ArrayLenWrong_glm) {}
 TEST(HostAgentCreationTest, DISABLED_HostAgentBirth_ArrayOutOfBounds_glm) {}
 #endif
+FLAMEGPU_STEP_FUNCTION(BatchOutput) {
+    auto &batch = FLAMEGPU->agent("agent").newAgents(NEW_AGENT_COUNT);
+    auto x = batch.column<float>("x");
+    x.generate([](unsigned int i) { return static_cast<float>(i); });
+    auto a = batch.column<int>("a");
+    for (unsigned int i = 0; i < a.size(); ++i)
+        a.data(i, i + 1)[0] = static_cast<int>(i);
+}
+FLAMEGPU_STEP_FUNCTION(BatchOutputMixed) {
+    auto t = FLAMEGPU->agent("agent");
+    t.newAgent().setVariable<float>("x", -1.0f);
+    t.newAgents(NEW_AGENT_COUNT).column<float>("x").fill(1.0f);
+    t.newAgents(NEW_AGENT_COUNT).column<float>("x").fill(2.0f);
+}
+FLAMEGPU_STEP_FUNCTION(BatchOutputIDs) {
+    auto &batch = FLAMEGPU->agent("agent").newAgents(NEW_AGENT_COUNT);
+    for (unsigned int i = 1; i < batch.size(); ++i)
+        EXPECT_EQ(batch.getID(i), batch.getID(0) + i);
+    EXPECT_THROW(batch.getID(NEW_AGENT_COUNT), exception::OutOfBoundsException);
+    EXPECT_THROW(batch.column<float>("_id"), exception::ReservedName);
+    EXPECT_THROW(batch.column<int>("x"), exception::InvalidVarType);
+    EXPECT_THROW(batch.column<float>("nope"), exception::InvalidAgentVar);
+}
+TEST(HostAgentCreationTest, BatchFromStep) {
+    ModelDescription model("TestModel");
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<float>("x");
+    agent.newVariable<int>("a");
+    agent.newVariable<int, 2>("default", {4, 5});
+    model.addStepFunction(BatchOutput);
+    CUDASimulation cudaSimulation(model);
+    AgentVector population(model.Agent("agent"), INIT_AGENT_COUNT);
+    for (AgentVector::Agent instance : population) {
+        instance.setVariable<float>("x", -12.0f);
+        instance.setVariable<int>("a", -12);
+    }
+    cudaSimulation.setPopulationData(population);
+    cudaSimulation.step();
+    cudaSimulation.getPopulationData(population);
+    ASSERT_EQ(population.size(), INIT_AGENT_COUNT + NEW_AGENT_COUNT);
+    // Existing agents are unchanged, batch agents are appended in order and default initialised
+    for (unsigned int i = 0; i < INIT_AGENT_COUNT; ++i) {
+        EXPECT_EQ(population[i].getVariable<float>("x"), -12.0f);
+        EXPECT_EQ(population[i].getVariable<int>("a"), -12);
+    }
+    std::set<id_t> ids;
+    for (unsigned int i = 0; i < NEW_AGENT_COUNT; ++i) {
+        AgentVector::Agent ai = population[INIT_AGENT_COUNT + i];
+        EXPECT_EQ(ai.getVariable<float>("x"), static_cast<float>(i));
+        EXPECT_EQ(ai.getVariable<int>("a"), static_cast<int>(i));
+        const std::array<int, 2> def = ai.getVariable<int, 2>("default");
+        EXPECT_EQ(def[0], 4);
+        EXPECT_EQ(def[1], 5);
+        EXPECT_NE(ai.getID(), ID_NOT_SET);
+        ids.insert(ai.getID());
+    }
+    EXPECT_EQ(ids.size(), NEW_AGENT_COUNT);
+}
+TEST(HostAgentCreationTest, BatchMixedWithNewAgent) {
+    ModelDescription model("TestModel");
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<float>("x");
+    model.addStepFunction(BatchOutputMixed);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 2;
+    cudaSimulation.simulate();
+    AgentVector population(model.Agent("agent"));
+    cudaSimulation.getPopulationData(population);
+    ASSERT_EQ(population.size(), 2 * (1 + 2 * NEW_AGENT_COUNT));
+    unsigned int count[3] = {0, 0, 0};
+    std::set<id_t> ids;
+    for (AgentVector::Agent ai : population) {
+        const float x = ai.getVariable<float>("x");
+        ++count[x < 0 ? 0 : static_cast<unsigned int>(x)];
+        ids.insert(ai.getID());
+    }
+    EXPECT_EQ(count[0], 2u);
+    EXPECT_EQ(count[1], 2 * NEW_AGENT_COUNT);
+    EXPECT_EQ(count[2], 2 * NEW_AGENT_COUNT);
+    // Every agent has a unique ID
+    EXPECT_EQ(ids.size(), population.size());
+}
+TEST(HostAgentCreationTest, BatchIDsAndExceptions) {
+    ModelDescription model("TestModel");
+    AgentDescription &agent = model.newAgent("agent");
+    agent.newVariable<float>("x");
+    model.addStepFunction(BatchOutputIDs);
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.step();
+    AgentVector population(model.Agent("agent"));
+    cudaSimulation.getPopulationData(population);
+    EXPECT_EQ(population.size(), NEW_AGENT_COUNT);
+}
 }  // namespace test_host_agent_creation
 }  // namespace flamegpu
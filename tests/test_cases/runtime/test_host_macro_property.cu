@@ -3,9 +3,14 @@
  * ReadTest: Test that HostMacroProperty can read data (written via agent fn's)
  * WriteTest: Test that HostMacroProperty can write data (read via agent fn's)
  * ZeroTest: Test that HostMacroProperty can zero data (read via agent fn's)
+ * HostBackend*: Test which parts of the macro property are transferred, using a host-only backend
  */
 
 #include <array>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "flamegpu/flamegpu.h"
 
@@ -487,6 +492,227 @@ TEST(HostMacroPropertyTest, ArithmeticTest) {
     ASSERT_NO_THROW(cudaSimulation.simulate());
 }
 
+TEST(HostMacroPropertyTest, WriteTestTiled) {
+    // As WriteTest, but the host copy is downloaded lazily in small tiles
+    ModelDescription model("device_env_test");
+    // Setup environment
+    model.Environment().newMacroProperty<unsigned int, 2, 3, 4, 5>("int");
+    model.Environment().newMacroProperty<unsigned int>("plusequal");
+    // Setup agent fn
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newVariable<unsigned int>("i");
+    agent.newVariable<unsigned int>("j");
+    agent.newVariable<unsigned int>("k");
+    agent.newVariable<unsigned int>("w");
+    agent.newVariable<unsigned int>("a");
+    agent.newFunction("agentread", AgentRead);
+    model.newLayer().addHostFunction(HostWrite);
+    model.newLayer().addAgentFunction(AgentRead);
+    const unsigned int total_agents = TEST_DIMS[0] * TEST_DIMS[1] * TEST_DIMS[2] * TEST_DIMS[3];
+    AgentVector population(agent, total_agents);
+    unsigned int a = 0;
+    for (unsigned int i = 0; i < TEST_DIMS[0]; ++i) {
+        for (unsigned int j = 0; j < TEST_DIMS[1]; ++j) {
+            for (unsigned int k = 0; k < TEST_DIMS[2]; ++k) {
+                for (unsigned int w = 0; w < TEST_DIMS[3]; ++w) {
+                    auto p = population[a];
+                    p.setVariable<unsigned int>("a", 2+a++);
+                    p.setVariable<unsigned int>("i", i);
+                    p.setVariable<unsigned int>("j", j);
+                    p.setVariable<unsigned int>("k", k);
+                    p.setVariable<unsigned int>("w", w);
+                }
+            }
+        }
+    }
+    // Do Sim
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.SimulationConfig().steps = 1;
+    cudaSimulation.CUDAConfig().macro_property_download_tile_bytes = 7 * sizeof(unsigned int);
+    cudaSimulation.setPopulationData(population);
+    ASSERT_NO_THROW(cudaSimulation.simulate());
+    cudaSimulation.getPopulationData(population);
+    // Check results
+    unsigned int correct = 0;
+    for (auto p : population) {
+        correct += p.getVariable<unsigned int>("a") == 12 ? 1 : 0;
+    }
+    ASSERT_EQ(correct, total_agents);
+}
+
+/**
+ * Host-only HostMacroProperty_Backend, whose "device" buffer is host memory
+ * Records each transfer as a range of elements, so that tests can check exactly what was transferred
+ */
+class RecordingBackend : public HostMacroProperty_Backend {
+ public:
+    typedef std::pair<size_t, size_t> Range;
+    explicit RecordingBackend(const std::vector<int> &_device)
+        : device(_device) { }
+    void download(void *h_dst, const void *d_src, size_t bytes) override {
+        memcpy(h_dst, d_src, bytes);
+        downloads.push_back(toRange(d_src, bytes));
+    }
+    void upload(void *d_dst, const void *h_src, size_t bytes) override {
+        memcpy(d_dst, h_src, bytes);
+        uploads.push_back(toRange(d_dst, bytes));
+    }
+    void zero(void *d_dst, size_t bytes) override {
+        memset(d_dst, 0, bytes);
+        zeros.push_back(toRange(d_dst, bytes));
+    }
+    void clear() {
+        downloads.clear();
+        uploads.clear();
+        zeros.clear();
+    }
+    std::vector<Range> downloads, uploads, zeros;
+
+ private:
+    Range toRange(const void *d_ptr, size_t bytes) const {
+        const size_t first = static_cast<const int*>(d_ptr) - device.data();
+        return {first, first + bytes / sizeof(int)};
+    }
+    const std::vector<int> &device;
+};
+typedef HostMacroProperty<int, 4, 8, 16, 2> HostBackendProp;
+const unsigned int HOST_BACKEND_DIMS[4] = {4, 8, 16, 2};
+const unsigned int HOST_BACKEND_ELEMENTS = 4 * 8 * 16 * 2;
+std::vector<int> makeDeviceBuffer(size_t elements) {
+    std::vector<int> device(elements);
+    for (size_t i = 0; i < elements; ++i)
+        device[i] = static_cast<int>(i);
+    return device;
+}
+std::shared_ptr<HostMacroProperty_MetaData> makeHostBackendMetaData(std::vector<int> &device, const std::shared_ptr<RecordingBackend> &backend, size_t tile_bytes) {
+    return std::make_shared<HostMacroProperty_MetaData>(device.data(),
+        std::array<unsigned int, 4>{HOST_BACKEND_DIMS[0], HOST_BACKEND_DIMS[1], HOST_BACKEND_DIMS[2], HOST_BACKEND_DIMS[3]},
+        sizeof(int), false, "prop", tile_bytes, backend);
+}
+TEST(HostMacroPropertyTest, HostBackendUploadsOnlyModified) {
+    std::vector<int> device = makeDeviceBuffer(HOST_BACKEND_ELEMENTS);
+    auto backend = std::make_shared<RecordingBackend>(device);
+    auto metadata = makeHostBackendMetaData(device, backend, 0);
+    HostBackendProp p(metadata);
+    // Reading does not upload
+    EXPECT_EQ(p[1][2][3][1], 256 + 64 + 6 + 1);
+    metadata->upload();
+    EXPECT_TRUE(backend->uploads.empty());
+    // Without tiling, the whole property is downloaded once
+    ASSERT_EQ(backend->downloads.size(), 1u);
+    EXPECT_EQ(backend->downloads[0], RecordingBackend::Range(0, HOST_BACKEND_ELEMENTS));
+    // Only modified elements are uploaded
+    p[0][0][0][0] = -1;
+    p[3][7][15][1] += 10;
+    p[2][0][0][0]++;
+    p[2][0][0][1]++;
+    metadata->upload();
+    ASSERT_EQ(backend->uploads.size(), 3u);
+    EXPECT_EQ(backend->uploads[0], RecordingBackend::Range(0, 1));
+    EXPECT_EQ(backend->uploads[1], RecordingBackend::Range(512, 514));
+    EXPECT_EQ(backend->uploads[2], RecordingBackend::Range(HOST_BACKEND_ELEMENTS - 1, HOST_BACKEND_ELEMENTS));
+    EXPECT_EQ(device[0], -1);
+    EXPECT_EQ(device[512], 513);
+    EXPECT_EQ(device[HOST_BACKEND_ELEMENTS - 1], static_cast<int>(HOST_BACKEND_ELEMENTS - 1 + 10));
+    // Nothing remains to upload
+    backend->clear();
+    metadata->upload();
+    EXPECT_TRUE(backend->uploads.empty());
+    EXPECT_TRUE(backend->downloads.empty());
+}
+TEST(HostMacroPropertyTest, HostBackendLazyTiles) {
+    std::vector<int> device = makeDeviceBuffer(HOST_BACKEND_ELEMENTS);
+    auto backend = std::make_shared<RecordingBackend>(device);
+    auto metadata = makeHostBackendMetaData(device, backend, 64 * sizeof(int));
+    HostBackendProp p(metadata);
+    // Only the tile holding the accessed element is downloaded
+    EXPECT_EQ(p[0][3][2][0], 100);
+    ASSERT_EQ(backend->downloads.size(), 1u);
+    EXPECT_EQ(backend->downloads[0], RecordingBackend::Range(64, 128));
+    EXPECT_EQ(p[0][3][3][0], 102);
+    EXPECT_EQ(backend->downloads.size(), 1u);
+    p[0][0][5][0] = 7;
+    EXPECT_EQ(backend->downloads.size(), 2u);
+    EXPECT_EQ(backend->downloads[1], RecordingBackend::Range(0, 64));
+    // Consecutive missing tiles are downloaded with a single copy
+    backend->clear();
+    metadata->download();
+    ASSERT_EQ(backend->downloads.size(), 1u);
+    EXPECT_EQ(backend->downloads[0], RecordingBackend::Range(128, HOST_BACKEND_ELEMENTS));
+    metadata->upload();
+    ASSERT_EQ(backend->uploads.size(), 1u);
+    EXPECT_EQ(backend->uploads[0], RecordingBackend::Range(10, 11));
+    EXPECT_EQ(device[10], 7);
+}
+TEST(HostMacroPropertyTest, HostBackendZero) {
+    std::vector<int> device = makeDeviceBuffer(HOST_BACKEND_ELEMENTS);
+    auto backend = std::make_shared<RecordingBackend>(device);
+    {
+        // Without a host copy, the device is zeroed directly
+        auto metadata = makeHostBackendMetaData(device, backend, 64 * sizeof(int));
+        HostBackendProp p(metadata);
+        p[1].zero();
+        ASSERT_EQ(backend->zeros.size(), 1u);
+        EXPECT_EQ(backend->zeros[0], RecordingBackend::Range(256, 512));
+        EXPECT_TRUE(backend->downloads.empty());
+    }
+    EXPECT_TRUE(backend->uploads.empty());
+    device = makeDeviceBuffer(HOST_BACKEND_ELEMENTS);
+    backend->clear();
+    {
+        auto metadata = makeHostBackendMetaData(device, backend, 64 * sizeof(int));
+        HostBackendProp p(metadata);
+        EXPECT_EQ(p[0][0][0][0], 0);
+        backend->clear();
+        // Completely zeroed tiles are not downloaded
+        p[1].zero();
+        EXPECT_TRUE(backend->downloads.empty());
+        EXPECT_EQ(p[1][3][0][0], 0);
+        EXPECT_TRUE(backend->downloads.empty());
+        // Partially zeroed tiles are downloaded, so the remainder of the tile is preserved
+        p[2][1].zero();
+        ASSERT_EQ(backend->downloads.size(), 1u);
+        EXPECT_EQ(backend->downloads[0], RecordingBackend::Range(512, 576));
+        EXPECT_EQ(p[2][0][0][0], 512);
+        EXPECT_TRUE(backend->zeros.empty());
+    }
+    // Modified elements are uploaded when the last reference is released
+    ASSERT_EQ(backend->uploads.size(), 2u);
+    EXPECT_EQ(backend->uploads[0], RecordingBackend::Range(256, 512));
+    EXPECT_EQ(backend->uploads[1], RecordingBackend::Range(544, 576));
+    for (unsigned int i = 0; i < HOST_BACKEND_ELEMENTS; ++i) {
+        const bool zeroed = (i >= 256 && i < 512) || (i >= 544 && i < 576);
+        ASSERT_EQ(device[i], zeroed ? 0 : static_cast<int>(i));
+    }
+}
+TEST(HostMacroPropertyTest, HostBackendMergedRangesSkipMissingTiles) {
+    // Write more scattered elements than dirty ranges are tracked, so that ranges are merged across tiles which were never downloaded
+    const unsigned int ELEMENTS = 16 * 16 * 16 * 16;
+    std::vector<int> device = makeDeviceBuffer(ELEMENTS);
+    auto backend = std::make_shared<RecordingBackend>(device);
+    auto metadata = std::make_shared<HostMacroProperty_MetaData>(device.data(), std::array<unsigned int, 4>{16, 16, 16, 16},
+        sizeof(int), false, "prop", 16 * sizeof(int), backend);
+    HostMacroProperty<int, 16, 16, 16, 16> p(metadata);
+    std::vector<bool> written(ELEMENTS, false);
+    for (unsigned int n = 0; n < 2 * HostMacroProperty_MetaData::MAX_DIRTY_RANGES; ++n) {
+        const unsigned int e = (n * 97) % ELEMENTS;
+        p[e / 4096][(e / 256) % 16][(e / 16) % 16][e % 16] = -static_cast<int>(e);
+        written[e] = true;
+    }
+    metadata->upload();
+    EXPECT_LE(backend->uploads.size(), 2 * HostMacroProperty_MetaData::MAX_DIRTY_RANGES);
+    // Every uploaded element lies within a downloaded tile
+    std::vector<bool> resident(ELEMENTS, false);
+    for (const auto &d : backend->downloads)
+        for (size_t i = d.first; i < d.second; ++i)
+            resident[i] = true;
+    for (const auto &u : backend->uploads)
+        for (size_t i = u.first; i < u.second; ++i)
+            ASSERT_TRUE(resident[i]);
+    for (unsigned int i = 0; i < ELEMENTS; ++i)
+        ASSERT_EQ(device[i], written[i] ? -static_cast<int>(i) : static_cast<int>(i));
+}
+
 /* These tests, test functionality which is not exposed unless LayerDescription allows agent fn and host fn in the same layer
 #if !defined(SEATBELTS) || SEATBELTS
 TEST(HostMacroPropertyTest, ReadSameLayerAsAgentWrite) {
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "flamegpu/flamegpu.h"
+#include "flamegpu/util/detail/SpaceFillingCurve.h"
 
 #include "gtest/gtest.h"
 
@@ -187,5 +192,66 @@ TEST(AutomaticSpatialAgentSort, SortEveryStep_vec3) {
     std::vector<int> expectedResult{ 3, 2, 1, 0 };
     EXPECT_EQ(expectedResult, finalOrder);
 }
+// Initialises one agent per bin of a 4x4 grid in row-major order, and checks that they are placed in curve order after one step
+void sortOrderTest(const SpatialSortOrder order) {
+    const unsigned int GRID_DIM = 4;
+    // Define model
+    ModelDescription model("model");
+    AgentDescription& agent = model.newAgent("agent");
+    agent.newVariable<int>("initial_order");
+    agent.newVariable<float>("x");
+    agent.newVariable<float>("y");
+    agent.setSortOrder(order);
+    EXPECT_EQ(agent.getSortOrder(), order);
+    MessageSpatial2D::Description& locationMessage = model.newMessage<MessageSpatial2D>("location");
+    locationMessage.setMin(0, 0);
+    locationMessage.setMax(static_cast<float>(GRID_DIM), static_cast<float>(GRID_DIM));
+    locationMessage.setRadius(1.0f);
+    AgentFunctionDescription& dummyFunc = agent.newFunction("dummySpatialFunc", dummySpatialFunc_2D);
+    dummyFunc.setMessageInput("location");
+    LayerDescription& layer = model.newLayer();
+    layer.addAgentFunction(dummyFunc);
+
+    // Init pop, and calculate the expected order with the host implementation of the curve
+    AgentVector pop(agent, GRID_DIM * GRID_DIM);
+    std::vector<std::pair<unsigned int, int>> keys;
+    for (int i = 0; i < static_cast<int>(GRID_DIM * GRID_DIM); i++) {
+        AgentVector::Agent instance = pop[i];
+        const int pos[2] = {i % static_cast<int>(GRID_DIM), i / static_cast<int>(GRID_DIM)};
+        const unsigned int dims[2] = {GRID_DIM, GRID_DIM};
+        instance.setVariable<int>("initial_order", i);
+        instance.setVariable<float>("x", pos[0] + 0.5f);
+        instance.setVariable<float>("y", pos[1] + 0.5f);
+        keys.push_back({util::detail::space_filling_curve::key<2, unsigned int>(order, pos, dims), i});
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<int> expectedResult;
+    for (const auto &k : keys)
+        expectedResult.push_back(k.second);
+
+    // Setup Model
+    CUDASimulation cudaSimulation(model);
+    cudaSimulation.setPopulationData(pop);
+
+    // Execute step fn
+    cudaSimulation.step();
+
+    // Check results
+    cudaSimulation.getPopulationData(pop);
+    std::vector<int> finalOrder;
+    for (AgentVector::Agent instance : pop) {
+        finalOrder.push_back(instance.getVariable<int>("initial_order"));
+    }
+    EXPECT_EQ(expectedResult, finalOrder);
+}
+TEST(AutomaticSpatialAgentSort, SortOrder_RowMajor) {
+    sortOrderTest(SpatialSortOrder::RowMajor);
+}
+TEST(AutomaticSpatialAgentSort, SortOrder_Morton) {
+    sortOrderTest(SpatialSortOrder::Morton);
+}
+TEST(AutomaticSpatialAgentSort, SortOrder_Hilbert) {
+    sortOrderTest(SpatialSortOrder::Hilbert);
+}
 }  // namespace test_spatial_agent_sort
 }  // namespace flamegpu
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "flamegpu/sim/LogReductionPlan.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_log_reduction_plan {
+using detail::LogReductionPlan;
+using detail::LogReductionPartial;
+
+template<typename T>
+T result(const LogReductionPlan &plan, unsigned int column, const LogReductionPartial &partial, LogReductionPlan::Statistic statistic) {
+    const util::Any a = plan.getResult(column, partial, statistic);
+    EXPECT_EQ(a.type, std::type_index(typeid(T)));
+    return *static_cast<const T*>(a.ptr);
+}
+
+TEST(LogReductionPlanTest, ColumnPerVariable) {
+    LogReductionPlan plan;
+    EXPECT_TRUE(plan.empty());
+    EXPECT_EQ(plan.add("a", typeid(float), LogReductionPlan::Mean), 0u);
+    EXPECT_EQ(plan.add("b", typeid(int), LogReductionPlan::Min), 1u);
+    EXPECT_EQ(plan.add("a", typeid(float), LogReductionPlan::StandardDev), 0u);
+    EXPECT_EQ(plan.add("a", typeid(float), LogReductionPlan::Max), 0u);
+    ASSERT_EQ(plan.getColumns().size(), 2u);
+    EXPECT_EQ(plan.getColumns()[0].variable_name, "a");
+    EXPECT_EQ(plan.getColumns()[0].statistics, LogReductionPlan::Mean | LogReductionPlan::StandardDev | LogReductionPlan::Max);
+    EXPECT_EQ(plan.getColumns()[1].variable_name, "b");
+    EXPECT_EQ(plan.getColumns()[1].statistics, static_cast<unsigned int>(LogReductionPlan::Min));
+    EXPECT_THROW(plan.add("c", typeid(bool), LogReductionPlan::Sum), exception::InvalidVarType);
+}
+TEST(LogReductionPlanTest, ReduceHost) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> f_dist(-100, 100);
+    std::uniform_int_distribution<int32_t> i_dist(-1000, 1000);
+    std::uniform_int_distribution<uint64_t> u_dist(0, 1ull << 62);
+    const unsigned int N = 1000;
+    std::vector<float> f(N);
+    std::vector<int32_t> i(N);
+    std::vector<uint64_t> u(N);
+    for (unsigned int j = 0; j < N; ++j) {
+        f[j] = f_dist(rng);
+        i[j] = i_dist(rng);
+        u[j] = u_dist(rng);
+    }
+    LogReductionPlan plan;
+    plan.add("f", typeid(float), LogReductionPlan::Mean);
+    plan.add("i", typeid(int32_t), LogReductionPlan::Sum);
+    plan.add("u", typeid(uint64_t), LogReductionPlan::Max);
+    const std::vector<LogReductionPartial> partials = plan.reduceHost({f.data(), i.data(), u.data()}, N);
+    ASSERT_EQ(partials.size(), 3u);
+    // Reference, two pass
+    const double f_mean = std::accumulate(f.begin(), f.end(), 0.0) / N;
+    double f_var = 0;
+    for (const float v : f)
+        f_var += (v - f_mean) * (v - f_mean);
+    f_var /= N;
+    EXPECT_NEAR(result<double>(plan, 0, partials[0], LogReductionPlan::Mean), f_mean, 1e-9);
+    EXPECT_NEAR(result<double>(plan, 0, partials[0], LogReductionPlan::StandardDev), sqrt(f_var), 1e-9);
+    EXPECT_EQ(result<float>(plan, 0, partials[0], LogReductionPlan::Min), *std::min_element(f.begin(), f.end()));
+    EXPECT_EQ(result<float>(plan, 0, partials[0], LogReductionPlan::Max), *std::max_element(f.begin(), f.end()));
+    // Integer sums use sum_input_t, and are exact
+    EXPECT_EQ(result<int64_t>(plan, 1, partials[1], LogReductionPlan::Sum), std::accumulate(i.begin(), i.end(), int64_t(0)));
+    EXPECT_EQ(result<int32_t>(plan, 1, partials[1], LogReductionPlan::Min), *std::min_element(i.begin(), i.end()));
+    EXPECT_EQ(result<uint64_t>(plan, 2, partials[2], LogReductionPlan::Max), *std::max_element(u.begin(), u.end()));
+    EXPECT_EQ(result<uint64_t>(plan, 2, partials[2], LogReductionPlan::Min), *std::min_element(u.begin(), u.end()));
+    EXPECT_THROW(plan.reduceHost({f.data()}, N), exception::InvalidArgument);
+}
+TEST(LogReductionPlanTest, LongLong) {
+    // long long is a distinct type from int64_t on some platforms, results are returned as the variable's type
+    const std::vector<long long> ll = {-5, 12, 7};  // NOLINT(runtime/int)
+    const std::vector<unsigned long long> ull = {3, 1ull << 40, 9};  // NOLINT(runtime/int)
+    LogReductionPlan plan;
+    plan.add("ll", typeid(long long), LogReductionPlan::Sum);  // NOLINT(runtime/int)
+    plan.add("ull", typeid(unsigned long long), LogReductionPlan::Max);  // NOLINT(runtime/int)
+    const std::vector<LogReductionPartial> partials = plan.reduceHost({ll.data(), ull.data()}, 3);
+    EXPECT_EQ(result<long long>(plan, 0, partials[0], LogReductionPlan::Sum), 14);  // NOLINT(runtime/int)
+    EXPECT_EQ(result<long long>(plan, 0, partials[0], LogReductionPlan::Min), -5);  // NOLINT(runtime/int)
+    EXPECT_EQ(result<unsigned long long>(plan, 1, partials[1], LogReductionPlan::Max), 1ull << 40);  // NOLINT(runtime/int)
+    EXPECT_EQ(result<unsigned long long>(plan, 1, partials[1], LogReductionPlan::Sum), (1ull << 40) + 12);  // NOLINT(runtime/int)
+}
+TEST(LogReductionPlanTest, MergeMatchesSinglePass) {
+    // Partials of disjoint subsets, merged in any grouping, match the partial of the whole population
+    std::vector<double> d(777);
+    for (size_t j = 0; j < d.size(); ++j)
+        d[j] = 1e6 + static_cast<double>((j * 7919) % 1000) / 7;
+    LogReductionPlan plan;
+    plan.add("d", typeid(double), LogReductionPlan::StandardDev);
+    const LogReductionPartial whole = plan.reduceHost({d.data()}, static_cast<unsigned int>(d.size()))[0];
+    LogReductionPartial merged;
+    merged.init(detail::LogReductionKind::Float);
+    for (size_t begin = 0; begin < d.size(); begin += 100) {
+        const unsigned int count = static_cast<unsigned int>(std::min<size_t>(100, d.size() - begin));
+        merged.merge(detail::LogReductionKind::Float, plan.reduceHost({d.data() + begin}, count)[0]);
+    }
+    EXPECT_EQ(merged.count, whole.count);
+    EXPECT_NEAR(merged.mean, whole.mean, 1e-6);
+    EXPECT_NEAR(merged.m2 / merged.count, whole.m2 / whole.count, 1e-6);
+    EXPECT_EQ(merged.sum.f, whole.sum.f);
+    EXPECT_EQ(merged.min.f, whole.min.f);
+    EXPECT_EQ(merged.max.f, whole.max.f);
+}
+TEST(LogReductionPlanTest, EmptyPopulation) {
+    // Results match the individual reductions of an empty population
+    LogReductionPlan plan;
+    plan.add("i", typeid(int16_t), LogReductionPlan::Min);
+    plan.add("c", typeid(char), LogReductionPlan::Sum);
+    const std::vector<LogReductionPartial> partials = plan.reduceHost({nullptr, nullptr}, 0);
+    EXPECT_EQ(result<double>(plan, 0, partials[0], LogReductionPlan::Mean), 0.0);
+    EXPECT_EQ(result<double>(plan, 0, partials[0], LogReductionPlan::StandardDev), 0.0);
+    EXPECT_EQ(result<int64_t>(plan, 0, partials[0], LogReductionPlan::Sum), 0);
+    EXPECT_EQ(result<int16_t>(plan, 0, partials[0], LogReductionPlan::Min), std::numeric_limits<int16_t>::max());
+    EXPECT_EQ(result<int16_t>(plan, 0, partials[0], LogReductionPlan::Max), std::numeric_limits<int16_t>::lowest());
+    EXPECT_EQ(result<uint64_t>(plan, 1, partials[1], LogReductionPlan::Sum), 0u);
+}
+
+}  // namespace test_log_reduction_plan
+}  // namespace flamegpu
@@ -69,6 +69,25 @@ TEST(TestRunPlan, setOutputSubdirectory) {
     // By default this is an empty string
     EXPECT_EQ(updatedSubdir, newSubdir);
 }
+TEST(TestRunPlan, setCostEstimate) {
+    // Create a model
+    flamegpu::ModelDescription model("test");
+    // Create an individual run plan.
+    flamegpu::RunPlan plan(model);
+    // By default there is no estimate
+    EXPECT_EQ(plan.getCostEstimate(), 0.0);
+    plan.setCostEstimate(12.5);
+    EXPECT_EQ(plan.getCostEstimate(), 12.5);
+    // Returning to 0 is permitted, but negative costs are not
+    EXPECT_NO_THROW(plan.setCostEstimate(0.0));
+    EXPECT_THROW(plan.setCostEstimate(-1.0), flamegpu::exception::OutOfBoundsException);
+    EXPECT_EQ(plan.getCostEstimate(), 0.0);
+    // The estimate is copied by assignment
+    flamegpu::RunPlan plan2(model);
+    plan2.setCostEstimate(3.0);
+    plan = plan2;
+    EXPECT_EQ(plan.getCostEstimate(), 3.0);
+}
 TEST(TestRunPlan, setProperty) {
     // Create a model
     flamegpu::ModelDescription model("test");
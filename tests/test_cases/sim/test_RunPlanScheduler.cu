@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/flamegpu.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+namespace tests {
+namespace test_runplanscheduler {
+
+/**
+ * Stands in for the runners of a CUDAEnsemble, without making any CUDA calls
+ * Each runner executes a plan for it's cost, in simulated time, before taking the next plan from the queue
+ * @return The simulated time at which the final run completes
+ */
+double fakeEnsemble(const RunPlanVector &plans, const RunPlanScheduler &scheduler, unsigned int runner_count) {
+    detail::RunPlanQueue queue(scheduler.getOrder(plans), static_cast<unsigned int>(plans.size()));
+    std::vector<double> runner_time(runner_count, 0);
+    unsigned int run_id;
+    while (true) {
+        // The runner which finishes first takes the next plan
+        auto runner = std::min_element(runner_time.begin(), runner_time.end());
+        if (!queue.next(run_id))
+            break;
+        *runner += LongestFirstScheduler::defaultCost(plans[run_id]);
+    }
+    return *std::max_element(runner_time.begin(), runner_time.end());
+}
+
+TEST(TestRunPlanScheduler, IndexOrder) {
+    flamegpu::ModelDescription model("test");
+    flamegpu::RunPlanVector plans(model, 5);
+    for (unsigned int i = 0; i < plans.size(); ++i)
+        plans[i].setSteps(10 - i);
+    const std::vector<unsigned int> expected = {0, 1, 2, 3, 4};
+    EXPECT_EQ(IndexOrderScheduler().getOrder(plans), expected);
+}
+TEST(TestRunPlanScheduler, LongestFirst) {
+    flamegpu::ModelDescription model("test");
+    flamegpu::RunPlanVector plans(model, 6);
+    const unsigned int steps[6] = {5, 100, 5, 20, 100, 1};
+    for (unsigned int i = 0; i < plans.size(); ++i)
+        plans[i].setSteps(steps[i]);
+    // Plans of equal cost retain their relative order
+    const std::vector<unsigned int> expected = {1, 4, 3, 0, 2, 5};
+    EXPECT_EQ(LongestFirstScheduler().getOrder(plans), expected);
+    // A cost estimate takes precedence over steps
+    plans[5].setCostEstimate(1000);
+    const std::vector<unsigned int> expected_estimate = {5, 1, 4, 3, 0, 2};
+    EXPECT_EQ(LongestFirstScheduler().getOrder(plans), expected_estimate);
+}
+TEST(TestRunPlanScheduler, LongestFirstUnlimitedSteps) {
+    // Runs with unlimited steps, are issued before any run of known length
+    flamegpu::ModelDescription model("test");
+    model.addExitCondition([](HostAPI *) { return flamegpu::EXIT; });
+    flamegpu::RunPlanVector plans(model, 3);
+    plans[0].setSteps(1000);
+    plans[1].setSteps(0);
+    plans[2].setSteps(1);
+    const std::vector<unsigned int> expected = {1, 0, 2};
+    EXPECT_EQ(LongestFirstScheduler().getOrder(plans), expected);
+}
+TEST(TestRunPlanScheduler, PropertyCost) {
+    flamegpu::ModelDescription model("test");
+    model.Environment().newProperty<uint32_t>("POPULATION_TO_GENERATE", 10, true);
+    flamegpu::RunPlanVector plans(model, 4);
+    plans.setSteps(10);
+    plans[1].setProperty<uint32_t>("POPULATION_TO_GENERATE", 1000);
+    plans[2].setProperty<uint32_t>("POPULATION_TO_GENERATE", 100);
+    plans[3].setSteps(1000);
+    const auto cost = LongestFirstScheduler::propertyCost<uint32_t>("POPULATION_TO_GENERATE");
+    EXPECT_EQ(cost(plans[0]), 100.0);
+    EXPECT_EQ(cost(plans[1]), 10000.0);
+    EXPECT_EQ(cost(plans[3]), 10000.0);
+    const std::vector<unsigned int> expected = {1, 3, 2, 0};
+    EXPECT_EQ(LongestFirstScheduler(cost).getOrder(plans), expected);
+    // Property type is validated when the cost is evaluated
+    EXPECT_THROW(LongestFirstScheduler(LongestFirstScheduler::propertyCost<float>("POPULATION_TO_GENERATE")).getOrder(plans), exception::InvalidEnvPropertyType);
+}
+TEST(TestRunPlanScheduler, LongestFirstReducesMakespan) {
+    // Plan lengths vary by 100x, with the longest plans at the end of the vector
+    flamegpu::ModelDescription model("test");
+    flamegpu::RunPlanVector plans(model, 34);
+    for (unsigned int i = 0; i < plans.size(); ++i)
+        plans[i].setSteps(i < 32 ? 100 : 10000);
+    const double index_makespan = fakeEnsemble(plans, IndexOrderScheduler(), 4);
+    const double longest_makespan = fakeEnsemble(plans, LongestFirstScheduler(), 4);
+    // In index order, every runner first executes 8 short plans, before two of them take a long plan
+    EXPECT_EQ(index_makespan, 10800.0);
+    // Longest first, the short plans are shared by the two runners not executing a long plan
+    EXPECT_EQ(longest_makespan, 10000.0);
+    EXPECT_LT(longest_makespan, index_makespan);
+}
+TEST(TestRunPlanScheduler, QueueIssuesEachPlanOnce) {
+    flamegpu::ModelDescription model("test");
+    flamegpu::RunPlanVector plans(model, 1000);
+    for (unsigned int i = 0; i < plans.size(); ++i)
+        plans[i].setSteps(1 + (i * 7919) % 100);
+    detail::RunPlanQueue queue(LongestFirstScheduler().getOrder(plans), static_cast<unsigned int>(plans.size()));
+    EXPECT_EQ(queue.size(), plans.size());
+    // Several threads take plans concurrently, as SimRunner does
+    std::mutex issued_mutex;
+    std::vector<unsigned int> issued;
+    std::vector<std::thread> runners;
+    for (int t = 0; t < 8; ++t) {
+        runners.emplace_back([&queue, &issued, &issued_mutex]() {
+            unsigned int run_id;
+            while (queue.next(run_id)) {
+                std::lock_guard<std::mutex> lock(issued_mutex);
+                issued.push_back(run_id);
+            }
+        });
+    }
+    for (auto &r : runners)
+        r.join();
+    EXPECT_EQ(queue.getIssuedCount(), plans.size());
+    ASSERT_EQ(issued.size(), plans.size());
+    std::sort(issued.begin(), issued.end());
+    for (unsigned int i = 0; i < issued.size(); ++i)
+        EXPECT_EQ(issued[i], i);
+}
+TEST(TestRunPlanScheduler, QueueValidatesOrder) {
+    EXPECT_NO_THROW(detail::RunPlanQueue({2, 0, 1}, 3));
+    EXPECT_NO_THROW(detail::RunPlanQueue({}, 0));
+    // Wrong length
+    EXPECT_THROW(detail::RunPlanQueue({0, 1}, 3), exception::InvalidArgument);
+    // Out of range
+    EXPECT_THROW(detail::RunPlanQueue({0, 1, 3}, 3), exception::InvalidArgument);
+    // Repeated
+    EXPECT_THROW(detail::RunPlanQueue({0, 1, 1}, 3), exception::InvalidArgument);
+}
+
+}  // namespace test_runplanscheduler
+}  // namespace tests
+}  // namespace flamegpu
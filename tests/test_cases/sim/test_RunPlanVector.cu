@@ -1,3 +1,5 @@
+#include <set>
+
 #include "flamegpu/flamegpu.h"
 
 #include "gtest/gtest.h"
@@ -497,6 +499,129 @@ TEST(TestRunPlanVector, setPropertyRandom) {
     EXPECT_THROW((plans.setPropertyRandom<double>("d3", static_cast<EnvironmentManager::size_type>(-1), d3dist0)), exception::OutOfBoundsException);
     EXPECT_THROW((plans.setPropertyRandom<double>("d3", 4u, d3dist0)), exception::OutOfBoundsException);
 }
+// Each design fills [0, 1) of every dimension with one point per stratum (Sobol requires a power of 2 plans)
+// So every stratum of each property's range should be hit exactly once
+TEST(TestRunPlanVector, setPropertiesLatinHypercube) {
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 1.0f);
+    environment.newProperty<int32_t>("i", 1);
+    environment.newProperty<uint32_t, 3>("u3", {{0, 1, 2}});
+    constexpr uint32_t totalPlans = 8u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    plans.setRandomPropertySeed(1u);
+    flamegpu::SampleSpace space;
+    space.addProperty<float>("f", 0.0f, 8.0f)
+        .addProperty<int32_t>("i", 10, 17)
+        .addProperty<uint32_t>("u3", 1, 100u, 107u);
+    EXPECT_EQ(space.getDimensions(), 3u);
+    plans.setPropertiesLatinHypercube(space);
+    std::set<int32_t> f_strata, i_values;
+    std::set<uint32_t> u_values;
+    for (const auto &plan : plans) {
+        const float f = plan.getProperty<float>("f");
+        EXPECT_GE(f, 0.0f);
+        EXPECT_LT(f, 8.0f);
+        f_strata.insert(static_cast<int32_t>(f));
+        i_values.insert(plan.getProperty<int32_t>("i"));
+        const std::array<uint32_t, 3> u3 = plan.getProperty<uint32_t, 3>("u3");
+        EXPECT_EQ(u3[0], 0u);
+        EXPECT_EQ(u3[2], 2u);
+        u_values.insert(u3[1]);
+    }
+    // 8 plans over ranges of width 8, so every integer is sampled once
+    EXPECT_EQ(f_strata.size(), totalPlans);
+    EXPECT_EQ(i_values.size(), totalPlans);
+    EXPECT_EQ(*i_values.begin(), 10);
+    EXPECT_EQ(*i_values.rbegin(), 17);
+    EXPECT_EQ(u_values.size(), totalPlans);
+    // The same seed reproduces the same design
+    flamegpu::RunPlanVector plans2(model, totalPlans);
+    plans2.setRandomPropertySeed(1u);
+    plans2.setPropertiesLatinHypercube(space);
+    for (uint32_t idx = 0; idx < totalPlans; ++idx) {
+        EXPECT_EQ(plans[idx].getProperty<float>("f"), plans2[idx].getProperty<float>("f"));
+        EXPECT_EQ(plans[idx].getProperty<int32_t>("i"), plans2[idx].getProperty<int32_t>("i"));
+    }
+}
+TEST(TestRunPlanVector, setPropertiesSobol) {
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<double>("d", 1.0);
+    environment.newProperty<int32_t>("i", 1);
+    constexpr uint32_t totalPlans = 4u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    flamegpu::SampleSpace space;
+    space.addProperty<double>("d", 0.0, 4.0)
+        .addProperty<int32_t>("i", 0, 3);
+    plans.setPropertiesSobol(space);
+    // Unscrambled Sobol, so the design is known
+    const double d_expected[totalPlans] = {0.0, 2.0, 3.0, 1.0};
+    const int32_t i_expected[totalPlans] = {0, 2, 1, 3};
+    for (uint32_t idx = 0; idx < totalPlans; ++idx) {
+        EXPECT_EQ(plans[idx].getProperty<double>("d"), d_expected[idx]);
+        EXPECT_EQ(plans[idx].getProperty<int32_t>("i"), i_expected[idx]);
+    }
+}
+TEST(TestRunPlanVector, setPropertiesHalton) {
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<double>("d2", 1.0);
+    environment.newProperty<double>("d3", 1.0);
+    constexpr uint32_t totalPlans = 3u;
+    flamegpu::RunPlanVector plans(model, totalPlans);
+    flamegpu::SampleSpace space;
+    space.addProperty<double>("d2", 0.0, 8.0)
+        .addProperty<double>("d3", 0.0, 9.0);
+    plans.setPropertiesHalton(space);
+    const double d2_expected[totalPlans] = {4.0, 2.0, 6.0};
+    const double d3_expected[totalPlans] = {3.0, 6.0, 1.0};
+    for (uint32_t idx = 0; idx < totalPlans; ++idx) {
+        EXPECT_DOUBLE_EQ(plans[idx].getProperty<double>("d2"), d2_expected[idx]);
+        EXPECT_DOUBLE_EQ(plans[idx].getProperty<double>("d3"), d3_expected[idx]);
+    }
+}
+TEST(TestRunPlanVector, setPropertiesSampleSpaceExceptions) {
+    flamegpu::ModelDescription model("test");
+    auto &environment = model.Environment();
+    environment.newProperty<float>("f", 1.0f);
+    environment.newProperty<uint32_t, 3>("u3", {{0, 1, 2}});
+    flamegpu::RunPlanVector plans(model, 4u);
+    flamegpu::RunPlanVector single(model, 1u);
+    // Invalid range
+    flamegpu::SampleSpace space;
+    EXPECT_THROW(space.addProperty<float>("f", 2.0f, 1.0f), exception::InvalidArgument);
+    // Valid space, too few plans
+    space.addProperty<float>("f", 1.0f, 2.0f);
+    EXPECT_THROW(single.setPropertiesLatinHypercube(space), exception::OutOfBoundsException);
+    EXPECT_THROW(single.setPropertiesSobol(space), exception::OutOfBoundsException);
+    EXPECT_THROW(single.setPropertiesHalton(space), exception::OutOfBoundsException);
+    EXPECT_NO_THROW(plans.setPropertiesLatinHypercube(space));
+    // Unknown property
+    flamegpu::SampleSpace missing;
+    missing.addProperty<float>("does_not_exist", 1.0f, 2.0f);
+    EXPECT_THROW(plans.setPropertiesLatinHypercube(missing), exception::InvalidEnvProperty);
+    EXPECT_THROW(plans.setPropertiesSobol(missing), exception::InvalidEnvProperty);
+    EXPECT_THROW(plans.setPropertiesHalton(missing), exception::InvalidEnvProperty);
+    // Type mismatch
+    flamegpu::SampleSpace wrong_type;
+    wrong_type.addProperty<double>("f", 1.0, 2.0);
+    EXPECT_THROW(plans.setPropertiesSobol(wrong_type), exception::InvalidEnvPropertyType);
+    // Array without index
+    flamegpu::SampleSpace array;
+    array.addProperty<uint32_t>("u3", 1u, 2u);
+    EXPECT_THROW(plans.setPropertiesSobol(array), exception::InvalidEnvPropertyType);
+    // Index out of bounds
+    flamegpu::SampleSpace bad_index;
+    bad_index.addProperty<uint32_t>("u3", 3, 1u, 2u);
+    EXPECT_THROW(plans.setPropertiesSobol(bad_index), exception::OutOfBoundsException);
+    // Too many dimensions for Sobol, validation occurs before plans are modified
+    flamegpu::SampleSpace large;
+    for (unsigned int j = 0; j < 22; ++j)
+        large.addProperty<float>("f", 1.0f, 2.0f);
+    EXPECT_THROW(plans.setPropertiesSobol(large), exception::OutOfBoundsException);
+    EXPECT_NO_THROW(plans.setPropertiesHalton(large));
+}
 // Test getting the random property seed
 TEST(TestRunPlanVector, getRandomPropertySeed) {
     // Define the simple model to use
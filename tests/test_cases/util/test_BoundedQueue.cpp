@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/util/detail/BoundedQueue.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_bounded_queue {
+using util::detail::BoundedQueue;
+
+TEST(TestBoundedQueue, FIFO) {
+    BoundedQueue<unsigned int> queue;
+    EXPECT_EQ(queue.getCapacity(), 0u);
+    for (unsigned int i = 0; i < 10; ++i)
+        EXPECT_TRUE(queue.push(i));
+    EXPECT_EQ(queue.size(), 10u);
+    unsigned int item = 0;
+    for (unsigned int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_EQ(queue.size(), 0u);
+}
+TEST(TestBoundedQueue, Close) {
+    BoundedQueue<unsigned int> queue;
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+    // Pushing to a closed queue fails
+    EXPECT_FALSE(queue.push(3));
+    // Remaining items are drained, before pop fails
+    unsigned int item = 0;
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 1u);
+    EXPECT_TRUE(queue.pop(item));
+    EXPECT_EQ(item, 2u);
+    EXPECT_FALSE(queue.pop(item));
+}
+TEST(TestBoundedQueue, CloseWakesConsumers) {
+    BoundedQueue<unsigned int> queue;
+    std::atomic<unsigned int> exited = {0};
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < 4; ++i) {
+        consumers.emplace_back([&queue, &exited]() {
+            unsigned int item;
+            while (queue.pop(item)) { }
+            ++exited;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(exited.load(), 0u);
+    queue.close();
+    for (auto &c : consumers)
+        c.join();
+    EXPECT_EQ(exited.load(), 4u);
+}
+TEST(TestBoundedQueue, BackPressure) {
+    BoundedQueue<unsigned int> queue(2);
+    EXPECT_EQ(queue.getCapacity(), 2u);
+    std::atomic<unsigned int> pushed = {0};
+    std::thread producer([&queue, &pushed]() {
+        for (unsigned int i = 0; i < 5; ++i) {
+            queue.push(i);
+            ++pushed;
+        }
+    });
+    // The producer blocks once the queue is full
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pushed.load() < 2 && std::chrono::steady_clock::now() < timeout)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(pushed.load(), 2u);
+    EXPECT_EQ(queue.size(), 2u);
+    // Each pop releases the producer
+    unsigned int item = 0;
+    for (unsigned int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+        EXPECT_LE(queue.size(), 2u);
+    }
+    producer.join();
+    EXPECT_EQ(pushed.load(), 5u);
+}
+TEST(TestBoundedQueue, CloseReleasesProducers) {
+    BoundedQueue<unsigned int> queue(1);
+    queue.push(0);
+    std::atomic<int> result = {-1};
+    std::thread producer([&queue, &result]() {
+        result = queue.push(1) ? 1 : 0;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(result.load(), -1);
+    queue.close();
+    producer.join();
+    EXPECT_EQ(result.load(), 0);
+}
+TEST(TestBoundedQueue, ManyProducersConsumers) {
+    BoundedQueue<unsigned int> queue(8);
+    const unsigned int PER_PRODUCER = 1000;
+    std::vector<std::thread> producers, consumers;
+    std::vector<std::vector<unsigned int>> received(4);
+    for (unsigned int p = 0; p < 4; ++p) {
+        producers.emplace_back([&queue, p, PER_PRODUCER]() {
+            for (unsigned int i = 0; i < PER_PRODUCER; ++i)
+                queue.push(p * PER_PRODUCER + i);
+        });
+    }
+    for (unsigned int c = 0; c < 4; ++c) {
+        consumers.emplace_back([&queue, &received, c]() {
+            unsigned int item;
+            while (queue.pop(item))
+                received[c].push_back(item);
+        });
+    }
+    for (auto &p : producers)
+        p.join();
+    queue.close();
+    for (auto &c : consumers)
+        c.join();
+    std::vector<unsigned int> all;
+    for (const auto &r : received)
+        all.insert(all.end(), r.begin(), r.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), 4 * PER_PRODUCER);
+    for (unsigned int i = 0; i < all.size(); ++i)
+        EXPECT_EQ(all[i], i);
+}
+
+}  // namespace test_bounded_queue
+}  // namespace flamegpu
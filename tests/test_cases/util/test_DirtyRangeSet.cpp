@@ -0,0 +1,94 @@
+#include <utility>
+#include <vector>
+
+#include "flamegpu/util/detail/DirtyRangeSet.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_dirty_range_set {
+typedef std::vector<util::detail::DirtyRangeSet::Range> Ranges;
+
+TEST(TestDirtyRangeSet, Empty) {
+    util::detail::DirtyRangeSet set;
+    EXPECT_TRUE(set.empty());
+    set.add(5, 5);
+    set.add(6, 2);
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(set.count(), 0u);
+    EXPECT_EQ(set.getBounds(), util::detail::DirtyRangeSet::Range(0, 0));
+}
+TEST(TestDirtyRangeSet, SequentialMerge) {
+    util::detail::DirtyRangeSet set;
+    // Adjacent single element changes, as produced by AgentVector::Agent::setVariable(), become a single range
+    for (size_t i = 10; i < 20; ++i)
+        set.add(i, i + 1);
+    EXPECT_EQ(set.getRanges(), (Ranges{{10, 20}}));
+    set.add(30, 31);
+    set.add(15, 25);
+    EXPECT_EQ(set.getRanges(), (Ranges{{10, 25}, {30, 31}}));
+    EXPECT_EQ(set.count(), 16u);
+    EXPECT_EQ(set.getBounds(), util::detail::DirtyRangeSet::Range(10, 31));
+}
+TEST(TestDirtyRangeSet, OutOfOrderMerge) {
+    util::detail::DirtyRangeSet set;
+    set.add(50, 60);
+    set.add(10, 20);
+    set.add(30, 40);
+    EXPECT_EQ(set.getRanges(), (Ranges{{10, 20}, {30, 40}, {50, 60}}));
+    // Insert between existing ranges
+    set.add(22, 24);
+    EXPECT_EQ(set.getRanges(), (Ranges{{10, 20}, {22, 24}, {30, 40}, {50, 60}}));
+    // Bridge several ranges
+    set.add(20, 35);
+    EXPECT_EQ(set.getRanges(), (Ranges{{10, 40}, {50, 60}}));
+    // Extend the front
+    set.add(0, 10);
+    EXPECT_EQ(set.getRanges(), (Ranges{{0, 40}, {50, 60}}));
+    // Contained
+    set.add(52, 55);
+    EXPECT_EQ(set.getRanges(), (Ranges{{0, 40}, {50, 60}}));
+}
+TEST(TestDirtyRangeSet, MaxRanges) {
+    util::detail::DirtyRangeSet set(3);
+    set.add(0, 1);
+    set.add(10, 11);
+    set.add(12, 13);
+    set.add(30, 31);
+    // The smallest gap (11 to 12) is merged
+    EXPECT_EQ(set.getRanges(), (Ranges{{0, 1}, {10, 13}, {30, 31}}));
+    set.add(100, 101);
+    EXPECT_EQ(set.getRanges(), (Ranges{{0, 13}, {30, 31}, {100, 101}}));
+    util::detail::DirtyRangeSet single(0);
+    single.add(0, 1);
+    single.add(99, 100);
+    EXPECT_EQ(single.getRanges(), (Ranges{{0, 100}}));
+}
+TEST(TestDirtyRangeSet, Truncate) {
+    util::detail::DirtyRangeSet set;
+    set.add(0, 10);
+    set.add(20, 30);
+    set.add(40, 50);
+    set.truncate(25);
+    EXPECT_EQ(set.getRanges(), (Ranges{{0, 10}, {20, 25}}));
+    set.truncate(20);
+    EXPECT_EQ(set.getRanges(), (Ranges{{0, 10}}));
+    set.clear();
+    EXPECT_TRUE(set.empty());
+}
+TEST(TestDirtyRangeSet, CoalescedRanges) {
+    util::detail::DirtyRangeSet set;
+    EXPECT_TRUE(set.getCoalescedRanges(8).empty());
+    set.add(0, 4);
+    set.add(8, 12);
+    set.add(20, 24);
+    set.add(100, 104);
+    EXPECT_EQ(set.getCoalescedRanges(0), set.getRanges());
+    EXPECT_EQ(set.getCoalescedRanges(4), (Ranges{{0, 12}, {20, 24}, {100, 104}}));
+    EXPECT_EQ(set.getCoalescedRanges(8), (Ranges{{0, 24}, {100, 104}}));
+    EXPECT_EQ(set.getCoalescedRanges(1000), (Ranges{{0, 104}}));
+    // The set itself is unchanged
+    EXPECT_EQ(set.getRanges().size(), 4u);
+}
+
+}  // namespace test_dirty_range_set
+}  // namespace flamegpu
@@ -0,0 +1,211 @@
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+// If earlier than VS 2019
+#if defined(_MSC_VER) && _MSC_VER < 1920
+#include <filesystem>
+using std::tr2::sys::create_directory;
+using std::tr2::sys::directory_iterator;
+using std::tr2::sys::exists;
+using std::tr2::sys::path;
+using std::tr2::sys::remove_all;
+#else
+// VS2019 requires this macro, as building pre c++17 cant use std::filesystem
+#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
+#include <experimental/filesystem>
+using std::experimental::filesystem::v1::create_directory;
+using std::experimental::filesystem::v1::directory_iterator;
+using std::experimental::filesystem::v1::exists;
+using std::experimental::filesystem::v1::path;
+using std::experimental::filesystem::v1::remove_all;
+#endif
+
+#include "flamegpu/util/detail/KernelCacheStore.h"
+#include "flamegpu/util/detail/SHA256.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_kernel_cache_store {
+using util::detail::KernelCacheStore;
+using util::detail::SHA256;
+
+const char *STORE_DIR = "test_kernel_cache_store";
+
+class KernelCacheStoreTest : public testing::Test {
+ protected:
+    void SetUp() override {
+        ::remove_all(STORE_DIR);
+        create_directory(STORE_DIR);
+    }
+    void TearDown() override {
+        ::remove_all(STORE_DIR);
+    }
+    /**
+     * Returns a compressible value, resembling PTX
+     */
+    static std::string makeValue(unsigned int seed, size_t lines) {
+        std::stringstream ss;
+        for (size_t i = 0; i < lines; ++i) {
+            ss << "\tld.global.f32 \t%f" << (i * 7 + seed) % 97 << ", [%rd" << (i + seed) % 13 << "+" << 4 * i << "];\n";
+        }
+        return ss.str();
+    }
+    static path entryPath(const std::string &key) {
+        return path(STORE_DIR) / path(key + ".fgpuk");
+    }
+};
+
+TEST_F(KernelCacheStoreTest, StoreLoad) {
+    for (const bool compress : {false, true}) {
+        KernelCacheStore store(STORE_DIR, KernelCacheStore::DEFAULT_MAX_BYTES, compress);
+        const std::string value = makeValue(compress, 1000);
+        const std::string key = SHA256::hash(value);
+        std::string loaded;
+        EXPECT_FALSE(store.load(key, loaded));
+        store.store(key, value);
+        EXPECT_TRUE(exists(entryPath(key)));
+        ASSERT_TRUE(store.load(key, loaded));
+        EXPECT_EQ(loaded, value);
+        // Compression is recorded per entry, so entries are readable regardless of the current setting
+        store.setCompression(!compress);
+        ASSERT_TRUE(store.load(key, loaded));
+        EXPECT_EQ(loaded, value);
+        if (compress) {
+            EXPECT_LT(store.getSize(), value.size() / 2);
+        } else {
+            EXPECT_GT(store.getSize(), value.size());
+        }
+        store.clear();
+        EXPECT_EQ(store.getSize(), 0u);
+        EXPECT_FALSE(store.load(key, loaded));
+    }
+}
+TEST_F(KernelCacheStoreTest, Compression) {
+    KernelCacheStore store(STORE_DIR);
+    // Edge cases of the codec: empty, shorter than a match, long runs and incompressible data
+    std::string noise;
+    unsigned int x = 12345;
+    for (int i = 0; i < 100000; ++i) {
+        x = x * 1103515245u + 12345u;
+        noise.push_back(static_cast<char>(x >> 16));
+    }
+    const std::vector<std::string> values = {"", "abc", std::string(100000, 'x'), noise, makeValue(3, 5000) + noise + makeValue(4, 10)};
+    for (size_t i = 0; i < values.size(); ++i) {
+        const std::string key = "k" + std::to_string(i);
+        store.store(key, values[i]);
+        std::string loaded = "stale";
+        ASSERT_TRUE(store.load(key, loaded)) << i;
+        EXPECT_EQ(loaded, values[i]) << i;
+    }
+}
+TEST_F(KernelCacheStoreTest, DamagedEntry) {
+    KernelCacheStore store(STORE_DIR);
+    const std::string value = makeValue(1, 100);
+    store.store("a", value);
+    store.store("b", value);
+    std::string loaded;
+    {
+        // Truncate a
+        std::ofstream ofs(entryPath("a").string(), std::ofstream::binary | std::ofstream::trunc);
+        ofs << "FGPUKC01";
+    }
+    EXPECT_FALSE(store.load("a", loaded));
+    {
+        // Rename b, so that it's contents does not match its key
+        std::ifstream ifs(entryPath("b").string(), std::ifstream::binary);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        std::ofstream ofs(entryPath("c").string(), std::ofstream::binary);
+        ofs << ss.str();
+    }
+    EXPECT_FALSE(store.load("c", loaded));
+    EXPECT_TRUE(store.load("b", loaded));
+    // Keys are used as file names, so must be validated
+    EXPECT_THROW(store.load("../b", loaded), exception::InvalidArgument);
+    EXPECT_THROW(store.store("", value), exception::InvalidArgument);
+}
+TEST_F(KernelCacheStoreTest, Eviction) {
+    const std::string value = makeValue(0, 200);
+    uint64_t entry_size;
+    {
+        KernelCacheStore store(STORE_DIR, 0, false);
+        store.store("p", value);
+        entry_size = store.getSize();
+        store.clear();
+    }
+    // Budget for 3 entries
+    KernelCacheStore store(STORE_DIR, 3 * entry_size, false);
+    std::string loaded;
+    store.store("a", value);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    store.store("b", value);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    store.store("c", value);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    // Use a, so that b is least recently used
+    ASSERT_TRUE(store.load("a", loaded));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    store.store("d", value);
+    EXPECT_EQ(store.getSize(), 3 * entry_size);
+    EXPECT_TRUE(exists(entryPath("a")));
+    EXPECT_FALSE(exists(entryPath("b")));
+    EXPECT_TRUE(exists(entryPath("c")));
+    EXPECT_TRUE(exists(entryPath("d")));
+    // Recency persists between stores (e.g. processes) via the index
+    {
+        KernelCacheStore other(STORE_DIR, 3 * entry_size, false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        other.store("e", value);
+    }
+    EXPECT_TRUE(exists(entryPath("a")));
+    EXPECT_FALSE(exists(entryPath("c")));
+    EXPECT_TRUE(exists(entryPath("d")));
+    EXPECT_TRUE(exists(entryPath("e")));
+    // Shrinking the budget evicts on the next store, but never the entry being stored
+    store.setMaxBytes(entry_size / 2);
+    store.store("f", value);
+    EXPECT_EQ(store.getSize(), entry_size);
+    EXPECT_TRUE(exists(entryPath("f")));
+}
+TEST_F(KernelCacheStoreTest, ConcurrentStores) {
+    // Many writers replacing the same entries never leave a partial entry, or temporary files
+    const unsigned int THREADS = 8;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([]() {
+            // Each thread acts as a separate process, with its own store
+            KernelCacheStore store(STORE_DIR);
+            std::string loaded;
+            for (unsigned int i = 0; i < 20; ++i) {
+                const std::string key = "k" + std::to_string(i % 4);
+                const std::string value = makeValue(i % 4, 500);
+                store.store(key, value);
+                if (store.load(key, loaded)) {
+                    EXPECT_EQ(loaded, value);
+                }
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    KernelCacheStore store(STORE_DIR);
+    std::string loaded;
+    for (unsigned int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(store.load("k" + std::to_string(i), loaded));
+        EXPECT_EQ(loaded, makeValue(i, 500));
+    }
+    unsigned int files = 0;
+    for (auto &p : directory_iterator(STORE_DIR)) {
+        EXPECT_NE(p.path().extension().string(), ".tmp");
+        ++files;
+    }
+    // 4 entries and the index
+    EXPECT_EQ(files, 5u);
+}
+
+}  // namespace test_kernel_cache_store
+}  // namespace flamegpu
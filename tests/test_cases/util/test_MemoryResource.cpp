@@ -0,0 +1,224 @@
+#include <climits>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/util/detail/MemoryResource.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_memory_resource {
+using util::detail::MemoryResource;
+using util::detail::HostMemoryResource;
+using util::detail::PoolMemoryResource;
+
+/**
+ * Host upstream resource, which counts the calls made to it
+ * Can be limited to a number of live allocations, to simulate running out of memory
+ */
+class CountingResource : public MemoryResource {
+ public:
+    void *allocate(size_t bytes) override {
+        if (live >= limit)
+            return nullptr;
+        ++allocations;
+        ++live;
+        return host.allocate(bytes);
+    }
+    void deallocate(void *ptr) override {
+        ++deallocations;
+        --live;
+        host.deallocate(ptr);
+    }
+    HostMemoryResource host;
+    unsigned int allocations = 0;
+    unsigned int deallocations = 0;
+    unsigned int live = 0;
+    unsigned int limit = UINT_MAX;
+};
+
+TEST(TestMemoryResource, BlockSize) {
+    EXPECT_EQ(PoolMemoryResource::getBlockSize(1), PoolMemoryResource::MIN_BLOCK_SIZE);
+    EXPECT_EQ(PoolMemoryResource::getBlockSize(256), 256u);
+    // Four size classes per power of two
+    EXPECT_EQ(PoolMemoryResource::getBlockSize(257), 320u);
+    EXPECT_EQ(PoolMemoryResource::getBlockSize(321), 384u);
+    EXPECT_EQ(PoolMemoryResource::getBlockSize(449), 512u);
+    EXPECT_EQ(PoolMemoryResource::getBlockSize(1024 * 1024 + 1), 1024u * 1024u * 5 / 4);
+    // Every block size satisfies it's request, wasting atmost a quarter of the next lower power of two
+    for (size_t bytes = 257; bytes < 100000; bytes += 37) {
+        const size_t block = PoolMemoryResource::getBlockSize(bytes);
+        EXPECT_GE(block, bytes);
+        EXPECT_LT(block - bytes, bytes / 4);
+    }
+}
+TEST(TestMemoryResource, Reuse) {
+    CountingResource upstream;
+    PoolMemoryResource pool(upstream);
+    void *a = pool.allocate(1000);
+    ASSERT_NE(a, nullptr);
+    pool.deallocate(a);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, PoolMemoryResource::getBlockSize(1000));
+    // Requests within the same size class reuse the cached buffer
+    void *b = pool.allocate(900);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(upstream.allocations, 1u);
+    EXPECT_EQ(pool.getStatistics().cache_hits, 1u);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, 0u);
+    // A larger class requires a new buffer
+    void *c = pool.allocate(4000);
+    EXPECT_NE(b, c);
+    EXPECT_EQ(upstream.allocations, 2u);
+    pool.deallocate(b);
+    pool.deallocate(c);
+    EXPECT_EQ(upstream.deallocations, 0u);
+    // Cached buffers are released by trim, and the destructor
+    pool.trim();
+    EXPECT_EQ(upstream.deallocations, 2u);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, 0u);
+}
+TEST(TestMemoryResource, Statistics) {
+    CountingResource upstream;
+    PoolMemoryResource pool(upstream);
+    void *a = pool.allocate(256);
+    void *b = pool.allocate(512);
+    EXPECT_EQ(pool.getStatistics().bytes_in_use, 768u);
+    pool.deallocate(a);
+    void *c = pool.allocate(1024);
+    const auto stats = pool.getStatistics();
+    EXPECT_EQ(stats.bytes_in_use, 1536u);
+    EXPECT_EQ(stats.peak_bytes_in_use, 1536u);
+    EXPECT_EQ(stats.bytes_cached, 256u);
+    EXPECT_EQ(stats.upstream_allocations, 3u);
+    pool.deallocate(b);
+    pool.deallocate(c);
+    EXPECT_EQ(pool.getStatistics().bytes_in_use, 0u);
+    EXPECT_EQ(pool.getStatistics().peak_bytes_in_use, 1536u);
+}
+TEST(TestMemoryResource, Destructor) {
+    CountingResource upstream;
+    {
+        PoolMemoryResource pool(upstream);
+        pool.deallocate(pool.allocate(300));
+        pool.deallocate(pool.allocate(3000));
+        EXPECT_EQ(upstream.live, 2u);
+    }
+    EXPECT_EQ(upstream.live, 0u);
+}
+TEST(TestMemoryResource, InvalidArguments) {
+    CountingResource upstream;
+    PoolMemoryResource pool(upstream);
+    EXPECT_THROW(pool.allocate(0), exception::InvalidArgument);
+    int x;
+    EXPECT_THROW(pool.deallocate(&x), exception::InvalidArgument);
+    void *a = pool.allocate(10);
+    pool.deallocate(a);
+    EXPECT_THROW(pool.deallocate(a), exception::InvalidArgument);
+    EXPECT_NO_THROW(pool.deallocate(nullptr));
+}
+TEST(TestMemoryResource, ShrinkPolicyMaxCachedBytes) {
+    CountingResource upstream;
+    PoolMemoryResource::ShrinkPolicy policy;
+    policy.max_cached_bytes = 2048;
+    PoolMemoryResource pool(upstream, policy);
+    void *small = pool.allocate(512);
+    void *medium = pool.allocate(1024);
+    void *large = pool.allocate(2048);
+    pool.deallocate(small);
+    pool.deallocate(medium);
+    EXPECT_EQ(upstream.deallocations, 0u);
+    // Exceeding the limit, releases the largest cached buffers first
+    pool.deallocate(large);
+    EXPECT_EQ(upstream.deallocations, 1u);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, 1536u);
+    // Tightening the policy trims the cache
+    policy.max_cached_bytes = 600;
+    pool.setShrinkPolicy(policy);
+    EXPECT_EQ(pool.getShrinkPolicy().max_cached_bytes, 600u);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, 512u);
+    EXPECT_EQ(upstream.deallocations, 2u);
+}
+TEST(TestMemoryResource, ShrinkPolicyMaxCachedBlock) {
+    CountingResource upstream;
+    PoolMemoryResource::ShrinkPolicy policy;
+    policy.max_cached_block = 1024;
+    PoolMemoryResource pool(upstream, policy);
+    void *a = pool.allocate(1024);
+    void *b = pool.allocate(1025);
+    pool.deallocate(a);
+    pool.deallocate(b);
+    // Only the buffer within the block limit is cached
+    EXPECT_EQ(upstream.deallocations, 1u);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, 1024u);
+    policy.max_cached_block = 512;
+    pool.setShrinkPolicy(policy);
+    EXPECT_EQ(upstream.deallocations, 2u);
+    EXPECT_EQ(pool.getStatistics().bytes_cached, 0u);
+}
+TEST(TestMemoryResource, ReleaseCacheWhenOutOfMemory) {
+    CountingResource upstream;
+    upstream.limit = 2;
+    PoolMemoryResource pool(upstream);
+    void *a = pool.allocate(300);
+    void *b = pool.allocate(3000);
+    pool.deallocate(a);
+    // Upstream is full, so the cached buffer is released to make room
+    void *c = pool.allocate(30000);
+    EXPECT_NE(c, nullptr);
+    EXPECT_EQ(upstream.deallocations, 1u);
+    // No memory can be released, so allocation fails
+    EXPECT_EQ(pool.allocate(30000), nullptr);
+    EXPECT_EQ(pool.getStatistics().bytes_in_use, PoolMemoryResource::getBlockSize(3000) + PoolMemoryResource::getBlockSize(30000));
+    pool.deallocate(b);
+    pool.deallocate(c);
+}
+TEST(TestMemoryResource, GrowShrinkPattern) {
+    // Agent state lists grow geometrically, and buffers of previous sizes are reused when the population shrinks again
+    CountingResource upstream;
+    PoolMemoryResource pool(upstream);
+    for (int repeat = 0; repeat < 10; ++repeat) {
+        std::vector<void*> buffers;
+        for (size_t len = 1024; len < 1000000; len = len * 5 / 4) {
+            void *data = pool.allocate(len * sizeof(float));
+            void *data_swap = pool.allocate(len * sizeof(float));
+            for (auto &b : buffers)
+                pool.deallocate(b);
+            buffers = {data, data_swap};
+        }
+        for (auto &b : buffers)
+            pool.deallocate(b);
+    }
+    const auto stats = pool.getStatistics();
+    // Only the first repeat requires upstream allocations
+    EXPECT_EQ(stats.upstream_allocations * 10, stats.upstream_allocations + stats.cache_hits);
+    EXPECT_EQ(upstream.deallocations, 0u);
+    EXPECT_EQ(stats.bytes_in_use, 0u);
+}
+TEST(TestMemoryResource, Concurrent) {
+    CountingResource upstream;
+    PoolMemoryResource pool(upstream);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t]() {
+            std::vector<void*> buffers;
+            for (int i = 0; i < 1000; ++i) {
+                buffers.push_back(pool.allocate(256 + (i * 97 + t * 13) % 4096));
+                if (buffers.size() > 8) {
+                    pool.deallocate(buffers.front());
+                    buffers.erase(buffers.begin());
+                }
+            }
+            for (auto &b : buffers)
+                pool.deallocate(b);
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(pool.getStatistics().bytes_in_use, 0u);
+    pool.trim();
+    EXPECT_EQ(upstream.live, 0u);
+}
+
+}  // namespace test_memory_resource
+}  // namespace flamegpu
@@ -0,0 +1,132 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "flamegpu/sim/Profile.h"
+#include "flamegpu/util/detail/Profiler.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_profiler {
+using util::detail::Profiler;
+
+TEST(ProfilerTest, ProfileRegion) {
+    ProfileRegion r;
+    EXPECT_EQ(r.calls, 0u);
+    EXPECT_EQ(r.getMeanTime(), 0);
+    r.add(2.0);
+    r.add(1.0);
+    r.add(3.0);
+    EXPECT_EQ(r.calls, 3u);
+    EXPECT_DOUBLE_EQ(r.total_time, 6.0);
+    EXPECT_DOUBLE_EQ(r.min_time, 1.0);
+    EXPECT_DOUBLE_EQ(r.max_time, 3.0);
+    EXPECT_DOUBLE_EQ(r.getMeanTime(), 2.0);
+    ProfileRegion r2;
+    r2.add(0.5);
+    r.merge(r2);
+    EXPECT_EQ(r.calls, 4u);
+    EXPECT_DOUBLE_EQ(r.min_time, 0.5);
+    EXPECT_DOUBLE_EQ(r.max_time, 3.0);
+    // Merging an empty region changes nothing
+    r.merge(ProfileRegion());
+    EXPECT_EQ(r.calls, 4u);
+    EXPECT_DOUBLE_EQ(r.min_time, 0.5);
+}
+TEST(ProfilerTest, ProfileMerge) {
+    Profile a, b;
+    a.add("step", 1.0);
+    b.add("step", 2.0);
+    b.add("step/layer:0", 1.5);
+    a.merge(b);
+    EXPECT_EQ(a.getRegions().size(), 2u);
+    EXPECT_EQ(a.getRegion("step").calls, 2u);
+    EXPECT_DOUBLE_EQ(a.getRegion("step").total_time, 3.0);
+    EXPECT_EQ(a.getRegion("step/layer:0").calls, 1u);
+    // Prefixed merge
+    a.merge(b, "step/layer:1/submodel:sub");
+    EXPECT_TRUE(a.hasRegion("step/layer:1/submodel:sub/step/layer:0"));
+    EXPECT_FALSE(a.hasRegion("step/layer:1"));
+    EXPECT_THROW(a.getRegion("step/layer:1"), exception::InvalidArgument);
+    a.clear();
+    EXPECT_TRUE(a.empty());
+}
+TEST(ProfilerTest, Disabled) {
+    Profiler p;
+    EXPECT_FALSE(p.isEnabled());
+    {
+        Profiler::Scope s(p, "step");
+        Profiler::Scope s2(p, "layer", "move");
+        Profiler::Scope s3(p, "host_function", 0u);
+    }
+    EXPECT_TRUE(p.getProfile().empty());
+}
+TEST(ProfilerTest, NestedScopes) {
+    Profiler p;
+    p.setEnabled(true);
+    for (unsigned int i = 0; i < 3; ++i) {
+        Profiler::Scope step(p, "step");
+        {
+            Profiler::Scope layer(p, "layer", "move", 0);
+            Profiler::Scope fn(p, "function", "move", "Boid");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        {
+            // Unnamed layers are named by their index
+            Profiler::Scope layer(p, "layer", "", 1);
+            Profiler::Scope fn(p, "host_function", 0u);
+        }
+    }
+    const Profile &profile = p.getProfile();
+    EXPECT_EQ(profile.getRegions().size(), 5u);
+    ASSERT_TRUE(profile.hasRegion("step"));
+    ASSERT_TRUE(profile.hasRegion("step/layer:move"));
+    ASSERT_TRUE(profile.hasRegion("step/layer:move/function:Boid.move"));
+    ASSERT_TRUE(profile.hasRegion("step/layer:1"));
+    ASSERT_TRUE(profile.hasRegion("step/layer:1/host_function:0"));
+    for (const auto &r : profile.getRegions()) {
+        EXPECT_EQ(r.second.calls, 3u) << r.first;
+    }
+    // Enclosing regions include the time of nested regions
+    const ProfileRegion &step = profile.getRegion("step");
+    const ProfileRegion &layer = profile.getRegion("step/layer:move");
+    const ProfileRegion &fn = profile.getRegion("step/layer:move/function:Boid.move");
+    EXPECT_GE(fn.min_time, 0.0015);
+    EXPECT_GE(layer.total_time, fn.total_time);
+    EXPECT_GE(step.total_time, layer.total_time + profile.getRegion("step/layer:1").total_time);
+    p.reset();
+    EXPECT_TRUE(p.getProfile().empty());
+}
+TEST(ProfilerTest, ExternalRegions) {
+    Profiler p;
+    p.setEnabled(true);
+    Profile sub;
+    sub.add("step", 0.25);
+    {
+        Profiler::Scope layer(p, "layer", "a");
+        EXPECT_EQ(p.getPath("function", "f", "agent"), "layer:a/function:agent.f");
+        p.add(p.getPath("function", "f", "agent"), 0.5);
+        Profiler::Scope submodel(p, "submodel", "sub");
+        p.merge(sub);
+    }
+    EXPECT_EQ(p.getPath("step", ""), "step");
+    EXPECT_DOUBLE_EQ(p.getProfile().getRegion("layer:a/function:agent.f").total_time, 0.5);
+    EXPECT_DOUBLE_EQ(p.getProfile().getRegion("layer:a/submodel:sub/step").total_time, 0.25);
+    EXPECT_THROW(p.pop(), exception::UnknownInternalError);
+}
+TEST(ProfilerTest, ScopeDestructorDoesNotThrow) {
+    static_assert(std::is_nothrow_destructible<Profiler::Scope>::value, "Profiler::Scope must not throw from its destructor");
+    Profiler p;
+    p.setEnabled(true);
+    // The scope's region has already been closed, so closing it again fails, the error is not thrown
+    EXPECT_NO_THROW({
+        Profiler::Scope s(p, "step");
+        p.pop();
+    });
+    EXPECT_EQ(p.getProfile().getRegion("step").calls, 1u);
+}
+
+}  // namespace test_profiler
+}  // namespace flamegpu
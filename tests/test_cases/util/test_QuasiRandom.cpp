@@ -0,0 +1,81 @@
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "flamegpu/util/detail/QuasiRandom.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_quasi_random {
+namespace qr = util::detail::quasi_random;
+
+/**
+ * Returns true if the n points of dimension j each fall within a unique stratum of width 1/n
+ */
+bool stratified(const std::vector<double> &points, const unsigned int n, const unsigned int d, const unsigned int j) {
+    std::set<unsigned int> strata;
+    for (unsigned int i = 0; i < n; ++i) {
+        const double v = points[i * d + j];
+        if (v < 0.0 || v >= 1.0)
+            return false;
+        strata.insert(static_cast<unsigned int>(v * n));
+    }
+    return strata.size() == n;
+}
+
+TEST(QuasiRandomTest, SobolKnownValues) {
+    const std::vector<double> s = qr::sobol(8, 2);
+    ASSERT_EQ(s.size(), 16u);
+    const double dim0[8] = {0.0, 0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125};
+    const double dim1[8] = {0.0, 0.5, 0.25, 0.75, 0.375, 0.875, 0.125, 0.625};
+    for (unsigned int i = 0; i < 8; ++i) {
+        EXPECT_EQ(s[i * 2 + 0], dim0[i]);
+        EXPECT_EQ(s[i * 2 + 1], dim1[i]);
+    }
+}
+TEST(QuasiRandomTest, SobolStratified) {
+    // The first 2^k points of every dimension are perfectly stratified
+    const unsigned int d = qr::SOBOL_MAX_DIMENSIONS;
+    for (unsigned int n = 2; n <= 1024; n *= 2) {
+        const std::vector<double> s = qr::sobol(n, d);
+        for (unsigned int j = 0; j < d; ++j) {
+            EXPECT_TRUE(stratified(s, n, d, j)) << "n: " << n << ", dimension: " << j;
+        }
+    }
+}
+TEST(QuasiRandomTest, SobolTooManyDimensions) {
+    EXPECT_NO_THROW(qr::sobol(4, qr::SOBOL_MAX_DIMENSIONS));
+    EXPECT_THROW(qr::sobol(4, qr::SOBOL_MAX_DIMENSIONS + 1), exception::OutOfBoundsException);
+}
+TEST(QuasiRandomTest, HaltonKnownValues) {
+    const std::vector<double> h = qr::halton(4, 2);
+    ASSERT_EQ(h.size(), 8u);
+    const double base2[4] = {1.0 / 2, 1.0 / 4, 3.0 / 4, 1.0 / 8};
+    const double base3[4] = {1.0 / 3, 2.0 / 3, 1.0 / 9, 4.0 / 9};
+    for (unsigned int i = 0; i < 4; ++i) {
+        EXPECT_DOUBLE_EQ(h[i * 2 + 0], base2[i]);
+        EXPECT_DOUBLE_EQ(h[i * 2 + 1], base3[i]);
+    }
+}
+TEST(QuasiRandomTest, LatinHypercubeStratified) {
+    std::mt19937_64 rng(12);
+    for (const unsigned int n : {2u, 7u, 100u}) {
+        const std::vector<double> l = qr::latinHypercube(n, 5, rng);
+        ASSERT_EQ(l.size(), n * 5);
+        for (unsigned int j = 0; j < 5; ++j) {
+            EXPECT_TRUE(stratified(l, n, 5, j)) << "n: " << n << ", dimension: " << j;
+        }
+    }
+}
+TEST(QuasiRandomTest, LatinHypercubeDeterministic) {
+    std::mt19937_64 a(34), b(34), c(35);
+    const std::vector<double> la = qr::latinHypercube(50, 3, a);
+    const std::vector<double> lb = qr::latinHypercube(50, 3, b);
+    const std::vector<double> lc = qr::latinHypercube(50, 3, c);
+    EXPECT_EQ(la, lb);
+    EXPECT_NE(la, lc);
+}
+
+}  // namespace test_quasi_random
+}  // namespace flamegpu
@@ -0,0 +1,33 @@
+#include <string>
+
+#include "flamegpu/util/detail/SHA256.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_sha256 {
+using util::detail::SHA256;
+
+// Test vectors from FIPS 180-4 examples and NIST CSRC
+TEST(SHA256Test, KnownDigests) {
+    EXPECT_EQ(SHA256::hash(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(SHA256::hash("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    // 56 bytes, the padding requires a second block
+    EXPECT_EQ(SHA256::hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    EXPECT_EQ(SHA256::hash(std::string(1000000, 'a')), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+TEST(SHA256Test, Incremental) {
+    const std::string msg = "The quick brown fox jumps over the lazy dog, repeatedly, until the message spans several blocks.";
+    SHA256 h;
+    for (const char c : msg) {
+        h.update(&c, 1);
+    }
+    EXPECT_EQ(h.hexdigest(), SHA256::hash(msg));
+    h.reset();
+    h.update(msg.substr(0, 63));
+    h.update(msg.substr(63));
+    EXPECT_EQ(h.hexdigest(), SHA256::hash(msg));
+}
+
+}  // namespace test_sha256
+}  // namespace flamegpu
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/util/detail/SingleFlight.h"
+
+#include "gtest/gtest.h"
+
+namespace flamegpu {
+namespace test_single_flight {
+/**
+ * Mock of an RTC compiler, used in place of NVRTC so that JitifyCache's locking behaviour can be tested without a GPU
+ * Records the number of compilations and the peak number of concurrent compilations
+ */
+class MockCompiler {
+ public:
+    explicit MockCompiler(unsigned int _wait_for_active = 1)
+        : wait_for_active(_wait_for_active) { }
+    std::string compile(const std::string &key) {
+        ++compilations;
+        std::unique_lock<std::mutex> lock(mutex);
+        ++active;
+        peak_active = std::max(peak_active, active);
+        cv.notify_all();
+        // Hold the compilation open until the expected number of compilations are concurrently active (or timeout)
+        cv.wait_for(lock, std::chrono::seconds(5), [this]() { return peak_active >= wait_for_active; });
+        --active;
+        return "kernel:" + key;
+    }
+    std::atomic<unsigned int> compilations{0};
+    unsigned int peak_active = 0;
+
+ private:
+    const unsigned int wait_for_active;
+    unsigned int active = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+const unsigned int THREAD_COUNT = 8;
+}  // namespace test_single_flight
+
+using test_single_flight::MockCompiler;
+using test_single_flight::THREAD_COUNT;
+
+TEST(TestSingleFlight, SameKeyCompilesOnce) {
+    util::detail::SingleFlight<std::string, std::string> flights;
+    MockCompiler compiler;
+    std::atomic<unsigned int> arrived{0};
+    std::atomic<unsigned int> leaders{0};
+    std::vector<std::string> results(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&, i]() {
+            ++arrived;
+            bool is_leader = false;
+            results[i] = flights.run("a", [&]() {
+                // Keep the compilation in-flight until every thread has requested it
+                while (arrived < THREAD_COUNT)
+                    std::this_thread::yield();
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                return compiler.compile("a");
+            }, &is_leader);
+            if (is_leader)
+                ++leaders;
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(compiler.compilations, 1u);
+    EXPECT_EQ(leaders, 1u);
+    for (const auto &r : results)
+        EXPECT_EQ(r, "kernel:a");
+    EXPECT_EQ(flights.inFlight(), 0u);
+}
+TEST(TestSingleFlight, DifferentKeysCompileConcurrently) {
+    util::detail::SingleFlight<std::string, std::string> flights;
+    // Each compilation blocks until all are active, this would timeout if compilations were serialised
+    MockCompiler compiler(THREAD_COUNT);
+    std::vector<std::string> results(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&, i]() {
+            const std::string key = std::to_string(i);
+            results[i] = flights.run(key, [&]() { return compiler.compile(key); });
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(compiler.compilations, THREAD_COUNT);
+    EXPECT_EQ(compiler.peak_active, THREAD_COUNT);
+    for (unsigned int i = 0; i < THREAD_COUNT; ++i)
+        EXPECT_EQ(results[i], "kernel:" + std::to_string(i));
+}
+TEST(TestSingleFlight, KeyReleasedAfterCompletion) {
+    util::detail::SingleFlight<std::string, std::string> flights;
+    MockCompiler compiler;
+    bool is_leader = false;
+    EXPECT_EQ(flights.run("a", [&]() { return compiler.compile("a"); }, &is_leader), "kernel:a");
+    EXPECT_TRUE(is_leader);
+    EXPECT_EQ(flights.inFlight(), 0u);
+    // Results are not retained, caching is the responsibility of the caller
+    EXPECT_EQ(flights.run("a", [&]() { return compiler.compile("a"); }, &is_leader), "kernel:a");
+    EXPECT_TRUE(is_leader);
+    EXPECT_EQ(compiler.compilations, 2u);
+}
+TEST(TestSingleFlight, ExceptionPropagatesToWaiters) {
+    util::detail::SingleFlight<std::string, std::string> flights;
+    std::atomic<unsigned int> arrived{0};
+    std::atomic<unsigned int> failures{0};
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&]() {
+            ++arrived;
+            try {
+                flights.run("a", [&]() -> std::string {
+                    while (arrived < THREAD_COUNT)
+                        std::this_thread::yield();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    throw std::runtime_error("compilation failed");
+                });
+            } catch (const std::runtime_error &) {
+                ++failures;
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(failures, THREAD_COUNT);
+    EXPECT_EQ(flights.inFlight(), 0u);
+    // A failed compilation can be retried
+    EXPECT_EQ(flights.run("a", []() { return std::string("kernel:a"); }), "kernel:a");
+}
+
+}  // namespace flamegpu
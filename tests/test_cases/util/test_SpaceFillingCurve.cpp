@@ -0,0 +1,136 @@
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include "flamegpu/util/detail/SpaceFillingCurve.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_space_filling_curve {
+namespace sfc = util::detail::space_filling_curve;
+
+/**
+ * Returns the coordinates of every bin of a cube grid, ordered by their key
+ */
+template<unsigned int N>
+std::vector<std::vector<int>> curve(const SpatialSortOrder order, const unsigned int dim) {
+    unsigned int dims[N];
+    unsigned int total = 1;
+    for (unsigned int i = 0; i < N; ++i) {
+        dims[i] = dim;
+        total *= dim;
+    }
+    std::vector<std::vector<int>> rtn(total);
+    for (unsigned int j = 0; j < total; ++j) {
+        int pos[N];
+        unsigned int t = j;
+        for (unsigned int i = 0; i < N; ++i) {
+            pos[i] = static_cast<int>(t % dim);
+            t /= dim;
+        }
+        const unsigned int k = sfc::key<N, unsigned int>(order, pos, dims);
+        EXPECT_LT(k, total);
+        if (k < total) {
+            EXPECT_TRUE(rtn[k].empty());  // Keys are unique
+            rtn[k].assign(pos, pos + N);
+        }
+    }
+    return rtn;
+}
+unsigned int manhattan(const std::vector<int> &a, const std::vector<int> &b) {
+    unsigned int rtn = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        rtn += std::abs(a[i] - b[i]);
+    return rtn;
+}
+
+TEST(SpaceFillingCurveTest, RequiredBits) {
+    EXPECT_EQ(sfc::requiredBits<2>({1, 1}), 0u);
+    EXPECT_EQ(sfc::requiredBits<2>({2, 1}), 1u);
+    EXPECT_EQ(sfc::requiredBits<3>({3, 4, 2}), 2u);
+    EXPECT_EQ(sfc::requiredBits<3>({1, 5, 1}), 3u);
+    EXPECT_EQ(sfc::requiredBits<2>({1024, 1025}), 11u);
+    EXPECT_EQ((sfc::maxBits<3, unsigned int>()), 10u);
+    EXPECT_EQ((sfc::maxBits<2, unsigned int>()), 16u);
+    EXPECT_EQ((sfc::maxBits<3, uint64_t>()), 21u);
+}
+TEST(SpaceFillingCurveTest, RowMajor) {
+    // Matches the linear index of the bin, as used by spatial messaging
+    const unsigned int dims[3] = {5, 6, 7};
+    const int pos[3] = {4, 2, 3};
+    EXPECT_EQ((sfc::key<3, unsigned int>(SpatialSortOrder::RowMajor, pos, dims)), 3u * 5 * 6 + 2 * 5 + 4);
+    const unsigned int dims2[2] = {5, 6};
+    const int pos2[2] = {4, 2};
+    EXPECT_EQ((sfc::key<2, unsigned int>(SpatialSortOrder::RowMajor, pos2, dims2)), 2u * 5 + 4);
+}
+TEST(SpaceFillingCurveTest, Morton) {
+    // x is the least significant bit of each digit
+    EXPECT_EQ((sfc::morton<2, unsigned int>({3, 5}, 3)), 39u);  // 0b10'01'11
+    EXPECT_EQ((sfc::morton<3, unsigned int>({1, 0, 0}, 1)), 1u);
+    EXPECT_EQ((sfc::morton<3, unsigned int>({0, 1, 0}, 1)), 2u);
+    EXPECT_EQ((sfc::morton<3, unsigned int>({0, 0, 1}, 1)), 4u);
+    EXPECT_EQ((sfc::morton<3, uint64_t>({0x1fffff, 0x1fffff, 0x1fffff}, 21)), (1ull << 63) - 1);
+    // Every 2x2x2 block of bins is contiguous
+    const auto c = curve<3>(SpatialSortOrder::Morton, 8);
+    for (size_t i = 0; i < c.size(); i += 8) {
+        for (size_t j = 1; j < 8; ++j) {
+            for (unsigned int d = 0; d < 3; ++d)
+                EXPECT_EQ(c[i + j][d] / 2, c[i][d] / 2);
+        }
+    }
+}
+TEST(SpaceFillingCurveTest, Hilbert2D) {
+    // Consecutive keys are always neighbouring bins
+    for (const unsigned int dim : {2u, 4u, 16u}) {
+        const auto c = curve<2>(SpatialSortOrder::Hilbert, dim);
+        for (size_t i = 1; i < c.size(); ++i)
+            EXPECT_EQ(manhattan(c[i - 1], c[i]), 1u);
+    }
+}
+TEST(SpaceFillingCurveTest, Hilbert3D) {
+    for (const unsigned int dim : {2u, 4u, 16u}) {
+        const auto c = curve<3>(SpatialSortOrder::Hilbert, dim);
+        for (size_t i = 1; i < c.size(); ++i)
+            EXPECT_EQ(manhattan(c[i - 1], c[i]), 1u);
+    }
+}
+TEST(SpaceFillingCurveTest, NonPowerOf2Grid) {
+    // Keys remain unique when the grid does not fill the curve's hypercube
+    const unsigned int dims[3] = {3, 5, 6};
+    for (const SpatialSortOrder order : {SpatialSortOrder::Morton, SpatialSortOrder::Hilbert}) {
+        std::set<unsigned int> keys;
+        for (int z = 0; z < 6; ++z)
+            for (int y = 0; y < 5; ++y)
+                for (int x = 0; x < 3; ++x) {
+                    const int pos[3] = {x, y, z};
+                    const unsigned int k = sfc::key<3, unsigned int>(order, pos, dims);
+                    EXPECT_LT(k, 512u);
+                    keys.insert(k);
+                }
+        EXPECT_EQ(keys.size(), 3u * 5 * 6);
+    }
+}
+TEST(SpaceFillingCurveTest, Clamp) {
+    // Out of bounds bins share the key of the nearest bin
+    const unsigned int dims[2] = {4, 4};
+    for (const SpatialSortOrder order : {SpatialSortOrder::Morton, SpatialSortOrder::Hilbert}) {
+        const int a[2] = {-3, 2}, b[2] = {0, 2}, c[2] = {7, 9}, d[2] = {3, 3};
+        EXPECT_EQ((sfc::key<2, unsigned int>(order, a, dims)), (sfc::key<2, unsigned int>(order, b, dims)));
+        EXPECT_EQ((sfc::key<2, unsigned int>(order, c, dims)), (sfc::key<2, unsigned int>(order, d, dims)));
+    }
+}
+TEST(SpaceFillingCurveTest, Coarsen) {
+    // Grids too large for 32 bit keys have their low bits discarded, so pairs of bins share a key
+    const unsigned int dims[3] = {2048, 2048, 2048};
+    for (const SpatialSortOrder order : {SpatialSortOrder::Morton, SpatialSortOrder::Hilbert}) {
+        const int a[3] = {2046, 2047, 0}, b[3] = {2047, 2046, 1}, c[3] = {2047, 2047, 2047};
+        EXPECT_EQ((sfc::key<3, unsigned int>(order, a, dims)), (sfc::key<3, unsigned int>(order, b, dims)));
+        EXPECT_LT((sfc::key<3, unsigned int>(order, c, dims)), 1u << 30);
+        // 64 bit keys have space for the full grid
+        EXPECT_NE((sfc::key<3, uint64_t>(order, a, dims)), (sfc::key<3, uint64_t>(order, b, dims)));
+    }
+}
+
+}  // namespace test_space_filling_curve
+}  // namespace flamegpu
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "flamegpu/util/detail/SparseCellTable.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_sparse_cell_table {
+using util::detail::SparseCellTable;
+
+/**
+ * Host model of the spatial messaging partitioning grid, which returns the messages within the Moore neighbourhood of a bin
+ * using either a dense PBM (as MessageSpatial3D::In iterates strips) or a SparseCellTable (as it iterates individual bins)
+ */
+class Grid {
+ public:
+    Grid(unsigned int x, unsigned int y, unsigned int z)
+        : dim{x, y, z} { }
+    unsigned int getHash(int x, int y, int z) const {
+        // Only x should ever be out of bounds here
+        const unsigned int _x = static_cast<unsigned int>(x < 0 ? 0 : (x >= static_cast<int>(dim[0]) - 1 ? static_cast<int>(dim[0]) - 1 : x));
+        return static_cast<unsigned int>(z) * dim[0] * dim[1] + static_cast<unsigned int>(y) * dim[0] + _x;
+    }
+    bool inBounds(int y, int z) const {
+        return y >= 0 && z >= 0 && y < static_cast<int>(dim[1]) && z < static_cast<int>(dim[2]);
+    }
+    /**
+     * Store the bin of each message
+     */
+    void build(const std::vector<std::vector<int>> &_bins) {
+        bins.clear();
+        for (const auto &b : _bins)
+            bins.push_back(getHash(b[0], b[1], b[2]));
+        // Dense PBM, as produced by the histogram and scan of CUDAModelHandler::buildIndex()
+        dense_pbm.assign(static_cast<size_t>(dim[0]) * dim[1] * dim[2] + 1, 0);
+        for (const auto &b : bins)
+            ++dense_pbm[b];
+        unsigned int running = 0;
+        for (auto &p : dense_pbm) {
+            const unsigned int t = p;
+            p = running;
+            running += t;
+        }
+        std::vector<unsigned int> offset(dense_pbm.begin(), dense_pbm.end() - 1);
+        dense_order.assign(bins.size(), 0);
+        for (unsigned int i = 0; i < bins.size(); ++i)
+            dense_order[offset[bins[i]]++] = i;
+        // Sparse PBM
+        sparse.reset(new SparseCellTable(bins));
+        sparse_order.assign(bins.size(), 0);
+        for (unsigned int i = 0; i < bins.size(); ++i)
+            sparse_order[sparse->getDestination()[i]] = i;
+    }
+    std::vector<unsigned int> denseNeighbours(int x, int y, int z) const {
+        std::vector<unsigned int> rtn;
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (!inBounds(y + dy, z + dz))
+                    continue;
+                const unsigned int first = dense_pbm[getHash(x - 1, y + dy, z + dz)];
+                const unsigned int last = dense_pbm[getHash(x + 1, y + dy, z + dz) + 1];
+                for (unsigned int i = first; i < last; ++i)
+                    rtn.push_back(dense_order[i]);
+            }
+        }
+        std::sort(rtn.begin(), rtn.end());
+        return rtn;
+    }
+    std::vector<unsigned int> sparseNeighbours(int x, int y, int z) const {
+        std::vector<unsigned int> rtn;
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (!inBounds(y + dy, z + dz))
+                    continue;
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (x + dx < 0 || x + dx >= static_cast<int>(dim[0]))
+                        continue;
+                    const auto range = sparse->getBin(getHash(x + dx, y + dy, z + dz));
+                    for (unsigned int i = range.first; i < range.second; ++i)
+                        rtn.push_back(sparse_order[i]);
+                }
+            }
+        }
+        std::sort(rtn.begin(), rtn.end());
+        return rtn;
+    }
+    const SparseCellTable &getSparse() const { return *sparse; }
+
+ private:
+    unsigned int dim[3];
+    std::vector<unsigned int> bins;
+    std::vector<unsigned int> dense_pbm;
+    std::vector<unsigned int> dense_order;
+    std::vector<unsigned int> sparse_order;
+    std::unique_ptr<SparseCellTable> sparse;
+};
+
+TEST(TestSparseCellTable, Capacity) {
+    EXPECT_EQ(util::detail::sparse_cell_table::getCapacity(0), util::detail::sparse_cell_table::MIN_CAPACITY);
+    EXPECT_EQ(util::detail::sparse_cell_table::getCapacity(32), 64u);
+    EXPECT_EQ(util::detail::sparse_cell_table::getCapacity(33), 128u);
+    EXPECT_EQ(util::detail::sparse_cell_table::getCapacity(1000), 2048u);
+}
+TEST(TestSparseCellTable, Build) {
+    // Messages 0, 2 and 5 share a bin
+    const std::vector<unsigned int> bins = {7, 1000000, 7, 3, 4000000000u, 7};
+    SparseCellTable table(bins);
+    EXPECT_EQ(table.getCapacity(), util::detail::sparse_cell_table::MIN_CAPACITY);
+    EXPECT_EQ(table.getOccupiedCount(), 4u);
+    EXPECT_EQ(table.getPBM().size(), table.getCapacity() + 1u);
+    EXPECT_EQ(table.getPBM().back(), bins.size());
+    // Each occupied bin's range holds exactly it's messages
+    std::set<unsigned int> positions;
+    for (unsigned int i = 0; i < bins.size(); ++i) {
+        const auto range = table.getBin(bins[i]);
+        EXPECT_GE(table.getDestination()[i], range.first);
+        EXPECT_LT(table.getDestination()[i], range.second);
+        positions.insert(table.getDestination()[i]);
+    }
+    EXPECT_EQ(positions.size(), bins.size());
+    EXPECT_EQ(table.getBin(7).second - table.getBin(7).first, 3u);
+    // Unoccupied bins are empty
+    const auto empty = table.getBin(8);
+    EXPECT_EQ(empty.first, empty.second);
+}
+TEST(TestSparseCellTable, Collisions) {
+    // Fill a minimum sized table to half capacity, so that probe sequences overlap
+    std::vector<unsigned int> bins;
+    for (unsigned int i = 0; i < util::detail::sparse_cell_table::MIN_CAPACITY / 2; ++i) {
+        bins.push_back(i * util::detail::sparse_cell_table::MIN_CAPACITY);
+        bins.push_back(i * util::detail::sparse_cell_table::MIN_CAPACITY);
+    }
+    SparseCellTable table(bins, util::detail::sparse_cell_table::MIN_CAPACITY);
+    EXPECT_EQ(table.getOccupiedCount(), util::detail::sparse_cell_table::MIN_CAPACITY / 2);
+    for (const auto &b : bins) {
+        const auto range = table.getBin(b);
+        EXPECT_EQ(range.second - range.first, 2u);
+    }
+    for (unsigned int i = 0; i < util::detail::sparse_cell_table::MIN_CAPACITY; ++i) {
+        const auto range = table.getBin(i * util::detail::sparse_cell_table::MIN_CAPACITY + 1);
+        EXPECT_EQ(range.first, range.second);
+    }
+}
+TEST(TestSparseCellTable, NeighboursMatchDense3D) {
+    // Large, mostly empty environment, with messages clustered in a few regions and along the bounds
+    Grid grid(200, 150, 40);
+    std::mt19937 rng(12);
+    std::vector<std::vector<int>> bins;
+    const int clusters[4][3] = {{5, 5, 5}, {100, 75, 20}, {195, 145, 38}, {0, 149, 0}};
+    for (const auto &c : clusters) {
+        std::uniform_int_distribution<int> offset(-4, 4);
+        for (int i = 0; i < 400; ++i) {
+            bins.push_back({
+                std::min(std::max(c[0] + offset(rng), 0), 199),
+                std::min(std::max(c[1] + offset(rng), 0), 149),
+                std::min(std::max(c[2] + offset(rng), 0), 39)});
+        }
+    }
+    grid.build(bins);
+    EXPECT_LT(grid.getSparse().getCapacity(), 200u * 150u * 40u / 100u);
+    // Search about every message's bin, and a selection of empty and boundary bins
+    std::vector<std::vector<int>> queries = bins;
+    queries.push_back({50, 50, 20});
+    queries.push_back({0, 0, 0});
+    queries.push_back({199, 149, 39});
+    queries.push_back({6, 11, 5});
+    unsigned int non_empty = 0;
+    for (const auto &q : queries) {
+        const auto dense = grid.denseNeighbours(q[0], q[1], q[2]);
+        const auto sparse = grid.sparseNeighbours(q[0], q[1], q[2]);
+        ASSERT_EQ(dense, sparse);
+        non_empty += dense.empty() ? 0 : 1;
+    }
+    EXPECT_EQ(non_empty, bins.size() + 2);
+}
+TEST(TestSparseCellTable, NeighboursMatchDense2D) {
+    // A 2D grid is a 3D grid with a single layer
+    Grid grid(1000, 1000, 1);
+    std::mt19937 rng(34);
+    std::uniform_int_distribution<int> pos(0, 999);
+    std::vector<std::vector<int>> bins;
+    for (int i = 0; i < 2000; ++i)
+        bins.push_back({pos(rng), pos(rng), 0});
+    // Fully occupy a small region, so that bins have several neighbours
+    for (int x = 10; x < 20; ++x)
+        for (int y = 990; y < 1000; ++y)
+            bins.push_back({x, y, 0});
+    grid.build(bins);
+    for (const auto &q : bins) {
+        ASSERT_EQ(grid.denseNeighbours(q[0], q[1], q[2]), grid.sparseNeighbours(q[0], q[1], q[2]));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        const int x = pos(rng), y = pos(rng);
+        ASSERT_EQ(grid.denseNeighbours(x, y, 0), grid.sparseNeighbours(x, y, 0));
+    }
+}
+
+}  // namespace test_sparse_cell_table
+}  // namespace flamegpu
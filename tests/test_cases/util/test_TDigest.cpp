@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "flamegpu/util/detail/TDigest.h"
+#include "flamegpu/exception/FLAMEGPUException.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_tdigest {
+using util::detail::TDigest;
+
+TEST(TDigestTest, Empty) {
+    TDigest d;
+    EXPECT_EQ(d.getCount(), 0);
+    EXPECT_EQ(d.quantile(0.5), 0);
+    EXPECT_THROW(d.quantile(-0.1), exception::InvalidArgument);
+    EXPECT_THROW(d.quantile(1.1), exception::InvalidArgument);
+}
+TEST(TDigestTest, SmallPopulationIsExact) {
+    // Every value is retained as it's own centroid, so quantiles interpolate between neighbouring values
+    TDigest d;
+    for (int i = 10; i >= 0; --i)
+        d.add(i);
+    EXPECT_EQ(d.getCount(), 11);
+    EXPECT_EQ(d.getCentroids().size(), 11u);
+    EXPECT_DOUBLE_EQ(d.quantile(0), 0);
+    EXPECT_DOUBLE_EQ(d.quantile(1), 10);
+    EXPECT_DOUBLE_EQ(d.getMin(), 0);
+    EXPECT_DOUBLE_EQ(d.getMax(), 10);
+    EXPECT_NEAR(d.quantile(0.5), 5, 0.5);
+}
+TEST(TDigestTest, LargePopulationIsBounded) {
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<double> dist(0, 1000);
+    std::vector<double> values(100000);
+    TDigest d(100);
+    for (double &v : values) {
+        v = dist(rng);
+        d.add(v);
+    }
+    std::sort(values.begin(), values.end());
+    // Centroid count is bounded by the compression
+    EXPECT_LE(d.getCentroids().size(), 200u);
+    for (const double q : {0.001, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99, 0.999}) {
+        const double expected = values[static_cast<size_t>(q * (values.size() - 1))];
+        EXPECT_NEAR(d.quantile(q), expected, 10) << "q: " << q;
+    }
+    EXPECT_DOUBLE_EQ(d.quantile(0), values.front());
+    EXPECT_DOUBLE_EQ(d.quantile(1), values.back());
+}
+TEST(TDigestTest, Merge) {
+    TDigest a, b, all;
+    for (int i = 0; i < 5000; ++i) {
+        (i % 2 ? a : b).add(i);
+        all.add(i);
+    }
+    a.merge(b);
+    EXPECT_EQ(a.getCount(), all.getCount());
+    EXPECT_DOUBLE_EQ(a.getMin(), 0);
+    EXPECT_DOUBLE_EQ(a.getMax(), 4999);
+    EXPECT_NEAR(a.quantile(0.5), all.quantile(0.5), 50);
+    EXPECT_NEAR(a.quantile(0.9), 4500, 50);
+}
+TEST(TDigestTest, IgnoresNaN) {
+    TDigest d;
+    d.add(1);
+    d.add(std::numeric_limits<double>::quiet_NaN());
+    EXPECT_EQ(d.getCount(), 1);
+    EXPECT_DOUBLE_EQ(d.quantile(0.5), 1);
+}
+
+}  // namespace test_tdigest
+}  // namespace flamegpu
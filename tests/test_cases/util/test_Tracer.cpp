@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flamegpu/util/detail/Tracer.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_tracer {
+using util::detail::Tracer;
+
+const char *TRACE_FILE = "test_tracer.json";
+
+std::string readFile(const char *path) {
+    std::ifstream f(path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+size_t countOf(const std::string &haystack, const std::string &needle) {
+    size_t rtn = 0;
+    for (size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + needle.size()))
+        ++rtn;
+    return rtn;
+}
+
+TEST(TracerTest, Inactive) {
+    Tracer &tracer = Tracer::getInstance();
+    ASSERT_FALSE(tracer.isActive());
+    EXPECT_FALSE(Tracer::isEnabled());
+    {
+        Tracer::Scope s("step");
+    }
+    EXPECT_EQ(tracer.stop(), 0u);
+}
+TEST(TracerTest, MultipleThreads) {
+    Tracer &tracer = Tracer::getInstance();
+    ASSERT_TRUE(tracer.start(TRACE_FILE));
+    EXPECT_TRUE(tracer.isActive());
+    EXPECT_TRUE(Tracer::isEnabled());
+    // A second session cannot be started whilst one is active
+    EXPECT_FALSE(tracer.start(TRACE_FILE));
+    const unsigned int THREADS = 4;
+    const unsigned int STEPS = 10;
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < THREADS; ++i) {
+        threads.emplace_back([i]() {
+            Tracer::setThreadName("Runner" + std::to_string(i));
+            Tracer::setRunIndex(static_cast<int>(i));
+            for (unsigned int s = 0; s < STEPS; ++s) {
+                Tracer::Scope step("step");
+                Tracer::Scope fn("function", "move", "Boid", 0, 1);
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    EXPECT_EQ(tracer.stop(), 0u);
+    EXPECT_FALSE(tracer.isActive());
+    const std::string trace = readFile(TRACE_FILE);
+    ASSERT_FALSE(trace.empty());
+    EXPECT_EQ(trace.front(), '[');
+    EXPECT_EQ(trace.substr(trace.size() - 2), "]\n");
+    EXPECT_EQ(countOf(trace, "\"ph\":\"X\""), 2 * THREADS * STEPS);
+    EXPECT_EQ(countOf(trace, "\"name\":\"Boid.move\""), THREADS * STEPS);
+    EXPECT_EQ(countOf(trace, "\"thread_name\""), THREADS);
+    EXPECT_EQ(countOf(trace, "\"name\":\"Runner3\""), 1u);
+    EXPECT_EQ(countOf(trace, "\"args\":{\"run\":2,\"layer\":0,\"stream\":1}"), STEPS);
+    std::remove(TRACE_FILE);
+}
+TEST(TracerTest, DroppedEvents) {
+    Tracer &tracer = Tracer::getInstance();
+    ASSERT_TRUE(tracer.start(TRACE_FILE, 0, 8));
+    std::thread t([]() {
+        for (unsigned int i = 0; i < 20; ++i) {
+            Tracer::Scope s("host_function", i);
+        }
+    });
+    t.join();
+    EXPECT_EQ(tracer.stop(), 12u);
+    const std::string trace = readFile(TRACE_FILE);
+    EXPECT_EQ(countOf(trace, "\"ph\":\"X\""), 8u);
+    std::remove(TRACE_FILE);
+}
+TEST(TracerTest, PeriodicFlush) {
+    Tracer &tracer = Tracer::getInstance();
+    // Flushing every 1ms allows far more events than the capacity of the buffer to be recorded
+    ASSERT_TRUE(tracer.start(TRACE_FILE, 1, 8));
+    uint64_t dropped = 0;
+    std::thread t([]() {
+        Tracer::setThreadName("Long \"run\"");
+        for (unsigned int i = 0; i < 40; ++i) {
+            Tracer::Scope s("step");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    t.join();
+    dropped = tracer.stop();
+    const std::string trace = readFile(TRACE_FILE);
+    EXPECT_GT(countOf(trace, "\"ph\":\"X\""), 8u);
+    EXPECT_EQ(countOf(trace, "\"ph\":\"X\"") + dropped, 40u);
+    // Names are escaped
+    EXPECT_EQ(countOf(trace, "\"name\":\"Long \\\"run\\\"\""), 1u);
+    std::remove(TRACE_FILE);
+}
+TEST(TracerTest, NestedSessions) {
+    Tracer &tracer = Tracer::getInstance();
+    {
+        Tracer::Session outer(TRACE_FILE);
+        EXPECT_TRUE(outer.isOwner());
+        {
+            // Inner sessions record into the outer session's trace
+            Tracer::Session inner("unused.json");
+            EXPECT_FALSE(inner.isOwner());
+            Tracer::Scope s("simulate", "inner");
+        }
+        EXPECT_TRUE(tracer.isActive());
+        // An empty path never starts a session
+        Tracer::Session none("");
+        EXPECT_FALSE(none.isOwner());
+    }
+    EXPECT_FALSE(tracer.isActive());
+    const std::string trace = readFile(TRACE_FILE);
+    EXPECT_EQ(countOf(trace, "\"name\":\"inner\""), 1u);
+    EXPECT_TRUE(readFile("unused.json").empty());
+    std::remove(TRACE_FILE);
+}
+
+}  // namespace test_tracer
+}  // namespace flamegpu
@@ -0,0 +1,83 @@
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "flamegpu/util/detail/WorkStealingThreadPool.h"
+
+#include "gtest/gtest.h"
+namespace flamegpu {
+namespace test_work_stealing_thread_pool {
+
+TEST(TestWorkStealingThreadPool, VisitsEachIndexOnce) {
+    util::detail::WorkStealingThreadPool pool(4);
+    EXPECT_EQ(pool.getThreadCount(), 4u);
+    const size_t N = 100003;
+    std::vector<std::atomic<unsigned int>> visits(N);
+    for (auto &v : visits)
+        v = 0;
+    pool.parallelFor(0, N, 64, [&visits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            ++visits[i];
+    });
+    for (size_t i = 0; i < N; ++i) {
+        ASSERT_EQ(visits[i], 1u);
+    }
+}
+TEST(TestWorkStealingThreadPool, AutomaticGrain) {
+    util::detail::WorkStealingThreadPool pool(3);
+    std::vector<unsigned int> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+    std::atomic<unsigned long long> total(0);
+    pool.parallelFor(0, data.size(), 0, [&data, &total](size_t begin, size_t end) {
+        unsigned long long t = 0;
+        for (size_t i = begin; i < end; ++i)
+            t += data[i];
+        total += t;
+    });
+    EXPECT_EQ(total, 999ull * 1000ull / 2);
+}
+TEST(TestWorkStealingThreadPool, SingleThreadIsSerial) {
+    util::detail::WorkStealingThreadPool pool(1);
+    EXPECT_EQ(pool.getThreadCount(), 1u);
+    std::vector<size_t> order;
+    pool.parallelFor(0, 10, 1, [&order](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            order.push_back(i);
+    });
+    ASSERT_EQ(order.size(), 10u);
+    for (size_t i = 0; i < order.size(); ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+TEST(TestWorkStealingThreadPool, EmptyRange) {
+    util::detail::WorkStealingThreadPool pool(2);
+    bool called = false;
+    pool.parallelFor(5, 5, 1, [&called](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
+TEST(TestWorkStealingThreadPool, ExceptionPropagates) {
+    util::detail::WorkStealingThreadPool pool(4);
+    std::atomic<unsigned int> chunks(0);
+    EXPECT_THROW(pool.parallelFor(0, 100, 1, [&chunks](size_t begin, size_t) {
+        ++chunks;
+        if (begin == 50)
+            throw std::runtime_error("test");
+    }), std::runtime_error);
+    // All chunks still complete, so the pool is left in a reusable state
+    EXPECT_EQ(chunks, 100u);
+    std::atomic<unsigned int> after(0);
+    pool.parallelFor(0, 100, 1, [&after](size_t begin, size_t end) { after += static_cast<unsigned int>(end - begin); });
+    EXPECT_EQ(after, 100u);
+}
+TEST(TestWorkStealingThreadPool, NestedParallelFor) {
+    util::detail::WorkStealingThreadPool pool(4);
+    std::atomic<unsigned int> total(0);
+    pool.parallelFor(0, 8, 1, [&pool, &total](size_t, size_t) {
+        pool.parallelFor(0, 16, 2, [&total](size_t begin, size_t end) { total += static_cast<unsigned int>(end - begin); });
+    });
+    EXPECT_EQ(total, 8u * 16u);
+}
+
+}  // namespace test_work_stealing_thread_pool
+}  // namespace flamegpu